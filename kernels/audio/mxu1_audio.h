@@ -0,0 +1,233 @@
+// mxu1_audio.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 stereo audio: FIR, biquad cascades, polyphase resampler
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Filters for 16-bit stereo audio, the mixer's and the player's format:
+// interleaved frames, each a uint32_t with the left sample in its low
+// halfword and the right one in its high halfword, which the MXU takes a
+// frame at a time, both channels in one d16mac.
+//   - FIR filters of up to MXU1_AUDIO_TAPS_MAX taps, coefficients in any
+//     fixed-point format Q0 .. Q15;
+//   - cascades of biquads (direct form I) in two precisions: Q14
+//     coefficients and 16-bit states, both channels at once (d16mac); and
+//     Q30 coefficients with states carrying 11 bits more, one channel at a
+//     time through s32madd into {HI:LO}, for the low corners and high Q
+//     that Q14 poles are too coarse for;
+//   - a polyphase resampler by any ratio phases / step of output to input
+//     rate (44.1 to 48 kHz is 160 / 147, 48 to 44.1 kHz 147 / 160, 8 to
+//     48 kHz 6 / 1), with a lowpass prototype designed at init.
+// All keep their history, so a stream can be fed in blocks of any size.
+//
+// Arithmetic (identical in the C versions): a FIR output is
+//     sat16((sum of h[i] * x[n - i] + 2^(shift - 1)) >> shift)
+// summed in 32 bits, which cannot overflow while the sum of |h[i]| stays
+// below 2^16 (below 2.0 in Q15). A Q14 biquad output is
+//     sat16((b0 x0 + b1 x1 + b2 x2 - a1 y1 - a2 y2 + 2^13) >> 14)
+// and a Q30 one, on samples scaled up by 2^11, w = the same sum (in 64 bits,
+// never overflowing) >> 30, clamped to 16-bit range times 2^11, kept as the
+// state, with y = w >> 11 the output. Shifts are arithmetic (round down);
+// sat16() clamps to -32768 .. 32767.
+//
+// Each function has a C version (_c) with the same results. The streaming
+// functions are in mxu1_audio_stream.c, written once against a set of
+// kernels, those in mxu1_audio.s or their C twins in mxu1_audio_ref.c.
+// 'dst' must not overlap 'src', except for the biquads, which may work in
+// place.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/audio, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_audio.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_audio_ref.c
+//         mxu1_audio_stream.c
+// and link with -lm (mxu1_audio_resampler_init() designs its filter).
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_AUDIO_H
+#define MXU1_AUDIO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  Most taps of a FIR filter, and of each phase of a resampler
+#define MXU1_AUDIO_TAPS_MAX     256
+
+////////////////////////////////////////////////////////////////////////////////
+// FIR (mxu1_audio_stream.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  The first three fields are the kernel's (mxu1_audio.s knows their
+// offsets): the number of taps (even), their fraction bits, and the taps,
+// each in both halves of a word, oldest sample's first. 'hist' holds the
+// last ntaps - 1 input frames, and the start of a block after them.
+typedef struct {
+  int32_t  ntaps;
+  int32_t  shift;
+  uint32_t taps[MXU1_AUDIO_TAPS_MAX];
+  uint32_t hist[2 * MXU1_AUDIO_TAPS_MAX];
+} mxu1_audio_fir;
+
+//  A filter of the n (1 .. MXU1_AUDIO_TAPS_MAX) taps h[] in Q'shift'
+// (0 .. 15), h[0] for the newest sample, with a silent history
+void mxu1_audio_fir_init(mxu1_audio_fir *f, const int16_t *h, int n,
+                         int shift);
+
+//  Filters 'frames' frames from 'src' into 'dst'
+void mxu1_audio_fir_apply(mxu1_audio_fir *f, uint32_t *dst,
+                          const uint32_t *src, int frames);
+void mxu1_audio_fir_apply_c(mxu1_audio_fir *f, uint32_t *dst,
+                            const uint32_t *src, int frames);
+
+////////////////////////////////////////////////////////////////////////////////
+// Biquad cascades (mxu1_audio_stream.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  One section: c[] = b0, b1, b2, -a1, -a2, each in both halves (Q14), and
+// z[] = x1, x2, y1, y2, the last two input and output frames
+typedef struct {
+  uint32_t c[5];
+  uint32_t z[4];
+} mxu1_audio_biquad;
+
+//  One channel of one section: c[] = b0, b1, b2, -a1, -a2 (Q30), z[] = x1,
+// x2, y1, y2 scaled up by 2^11
+typedef struct {
+  int32_t c[5];
+  int32_t z[4];
+} mxu1_audio_biquad32_ch;
+
+typedef struct {
+  mxu1_audio_biquad32_ch ch[2];
+} mxu1_audio_biquad32;
+
+//  A section of transfer function (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 +
+// a2 z^-2), c[] = b0, b1, b2, a1, a2 (normalized, a0 = 1), with silent
+// states. Coefficients are rounded to the nearest step and clamped to the
+// format: -2 .. 2 - 2^-14 for the Q14 sections, -2 .. 2 - 2^-30 for Q30.
+void mxu1_audio_biquad_init(mxu1_audio_biquad *s, const double c[5]);
+void mxu1_audio_biquad32_init(mxu1_audio_biquad32 *s, const double c[5]);
+
+//  Runs 'frames' frames from 'src' through the 'sections' sections s[] in
+// turn, into 'dst' (which may be 'src')
+void mxu1_audio_biquad_apply(mxu1_audio_biquad *s, int sections,
+                             uint32_t *dst, const uint32_t *src, int frames);
+void mxu1_audio_biquad_apply_c(mxu1_audio_biquad *s, int sections,
+                               uint32_t *dst, const uint32_t *src,
+                               int frames);
+void mxu1_audio_biquad32_apply(mxu1_audio_biquad32 *s, int sections,
+                               uint32_t *dst, const uint32_t *src,
+                               int frames);
+void mxu1_audio_biquad32_apply_c(mxu1_audio_biquad32 *s, int sections,
+                                 uint32_t *dst, const uint32_t *src,
+                                 int frames);
+
+////////////////////////////////////////////////////////////////////////////////
+// Polyphase resampler (mxu1_audio_stream.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  Words of the coefficient table of a resampler, and the most output
+// frames that 'frames' input frames can give
+#define MXU1_AUDIO_TABLE_WORDS(phases, taps) \
+  ((phases) * (((taps) + 1) & ~1))
+#define MXU1_AUDIO_RESAMPLE_MAX(frames, phases, step) \
+  (int)(((int64_t)(frames) * (phases) + (step) - 1) / (step))
+
+//  The first seven fields are the kernel's: the table (each phase's taps
+// as in mxu1_audio_fir), the taps per phase and their fraction bits; then
+// in bytes, the current phase's offset into the table, how far it moves
+// per output, the table's size, and the whole input frames per output
+// step. 'start' is where the next output's window starts, in frames from
+// hist[0], which holds the last ntaps - 1 input frames.
+typedef struct {
+  const uint32_t *table;
+  int32_t         ntaps;
+  int32_t         shift;
+  int32_t         phase;
+  int32_t         step_phase;
+  int32_t         period;
+  int32_t         advance;
+  int32_t         phases, step;
+  int32_t         start;
+  uint32_t        hist[2 * MXU1_AUDIO_TAPS_MAX];
+} mxu1_audio_resampler;
+
+//  A resampler to 'phases' / 'step' times the input rate, 'taps' (2 ..
+// MXU1_AUDIO_TAPS_MAX, rounded up to even) per phase: it designs a
+// Blackman-windowed sinc lowpass (cut off at 0.45 of the lower of the two
+// rates) of phases * taps taps into 'table', which must hold
+// MXU1_AUDIO_TABLE_WORDS(phases, taps) words and outlive the resampler.
+// Reduce phases / step first (160 / 147, not 480 / 441). 16 taps is about
+// 60 dB of stop band, 32 taps about 75 dB and a narrower transition.
+void mxu1_audio_resampler_init(mxu1_audio_resampler *r, uint32_t *table,
+                               int phases, int step, int taps);
+
+//  Resamples 'frames' frames from 'src' into 'dst', returning how many
+// frames it wrote: those of all the output instants whose filter windows
+// this input completes, at most MXU1_AUDIO_RESAMPLE_MAX(frames, ...).
+int mxu1_audio_resample(mxu1_audio_resampler *r, uint32_t *dst,
+                        const uint32_t *src, int frames);
+int mxu1_audio_resample_c(mxu1_audio_resampler *r, uint32_t *dst,
+                          const uint32_t *src, int frames);
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels (mxu1_audio.s, C twins in mxu1_audio_ref.c), for the driver
+////////////////////////////////////////////////////////////////////////////////
+
+//  dst[k] for k = 0 .. n - 1 is the output over x[k .. k + ntaps - 1]
+void mxu1_audio_fir_run(uint32_t *dst, const uint32_t *x, int32_t n,
+                        const mxu1_audio_fir *f);
+void mxu1_audio_fir_run_c(uint32_t *dst, const uint32_t *x, int32_t n,
+                          const mxu1_audio_fir *f);
+
+//  n outputs, each over x[0 ..] with the taps of r->phase, after which x
+// and r->phase step on; returns the frames x stepped over, and leaves
+// r->phase at the next output's
+int32_t mxu1_audio_poly_run(uint32_t *dst, const uint32_t *x, int32_t n,
+                            mxu1_audio_resampler *r);
+int32_t mxu1_audio_poly_run_c(uint32_t *dst, const uint32_t *x, int32_t n,
+                              mxu1_audio_resampler *r);
+
+//  n frames through one section, updating its states (dst may be src)
+void mxu1_audio_biquad_run(uint32_t *dst, const uint32_t *src, int32_t n,
+                           mxu1_audio_biquad *s);
+void mxu1_audio_biquad_run_c(uint32_t *dst, const uint32_t *src, int32_t n,
+                             mxu1_audio_biquad *s);
+
+//  n samples of one channel: src and dst step by a frame (4 bytes)
+void mxu1_audio_biquad32_run(int16_t *dst, const int16_t *src, int32_t n,
+                             mxu1_audio_biquad32_ch *s);
+void mxu1_audio_biquad32_run_c(int16_t *dst, const int16_t *src, int32_t n,
+                               mxu1_audio_biquad32_ch *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_AUDIO_H
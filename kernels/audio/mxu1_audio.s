@@ -0,0 +1,383 @@
+# mxu1_audio.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 stereo audio: FIR, biquad cascades, polyphase resampler
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, the structures and the arithmetic are described in
+# mxu1_audio.h. A frame is a word, the left sample in its low halfword and
+# the right in its high one, and a tap is a word too, its coefficient in
+# both halves: d16mac (WW) of the two adds the right channel's product into
+# XRa and the left's into XRd.
+#
+#  Accumulators start at the rounding bias (d32add from a bias register sets
+# both), add their products in 32 bits, and are clamped with s32max/s32min
+# to the values that shift down into int16_t; d32sarw then shifts both by
+# the format's fraction bits and packs them into the output frame.
+#
+#   fir_run:     two outputs per pass, x[k] and x[k + 1] windows sharing
+#                every frame loaded: per pair of taps, 4 loads and 4 d16mac
+#                (8 MACs); an odd last output takes one more pass alone.
+#   poly_run:    one output per pass, its phase's taps against its window,
+#                even and odd taps in two accumulator pairs (xr5/xr6 and
+#                xr7/xr8) summed by d32asum; then the phase steps on.
+#   biquad_run:  one frame per pass, the coefficients and the four state
+#                frames held in registers; direct form I, so the states are
+#                the last inputs and outputs, moved along by s32alni.
+#   biquad32_run: one channel (every other halfword) per call. Coefficients
+#                and states are 32-bit, in GPRs; s32mul and s32madd sum the
+#                five 32 x 32-bit products into {HI:LO} (and xr1:xr2), and
+#                s32extr takes bits 60..30 of it, the new state, which is
+#                sign extended (d32sll/d32sar), clamped and moved back.
+#
+# Register use: any xr, $v0, $v1, $t0..$t9, $a0..$a3, HI/LO. Leaf functions,
+# no stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# mxu1_audio_fir and mxu1_audio_resampler field offsets
+  .equ    F_NTAPS,        0
+  .equ    F_SHIFT,        4
+  .equ    F_TAPS,         8
+  .equ    R_TABLE,        0
+  .equ    R_NTAPS,        4
+  .equ    R_SHIFT,        8
+  .equ    R_PHASE,        12
+  .equ    R_STEP_PHASE,   16
+  .equ    R_PERIOD,       20
+  .equ    R_ADVANCE,      24
+
+# mxu1_audio_biquad and mxu1_audio_biquad32_ch field offsets
+  .equ    BQ_C,           0
+  .equ    BQ_Z,           20
+
+# Fraction bits of mxu1_audio_biquad's coefficients, and the extra bits of
+# mxu1_audio_biquad32's states
+  .equ    BQ_SHIFT,       14
+  .equ    BQ32_EXTRA,     11
+
+
+################################################################################
+#  xr13 = rounding bias, xr14/xr15 = smallest/largest accumulator that
+# shifts into int16_t, for a shift of \s (a GPR, 0..15). Uses $v0, $v1.
+.macro LIMITS s
+  li      $v0,  1
+  sllv    $v0,  $v0,  \s
+  srl     $v0,  $v0,  1
+  s32i2m  xr13, $v0
+  li      $v1,  -32768
+  sllv    $v1,  $v1,  \s
+  s32i2m  xr14, $v1
+  nor     $v1,  $v1,  $zero
+  s32i2m  xr15, $v1
+.endm
+
+#  Clamps the accumulator pair \a/\d to xr14..xr15 and shifts both by \s
+# into the frame \out
+.macro SATURATE out, a, d, s
+  s32max  \a,   \a,   xr14
+  s32max  \d,   \d,   xr14
+  s32min  \a,   \a,   xr15
+  s32min  \d,   \d,   xr15
+  d32sarw \out, \a,   \d,   \s
+.endm
+
+#  One output over the \n (even) taps after \t and frames after \x (both
+# pre-increment pointers): the even taps' sums in xr5/xr6, the odd ones' in
+# xr7/xr8, for the caller to add (d32asum). \n is used up.
+.macro FIR1 t, x, n
+  d32add  xr5,  xr13, xr0,  xr6,  AA
+  d32add  xr7,  xr0,  xr0,  xr8,  AA
+  s32ldi  xr3,  \t,   4
+  s32ldi  xr1,  \x,   4
+  s32ldi  xr4,  \t,   4
+  s32ldi  xr2,  \x,   4
+  addiu   \n,   \n,   -2
+  beqz    \n,   12f
+  nop
+11:
+  d16mac  xr5,  xr1,  xr3,  xr6,  AA, WW
+  s32ldi  xr3,  \t,   4
+  s32ldi  xr1,  \x,   4
+  d16mac  xr7,  xr2,  xr4,  xr8,  AA, WW
+  s32ldi  xr4,  \t,   4
+  addiu   \n,   \n,   -2
+  bnez    \n,   11b
+  s32ldi  xr2,  \x,   4
+12:
+  d16mac  xr5,  xr1,  xr3,  xr6,  AA, WW
+  d16mac  xr7,  xr2,  xr4,  xr8,  AA, WW
+.endm
+
+
+################################################################################
+# void mxu1_audio_fir_run(uint32_t *dst, const uint32_t *x, int32_t n,
+#                         const mxu1_audio_fir *f)
+#
+#  Output k (and k + 1) is over x[k ..]: $t8 walks the frames and $t6 the
+# taps, xr1 holding the frame both outputs have in common at each step.
+# xr5/xr6 accumulate output k, xr7/xr8 output k + 1.
+  .globl  mxu1_audio_fir_run
+  .type   mxu1_audio_fir_run, @function
+  .ent    mxu1_audio_fir_run
+mxu1_audio_fir_run:
+  lw      $t1,  F_NTAPS($a3)
+  lw      $t2,  F_SHIFT($a3)
+  LIMITS  $t2
+  addiu   $t0,  $a3,  F_TAPS - 4
+  addiu   $a0,  $a0,  -4
+  addiu   $a2,  $a2,  -2
+  bltz    $a2,  5f
+  srl     $t3,  $t1,  1                   # Pairs of taps
+
+1:                                        # Two outputs
+  s32ldd  xr1,  $a1,  0
+  move    $t6,  $t0
+  move    $t8,  $a1
+  addiu   $t9,  $t3,  -1
+  d32add  xr5,  xr13, xr0,  xr6,  AA
+  d32add  xr7,  xr13, xr0,  xr8,  AA
+  s32ldi  xr3,  $t6,  4                   # t[j]
+  beqz    $t9,  3f
+  s32ldi  xr2,  $t8,  4                   # x[k + j + 1]
+
+2:                                        # Two taps
+  d16mac  xr5,  xr1,  xr3,  xr6,  AA, WW
+  s32ldi  xr4,  $t6,  4                   # t[j + 1]
+  d16mac  xr7,  xr2,  xr3,  xr8,  AA, WW
+  s32ldi  xr1,  $t8,  4                   # x[k + j + 2]
+  d16mac  xr5,  xr2,  xr4,  xr6,  AA, WW
+  addiu   $t9,  $t9,  -1
+  s32ldi  xr3,  $t6,  4
+  s32ldi  xr2,  $t8,  4
+  bnez    $t9,  2b
+  d16mac  xr7,  xr1,  xr4,  xr8,  AA, WW
+
+3:                                        # The last two, loading no further
+  d16mac  xr5,  xr1,  xr3,  xr6,  AA, WW
+  s32ldi  xr4,  $t6,  4
+  d16mac  xr7,  xr2,  xr3,  xr8,  AA, WW
+  s32ldi  xr1,  $t8,  4
+  d16mac  xr5,  xr2,  xr4,  xr6,  AA, WW
+  d16mac  xr7,  xr1,  xr4,  xr8,  AA, WW
+
+  SATURATE xr9, xr5, xr6, $t2
+  SATURATE xr10, xr7, xr8, $t2
+  addiu   $a1,  $a1,  8
+  s32sdi  xr9,  $a0,  4
+  addiu   $a2,  $a2,  -2
+  bgez    $a2,  1b
+  s32sdi  xr10, $a0,  4
+
+5:
+  addiu   $a2,  $a2,  2
+  beqz    $a2,  9f
+  addiu   $t8,  $a1,  -4
+
+  FIR1    $t0,  $t8,  $t1                 # The odd last output
+  d32asum xr5,  xr7,  xr8,  xr6,  AA
+  SATURATE xr9, xr5, xr6, $t2
+  s32sdi  xr9,  $a0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_audio_fir_run
+  .size   mxu1_audio_fir_run, .-mxu1_audio_fir_run
+
+
+################################################################################
+# int32_t mxu1_audio_poly_run(uint32_t *dst, const uint32_t *x, int32_t n,
+#                             mxu1_audio_resampler *r)
+#
+#  The phase, its step and period are byte offsets into the table ($t3, $t4,
+# $t5), so the taps of a phase are at table + phase; $t6 is the whole frames
+# of the step, in bytes. The phase is stored back, and the frames stepped
+# over returned.
+  .globl  mxu1_audio_poly_run
+  .type   mxu1_audio_poly_run, @function
+  .ent    mxu1_audio_poly_run
+mxu1_audio_poly_run:
+  lw      $t0,  R_TABLE($a3)
+  lw      $t1,  R_NTAPS($a3)
+  lw      $t2,  R_SHIFT($a3)
+  lw      $t3,  R_PHASE($a3)
+  lw      $t4,  R_STEP_PHASE($a3)
+  lw      $t5,  R_PERIOD($a3)
+  lw      $t6,  R_ADVANCE($a3)
+  LIMITS  $t2
+  addiu   $t0,  $t0,  -4
+  addiu   $a0,  $a0,  -4
+  blez    $a2,  9f
+  move    $v1,  $a1
+
+1:                                        # One output
+  addu    $t7,  $t0,  $t3
+  addiu   $t8,  $a1,  -4
+  move    $t9,  $t1
+  FIR1    $t7,  $t8,  $t9
+  addu    $t3,  $t3,  $t4                 # Next phase,
+  d32asum xr5,  xr7,  xr8,  xr6,  AA
+  addu    $a1,  $a1,  $t6                 # and frame
+  sltu    $v0,  $t3,  $t5
+  subu    $t9,  $t3,  $t5
+  movz    $t3,  $t9,  $v0                 # Past the period: one frame on
+  xori    $v0,  $v0,  1
+  sll     $v0,  $v0,  2
+  addu    $a1,  $a1,  $v0
+  SATURATE xr9, xr5, xr6, $t2
+  addiu   $a2,  $a2,  -1
+  bnez    $a2,  1b
+  s32sdi  xr9,  $a0,  4
+
+  sw      $t3,  R_PHASE($a3)
+9:
+  subu    $v0,  $a1,  $v1
+  jr      $ra
+  sra     $v0,  $v0,  2
+  .end    mxu1_audio_poly_run
+  .size   mxu1_audio_poly_run, .-mxu1_audio_poly_run
+
+
+################################################################################
+# void mxu1_audio_biquad_run(uint32_t *dst, const uint32_t *src, int32_t n,
+#                            mxu1_audio_biquad *s)
+#
+#  xr1..xr5 = b0, b1, b2, -a1, -a2; xr6/xr7 = x1/x2, xr8/xr9 = y1/y2; xr10
+# the new input, xr11/xr12 the accumulators. The oldest terms go first, so
+# that each state is free to move along once its product is in.
+  .globl  mxu1_audio_biquad_run
+  .type   mxu1_audio_biquad_run, @function
+  .ent    mxu1_audio_biquad_run
+mxu1_audio_biquad_run:
+  li      $t0,  BQ_SHIFT
+  LIMITS  $t0
+  s32ldd  xr1,  $a3,  BQ_C
+  s32ldd  xr2,  $a3,  BQ_C + 4
+  s32ldd  xr3,  $a3,  BQ_C + 8
+  s32ldd  xr4,  $a3,  BQ_C + 12
+  s32ldd  xr5,  $a3,  BQ_C + 16
+  s32ldd  xr6,  $a3,  BQ_Z
+  s32ldd  xr7,  $a3,  BQ_Z + 4
+  s32ldd  xr8,  $a3,  BQ_Z + 8
+  s32ldd  xr9,  $a3,  BQ_Z + 12
+  addiu   $a0,  $a0,  -4
+  blez    $a2,  9f
+  addiu   $a1,  $a1,  -4
+
+1:                                        # One frame
+  d32add  xr11, xr13, xr0,  xr12, AA
+  s32ldi  xr10, $a1,  4
+  d16mac  xr11, xr7,  xr3,  xr12, AA, WW  # b2 * x2
+  s32alni xr7,  xr6,  xr0,  0             # x2 = x1
+  d16mac  xr11, xr9,  xr5,  xr12, AA, WW  # - a2 * y2
+  s32alni xr9,  xr8,  xr0,  0             # y2 = y1
+  d16mac  xr11, xr6,  xr2,  xr12, AA, WW  # b1 * x1
+  s32alni xr6,  xr10, xr0,  0             # x1 = x
+  d16mac  xr11, xr8,  xr4,  xr12, AA, WW  # - a1 * y1
+  addiu   $a2,  $a2,  -1
+  d16mac  xr11, xr10, xr1,  xr12, AA, WW  # b0 * x
+  SATURATE xr8, xr11, xr12, $t0           # y1 = y
+  bnez    $a2,  1b
+  s32sdi  xr8,  $a0,  4
+
+  s32std  xr6,  $a3,  BQ_Z
+  s32std  xr7,  $a3,  BQ_Z + 4
+  s32std  xr8,  $a3,  BQ_Z + 8
+  s32std  xr9,  $a3,  BQ_Z + 12
+9:
+  jr      $ra
+  nop
+  .end    mxu1_audio_biquad_run
+  .size   mxu1_audio_biquad_run, .-mxu1_audio_biquad_run
+
+
+################################################################################
+# void mxu1_audio_biquad32_run(int16_t *dst, const int16_t *src, int32_t n,
+#                              mxu1_audio_biquad32_ch *s)
+#
+#  $t0..$t4 = b0, b1, b2, -a1, -a2 (Q30); $t5/$t6 = x1/x2, $t7/$t8 = y1/y2,
+# all samples scaled up by BQ32_EXTRA bits. xr3/xr4 bound the states to
+# what shifts into int16_t. $v1 = 3, s32extr's bits below the top of
+# {xr1:xr2}: the 31-bit field there ends at bit 30 of {HI:LO}.
+  .globl  mxu1_audio_biquad32_run
+  .type   mxu1_audio_biquad32_run, @function
+  .ent    mxu1_audio_biquad32_run
+mxu1_audio_biquad32_run:
+  lw      $t0,  BQ_C($a3)
+  lw      $t1,  BQ_C + 4($a3)
+  lw      $t2,  BQ_C + 8($a3)
+  lw      $t3,  BQ_C + 12($a3)
+  lw      $t4,  BQ_C + 16($a3)
+  lw      $t5,  BQ_Z($a3)
+  lw      $t6,  BQ_Z + 4($a3)
+  lw      $t7,  BQ_Z + 8($a3)
+  lw      $t8,  BQ_Z + 12($a3)
+  li      $v0,  -32768 << BQ32_EXTRA
+  s32i2m  xr3,  $v0
+  nor     $v0,  $v0,  $zero
+  s32i2m  xr4,  $v0
+  li      $v1,  3
+  blez    $a2,  9f
+  addiu   $a0,  $a0,  -4
+
+1:                                        # One sample
+  s32mul  xr1,  xr2,  $t2,  $t6           # b2 * x2
+  lh      $t9,  0($a1)
+  addiu   $a1,  $a1,  4
+  s32madd xr1,  xr2,  $t4,  $t8           # - a2 * y2
+  move    $t6,  $t5                       # x2 = x1
+  sll     $t9,  $t9,  BQ32_EXTRA
+  s32madd xr1,  xr2,  $t1,  $t5           # b1 * x1
+  move    $t8,  $t7                       # y2 = y1
+  addiu   $a2,  $a2,  -1
+  s32madd xr1,  xr2,  $t0,  $t9           # b0 * x
+  move    $t5,  $t9                       # x1 = x
+  s32madd xr1,  xr2,  $t3,  $t7           # - a1 * y1
+  s32extr xr1,  xr2,  $v1,  31
+  d32sll  xr1,  xr1,  xr0,  xr0,  1
+  d32sar  xr1,  xr1,  xr0,  xr0,  1
+  s32max  xr1,  xr1,  xr3
+  s32min  xr1,  xr1,  xr4
+  d32sar  xr5,  xr1,  xr0,  xr0,  BQ32_EXTRA
+  s32m2i  xr1,  $t7                       # y1 = y
+  bnez    $a2,  1b
+  s16sdi  xr5,  $a0,  4,  0
+
+  sw      $t5,  BQ_Z($a3)
+  sw      $t6,  BQ_Z + 4($a3)
+  sw      $t7,  BQ_Z + 8($a3)
+  sw      $t8,  BQ_Z + 12($a3)
+9:
+  jr      $ra
+  nop
+  .end    mxu1_audio_biquad32_run
+  .size   mxu1_audio_biquad32_run, .-mxu1_audio_biquad32_run
+
+# vim:shiftwidth=2:expandtab:syntax=asm
@@ -0,0 +1,250 @@
+// mxu1_audio_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 stereo audio filters: checks and CPU share per stream
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Checks every function in mxu1_audio.h against its _c version on random,
+// full scale and sine input fed in blocks of random sizes (down to 0 and
+// 1 frame, so the history paths are crossed), then times each as a stereo
+// 44.1 kHz stream in 256-frame blocks, the player's period, and prints the
+// share of one CPU it takes: a stream running at x% leaves room for 100 / x
+// of them.
+//
+// Build and run on the target (kernels/audio):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_audio_bench
+//         mxu1_audio_bench.c mxu1_audio_stream.c mxu1_audio_ref.c
+//         mxu1_audio.s ../dispatch/mxu1_cpu.c -lm
+//     ./mxu1_audio_bench [seconds per test, default 1]
+// Exits non-zero if any output differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_audio.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+#define RATE    44100
+#define BLOCK   256
+#define PI      3.14159265358979323846
+
+enum { MXU, C };
+
+typedef enum {
+  FIR32, FIR128, EQ, EQ32, RESAMPLE16, RESAMPLE32, STREAMS
+} stream;
+
+static const char *const name[] = {
+  "FIR, 32 taps", "FIR, 128 taps", "5-band EQ, Q14", "5-band EQ, Q30",
+  "44.1 -> 48 kHz, 16 taps", "44.1 -> 48 kHz, 32 taps"
+};
+
+static mxu1_audio_fir fir[2];
+static mxu1_audio_biquad eq[2][5];
+static mxu1_audio_biquad32 eq32[2][5];
+static mxu1_audio_resampler rs[2];
+static uint32_t table[MXU1_AUDIO_TABLE_WORDS(160, 32)];
+
+//  A Hann-windowed sinc lowpass at 'fc' (of the rate) of n taps in Q15
+static void lowpass(int16_t *h, int n, double fc)
+{
+  for (int i = 0; i < n; ++i) {
+    const double x = i - (n - 1) / 2.0;
+    const double s = x == 0 ? 2 * fc : sin(2 * PI * fc * x) / (PI * x);
+    h[i] = (int16_t)floor(32768 * s * (0.5 - 0.5 * cos(2 * PI * (i + 1) /
+                                                       (n + 1))) + 0.5);
+  }
+}
+
+//  Peaking EQ section (RBJ cookbook) at f0 Hz, 'db' gain, Q of 1
+static void peaking(double c[5], double f0, double db)
+{
+  const double a = pow(10, db / 40), w = 2 * PI * f0 / RATE;
+  const double alpha = sin(w) / 2, a0 = 1 + alpha / a;
+  c[0] = (1 + alpha * a) / a0;
+  c[1] = -2 * cos(w) / a0;
+  c[2] = (1 - alpha * a) / a0;
+  c[3] = c[1];
+  c[4] = (1 - alpha / a) / a0;
+}
+
+//  Both implementations' filters for 's', freshly initialized
+static void setup(stream s)
+{
+  static const double f0[5] = { 60, 250, 1000, 4000, 12000 };
+  static const double db[5] = { 6, -3, 2, -6, 4 };
+  int16_t h[128];
+
+  for (int impl = MXU; impl <= C; ++impl) {
+    switch (s) {
+      case FIR32:
+      case FIR128: {
+        const int n = s == FIR32 ? 32 : 128;
+        lowpass(h, n, 0.2);
+        mxu1_audio_fir_init(&fir[impl], h, n, 15);
+        break;
+      }
+      case EQ:
+      case EQ32:
+        for (int i = 0; i < 5; ++i) {
+          double c[5];
+          peaking(c, f0[i], db[i]);
+          mxu1_audio_biquad_init(&eq[impl][i], c);
+          mxu1_audio_biquad32_init(&eq32[impl][i], c);
+        }
+        break;
+      default:
+        mxu1_audio_resampler_init(&rs[impl], table, 160, 147,
+                                  s == RESAMPLE16 ? 16 : 32);
+        break;
+    }
+  }
+}
+
+//  Runs a block through 's', returning the output frames
+static int process(stream s, int impl, uint32_t *dst, const uint32_t *src,
+                   int frames)
+{
+  const int c = impl == C;
+  switch (s) {
+    case FIR32:
+    case FIR128:
+      (c ? mxu1_audio_fir_apply_c : mxu1_audio_fir_apply)(&fir[impl], dst,
+                                                          src, frames);
+      return frames;
+    case EQ:
+      (c ? mxu1_audio_biquad_apply_c : mxu1_audio_biquad_apply)(
+          eq[impl], 5, dst, src, frames);
+      return frames;
+    case EQ32:
+      (c ? mxu1_audio_biquad32_apply_c : mxu1_audio_biquad32_apply)(
+          eq32[impl], 5, dst, src, frames);
+      return frames;
+    default:
+      return (c ? mxu1_audio_resample_c : mxu1_audio_resample)(&rs[impl], dst,
+                                                               src, frames);
+  }
+}
+
+//  Share of one CPU that 's' takes at RATE, from 'in' (RATE frames) looped
+static double cpu(stream s, int impl, const uint32_t *in, uint32_t *out,
+                  double secs)
+{
+  long frames = 0;
+  double t0 = now(), dt;
+
+  setup(s);
+  do {
+    for (int i = 0; i + BLOCK <= RATE; i += BLOCK)
+      process(s, impl, out, in + i, BLOCK);
+    frames += RATE / BLOCK * BLOCK;
+    dt = now() - t0;
+  } while (dt < secs);
+  return 100 * dt / ((double)frames / RATE);
+}
+
+int main(int argc, char **argv)
+{
+  const int max = 2000;
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  uint32_t *in = (uint32_t *)malloc(RATE * sizeof(*in));
+  uint32_t *out[2];
+  int failed = 0;
+
+  out[MXU] = (uint32_t *)malloc(2 * RATE * sizeof(*in));
+  out[C] = (uint32_t *)malloc(2 * RATE * sizeof(*in));
+  if (!in || !out[MXU] || !out[C]) {
+    fprintf(stderr, "out of memory\n");
+    return 2;
+  }
+  mxu1_cpu_enable();
+
+  // Random, full scale square (saturating every filter) and two sines
+  for (int fill = 0; fill < 3; ++fill) {
+    for (int i = 0; i < max; ++i) {
+      const int l = fill == 0 ? (int16_t)rand16() :
+                    fill == 1 ? (i / 40 & 1 ? 32767 : -32768) :
+                    (int)(32000 * sin(2 * PI * 440 * i / RATE));
+      const int r = fill == 0 ? (int16_t)rand16() :
+                    fill == 1 ? (i / 13 & 1 ? -32768 : 32767) :
+                    (int)(20000 * sin(2 * PI * 3000 * i / RATE));
+      in[i] = (uint16_t)l | (uint32_t)(uint16_t)r << 16;
+    }
+    for (int s = 0; s < STREAMS; ++s) {
+      setup((stream)s);
+      for (int i = 0, n; i < max; i += n) {
+        int m[2];
+        n = rand16() % 4 == 0 ? rand16() % 3 : rand16() % 600;
+        n = n < max - i ? n : max - i;
+        m[MXU] = process((stream)s, MXU, out[MXU], in + i, n);
+        m[C] = process((stream)s, C, out[C], in + i, n);
+        if (m[MXU] != m[C] ||
+            memcmp(out[MXU], out[C], m[MXU] * sizeof(*in))) {
+          printf("%-24s %d frames at %d, fill %d: MISMATCH\n", name[s], n,
+                 i, fill);
+          failed = 1;
+          break;
+        }
+      }
+    }
+  }
+
+  // A second of music-like input: two sines and a little noise
+  for (int i = 0; i < RATE; ++i) {
+    const int v = (int)(12000 * sin(2 * PI * 220 * i / RATE) +
+                        6000 * sin(2 * PI * 3520 * i / RATE)) +
+                  (int)(rand16() % 512) - 256;
+    in[i] = (uint16_t)v | (uint32_t)(uint16_t)(-v) << 16;
+  }
+  printf("stereo 44.1 kHz, %d-frame blocks   CPU %%: MXU       C"
+         "  (MXU vs C)\n", BLOCK);
+  for (int s = 0; s < STREAMS; ++s) {
+    const double m = cpu((stream)s, MXU, in, out[MXU], secs);
+    const double c = cpu((stream)s, C, in, out[C], secs);
+    printf("  %-30s %8.2f %8.2f  x%.2f\n", name[s], m, c, c / m);
+  }
+
+  free(in);
+  free(out[MXU]);
+  free(out[C]);
+  return failed;
+}
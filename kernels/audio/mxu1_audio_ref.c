@@ -0,0 +1,131 @@
+// mxu1_audio_ref.c
+//
+// Scalar C reference for the mxu1_audio.s filter and resampler kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The kernels of mxu1_audio.s in C, a sample at a time, which the MXU
+// versions must match exactly. Sums wrap in 32 bits as the MXU's lanes do
+// (uint32_t, then converted), so that even filters outside the documented
+// range give the same result in both.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_audio.h"
+
+//  The samples and taps of a frame word: left low, right high
+static int32_t lo16(uint32_t w) { return (int16_t)(w & 0xffff); }
+static int32_t hi16(uint32_t w) { return (int16_t)(w >> 16); }
+
+//  A 32-bit sum clamped to what shifts into int16_t, shifted, as a frame
+static uint32_t saturate(uint32_t sum, int shift)
+{
+  const int32_t lo = (int32_t)((uint32_t)-32768 << shift), hi = ~lo;
+  int32_t v = (int32_t)sum;
+  v = v < lo ? lo : v > hi ? hi : v;
+  return (uint32_t)(v >> shift) & 0xffff;
+}
+
+static uint32_t frame(uint32_t l, uint32_t r, int shift)
+{
+  return saturate(r, shift) << 16 | saturate(l, shift);
+}
+
+//  One output of n taps over x[]
+static uint32_t fir1(const uint32_t *t, const uint32_t *x, int n, int shift)
+{
+  uint32_t l = shift ? 1u << (shift - 1) : 0, r = l;
+  for (int j = 0; j < n; ++j) {
+    l += (uint32_t)(lo16(t[j]) * lo16(x[j]));
+    r += (uint32_t)(hi16(t[j]) * hi16(x[j]));
+  }
+  return frame(l, r, shift);
+}
+
+void mxu1_audio_fir_run_c(uint32_t *dst, const uint32_t *x, int32_t n,
+                          const mxu1_audio_fir *f)
+{
+  for (int32_t k = 0; k < n; ++k)
+    dst[k] = fir1(f->taps, x + k, f->ntaps, f->shift);
+}
+
+int32_t mxu1_audio_poly_run_c(uint32_t *dst, const uint32_t *x, int32_t n,
+                              mxu1_audio_resampler *r)
+{
+  int32_t pos = 0;
+  for (int32_t k = 0; k < n; ++k) {
+    dst[k] = fir1(r->table + r->phase / 4, x + pos, r->ntaps, r->shift);
+    pos += r->advance / 4;
+    r->phase += r->step_phase;
+    if (r->phase >= r->period) {
+      r->phase -= r->period;
+      ++pos;
+    }
+  }
+  return pos;
+}
+
+void mxu1_audio_biquad_run_c(uint32_t *dst, const uint32_t *src, int32_t n,
+                             mxu1_audio_biquad *s)
+{
+  uint32_t *z = s->z;
+
+  for (int32_t k = 0; k < n; ++k) {
+    const uint32_t v[5] = { src[k], z[0], z[1], z[2], z[3] };
+    uint32_t l = 1u << 13, r = l, y;
+    for (int i = 0; i < 5; ++i) {
+      l += (uint32_t)(lo16(s->c[i]) * lo16(v[i]));
+      r += (uint32_t)(hi16(s->c[i]) * hi16(v[i]));
+    }
+    y = frame(l, r, 14);
+    z[1] = z[0];
+    z[0] = v[0];
+    z[3] = z[2];
+    z[2] = y;
+    dst[k] = y;
+  }
+}
+
+void mxu1_audio_biquad32_run_c(int16_t *dst, const int16_t *src, int32_t n,
+                               mxu1_audio_biquad32_ch *s)
+{
+  const int32_t *c = s->c;
+  int32_t *z = s->z;
+
+  for (int32_t k = 0; k < n; ++k) {
+    const int32_t x = src[2 * k] * 2048;
+    const int64_t sum = (int64_t)c[0] * x + (int64_t)c[1] * z[0] +
+                        (int64_t)c[2] * z[1] + (int64_t)c[3] * z[2] +
+                        (int64_t)c[4] * z[3];
+    // Bits 60..30, sign extended from bit 60, as s32extr takes them
+    int32_t w = (int32_t)((uint32_t)((uint64_t)sum >> 30) << 1) >> 1;
+    w = w < -32768 * 2048 ? -32768 * 2048 : w > 32768 * 2048 - 1 ?
+        32768 * 2048 - 1 : w;
+    z[1] = z[0];
+    z[0] = x;
+    z[3] = z[2];
+    z[2] = w;
+    dst[2 * k] = (int16_t)(w >> 11);
+  }
+}
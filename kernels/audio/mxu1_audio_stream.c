@@ -0,0 +1,278 @@
+// mxu1_audio_stream.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 streaming FIR, biquad and resampler drivers
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The kernels filter windows that lie in one buffer, so each block's first
+// windows, which start in the history, are run on a copy of the history
+// followed by the block's first frames (hist[] in the filter), and the rest
+// on the block itself; then the history takes the block's last frames.
+// The resampler's windows do not advance one frame per output, so it
+// counts how many windows end in each buffer before running the kernel.
+//
+//  The driver is written once, against a set of kernels, so that the _c
+// functions are the same computation with the C kernels throughout.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+#include "mxu1_audio.h"
+
+typedef struct {
+  void    (*fir)(uint32_t *, const uint32_t *, int32_t,
+                 const mxu1_audio_fir *);
+  int32_t (*poly)(uint32_t *, const uint32_t *, int32_t,
+                  mxu1_audio_resampler *);
+  void    (*biquad)(uint32_t *, const uint32_t *, int32_t,
+                    mxu1_audio_biquad *);
+  void    (*biquad32)(int16_t *, const int16_t *, int32_t,
+                      mxu1_audio_biquad32_ch *);
+} kernels;
+
+static const kernels mxu = {
+  mxu1_audio_fir_run, mxu1_audio_poly_run, mxu1_audio_biquad_run,
+  mxu1_audio_biquad32_run
+};
+
+static const kernels ref = {
+  mxu1_audio_fir_run_c, mxu1_audio_poly_run_c, mxu1_audio_biquad_run_c,
+  mxu1_audio_biquad32_run_c
+};
+
+//  A coefficient in both halves of a word
+static uint32_t pack(int32_t v)
+{
+  return (uint32_t)(uint16_t)v * 0x10001u;
+}
+
+//  v * 2^bits rounded to the nearest integer, clamped to lo .. hi
+static int32_t fixed(double v, int bits, double lo, double hi)
+{
+  v = floor(ldexp(v, bits) + 0.5);
+  return (int32_t)(v < lo ? lo : v > hi ? hi : v);
+}
+
+//  hist[0 .. h - 1] = the last h of hist[0 .. h - 1] then src[0 .. n - 1],
+// where hist[h ..] already holds src's first min(n, h) frames
+static void keep(uint32_t *hist, int h, const uint32_t *src, int n)
+{
+  if (n >= h)
+    memcpy(hist, src + n - h, h * sizeof(*hist));
+  else
+    memmove(hist, hist + n, h * sizeof(*hist));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FIR
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_audio_fir_init(mxu1_audio_fir *f, const int16_t *h, int n,
+                         int shift)
+{
+  f->ntaps = (n + 1) & ~1;
+  f->shift = shift;
+  for (int j = 0; j < f->ntaps; ++j) {
+    const int i = f->ntaps - 1 - j;
+    f->taps[j] = i < n ? pack(h[i]) : 0;
+  }
+  memset(f->hist, 0, sizeof(f->hist));
+}
+
+//  Output k's window starts k frames from hist[0]: in hist[] for the first
+// ntaps - 1, at src + k - (ntaps - 1) after
+static void fir(mxu1_audio_fir *f, uint32_t *dst, const uint32_t *src,
+                int frames, const kernels *k)
+{
+  const int h = f->ntaps - 1, m = frames < h ? frames : h;
+
+  if (frames <= 0)
+    return;
+  memcpy(f->hist + h, src, m * sizeof(*src));
+  k->fir(dst, f->hist, m, f);
+  if (frames > m)
+    k->fir(dst + m, src + m - h, frames - m, f);
+  keep(f->hist, h, src, frames);
+}
+
+void mxu1_audio_fir_apply(mxu1_audio_fir *f, uint32_t *dst,
+                          const uint32_t *src, int frames)
+{
+  fir(f, dst, src, frames, &mxu);
+}
+
+void mxu1_audio_fir_apply_c(mxu1_audio_fir *f, uint32_t *dst,
+                            const uint32_t *src, int frames)
+{
+  fir(f, dst, src, frames, &ref);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Biquad cascades
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_audio_biquad_init(mxu1_audio_biquad *s, const double c[5])
+{
+  for (int i = 0; i < 5; ++i)
+    s->c[i] = pack(fixed(i < 3 ? c[i] : -c[i], 14, -32768, 32767));
+  memset(s->z, 0, sizeof(s->z));
+}
+
+void mxu1_audio_biquad32_init(mxu1_audio_biquad32 *s, const double c[5])
+{
+  for (int i = 0; i < 5; ++i)
+    s->ch[0].c[i] = fixed(i < 3 ? c[i] : -c[i], 30, INT32_MIN, INT32_MAX);
+  memset(s->ch[0].z, 0, sizeof(s->ch[0].z));
+  s->ch[1] = s->ch[0];
+}
+
+static void biquads(mxu1_audio_biquad *s, int sections, uint32_t *dst,
+                    const uint32_t *src, int frames, const kernels *k)
+{
+  for (int i = 0; i < sections; ++i, src = dst)
+    k->biquad(dst, src, frames, s + i);
+}
+
+static void biquads32(mxu1_audio_biquad32 *s, int sections, uint32_t *dst,
+                      const uint32_t *src, int frames, const kernels *k)
+{
+  for (int i = 0; i < sections; ++i, src = dst)
+    for (int ch = 0; ch < 2; ++ch)
+      k->biquad32((int16_t *)dst + ch, (const int16_t *)src + ch, frames,
+                  &s[i].ch[ch]);
+}
+
+void mxu1_audio_biquad_apply(mxu1_audio_biquad *s, int sections,
+                             uint32_t *dst, const uint32_t *src, int frames)
+{
+  biquads(s, sections, dst, src, frames, &mxu);
+}
+
+void mxu1_audio_biquad_apply_c(mxu1_audio_biquad *s, int sections,
+                               uint32_t *dst, const uint32_t *src,
+                               int frames)
+{
+  biquads(s, sections, dst, src, frames, &ref);
+}
+
+void mxu1_audio_biquad32_apply(mxu1_audio_biquad32 *s, int sections,
+                               uint32_t *dst, const uint32_t *src,
+                               int frames)
+{
+  biquads32(s, sections, dst, src, frames, &mxu);
+}
+
+void mxu1_audio_biquad32_apply_c(mxu1_audio_biquad32 *s, int sections,
+                                 uint32_t *dst, const uint32_t *src,
+                                 int frames)
+{
+  biquads32(s, sections, dst, src, frames, &ref);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Polyphase resampler
+////////////////////////////////////////////////////////////////////////////////
+
+//  Output instants are 'step' apart on a grid 'phases' times finer than the
+// input's, so the prototype filter is designed at that rate. Output k
+// after one at grid point q * phases + p (p the phase) is over the input
+// frames q - ntaps + 1 .. q, against taps p, p + phases, ... of the
+// prototype, newest first: phase p's row of the table.
+void mxu1_audio_resampler_init(mxu1_audio_resampler *r, uint32_t *table,
+                               int phases, int step, int taps)
+{
+  const int t = (taps + 1) & ~1, n = phases * t;
+  const double pi = 3.14159265358979323846;
+  const double fc = 0.45 / phases * (step > phases ?
+                                     (double)phases / step : 1.0);
+
+  for (int p = 0; p < phases; ++p) {
+    for (int j = 0; j < t; ++j) {
+      const int i = (t - 1 - j) * phases + p;
+      const double x = i - (n - 1) / 2.0, a = 2 * pi * i / (n - 1);
+      const double w = 0.42 - 0.5 * cos(a) + 0.08 * cos(2 * a);
+      const double s = x == 0 ? 1.0 : sin(2 * pi * fc * x) / (2 * pi * fc * x);
+      table[p * t + j] = pack(fixed(2 * fc * phases * s * w, 15,
+                                    -32768, 32767));
+    }
+  }
+  r->table = table;
+  r->ntaps = t;
+  r->shift = 15;
+  r->phase = 0;
+  r->step_phase = step % phases * t * 4;
+  r->period = phases * t * 4;
+  r->advance = step / phases * 4;
+  r->phases = phases;
+  r->step = step;
+  r->start = 0;
+  memset(r->hist, 0, sizeof(r->hist));
+}
+
+//  How many more outputs have windows that end within the first 'avail'
+// frames from hist[0]: output k starts at start + (phase + k * step) /
+// phases (phase as a grid offset), which must be at most avail - ntaps.
+static int outputs(const mxu1_audio_resampler *r, int avail)
+{
+  const int64_t last = avail - r->ntaps - r->start;
+  const int64_t phase = r->phase / (r->ntaps * 4);
+
+  if (last < 0)
+    return 0;
+  return (int)(((last + 1) * r->phases - phase + r->step - 1) / r->step);
+}
+
+static int resample(mxu1_audio_resampler *r, uint32_t *dst,
+                    const uint32_t *src, int frames, const kernels *k)
+{
+  const int h = r->ntaps - 1, m = frames < h ? frames : h;
+  int out, n;
+
+  if (frames <= 0)
+    return 0;
+  memcpy(r->hist + h, src, m * sizeof(*src));
+  out = outputs(r, h + m);
+  if (out > 0)
+    r->start += k->poly(dst, r->hist + r->start, out, r);
+  if (r->start >= h && (n = outputs(r, h + frames)) > 0) {
+    r->start += k->poly(dst + out, src + r->start - h, n, r);
+    out += n;
+  }
+  keep(r->hist, h, src, frames);
+  r->start -= frames;
+  return out;
+}
+
+int mxu1_audio_resample(mxu1_audio_resampler *r, uint32_t *dst,
+                        const uint32_t *src, int frames)
+{
+  return resample(r, dst, src, frames, &mxu);
+}
+
+int mxu1_audio_resample_c(mxu1_audio_resampler *r, uint32_t *dst,
+                          const uint32_t *src, int frames)
+{
+  return resample(r, dst, src, frames, &ref);
+}
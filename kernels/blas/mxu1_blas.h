@@ -0,0 +1,202 @@
+// mxu1_blas.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 Q15/Q31 linear algebra: dot, AXPY, 4x4 transforms, GEMV, GEMM
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  16-bit fixed-point linear algebra for sensor fusion, control loops and
+// small inference layers:
+//   - dot products of Q15 vectors (d16mac, two lanes in two chains, summed
+//     by d32asum) and of Q31 vectors (s32madd into {HI:LO});
+//   - AXPY, y += a * x, on Q15 vectors;
+//   - a 4x4 matrix times a batch of 4-vectors (points, quaternions, state
+//     vectors), the matrix held in xr1..xr8 for the whole batch;
+//   - GEMV, y = A x, four rows per pass sharing every word of x loaded;
+//   - GEMM, C = A B, in tiles of 2 rows by 4 columns, each of the 8
+//     accumulators a single sum (d16mac LW/HW takes one element of A's word
+//     against a word of two of B's), over column blocks of B sized for L1.
+//
+// Arithmetic (identical in the C versions): products of 16-bit elements are
+// summed in 32 bits, wrapping, so a result is exact whenever its final sum
+// fits in int32_t, whatever the order of the terms: a Q15 dot product
+// returns the Q30 sum itself, exact for true values in -2 .. 2. The Q31
+// one returns the Q62 sum in 64 bits, wrapping likewise. A matrix output
+// (mat4, gemv, gemm) with matrix elements in Q'shift' (0 .. 15) is
+//     sat16((sum of a[i][j] * x[j] + 2^(shift - 1)) >> shift)
+// (no rounding term for shift 0), which cannot overflow while the sum of
+// |a[i][j]| over a row stays below 2^16 (below 2.0 in Q15), and AXPY is
+//     y[i] = sat16((y[i] * 2^15 + a * x[i] + 2^14) >> 15)
+// which never does. Shifts are arithmetic (round down); sat16() clamps to
+// -32768 .. 32767.
+//
+// Vectors and matrices are word aligned, and the leading dimensions lda,
+// ldb, ldc (in elements) even, so that every row is; lengths and sizes are
+// any. Each function has a C version (_c) with the same results. The
+// drivers in mxu1_blas_matrix.c are written once against a set of kernels,
+// those in mxu1_blas.s or their C twins in mxu1_blas_ref.c, and do the
+// edges the kernels leave (odd rows, the last columns of a GEMM) in C.
+// Outputs must not overlap inputs, except for mxu1_blas_mat4_apply(),
+// which may work in place.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/blas, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_blas.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_blas_ref.c
+//         mxu1_blas_matrix.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_BLAS_H
+#define MXU1_BLAS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  Bytes of the data cache a GEMM column block of B is sized to fill half
+// of (16 KB on the JZ4760 and X1000, 32 KB on the JZ4780)
+#ifndef MXU1_BLAS_L1_BYTES
+#define MXU1_BLAS_L1_BYTES      16384
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Vectors (mxu1_blas_matrix.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  The sum of x[i] * y[i], i = 0 .. n - 1: Q30 for Q15 vectors
+int32_t mxu1_blas_dot_q15(const int16_t *x, const int16_t *y, int n);
+int32_t mxu1_blas_dot_q15_c(const int16_t *x, const int16_t *y, int n);
+
+//  The same, Q62 for Q31 vectors
+int64_t mxu1_blas_dot_q31(const int32_t *x, const int32_t *y, int n);
+int64_t mxu1_blas_dot_q31_c(const int32_t *x, const int32_t *y, int n);
+
+//  y[i] += a * x[i], i = 0 .. n - 1, all Q15
+void mxu1_blas_axpy_q15(int16_t *y, int16_t a, const int16_t *x, int n);
+void mxu1_blas_axpy_q15_c(int16_t *y, int16_t a, const int16_t *x, int n);
+
+////////////////////////////////////////////////////////////////////////////////
+// 4x4 matrix times 4-vectors (mxu1_blas_matrix.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  The kernel's form of a matrix: its fraction bits, and each column in two
+// words, cols[2 c] = m[1][c] : m[0][c], cols[2 c + 1] = m[3][c] : m[2][c]
+// (high : low halfword)
+typedef struct {
+  int32_t  shift;
+  uint32_t cols[8];
+} mxu1_blas_mat4;
+
+//  The matrix a[r * 4 + c] (row-major) in Q'shift' (0 .. 15)
+void mxu1_blas_mat4_init(mxu1_blas_mat4 *m, const int16_t a[16], int shift);
+
+//  dst[v] = m src[v] for the 'count' 4-vectors (4 int16_t each) at src
+// (dst may be src)
+void mxu1_blas_mat4_apply(const mxu1_blas_mat4 *m, int16_t *dst,
+                          const int16_t *src, int count);
+void mxu1_blas_mat4_apply_c(const mxu1_blas_mat4 *m, int16_t *dst,
+                            const int16_t *src, int count);
+
+////////////////////////////////////////////////////////////////////////////////
+// Matrices (mxu1_blas_matrix.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  y = A x: A is m x n, row i at a + i * lda, in Q'shift' (0 .. 15); x has
+// n elements and y m
+void mxu1_blas_gemv_q15(int16_t *y, const int16_t *a, int lda,
+                        const int16_t *x, int m, int n, int shift);
+void mxu1_blas_gemv_q15_c(int16_t *y, const int16_t *a, int lda,
+                          const int16_t *x, int m, int n, int shift);
+
+//  C = A B: A is m x k (row i at a + i * lda), B k x n (row at b + ldb),
+// C m x n (row at c + ldc), the elements of A in Q'shift' (0 .. 15)
+void mxu1_blas_gemm_q15(int16_t *c, int ldc, const int16_t *a, int lda,
+                        const int16_t *b, int ldb, int m, int n, int k,
+                        int shift);
+void mxu1_blas_gemm_q15_c(int16_t *c, int ldc, const int16_t *a, int lda,
+                          const int16_t *b, int ldb, int m, int n, int k,
+                          int shift);
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels (mxu1_blas.s, C twins in mxu1_blas_ref.c), for the driver
+////////////////////////////////////////////////////////////////////////////////
+
+//  The kernels' arguments: counts, and strides in bytes
+typedef struct {
+  int32_t rows;                 // A multiple of 4
+  int32_t n;
+  int32_t lda;
+  int32_t shift;
+} mxu1_blas_gemv_args;
+
+typedef struct {
+  int32_t rows;                 // Even
+  int32_t cols;                 // A multiple of 4
+  int32_t k;                    // 1 or more
+  int32_t lda, ldb, ldc;
+  int32_t shift;
+} mxu1_blas_gemm_args;
+
+//  The wrapped sum over 'pairs' words of x and y (2 * pairs elements)
+int32_t mxu1_blas_dot_run(const int16_t *x, const int16_t *y, int32_t pairs);
+int32_t mxu1_blas_dot_run_c(const int16_t *x, const int16_t *y,
+                            int32_t pairs);
+
+//  The wrapped 64-bit sum over n elements
+int64_t mxu1_blas_dot32_run(const int32_t *x, const int32_t *y, int32_t n);
+int64_t mxu1_blas_dot32_run_c(const int32_t *x, const int32_t *y,
+                              int32_t n);
+
+//  AXPY over 'pairs' words of y and x
+void mxu1_blas_axpy_run(int16_t *y, const int16_t *x, int32_t pairs,
+                        int32_t a);
+void mxu1_blas_axpy_run_c(int16_t *y, const int16_t *x, int32_t pairs,
+                          int32_t a);
+
+void mxu1_blas_mat4_run(int16_t *dst, const int16_t *src, int32_t count,
+                        const mxu1_blas_mat4 *m);
+void mxu1_blas_mat4_run_c(int16_t *dst, const int16_t *src, int32_t count,
+                          const mxu1_blas_mat4 *m);
+
+//  y[0 .. g->rows - 1] over rows of g->n elements from a
+void mxu1_blas_gemv_run(int16_t *y, const int16_t *a, const int16_t *x,
+                        const mxu1_blas_gemv_args *g);
+void mxu1_blas_gemv_run_c(int16_t *y, const int16_t *a, const int16_t *x,
+                          const mxu1_blas_gemv_args *g);
+
+//  The g->rows x g->cols block of C at c, from the rows of A at a and the
+// columns of B at b
+void mxu1_blas_gemm_run(int16_t *c, const int16_t *a, const int16_t *b,
+                        const mxu1_blas_gemm_args *g);
+void mxu1_blas_gemm_run_c(int16_t *c, const int16_t *a, const int16_t *b,
+                          const mxu1_blas_gemm_args *g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_BLAS_H
@@ -0,0 +1,492 @@
+# mxu1_blas.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 Q15/Q31 linear algebra: dot, AXPY, 4x4 transforms, GEMV, GEMM
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, the structures and the arithmetic are described in
+# mxu1_blas.h. Elements are int16_t, two to a word, the lower-indexed one in
+# the low halfword. d16mac multiplies them lane by lane in two ways:
+#  - WW, a word of A's row against a word of x: element j's product into
+#    XRd and j + 1's into XRa, two partial sums of one output, added at the
+#    end by d32asum (dot, gemv);
+#  - LW/HW, one element of a word (the low or high one, in both lanes)
+#    against a word of two neighbouring outputs' coefficients: each lane
+#    the whole sum of its own output (mat4, gemm).
+#
+#  Accumulators start at the rounding bias (d32add from xr15) and are
+# clamped with s32max/s32min to the values that shift down into int16_t;
+# d32sarw then shifts two by the format's fraction bits and packs them into
+# a word of output.
+#
+#   dot_run:     two words of each vector per pass, in two accumulator pairs.
+#   dot32_run:   s32madd of each pair of elements into {HI:LO}.
+#   axpy_run:    two words per pass: y * 2^15 is a d16mac subtracting y
+#                times -32768 (0x8000), then a * x (a in both lanes).
+#   mat4_run:    the matrix's columns in xr1..xr8 for the whole batch: per
+#                vector, 2 loads, 8 d16mac (16 MACs) into rows 1:0 (xr11/
+#                xr12) and 3:2 (xr13/xr14), and 2 stores.
+#   gemv_run:    four rows per pass, each word of x loaded once for all four:
+#                per two columns, 5 loads and 4 d16mac (8 MACs).
+#   gemm_run:    a tile of 2 rows by 4 columns in xr1..xr8 (row i columns
+#                j + 1 : j in xr1/xr2, j + 3 : j + 2 in xr3/xr4, row i + 1 in
+#                xr5..xr8); per two steps of k, a word of each row of A
+#                (xr9/xr10) and two of each of two rows of B (xr11..xr14):
+#                6 loads and 8 d16mac (16 MACs).
+#
+# Register use: any xr, $v0, $v1, $t0..$t9, $a0..$a3, HI/LO. Leaf functions,
+# no stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# mxu1_blas_mat4 field offsets
+  .equ    M_SHIFT,        0
+  .equ    M_COLS,         4
+
+# mxu1_blas_gemv_args and mxu1_blas_gemm_args field offsets
+  .equ    GV_ROWS,        0
+  .equ    GV_N,           4
+  .equ    GV_LDA,         8
+  .equ    GV_SHIFT,       12
+  .equ    GM_ROWS,        0
+  .equ    GM_COLS,        4
+  .equ    GM_K,           8
+  .equ    GM_LDA,         12
+  .equ    GM_LDB,         16
+  .equ    GM_LDC,         20
+  .equ    GM_SHIFT,       24
+
+
+################################################################################
+#  xr15 = rounding bias, $v0/$v1 = smallest/largest accumulator that shifts
+# into int16_t, for a shift of \s (a GPR, 0..15)
+.macro LIMITS s
+  li      $v0,  1
+  sllv    $v0,  $v0,  \s
+  srl     $v0,  $v0,  1
+  s32i2m  xr15, $v0
+  li      $v0,  -32768
+  sllv    $v0,  $v0,  \s
+  nor     $v1,  $v0,  $zero
+.endm
+
+#  Clamps the accumulator pair \a/\d to \lo..\hi and shifts both by \s into
+# the word \out
+.macro SATURATE out, a, d, s, lo, hi
+  s32max  \a,   \a,   \lo
+  s32max  \d,   \d,   \lo
+  s32min  \a,   \a,   \hi
+  s32min  \d,   \d,   \hi
+  d32sarw \out, \a,   \d,   \s
+.endm
+
+
+################################################################################
+# int32_t mxu1_blas_dot_run(const int16_t *x, const int16_t *y, int32_t pairs)
+#
+#  xr1/xr2 and xr3/xr4 accumulate alternate words, then all four are added.
+  .globl  mxu1_blas_dot_run
+  .type   mxu1_blas_dot_run, @function
+  .ent    mxu1_blas_dot_run
+mxu1_blas_dot_run:
+  d32add  xr1,  xr0,  xr0,  xr2,  AA
+  d32add  xr3,  xr0,  xr0,  xr4,  AA
+  addiu   $a0,  $a0,  -4
+  addiu   $a1,  $a1,  -4
+  srl     $t0,  $a2,  1                   # Pairs of words
+  beqz    $t0,  2f
+  andi    $a2,  $a2,  1
+
+1:                                        # Two words
+  s32ldi  xr5,  $a0,  4
+  s32ldi  xr6,  $a1,  4
+  s32ldi  xr7,  $a0,  4
+  d16mac  xr1,  xr5,  xr6,  xr2,  AA, WW
+  s32ldi  xr8,  $a1,  4
+  addiu   $t0,  $t0,  -1
+  bnez    $t0,  1b
+  d16mac  xr3,  xr7,  xr8,  xr4,  AA, WW
+
+2:
+  beqz    $a2,  3f
+  nop
+  s32ldi  xr5,  $a0,  4                   # The odd last word
+  s32ldi  xr6,  $a1,  4
+  d16mac  xr1,  xr5,  xr6,  xr2,  AA, WW
+
+3:
+  d32asum xr1,  xr3,  xr4,  xr2,  AA
+  d32add  xr1,  xr1,  xr2,  xr0,  AA
+  jr      $ra
+  s32m2i  xr1,  $v0
+  .end    mxu1_blas_dot_run
+  .size   mxu1_blas_dot_run, .-mxu1_blas_dot_run
+
+
+################################################################################
+# int64_t mxu1_blas_dot32_run(const int32_t *x, const int32_t *y, int32_t n)
+#
+#  {HI:LO} is the sum (returned in $v1:$v0), xr1:xr2 a copy s32madd keeps.
+  .globl  mxu1_blas_dot32_run
+  .type   mxu1_blas_dot32_run, @function
+  .ent    mxu1_blas_dot32_run
+mxu1_blas_dot32_run:
+  blez    $a2,  9f
+  mult    $zero, $zero
+
+1:                                        # One element
+  lw      $t0,  0($a0)
+  lw      $t1,  0($a1)
+  addiu   $a0,  $a0,  4
+  addiu   $a2,  $a2,  -1
+  addiu   $a1,  $a1,  4
+  bnez    $a2,  1b
+  s32madd xr1,  xr2,  $t0,  $t1
+
+9:
+  mflo    $v0
+  jr      $ra
+  mfhi    $v1
+  .end    mxu1_blas_dot32_run
+  .size   mxu1_blas_dot32_run, .-mxu1_blas_dot32_run
+
+
+################################################################################
+# void mxu1_blas_axpy_run(int16_t *y, const int16_t *x, int32_t pairs,
+#                         int32_t a)
+#
+#  xr11 = a in both halves, xr12 = -32768 in both, xr13/xr14 the limits for
+# Q15; one word in xr1..xr5 (x, y, the sums, the result), the next in
+# xr6..xr10. $t8 loads y and $a0 stores it.
+  .globl  mxu1_blas_axpy_run
+  .type   mxu1_blas_axpy_run, @function
+  .ent    mxu1_blas_axpy_run
+mxu1_blas_axpy_run:
+  li      $t2,  15
+  LIMITS  $t2
+  s32i2m  xr13, $v0
+  s32i2m  xr14, $v1
+  andi    $t0,  $a3,  0xffff
+  sll     $t1,  $t0,  16
+  or      $t0,  $t0,  $t1
+  s32i2m  xr11, $t0
+  lui     $t0,  0x8000
+  ori     $t0,  $t0,  0x8000
+  s32i2m  xr12, $t0
+  addiu   $a0,  $a0,  -4
+  addiu   $a1,  $a1,  -4
+  move    $t8,  $a0
+  srl     $t0,  $a2,  1                   # Pairs of words
+  beqz    $t0,  2f
+  andi    $a2,  $a2,  1
+
+1:                                        # Two words
+  s32ldi  xr1,  $a1,  4
+  s32ldi  xr2,  $t8,  4
+  d32add  xr3,  xr15, xr0,  xr4,  AA
+  s32ldi  xr6,  $a1,  4
+  d16mac  xr3,  xr2,  xr12, xr4,  SS, WW  # + y * 2^15
+  s32ldi  xr7,  $t8,  4
+  d32add  xr8,  xr15, xr0,  xr9,  AA
+  d16mac  xr3,  xr11, xr1,  xr4,  AA, WW  # + a * x
+  d16mac  xr8,  xr7,  xr12, xr9,  SS, WW
+  d16mac  xr8,  xr11, xr6,  xr9,  AA, WW
+  SATURATE xr5, xr3, xr4, $t2, xr13, xr14
+  SATURATE xr10, xr8, xr9, $t2, xr13, xr14
+  addiu   $t0,  $t0,  -1
+  s32sdi  xr5,  $a0,  4
+  bnez    $t0,  1b
+  s32sdi  xr10, $a0,  4
+
+2:
+  beqz    $a2,  9f
+  nop
+  s32ldi  xr1,  $a1,  4                   # The odd last word
+  s32ldi  xr2,  $t8,  4
+  d32add  xr3,  xr15, xr0,  xr4,  AA
+  d16mac  xr3,  xr2,  xr12, xr4,  SS, WW
+  d16mac  xr3,  xr11, xr1,  xr4,  AA, WW
+  SATURATE xr5, xr3, xr4, $t2, xr13, xr14
+  s32sdi  xr5,  $a0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_blas_axpy_run
+  .size   mxu1_blas_axpy_run, .-mxu1_blas_axpy_run
+
+
+################################################################################
+# void mxu1_blas_mat4_run(int16_t *dst, const int16_t *src, int32_t count,
+#                         const mxu1_blas_mat4 *m)
+#
+#  xr1..xr8 = the matrix's columns, xr9/xr10 the vector (v1 : v0, v3 : v2),
+# then the limits once its products are in.
+  .globl  mxu1_blas_mat4_run
+  .type   mxu1_blas_mat4_run, @function
+  .ent    mxu1_blas_mat4_run
+mxu1_blas_mat4_run:
+  lw      $t2,  M_SHIFT($a3)
+  LIMITS  $t2
+  s32ldd  xr1,  $a3,  M_COLS
+  s32ldd  xr2,  $a3,  M_COLS + 4
+  s32ldd  xr3,  $a3,  M_COLS + 8
+  s32ldd  xr4,  $a3,  M_COLS + 12
+  s32ldd  xr5,  $a3,  M_COLS + 16
+  s32ldd  xr6,  $a3,  M_COLS + 20
+  s32ldd  xr7,  $a3,  M_COLS + 24
+  s32ldd  xr8,  $a3,  M_COLS + 28
+  addiu   $a0,  $a0,  -4
+  blez    $a2,  9f
+  addiu   $a1,  $a1,  -4
+
+1:                                        # One vector
+  s32ldi  xr9,  $a1,  4
+  s32ldi  xr10, $a1,  4
+  d32add  xr11, xr15, xr0,  xr12, AA
+  d32add  xr13, xr15, xr0,  xr14, AA
+  d16mac  xr11, xr9,  xr1,  xr12, AA, LW  # v0 * column 0
+  d16mac  xr13, xr9,  xr2,  xr14, AA, LW
+  d16mac  xr11, xr9,  xr3,  xr12, AA, HW  # v1 * column 1
+  d16mac  xr13, xr9,  xr4,  xr14, AA, HW
+  d16mac  xr11, xr10, xr5,  xr12, AA, LW  # v2 * column 2
+  d16mac  xr13, xr10, xr6,  xr14, AA, LW
+  d16mac  xr11, xr10, xr7,  xr12, AA, HW  # v3 * column 3
+  d16mac  xr13, xr10, xr8,  xr14, AA, HW
+  s32i2m  xr9,  $v0
+  s32i2m  xr10, $v1
+  SATURATE xr11, xr11, xr12, $t2, xr9, xr10
+  SATURATE xr13, xr13, xr14, $t2, xr9, xr10
+  addiu   $a2,  $a2,  -1
+  s32sdi  xr11, $a0,  4
+  bnez    $a2,  1b
+  s32sdi  xr13, $a0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_blas_mat4_run
+  .size   mxu1_blas_mat4_run, .-mxu1_blas_mat4_run
+
+
+################################################################################
+# void mxu1_blas_gemv_run(int16_t *y, const int16_t *a, const int16_t *x,
+#                         const mxu1_blas_gemv_args *g)
+#
+#  Rows i .. i + 3 are walked by $t6..$t9 and x by $a3 (g's fields are in
+# $t0..$t3 by then), into the pairs xr1/xr2 .. xr7/xr8, the odd columns'
+# sums in the first of each. Two rows' odd sums start at the bias, which
+# d32add sets in one go. An odd last column is one s16ldd of each, x's into
+# a cleared word, so that the high lanes add nothing.
+  .globl  mxu1_blas_gemv_run
+  .type   mxu1_blas_gemv_run, @function
+  .ent    mxu1_blas_gemv_run
+mxu1_blas_gemv_run:
+  lw      $t0,  GV_ROWS($a3)
+  lw      $t1,  GV_N($a3)
+  lw      $t2,  GV_LDA($a3)
+  lw      $t3,  GV_SHIFT($a3)
+  LIMITS  $t3
+  s32i2m  xr13, $v0
+  s32i2m  xr14, $v1
+  srl     $t4,  $t1,  1                   # Pairs of columns
+  andi    $t5,  $t1,  1
+  blez    $t0,  9f
+  addiu   $a0,  $a0,  -4
+
+1:                                        # Four rows
+  addiu   $t6,  $a1,  -4
+  addu    $t7,  $t6,  $t2
+  addu    $t8,  $t7,  $t2
+  addu    $t9,  $t8,  $t2
+  addiu   $a3,  $a2,  -4
+  d32add  xr1,  xr15, xr0,  xr3,  AA
+  d32add  xr5,  xr15, xr0,  xr7,  AA
+  d32add  xr2,  xr0,  xr0,  xr4,  AA
+  d32add  xr6,  xr0,  xr0,  xr8,  AA
+  beqz    $t4,  3f
+  move    $v0,  $t4
+
+2:                                        # Two columns
+  s32ldi  xr9,  $a3,  4                   # x[j + 1] : x[j]
+  s32ldi  xr10, $t6,  4
+  s32ldi  xr11, $t7,  4
+  s32ldi  xr12, $t8,  4
+  d16mac  xr1,  xr10, xr9,  xr2,  AA, WW
+  s32ldi  xr10, $t9,  4
+  d16mac  xr3,  xr11, xr9,  xr4,  AA, WW
+  addiu   $v0,  $v0,  -1
+  d16mac  xr5,  xr12, xr9,  xr6,  AA, WW
+  bnez    $v0,  2b
+  d16mac  xr7,  xr10, xr9,  xr8,  AA, WW
+
+3:
+  beqz    $t5,  4f
+  s32i2m  xr9,  $zero
+  s16ldd  xr9,  $a3,  4,  0               # The odd last column
+  s16ldd  xr10, $t6,  4,  0
+  s16ldd  xr11, $t7,  4,  0
+  s16ldd  xr12, $t8,  4,  0
+  d16mac  xr1,  xr10, xr9,  xr2,  AA, WW
+  s16ldd  xr10, $t9,  4,  0
+  d16mac  xr3,  xr11, xr9,  xr4,  AA, WW
+  d16mac  xr5,  xr12, xr9,  xr6,  AA, WW
+  d16mac  xr7,  xr10, xr9,  xr8,  AA, WW
+
+4:
+  d32asum xr1,  xr2,  xr4,  xr3,  AA      # Rows i, i + 1
+  d32asum xr5,  xr6,  xr8,  xr7,  AA      # Rows i + 2, i + 3
+  SATURATE xr9, xr3, xr1, $t3, xr13, xr14
+  SATURATE xr10, xr7, xr5, $t3, xr13, xr14
+  sll     $v0,  $t2,  2
+  addu    $a1,  $a1,  $v0
+  addiu   $t0,  $t0,  -4
+  s32sdi  xr9,  $a0,  4
+  bgtz    $t0,  1b
+  s32sdi  xr10, $a0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_blas_gemv_run
+  .size   mxu1_blas_gemv_run, .-mxu1_blas_gemv_run
+
+
+################################################################################
+# void mxu1_blas_gemm_run(int16_t *c, const int16_t *a, const int16_t *b,
+#                         const mxu1_blas_gemm_args *g)
+#
+#  Per pair of rows, the tiles go left to right: $a0 and $a2 step through C
+# and B by 4 columns, $a1 stays at the rows of A. In a tile, $t6/$t7 walk
+# the two rows of A, $t8/$t2 rows k and k + 1 of B, by $t3 = 2 ldb (s32ldiv),
+# and $t9 counts pairs of k; an odd last k takes one more step, from the low
+# halves of s16ldd. $t4 = ldc, $t5 = shift, $t0/$t1 count rows and tiles;
+# the rest of g is read from it as needed. The limits go in xr9/xr10 once
+# A is done with them.
+  .globl  mxu1_blas_gemm_run
+  .type   mxu1_blas_gemm_run, @function
+  .ent    mxu1_blas_gemm_run
+mxu1_blas_gemm_run:
+  lw      $t0,  GM_ROWS($a3)
+  lw      $t3,  GM_LDB($a3)
+  lw      $t4,  GM_LDC($a3)
+  lw      $t5,  GM_SHIFT($a3)
+  LIMITS  $t5
+  blez    $t0,  9f
+  sll     $t3,  $t3,  1
+
+1:                                        # Two rows
+  lw      $t1,  GM_COLS($a3)
+  srl     $t1,  $t1,  2
+
+2:                                        # A tile: 2 rows, 4 columns
+  lw      $t9,  GM_LDA($a3)
+  addiu   $t6,  $a1,  -4
+  addu    $t7,  $t6,  $t9
+  lw      $t9,  GM_LDB($a3)
+  subu    $t8,  $a2,  $t3
+  addu    $t2,  $t8,  $t9
+  lw      $t9,  GM_K($a3)
+  d32add  xr1,  xr15, xr0,  xr2,  AA
+  d32add  xr3,  xr15, xr0,  xr4,  AA
+  d32add  xr5,  xr15, xr0,  xr6,  AA
+  d32add  xr7,  xr15, xr0,  xr8,  AA
+  srl     $t9,  $t9,  1
+  beqz    $t9,  4f
+  nop
+
+3:                                        # Two steps of k
+  s32ldi  xr9,  $t6,  4                   # a[i][k + 1] : a[i][k]
+  s32ldiv xr11, $t8,  $t3,  0             # b[k][j + 1] : b[k][j]
+  s32ldi  xr10, $t7,  4
+  s32ldd  xr12, $t8,  4                   # b[k][j + 3] : b[k][j + 2]
+  d16mac  xr1,  xr9,  xr11, xr2,  AA, LW
+  s32ldiv xr13, $t2,  $t3,  0             # Row k + 1
+  d16mac  xr3,  xr9,  xr12, xr4,  AA, LW
+  s32ldd  xr14, $t2,  4
+  d16mac  xr5,  xr10, xr11, xr6,  AA, LW
+  addiu   $t9,  $t9,  -1
+  d16mac  xr7,  xr10, xr12, xr8,  AA, LW
+  d16mac  xr1,  xr9,  xr13, xr2,  AA, HW
+  d16mac  xr3,  xr9,  xr14, xr4,  AA, HW
+  d16mac  xr5,  xr10, xr13, xr6,  AA, HW
+  bnez    $t9,  3b
+  d16mac  xr7,  xr10, xr14, xr8,  AA, HW
+
+4:
+  lw      $t9,  GM_K($a3)
+  andi    $t9,  $t9,  1
+  beqz    $t9,  5f
+  nop
+  s16ldd  xr9,  $t6,  4,  0               # The odd last k
+  s32ldiv xr11, $t8,  $t3,  0
+  s16ldd  xr10, $t7,  4,  0
+  s32ldd  xr12, $t8,  4
+  d16mac  xr1,  xr9,  xr11, xr2,  AA, LW
+  d16mac  xr3,  xr9,  xr12, xr4,  AA, LW
+  d16mac  xr5,  xr10, xr11, xr6,  AA, LW
+  d16mac  xr7,  xr10, xr12, xr8,  AA, LW
+
+5:
+  s32i2m  xr9,  $v0
+  s32i2m  xr10, $v1
+  SATURATE xr11, xr1, xr2, $t5, xr9, xr10
+  SATURATE xr12, xr3, xr4, $t5, xr9, xr10
+  SATURATE xr13, xr5, xr6, $t5, xr9, xr10
+  SATURATE xr14, xr7, xr8, $t5, xr9, xr10
+  addu    $t6,  $a0,  $t4
+  s32std  xr11, $a0,  0
+  s32std  xr12, $a0,  4
+  s32std  xr13, $t6,  0
+  s32std  xr14, $t6,  4
+  addiu   $a0,  $a0,  8
+  addiu   $t1,  $t1,  -1
+  bnez    $t1,  2b
+  addiu   $a2,  $a2,  8
+
+  lw      $t9,  GM_COLS($a3)              # Back to the left, two rows down
+  lw      $t6,  GM_LDA($a3)
+  sll     $t9,  $t9,  1
+  subu    $a0,  $a0,  $t9
+  subu    $a2,  $a2,  $t9
+  sll     $t7,  $t4,  1
+  addu    $a0,  $a0,  $t7
+  sll     $t6,  $t6,  1
+  addu    $a1,  $a1,  $t6
+  addiu   $t0,  $t0,  -2
+  bgtz    $t0,  1b
+  nop
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_blas_gemm_run
+  .size   mxu1_blas_gemm_run, .-mxu1_blas_gemm_run
+
+# vim:shiftwidth=2:expandtab:syntax=asm
@@ -0,0 +1,341 @@
+// mxu1_blas_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 Q15/Q31 linear algebra: checks, accuracy against double and MMAC/s
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Checks every function in mxu1_blas.h against its _c version on random,
+// full-scale (every element -32768 or 32767) and small elements, of many
+// sizes, shifts and leading dimensions; checks the results against the
+// same products in double (every output within half a step of the exact
+// value, clamped; the dot products exact); then prints millions of MACs
+// per second, and the GOP/s equivalent (a MAC being two operations), for
+// the MXU and C versions at sizes of a sensor fusion step and of a small
+// network layer.
+//
+// Build and run on the target (kernels/blas):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_blas_bench
+//         mxu1_blas_bench.c mxu1_blas_matrix.c mxu1_blas_ref.c mxu1_blas.s
+//         ../dispatch/mxu1_cpu.c
+//     ./mxu1_blas_bench [seconds per test, default 1]
+// Exits non-zero if any result differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_blas.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+//  An element: random, full scale, or small (-1000 .. 1000)
+static int16_t element(int fill)
+{
+  return fill == 0 ? (int16_t)rand16() :
+         fill == 1 ? (rand16() & 1 ? 32767 : -32768) :
+         (int16_t)(rand16() % 2001 - 1000);
+}
+
+static void randomize(int16_t *p, int n, int fill)
+{
+  for (int i = 0; i < n; ++i)
+    p[i] = element(fill);
+}
+
+enum { M = 128, MAXN = 4096 };
+
+static int16_t va[MAXN + 8], vb[MAXN + 8], vc[MAXN + 8], vd[MAXN + 8];
+static int16_t ma[M * (M + 4)], mb[M * (M + 4)], mc[M * (M + 4)],
+               md[M * (M + 4)];
+
+static int failed;
+
+static void mismatch(const char *what, int m, int n, int k)
+{
+  printf("%-6s %d x %d x %d: MISMATCH\n", what, m, n, k);
+  failed = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Against double
+////////////////////////////////////////////////////////////////////////////////
+
+static double max_err[5];
+enum { E_DOT, E_AXPY, E_MAT4, E_GEMV, E_GEMM };
+
+//  How far the output 'got' is from sum / 2^shift, clamped to int16_t, in
+// steps; unless sum (with the rounding term) is outside int32_t, where the
+// result is not defined
+static void error(int which, int16_t got, double sum, int shift)
+{
+  double v = ldexp(sum, -shift), e;
+  if (fabs(sum + (shift ? ldexp(1, shift - 1) : 0)) >= 2147483648.0)
+    return;
+  v = v < -32768 ? -32768 : v > 32767 ? 32767 : v;
+  e = fabs(got - v);
+  if (e > max_err[which])
+    max_err[which] = e;
+}
+
+static void accuracy(int fill)
+{
+  const int n = 1 + rand16() % 300, shift = rand16() % 16;
+  double s = 0;
+  int16_t a;
+
+  randomize(va, n, fill);
+  randomize(vb, n, fill);
+  for (int i = 0; i < n; ++i)
+    s += (double)va[i] * vb[i];
+  if (fabs(s) < 2147483648.0 && mxu1_blas_dot_q15(va, vb, n) != s)
+    max_err[E_DOT] = 1;
+
+  a = element(fill);
+  memcpy(vc, vb, n * sizeof(*vc));
+  mxu1_blas_axpy_q15(vc, a, va, n);
+  for (int i = 0; i < n; ++i)
+    error(E_AXPY, vc[i], ldexp(vb[i], 15) + (double)a * va[i], 15);
+
+  {
+    mxu1_blas_mat4 m;
+    const int count = n / 4;
+    randomize(vd, 16, fill);
+    mxu1_blas_mat4_init(&m, vd, shift);
+    mxu1_blas_mat4_apply(&m, vc, va, count);
+    for (int v = 0; v < count; ++v)
+      for (int r = 0; r < 4; ++r) {
+        s = 0;
+        for (int c = 0; c < 4; ++c)
+          s += (double)vd[r * 4 + c] * va[v * 4 + c];
+        error(E_MAT4, vc[v * 4 + r], s, shift);
+      }
+  }
+
+  {
+    const int m = 1 + rand16() % 40, k = 1 + rand16() % 60, c = 1 + rand16() % 40;
+    const int lda = (k + 1) & ~1, ldb = (c + 1) & ~1;
+    randomize(ma, m * lda, fill);
+    randomize(mb, k * ldb, fill);
+    randomize(va, k, fill);
+    mxu1_blas_gemv_q15(vc, ma, lda, va, m, k, shift);
+    mxu1_blas_gemm_q15(mc, ldb, ma, lda, mb, ldb, m, c, k, shift);
+    for (int i = 0; i < m; ++i) {
+      s = 0;
+      for (int j = 0; j < k; ++j)
+        s += (double)ma[i * lda + j] * va[j];
+      error(E_GEMV, vc[i], s, shift);
+      for (int j = 0; j < c; ++j) {
+        s = 0;
+        for (int l = 0; l < k; ++l)
+          s += (double)ma[i * lda + l] * mb[l * ldb + j];
+        error(E_GEMM, mc[i * ldb + j], s, shift);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MXU against C
+////////////////////////////////////////////////////////////////////////////////
+
+static void cross_check(int fill, int t)
+{
+  const int n = t < 40 ? t : (int)(rand16() % (t % 5 ? 300 : MAXN));
+  const int shift = rand16() % 16;
+
+  randomize(va, n + 8, fill);
+  randomize(vb, n + 8, fill);
+  if (mxu1_blas_dot_q15(va, vb, n) != mxu1_blas_dot_q15_c(va, vb, n))
+    mismatch("dot", 1, n, 1);
+  if (mxu1_blas_dot_q31((const int32_t *)va, (const int32_t *)vb, n / 2) !=
+      mxu1_blas_dot_q31_c((const int32_t *)va, (const int32_t *)vb, n / 2))
+    mismatch("dot32", 1, n / 2, 1);
+
+  {
+    const int16_t a = element(fill);
+    memcpy(vc, vb, sizeof(vc));
+    memcpy(vd, vb, sizeof(vd));
+    mxu1_blas_axpy_q15(vc, a, va, n);
+    mxu1_blas_axpy_q15_c(vd, a, va, n);
+    if (memcmp(vc, vd, sizeof(vc)))
+      mismatch("axpy", 1, n, 1);
+  }
+
+  {
+    mxu1_blas_mat4 m;
+    const int count = n / 4;
+    mxu1_blas_mat4_init(&m, vb, shift);
+    memset(vc, 0x55, sizeof(vc));
+    memset(vd, 0x55, sizeof(vd));
+    mxu1_blas_mat4_apply(&m, vc, va, count);
+    mxu1_blas_mat4_apply_c(&m, vd, va, count);
+    if (memcmp(vc, vd, sizeof(vc)))
+      mismatch("mat4", 4, count, 4);
+    memcpy(vc, va, sizeof(vc));
+    mxu1_blas_mat4_apply(&m, vc, vc, count);
+    if (memcmp(vc, vd, count * 4 * sizeof(*vc)))
+      mismatch("mat4 in place", 4, count, 4);
+  }
+
+  {
+    const int m = 1 + rand16() % (t < 100 ? 9 : M), k = rand16() % (t < 100 ? 9 : M);
+    const int c = rand16() % (t < 100 ? 9 : M);
+    const int lda = (k + 1 + rand16() % 4) & ~1, ldb = (c + 1 + rand16() % 4) & ~1;
+    const int ldc = (c + 1 + rand16() % 4) & ~1;
+    randomize(ma, m * lda, fill);
+    randomize(mb, k * ldb, fill);
+    memset(mc, 0x55, sizeof(mc));
+    memset(md, 0x55, sizeof(md));
+    mxu1_blas_gemm_q15(mc, ldc, ma, lda, mb, ldb, m, c, k, shift);
+    mxu1_blas_gemm_q15_c(md, ldc, ma, lda, mb, ldb, m, c, k, shift);
+    if (memcmp(mc, md, sizeof(mc)))
+      mismatch("gemm", m, c, k);
+    memset(vc, 0x55, sizeof(vc));
+    memset(vd, 0x55, sizeof(vd));
+    mxu1_blas_gemv_q15(vc, ma, lda, va, m, k, shift);
+    mxu1_blas_gemv_q15_c(vd, ma, lda, va, m, k, shift);
+    if (memcmp(vc, vd, sizeof(vc)))
+      mismatch("gemv", m, k, 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Speed
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum { DOT, DOT32, AXPY, MAT4, GEMV, GEMM } function;
+
+typedef struct {
+  function f;
+  const char *name;
+  int m, n, k;                  // GEMM sizes; n alone for the vectors
+} test;
+
+static const test tests[] = {
+  { DOT,   "dot q15 4096",       1, 4096, 1 },
+  { DOT32, "dot q31 2048",       1, 2048, 1 },
+  { AXPY,  "axpy q15 4096",      1, 4096, 1 },
+  { MAT4,  "mat4 x 1024 vec",    4, 1024, 4 },
+  { GEMV,  "gemv 12 x 12",       12, 12, 1 },
+  { GEMV,  "gemv 128 x 128",     M, M, 1 },
+  { GEMM,  "gemm 12x12x12",      12, 12, 12 },
+  { GEMM,  "gemm 64x64x64",      64, 64, 64 },
+  { GEMM,  "gemm 128x128x128",   M, M, M },
+};
+
+static void run(const test *t, int c)
+{
+  switch (t->f) {
+    case DOT:
+      (c ? mxu1_blas_dot_q15_c : mxu1_blas_dot_q15)(va, vb, t->n);
+      break;
+    case DOT32:
+      (c ? mxu1_blas_dot_q31_c : mxu1_blas_dot_q31)(
+          (const int32_t *)va, (const int32_t *)vb, t->n);
+      break;
+    case AXPY:
+      (c ? mxu1_blas_axpy_q15_c : mxu1_blas_axpy_q15)(vc, 1000, va, t->n);
+      break;
+    case MAT4: {
+      mxu1_blas_mat4 m;
+      mxu1_blas_mat4_init(&m, vb, 14);
+      (c ? mxu1_blas_mat4_apply_c : mxu1_blas_mat4_apply)(&m, vc, va, t->n);
+      break;
+    }
+    case GEMV:
+      (c ? mxu1_blas_gemv_q15_c : mxu1_blas_gemv_q15)(vc, ma, t->n, va, t->m,
+                                                      t->n, 15);
+      break;
+    default:
+      (c ? mxu1_blas_gemm_q15_c : mxu1_blas_gemm_q15)(
+          mc, t->n, ma, t->k, mb, t->n, t->m, t->n, t->k, 15);
+      break;
+  }
+}
+
+//  Millions of MACs per second
+static double mmacs(const test *t, int c, double secs)
+{
+  const double macs = (double)t->m * t->n * t->k;
+  unsigned long k = 0;
+  double t0 = now(), dt;
+
+  do {
+    run(t, c);
+    ++k;
+    dt = now() - t0;
+  } while (dt < secs);
+  return k * macs / dt * 1e-6;
+}
+
+int main(int argc, char **argv)
+{
+  static const char *const names[] = { "dot", "axpy", "mat4", "gemv", "gemm" };
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+
+  mxu1_cpu_enable();
+
+  for (int fill = 0; fill < 3; ++fill)
+    for (int t = 0; t < 400; ++t) {
+      cross_check(fill, t);
+      accuracy(fill);
+    }
+  printf("Largest error against double, in output steps:\n");
+  for (int i = 0; i < 5; ++i) {
+    printf("  %-6s %.3f\n", names[i], max_err[i]);
+    if (max_err[i] > (i == E_DOT ? 0 : 0.5)) {
+      printf("  %s: ERROR TOO LARGE\n", names[i]);
+      failed = 1;
+    }
+  }
+
+  randomize(va, MAXN, 2);
+  randomize(vb, MAXN, 2);
+  randomize(ma, M * M, 2);
+  randomize(mb, M * M, 2);
+  printf("%-20s    MMAC/s: MXU        C  (MXU vs C)   GOP/s: MXU\n", "");
+  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+    const double m = mmacs(&tests[i], 0, secs);
+    const double c = mmacs(&tests[i], 1, secs);
+    printf("  %-20s %13.1f %8.1f  x%.2f %14.3f\n", tests[i].name, m, c,
+           m / c, m * 2e-3);
+  }
+  return failed;
+}
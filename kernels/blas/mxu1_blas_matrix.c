@@ -0,0 +1,226 @@
+// mxu1_blas_matrix.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 Q15/Q31 vector and matrix drivers, edges and GEMM blocking
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The kernels take whole words of every row, and GEMV four rows and GEMM
+// two rows by four columns at a time; the drivers give them the largest
+// part of each call that fits, and do the rest here, an element at a time:
+// an odd last element of a vector, the last m % 4 rows of a GEMV (each a
+// dot product), and the last row and n % 4 columns of a GEMM.
+//
+//  A GEMM runs in column blocks: B's k x nb block stays in L1 while every
+// pair of rows of A goes through it, nb the most columns (a multiple of 4)
+// whose block fills half of MXU1_BLAS_L1_BYTES, the rest left to A's rows
+// and C's.
+//
+//  The driver is written once, against a set of kernels, so that the _c
+// functions are the same computation with the C kernels throughout.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_blas.h"
+
+typedef struct {
+  int32_t (*dot)(const int16_t *, const int16_t *, int32_t);
+  int64_t (*dot32)(const int32_t *, const int32_t *, int32_t);
+  void    (*axpy)(int16_t *, const int16_t *, int32_t, int32_t);
+  void    (*mat4)(int16_t *, const int16_t *, int32_t,
+                  const mxu1_blas_mat4 *);
+  void    (*gemv)(int16_t *, const int16_t *, const int16_t *,
+                  const mxu1_blas_gemv_args *);
+  void    (*gemm)(int16_t *, const int16_t *, const int16_t *,
+                  const mxu1_blas_gemm_args *);
+} kernels;
+
+static const kernels mxu = {
+  mxu1_blas_dot_run, mxu1_blas_dot32_run, mxu1_blas_axpy_run,
+  mxu1_blas_mat4_run, mxu1_blas_gemv_run, mxu1_blas_gemm_run
+};
+
+static const kernels ref = {
+  mxu1_blas_dot_run_c, mxu1_blas_dot32_run_c, mxu1_blas_axpy_run_c,
+  mxu1_blas_mat4_run_c, mxu1_blas_gemv_run_c, mxu1_blas_gemm_run_c
+};
+
+//  A sum of the given shift's rounding term and products, clamped to what
+// shifts into int16_t, shifted
+static int16_t saturate(uint32_t sum, int shift)
+{
+  const int32_t lo = (int32_t)((uint32_t)-32768 << shift), hi = ~lo;
+  int32_t v = (int32_t)(sum + (shift ? 1u << (shift - 1) : 0));
+  v = v < lo ? lo : v > hi ? hi : v;
+  return (int16_t)(v >> shift);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Vectors
+////////////////////////////////////////////////////////////////////////////////
+
+static int32_t dot(const int16_t *x, const int16_t *y, int n,
+                   const kernels *k)
+{
+  uint32_t s = (uint32_t)k->dot(x, y, n / 2);
+  if (n & 1)
+    s += (uint32_t)(x[n - 1] * y[n - 1]);
+  return (int32_t)s;
+}
+
+int32_t mxu1_blas_dot_q15(const int16_t *x, const int16_t *y, int n)
+{
+  return dot(x, y, n, &mxu);
+}
+
+int32_t mxu1_blas_dot_q15_c(const int16_t *x, const int16_t *y, int n)
+{
+  return dot(x, y, n, &ref);
+}
+
+int64_t mxu1_blas_dot_q31(const int32_t *x, const int32_t *y, int n)
+{
+  return mxu.dot32(x, y, n);
+}
+
+int64_t mxu1_blas_dot_q31_c(const int32_t *x, const int32_t *y, int n)
+{
+  return ref.dot32(x, y, n);
+}
+
+static void axpy(int16_t *y, int16_t a, const int16_t *x, int n,
+                 const kernels *k)
+{
+  if (n <= 0)
+    return;
+  k->axpy(y, x, n / 2, a);
+  if (n & 1)
+    y[n - 1] = saturate(((uint32_t)y[n - 1] << 15) +
+                        (uint32_t)(a * x[n - 1]), 15);
+}
+
+void mxu1_blas_axpy_q15(int16_t *y, int16_t a, const int16_t *x, int n)
+{
+  axpy(y, a, x, n, &mxu);
+}
+
+void mxu1_blas_axpy_q15_c(int16_t *y, int16_t a, const int16_t *x, int n)
+{
+  axpy(y, a, x, n, &ref);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 4x4 matrix times 4-vectors
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_blas_mat4_init(mxu1_blas_mat4 *m, const int16_t a[16], int shift)
+{
+  m->shift = shift;
+  for (int c = 0; c < 4; ++c)
+    for (int r = 0; r < 4; r += 2)
+      m->cols[2 * c + r / 2] = (uint32_t)(uint16_t)a[(r + 1) * 4 + c] << 16 |
+                               (uint16_t)a[r * 4 + c];
+}
+
+void mxu1_blas_mat4_apply(const mxu1_blas_mat4 *m, int16_t *dst,
+                          const int16_t *src, int count)
+{
+  mxu.mat4(dst, src, count, m);
+}
+
+void mxu1_blas_mat4_apply_c(const mxu1_blas_mat4 *m, int16_t *dst,
+                            const int16_t *src, int count)
+{
+  ref.mat4(dst, src, count, m);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Matrices
+////////////////////////////////////////////////////////////////////////////////
+
+static void gemv(int16_t *y, const int16_t *a, int lda, const int16_t *x,
+                 int m, int n, int shift, const kernels *k)
+{
+  const mxu1_blas_gemv_args g = { m & ~3, n, lda * 2, shift };
+
+  if (g.rows > 0)
+    k->gemv(y, a, x, &g);
+  for (int i = g.rows; i < m; ++i)
+    y[i] = saturate((uint32_t)dot(a + i * lda, x, n, k), shift);
+}
+
+void mxu1_blas_gemv_q15(int16_t *y, const int16_t *a, int lda,
+                        const int16_t *x, int m, int n, int shift)
+{
+  gemv(y, a, lda, x, m, n, shift, &mxu);
+}
+
+void mxu1_blas_gemv_q15_c(int16_t *y, const int16_t *a, int lda,
+                          const int16_t *x, int m, int n, int shift)
+{
+  gemv(y, a, lda, x, m, n, shift, &ref);
+}
+
+//  c[i * ldc + j] alone
+static void element(int16_t *c, int ldc, const int16_t *a, int lda,
+                    const int16_t *b, int ldb, int i, int j, int k,
+                    int shift)
+{
+  uint32_t s = 0;
+  for (int kk = 0; kk < k; ++kk)
+    s += (uint32_t)(a[i * lda + kk] * b[kk * ldb + j]);
+  c[i * ldc + j] = saturate(s, shift);
+}
+
+static void gemm(int16_t *c, int ldc, const int16_t *a, int lda,
+                 const int16_t *b, int ldb, int m, int n, int k, int shift,
+                 const kernels *kn)
+{
+  mxu1_blas_gemm_args g = { m & ~1, 0, k, lda * 2, ldb * 2, ldc * 2, shift };
+  const int n4 = k > 0 ? n & ~3 : 0;
+  int nb = k > 0 ? MXU1_BLAS_L1_BYTES / 4 / k & ~3 : 0;
+
+  if (nb < 4)
+    nb = 4;
+  for (int j = 0; g.rows > 0 && j < n4; j += nb) {
+    g.cols = n4 - j < nb ? n4 - j : nb;
+    kn->gemm(c + j, a, b + j, &g);
+  }
+  for (int i = 0; i < m; ++i)
+    for (int j = i < g.rows ? n4 : 0; j < n; ++j)
+      element(c, ldc, a, lda, b, ldb, i, j, k, shift);
+}
+
+void mxu1_blas_gemm_q15(int16_t *c, int ldc, const int16_t *a, int lda,
+                        const int16_t *b, int ldb, int m, int n, int k,
+                        int shift)
+{
+  gemm(c, ldc, a, lda, b, ldb, m, n, k, shift, &mxu);
+}
+
+void mxu1_blas_gemm_q15_c(int16_t *c, int ldc, const int16_t *a, int lda,
+                          const int16_t *b, int ldb, int m, int n, int k,
+                          int shift)
+{
+  gemm(c, ldc, a, lda, b, ldb, m, n, k, shift, &ref);
+}
@@ -0,0 +1,126 @@
+// mxu1_blas_ref.c
+//
+// Scalar C reference for the mxu1_blas.s dot product, AXPY and matrix kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The kernels of mxu1_blas.s in C, an element at a time, which the MXU
+// versions must match exactly. Sums wrap in 32 bits as the MXU's lanes do
+// (uint32_t, then converted), so that even matrices outside the documented
+// range give the same result in both; the Q31 dot product wraps in 64.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_blas.h"
+
+//  The rounding term of a shift
+static uint32_t bias(int shift)
+{
+  return shift ? 1u << (shift - 1) : 0;
+}
+
+//  A 32-bit sum clamped to what shifts into int16_t, shifted
+static int16_t saturate(uint32_t sum, int shift)
+{
+  const int32_t lo = (int32_t)((uint32_t)-32768 << shift), hi = ~lo;
+  int32_t v = (int32_t)sum;
+  v = v < lo ? lo : v > hi ? hi : v;
+  return (int16_t)(v >> shift);
+}
+
+//  Element i of a row 'stride' bytes after p
+static const int16_t *row(const int16_t *p, int32_t i, int32_t stride)
+{
+  return (const int16_t *)((const uint8_t *)p + i * stride);
+}
+
+int32_t mxu1_blas_dot_run_c(const int16_t *x, const int16_t *y,
+                            int32_t pairs)
+{
+  uint32_t s = 0;
+  for (int32_t i = 0; i < 2 * pairs; ++i)
+    s += (uint32_t)(x[i] * y[i]);
+  return (int32_t)s;
+}
+
+int64_t mxu1_blas_dot32_run_c(const int32_t *x, const int32_t *y,
+                              int32_t n)
+{
+  uint64_t s = 0;
+  for (int32_t i = 0; i < n; ++i)
+    s += (uint64_t)((int64_t)x[i] * y[i]);
+  return (int64_t)s;
+}
+
+void mxu1_blas_axpy_run_c(int16_t *y, const int16_t *x, int32_t pairs,
+                          int32_t a)
+{
+  for (int32_t i = 0; i < 2 * pairs; ++i)
+    y[i] = saturate(bias(15) + ((uint32_t)y[i] << 15) +
+                    (uint32_t)((int16_t)a * x[i]), 15);
+}
+
+void mxu1_blas_mat4_run_c(int16_t *dst, const int16_t *src, int32_t count,
+                          const mxu1_blas_mat4 *m)
+{
+  for (int32_t v = 0; v < count; ++v, src += 4, dst += 4) {
+    uint32_t s[4];
+    for (int r = 0; r < 4; ++r) {
+      s[r] = bias(m->shift);
+      for (int c = 0; c < 4; ++c) {
+        const uint32_t w = m->cols[2 * c + r / 2];
+        s[r] += (uint32_t)((int16_t)(r & 1 ? w >> 16 : w) * src[c]);
+      }
+    }
+    for (int r = 0; r < 4; ++r)
+      dst[r] = saturate(s[r], m->shift);
+  }
+}
+
+void mxu1_blas_gemv_run_c(int16_t *y, const int16_t *a, const int16_t *x,
+                          const mxu1_blas_gemv_args *g)
+{
+  for (int32_t i = 0; i < g->rows; ++i) {
+    const int16_t *ai = row(a, i, g->lda);
+    uint32_t s = bias(g->shift);
+    for (int32_t j = 0; j < g->n; ++j)
+      s += (uint32_t)(ai[j] * x[j]);
+    y[i] = saturate(s, g->shift);
+  }
+}
+
+void mxu1_blas_gemm_run_c(int16_t *c, const int16_t *a, const int16_t *b,
+                          const mxu1_blas_gemm_args *g)
+{
+  for (int32_t i = 0; i < g->rows; ++i) {
+    const int16_t *ai = row(a, i, g->lda);
+    int16_t *ci = (int16_t *)row(c, i, g->ldc);
+    for (int32_t j = 0; j < g->cols; ++j) {
+      uint32_t s = bias(g->shift);
+      for (int32_t k = 0; k < g->k; ++k)
+        s += (uint32_t)(ai[k] * row(b, k, g->ldb)[j]);
+      ci[j] = saturate(s, g->shift);
+    }
+  }
+}
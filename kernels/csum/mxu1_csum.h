@@ -0,0 +1,154 @@
+// mxu1_csum.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 checksums (Adler-32, Fletcher, internet) and reductions
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Checksums and reductions over byte buffers, for the OTA updater (Adler-32
+// of images and deltas) and the network stack (the internet checksum):
+//   - Adler-32, as zlib's adler32(): start from 1, or chain calls;
+//   - Fletcher-16 (bytes, modulo 255) and Fletcher-32 (little-endian 16-bit
+//     words, modulo 65535), both started from 0 and chainable;
+//   - the internet checksum of RFC 1071, a 16-bit one's complement sum of
+//     big-endian 16-bit words;
+//   - sums, minimum and maximum of uint8_t and int16_t arrays, and a 256-bin
+//     histogram of bytes.
+//
+// Each has a C version (_c, in mxu1_csum_ref.c) with the same result. The
+// MXU versions (mxu1_csum_buffer.c) take the word aligned 64-byte blocks in
+// the middle of the buffer to the kernels in mxu1_csum.s, which return lane
+// sums for the driver to finish, and do the ends in C: any length and
+// alignment works. The histogram is plain C in both versions (the MXU has
+// no scatter); the MXU one keeps four tables of counts so that repeated
+// bytes do not wait on each other's increments.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/csum, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_csum.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_csum_ref.c
+//         mxu1_csum_buffer.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_CSUM_H
+#define MXU1_CSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Checksums (MXU: mxu1_csum_buffer.c, C: mxu1_csum_ref.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  Adler-32 of 'n' bytes continuing from 'adler' (1 for a new checksum),
+// equal to zlib's adler32(adler, buf, n)
+uint32_t mxu1_adler32(uint32_t adler, const void *buf, size_t n);
+uint32_t mxu1_adler32_c(uint32_t adler, const void *buf, size_t n);
+
+//  Fletcher-16: (sum2 << 8) | sum1, continuing from 'f' (0 for a new one)
+uint32_t mxu1_fletcher16(uint32_t f, const void *buf, size_t n);
+uint32_t mxu1_fletcher16_c(uint32_t f, const void *buf, size_t n);
+
+//  Fletcher-32 over little-endian 16-bit words, (sum2 << 16) | sum1,
+// continuing from 'f' (0 for a new one). An odd 'n' is padded with a zero
+// byte, so only the last of chained calls may have one. 'buf' at an odd
+// address is done in C.
+uint32_t mxu1_fletcher32(uint32_t f, const void *buf, size_t n);
+uint32_t mxu1_fletcher32_c(uint32_t f, const void *buf, size_t n);
+
+//  One's complement sum of 'n' bytes as big-endian 16-bit words, an odd
+// last byte padded with zero, added to 'sum' and folded to 16 bits. Chain
+// it over the pieces of a packet (a pseudo-header, then the payload: all
+// but the last piece of even length), then take mxu1_inet_fold().
+uint32_t mxu1_inet_sum(uint32_t sum, const void *buf, size_t n);
+uint32_t mxu1_inet_sum_c(uint32_t sum, const void *buf, size_t n);
+
+//  The checksum to store (big-endian) from a sum: its complement, folded
+static inline uint16_t mxu1_inet_fold(uint32_t sum)
+{
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum += sum >> 16;
+  return (uint16_t)~sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reductions (MXU: mxu1_csum_buffer.c, C: mxu1_csum_ref.c)
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t mxu1_sum_u8(const uint8_t *p, size_t n);
+uint64_t mxu1_sum_u8_c(const uint8_t *p, size_t n);
+int64_t  mxu1_sum_s16(const int16_t *p, size_t n);
+int64_t  mxu1_sum_s16_c(const int16_t *p, size_t n);
+
+//  Smallest and largest element; with n == 0, *min and *max are the
+// largest and smallest values of the type
+void mxu1_minmax_u8(const uint8_t *p, size_t n, uint8_t *min, uint8_t *max);
+void mxu1_minmax_u8_c(const uint8_t *p, size_t n, uint8_t *min,
+                      uint8_t *max);
+void mxu1_minmax_s16(const int16_t *p, size_t n, int16_t *min, int16_t *max);
+void mxu1_minmax_s16_c(const int16_t *p, size_t n, int16_t *min,
+                       int16_t *max);
+
+//  Adds the count of each byte value of p[0 .. n - 1] to hist[]
+void mxu1_histogram_u8(uint32_t hist[256], const uint8_t *p, size_t n);
+void mxu1_histogram_u8_c(uint32_t hist[256], const uint8_t *p, size_t n);
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels (mxu1_csum.s), for the driver
+////////////////////////////////////////////////////////////////////////////////
+
+//  All take 'blocks' 64-byte blocks from the word aligned 'p', and write
+// their results. Even and odd are byte (or halfword) positions from p.
+
+//  Largest 'blocks' for mxu1_csum_sums() (keeps W below 2^32), and for
+// mxu1_csum_sum() and mxu1_csum_sum_s16() (keeps the sums below 2^31)
+#define MXU1_CSUM_SUMS_MAX      64
+#define MXU1_CSUM_SUM_MAX       65536
+#define MXU1_CSUM_SUM_S16_MAX   2048
+
+//  sums[] = { S even, S odd, W even, W odd }: the byte sums and the sums
+// of (64 * blocks - i) * p[i], over even and odd i
+void mxu1_csum_sums(const uint32_t *p, int32_t blocks, uint32_t sums[4]);
+
+//  sums[] = { even, odd } byte sums
+void mxu1_csum_sum(const uint32_t *p, int32_t blocks, uint32_t sums[2]);
+
+//  sums[] = { even, odd } sums of the int16_t halfwords
+void mxu1_csum_sum_s16(const uint32_t *p, int32_t blocks, int32_t sums[2]);
+
+//  mm[] = { minimum, maximum } of each byte (halfword) lane over the words:
+// the minimum and maximum are those of the four (two) lanes
+void mxu1_csum_minmax_u8(const uint32_t *p, int32_t blocks, uint32_t mm[2]);
+void mxu1_csum_minmax_s16(const uint32_t *p, int32_t blocks, uint32_t mm[2]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_CSUM_H
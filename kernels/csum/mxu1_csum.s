@@ -0,0 +1,355 @@
+# mxu1_csum.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 checksum and reduction kernels
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes are in mxu1_csum.h, and mxu1_csum_ref.c has the same
+# computations in C. Every kernel here works on whole 64-byte blocks of a
+# word aligned buffer, 16 s32ldi per block, and leaves the checksum (or
+# reduction) arithmetic proper to the C driver, mxu1_csum_buffer.c: each
+# returns a few 32-bit sums from which the driver finishes Adler-32, Fletcher
+# and the internet checksum for any length and alignment.
+#
+#  The byte sums are kept in 16-bit lanes, by byte position: q8acce adds the
+# four bytes of two words into the four lanes of two registers (bytes 1, 0
+# and 3, 2), one instruction per 8 bytes like d8sum, but keeping the byte
+# positions apart, which the checksums need. At the end of a run of
+# blocks, short enough that no lane can pass 32767, d16mac widens the lanes
+# into 32-bit sums, the odd bytes' half into one register and the even
+# bytes' into another (a multiply by 1 in both halves, or by a weight).
+#
+#  mxu1_csum_sums() also needs, for Adler-32 and Fletcher, the sums weighted
+# by the distance of each byte from the end, W = sum (n - i) * p[i] over the
+# n bytes. Per pair of words X, Y it keeps three sets of lanes:
+#   L  += X + Y         byte sums
+#   Lx += X             byte sums of the first word only
+#   Q  += L             L before the pair: the pairs so far, once per later
+#                       pair
+# and at the end of each block (8 pairs, which keeps Q below 32767) adds
+# 8 Q + 4 Lx + (4 - k) L, k the lane's byte position, to W, the weights within
+# the block. The blocks' own distances come from Z, the sum of the byte sums
+# of all blocks before each one (d32asum), which is added to W * 64 at the end.
+#
+# Register use: any xr, $t0..$t2, $a0..$a2. Leaf functions, no stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# Prefetch distance, bytes: two 64-byte blocks
+  .equ    CSUM_PREF_AHEAD, 128
+
+
+################################################################################
+# void mxu1_csum_sums(const uint32_t *p, int32_t blocks, uint32_t sums[4])
+#
+#  Lanes: L in xr1 (bytes 1, 0), xr2 (3, 2); Lx in xr3, xr4; Q in xr5, xr6.
+# 32-bit sums, odd bytes / even bytes: S in xr7 / xr8, W in xr9 / xr10, Z in
+# xr11 / xr12. The pair is loaded into xr13, xr14.
+################################################################################
+
+.macro SUMS_PAIR
+  s32ldi  xr13, $a0,  4
+  s32ldi  xr14, $a0,  4
+  q16accm xr6,  xr2,  xr1,  xr5,  AA      # Q += L
+  q8acce  xr2,  xr13, xr14, xr1,  AA      # L += X + Y
+  q8acce  xr4,  xr13, xr0,  xr3,  AA      # Lx += X
+.endm
+
+  .globl  mxu1_csum_sums
+  .type   mxu1_csum_sums, @function
+  .ent    mxu1_csum_sums
+mxu1_csum_sums:
+  q16add  xr1,  xr0,  xr0,  xr2,  AA, WW  # Everything 0
+  q16add  xr3,  xr0,  xr0,  xr4,  AA, WW
+  q16add  xr5,  xr0,  xr0,  xr6,  AA, WW
+  q16add  xr7,  xr0,  xr0,  xr8,  AA, WW
+  q16add  xr9,  xr0,  xr0,  xr10, AA, WW
+  q16add  xr11, xr0,  xr0,  xr12, AA, WW
+  li      $t1,  0x00030004                # (4 - k) for bytes 1, 0
+  li      $t2,  0x00010002                # and 3, 2
+  blez    $a1,  9f
+   addiu  $a0,  $a0,  -4
+
+1:
+  pref    0,    CSUM_PREF_AHEAD($a0)
+  SUMS_PAIR
+  SUMS_PAIR
+  SUMS_PAIR
+  SUMS_PAIR
+  SUMS_PAIR
+  SUMS_PAIR
+  SUMS_PAIR
+  SUMS_PAIR
+  d32asum xr11, xr7,  xr8,  xr12, AA      # Z += S, the blocks before
+  s32lui  xr15, 1,    4
+  s32lui  xr13, 8,    4
+  d16mac  xr7,  xr1,  xr15, xr8,  AA, WW  # S += L
+  d16mac  xr9,  xr5,  xr13, xr10, AA, WW  # W += 8 Q
+  d16mac  xr7,  xr2,  xr15, xr8,  AA, WW
+  d16mac  xr9,  xr6,  xr13, xr10, AA, WW
+  s32lui  xr14, 4,    4
+  d16mac  xr9,  xr3,  xr14, xr10, AA, WW  #    + 4 Lx
+  s32i2m  xr15, $t1
+  d16mac  xr9,  xr4,  xr14, xr10, AA, WW
+  s32i2m  xr13, $t2
+  d16mac  xr9,  xr1,  xr15, xr10, AA, WW  #    + (4 - k) L
+  q16add  xr3,  xr0,  xr0,  xr4,  AA, WW
+  d16mac  xr9,  xr2,  xr13, xr10, AA, WW
+  q16add  xr1,  xr0,  xr0,  xr2,  AA, WW
+  addiu   $a1,  $a1,  -1
+  bnez    $a1,  1b
+   q16add xr5,  xr0,  xr0,  xr6,  AA, WW
+
+  d32sll  xr11, xr11, xr12, xr12, 6       # W += 64 Z
+  d32asum xr9,  xr11, xr12, xr10, AA
+9:
+  s32std  xr8,  $a2,  0
+  s32std  xr7,  $a2,  4
+  s32std  xr10, $a2,  8
+  jr      $ra
+   s32std xr9,  $a2,  12
+  .end    mxu1_csum_sums
+  .size   mxu1_csum_sums, .-mxu1_csum_sums
+
+
+################################################################################
+# void mxu1_csum_sum(const uint32_t *p, int32_t blocks, uint32_t sums[2])
+#
+#  Two sets of lanes, xr9, xr10 and xr11, xr12, taking alternate pairs, are
+# widened every CSUM_SUM_RUN blocks (4 pairs each per block, at most 510 per
+# lane per pair) into xr14 (even bytes) and xr13 (odd).
+################################################################################
+
+  .equ    CSUM_SUM_RUN,   16
+
+  .globl  mxu1_csum_sum
+  .type   mxu1_csum_sum, @function
+  .ent    mxu1_csum_sum
+mxu1_csum_sum:
+  s32lui  xr15, 1,    4
+  q16add  xr13, xr0,  xr0,  xr14, AA, WW
+  blez    $a1,  9f
+   addiu  $a0,  $a0,  -4
+  li      $t0,  CSUM_SUM_RUN
+  slt     $t1,  $a1,  $t0
+  movn    $t0,  $a1,  $t1                 # Blocks in this run
+  subu    $a1,  $a1,  $t0
+
+1:
+  q16add  xr9,  xr0,  xr0,  xr10, AA, WW
+  q16add  xr11, xr0,  xr0,  xr12, AA, WW
+2:
+  pref    0,    CSUM_PREF_AHEAD($a0)
+  s32ldi  xr1,  $a0,  4
+  s32ldi  xr2,  $a0,  4
+  s32ldi  xr3,  $a0,  4
+  s32ldi  xr4,  $a0,  4
+  s32ldi  xr5,  $a0,  4
+  s32ldi  xr6,  $a0,  4
+  s32ldi  xr7,  $a0,  4
+  s32ldi  xr8,  $a0,  4
+  q8acce  xr10, xr1,  xr2,  xr9,  AA
+  q8acce  xr12, xr3,  xr4,  xr11, AA
+  q8acce  xr10, xr5,  xr6,  xr9,  AA
+  q8acce  xr12, xr7,  xr8,  xr11, AA
+  s32ldi  xr1,  $a0,  4
+  s32ldi  xr2,  $a0,  4
+  s32ldi  xr3,  $a0,  4
+  s32ldi  xr4,  $a0,  4
+  s32ldi  xr5,  $a0,  4
+  s32ldi  xr6,  $a0,  4
+  s32ldi  xr7,  $a0,  4
+  s32ldi  xr8,  $a0,  4
+  q8acce  xr10, xr1,  xr2,  xr9,  AA
+  q8acce  xr12, xr3,  xr4,  xr11, AA
+  q8acce  xr10, xr5,  xr6,  xr9,  AA
+  addiu   $t0,  $t0,  -1
+  bnez    $t0,  2b
+   q8acce xr12, xr7,  xr8,  xr11, AA
+
+  d16mac  xr13, xr9,  xr15, xr14, AA, WW  # Widen, and set up the next run
+  li      $t0,  CSUM_SUM_RUN
+  d16mac  xr13, xr10, xr15, xr14, AA, WW
+  slt     $t1,  $a1,  $t0
+  d16mac  xr13, xr11, xr15, xr14, AA, WW
+  movn    $t0,  $a1,  $t1
+  d16mac  xr13, xr12, xr15, xr14, AA, WW
+  bnez    $a1,  1b
+   subu   $a1,  $a1,  $t0
+
+9:
+  s32std  xr14, $a2,  0
+  jr      $ra
+   s32std xr13, $a2,  4
+  .end    mxu1_csum_sum
+  .size   mxu1_csum_sum, .-mxu1_csum_sum
+
+
+################################################################################
+# void mxu1_csum_sum_s16(const uint32_t *p, int32_t blocks, int32_t sums[2])
+#
+#  One d16mac by (1, 1) per word, into two pairs of accumulators taken in
+# turn, xr9 / xr10 and xr11 / xr12 (odd / even halfwords).
+################################################################################
+
+  .globl  mxu1_csum_sum_s16
+  .type   mxu1_csum_sum_s16, @function
+  .ent    mxu1_csum_sum_s16
+mxu1_csum_sum_s16:
+  s32lui  xr15, 1,    4
+  q16add  xr9,  xr0,  xr0,  xr10, AA, WW
+  q16add  xr11, xr0,  xr0,  xr12, AA, WW
+  blez    $a1,  9f
+   addiu  $a0,  $a0,  -4
+
+1:
+  pref    0,    CSUM_PREF_AHEAD($a0)
+  s32ldi  xr1,  $a0,  4
+  s32ldi  xr2,  $a0,  4
+  s32ldi  xr3,  $a0,  4
+  s32ldi  xr4,  $a0,  4
+  s32ldi  xr5,  $a0,  4
+  s32ldi  xr6,  $a0,  4
+  s32ldi  xr7,  $a0,  4
+  s32ldi  xr8,  $a0,  4
+  d16mac  xr9,  xr1,  xr15, xr10, AA, WW
+  d16mac  xr11, xr2,  xr15, xr12, AA, WW
+  d16mac  xr9,  xr3,  xr15, xr10, AA, WW
+  d16mac  xr11, xr4,  xr15, xr12, AA, WW
+  d16mac  xr9,  xr5,  xr15, xr10, AA, WW
+  d16mac  xr11, xr6,  xr15, xr12, AA, WW
+  d16mac  xr9,  xr7,  xr15, xr10, AA, WW
+  d16mac  xr11, xr8,  xr15, xr12, AA, WW
+  s32ldi  xr1,  $a0,  4
+  s32ldi  xr2,  $a0,  4
+  s32ldi  xr3,  $a0,  4
+  s32ldi  xr4,  $a0,  4
+  s32ldi  xr5,  $a0,  4
+  s32ldi  xr6,  $a0,  4
+  s32ldi  xr7,  $a0,  4
+  s32ldi  xr8,  $a0,  4
+  d16mac  xr9,  xr1,  xr15, xr10, AA, WW
+  d16mac  xr11, xr2,  xr15, xr12, AA, WW
+  d16mac  xr9,  xr3,  xr15, xr10, AA, WW
+  d16mac  xr11, xr4,  xr15, xr12, AA, WW
+  d16mac  xr9,  xr5,  xr15, xr10, AA, WW
+  d16mac  xr11, xr6,  xr15, xr12, AA, WW
+  d16mac  xr9,  xr7,  xr15, xr10, AA, WW
+  addiu   $a1,  $a1,  -1
+  bnez    $a1,  1b
+   d16mac xr11, xr8,  xr15, xr12, AA, WW
+
+  d32asum xr9,  xr11, xr12, xr10, AA
+9:
+  s32std  xr10, $a2,  0
+  jr      $ra
+   s32std xr9,  $a2,  4
+  .end    mxu1_csum_sum_s16
+  .size   mxu1_csum_sum_s16, .-mxu1_csum_sum_s16
+
+
+################################################################################
+# void mxu1_csum_minmax_u8(const uint32_t *p, int32_t blocks, uint32_t mm[2])
+# void mxu1_csum_minmax_s16(const uint32_t *p, int32_t blocks, uint32_t mm[2])
+#
+#  Lane minimum in xr9 and xr10, maximum in xr11 and xr12, each pair taking
+# alternate words, combined at the end.
+################################################################################
+
+.macro MINMAX_WORDS min, max
+  s32ldi  xr1,  $a0,  4
+  s32ldi  xr2,  $a0,  4
+  s32ldi  xr3,  $a0,  4
+  s32ldi  xr4,  $a0,  4
+  s32ldi  xr5,  $a0,  4
+  s32ldi  xr6,  $a0,  4
+  s32ldi  xr7,  $a0,  4
+  s32ldi  xr8,  $a0,  4
+  \min    xr9,  xr9,  xr1
+  \max    xr11, xr11, xr1
+  \min    xr10, xr10, xr2
+  \max    xr12, xr12, xr2
+  \min    xr9,  xr9,  xr3
+  \max    xr11, xr11, xr3
+  \min    xr10, xr10, xr4
+  \max    xr12, xr12, xr4
+  \min    xr9,  xr9,  xr5
+  \max    xr11, xr11, xr5
+  \min    xr10, xr10, xr6
+  \max    xr12, xr12, xr6
+  \min    xr9,  xr9,  xr7
+  \max    xr11, xr11, xr7
+  \min    xr10, xr10, xr8
+  \max    xr12, xr12, xr8
+.endm
+
+#  \min and \max are the lane ops; the lanes start at xr9 (minimum) and xr11
+# (maximum), set by the caller
+.macro MINMAX min, max
+  blez    $a1,  9f
+   addiu  $a0,  $a0,  -4
+  s32alni xr10, xr9,  xr0,  0             # Copies for the second pair
+  s32alni xr12, xr11, xr0,  0
+1:
+  pref    0,    CSUM_PREF_AHEAD($a0)
+  MINMAX_WORDS \min, \max
+  MINMAX_WORDS \min, \max
+  addiu   $a1,  $a1,  -1
+  bnez    $a1,  1b
+   nop
+  \min    xr9,  xr9,  xr10
+  \max    xr11, xr11, xr12
+9:
+  s32std  xr9,  $a2,  0
+  jr      $ra
+   s32std xr11, $a2,  4
+.endm
+
+  .globl  mxu1_csum_minmax_u8
+  .type   mxu1_csum_minmax_u8, @function
+  .ent    mxu1_csum_minmax_u8
+mxu1_csum_minmax_u8:
+  s32lui  xr9,  0xff, 7                   # 255 in every byte
+  s32lui  xr11, 0,    0
+  MINMAX  q8min, q8max
+  .end    mxu1_csum_minmax_u8
+  .size   mxu1_csum_minmax_u8, .-mxu1_csum_minmax_u8
+
+  .globl  mxu1_csum_minmax_s16
+  .type   mxu1_csum_minmax_s16, @function
+  .ent    mxu1_csum_minmax_s16
+mxu1_csum_minmax_s16:
+  li      $t0,  0x7fff7fff
+  s32i2m  xr9,  $t0
+  s32lui  xr11, 0x80, 5                   # -32768 in both halves
+  MINMAX  d16min, d16max
+  .end    mxu1_csum_minmax_s16
+  .size   mxu1_csum_minmax_s16, .-mxu1_csum_minmax_s16
+
+# vim:shiftwidth=2:expandtab:syntax=asm
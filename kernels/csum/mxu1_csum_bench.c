@@ -0,0 +1,186 @@
+// mxu1_csum_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 checksums and reductions: checks and GB/s
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Checks every function in mxu1_csum.h against its _c version, and
+// mxu1_adler32() also against zlib's adler32(), on random and constant
+// buffers of many lengths and alignments, then prints GB/s for the MXU and
+// C versions (and zlib) over a 1 MB buffer, an OTA image chunk, and a 1500
+// byte packet, the network stack's case.
+//
+// Build and run on the target (kernels/csum):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_csum_bench
+//         mxu1_csum_bench.c mxu1_csum_buffer.c mxu1_csum_ref.c mxu1_csum.s
+//         ../dispatch/mxu1_cpu.c -lz
+//     ./mxu1_csum_bench [seconds per test, default 1]
+// Exits non-zero if any result differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+#include "mxu1_csum.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+enum { MXU, C, ZLIB };
+
+typedef enum {
+  ADLER32, FLETCHER16, FLETCHER32, INET, SUM_U8, SUM_S16, MINMAX_U8,
+  MINMAX_S16, HISTOGRAM, FUNCTIONS
+} function;
+
+static const char *const name[] = {
+  "adler32", "fletcher16", "fletcher32", "inet", "sum u8", "sum s16",
+  "minmax u8", "minmax s16", "histogram u8"
+};
+
+static uint32_t hist[256];
+
+//  The result of 'f' over n bytes at p, by 'impl', folded to 64 bits
+static uint64_t run(function f, int impl, const uint8_t *p, size_t n)
+{
+  const int c = impl == C;
+  switch (f) {
+    case ADLER32:
+      return impl == ZLIB ? adler32(1, p, (uInt)n) :
+             (c ? mxu1_adler32_c : mxu1_adler32)(1, p, n);
+    case FLETCHER16:
+      return (c ? mxu1_fletcher16_c : mxu1_fletcher16)(0, p, n);
+    case FLETCHER32:
+      return (c ? mxu1_fletcher32_c : mxu1_fletcher32)(0, p, n);
+    case INET:
+      return mxu1_inet_fold((c ? mxu1_inet_sum_c : mxu1_inet_sum)(0, p, n));
+    case SUM_U8:
+      return (c ? mxu1_sum_u8_c : mxu1_sum_u8)(p, n);
+    case SUM_S16:
+      return (uint64_t)(c ? mxu1_sum_s16_c : mxu1_sum_s16)(
+          (const int16_t *)p, n / 2);
+    case MINMAX_U8: {
+      uint8_t lo, hi;
+      (c ? mxu1_minmax_u8_c : mxu1_minmax_u8)(p, n, &lo, &hi);
+      return (uint64_t)lo << 8 | hi;
+    }
+    case MINMAX_S16: {
+      int16_t lo, hi;
+      (c ? mxu1_minmax_s16_c : mxu1_minmax_s16)((const int16_t *)p, n / 2,
+                                                &lo, &hi);
+      return (uint64_t)(uint16_t)lo << 16 | (uint16_t)hi;
+    }
+    default: {
+      uint64_t h = 0;
+      memset(hist, 0, sizeof(hist));
+      (c ? mxu1_histogram_u8_c : mxu1_histogram_u8)(hist, p, n);
+      for (int i = 0; i < 256; ++i)
+        h = h * 31 + hist[i];
+      return h;
+    }
+  }
+}
+
+static double gbs(function f, int impl, const uint8_t *p, size_t n,
+                  double secs)
+{
+  unsigned long k = 0;
+  double t0 = now(), dt;
+  volatile uint64_t sink;
+
+  do {
+    sink = run(f, impl, p, n);
+    ++k;
+    dt = now() - t0;
+  } while (dt < secs);
+  (void)sink;
+  return k * (double)n / dt * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+  static const size_t sizes[] = { 1 << 20, 64 << 10, 1500 };
+  const size_t max = (1 << 20) + 64;
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  uint8_t *buf = (uint8_t *)malloc(max);
+  int failed = 0;
+
+  if (!buf) {
+    fprintf(stderr, "out of memory\n");
+    return 2;
+  }
+  mxu1_cpu_enable();
+
+  // Random, all 255 (the largest sums) and all 0x80 (the smallest int16_t)
+  for (int fill = 0; fill < 3; ++fill) {
+    for (size_t i = 0; i < max; ++i)
+      buf[i] = fill == 0 ? (uint8_t)rand16() : fill == 1 ? 255 : 0x80;
+    for (int t = 0; t < 400; ++t) {
+      const size_t off = t % 8;
+      const size_t n = t < 8 ? max - 8 : t < 200 ? (size_t)t - 8 :
+                       rand16() * 16 + rand16() % 16;
+      for (int f = 0; f < FUNCTIONS; ++f) {
+        const uint8_t *p = buf + (f == SUM_S16 || f == MINMAX_S16 ?
+                                  off & ~(size_t)1 : off);
+        const uint64_t m = run((function)f, MXU, p, n);
+        if (m != run((function)f, C, p, n) ||
+            (f == ADLER32 && m != run((function)f, ZLIB, p, n))) {
+          printf("%-12s %zu bytes at +%zu, fill %d: MISMATCH\n", name[f], n,
+                 off, fill);
+          failed = 1;
+        }
+      }
+    }
+  }
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    printf("%7zu bytes      GB/s: MXU        C  (MXU vs C)\n", sizes[s]);
+    for (int f = 0; f < FUNCTIONS; ++f) {
+      const double m = gbs((function)f, MXU, buf, sizes[s], secs);
+      const double c = gbs((function)f, C, buf, sizes[s], secs);
+      printf("  %-22s %8.3f %8.3f  x%.2f", name[f], m, c, m / c);
+      if (f == ADLER32)
+        printf("   zlib %.3f", gbs((function)f, ZLIB, buf, sizes[s], secs));
+      printf("\n");
+    }
+  }
+
+  free(buf);
+  return failed;
+}
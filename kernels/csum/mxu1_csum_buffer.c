@@ -0,0 +1,273 @@
+// mxu1_csum_buffer.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 checksums and reductions: any length and alignment
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Each function does the bytes up to the first word boundary in C, then
+// hands the 64-byte blocks from there to a kernel (in runs no longer than
+// its MXU1_CSUM_*_MAX), then does the rest in C. A kernel's even and odd
+// sums are of positions from where it started, so they swap when that is an
+// odd distance into the buffer.
+//
+//  The kernel sums carry the checksums forward one run at a time, as zlib
+// combines Adler-32s: a run of n bytes with byte sum S and weighted sum W
+// (mxu1_csum.h) takes s1 to s1 + S and s2 to s2 + n * s1 + W. Fletcher-32
+// counts 16-bit words instead, which starting at an even offset are
+// p[i] + 256 * p[i + 1]: over n bytes (n / 2 words), S16 = S even + 256 *
+// S odd, and W16 = W even / 2 + 128 * (W odd + S odd) since byte i is in
+// word i / 2, which is (n - i) / 2 words from the end for even i and
+// (n - i + 1) / 2 for odd. The internet checksum is S even * 256 + S odd,
+// folded.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "mxu1_csum.h"
+
+//  Bytes from p to the next word boundary, at most n
+static size_t head(const void *p, size_t n)
+{
+  const size_t h = (size_t)(-(uintptr_t)p & 3);
+  return h < n ? h : n;
+}
+
+static size_t run(size_t n, size_t max)
+{
+  const size_t blocks = n / 64;
+  return blocks < max ? blocks : max;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Checksums
+////////////////////////////////////////////////////////////////////////////////
+
+//  s1 and s2 (reduced modulo 'mod') carried over n bytes
+static void carry(const uint8_t *p, size_t n, uint32_t mod, uint32_t *s1,
+                  uint32_t *s2)
+{
+  uint32_t a = *s1, b = *s2;
+  size_t i = 0, h = head(p, n);
+
+  for (; i < h; ++i) {
+    a += p[i];
+    b += a;
+  }
+  a %= mod;
+  b %= mod;
+  for (size_t blocks; (blocks = run(n - i, MXU1_CSUM_SUMS_MAX)) > 0;
+       i += blocks * 64) {
+    uint32_t k[4];
+    mxu1_csum_sums((const uint32_t *)(p + i), (int32_t)blocks, k);
+    b = (uint32_t)((b + (uint64_t)blocks * 64 * a + k[2] + k[3]) % mod);
+    a = (uint32_t)(((uint64_t)a + k[0] + k[1]) % mod);
+  }
+  for (; i < n; ++i) {
+    a += p[i];
+    b += a;
+  }
+  *s1 = a % mod;
+  *s2 = b % mod;
+}
+
+uint32_t mxu1_adler32(uint32_t adler, const void *buf, size_t n)
+{
+  uint32_t a = adler & 0xffff, b = adler >> 16;
+  carry((const uint8_t *)buf, n, 65521, &a, &b);
+  return b << 16 | a;
+}
+
+uint32_t mxu1_fletcher16(uint32_t f, const void *buf, size_t n)
+{
+  uint32_t s1 = f & 0xff, s2 = (f >> 8) & 0xff;
+  carry((const uint8_t *)buf, n, 255, &s1, &s2);
+  return s2 << 8 | s1;
+}
+
+uint32_t mxu1_fletcher32(uint32_t f, const void *buf, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+  uint32_t s1 = f & 0xffff, s2 = f >> 16;
+  size_t i = 0;
+
+  if ((uintptr_t)p & 1)
+    return mxu1_fletcher32_c(f, buf, n);
+
+  for (size_t h = head(p, n) & ~(size_t)1; i < h; i += 2) {
+    s1 = (s1 + (p[i] | (uint32_t)p[i + 1] << 8)) % 65535;
+    s2 = (s2 + s1) % 65535;
+  }
+  for (size_t blocks; (blocks = run(n - i, MXU1_CSUM_SUMS_MAX)) > 0;
+       i += blocks * 64) {
+    uint32_t k[4];
+    mxu1_csum_sums((const uint32_t *)(p + i), (int32_t)blocks, k);
+    s2 = (uint32_t)((s2 + (uint64_t)blocks * 32 * s1 + k[2] / 2 +
+                     128 * ((uint64_t)k[3] + k[1])) % 65535);
+    s1 = (uint32_t)((s1 + k[0] + 256 * (uint64_t)k[1]) % 65535);
+  }
+  if (i < n)
+    return mxu1_fletcher32_c(s2 << 16 | s1, p + i, n - i);
+  return s2 << 16 | s1;
+}
+
+//  Sums of the bytes at even and odd offsets from p
+static void sum_bytes(const uint8_t *p, size_t n, uint64_t s[2])
+{
+  size_t i = 0, h = head(p, n);
+
+  s[0] = s[1] = 0;
+  for (; i < h; ++i)
+    s[i & 1] += p[i];
+  for (size_t blocks; (blocks = run(n - i, MXU1_CSUM_SUM_MAX)) > 0;
+       i += blocks * 64) {
+    uint32_t k[2];
+    mxu1_csum_sum((const uint32_t *)(p + i), (int32_t)blocks, k);
+    s[i & 1] += k[0];
+    s[~i & 1] += k[1];
+  }
+  for (; i < n; ++i)
+    s[i & 1] += p[i];
+}
+
+uint32_t mxu1_inet_sum(uint32_t sum, const void *buf, size_t n)
+{
+  uint64_t s[2];
+  sum_bytes((const uint8_t *)buf, n, s);
+  s[0] = s[0] * 256 + s[1] + sum;
+  while (s[0] >> 16)
+    s[0] = (s[0] & 0xffff) + (s[0] >> 16);
+  return (uint32_t)s[0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reductions
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t mxu1_sum_u8(const uint8_t *p, size_t n)
+{
+  uint64_t s[2];
+  sum_bytes(p, n, s);
+  return s[0] + s[1];
+}
+
+int64_t mxu1_sum_s16(const int16_t *p, size_t n)
+{
+  int64_t s = 0;
+  size_t i = 0, h = head(p, 2 * n) / 2;
+
+  for (; i < h; ++i)
+    s += p[i];
+  for (size_t blocks; (blocks = run(2 * (n - i), MXU1_CSUM_SUM_S16_MAX)) > 0;
+       i += blocks * 32) {
+    int32_t k[2];
+    mxu1_csum_sum_s16((const uint32_t *)(p + i), (int32_t)blocks, k);
+    s += (int64_t)k[0] + k[1];
+  }
+  for (; i < n; ++i)
+    s += p[i];
+  return s;
+}
+
+void mxu1_minmax_u8(const uint8_t *p, size_t n, uint8_t *min, uint8_t *max)
+{
+  uint8_t lo = UINT8_MAX, hi = 0;
+  size_t i = 0, h = head(p, n);
+
+  for (; i < h; ++i) {
+    lo = p[i] < lo ? p[i] : lo;
+    hi = p[i] > hi ? p[i] : hi;
+  }
+  for (size_t blocks; (blocks = run(n - i, INT32_MAX)) > 0;
+       i += blocks * 64) {
+    uint32_t mm[2];
+    mxu1_csum_minmax_u8((const uint32_t *)(p + i), (int32_t)blocks, mm);
+    for (int sh = 0; sh < 32; sh += 8) {
+      const uint8_t l = (uint8_t)(mm[0] >> sh), u = (uint8_t)(mm[1] >> sh);
+      lo = l < lo ? l : lo;
+      hi = u > hi ? u : hi;
+    }
+  }
+  for (; i < n; ++i) {
+    lo = p[i] < lo ? p[i] : lo;
+    hi = p[i] > hi ? p[i] : hi;
+  }
+  *min = lo;
+  *max = hi;
+}
+
+void mxu1_minmax_s16(const int16_t *p, size_t n, int16_t *min, int16_t *max)
+{
+  int16_t lo = INT16_MAX, hi = INT16_MIN;
+  size_t i = 0, h = head(p, 2 * n) / 2;
+
+  for (; i < h; ++i) {
+    lo = p[i] < lo ? p[i] : lo;
+    hi = p[i] > hi ? p[i] : hi;
+  }
+  for (size_t blocks; (blocks = run(2 * (n - i), INT32_MAX)) > 0;
+       i += blocks * 32) {
+    uint32_t mm[2];
+    mxu1_csum_minmax_s16((const uint32_t *)(p + i), (int32_t)blocks, mm);
+    for (int sh = 0; sh < 32; sh += 16) {
+      const int16_t l = (int16_t)(mm[0] >> sh), u = (int16_t)(mm[1] >> sh);
+      lo = l < lo ? l : lo;
+      hi = u > hi ? u : hi;
+    }
+  }
+  for (; i < n; ++i) {
+    lo = p[i] < lo ? p[i] : lo;
+    hi = p[i] > hi ? p[i] : hi;
+  }
+  *min = lo;
+  *max = hi;
+}
+
+//  Four tables of counts, byte k of each word counted in table k, so that
+// a run of equal bytes is four independent load-add-store chains rather
+// than one. Short buffers are not worth clearing the tables for.
+void mxu1_histogram_u8(uint32_t hist[256], const uint8_t *p, size_t n)
+{
+  uint32_t t[3][256];
+  size_t i = 0, h = head(p, n);
+
+  if (n < 1024) {
+    mxu1_histogram_u8_c(hist, p, n);
+    return;
+  }
+  memset(t, 0, sizeof(t));
+  for (; i < h; ++i)
+    ++hist[p[i]];
+  for (; n - i >= 4; i += 4) {
+    uint32_t w;
+    memcpy(&w, p + i, 4);
+    ++hist[w & 255];
+    ++t[0][(w >> 8) & 255];
+    ++t[1][(w >> 16) & 255];
+    ++t[2][w >> 24];
+  }
+  for (; i < n; ++i)
+    ++hist[p[i]];
+  for (int v = 0; v < 256; ++v)
+    hist[v] += t[0][v] + t[1][v] + t[2][v];
+}
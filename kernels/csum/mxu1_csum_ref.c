@@ -0,0 +1,129 @@
+// mxu1_csum_ref.c
+//
+// Scalar C reference for the mxu1_csum.s checksums and reductions
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The definitions of the functions in mxu1_csum.h, one byte (or element) at
+// a time, which the MXU versions must match exactly. Modular sums are kept
+// reduced, 0 .. modulus - 1, after every step.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_csum.h"
+
+uint32_t mxu1_adler32_c(uint32_t adler, const void *buf, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+  uint32_t a = adler & 0xffff, b = adler >> 16;
+
+  for (size_t i = 0; i < n; ++i) {
+    a = (a + p[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return b << 16 | a;
+}
+
+uint32_t mxu1_fletcher16_c(uint32_t f, const void *buf, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+  uint32_t s1 = f & 0xff, s2 = (f >> 8) & 0xff;
+
+  for (size_t i = 0; i < n; ++i) {
+    s1 = (s1 + p[i]) % 255;
+    s2 = (s2 + s1) % 255;
+  }
+  return s2 << 8 | s1;
+}
+
+uint32_t mxu1_fletcher32_c(uint32_t f, const void *buf, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+  uint32_t s1 = f & 0xffff, s2 = f >> 16;
+
+  for (size_t i = 0; i < n; i += 2) {
+    const uint32_t w = p[i] | (i + 1 < n ? (uint32_t)p[i + 1] << 8 : 0);
+    s1 = (s1 + w) % 65535;
+    s2 = (s2 + s1) % 65535;
+  }
+  return s2 << 16 | s1;
+}
+
+uint32_t mxu1_inet_sum_c(uint32_t sum, const void *buf, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+  uint64_t s = sum;
+
+  for (size_t i = 0; i < n; i += 2)
+    s += (uint32_t)p[i] << 8 | (i + 1 < n ? p[i + 1] : 0);
+  while (s >> 16)
+    s = (s & 0xffff) + (s >> 16);
+  return (uint32_t)s;
+}
+
+uint64_t mxu1_sum_u8_c(const uint8_t *p, size_t n)
+{
+  uint64_t s = 0;
+  for (size_t i = 0; i < n; ++i)
+    s += p[i];
+  return s;
+}
+
+int64_t mxu1_sum_s16_c(const int16_t *p, size_t n)
+{
+  int64_t s = 0;
+  for (size_t i = 0; i < n; ++i)
+    s += p[i];
+  return s;
+}
+
+void mxu1_minmax_u8_c(const uint8_t *p, size_t n, uint8_t *min,
+                      uint8_t *max)
+{
+  uint8_t lo = UINT8_MAX, hi = 0;
+  for (size_t i = 0; i < n; ++i) {
+    lo = p[i] < lo ? p[i] : lo;
+    hi = p[i] > hi ? p[i] : hi;
+  }
+  *min = lo;
+  *max = hi;
+}
+
+void mxu1_minmax_s16_c(const int16_t *p, size_t n, int16_t *min,
+                       int16_t *max)
+{
+  int16_t lo = INT16_MAX, hi = INT16_MIN;
+  for (size_t i = 0; i < n; ++i) {
+    lo = p[i] < lo ? p[i] : lo;
+    hi = p[i] > hi ? p[i] : hi;
+  }
+  *min = lo;
+  *max = hi;
+}
+
+void mxu1_histogram_u8_c(uint32_t hist[256], const uint8_t *p, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    ++hist[p[i]];
+}
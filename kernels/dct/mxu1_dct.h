@@ -0,0 +1,87 @@
+// mxu1_dct.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 8x8 DCT/IDCT, 16-bit fixed point
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  8x8 forward and inverse DCT for JPEG and MPEG codecs, with the kernels in
+// mxu1_dct.s (d16mac in matrix form, see the comments there) and a C reference
+// for each (the _c functions, mxu1_dct_ref.c) that they match bit for bit.
+//
+// Blocks are int16_t[64] in row-major order, word aligned. Both transforms are
+// orthonormal (the JPEG definition):
+//     F(u,v) = 1/4 c(u) c(v) sum_x,y f(x,y) cos((2x+1)u pi/16) cos((2y+1)v pi/16)
+// with c(0) = 1/sqrt(2), c(k) = 1 otherwise, results rounded to integers.
+//
+// Accuracy: mxu1_idct8x8() meets IEEE 1180-1990 (peak error 1, overall mean
+// square error about 0.01 against the 0.02 limit; mxu1_dct_bench runs the full
+// test). The first pass keeps 4 fractional bits in 16 bits, so coefficients
+// are expected to be such that each row's 1-D IDCT stays within +-2047, which
+// holds for blocks that decode to pixels (or differences) within +-256 plus
+// quantization noise; larger values wrap. mxu1_fdct8x8() takes inputs in
+// -256..255 and is within 1 of the exact rounded transform.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/dct, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_dct.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_dct_ref.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_DCT_H
+#define MXU1_DCT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  In-place inverse DCT. Results are not clamped.
+void mxu1_idct8x8(int16_t block[64]);
+
+//  Fused dequantize + inverse DCT + clamp: each of coef[i] * quant[i] (kept
+// to 16 bits) is transformed, 'offset' is added (128 for JPEG's level shift,
+// 0 for MPEG intra blocks), and the result is clamped to 0..255 and stored as
+// an 8x8 block of pixels at 'dst'. 'quant' may be NULL when the coefficients
+// are already dequantized. 'dst' must be word aligned, 'dst_stride' a multiple
+// of 4. coef[] is not modified.
+void mxu1_idct8x8_put(const int16_t coef[64], const int16_t *quant,
+                      uint8_t *dst, int dst_stride, int offset);
+
+//  In-place forward DCT.
+void mxu1_fdct8x8(int16_t block[64]);
+
+// Scalar references (mxu1_dct_ref.c), same arguments and results
+void mxu1_idct8x8_c(int16_t block[64]);
+void mxu1_idct8x8_put_c(const int16_t coef[64], const int16_t *quant,
+                        uint8_t *dst, int dst_stride, int offset);
+void mxu1_fdct8x8_c(int16_t block[64]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_DCT_H
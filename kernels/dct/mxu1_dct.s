@@ -0,0 +1,373 @@
+# mxu1_dct.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 8x8 DCT/IDCT kernels, 16-bit fixed point
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, block layout and accuracy are described in mxu1_dct.h.
+#
+#  Both transforms are two passes of the same 1-D transform in matrix form,
+# each pass reading rows and writing its results transposed, so that the
+# second pass (the columns) is again a row pass and the block comes out the
+# right way round. A pass works on two rows at a time, xr1..xr4 and xr5..xr8,
+# each word holding two neighbouring coefficients (odd one in the upper half).
+# One constant word of two Q16 cosines (mxu1_dct_k) then feeds a d16mac per
+# row, which accumulates the odd-index product into XRa and the even-index one
+# into XRd:
+#
+#   IDCT: for outputs n and 7-n, XRa = sum of X[2j+1] * C[2j+1][n] (odd part)
+#         and XRd = sum of X[2j] * C[2j][n] (even part); out[n] = XRd + XRa,
+#         out[7-n] = XRd - XRa, a single d32add.
+#   FDCT: the row is first folded (q16add) into s[n] = x[n] + x[7-n] and
+#         -d[n] = x[7-n] - x[n], paired up as (-d[n], s[n]) (s32sfl), so that
+#         XRa = X[2p+1] and XRd = X[2p] directly.
+#
+# The rounding bias is put in the accumulators before the first d16mac. The
+# first pass keeps 4 (IDCT) or 3 (FDCT) fractional bits: d32sarl scales both
+# rows' results down and packs them into one word, which is a column pair of
+# the transposed output. The second pass must scale by more than d32sarl's
+# 15 bits: s32sfl takes the upper halves and q16sar shifts what is left.
+#
+# Register use: any xr, $v0, $v1, $t0..$t9 and $a0..$a3; 128 bytes of stack.
+# Leaf functions. The constants are addressed PC-relatively, so the code is
+# position independent without needing $gp.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+################################################################################
+#  Cosines C[k][n] = c(k)/2 * cos((2n+1)k*pi/16) in Q16, c(0) = 1/sqrt(2) and
+# c(k) = 1 otherwise, paired into words (low half first).
+#
+#  .Ldct_k returns their address in $t8: it branches-and-links over them, so
+# $ra is the table's own address, whatever the code is linked at.
+.Ldct_k:
+  move    $t8,  $ra
+  bal     .Ldct_k_end
+  nop
+  .type   mxu1_dct_k, @object
+mxu1_dct_k:
+  # IDCT, outputs n and 7-n: (C[2j][n], C[2j+1][n]) for j = 0..3
+  .hword  23170,  32138,  30274,  27246,  23170,  18205,  12540,   6393  # n = 0
+  .hword  23170,  27246,  12540,  -6393, -23170, -32138, -30274, -18205  # n = 1
+  .hword  23170,  18205, -12540, -32138, -23170,   6393,  30274,  27246  # n = 2
+  .hword  23170,   6393, -30274, -18205,  23170,  27246, -12540, -32138  # n = 3
+  # FDCT, outputs 2p and 2p+1: (C[2p][n], -C[2p+1][n]) for n = 0..3
+  .hword  23170, -32138,  23170, -27246,  23170, -18205,  23170,  -6393  # p = 0
+  .hword  30274, -27246,  12540,   6393, -12540,  32138, -30274,  18205  # p = 1
+  .hword  23170, -18205, -23170,  32138, -23170,  -6393,  23170, -27246  # p = 2
+  .hword  12540,  -6393, -30274,  18205,  30274, -27246, -12540,  32138  # p = 3
+  .size   mxu1_dct_k, .-mxu1_dct_k
+.Ldct_k_end:
+  jr      $t8
+  move    $t8,  $ra
+
+
+# Point $t8 at mxu1_dct_k (clobbers $v1; $ra is preserved)
+.macro DCT_CONSTS
+  move    $v1,  $ra
+  bal     .Ldct_k
+  nop
+  move    $ra,  $v1
+.endm
+
+# Load the two rows at \off(\src) into xr1..xr4 and xr5..xr8
+.macro DCT_LOAD2 src, off=0
+  s32ldd  xr1,  \src, \off
+  s32ldd  xr2,  \src, \off + 4
+  s32ldd  xr3,  \src, \off + 8
+  s32ldd  xr4,  \src, \off + 12
+  s32ldd  xr5,  \src, \off + 16
+  s32ldd  xr6,  \src, \off + 20
+  s32ldd  xr7,  \src, \off + 24
+  s32ldd  xr8,  \src, \off + 28
+.endm
+
+# Multiply the two loaded rows by the four constant words at \k($t8), into
+#  xr9 (XRa) and xr10 (XRd) for the first row, xr11 and xr12 for the second.
+#  The words of the first row are taken in the order \a0..\a3, those of the
+#  second in the order \b0..\b3. xr14 holds the preset: with \bias = 1,
+#  XRd = 2*xr14 and XRa = 0 (IDCT); with \bias = 2, both are xr14 (FDCT).
+.macro DCT_MAC4 k, bias, a0, a1, a2, a3, b0, b1, b2, b3
+  s32ldd  xr13, $t8, \k
+  s32ldd  xr15, $t8, \k + 4
+  .if \bias == 1
+    d32add  xr10, xr14, xr14, xr9,  AS
+    d32add  xr12, xr14, xr14, xr11, AS
+  .else
+    d32add  xr10, xr14, xr0,  xr9,  AA
+    d32add  xr12, xr14, xr0,  xr11, AA
+  .endif
+  d16mac  xr9,  \a0, xr13, xr10, AA, WW
+  d16mac  xr11, \b0, xr13, xr12, AA, WW
+  s32ldd  xr13, $t8, \k + 8
+  d16mac  xr9,  \a1, xr15, xr10, AA, WW
+  d16mac  xr11, \b1, xr15, xr12, AA, WW
+  s32ldd  xr15, $t8, \k + 12
+  d16mac  xr9,  \a2, xr13, xr10, AA, WW
+  d16mac  xr11, \b2, xr13, xr12, AA, WW
+  d16mac  xr9,  \a3, xr15, xr10, AA, WW
+  d16mac  xr11, \b3, xr15, xr12, AA, WW
+.endm
+
+# Scale the two rows' XRa results (xr9, xr11) into xr13 and their XRd results
+#  (xr10, xr12) into xr15, second row in the upper halves. Pass 1 shifts right
+#  by \sh; pass 2 by 16 + \sh.
+.macro DCT_PACK pass, sh
+  .if \pass == 1
+    d32sarl xr13, xr11, xr9,  \sh
+    d32sarl xr15, xr12, xr10, \sh
+  .else
+    s32sfl  xr13, xr11, xr9,  xr0, ptn3
+    s32sfl  xr15, xr12, xr10, xr0, ptn3
+    q16sar  xr13, xr13, xr15, xr15, \sh
+  .endif
+.endm
+
+# IDCT outputs n and 7-n of the two loaded rows, packed into xr13 and xr15
+.macro IDCT_OUT n, pass, sh
+  DCT_MAC4 (\n * 16), 1, xr1, xr2, xr3, xr4, xr5, xr6, xr7, xr8
+  d32add  xr9,  xr10, xr9,  xr10, AS
+  d32add  xr11, xr12, xr11, xr12, AS
+  DCT_PACK \pass, \sh
+.endm
+
+# One IDCT pass over the two loaded rows, written transposed (as a column
+#  pair) to \dst with a row stride of 16
+.macro IDCT_ROWS2 dst, pass, sh
+  .irp n, 0, 1, 2, 3
+    IDCT_OUT \n, \pass, \sh
+    s32std  xr13, \dst, \n * 16
+    s32std  xr15, \dst, (7 - \n) * 16
+  .endr
+.endm
+
+# Multiply \xa and \xb by the int16 pairs at \off(\q), keeping the low 16 bits
+.macro DCT_DEQUANT2 xa, xb, q, off
+  s32ldd  xr13, \q, \off
+  s32ldd  xr15, \q, \off + 4
+  d16mul  xr9,  \xa, xr13, xr10, WW
+  d16mul  xr11, \xb, xr15, xr12, WW
+  s32sfl  xr0,  xr9,  xr10, \xa, ptn3
+  s32sfl  xr0,  xr11, xr12, \xb, ptn3
+.endm
+
+# Fold a row \w0..\w3 = (x1,x0) .. (x7,x6) into (-d0,s0) in \w0, (-d2,s2)
+#  in \w1, (-d3,s3) in \w2 and (-d1,s1) in \w3
+.macro FDCT_FOLD w0, w1, w2, w3
+  q16add  \w0, \w3, \w0, \w3, AS, XW     # (s1,s0), (-d1,-d0)
+  q16add  \w1, \w2, \w1, \w2, AS, XW     # (s3,s2), (-d3,-d2)
+  s32sfl  \w3, \w3, \w0, \w0, ptn3
+  s32sfl  \w2, \w2, \w1, \w1, ptn3
+.endm
+
+# One FDCT pass over the two loaded rows, as IDCT_ROWS2
+.macro FDCT_ROWS2 dst, pass, sh
+  FDCT_FOLD xr1, xr2, xr3, xr4
+  FDCT_FOLD xr5, xr6, xr7, xr8
+  .irp p, 0, 1, 2, 3
+    DCT_MAC4 (64 + \p * 16), 2, xr1, xr4, xr2, xr3, xr5, xr8, xr6, xr7
+    DCT_PACK \pass, \sh
+    s32std  xr13, \dst, (2 * \p + 1) * 16
+    s32std  xr15, \dst, (2 * \p) * 16
+  .endr
+.endm
+
+# Outputs n and 7-n of the second column pair of mxu1_idct8x8_put, packed
+#  with the first pair's (parked at \col*16($sp)) into pixels \col..\col+3
+#  of rows \rowa and \rowb
+.macro IDCT_PUT_OUT n, col, rowa, rowb
+  IDCT_OUT \n, 2, 4
+  s32ldd  xr9,  $sp, \col * 16 + \n * 4
+  s32ldd  xr10, $sp, \col * 16 + (7 - \n) * 4
+  q16sat  xr13, xr13, xr9
+  q16sat  xr15, xr15, xr10
+  s32std  xr13, \rowa, \col
+  s32std  xr15, \rowb, \col
+.endm
+
+# Column pass of mxu1_idct8x8_put for columns \col..\col+3. The results of
+#  the first column pair are parked in the 32 bytes of stack buffer it has
+#  just read.
+.macro IDCT_PUT4 col
+  DCT_LOAD2 $sp, \col * 16
+  .irp n, 0, 1, 2, 3
+    IDCT_OUT \n, 2, 4
+    s32std  xr13, $sp, \col * 16 + \n * 4
+    s32std  xr15, $sp, \col * 16 + (7 - \n) * 4
+  .endr
+  DCT_LOAD2 $sp, (\col + 2) * 16
+  IDCT_PUT_OUT 0, \col, $t2, $v1
+  IDCT_PUT_OUT 1, \col, $t3, $v0
+  IDCT_PUT_OUT 2, \col, $t4, $t7
+  IDCT_PUT_OUT 3, \col, $t5, $t6
+.endm
+
+
+################################################################################
+# void mxu1_idct8x8(int16_t block[64])
+  .globl  mxu1_idct8x8
+  .type   mxu1_idct8x8, @function
+  .ent    mxu1_idct8x8
+mxu1_idct8x8:
+  addiu   $sp,  $sp,  -128
+  DCT_CONSTS
+
+  # Rows, into the stack buffer: bias 2^11, shift 12
+  li      $v0,  1 << 10
+  s32i2m  xr14, $v0
+  move    $t0,  $a0
+  move    $t1,  $sp
+  li      $t9,  4
+1:
+  DCT_LOAD2 $t0
+  IDCT_ROWS2 $t1, 1, 12
+  addiu   $t9,  $t9,  -1
+  addiu   $t0,  $t0,  32
+  bnez    $t9,  1b
+  addiu   $t1,  $t1,  4
+
+  # Columns, back into the block: bias 2^19, shift 20
+  lui     $v0,  (1 << 18) >> 16
+  s32i2m  xr14, $v0
+  move    $t0,  $sp
+  move    $t1,  $a0
+  li      $t9,  4
+2:
+  DCT_LOAD2 $t0
+  IDCT_ROWS2 $t1, 2, 4
+  addiu   $t9,  $t9,  -1
+  addiu   $t0,  $t0,  32
+  bnez    $t9,  2b
+  addiu   $t1,  $t1,  4
+
+  jr      $ra
+  addiu   $sp,  $sp,  128
+  .end    mxu1_idct8x8
+  .size   mxu1_idct8x8, .-mxu1_idct8x8
+
+
+################################################################################
+# void mxu1_idct8x8_put(const int16_t coef[64], const int16_t *quant,
+#                       uint8_t *dst, int dst_stride, int offset)
+  .globl  mxu1_idct8x8_put
+  .type   mxu1_idct8x8_put, @function
+  .ent    mxu1_idct8x8_put
+mxu1_idct8x8_put:
+  lw      $v0,  16($sp)                   # offset
+  addiu   $sp,  $sp,  -128
+  DCT_CONSTS
+
+  # Rows, dequantized unless quant is NULL, into the stack buffer
+  li      $t2,  1 << 10
+  s32i2m  xr14, $t2
+  move    $t0,  $a0
+  move    $t1,  $sp
+  li      $t9,  4
+1:
+  DCT_LOAD2 $t0
+  beqz    $a1,  2f
+  nop
+  DCT_DEQUANT2 xr1, xr2, $a1, 0
+  DCT_DEQUANT2 xr3, xr4, $a1, 8
+  DCT_DEQUANT2 xr5, xr6, $a1, 16
+  DCT_DEQUANT2 xr7, xr8, $a1, 24
+  addiu   $a1,  $a1,  32
+2:
+  IDCT_ROWS2 $t1, 1, 12
+  addiu   $t9,  $t9,  -1
+  addiu   $t0,  $t0,  32
+  bnez    $t9,  1b
+  addiu   $t1,  $t1,  4
+
+  # Columns: bias 2^19 + offset * 2^20, halved for the XRd/XRa preset
+  sll     $v0,  $v0,  19
+  lui     $t2,  (1 << 18) >> 16
+  addu    $v0,  $v0,  $t2
+  s32i2m  xr14, $v0
+
+  addu    $t3,  $a2,  $a3                 # $t2..$t7, $v0, $v1: rows 0..7
+  addu    $t4,  $t3,  $a3
+  addu    $t5,  $t4,  $a3
+  addu    $t6,  $t5,  $a3
+  addu    $t7,  $t6,  $a3
+  addu    $v0,  $t7,  $a3
+  addu    $v1,  $v0,  $a3
+  move    $t2,  $a2
+  IDCT_PUT4 0
+  IDCT_PUT4 4
+
+  jr      $ra
+  addiu   $sp,  $sp,  128
+  .end    mxu1_idct8x8_put
+  .size   mxu1_idct8x8_put, .-mxu1_idct8x8_put
+
+
+################################################################################
+# void mxu1_fdct8x8(int16_t block[64])
+  .globl  mxu1_fdct8x8
+  .type   mxu1_fdct8x8, @function
+  .ent    mxu1_fdct8x8
+mxu1_fdct8x8:
+  addiu   $sp,  $sp,  -128
+  DCT_CONSTS
+
+  # Rows, into the stack buffer: bias 2^12, shift 13
+  li      $v0,  1 << 12
+  s32i2m  xr14, $v0
+  move    $t0,  $a0
+  move    $t1,  $sp
+  li      $t9,  4
+1:
+  DCT_LOAD2 $t0
+  FDCT_ROWS2 $t1, 1, 13
+  addiu   $t9,  $t9,  -1
+  addiu   $t0,  $t0,  32
+  bnez    $t9,  1b
+  addiu   $t1,  $t1,  4
+
+  # Columns, back into the block: bias 2^18, shift 19
+  lui     $v0,  (1 << 18) >> 16
+  s32i2m  xr14, $v0
+  move    $t0,  $sp
+  move    $t1,  $a0
+  li      $t9,  4
+2:
+  DCT_LOAD2 $t0
+  FDCT_ROWS2 $t1, 2, 3
+  addiu   $t9,  $t9,  -1
+  addiu   $t0,  $t0,  32
+  bnez    $t9,  2b
+  addiu   $t1,  $t1,  4
+
+  jr      $ra
+  addiu   $sp,  $sp,  128
+  .end    mxu1_fdct8x8
+  .size   mxu1_fdct8x8, .-mxu1_fdct8x8
+
+# vim:shiftwidth=2:expandtab:syntax=asm
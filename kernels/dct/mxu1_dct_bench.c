@@ -0,0 +1,336 @@
+// mxu1_dct_bench.c
+//
+// IEEE 1180 conformance test and benchmark of the MXU1 8x8 DCT/IDCT kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  1. The IEEE 1180-1990 procedure on mxu1_idct8x8(): for each input range
+//     (-256..255, -5..5, -300..300) and sign, 10000 blocks from the standard's
+//     random generator are transformed by a double-precision FDCT, rounded and
+//     clipped to -2048..2047, then inverse transformed both in double precision
+//     and by the kernel; outputs clipped to -256..255 are compared against the
+//     standard's limits. An all-zero block must come out all zero.
+//  2. mxu1_fdct8x8() against the exact rounded FDCT (peak and mean square).
+//  3. Every kernel against its C reference, bit for bit, on random blocks.
+//  4. Blocks per second for each kernel and its C reference.
+//
+// Build and run on the target (kernels/dct):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_dct_bench
+//         mxu1_dct_bench.c mxu1_dct_ref.c mxu1_dct.s ../dispatch/mxu1_cpu.c -lm
+//     ./mxu1_dct_bench [seconds per test, default 1]
+// Exits non-zero if any check fails.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_dct.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Double-precision reference transforms
+////////////////////////////////////////////////////////////////////////////////
+
+static double cosines[8][8];    // c(k)/2 * cos((2n+1)k pi/16)
+
+static void init_cosines(void)
+{
+  for (int k = 0; k < 8; ++k)
+    for (int n = 0; n < 8; ++n)
+      cosines[k][n] = (k ? 0.5 : sqrt(0.125)) * cos((2 * n + 1) * k * M_PI / 16);
+}
+
+static void fdct_double(double b[64])
+{
+  double t[64];
+  for (int u = 0; u < 8; ++u)
+    for (int x = 0; x < 8; ++x) {
+      double s = 0;
+      for (int y = 0; y < 8; ++y)
+        s += cosines[u][y] * b[y * 8 + x];
+      t[u * 8 + x] = s;
+    }
+  for (int u = 0; u < 8; ++u)
+    for (int v = 0; v < 8; ++v) {
+      double s = 0;
+      for (int x = 0; x < 8; ++x)
+        s += cosines[v][x] * t[u * 8 + x];
+      b[u * 8 + v] = s;
+    }
+}
+
+static void idct_double(double b[64])
+{
+  double t[64];
+  for (int y = 0; y < 8; ++y)
+    for (int v = 0; v < 8; ++v) {
+      double s = 0;
+      for (int u = 0; u < 8; ++u)
+        s += cosines[u][y] * b[u * 8 + v];
+      t[y * 8 + v] = s;
+    }
+  for (int y = 0; y < 8; ++y)
+    for (int x = 0; x < 8; ++x) {
+      double s = 0;
+      for (int v = 0; v < 8; ++v)
+        s += cosines[v][x] * t[y * 8 + v];
+      b[y * 8 + x] = s;
+    }
+}
+
+static double clip(double v, double lo, double hi)
+{
+  return v < lo ? lo : v > hi ? hi : v;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// IEEE 1180
+////////////////////////////////////////////////////////////////////////////////
+
+// The standard's generator: uniform integers in -lo..hi
+static long ieee_seed;
+static long ieee_rand(long lo, long hi)
+{
+  double x;
+  ieee_seed = ieee_seed * 1103515245 + 12345;
+  x = (double)(ieee_seed & 0x7ffffffe) / 0x7fffffff;
+  return (long)(x * (lo + hi + 1)) - lo;
+}
+
+static int ieee1180(void (*idct)(int16_t *), const char *name)
+{
+  static const long ranges[3][2] = { { 256, 255 }, { 5, 5 }, { 300, 300 } };
+  int ok = 1;
+
+  printf("IEEE 1180, %s:\n", name);
+  for (int r = 0; r < 3; ++r) {
+    for (int sign = 1; sign >= -1; sign -= 2) {
+      double sq[64] = { 0 }, sum[64] = { 0 };
+      double pmse = 0, omse = 0, pme = 0, ome = 0;
+      int peak = 0, pass;
+
+      ieee_seed = 1;
+      for (int i = 0; i < 10000; ++i) {
+        double ref[64];
+        int16_t blk[64] __attribute__((aligned(4)));
+
+        for (int j = 0; j < 64; ++j)
+          ref[j] = sign * ieee_rand(ranges[r][0], ranges[r][1]);
+        fdct_double(ref);
+        for (int j = 0; j < 64; ++j) {
+          ref[j] = clip(floor(ref[j] + 0.5), -2048, 2047);
+          blk[j] = (int16_t)ref[j];
+        }
+        idct_double(ref);
+        idct(blk);
+        for (int j = 0; j < 64; ++j) {
+          int e = (int)clip(blk[j], -256, 255) -
+                  (int)clip(floor(ref[j] + 0.5), -256, 255);
+          peak = abs(e) > peak ? abs(e) : peak;
+          sq[j] += e * e;
+          sum[j] += e;
+        }
+      }
+      for (int j = 0; j < 64; ++j) {
+        pmse = sq[j] / 10000 > pmse ? sq[j] / 10000 : pmse;
+        pme = fabs(sum[j]) / 10000 > pme ? fabs(sum[j]) / 10000 : pme;
+        omse += sq[j];
+        ome += sum[j];
+      }
+      omse /= 640000;
+      ome /= 640000;
+      pass = peak <= 1 && pmse <= 0.06 && omse <= 0.02 && pme <= 0.015 &&
+             fabs(ome) <= 0.0015;
+      printf("  -%ld..%ld %s: peak %d, pmse %.4f, omse %.4f, pme %.4f, ome %+.5f  %s\n",
+             ranges[r][0], ranges[r][1], sign > 0 ? "+" : "-", peak, pmse, omse,
+             pme, ome, pass ? "ok" : "FAIL");
+      ok &= pass;
+    }
+  }
+
+  {
+    int16_t zero[64] __attribute__((aligned(4))) = { 0 };
+    idct(zero);
+    for (int j = 0; j < 64; ++j)
+      if (zero[j]) {
+        printf("  zero block: FAIL\n");
+        ok = 0;
+        break;
+      }
+  }
+  return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FDCT accuracy and bit-exactness
+////////////////////////////////////////////////////////////////////////////////
+
+static int fdct_accuracy(void)
+{
+  double sq = 0;
+  int peak = 0;
+
+  srand(1);
+  for (int i = 0; i < 10000; ++i) {
+    int16_t blk[64] __attribute__((aligned(4)));
+    double ref[64];
+    for (int j = 0; j < 64; ++j) {
+      // Every 8th block at the extremes of the range
+      blk[j] = i % 8 ? rand() % 512 - 256 : (rand() & 1 ? -256 : 255);
+      ref[j] = blk[j];
+    }
+    fdct_double(ref);
+    mxu1_fdct8x8(blk);
+    for (int j = 0; j < 64; ++j) {
+      int e = blk[j] - (int)floor(ref[j] + 0.5);
+      peak = abs(e) > peak ? abs(e) : peak;
+      sq += e * e;
+    }
+  }
+  printf("FDCT: peak error %d, mean square error %.4f  %s\n", peak, sq / 640000,
+         peak <= 1 ? "ok" : "FAIL");
+  return peak <= 1;
+}
+
+static void random_coefs(int16_t blk[64], int range)
+{
+  for (int j = 0; j < 64; ++j)
+    blk[j] = rand() % 4 ? 0 : rand() % (2 * range) - range;
+}
+
+static int bit_exact(void)
+{
+  int ok = 1;
+
+  srand(2);
+  for (int i = 0; i < 10000 && ok; ++i) {
+    int16_t a[64] __attribute__((aligned(4))), b[64], q[64];
+    uint8_t pa[8 * 12] __attribute__((aligned(4))), pb[8 * 12];
+
+    random_coefs(a, i & 1 ? 2048 : 256);
+    memcpy(b, a, sizeof(a));
+    mxu1_idct8x8(a);
+    mxu1_idct8x8_c(b);
+    ok &= !memcmp(a, b, sizeof(a));
+
+    random_coefs(a, 64);
+    for (int j = 0; j < 64; ++j)
+      q[j] = 1 + rand() % 16;
+    memset(pa, 0, sizeof(pa));
+    memset(pb, 0, sizeof(pb));
+    mxu1_idct8x8_put(a, i & 2 ? q : NULL, pa, 12, i & 4 ? 128 : 0);
+    mxu1_idct8x8_put_c(a, i & 2 ? q : NULL, pb, 12, i & 4 ? 128 : 0);
+    ok &= !memcmp(pa, pb, sizeof(pa));
+
+    for (int j = 0; j < 64; ++j)
+      a[j] = b[j] = rand() % 512 - 256;
+    mxu1_fdct8x8(a);
+    mxu1_fdct8x8_c(b);
+    ok &= !memcmp(a, b, sizeof(a));
+  }
+  printf("MXU vs C reference, bit for bit: %s\n", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Timing
+////////////////////////////////////////////////////////////////////////////////
+
+#define NBLOCKS 64
+
+static int16_t coefs[NBLOCKS][64] __attribute__((aligned(4)));
+static int16_t work[NBLOCKS][64] __attribute__((aligned(4)));
+static int16_t quant[64] __attribute__((aligned(4)));
+static uint8_t pixels[8 * 64] __attribute__((aligned(4)));
+
+typedef void (*block_fn)(int i);
+
+static void run_idct(int i)     { mxu1_idct8x8(work[i]); }
+static void run_idct_c(int i)   { mxu1_idct8x8_c(work[i]); }
+static void run_fdct(int i)     { mxu1_fdct8x8(work[i]); }
+static void run_fdct_c(int i)   { mxu1_fdct8x8_c(work[i]); }
+static void run_put(int i)      { mxu1_idct8x8_put(coefs[i], quant, pixels + (i & 7) * 8, 64, 128); }
+static void run_put_c(int i)    { mxu1_idct8x8_put_c(coefs[i], quant, pixels + (i & 7) * 8, 64, 128); }
+
+static double blocks_per_s(block_fn f, double secs)
+{
+  unsigned long blocks = 0;
+  double t0 = now(), t;
+
+  do {
+    // The in-place transforms start over from the same data each round
+    memcpy(work, coefs, sizeof(work));
+    for (int i = 0; i < NBLOCKS; ++i)
+      f(i);
+    blocks += NBLOCKS;
+    t = now() - t0;
+  } while (t < secs);
+  return blocks / t;
+}
+
+int main(int argc, char **argv)
+{
+  static const struct {
+    const char *name;
+    block_fn    mxu, c;
+  } tests[] = {
+    { "idct",             run_idct, run_idct_c },
+    { "dequant+idct+put", run_put,  run_put_c  },
+    { "fdct",             run_fdct, run_fdct_c },
+  };
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  int ok = 1;
+
+  mxu1_cpu_enable();
+  init_cosines();
+
+  ok &= ieee1180(mxu1_idct8x8, "mxu1_idct8x8");
+  ok &= fdct_accuracy();
+  ok &= bit_exact();
+
+  srand(3);
+  for (int i = 0; i < NBLOCKS; ++i)
+    random_coefs(coefs[i], 64);
+  for (int j = 0; j < 64; ++j)
+    quant[j] = 1 + j / 4;
+
+  printf("blocks/s (MXU vs C):\n");
+  for (unsigned t = 0; t < sizeof(tests) / sizeof(tests[0]); ++t) {
+    double m = blocks_per_s(tests[t].mxu, secs);
+    double c = blocks_per_s(tests[t].c, secs);
+    printf("  %-17s %10.0f %10.0f  x%.2f\n", tests[t].name, m, c, m / c);
+  }
+
+  return !ok;
+}
@@ -0,0 +1,131 @@
+// mxu1_dct_ref.c
+//
+// Scalar C reference for the mxu1_dct.s 8x8 DCT/IDCT kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The same arithmetic as mxu1_dct.s, step for step: 16x16-bit products summed
+// in 32 bits (wrapping as the MXU does), rounded by a bias and an arithmetic
+// shift, and truncated to 16 bits between passes. The results are therefore
+// bit-exact with the MXU kernels for every input, not just close to them.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_dct.h"
+
+// C[k][n] = c(k)/2 * cos((2n+1)k*pi/16) in Q16, as in mxu1_dct_k
+static const int16_t dct_k[8][8] = {
+  { 23170,  23170,  23170,  23170,  23170,  23170,  23170,  23170 },
+  { 32138,  27246,  18205,   6393,  -6393, -18205, -27246, -32138 },
+  { 30274,  12540, -12540, -30274, -30274, -12540,  12540,  30274 },
+  { 27246,  -6393, -32138, -18205,  18205,  32138,   6393, -27246 },
+  { 23170, -23170, -23170,  23170,  23170, -23170, -23170,  23170 },
+  { 18205, -32138,   6393,  27246, -27246,  -6393,  32138, -18205 },
+  { 12540, -30274,  30274, -12540, -12540,  30274, -30274,  12540 },
+  {  6393, -18205,  27246, -32138,  32138, -27246,  18205,  -6393 }
+};
+
+static inline uint32_t mul(int16_t a, int16_t b)
+{
+  return (uint32_t)((int32_t)a * b);
+}
+
+// Scale a 32-bit sum down: by 'sh' in the first pass, by 16 then 'sh' in
+//  the second (d32sarl, or s32sfl then q16sar)
+static inline int16_t scale(uint32_t v, int pass, int sh)
+{
+  if (pass == 1)
+    return (int16_t)((int32_t)v >> sh);
+  return (int16_t)((int16_t)((int32_t)v >> 16) >> sh);
+}
+
+// One IDCT pass: rows of 'in', transposed into 'out'. 'half' is half the bias.
+static void idct_pass(const int16_t *in, int16_t *out, int pass, int sh,
+                      uint32_t half)
+{
+  for (int r = 0; r < 8; ++r, in += 8) {
+    for (int n = 0; n < 4; ++n) {
+      uint32_t odd = 0, even = 2 * half;
+      for (int j = 0; j < 4; ++j) {
+        odd  += mul(in[2 * j + 1], dct_k[2 * j + 1][n]);
+        even += mul(in[2 * j],     dct_k[2 * j][n]);
+      }
+      out[n * 8 + r]       = scale(even + odd, pass, sh);
+      out[(7 - n) * 8 + r] = scale(even - odd, pass, sh);
+    }
+  }
+}
+
+// One FDCT pass, as idct_pass(); 'bias' is the full bias
+static void fdct_pass(const int16_t *in, int16_t *out, int pass, int sh,
+                      uint32_t bias)
+{
+  for (int r = 0; r < 8; ++r, in += 8) {
+    int16_t s[4], nd[4];
+    for (int n = 0; n < 4; ++n) {
+      s[n]  = (int16_t)(in[n] + in[7 - n]);
+      nd[n] = (int16_t)(in[7 - n] - in[n]);
+    }
+    for (int p = 0; p < 4; ++p) {
+      uint32_t odd = bias, even = bias;
+      for (int n = 0; n < 4; ++n) {
+        odd  += mul(nd[n], (int16_t)-dct_k[2 * p + 1][n]);
+        even += mul(s[n],  dct_k[2 * p][n]);
+      }
+      out[(2 * p + 1) * 8 + r] = scale(odd, pass, sh);
+      out[2 * p * 8 + r]       = scale(even, pass, sh);
+    }
+  }
+}
+
+void mxu1_idct8x8_c(int16_t block[64])
+{
+  int16_t tmp[64];
+  idct_pass(block, tmp, 1, 12, 1 << 10);
+  idct_pass(tmp, block, 2, 4, 1 << 18);
+}
+
+void mxu1_idct8x8_put_c(const int16_t coef[64], const int16_t *quant,
+                        uint8_t *dst, int dst_stride, int offset)
+{
+  int16_t in[64], tmp[64], out[64];
+
+  for (int i = 0; i < 64; ++i)
+    in[i] = quant ? (int16_t)mul(coef[i], quant[i]) : coef[i];
+  idct_pass(in, tmp, 1, 12, 1 << 10);
+  idct_pass(tmp, out, 2, 4, (1u << 18) + ((uint32_t)offset << 19));
+
+  for (int y = 0; y < 8; ++y, dst += dst_stride)
+    for (int x = 0; x < 8; ++x) {
+      int v = out[y * 8 + x];
+      dst[x] = v < 0 ? 0 : v > 255 ? 255 : v;
+    }
+}
+
+void mxu1_fdct8x8_c(int16_t block[64])
+{
+  int16_t tmp[64];
+  fdct_pass(block, tmp, 1, 13, 1 << 12);
+  fdct_pass(tmp, block, 2, 3, 1 << 18);
+}
@@ -0,0 +1,182 @@
+// mxu1_cpu.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 runtime detection and enabling of the MXU
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Detection and mxu1_cpu_enable(); see mxu1_cpu.h. The probe is only
+// compiled for MIPS: built for anything else, detection finds no MXU unless
+// MXU1_CPU says otherwise.
+////////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <ctype.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mxu1_cpu.h"
+
+//  MXU1_CPU as a level, or -1 for "detect"
+static int forced_level(void)
+{
+  static const struct {
+    const char *name;
+    int         level;
+  } names[] = {
+    { "none", MXU1_CPU_NONE }, { "0", MXU1_CPU_NONE },
+    { "rev1", MXU1_CPU_REV1 }, { "1", MXU1_CPU_REV1 },
+    { "rev2", MXU1_CPU_REV2 }, { "2", MXU1_CPU_REV2 }
+  };
+  const char *v = getenv("MXU1_CPU");
+
+  for (size_t i = 0; v && i < sizeof(names) / sizeof(names[0]); ++i)
+    if (!strcmp(v, names[i].name))
+      return names[i].level;
+  return -1;
+}
+
+//  Whether 'line', lowercased, contains 'word' (lowercase) on its own
+static int has_word(const char *line, const char *word)
+{
+  const size_t n = strlen(word);
+
+  for (const char *p = line; *p; ++p) {
+    size_t i = 0;
+    while (i < n && tolower((unsigned char)p[i]) == word[i])
+      ++i;
+    if (i == n && (p == line || !isalnum((unsigned char)p[-1])) &&
+        !isalnum((unsigned char)p[n]))
+      return 1;
+  }
+  return 0;
+}
+
+//  1 if /proc/cpuinfo names an Ingenic XBurst core or lists the MXU among
+// the ASEs, 0 if not, -1 if it cannot be read
+static int cpuinfo(void)
+{
+  FILE *f = fopen("/proc/cpuinfo", "r");
+  char line[512];
+  int found = 0;
+
+  if (!f)
+    return -1;
+  while (!found && fgets(line, sizeof(line), f)) {
+    if (!strncmp(line, "ASEs implemented", 16))
+      found = has_word(line, "mxu");
+    else if (!strncmp(line, "cpu model", 9) ||
+             !strncmp(line, "system type", 11))
+      found = has_word(line, "ingenic") && has_word(line, "xburst");
+  }
+  fclose(f);
+  return found;
+}
+
+#if defined(__mips__)
+
+__asm__(".include \"mxu1_as_macros.s.h\"");
+
+static sigjmp_buf probe_jump;
+
+static void probe_sigill(int sig)
+{
+  (void)sig;
+  siglongjmp(probe_jump, 1);
+}
+
+//  Whether the CPU has an MXU: MXU_EN written to xr16 and read back, and a
+// pattern through xr1; MXU1_CPU_NONE if either opcode traps or does not
+// hold what it was given. Nothing readable here differs between rev1 and
+// rev2 (the other MXU_CR bits are rounding controls, RD_EN and BIAS, on
+// both), so an MXU found is reported as MXU1_CPU_REV1, the baseline every
+// kernel is written for. The SIGILL handler is the probe's only while it
+// runs.
+static mxu1_cpu_level probe(void)
+{
+  const uint32_t pattern = 0x5a3cc3a5u;
+  struct sigaction sa, old;
+  volatile mxu1_cpu_level level = MXU1_CPU_NONE;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = probe_sigill;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGILL, &sa, &old))
+    return MXU1_CPU_NONE;
+  if (!sigsetjmp(probe_jump, 1)) {
+    uint32_t cr, x;
+    __asm__ __volatile__("li     $t0, 1\n\t"
+                         "s32i2m xr16, $t0\n\t"
+                         "s32m2i xr16, $t0\n\t"
+                         "move   %0, $t0\n\t"
+                         "move   $t1, %2\n\t"
+                         "s32i2m xr1, $t1\n\t"
+                         "s32m2i xr1, $t1\n\t"
+                         "move   %1, $t1"
+                         : "=&r"(cr), "=&r"(x) : "r"(pattern) : "t0", "t1");
+    if ((cr & 1) && x == pattern)
+      level = MXU1_CPU_REV1;
+  }
+  sigaction(SIGILL, &old, NULL);
+  return level;
+}
+
+void mxu1_cpu_enable(void)
+{
+  __asm__ __volatile__("li     $t0, 1\n\t"
+                       "s32i2m xr16, $t0" ::: "t0");
+}
+
+#else
+
+static mxu1_cpu_level probe(void)
+{
+  return MXU1_CPU_NONE;
+}
+
+void mxu1_cpu_enable(void)
+{
+}
+
+#endif
+
+mxu1_cpu_level mxu1_cpu_detect(mxu1_cpu_info *info)
+{
+  static int probed = -1;
+  mxu1_cpu_info i;
+  const int forced = forced_level();
+
+  i.forced = forced >= 0;
+  i.cpuinfo = cpuinfo();
+  if (!i.forced && i.cpuinfo == 1 && probed < 0)
+    probed = probe();
+  i.probe = probed < 0 ? MXU1_CPU_NONE : (mxu1_cpu_level)probed;
+  i.level = i.forced ? (mxu1_cpu_level)forced : i.probe;
+  if (info)
+    *info = i;
+  return i.level;
+}
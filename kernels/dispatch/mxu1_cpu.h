@@ -0,0 +1,75 @@
+// mxu1_cpu.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 runtime detection and enabling of the MXU
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Whether the MXU is there, and turning it on: the detection half of
+// kernels/dispatch, on its own so that the benchmarks and code that calls
+// one module directly can link it without every module's objects. How
+// mxu1_cpu_detect() decides is described in mxu1_dispatch.h.
+//
+//     if (mxu1_cpu_detect(NULL) > MXU1_CPU_NONE)
+//       mxu1_cpu_enable();
+//
+// Build (kernels/dispatch, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_cpu.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_CPU_H
+#define MXU1_CPU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  MXU1_CPU_NONE = 0,
+  MXU1_CPU_REV1 = 1,
+  MXU1_CPU_REV2 = 2
+} mxu1_cpu_level;
+
+//  What detection found, for logs and the benchmark
+typedef struct {
+  mxu1_cpu_level level;          // the answer
+  int            forced;         // 1 if MXU1_CPU gave it
+  int            cpuinfo;        // 1 an MXU core, 0 not, -1 unreadable
+  mxu1_cpu_level probe;          // what the probe found, if it ran
+} mxu1_cpu_info;
+
+//  Runs detection as described in mxu1_dispatch.h (the probe at most once
+// a process)
+mxu1_cpu_level mxu1_cpu_detect(mxu1_cpu_info *info);
+
+//  Sets MXU_CR to MXU_EN alone in the calling thread: rounding (RD_EN) off,
+// which is what the kernels and their C versions compute with. Only call
+// it when mxu1_cpu_detect() found an MXU.
+void mxu1_cpu_enable(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_CPU_H
@@ -0,0 +1,79 @@
+// mxu1_dispatch.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 MXU/C function dispatch
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The function sets and the constructor that resolves mxu1_fn; see
+// mxu1_dispatch.h. Detection is in mxu1_cpu.c.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include "mxu1_dispatch.h"
+
+#define MXU1_DISPATCH_MXU(ret, name, params) mxu1_##name,
+#define MXU1_DISPATCH_C(ret, name, params)   mxu1_##name##_c,
+
+const mxu1_functions mxu1_functions_mxu = {
+  MXU1_DISPATCH_FUNCTIONS(MXU1_DISPATCH_MXU)
+};
+
+const mxu1_functions mxu1_functions_c = {
+  MXU1_DISPATCH_FUNCTIONS(MXU1_DISPATCH_C)
+};
+
+mxu1_functions mxu1_fn = {
+  MXU1_DISPATCH_FUNCTIONS(MXU1_DISPATCH_C)
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Dispatch
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_dispatch_bind(mxu1_cpu_level level)
+{
+  if (level > MXU1_CPU_NONE) {
+    mxu1_cpu_enable();
+    mxu1_fn = mxu1_functions_mxu;
+  } else {
+    mxu1_fn = mxu1_functions_c;
+  }
+}
+
+mxu1_cpu_level mxu1_dispatch_init(void)
+{
+  static int bound = -1;
+
+  if (bound < 0) {
+    bound = mxu1_cpu_detect(NULL);
+    mxu1_dispatch_bind((mxu1_cpu_level)bound);
+  }
+  return (mxu1_cpu_level)bound;
+}
+
+__attribute__((constructor)) static void resolve(void)
+{
+  mxu1_dispatch_init();
+}
@@ -0,0 +1,229 @@
+// mxu1_dispatch.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 runtime detection and MXU/C function dispatch
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  One binary for SoCs with and without the MXU: mxu1_fn holds a pointer to
+// either the MXU or the C (_c) version of every function the kernels/
+// modules export, chosen once at startup, and callers go through it:
+//     mxu1_fn.adler32(1, buf, n);
+//     mxu1_fn.h264_qpel_put(dst, src, stride, 16, dx, dy);
+// A call is then a load of the pointer and an indirect call, what a call
+// into a shared library through its PLT costs anyway: nothing is checked
+// per call. mxu1_fn starts out all C, so calls made before it is resolved
+// (from other constructors, say) still work.
+//
+//  The choice (mxu1_cpu_detect(), mxu1_cpu.h) is, in order:
+//   - the environment variable MXU1_CPU, if set to one of "none" (or "0"),
+//     "rev1" (or "1") or "rev2" (or "2"): taken as is, nothing is probed,
+//     so the C versions can be run on an MXU board and either set on any
+//     MIPS Linux, qemu-user included; "auto" or anything else detects;
+//   - /proc/cpuinfo, which must name an Ingenic XBurst core or list "mxu"
+//     among its ASEs: other vendors' cores give the same SPECIAL2 opcodes
+//     instructions of their own, so the probe never runs on them;
+//   - the probe: MXU_CR.MXU_EN (bit 0 of xr16) set with s32i2m and read
+//     back with s32m2i, and a pattern through xr1, under a SIGILL handler.
+//     It finds an MXU, not its revision: the rest of MXU_CR is RD_EN and
+//     BIAS (bits 1 and 2), rounding controls on either revision, so a found
+//     MXU is reported as rev1. Only MXU1_CPU gives rev2.
+// The MXU versions cover rev1 and rev2 alike; the level is reported for
+// code that cares.
+//
+//  Resolution runs from a constructor before main() (GCC's constructor
+// attribute), and leaves the MXU enabled in that thread when it picks the
+// MXU. Threads started before then, or under a kernel that does not copy
+// the MXU state to new threads, call mxu1_cpu_enable() first. Real ifuncs
+// are not used: their resolvers run before libc can read files or the
+// environment, and uClibc and musl, common on these boards, lack them.
+//
+// Build (kernels/dispatch, mipsel cross toolchain), with every module's
+// objects (see each header):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_dispatch.c
+//         mxu1_cpu.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_DISPATCH_H
+#define MXU1_DISPATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../audio/mxu1_audio.h"
+#include "../blas/mxu1_blas.h"
+#include "../csum/mxu1_csum.h"
+#include "../dct/mxu1_dct.h"
+#include "../gfx/mxu1_gfx.h"
+#include "../mc/mxu1_mc.h"
+#include "../me/mxu1_me.h"
+#include "../mem/mxu1_mem.h"
+#include "../nn/mxu1_nn.h"
+#include "../rank/mxu1_rank.h"
+#include "../yuv/mxu1_yuv.h"
+#include "mxu1_cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Dispatch
+////////////////////////////////////////////////////////////////////////////////
+
+//  Every dispatched function, X(return type, name without mxu1_, params):
+// mxu1_<name> and mxu1_<name>_c exist with that prototype
+#define MXU1_DISPATCH_FUNCTIONS(X)                                            \
+  X(void, audio_fir_apply, (mxu1_audio_fir *f, uint32_t *dst,                 \
+                            const uint32_t *src, int frames))                 \
+  X(void, audio_biquad_apply, (mxu1_audio_biquad *s, int sections,            \
+                               uint32_t *dst, const uint32_t *src,            \
+                               int frames))                                   \
+  X(void, audio_biquad32_apply, (mxu1_audio_biquad32 *s, int sections,        \
+                                 uint32_t *dst, const uint32_t *src,          \
+                                 int frames))                                 \
+  X(int, audio_resample, (mxu1_audio_resampler *r, uint32_t *dst,             \
+                          const uint32_t *src, int frames))                   \
+  X(int32_t, blas_dot_q15, (const int16_t *x, const int16_t *y, int n))       \
+  X(int64_t, blas_dot_q31, (const int32_t *x, const int32_t *y, int n))       \
+  X(void, blas_axpy_q15, (int16_t *y, int16_t a, const int16_t *x, int n))    \
+  X(void, blas_mat4_apply, (const mxu1_blas_mat4 *m, int16_t *dst,            \
+                            const int16_t *src, int count))                   \
+  X(void, blas_gemv_q15, (int16_t *y, const int16_t *a, int lda,              \
+                          const int16_t *x, int m, int n, int shift))         \
+  X(void, blas_gemm_q15, (int16_t *c, int ldc, const int16_t *a, int lda,     \
+                          const int16_t *b, int ldb, int m, int n, int k,     \
+                          int shift))                                         \
+  X(uint32_t, adler32, (uint32_t adler, const void *buf, size_t n))           \
+  X(uint32_t, fletcher16, (uint32_t f, const void *buf, size_t n))            \
+  X(uint32_t, fletcher32, (uint32_t f, const void *buf, size_t n))            \
+  X(uint32_t, inet_sum, (uint32_t sum, const void *buf, size_t n))            \
+  X(uint64_t, sum_u8, (const uint8_t *p, size_t n))                           \
+  X(int64_t, sum_s16, (const int16_t *p, size_t n))                           \
+  X(void, minmax_u8, (const uint8_t *p, size_t n, uint8_t *min,               \
+                      uint8_t *max))                                          \
+  X(void, minmax_s16, (const int16_t *p, size_t n, int16_t *min,              \
+                       int16_t *max))                                         \
+  X(void, histogram_u8, (uint32_t hist[256], const uint8_t *p, size_t n))     \
+  X(void, idct8x8, (int16_t block[64]))                                       \
+  X(void, idct8x8_put, (const int16_t coef[64], const int16_t *quant,         \
+                        uint8_t *dst, int dst_stride, int offset))            \
+  X(void, fdct8x8, (int16_t block[64]))                                       \
+  X(void, gfx_blend, (const mxu1_gfx_image *dst, int x, int y,                \
+                      const mxu1_gfx_image *src, mxu1_gfx_op op, int alpha))  \
+  X(void, gfx_half, (const mxu1_gfx_image *dst, const mxu1_gfx_image *src))   \
+  X(void, gfx_double, (const mxu1_gfx_image *dst,                             \
+                       const mxu1_gfx_image *src))                            \
+  X(void, gfx_scale, (const mxu1_gfx_image *dst, const mxu1_gfx_image *src,   \
+                      void *scratch))                                         \
+  X(void, h264_qpel_put, (uint8_t *dst, const uint8_t *src, int stride,       \
+                          int size, int dx, int dy))                          \
+  X(void, h264_qpel_avg, (uint8_t *dst, const uint8_t *src, int stride,       \
+                          int size, int dx, int dy))                          \
+  X(void, h264_chroma_put, (uint8_t *dst, const uint8_t *src, int stride,     \
+                            int w, int h, int x, int y))                      \
+  X(void, h264_chroma_avg, (uint8_t *dst, const uint8_t *src, int stride,     \
+                            int w, int h, int x, int y))                      \
+  X(void, hevc_qpel_put, (uint8_t *dst, int dst_stride, const uint8_t *src,   \
+                          int src_stride, int w, int h, int mx, int my))      \
+  X(uint32_t, sad16, (const uint8_t *cur, const uint8_t *ref, int ref_stride, \
+                      int h))                                                 \
+  X(uint32_t, sad8, (const uint8_t *cur, const uint8_t *ref, int ref_stride,  \
+                     int h))                                                  \
+  X(uint32_t, sad4, (const uint8_t *cur, const uint8_t *ref, int ref_stride,  \
+                     int h))                                                  \
+  X(void, sad16_x4, (const uint8_t *cur, const uint8_t *const ref[4],         \
+                     int ref_stride, uint32_t sad[4], int h))                 \
+  X(void, sad8_x4, (const uint8_t *cur, const uint8_t *const ref[4],          \
+                    int ref_stride, uint32_t sad[4], int h))                  \
+  X(void, sad4_x4, (const uint8_t *cur, const uint8_t *const ref[4],          \
+                    int ref_stride, uint32_t sad[4], int h))                  \
+  X(uint32_t, satd4x4n, (const uint8_t *cur, const uint8_t *ref,              \
+                         int ref_stride, int n))                              \
+  X(mxu1_me_result, me_full, (const mxu1_me_params *p))                       \
+  X(mxu1_me_result, me_diamond, (const mxu1_me_params *p))                    \
+  X(mxu1_me_result, me_hexagon, (const mxu1_me_params *p))                    \
+  X(void *, memcpy, (void *dst, const void *src, size_t n))                   \
+  X(void *, memmove, (void *dst, const void *src, size_t n))                  \
+  X(void *, memset, (void *dst, int c, size_t n))                             \
+  X(int, memcmp, (const void *s1, const void *s2, size_t n))                  \
+  X(size_t, strlen, (const char *s))                                          \
+  X(char *, strchr, (const char *s, int c))                                   \
+  X(void *, memchr, (const void *s, int c, size_t n))                         \
+  X(void *, memrchr, (const void *s, int c, size_t n))                        \
+  X(void, nn_run, (const mxu1_nn_layer *l, const void *packed,                \
+                   const int8_t *in, int8_t *out, void *scratch))             \
+  X(void, median3x3, (uint8_t *dst, int dst_stride, const uint8_t *src,       \
+                      int src_stride, int width, int height))                 \
+  X(void, median5x5, (uint8_t *dst, int dst_stride, const uint8_t *src,       \
+                      int src_stride, int width, int height))                 \
+  X(void, erode3x3, (uint8_t *dst, int dst_stride, const uint8_t *src,        \
+                     int src_stride, int width, int height))                  \
+  X(void, erode5x5, (uint8_t *dst, int dst_stride, const uint8_t *src,        \
+                     int src_stride, int width, int height))                  \
+  X(void, dilate3x3, (uint8_t *dst, int dst_stride, const uint8_t *src,       \
+                      int src_stride, int width, int height))                 \
+  X(void, dilate5x5, (uint8_t *dst, int dst_stride, const uint8_t *src,       \
+                      int src_stride, int width, int height))                 \
+  X(void, i420_to_rgb, (const uint8_t *y, int y_stride, const uint8_t *u,     \
+                        const uint8_t *v, int uv_stride, void *rgb,           \
+                        int rgb_stride, mxu1_rgb_format fmt, int width,       \
+                        int height))                                          \
+  X(void, nv12_to_rgb, (const uint8_t *y, int y_stride, const uint8_t *uv,    \
+                        int uv_stride, void *rgb, int rgb_stride,             \
+                        mxu1_rgb_format fmt, int width, int height))          \
+  X(void, rgb_to_i420, (const void *rgb, int rgb_stride,                      \
+                        mxu1_rgb_format fmt, uint8_t *y, int y_stride,        \
+                        uint8_t *u, uint8_t *v, int uv_stride, int width,     \
+                        int height))                                          \
+  X(void, rgb_to_nv12, (const void *rgb, int rgb_stride,                      \
+                        mxu1_rgb_format fmt, uint8_t *y, int y_stride,        \
+                        uint8_t *uv, int uv_stride, int width, int height))
+
+#define MXU1_DISPATCH_MEMBER(ret, name, params) ret (*name) params;
+
+typedef struct {
+  MXU1_DISPATCH_FUNCTIONS(MXU1_DISPATCH_MEMBER)
+} mxu1_functions;
+
+//  The resolved functions
+extern mxu1_functions mxu1_fn;
+
+//  The two sets to choose from
+extern const mxu1_functions mxu1_functions_mxu;
+extern const mxu1_functions mxu1_functions_c;
+
+//  Detects (once) and resolves mxu1_fn; the constructor calls it, and
+// calling it again changes nothing. Returns the level bound.
+mxu1_cpu_level mxu1_dispatch_init(void);
+
+//  Binds mxu1_fn to the MXU versions for any level above MXU1_CPU_NONE,
+// enabling the MXU in the calling thread, else to the C ones. For tests:
+// binding the MXU on a CPU without one makes the first call trap.
+void mxu1_dispatch_bind(mxu1_cpu_level level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_DISPATCH_H
@@ -0,0 +1,174 @@
+// mxu1_dispatch_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 dispatch: detection report, checks and call overhead
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Prints what detection found and which set mxu1_fn was bound to, checks
+// that every pointer in it is that set's, runs a few functions through it
+// against their _c versions, then times calls of small blocks made directly
+// and through mxu1_fn, the per-call cost of dispatch (which should be lost
+// in the noise). Set MXU1_CPU to force either set (see mxu1_dispatch.h).
+//
+// Build and run on the target (kernels/dispatch), with every module:
+//     M="audio/mxu1_audio_ref audio/mxu1_audio_stream blas/mxu1_blas_ref
+//        blas/mxu1_blas_matrix csum/mxu1_csum_ref csum/mxu1_csum_buffer
+//        dct/mxu1_dct_ref gfx/mxu1_gfx_ref gfx/mxu1_gfx_image mc/mxu1_mc_ref
+//        mc/mxu1_mc_pred me/mxu1_me_ref me/mxu1_me_search mem/mxu1_mem_ref
+//        nn/mxu1_nn_ref nn/mxu1_nn_layer rank/mxu1_rank_ref
+//        rank/mxu1_rank_image yuv/mxu1_yuv_ref yuv/mxu1_yuv_frame"
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_dispatch_bench
+//         mxu1_dispatch_bench.c mxu1_dispatch.c mxu1_cpu.c ../*/mxu1_*[a-z].s
+//         $(for m in $M; do echo ../$m.c; done) -lm
+//     ./mxu1_dispatch_bench [seconds per test, default 1]
+//     MXU1_CPU=none ./mxu1_dispatch_bench
+// Exits non-zero if any check fails.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_dispatch.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+static const char *const level_name[] = { "none", "rev1", "rev2" };
+
+#define STRIDE 64
+static uint32_t cur_words[MXU1_ME_CUR_STRIDE * 16 / 4];
+static uint8_t picture[STRIDE * 32], out[2][STRIDE * 16];
+
+//  Whether mxu1_fn gives what the _c versions give on a few calls
+static int agrees(void)
+{
+  const uint8_t *const cur = (const uint8_t *)cur_words, *const ref =
+      picture + 3 * STRIDE + 5;
+  int ok = 1;
+
+  ok &= mxu1_fn.adler32(1, picture, sizeof(picture)) ==
+        mxu1_adler32_c(1, picture, sizeof(picture));
+  ok &= mxu1_fn.sad16(cur, ref, STRIDE, 16) ==
+        mxu1_sad16_c(cur, ref, STRIDE, 16);
+  ok &= mxu1_fn.blas_dot_q15((const int16_t *)picture,
+                             (const int16_t *)(picture + 64), 200) ==
+        mxu1_blas_dot_q15_c((const int16_t *)picture,
+                            (const int16_t *)(picture + 64), 200);
+  ok &= !mxu1_fn.memcmp(picture + 1, picture + 1, 100) &&
+        (mxu1_fn.memcmp(picture, picture + 1, 100) > 0) ==
+        (mxu1_memcmp_c(picture, picture + 1, 100) > 0);
+  ok &= mxu1_fn.memchr(picture + 3, picture[90], 200) ==
+        mxu1_memchr_c(picture + 3, picture[90], 200);
+  for (int p = 0; p < 16; ++p) {
+    mxu1_fn.h264_qpel_put(out[0], ref, STRIDE, 8, p % 4, p / 4);
+    mxu1_h264_qpel_put_c(out[1], ref, STRIDE, 8, p % 4, p / 4);
+    ok &= !memcmp(out[0], out[1], sizeof(out[0]));
+  }
+  mxu1_fn.median3x3(out[0], STRIDE, picture, STRIDE, 32, 16);
+  mxu1_median3x3_c(out[1], STRIDE, picture, STRIDE, 32, 16);
+  ok &= !memcmp(out[0], out[1], sizeof(out[0]));
+  return ok;
+}
+
+//  Nanoseconds per call of a 4x4 SAD: directly ('via' 0) or through
+// mxu1_fn, of the MXU or the C version ('mxu')
+static double sad4_ns(int mxu, int via, double secs)
+{
+  const uint8_t *const cur = (const uint8_t *)cur_words;
+  volatile uint32_t sink = 0;
+  unsigned long k = 0;
+  double t0 = now(), dt;
+
+  do {
+    for (int i = 0; i < 1024; ++i, ++k) {
+      const uint8_t *const ref = picture + (k & 15);
+      if (via)
+        sink += mxu1_fn.sad4(cur, ref, STRIDE, 4);
+      else if (mxu)
+        sink += mxu1_sad4(cur, ref, STRIDE, 4);
+      else
+        sink += mxu1_sad4_c(cur, ref, STRIDE, 4);
+    }
+    dt = now() - t0;
+  } while (dt < secs);
+  (void)sink;
+  return dt / k * 1e9;
+}
+
+int main(int argc, char **argv)
+{
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  const char *forced = getenv("MXU1_CPU");
+  mxu1_cpu_info info;
+  const mxu1_cpu_level bound = mxu1_dispatch_init();
+  const mxu1_functions *const want =
+      bound > MXU1_CPU_NONE ? &mxu1_functions_mxu : &mxu1_functions_c;
+  int failed = 0;
+
+  mxu1_cpu_detect(&info);
+  printf("MXU1_CPU:      %s\n", forced ? forced : "(unset)");
+  printf("/proc/cpuinfo: %s\n", info.cpuinfo < 0 ? "unreadable" :
+                                info.cpuinfo ? "MXU core" : "no MXU core");
+  printf("probe:         %s\n", info.forced || info.cpuinfo != 1 ?
+                                "not run" : level_name[info.probe]);
+  printf("detected:      %s, bound to the %s functions\n",
+         level_name[info.level], bound > MXU1_CPU_NONE ? "MXU" : "C");
+
+  if (memcmp(&mxu1_fn, want, sizeof(mxu1_fn))) {
+    printf("mxu1_fn is not the set it was bound to\n");
+    failed = 1;
+  }
+
+  for (size_t i = 0; i < sizeof(picture); ++i)
+    picture[i] = (uint8_t)rand16();
+  mxu1_me_load_cur((uint8_t *)cur_words, picture + 7 * STRIDE + 9, STRIDE,
+                   MXU1_ME_16x16);
+  if (!agrees()) {
+    printf("%s functions disagree with the C references\n",
+           bound > MXU1_CPU_NONE ? "MXU" : "C");
+    failed = 1;
+  }
+
+  printf("sad4, ns per call:  direct  mxu1_fn\n");
+  if (bound > MXU1_CPU_NONE)
+    printf("  MXU             %8.1f %8.1f\n", sad4_ns(1, 0, secs),
+           sad4_ns(1, 1, secs));
+  mxu1_dispatch_bind(MXU1_CPU_NONE);
+  printf("  C               %8.1f %8.1f\n", sad4_ns(0, 0, secs),
+         sad4_ns(0, 1, secs));
+  return failed;
+}
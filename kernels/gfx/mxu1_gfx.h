@@ -0,0 +1,186 @@
+// mxu1_gfx.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 ARGB8888 alpha blending and scaling
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  A small 2D engine for UI compositing on ARGB8888 images: source-over
+// blending (premultiplied or straight alpha), constant-alpha fades, 2x and
+// 0.5x scaling fast paths and an arbitrary-ratio bilinear scaler. The
+// scanline kernels are in mxu1_gfx.s, each with a C twin in mxu1_gfx_ref.c
+// whose output it matches bit for bit; the image functions
+// (mxu1_gfx_image.c) clip, walk the scanlines and run either set.
+//
+// Pixels are 32-bit words 0xAARRGGBB; all four channels go through the same
+// arithmetic, which is (per channel, x / 255 rounded to nearest with
+// div255(x) = (t + (t >> 8)) >> 8, t = x + 128, exact for x <= 255 * 255):
+//   over           d = s + div255(d * (255 - sa))     premultiplied source
+//   over straight  d = div255(s * sa + d * (255 - sa)) for R, G and B,
+//                  da = div255(255 * sa + da * (255 - sa))
+//   fade           d = div255(s * a + d * (255 - a))   a constant, 0..255
+//   0.5x           2x2 box: avgr(avgr(p00, p10), avgr(p01, p11)),
+//                  avgr(a, b) = (a + b + 1) >> 1, as q8avgr does
+//   2x             each source pixel p becomes p, avgr(p, right) over
+//                  avgr(p, below), avgr(avgr(p, right), avgr(below,
+//                  below right)); the last column and row repeat themselves
+//   bilinear       lerp(a, b, f) = (a * (128 - f) + b * f + 64) >> 7, with
+//                  f in 1/128 pixel: rows first (into a scratch row), then
+//                  columns, on pixel centres (x + 0.5) * src / dst - 0.5
+//                  clamped to the image
+// 'over' wraps, as the premultiplied rule assumes s <= sa in each channel.
+//
+// How the MXU does it (details in mxu1_gfx.s): two pixels per pass, loaded
+// and stored with s32ldi/s32sdi so each scanline is one stream per image.
+// Alpha is spread to the four lanes of its pixel with three s32sfl per pair,
+// q8mul/q8mac form 8 x 8-bit products into 16-bit lanes, q16accm and q16slr
+// do the rounding and division, q16sat packs. The 2x and 0.5x paths are
+// q8avgr only. The bilinear column pass reads per-column offsets and weight
+// words from a table the image function builds once per call.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/gfx, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_gfx.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_gfx_ref.c mxu1_gfx_image.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_GFX_H
+#define MXU1_GFX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  'stride' is in pixels; rows are word aligned by construction.
+typedef struct {
+  uint32_t *px;
+  int32_t   width, height;
+  int32_t   stride;
+} mxu1_gfx_image;
+
+typedef enum {
+  MXU1_GFX_OVER,                // Premultiplied source over destination
+  MXU1_GFX_OVER_STRAIGHT,       // Straight (non-premultiplied) source over
+  MXU1_GFX_FADE                 // Constant alpha cross-fade, all 4 channels
+} mxu1_gfx_op;
+
+////////////////////////////////////////////////////////////////////////////////
+// Images (mxu1_gfx_image.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  Composite 'src' onto 'dst' with its top left corner at (x, y), clipped
+// to 'dst'. 'alpha' (0..255) is the fade's source weight, unused otherwise.
+void mxu1_gfx_blend(const mxu1_gfx_image *dst, int x, int y,
+                    const mxu1_gfx_image *src, mxu1_gfx_op op, int alpha);
+
+//  0.5x: dst's top left (src width / 2) x (src height / 2) pixels; an odd
+// last source row or column is dropped.
+void mxu1_gfx_half(const mxu1_gfx_image *dst, const mxu1_gfx_image *src);
+
+//  2x: dst's top left (2 src width) x (2 src height) pixels.
+void mxu1_gfx_double(const mxu1_gfx_image *dst, const mxu1_gfx_image *src);
+
+//  Bilinear scaling of all of 'src' to all of 'dst', any sizes. 'scratch'
+// holds the column table and one filtered row, mxu1_gfx_scale_scratch_size()
+// bytes, word aligned.
+size_t mxu1_gfx_scale_scratch_size(const mxu1_gfx_image *dst,
+                                   const mxu1_gfx_image *src);
+void   mxu1_gfx_scale(const mxu1_gfx_image *dst, const mxu1_gfx_image *src,
+                      void *scratch);
+
+//  The same, on the C kernels only.
+void   mxu1_gfx_blend_c(const mxu1_gfx_image *dst, int x, int y,
+                        const mxu1_gfx_image *src, mxu1_gfx_op op, int alpha);
+void   mxu1_gfx_half_c(const mxu1_gfx_image *dst, const mxu1_gfx_image *src);
+void   mxu1_gfx_double_c(const mxu1_gfx_image *dst, const mxu1_gfx_image *src);
+void   mxu1_gfx_scale_c(const mxu1_gfx_image *dst, const mxu1_gfx_image *src,
+                        void *scratch);
+
+////////////////////////////////////////////////////////////////////////////////
+// Scanline kernels (mxu1_gfx.s), for the image functions
+////////////////////////////////////////////////////////////////////////////////
+
+//  MXU kernels: 'n' even (the image functions leave an odd last pixel to
+// the C kernel), except mxu1_gfx_double_row, which takes any n >= 1.
+//   C kernels:   any n.
+
+//  n pixels of 'src' onto 'dst'; 'alpha' is only read by the fade.
+void mxu1_gfx_over_row(uint32_t *dst, const uint32_t *src, int32_t n,
+                       uint32_t alpha);
+void mxu1_gfx_over_straight_row(uint32_t *dst, const uint32_t *src, int32_t n,
+                                uint32_t alpha);
+void mxu1_gfx_fade_row(uint32_t *dst, const uint32_t *src, int32_t n,
+                       uint32_t alpha);
+
+void mxu1_gfx_over_row_c(uint32_t *dst, const uint32_t *src, int32_t n,
+                         uint32_t alpha);
+void mxu1_gfx_over_straight_row_c(uint32_t *dst, const uint32_t *src,
+                                  int32_t n, uint32_t alpha);
+void mxu1_gfx_fade_row_c(uint32_t *dst, const uint32_t *src, int32_t n,
+                         uint32_t alpha);
+
+//  Two source and two destination rows, as each kernel uses them:
+//   half_row:   dst[0][i], from src[0] and src[1] pixels 2i and 2i + 1, for
+//               n output pixels
+//   double_row: n pixels of src[0] (src[1] the row below, or src[0] again
+//               for the last) to 2n pixels of each of dst[0] and dst[1]
+//   vlerp_row:  dst[0][i] = lerp(src[0][i], src[1][i], weight), n pixels,
+//               'weight' 0..128
+typedef struct {
+  uint32_t       *dst[2];
+  const uint32_t *src[2];
+  int32_t         n;
+  int32_t         weight;
+} mxu1_gfx_rows;
+
+void mxu1_gfx_half_row(const mxu1_gfx_rows *r);
+void mxu1_gfx_double_row(const mxu1_gfx_rows *r);
+void mxu1_gfx_vlerp_row(const mxu1_gfx_rows *r);
+
+void mxu1_gfx_half_row_c(const mxu1_gfx_rows *r);
+void mxu1_gfx_double_row_c(const mxu1_gfx_rows *r);
+void mxu1_gfx_vlerp_row_c(const mxu1_gfx_rows *r);
+
+//  One output column of the bilinear column pass: dst[i] = lerp of the
+// pixels 'off' bytes and off + 4 bytes into the row, with w0 = (128 - f) and
+// w1 = f replicated to all four bytes.
+typedef struct {
+  int32_t  off;
+  uint32_t w0, w1;
+} mxu1_gfx_step;
+
+void mxu1_gfx_hlerp_row(uint32_t *dst, const uint32_t *src,
+                        const mxu1_gfx_step *step, int32_t n);
+void mxu1_gfx_hlerp_row_c(uint32_t *dst, const uint32_t *src,
+                          const mxu1_gfx_step *step, int32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_GFX_H
@@ -0,0 +1,436 @@
+# mxu1_gfx.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 ARGB8888 alpha blending and scaling scanline kernels
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, the row layout (mxu1_gfx_rows) and the arithmetic are
+# described in mxu1_gfx.h; mxu1_gfx_ref.c is the same computation in C.
+#
+#  The blending kernels take two pixels per pass: both source words, both
+# destination words (read through a second pointer into dst, so reads and
+# writes are each one s32ldi/s32sdi stream), two results stored.
+#
+#  Per-pixel alpha: s32sfl pattern 0 of (S1, S0) puts A1 A0 in the top
+# bytes, a second one gives (A1 A1 A0 A0) and pattern 3 splits that into
+# A1 and A0 in all four bytes of a word each; s32nor against xr0 gives
+# 255 - A. Products are 8 x 8 bits into 16-bit lanes (q8mul, then q8mac
+# for the second term of a sum), at most 255 * 255, so div255 fits in
+# unsigned 16 bits: q16accm adds 128 (t), q16slr and q16accm form t +
+# (t >> 8), q16slr by 8 and q16sat narrow the result back to bytes.
+#
+#  Scaling: 0.5x and 2x are q8avgr of neighbouring pixels, whole words at a
+# time. Bilinear is a row pass (vlerp) and a column pass (hlerp) of the same
+# lerp: q8mul by the first weight, q8mac by the second, +64, q16slr by 7,
+# q16sat. The column pass loads each output pixel's source offset with lw
+# and its weight words from the step table.
+#
+# Register use: any xr, $t0..$t9, $a0..$a3. Leaf functions, no stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# mxu1_gfx_rows field offsets
+  .equ    ROWS_DST0,      0
+  .equ    ROWS_DST1,      4
+  .equ    ROWS_SRC0,      8
+  .equ    ROWS_SRC1,      12
+  .equ    ROWS_N,         16
+  .equ    ROWS_WEIGHT,    20
+
+# mxu1_gfx_step field offset and size (w0 and w1 follow 'off')
+  .equ    STEP_OFF,       0
+  .equ    STEP_SIZE,      12
+
+
+#  div255 of the 16-bit products of two pixels, \h0/\l0 and \h1/\l1, packed
+# back to bytes in \h0 and \h1. xr15 holds 128 in both halves; xr12 and xr13
+# are clobbered.
+.macro DIV255 h0, l0, h1, l1
+  q16accm \h0,  xr15, xr15, \l0,  AA      # t = x + 128
+  q16accm \h1,  xr15, xr15, \l1,  AA
+  q16slr  xr12, \h0,  \l0,  xr13, 8
+  q16accm \h0,  xr12, xr13, \l0,  AA      # t + (t >> 8)
+  q16slr  xr12, \h1,  \l1,  xr13, 8
+  q16accm \h1,  xr12, xr13, \l1,  AA
+  q16slr  \h0,  \h0,  \l0,  \l0,  8
+  q16slr  \h1,  \h1,  \l1,  \l1,  8
+  q16sat  \h0,  \h0,  \l0
+  q16sat  \h1,  \h1,  \l1
+.endm
+
+#  Blending kernel frame: $a0 dst (stores), $t0 dst (loads), $a1 src, $a2
+# pairs left. \body is one pair, S0 S1 in xr1 xr2 and D0 D1 in xr3 xr4,
+# leaving its results in xr8 and xr10.
+.macro BLEND name, setup, body
+  .globl  \name
+  .type   \name, @function
+  .ent    \name
+\name:
+  sra     $a2,  $a2,  1
+  blez    $a2,  9f
+   addiu  $a0,  $a0,  -4
+  addiu   $a1,  $a1,  -4
+  move    $t0,  $a0
+  s32lui  xr15, 0x80, 4
+  \setup
+
+1:
+  s32ldi  xr1,  $a1,  4
+  s32ldi  xr2,  $a1,  4
+  s32ldi  xr3,  $t0,  4
+  s32ldi  xr4,  $t0,  4
+  \body
+  addiu   $a2,  $a2,  -1
+  s32sdi  xr8,  $a0,  4
+  bnez    $a2,  1b
+   s32sdi xr10, $a0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    \name
+  .size   \name, .-\name
+.endm
+
+
+################################################################################
+# void mxu1_gfx_over_row(uint32_t *dst, const uint32_t *src, int32_t n,
+#                        uint32_t alpha)
+#
+#  d = s + div255(d * (255 - sa)); the final q8add wraps like the C.
+################################################################################
+
+.macro OVER_SETUP
+.endm
+
+.macro OVER_BODY
+  s32sfl  xr5,  xr2,  xr1,  xr0,  0       # (A1 A0 R1 R0)
+  s32nor  xr5,  xr5,  xr0
+  s32sfl  xr5,  xr5,  xr5,  xr0,  0       # (I1 I1 I0 I0), I = 255 - A
+  s32sfl  xr6,  xr5,  xr5,  xr7,  3       # I1 x4, I0 x4
+  q8mul   xr8,  xr3,  xr7,  xr9
+  q8mul   xr10, xr4,  xr6,  xr11
+  DIV255  xr8,  xr9,  xr10, xr11
+  q8add   xr8,  xr8,  xr1,  AA
+  q8add   xr10, xr10, xr2,  AA
+.endm
+
+  BLEND mxu1_gfx_over_row, OVER_SETUP, OVER_BODY
+
+
+################################################################################
+# void mxu1_gfx_over_straight_row(uint32_t *dst, const uint32_t *src,
+#                                 int32_t n, uint32_t alpha)
+#
+#  d = div255(s * sa + d * (255 - sa)) with the source's own alpha byte
+# weighted by 255 instead of sa: xr14 holds 0xff000000 to OR into A x4.
+################################################################################
+
+.macro STRAIGHT_SETUP
+  s32lui  xr14, 0xff, 3
+.endm
+
+.macro STRAIGHT_BODY
+  s32sfl  xr5,  xr2,  xr1,  xr0,  0       # (A1 A0 R1 R0)
+  s32sfl  xr5,  xr5,  xr5,  xr0,  0       # (A1 A1 A0 A0)
+  s32sfl  xr6,  xr5,  xr5,  xr7,  3       # A1 x4, A0 x4
+  s32nor  xr8,  xr7,  xr0                 # (255 - A0) x4
+  s32nor  xr10, xr6,  xr0
+  s32or   xr7,  xr7,  xr14                # (255 A0 A0 A0)
+  s32or   xr6,  xr6,  xr14
+  q8mul   xr8,  xr3,  xr8,  xr9
+  q8mul   xr10, xr4,  xr10, xr11
+  q8mac   xr8,  xr1,  xr7,  xr9,  AA
+  q8mac   xr10, xr2,  xr6,  xr11, AA
+  DIV255  xr8,  xr9,  xr10, xr11
+.endm
+
+  BLEND mxu1_gfx_over_straight_row, STRAIGHT_SETUP, STRAIGHT_BODY
+
+
+################################################################################
+# void mxu1_gfx_fade_row(uint32_t *dst, const uint32_t *src, int32_t n,
+#                        uint32_t alpha)
+#
+#  d = div255(s * a + d * (255 - a)): a x4 in xr6, (255 - a) x4 in xr7.
+################################################################################
+
+.macro FADE_SETUP
+  andi    $a3,  $a3,  0xff
+  sll     $t1,  $a3,  8
+  or      $a3,  $a3,  $t1
+  sll     $t1,  $a3,  16
+  or      $a3,  $a3,  $t1
+  s32i2m  xr6,  $a3
+  s32nor  xr7,  xr6,  xr0
+.endm
+
+.macro FADE_BODY
+  q8mul   xr8,  xr1,  xr6,  xr9
+  q8mul   xr10, xr2,  xr6,  xr11
+  q8mac   xr8,  xr3,  xr7,  xr9,  AA
+  q8mac   xr10, xr4,  xr7,  xr11, AA
+  DIV255  xr8,  xr9,  xr10, xr11
+.endm
+
+  BLEND mxu1_gfx_fade_row, FADE_SETUP, FADE_BODY
+
+
+################################################################################
+# void mxu1_gfx_half_row(const mxu1_gfx_rows *r)
+#
+#  Two output pixels per pass from 4 pixels of each source row: the rows
+# are averaged first, then the column pairs.
+################################################################################
+
+  .globl  mxu1_gfx_half_row
+  .type   mxu1_gfx_half_row, @function
+  .ent    mxu1_gfx_half_row
+mxu1_gfx_half_row:
+  lw      $t3,  ROWS_N($a0)
+  lw      $t0,  ROWS_DST0($a0)
+  lw      $t1,  ROWS_SRC0($a0)
+  lw      $t2,  ROWS_SRC1($a0)
+  sra     $t3,  $t3,  1
+  blez    $t3,  9f
+   addiu  $t0,  $t0,  -4
+  addiu   $t1,  $t1,  -4
+  addiu   $t2,  $t2,  -4
+
+1:
+  s32ldi  xr1,  $t1,  4
+  s32ldi  xr5,  $t2,  4
+  s32ldi  xr2,  $t1,  4
+  s32ldi  xr6,  $t2,  4
+  s32ldi  xr3,  $t1,  4
+  s32ldi  xr7,  $t2,  4
+  s32ldi  xr4,  $t1,  4
+  s32ldi  xr8,  $t2,  4
+  q8avgr  xr1,  xr1,  xr5
+  q8avgr  xr2,  xr2,  xr6
+  q8avgr  xr3,  xr3,  xr7
+  q8avgr  xr4,  xr4,  xr8
+  q8avgr  xr1,  xr1,  xr2
+  q8avgr  xr3,  xr3,  xr4
+  addiu   $t3,  $t3,  -1
+  s32sdi  xr1,  $t0,  4
+  bnez    $t3,  1b
+   s32sdi xr3,  $t0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_gfx_half_row
+  .size   mxu1_gfx_half_row, .-mxu1_gfx_half_row
+
+
+################################################################################
+# void mxu1_gfx_double_row(const mxu1_gfx_rows *r)
+#
+#  Each pass takes the next pixel of both source rows (\b below \d) as the
+# right neighbours of the current ones (\a below \c), and writes two pixels
+# to each output row. The loop is unrolled twice with the registers swapped,
+# so that the next pair needs no moves; the last pixel is its own neighbour.
+################################################################################
+
+.macro DOUBLE a, c, b, d
+  s32ldi  \b,   $t1,  4
+  s32ldi  \d,   $t2,  4
+  q8avgr  xr5,  \a,   \c                  # Left, row 1
+  s32sdi  \a,   $t3,  4
+  q8avgr  xr6,  \a,   \b                  # Right, row 0
+  q8avgr  xr7,  \c,   \d
+  s32sdi  xr5,  $t4,  4
+  q8avgr  xr7,  xr6,  xr7                 # Right, row 1
+  s32sdi  xr6,  $t3,  4
+  s32sdi  xr7,  $t4,  4
+.endm
+
+.macro DOUBLE_LAST a, c
+  q8avgr  xr5,  \a,   \c
+  s32sdi  \a,   $t3,  4
+  s32sdi  \a,   $t3,  4
+  s32sdi  xr5,  $t4,  4
+  s32sdi  xr5,  $t4,  4
+.endm
+
+  .globl  mxu1_gfx_double_row
+  .type   mxu1_gfx_double_row, @function
+  .ent    mxu1_gfx_double_row
+mxu1_gfx_double_row:
+  lw      $t5,  ROWS_N($a0)
+  lw      $t3,  ROWS_DST0($a0)
+  lw      $t4,  ROWS_DST1($a0)
+  lw      $t1,  ROWS_SRC0($a0)
+  lw      $t2,  ROWS_SRC1($a0)
+  blez    $t5,  9f
+   addiu  $t1,  $t1,  -4
+  addiu   $t2,  $t2,  -4
+  addiu   $t3,  $t3,  -4
+  addiu   $t4,  $t4,  -4
+  s32ldi  xr1,  $t1,  4
+  s32ldi  xr2,  $t2,  4
+  addiu   $t5,  $t5,  -1
+  beqz    $t5,  8f
+  nop
+
+1:
+  DOUBLE  xr1,  xr2,  xr3,  xr4
+  addiu   $t5,  $t5,  -1
+  beqz    $t5,  7f
+  nop
+  DOUBLE  xr3,  xr4,  xr1,  xr2
+  addiu   $t5,  $t5,  -1
+  bnez    $t5,  1b
+  nop
+
+8:
+  DOUBLE_LAST xr1, xr2
+  jr      $ra
+  nop
+
+7:
+  DOUBLE_LAST xr3, xr4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_gfx_double_row
+  .size   mxu1_gfx_double_row, .-mxu1_gfx_double_row
+
+
+################################################################################
+# void mxu1_gfx_vlerp_row(const mxu1_gfx_rows *r)
+#
+#  Weights (128 - w) x4 in xr13, w x4 in xr14, 64 in both halves of xr15.
+################################################################################
+
+  .globl  mxu1_gfx_vlerp_row
+  .type   mxu1_gfx_vlerp_row, @function
+  .ent    mxu1_gfx_vlerp_row
+mxu1_gfx_vlerp_row:
+  lw      $t0,  ROWS_DST0($a0)
+  lw      $t1,  ROWS_SRC0($a0)
+  lw      $t2,  ROWS_SRC1($a0)
+  lw      $t3,  ROWS_N($a0)
+  lw      $t4,  ROWS_WEIGHT($a0)
+  li      $t5,  0x01010101
+  sra     $t3,  $t3,  1
+  blez    $t3,  9f
+   mul    $t4,  $t4,  $t5
+  s32i2m  xr14, $t4
+  li      $t5,  0x80808080
+  subu    $t5,  $t5,  $t4
+  s32i2m  xr13, $t5
+  s32lui  xr15, 0x40, 4
+  addiu   $t0,  $t0,  -4
+  addiu   $t1,  $t1,  -4
+  addiu   $t2,  $t2,  -4
+
+1:
+  s32ldi  xr1,  $t1,  4
+  s32ldi  xr3,  $t2,  4
+  s32ldi  xr2,  $t1,  4
+  s32ldi  xr4,  $t2,  4
+  q8mul   xr5,  xr1,  xr13, xr6
+  q8mul   xr7,  xr2,  xr13, xr8
+  q8mac   xr5,  xr3,  xr14, xr6,  AA
+  q8mac   xr7,  xr4,  xr14, xr8,  AA
+  q16accm xr5,  xr15, xr15, xr6,  AA
+  q16accm xr7,  xr15, xr15, xr8,  AA
+  q16slr  xr5,  xr5,  xr6,  xr6,  7
+  q16slr  xr7,  xr7,  xr8,  xr8,  7
+  q16sat  xr5,  xr5,  xr6
+  q16sat  xr7,  xr7,  xr8
+  addiu   $t3,  $t3,  -1
+  s32sdi  xr5,  $t0,  4
+  bnez    $t3,  1b
+   s32sdi xr7,  $t0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_gfx_vlerp_row
+  .size   mxu1_gfx_vlerp_row, .-mxu1_gfx_vlerp_row
+
+
+################################################################################
+# void mxu1_gfx_hlerp_row(uint32_t *dst, const uint32_t *src,
+#                         const mxu1_gfx_step *step, int32_t n)
+#
+#  Two output pixels per pass: their source pairs (xr1 xr2 and xr3 xr4) are
+# addressed from the step offsets through $t0 and $t1, the weight words
+# loaded into xr5..xr8.
+################################################################################
+
+  .globl  mxu1_gfx_hlerp_row
+  .type   mxu1_gfx_hlerp_row, @function
+  .ent    mxu1_gfx_hlerp_row
+mxu1_gfx_hlerp_row:
+  sra     $a3,  $a3,  1
+  blez    $a3,  9f
+   addiu  $a0,  $a0,  -4
+  s32lui  xr15, 0x40, 4
+
+1:
+  lw      $t0,  STEP_OFF($a2)
+  lw      $t1,  STEP_SIZE+STEP_OFF($a2)
+  s32ldd  xr5,  $a2,  4                   # w0
+  s32ldd  xr6,  $a2,  8                   # w1
+  addu    $t0,  $a1,  $t0
+  addu    $t1,  $a1,  $t1
+  s32ldd  xr1,  $t0,  0
+  s32ldd  xr2,  $t0,  4
+  s32ldd  xr3,  $t1,  0
+  s32ldd  xr4,  $t1,  4
+  s32ldd  xr7,  $a2,  16                  # Next step's w0
+  s32ldd  xr8,  $a2,  20                  # and w1
+  q8mul   xr9,  xr1,  xr5,  xr10
+  q8mul   xr11, xr3,  xr7,  xr12
+  q8mac   xr9,  xr2,  xr6,  xr10, AA
+  q8mac   xr11, xr4,  xr8,  xr12, AA
+  q16accm xr9,  xr15, xr15, xr10, AA
+  q16accm xr11, xr15, xr15, xr12, AA
+  q16slr  xr9,  xr9,  xr10, xr10, 7
+  q16slr  xr11, xr11, xr12, xr12, 7
+  q16sat  xr9,  xr9,  xr10
+  q16sat  xr11, xr11, xr12
+  addiu   $a3,  $a3,  -1
+  addiu   $a2,  $a2,  2*STEP_SIZE
+  s32sdi  xr9,  $a0,  4
+  bnez    $a3,  1b
+   s32sdi xr11, $a0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_gfx_hlerp_row
+  .size   mxu1_gfx_hlerp_row, .-mxu1_gfx_hlerp_row
+
+# vim:shiftwidth=2:expandtab:syntax=asm
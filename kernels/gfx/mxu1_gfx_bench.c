@@ -0,0 +1,258 @@
+// mxu1_gfx_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 2D engine: checks and megapixels per second
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Runs each operation of the 2D engine on 720p and 1080p sized images of
+// random pixels (alpha mostly 0 or 255, as in UI layers), checks that the
+// MXU image functions match their _c versions bit for bit (also on odd
+// sizes, clipped placements and a 1-pixel wide scale, for the C edges), and
+// prints output megapixels per second for both.
+//
+// Build and run on the target (kernels/gfx):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_gfx_bench
+//         mxu1_gfx_bench.c mxu1_gfx_image.c mxu1_gfx_ref.c mxu1_gfx.s
+//         ../dispatch/mxu1_cpu.c
+//     ./mxu1_gfx_bench [seconds per test, default 1]
+// Exits non-zero if any output differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_gfx.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+static void *xalloc(size_t n)
+{
+  void *p = malloc(n);
+  if (!p) {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  return p;
+}
+
+//  Premultiplied: each colour channel at most alpha
+static uint32_t rand_pixel(void)
+{
+  const uint32_t k = rand16() % 4;
+  const uint32_t a = k == 0 ? 0 : k == 1 ? 255 : rand16() & 255;
+  uint32_t p = a << 24;
+  for (int sh = 0; sh < 24; sh += 8)
+    p |= (a ? rand16() % (a + 1) : 0) << sh;
+  return p;
+}
+
+static mxu1_gfx_image image(int w, int h)
+{
+  mxu1_gfx_image im;
+  im.width = w;
+  im.height = h;
+  im.stride = w + 3;                    // Rows apart by more than the width
+  im.px = (uint32_t *)xalloc((size_t)im.stride * h * 4);
+  for (size_t i = 0; i < (size_t)im.stride * h; ++i)
+    im.px[i] = rand_pixel();
+  return im;
+}
+
+static size_t image_bytes(const mxu1_gfx_image *im)
+{
+  return (size_t)im->stride * im->height * 4;
+}
+
+typedef enum { OVER, OVER_STRAIGHT, FADE, HALF, DOUBLE, SCALE } test_op;
+
+static const char *const op_name[] = {
+  "over", "over straight", "fade", "0.5x", "2x", "bilinear"
+};
+
+typedef struct {
+  test_op        op;
+  mxu1_gfx_image src, dst;
+  int            x, y;                  // Blending position
+  void          *scratch;
+} test;
+
+static void run(const test *t, const mxu1_gfx_image *dst, int c)
+{
+  switch (t->op) {
+    case OVER:
+    case OVER_STRAIGHT:
+    case FADE:
+      (c ? mxu1_gfx_blend_c : mxu1_gfx_blend)(dst, t->x, t->y, &t->src,
+                                              (mxu1_gfx_op)t->op, 96);
+      break;
+    case HALF:
+      (c ? mxu1_gfx_half_c : mxu1_gfx_half)(dst, &t->src);
+      break;
+    case DOUBLE:
+      (c ? mxu1_gfx_double_c : mxu1_gfx_double)(dst, &t->src);
+      break;
+    default:
+      (c ? mxu1_gfx_scale_c : mxu1_gfx_scale)(dst, &t->src, t->scratch);
+      break;
+  }
+}
+
+static void test_init(test *t, test_op op, int sw, int sh, int dw, int dh,
+                      int x, int y)
+{
+  t->op = op;
+  t->src = image(sw, sh);
+  t->dst = image(dw, dh);
+  t->x = x;
+  t->y = y;
+  t->scratch = op == SCALE ?
+      xalloc(mxu1_gfx_scale_scratch_size(&t->dst, &t->src)) : NULL;
+}
+
+static void test_free(test *t)
+{
+  free(t->src.px);
+  free(t->dst.px);
+  free(t->scratch);
+}
+
+//  Both outputs onto copies of the same destination, compared whole
+static int check(const test *t)
+{
+  const size_t bytes = image_bytes(&t->dst);
+  mxu1_gfx_image d[2];
+  int diff;
+
+  for (int i = 0; i < 2; ++i) {
+    d[i] = t->dst;
+    d[i].px = (uint32_t *)xalloc(bytes);
+    memcpy(d[i].px, t->dst.px, bytes);
+    run(t, &d[i], i);
+  }
+  diff = memcmp(d[0].px, d[1].px, bytes) != 0;
+  free(d[0].px);
+  free(d[1].px);
+  return diff;
+}
+
+//  Output megapixels per second: the blended area or the whole output
+static double mpix(const test *t, int c, double secs)
+{
+  const double w = t->op == HALF ? t->src.width / 2 :
+                   t->op == DOUBLE ? 2 * t->src.width :
+                   t->op == SCALE ? t->dst.width : t->src.width;
+  const double h = t->op == HALF ? t->src.height / 2 :
+                   t->op == DOUBLE ? 2 * t->src.height :
+                   t->op == SCALE ? t->dst.height : t->src.height;
+  unsigned long n = 0;
+  double t0 = now(), dt;
+
+  do {
+    run(t, &t->dst, c);
+    ++n;
+    dt = now() - t0;
+  } while (dt < secs);
+  return n * w * h / dt * 1e-6;
+}
+
+int main(int argc, char **argv)
+{
+  static const struct {
+    test_op op;
+    int     sw, sh, dw, dh, x, y;
+  } timed[] = {
+    { OVER,          1280,  720, 1280,  720,   0,   0 },
+    { OVER_STRAIGHT, 1280,  720, 1280,  720,   0,   0 },
+    { FADE,          1280,  720, 1280,  720,   0,   0 },
+    { HALF,          1920, 1080,  960,  540,   0,   0 },
+    { DOUBLE,         640,  360, 1280,  720,   0,   0 },
+    { SCALE,         1280,  720, 1920, 1080,   0,   0 },
+    { SCALE,         1920, 1080,  800,  480,   0,   0 },
+  }, edges[] = {
+    { OVER,          1277,  719, 1280,  720,  -3,   5 },
+    { OVER_STRAIGHT,  301,  203,  640,  360, 500, -17 },
+    { FADE,           333,  111,  320,  100,   1,   1 },
+    { HALF,          1277,  719,  638,  359,   0,   0 },
+    { DOUBLE,         641,  359, 1282,  718,   0,   0 },
+    { SCALE,         1277,  719,  803,  479,   0,   0 },
+    { SCALE,          333,  111, 1001,  997,   0,   0 },
+    { SCALE,            1,    9,    5,   20,   0,   0 },
+    { SCALE,            9,    1,    2,    1,   0,   0 },
+  };
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  int failed = 0;
+
+  mxu1_cpu_enable();
+
+  for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i) {
+    test t;
+    test_init(&t, edges[i].op, edges[i].sw, edges[i].sh, edges[i].dw,
+              edges[i].dh, edges[i].x, edges[i].y);
+    if (check(&t)) {
+      printf("%-13s %dx%d -> %dx%d: MISMATCH between MXU and C\n",
+             op_name[t.op], edges[i].sw, edges[i].sh, edges[i].dw,
+             edges[i].dh);
+      failed = 1;
+    }
+    test_free(&t);
+  }
+
+  printf("                                  Mpix/s: MXU        C  (MXU vs C)\n");
+  for (size_t i = 0; i < sizeof(timed) / sizeof(timed[0]); ++i) {
+    char name[64];
+    double m, c;
+    test t;
+
+    test_init(&t, timed[i].op, timed[i].sw, timed[i].sh, timed[i].dw,
+              timed[i].dh, timed[i].x, timed[i].y);
+    snprintf(name, sizeof(name), "%s %dx%d -> %dx%d", op_name[t.op],
+             timed[i].sw, timed[i].sh, timed[i].dw, timed[i].dh);
+    if (check(&t)) {
+      printf("%-34s MISMATCH between MXU and C\n", name);
+      failed = 1;
+    } else {
+      m = mpix(&t, 0, secs);
+      c = mpix(&t, 1, secs);
+      printf("%-34s %10.1f %8.1f  x%.2f\n", name, m, c, m / c);
+    }
+    test_free(&t);
+  }
+
+  return failed;
+}
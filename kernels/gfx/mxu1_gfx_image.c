@@ -0,0 +1,317 @@
+// mxu1_gfx_image.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 2D engine image functions: clipping, scanlines and edges
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Images are processed one scanline (or, for the scalers, one output row
+// pair or row) at a time. The MXU kernel takes the largest even number of
+// pixels of each scanline and the C kernel the odd one left, at the matching
+// offset; mxu1_gfx_double_row takes any count itself.
+//
+//  Bilinear scaling builds the column step table once, at the start of the
+// scratch space, then for each output row filters the two source rows it
+// falls between into the scratch row (kept when the next output row falls
+// on the same place), and runs the column pass over it. A row that falls
+// exactly on a source row is read in place. Positions are 16.16 fixed
+// point, weights their top 7 fraction bits; at the right and bottom edges
+// the last pair is used with weight 128 (all of the last pixel), so no
+// pixel past the image is ever read, except through the scratch row, which
+// has the last pixel written twice. A 1-pixel wide source always goes
+// through the scratch row.
+//
+//  The driver is written once, against a table of kernels, so that the _c
+// functions are the same computation on the C kernels.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_gfx.h"
+
+typedef void (*blend_fn)(uint32_t *dst, const uint32_t *src, int32_t n,
+                         uint32_t alpha);
+typedef void (*rows_fn)(const mxu1_gfx_rows *r);
+typedef void (*hlerp_fn)(uint32_t *dst, const uint32_t *src,
+                         const mxu1_gfx_step *step, int32_t n);
+
+typedef struct {
+  blend_fn blend[3];            // By mxu1_gfx_op
+  rows_fn  half, dbl, vlerp;
+  hlerp_fn hlerp;
+} gfx_kernels;
+
+static const gfx_kernels kernels_mxu = {
+  { mxu1_gfx_over_row, mxu1_gfx_over_straight_row, mxu1_gfx_fade_row },
+  mxu1_gfx_half_row, mxu1_gfx_double_row, mxu1_gfx_vlerp_row,
+  mxu1_gfx_hlerp_row
+};
+
+static const gfx_kernels kernels_c = {
+  { mxu1_gfx_over_row_c, mxu1_gfx_over_straight_row_c, mxu1_gfx_fade_row_c },
+  mxu1_gfx_half_row_c, mxu1_gfx_double_row_c, mxu1_gfx_vlerp_row_c,
+  mxu1_gfx_hlerp_row_c
+};
+
+static uint32_t *row(const mxu1_gfx_image *im, int y)
+{
+  return im->px + (size_t)y * im->stride;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Blending
+////////////////////////////////////////////////////////////////////////////////
+
+static void blend(const mxu1_gfx_image *dst, int x, int y,
+                  const mxu1_gfx_image *src, mxu1_gfx_op op, int alpha,
+                  const gfx_kernels *mxu)
+{
+  const blend_fn c = kernels_c.blend[op];
+  int sx = 0, sy = 0, w = src->width, h = src->height;
+
+  if (x < 0) {
+    sx = -x;
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    sy = -y;
+    h += y;
+    y = 0;
+  }
+  if (w > dst->width - x)
+    w = dst->width - x;
+  if (h > dst->height - y)
+    h = dst->height - y;
+  if (w <= 0 || h <= 0)
+    return;                     // Wholly off the destination
+
+  for (int j = 0; j < h; ++j) {
+    uint32_t *d = row(dst, y + j) + x;
+    const uint32_t *s = row(src, sy + j) + sx;
+    int n = 0;
+    if (mxu) {
+      n = w & ~1;
+      if (n)
+        mxu->blend[op](d, s, n, (uint32_t)alpha);
+    }
+    if (n < w)
+      c(d + n, s + n, w - n, (uint32_t)alpha);
+  }
+}
+
+void mxu1_gfx_blend(const mxu1_gfx_image *dst, int x, int y,
+                    const mxu1_gfx_image *src, mxu1_gfx_op op, int alpha)
+{
+  blend(dst, x, y, src, op, alpha, &kernels_mxu);
+}
+
+void mxu1_gfx_blend_c(const mxu1_gfx_image *dst, int x, int y,
+                      const mxu1_gfx_image *src, mxu1_gfx_op op, int alpha)
+{
+  blend(dst, x, y, src, op, alpha, NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 0.5x and 2x
+////////////////////////////////////////////////////////////////////////////////
+
+static void half(const mxu1_gfx_image *dst, const mxu1_gfx_image *src,
+                 const gfx_kernels *mxu)
+{
+  const int w = src->width / 2;
+  mxu1_gfx_rows r;
+
+  for (int y = 0; y < src->height / 2; ++y) {
+    int n = 0;
+    r.dst[0] = r.dst[1] = row(dst, y);
+    r.src[0] = row(src, 2 * y);
+    r.src[1] = row(src, 2 * y + 1);
+    if (mxu) {
+      n = w & ~1;
+      r.n = n;
+      if (n)
+        mxu->half(&r);
+    }
+    if (n < w) {
+      r.dst[0] += n;
+      r.src[0] += 2 * n;
+      r.src[1] += 2 * n;
+      r.n = w - n;
+      kernels_c.half(&r);
+    }
+  }
+}
+
+static void dbl(const mxu1_gfx_image *dst, const mxu1_gfx_image *src,
+                const gfx_kernels *k)
+{
+  mxu1_gfx_rows r;
+
+  r.n = src->width;
+  for (int y = 0; y < src->height; ++y) {
+    r.dst[0] = row(dst, 2 * y);
+    r.dst[1] = row(dst, 2 * y + 1);
+    r.src[0] = row(src, y);
+    r.src[1] = y + 1 < src->height ? row(src, y + 1) : r.src[0];
+    if (r.n)
+      k->dbl(&r);
+  }
+}
+
+void mxu1_gfx_half(const mxu1_gfx_image *dst, const mxu1_gfx_image *src)
+{
+  half(dst, src, &kernels_mxu);
+}
+
+void mxu1_gfx_half_c(const mxu1_gfx_image *dst, const mxu1_gfx_image *src)
+{
+  half(dst, src, NULL);
+}
+
+void mxu1_gfx_double(const mxu1_gfx_image *dst, const mxu1_gfx_image *src)
+{
+  dbl(dst, src, &kernels_mxu);
+}
+
+void mxu1_gfx_double_c(const mxu1_gfx_image *dst, const mxu1_gfx_image *src)
+{
+  dbl(dst, src, &kernels_c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Bilinear
+////////////////////////////////////////////////////////////////////////////////
+
+//  Source position of output pixel i of 'dst_n', (i + 0.5) * src_n / dst_n -
+// 0.5 in 16.16, as the left (top) pixel of its pair and the weight of the
+// right one, clamped as described above
+static void position(int i, int dst_n, int src_n, int *p, int *f)
+{
+  const int64_t step = ((int64_t)src_n << 16) / dst_n;
+  int64_t x = step / 2 - 0x8000 + step * i;
+
+  if (x < 0)
+    x = 0;
+  if (x >= (int64_t)(src_n - 1) << 16) {
+    *p = src_n > 1 ? src_n - 2 : 0;
+    *f = src_n > 1 ? 128 : 0;
+    return;
+  }
+  *p = (int)(x >> 16);
+  *f = (int)(x >> 9) & 127;
+}
+
+size_t mxu1_gfx_scale_scratch_size(const mxu1_gfx_image *dst,
+                                   const mxu1_gfx_image *src)
+{
+  return (size_t)dst->width * sizeof(mxu1_gfx_step) +
+         ((size_t)src->width + 1) * sizeof(uint32_t);
+}
+
+//  The scratch row, from src[0] and src[1] at weight 'f', n pixels
+static void vlerp(const gfx_kernels *mxu, mxu1_gfx_rows *r, int n)
+{
+  int m = 0;
+  if (mxu) {
+    m = n & ~1;
+    r->n = m;
+    if (m)
+      mxu->vlerp(r);
+  }
+  if (m < n) {
+    mxu1_gfx_rows t = *r;
+    t.dst[0] += m;
+    t.src[0] += m;
+    t.src[1] += m;
+    t.n = n - m;
+    kernels_c.vlerp(&t);
+  }
+  r->dst[0][n] = r->dst[0][n - 1];
+}
+
+static void scale(const mxu1_gfx_image *dst, const mxu1_gfx_image *src,
+                  void *scratch, const gfx_kernels *mxu)
+{
+  const int w = dst->width, sw = src->width;
+  mxu1_gfx_step *step = (mxu1_gfx_step *)scratch;
+  uint32_t *tmp = (uint32_t *)(step + w);
+  int cached = -1;                      // y * 128 + f of the scratch row
+  mxu1_gfx_rows r;
+
+  if (w <= 0 || dst->height <= 0 || sw <= 0 || src->height <= 0)
+    return;
+
+  for (int i = 0; i < w; ++i) {
+    int p, f;
+    position(i, w, sw, &p, &f);
+    step[i].off = p * 4;
+    step[i].w0 = (uint32_t)(128 - f) * 0x01010101u;
+    step[i].w1 = (uint32_t)f * 0x01010101u;
+  }
+
+  r.dst[0] = r.dst[1] = tmp;
+  r.weight = 0;
+  for (int y = 0; y < dst->height; ++y) {
+    const uint32_t *s;
+    uint32_t *d = row(dst, y);
+    int p, f, n = 0;
+
+    position(y, dst->height, src->height, &p, &f);
+    if (f == 128) {
+      ++p;
+      f = 0;
+    }
+    if (f == 0 && sw > 1) {
+      s = row(src, p);
+    } else {
+      if (cached != p * 128 + f) {
+        r.src[0] = row(src, p);
+        r.src[1] = f ? row(src, p + 1) : r.src[0];
+        r.weight = f;
+        vlerp(mxu, &r, sw);
+        cached = p * 128 + f;
+      }
+      s = tmp;
+    }
+
+    if (mxu) {
+      n = w & ~1;
+      if (n)
+        mxu->hlerp(d, s, step, n);
+    }
+    if (n < w)
+      kernels_c.hlerp(d + n, s, step + n, w - n);
+  }
+}
+
+void mxu1_gfx_scale(const mxu1_gfx_image *dst, const mxu1_gfx_image *src,
+                    void *scratch)
+{
+  scale(dst, src, scratch, &kernels_mxu);
+}
+
+void mxu1_gfx_scale_c(const mxu1_gfx_image *dst, const mxu1_gfx_image *src,
+                      void *scratch)
+{
+  scale(dst, src, scratch, NULL);
+}
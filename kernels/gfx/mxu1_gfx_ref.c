@@ -0,0 +1,142 @@
+// mxu1_gfx_ref.c
+//
+// Scalar C reference for the mxu1_gfx.s scanline kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  C versions of the scanline kernels in mxu1_gfx.s, with identical
+// arguments and results: the definition of the arithmetic in mxu1_gfx.h,
+// one channel at a time. They take any n, and are what the image functions
+// fall back on for the pixels the MXU kernels leave.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_gfx.h"
+
+//  x / 255 rounded, for x <= 255 * 255
+static uint32_t div255(uint32_t x)
+{
+  const uint32_t t = x + 128;
+  return (t + (t >> 8)) >> 8;
+}
+
+static uint32_t avgr(uint32_t a, uint32_t b)
+{
+  uint32_t r = 0;
+  for (int sh = 0; sh < 32; sh += 8)
+    r |= ((((a >> sh) & 255) + ((b >> sh) & 255) + 1) >> 1) << sh;
+  return r;
+}
+
+static uint32_t lerp(uint32_t a, uint32_t b, uint32_t f)
+{
+  uint32_t r = 0;
+  for (int sh = 0; sh < 32; sh += 8)
+    r |= ((((a >> sh) & 255) * (128 - f) + ((b >> sh) & 255) * f + 64) >> 7) << sh;
+  return r;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Blending
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_gfx_over_row_c(uint32_t *dst, const uint32_t *src, int32_t n,
+                         uint32_t alpha)
+{
+  (void)alpha;
+  for (int32_t i = 0; i < n; ++i) {
+    const uint32_t s = src[i], d = dst[i], ia = 255 - (s >> 24);
+    uint32_t r = 0;
+    for (int sh = 0; sh < 32; sh += 8)
+      r |= (((s >> sh) + div255(((d >> sh) & 255) * ia)) & 255) << sh;
+    dst[i] = r;
+  }
+}
+
+void mxu1_gfx_over_straight_row_c(uint32_t *dst, const uint32_t *src,
+                                  int32_t n, uint32_t alpha)
+{
+  (void)alpha;
+  for (int32_t i = 0; i < n; ++i) {
+    const uint32_t s = src[i], d = dst[i], sa = s >> 24;
+    uint32_t r = div255(255 * sa + (d >> 24) * (255 - sa)) << 24;
+    for (int sh = 0; sh < 24; sh += 8)
+      r |= div255(((s >> sh) & 255) * sa + ((d >> sh) & 255) * (255 - sa)) << sh;
+    dst[i] = r;
+  }
+}
+
+void mxu1_gfx_fade_row_c(uint32_t *dst, const uint32_t *src, int32_t n,
+                         uint32_t alpha)
+{
+  const uint32_t a = alpha & 255;
+  for (int32_t i = 0; i < n; ++i) {
+    const uint32_t s = src[i], d = dst[i];
+    uint32_t r = 0;
+    for (int sh = 0; sh < 32; sh += 8)
+      r |= div255(((s >> sh) & 255) * a + ((d >> sh) & 255) * (255 - a)) << sh;
+    dst[i] = r;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scaling
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_gfx_half_row_c(const mxu1_gfx_rows *r)
+{
+  const uint32_t *s0 = r->src[0], *s1 = r->src[1];
+  for (int32_t i = 0; i < r->n; ++i)
+    r->dst[0][i] = avgr(avgr(s0[2 * i], s1[2 * i]),
+                        avgr(s0[2 * i + 1], s1[2 * i + 1]));
+}
+
+void mxu1_gfx_double_row_c(const mxu1_gfx_rows *r)
+{
+  const uint32_t *s0 = r->src[0], *s1 = r->src[1];
+  uint32_t *d0 = r->dst[0], *d1 = r->dst[1];
+  for (int32_t i = 0; i < r->n; ++i) {
+    const int32_t j = i + 1 < r->n ? i + 1 : i;
+    const uint32_t top = avgr(s0[i], s0[j]);
+    d0[2 * i] = s0[i];
+    d0[2 * i + 1] = top;
+    d1[2 * i] = avgr(s0[i], s1[i]);
+    d1[2 * i + 1] = avgr(top, avgr(s1[i], s1[j]));
+  }
+}
+
+void mxu1_gfx_vlerp_row_c(const mxu1_gfx_rows *r)
+{
+  for (int32_t i = 0; i < r->n; ++i)
+    r->dst[0][i] = lerp(r->src[0][i], r->src[1][i], (uint32_t)r->weight);
+}
+
+void mxu1_gfx_hlerp_row_c(uint32_t *dst, const uint32_t *src,
+                          const mxu1_gfx_step *step, int32_t n)
+{
+  for (int32_t i = 0; i < n; ++i) {
+    const uint32_t *p = src + step[i].off / 4;
+    dst[i] = lerp(p[0], p[1], step[i].w1 & 255);
+  }
+}
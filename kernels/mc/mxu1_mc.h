@@ -0,0 +1,166 @@
+// mxu1_mc.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 H.264/HEVC sub-pixel motion compensation
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Sub-pixel motion compensation for video decoding, matching libavcodec's C
+// code byte for byte:
+//   - H.264 luma, all 16 quarter-pel positions of 16x16, 8x8 and 4x4 blocks,
+//     put and avg (h264qpel_template.c): half-pel samples from the 6-tap
+//     filter (1, -5, 20, 20, -5, 1), (sum + 16) >> 5, the centre one from
+//     the unrounded horizontal sums filtered again, (sum + 512) >> 10, and
+//     quarter-pel samples the rounded average of their two neighbours;
+//   - H.264 chroma, eighth-pel bilinear, 8, 4 and 2 pixels wide, put and
+//     avg (h264chroma_template.c): (A a + B b + C c + D d + 32) >> 6 with
+//     A = (8 - x)(8 - y), B = x (8 - y), C = (8 - x) y, D = x y;
+//   - HEVC luma, 8-bit uni-prediction (put_hevc_qpel_uni_* in
+//     hevcdsp_template.c) with the 8-tap filters of the standard, any width
+//     up to 64 and even height: (sum + 32) >> 6 in one direction, and
+//     ((sum >> 6) + 32) >> 6 of the unrounded horizontal sums in both.
+// The _c functions (mxu1_mc_ref.c) are that C, written the way libavcodec
+// writes it; the MXU ones (mxu1_mc_pred.c) build each position from the
+// kernels in mxu1_mc.s the same way, a filter straight into 'dst' or into
+// a scratch block, and q8avgr for the averages.
+//
+// Conventions shared by every function here:
+//   - 'dst' must be word aligned and the strides multiples of 4 (both are
+//     checked: anything else is passed to the _c function).
+//   - 'src' is the reference block's top left pixel, at any alignment.
+//     Filters read the pixels libavcodec reads around it (2 left, 3 right,
+//     2 up and 3 down for H.264 luma; 3, 4, 3 and 4 for HEVC; 1 right and
+//     1 down for chroma), in whole aligned words, so each row is read up to
+//     5 bytes past the right edge of that area as well: keep the reference
+//     frames' padding (or the edge emulation buffer) that much wider.
+//   - The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/mc, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_mc.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_mc_ref.c mxu1_mc_pred.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_MC_H
+#define MXU1_MC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  Widest and tallest HEVC luma prediction block
+#define MXU1_MC_HEVC_MAX        64
+
+////////////////////////////////////////////////////////////////////////////////
+// H.264 (MXU: mxu1_mc_pred.c, C: mxu1_mc_ref.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  Luma prediction of a 'size' x 'size' block (16, 8 or 4) at quarter-pel
+// offset (dx, dy), each 0 .. 3, from 'src' into 'dst', both 'stride' bytes
+// a row: put writes the prediction, avg its rounded average with 'dst'
+void mxu1_h264_qpel_put(uint8_t *dst, const uint8_t *src, int stride,
+                        int size, int dx, int dy);
+void mxu1_h264_qpel_avg(uint8_t *dst, const uint8_t *src, int stride,
+                        int size, int dx, int dy);
+void mxu1_h264_qpel_put_c(uint8_t *dst, const uint8_t *src, int stride,
+                          int size, int dx, int dy);
+void mxu1_h264_qpel_avg_c(uint8_t *dst, const uint8_t *src, int stride,
+                          int size, int dx, int dy);
+
+//  Chroma prediction of a 'w' (8, 4 or 2) x 'h' block at eighth-pel offset
+// (x, y), each 0 .. 7. The MXU takes 8 and 4 wide blocks of even height;
+// 2 wide ones are done in C.
+void mxu1_h264_chroma_put(uint8_t *dst, const uint8_t *src, int stride,
+                          int w, int h, int x, int y);
+void mxu1_h264_chroma_avg(uint8_t *dst, const uint8_t *src, int stride,
+                          int w, int h, int x, int y);
+void mxu1_h264_chroma_put_c(uint8_t *dst, const uint8_t *src, int stride,
+                            int w, int h, int x, int y);
+void mxu1_h264_chroma_avg_c(uint8_t *dst, const uint8_t *src, int stride,
+                            int w, int h, int x, int y);
+
+////////////////////////////////////////////////////////////////////////////////
+// HEVC (MXU: mxu1_mc_pred.c, C: mxu1_mc_ref.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  Luma uni-prediction of a 'w' x 'h' block at quarter-pel offset (mx, my),
+// each 0 .. 3. The MXU takes widths that are multiples of 4 (every HEVC
+// luma block's) up to MXU1_MC_HEVC_MAX and even heights up to the same.
+void mxu1_hevc_qpel_put(uint8_t *dst, int dst_stride, const uint8_t *src,
+                        int src_stride, int w, int h, int mx, int my);
+void mxu1_hevc_qpel_put_c(uint8_t *dst, int dst_stride, const uint8_t *src,
+                          int src_stride, int w, int h, int mx, int my);
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels (mxu1_mc.s), for the driver
+////////////////////////////////////////////////////////////////////////////////
+
+//  One block for a kernel: 'dst' word aligned, 'src' anywhere, strides
+// multiples of 4, 'width' a multiple of 4. Only the fields a kernel lists
+// are read, and mxu1_mc.s knows their offsets.
+typedef struct {
+  uint8_t        *dst;
+  const uint8_t  *src;
+  int32_t         dst_stride;
+  int32_t         src_stride;
+  int32_t         width;
+  int32_t         height;
+  const uint8_t  *src2;          // second source: word aligned
+  int32_t         src2_stride;
+  int16_t        *tmp;           // scratch rows: word aligned
+  const uint32_t *coef;          // weights or taps, see each kernel
+} mxu1_mc_block;
+
+//  dst = src (mxu1_mc_copy), or the rounded average of src and src2
+// (mxu1_mc_avg)
+void mxu1_mc_copy(const mxu1_mc_block *b);
+void mxu1_mc_avg(const mxu1_mc_block *b);
+
+//  H.264 luma half-pel samples, horizontal, vertical and centre, of the
+// block at 'src': width 4, 8 or 16 for _h and _hv, height a multiple of 4
+// for _v. _hv leaves the unrounded horizontal sums of rows -2 .. height + 2
+// in 'tmp' ((height + 5) * width int16_t).
+void mxu1_h264_h(const mxu1_mc_block *b);
+void mxu1_h264_v(const mxu1_mc_block *b);
+void mxu1_h264_hv(const mxu1_mc_block *b);
+
+//  H.264 chroma, even height, 'coef' the weights A, B, C, D, each in all
+// four bytes of a word
+void mxu1_h264_chroma(const mxu1_mc_block *b);
+
+//  HEVC luma, even height, 'coef' the 8 taps of the filter, each in all
+// four bytes of a word. _hv also takes the vertical filter's taps, each in
+// both halves of a word, from coef[8 .. 15], and leaves the unrounded
+// horizontal sums of rows -3 .. height + 3 in 'tmp' ((height + 7) * width
+// int16_t).
+void mxu1_hevc_h(const mxu1_mc_block *b);
+void mxu1_hevc_v(const mxu1_mc_block *b);
+void mxu1_hevc_hv(const mxu1_mc_block *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_MC_H
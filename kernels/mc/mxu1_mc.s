@@ -0,0 +1,781 @@
+# mxu1_mc.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 H.264/HEVC sub-pixel motion compensation filters
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, mxu1_mc_block and the arithmetic are described in mxu1_mc.h;
+# mxu1_mc_ref.c is libavcodec's C for the same predictions.
+#
+#  Reference rows are read as aligned words and put back together with
+# s32aln, by 4 - (src & 3) as in mxu1_me.s: the same amount for every row
+# and column of a block, since strides are multiples of 4. The neighbours a
+# filter tap needs, the row shifted by 1 to 3 pixels, are then s32alni of
+# two realigned words by a constant, so an unaligned block costs no more
+# than an aligned one.
+#
+#  Filters multiply four pixels at once by a tap held in all four bytes of
+# a word, into 16-bit lanes (pixels 3, 2 into XRa, 1, 0 into XRd): q8mac
+# for H.264 (20 and 5, the -5s subtracted with SS, the two 1s added by the
+# q8adde that starts the sums), q8macsu for HEVC's signed taps. The sums
+# stay within 16 bits, -2550 .. 10710 for H.264 and -6120 .. 22440 for
+# HEVC, so they start at (or q16acc adds) the rounding bias, q16sar shifts,
+# and q16sat clamps both lane pairs into the 4 output bytes. Averages are
+# q8avgr.
+#
+#  The centre (_hv) samples keep the horizontal pass's unrounded sums, four
+# per two words, in 'tmp', and filter those vertically with d16mac against
+# taps in both halves of a word: two 32-bit sums per instruction, started
+# at the bias of both shifts together, (sum + 512) >> 10 for H.264 and
+# (sum + 2048) >> 12 for HEVC's ((sum >> 6) + 32) >> 6, which is the same.
+# d32sarl shifts them back into halfwords for q16sat.
+#
+#   copy, avg:   4 pixels a pass, realigned from two loads (q8avgr'd with
+#                src2).
+#   h264_h:      one row a pass, straight-line for each of widths 4, 8 and
+#                16: the row's words loaded and realigned into xr1..xr6,
+#                then per 4 pixels three s32alni, q8adde and four q8mac.
+#   h264_v:      4 pixel wide strips, 4 rows a pass from the 9 realigned
+#                source rows they need, xr1..xr9; each row is q8adde and
+#                four q8mac over six of them.
+#   h264_hv:     h264_h's rows -2 .. height + 2 into 'tmp' as sums, then
+#                12 d16mac per 4 pixels over six tmp rows.
+#   chroma:      4 pixel strips, two rows a pass; each source row is loaded
+#                and realigned (at x and x + 1) once for the two output rows
+#                it is in: q8mul and three q8mac per row.
+#   hevc_h:      8 q8macsu per 4 pixels, from three realigned words xr1..xr3
+#                that slide along the row a word at a time.
+#   hevc_v:      4 pixel strips, two rows a pass sharing the 9 rows loaded,
+#                each loaded while the one before is multiplied.
+#   hevc_hv:     hevc_h's rows -3 .. height + 3 into 'tmp' as sums, then
+#                16 d16mac per 4 pixels over eight tmp rows.
+#
+# Register use: any xr, $v0, $v1, $t0..$t9 and $a0..$a3. Leaf functions, no
+# stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# mxu1_mc_block field offsets
+  .equ    MC_DST,         0
+  .equ    MC_SRC,         4
+  .equ    MC_DST_STRIDE,  8
+  .equ    MC_SRC_STRIDE,  12
+  .equ    MC_WIDTH,       16
+  .equ    MC_HEIGHT,      20
+  .equ    MC_SRC2,        24
+  .equ    MC_SRC2_STRIDE, 28
+  .equ    MC_TMP,         32
+  .equ    MC_COEF,        36
+
+
+################################################################################
+#  dst, src, their strides, width and height into $t0..$t5
+.macro MC_ENTER
+  lw      $t0,  MC_DST($a0)
+  lw      $t1,  MC_SRC($a0)
+  lw      $t2,  MC_DST_STRIDE($a0)
+  lw      $t3,  MC_SRC_STRIDE($a0)
+  lw      $t4,  MC_WIDTH($a0)
+  lw      $t5,  MC_HEIGHT($a0)
+.endm
+
+# Split \p into its aligned address and the s32aln amount \sh; leaves
+#  \p & 3 in $v0
+.macro MC_ALIGN p, sh
+  andi    $v0,  \p,   3
+  li      \sh,  4
+  subu    \p,   \p,   $v0
+  subu    \sh,  \sh,  $v0
+.endm
+
+#  One row of a two-pass filter's vertical pass: the tmp row after \q (and
+# \q moved to it, \s bytes on), in \r0 (pixels 1, 0) and \r1 (3, 2), times
+# the tap \c into the sums xr1/xr2 and xr3/xr4
+.macro MC_VTAP q, s, r0, r1, c, pat
+  s32ldiv \r0,  \q,   \s,   0
+  s32ldd  \r1,  \q,   4
+  d16mac  xr1,  \r0,  \c,   xr2,  \pat, WW
+  d16mac  xr3,  \r1,  \c,   xr4,  \pat, WW
+.endm
+
+#  The 4 pixels from the vertical sums, shifted by \sh, to \d
+.macro MC_VPUT d, sh
+  d32sarl xr1,  xr1,  xr2,  \sh
+  d32sarl xr3,  xr3,  xr4,  \sh
+  q16sat  xr1,  xr3,  xr1
+  s32std  xr1,  \d,   0
+.endm
+
+
+################################################################################
+# void mxu1_mc_copy(const mxu1_mc_block *b)
+  .globl  mxu1_mc_copy
+  .type   mxu1_mc_copy, @function
+  .ent    mxu1_mc_copy
+mxu1_mc_copy:
+  MC_ENTER
+  MC_ALIGN $t1, $v1
+1:                                        # Rows
+  move    $t6,  $t1
+  move    $t7,  $t0
+  move    $t8,  $t4
+2:                                        # 4 pixels
+  s32ldd  xr1,  $t6,  0
+  s32ldd  xr2,  $t6,  4
+  addiu   $t8,  $t8,  -4
+  addiu   $t6,  $t6,  4
+  s32aln  xr1,  xr2,  xr1,  $v1
+  s32std  xr1,  $t7,  0
+  bnez    $t8,  2b
+  addiu   $t7,  $t7,  4
+  addiu   $t5,  $t5,  -1
+  addu    $t1,  $t1,  $t3
+  bnez    $t5,  1b
+  addu    $t0,  $t0,  $t2
+  jr      $ra
+  nop
+  .end    mxu1_mc_copy
+  .size   mxu1_mc_copy, .-mxu1_mc_copy
+
+
+################################################################################
+# void mxu1_mc_avg(const mxu1_mc_block *b)
+  .globl  mxu1_mc_avg
+  .type   mxu1_mc_avg, @function
+  .ent    mxu1_mc_avg
+mxu1_mc_avg:
+  MC_ENTER
+  lw      $t9,  MC_SRC2($a0)
+  lw      $a3,  MC_SRC2_STRIDE($a0)
+  MC_ALIGN $t1, $v1
+1:                                        # Rows
+  move    $t6,  $t1
+  move    $t7,  $t0
+  move    $a1,  $t9
+  move    $t8,  $t4
+2:                                        # 4 pixels
+  s32ldd  xr1,  $t6,  0
+  s32ldd  xr2,  $t6,  4
+  s32ldd  xr3,  $a1,  0
+  addiu   $t6,  $t6,  4
+  s32aln  xr1,  xr2,  xr1,  $v1
+  addiu   $a1,  $a1,  4
+  q8avgr  xr1,  xr1,  xr3
+  addiu   $t8,  $t8,  -4
+  s32std  xr1,  $t7,  0
+  bnez    $t8,  2b
+  addiu   $t7,  $t7,  4
+  addiu   $t5,  $t5,  -1
+  addu    $t1,  $t1,  $t3
+  addu    $t9,  $t9,  $a3
+  bnez    $t5,  1b
+  addu    $t0,  $t0,  $t2
+  jr      $ra
+  nop
+  .end    mxu1_mc_avg
+  .size   mxu1_mc_avg, .-mxu1_mc_avg
+
+
+################################################################################
+# H.264 luma
+################################################################################
+
+#  xr11/xr12 = taps 20 and 5 in every byte, xr13 = the bias \bias in both
+# halves
+.macro H264_TAPS bias
+  s32lui  xr11, 20,   7
+  s32lui  xr12, 5,    7
+  s32lui  xr13, \bias, 4
+.endm
+
+#  The 6-tap sums of 4 pixels from \u0..\u2, the realigned row words at
+# x - 2, x + 2 and x + 6, plus the bias: pixels x + 3, x + 2 into xr9 and
+# x + 1, x into xr10. Two chains of sums, xr9/xr10 and xr14/xr15, so that
+# no q8mac waits on the one before. Uses xr7, xr8.
+.macro H264_SUMS u0, u1, u2
+  s32alni xr7,  \u2,  \u1,  3             # x + 3
+  s32alni xr8,  \u1,  \u0,  2             # x
+  q8adde  xr9,  \u0,  xr7,  xr10, AA      # x - 2 and x + 3
+  d32add  xr14, xr13, xr0,  xr15, AA
+  s32alni xr7,  \u1,  \u0,  1             # x + 1
+  q8mac   xr9,  xr8,  xr11, xr10, AA
+  q8mac   xr14, xr7,  xr11, xr15, AA
+  s32alni xr8,  \u1,  \u0,  3             # x - 1
+  q8mac   xr9,  \u1,  xr12, xr10, SS      # x + 2
+  q8mac   xr14, xr8,  xr12, xr15, SS
+  q16accm xr9,  xr14, xr15, xr10, AA
+.endm
+
+#  Group \g of a row, pixels 4 \g .. 4 \g + 3, as half-pel pixels to \d
+.macro H264_PUT d, g
+  q16sar  xr9,  xr9,  xr10, xr10, 5
+  q16sat  xr9,  xr9,  xr10
+  s32std  xr9,  \d,   (4 * \g)
+.endm
+
+#  ... or as their sums, to \d as int16_t
+.macro H264_KEEP d, g
+  s32std  xr10, \d,   (8 * \g)
+  s32std  xr9,  \d,   (8 * \g + 4)
+.endm
+
+#  \rows rows of \n (1, 2 or 4) groups of 4 pixels from the aligned words at
+# $t6 (realigned by $v1), to $t7 by \out; the rows are $t3 and \stride
+# bytes apart
+.macro H264_H_ROWS n, out, rows, stride
+1:
+  s32ldd  xr1,  $t6,  0
+  s32ldd  xr2,  $t6,  4
+  s32ldd  xr3,  $t6,  8
+  .if \n == 1
+  s32aln  xr1,  xr2,  xr1,  $v1
+  s32aln  xr2,  xr3,  xr2,  $v1
+  s32aln  xr3,  xr3,  xr3,  $v1           # Only its first byte is used
+  H264_SUMS xr1, xr2, xr3
+  \out    $t7,  0
+  .endif
+  .if \n == 2
+  s32ldd  xr4,  $t6,  12
+  s32aln  xr1,  xr2,  xr1,  $v1
+  s32aln  xr2,  xr3,  xr2,  $v1
+  s32aln  xr3,  xr4,  xr3,  $v1
+  s32aln  xr4,  xr4,  xr4,  $v1
+  H264_SUMS xr1, xr2, xr3
+  \out    $t7,  0
+  H264_SUMS xr2, xr3, xr4
+  \out    $t7,  1
+  .endif
+  .if \n == 4
+  s32ldd  xr4,  $t6,  12
+  s32aln  xr1,  xr2,  xr1,  $v1
+  s32ldd  xr5,  $t6,  16
+  s32aln  xr2,  xr3,  xr2,  $v1
+  s32ldd  xr6,  $t6,  20
+  s32aln  xr3,  xr4,  xr3,  $v1
+  H264_SUMS xr1, xr2, xr3
+  s32aln  xr4,  xr5,  xr4,  $v1
+  \out    $t7,  0
+  H264_SUMS xr2, xr3, xr4
+  s32aln  xr5,  xr6,  xr5,  $v1
+  \out    $t7,  1
+  H264_SUMS xr3, xr4, xr5
+  s32aln  xr6,  xr6,  xr6,  $v1
+  \out    $t7,  2
+  H264_SUMS xr4, xr5, xr6
+  \out    $t7,  3
+  .endif
+  addiu   \rows, \rows, -1
+  addu    $t6,  $t6,  $t3
+  bnez    \rows, 1b
+  addu    $t7,  $t7,  \stride
+.endm
+
+#  H264_H_ROWS for the width $t4 (4, 8 or 16), then return
+.macro H264_H_WIDTHS out, rows, stride
+  li      $t8,  16
+  beq     $t4,  $t8,  3f
+  li      $t8,  8
+  beq     $t4,  $t8,  2f
+  nop
+  H264_H_ROWS 1, \out, \rows, \stride
+  b       9f
+  nop
+2:
+  H264_H_ROWS 2, \out, \rows, \stride
+  b       9f
+  nop
+3:
+  H264_H_ROWS 4, \out, \rows, \stride
+9:
+.endm
+
+
+################################################################################
+# void mxu1_h264_h(const mxu1_mc_block *b)
+  .globl  mxu1_h264_h
+  .type   mxu1_h264_h, @function
+  .ent    mxu1_h264_h
+mxu1_h264_h:
+  MC_ENTER
+  H264_TAPS 16
+  addiu   $t6,  $t1,  -2
+  MC_ALIGN $t6, $v1
+  move    $t7,  $t0
+  H264_H_WIDTHS H264_PUT, $t5, $t2
+  jr      $ra
+  nop
+  .end    mxu1_h264_h
+  .size   mxu1_h264_h, .-mxu1_h264_h
+
+
+################################################################################
+# void mxu1_h264_v(const mxu1_mc_block *b)
+#
+#  Source rows y - 2 .. y + 6 for output rows y .. y + 3; $a1 steps down
+# them from row y - 3. xr14/xr15 hold the sums.
+
+#  Loads the next source row into \r and the word after it into \t
+.macro H264_V_LOAD r, t
+  s32ldiv \r,   $a1,  $t3,  0
+  s32ldd  \t,   $a1,  4
+.endm
+
+#  The output row from source rows \r0..\r5, to $t7 and on to the next; the
+# source row \next (if not 'none') is loaded meanwhile
+.macro H264_V_ROW r0, r1, r2, r3, r4, r5, next
+  q8adde  xr14, \r0,  \r5,  xr15, AA
+  q8mac   xr14, \r2,  xr11, xr15, AA
+  .ifnc \next, none
+  s32ldiv \next, $a1, $t3,  0
+  .endif
+  q8mac   xr14, \r3,  xr11, xr15, AA
+  .ifnc \next, none
+  s32ldd  xr10, $a1,  4
+  .endif
+  q8mac   xr14, \r1,  xr12, xr15, SS
+  .ifnc \next, none
+  s32aln  \next, xr10, \next, $v1
+  .endif
+  q8mac   xr14, \r4,  xr12, xr15, SS
+  q16acc  xr14, xr13, xr0,  xr15, AA
+  q16sar  xr14, xr14, xr15, xr15, 5
+  q16sat  xr14, xr14, xr15
+  s32std  xr14, $t7,  0
+  addu    $t7,  $t7,  $t2
+.endm
+
+  .globl  mxu1_h264_v
+  .type   mxu1_h264_v, @function
+  .ent    mxu1_h264_v
+mxu1_h264_v:
+  MC_ENTER
+  H264_TAPS 16
+  MC_ALIGN $t1, $v1
+  sll     $t9,  $t3,  2                   # 4 rows
+  sll     $v0,  $t3,  1
+  addu    $v0,  $v0,  $t3
+  subu    $t1,  $t1,  $v0                 # Row -3
+1:                                        # 4 pixel strips
+  move    $t6,  $t1
+  move    $t7,  $t0
+  move    $t8,  $t5
+2:                                        # 4 rows
+  move    $a1,  $t6                       # Rows -2 .. 3, two in flight
+  H264_V_LOAD xr1, xr7
+  H264_V_LOAD xr2, xr8
+  s32aln  xr1,  xr7,  xr1,  $v1
+  H264_V_LOAD xr3, xr7
+  s32aln  xr2,  xr8,  xr2,  $v1
+  H264_V_LOAD xr4, xr8
+  s32aln  xr3,  xr7,  xr3,  $v1
+  H264_V_LOAD xr5, xr7
+  s32aln  xr4,  xr8,  xr4,  $v1
+  H264_V_LOAD xr6, xr8
+  s32aln  xr5,  xr7,  xr5,  $v1
+  s32aln  xr6,  xr8,  xr6,  $v1
+  H264_V_ROW xr1, xr2, xr3, xr4, xr5, xr6, xr7
+  H264_V_ROW xr2, xr3, xr4, xr5, xr6, xr7, xr8
+  H264_V_ROW xr3, xr4, xr5, xr6, xr7, xr8, xr9
+  addiu   $t8,  $t8,  -4
+  H264_V_ROW xr4, xr5, xr6, xr7, xr8, xr9, none
+  bnez    $t8,  2b
+  addu    $t6,  $t6,  $t9
+  addiu   $t4,  $t4,  -4
+  addiu   $t1,  $t1,  4
+  bnez    $t4,  1b
+  addiu   $t0,  $t0,  4
+  jr      $ra
+  nop
+  .end    mxu1_h264_v
+  .size   mxu1_h264_v, .-mxu1_h264_v
+
+
+################################################################################
+# void mxu1_h264_hv(const mxu1_mc_block *b)
+#
+#  The horizontal pass writes height + 5 rows of sums to tmp, 2 * width
+# bytes apart ($v0); output row y is then over tmp rows y .. y + 5.
+  .globl  mxu1_h264_hv
+  .type   mxu1_h264_hv, @function
+  .ent    mxu1_h264_hv
+mxu1_h264_hv:
+  MC_ENTER
+  lw      $t9,  MC_TMP($a0)
+  H264_TAPS 0
+  sll     $v0,  $t3,  1
+  subu    $t6,  $t1,  $v0
+  addiu   $t6,  $t6,  -2                  # Row -2, column -2
+  MC_ALIGN $t6, $v1
+  move    $t7,  $t9
+  addiu   $t1,  $t5,  5
+  sll     $a3,  $t4,  1
+  H264_H_WIDTHS H264_KEEP, $t1, $a3
+
+  s32lui  xr11, 20,   4
+  s32lui  xr12, 5,    4
+  s32lui  xr13, 1,    4
+  li      $v0,  512
+  s32i2m  xr14, $v0
+1:                                        # Rows
+  move    $t6,  $t9
+  move    $t7,  $t0
+  move    $t8,  $t4
+2:                                        # 4 pixels
+  subu    $a1,  $t6,  $a3
+  d32add  xr1,  xr14, xr0,  xr2,  AA
+  d32add  xr3,  xr14, xr0,  xr4,  AA
+  MC_VTAP $a1, $a3, xr5, xr6, xr13, AA
+  MC_VTAP $a1, $a3, xr7, xr8, xr12, SS
+  MC_VTAP $a1, $a3, xr5, xr6, xr11, AA
+  MC_VTAP $a1, $a3, xr7, xr8, xr11, AA
+  MC_VTAP $a1, $a3, xr5, xr6, xr12, SS
+  MC_VTAP $a1, $a3, xr7, xr8, xr13, AA
+  addiu   $t8,  $t8,  -4
+  addiu   $t6,  $t6,  8
+  MC_VPUT $t7, 10
+  bnez    $t8,  2b
+  addiu   $t7,  $t7,  4
+  addiu   $t5,  $t5,  -1
+  addu    $t9,  $t9,  $a3
+  bnez    $t5,  1b
+  addu    $t0,  $t0,  $t2
+  jr      $ra
+  nop
+  .end    mxu1_h264_hv
+  .size   mxu1_h264_hv, .-mxu1_h264_hv
+
+
+################################################################################
+# void mxu1_h264_chroma(const mxu1_mc_block *b)
+#
+#  Weights A, B, C, D in xr8..xr11, the bias 32 in xr12, the sums in
+# xr6/xr7 and xr13/xr14 (two chains, as in H264_SUMS). A source row is
+# loaded as its words at x and x + 1 (s32aln by $v1 and $t9), into xr1/xr2
+# and xr3/xr4 by turns: each output row is over the pair loaded last.
+
+#  Loads and realigns the next source row into \w0 (x) and \w1 (x + 1)
+.macro CHROMA_LOAD w0, w1
+  s32ldd  \w0,  $t6,  0
+  s32ldd  xr5,  $t6,  4
+  addu    $t6,  $t6,  $t3
+  s32aln  \w1,  xr5,  \w0,  $t9
+  s32aln  \w0,  xr5,  \w0,  $v1
+.endm
+
+#  The output row from source rows \p0/\p1 and \q0/\q1, to $t7 and on
+.macro CHROMA_ROW p0, p1, q0, q1
+  d32add  xr13, xr12, xr0,  xr14, AA
+  q8mul   xr6,  \p0,  xr8,  xr7
+  q8mac   xr13, \p1,  xr9,  xr14, AA
+  q8mac   xr6,  \q0,  xr10, xr7,  AA
+  q8mac   xr13, \q1,  xr11, xr14, AA
+  q16accm xr6,  xr13, xr14, xr7,  AA
+  q16sar  xr6,  xr6,  xr7,  xr7,  6
+  q16sat  xr6,  xr6,  xr7
+  s32std  xr6,  $t7,  0
+  addu    $t7,  $t7,  $t2
+.endm
+
+  .globl  mxu1_h264_chroma
+  .type   mxu1_h264_chroma, @function
+  .ent    mxu1_h264_chroma
+mxu1_h264_chroma:
+  MC_ENTER
+  lw      $t9,  MC_COEF($a0)
+  s32lui  xr12, 32,   4
+  s32ldd  xr8,  $t9,  0
+  s32ldd  xr9,  $t9,  4
+  s32ldd  xr10, $t9,  8
+  s32ldd  xr11, $t9,  12
+  MC_ALIGN $t1, $v1
+  addiu   $t9,  $v1,  -1                  # x + 1 (0 when src & 3 is 3)
+1:                                        # 4 pixel strips
+  move    $t6,  $t1
+  move    $t7,  $t0
+  move    $t8,  $t5
+  CHROMA_LOAD xr1, xr2
+2:                                        # 2 rows
+  CHROMA_LOAD xr3, xr4
+  CHROMA_ROW xr1, xr2, xr3, xr4
+  CHROMA_LOAD xr1, xr2
+  addiu   $t8,  $t8,  -2
+  CHROMA_ROW xr3, xr4, xr1, xr2
+  bnez    $t8,  2b
+  nop
+  addiu   $t4,  $t4,  -4
+  addiu   $t1,  $t1,  4
+  bnez    $t4,  1b
+  addiu   $t0,  $t0,  4
+  jr      $ra
+  nop
+  .end    mxu1_h264_chroma
+  .size   mxu1_h264_chroma, .-mxu1_h264_chroma
+
+
+################################################################################
+# HEVC luma
+################################################################################
+
+#  The 8 taps at \p into xr8..xr15
+.macro HEVC_TAPS p
+  s32ldd  xr8,  \p,   0
+  s32ldd  xr9,  \p,   4
+  s32ldd  xr10, \p,   8
+  s32ldd  xr11, \p,   12
+  s32ldd  xr12, \p,   16
+  s32ldd  xr13, \p,   20
+  s32ldd  xr14, \p,   24
+  s32ldd  xr15, \p,   28
+.endm
+
+#  The 4 pixels at \d from the sums (which started at the bias)
+.macro HEVC_PUT d
+  q16sar  xr6,  xr6,  xr7,  xr7,  6
+  q16sat  xr6,  xr6,  xr7
+  s32std  xr6,  \d,   0
+.endm
+
+#  ... or the sums themselves, as int16_t
+.macro HEVC_KEEP d
+  s32std  xr7,  \d,   0
+  s32std  xr6,  \d,   4
+.endm
+
+#  \rows rows of the width $t4 from the aligned words at $t6 (realigned by
+# $v1), to $t7 by \out, \step bytes per 4 pixels; the rows are $t3 and
+# \stride bytes apart. The 8-tap sums of pixels x .. x + 3, from xr1..xr3
+# (the realigned words at x - 3, x + 1 and x + 5), start at $a3 in both
+# halves of xr6 (x + 3, x + 2) and xr7 (x + 1, x). The two taps on whole
+# words go first, between the others, so no q8macsu waits on the one
+# before.
+.macro HEVC_H_ROWS out, step, rows, stride
+1:                                        # Rows
+  s32ldd  xr1,  $t6,  0
+  s32ldd  xr2,  $t6,  4
+  s32ldd  xr4,  $t6,  8
+  addiu   $a1,  $t6,  12
+  move    $a2,  $t7
+  s32aln  xr1,  xr2,  xr1,  $v1
+  move    $t8,  $t4
+  s32aln  xr2,  xr4,  xr2,  $v1
+2:                                        # 4 pixels: xr4 = the last word
+  s32ldd  xr5,  $a1,  0
+  s32i2m  xr6,  $a3
+  s32i2m  xr7,  $a3
+  s32aln  xr3,  xr5,  xr4,  $v1
+  q8macsu xr6,  xr8,  xr1,  xr7,  AA      # x - 3
+  s32alni xr4,  xr5,  xr0,  0
+  q8macsu xr6,  xr12, xr2,  xr7,  AA      # x + 1
+  s32alni xr5,  xr2,  xr1,  3
+  addiu   $a1,  $a1,  4
+  q8macsu xr6,  xr9,  xr5,  xr7,  AA      # x - 2
+  s32alni xr5,  xr2,  xr1,  2
+  q8macsu xr6,  xr10, xr5,  xr7,  AA      # x - 1
+  s32alni xr5,  xr2,  xr1,  1
+  q8macsu xr6,  xr11, xr5,  xr7,  AA      # x
+  s32alni xr5,  xr3,  xr2,  3
+  q8macsu xr6,  xr13, xr5,  xr7,  AA      # x + 2
+  s32alni xr5,  xr3,  xr2,  2
+  q8macsu xr6,  xr14, xr5,  xr7,  AA      # x + 3
+  s32alni xr5,  xr3,  xr2,  1
+  q8macsu xr6,  xr15, xr5,  xr7,  AA      # x + 4
+  addiu   $t8,  $t8,  -4
+  \out    $a2
+  s32alni xr1,  xr2,  xr0,  0
+  s32alni xr2,  xr3,  xr0,  0
+  bnez    $t8,  2b
+  addiu   $a2,  $a2,  \step
+  addiu   \rows, \rows, -1
+  addu    $t6,  $t6,  $t3
+  bnez    \rows, 1b
+  addu    $t7,  $t7,  \stride
+.endm
+
+
+################################################################################
+# void mxu1_hevc_h(const mxu1_mc_block *b)
+  .globl  mxu1_hevc_h
+  .type   mxu1_hevc_h, @function
+  .ent    mxu1_hevc_h
+mxu1_hevc_h:
+  MC_ENTER
+  lw      $t9,  MC_COEF($a0)
+  HEVC_TAPS $t9
+  addiu   $t6,  $t1,  -3
+  MC_ALIGN $t6, $v1
+  move    $t7,  $t0
+  li      $a3,  0x00200020
+  HEVC_H_ROWS HEVC_PUT, 4, $t5, $t2
+  jr      $ra
+  nop
+  .end    mxu1_hevc_h
+  .size   mxu1_hevc_h, .-mxu1_hevc_h
+
+
+################################################################################
+# void mxu1_hevc_v(const mxu1_mc_block *b)
+#
+#  Source rows y - 3 .. y + 5 for output rows y and y + 1; $a1 steps down
+# them from row y - 4. Row i is tap i of output y (xr1/xr2) and tap i - 1 of
+# output y + 1 (xr3/xr4), both started at the bias in $a3. The rows take
+# turns in xr5 and xr7, the next loaded while the last is used.
+
+#  The source row \r times taps \ca and \cb (either may be 'none'), while
+# the next is loaded into \next (if not 'none')
+.macro HEVC_V_ROW r, next, ca, cb
+  .ifnc \next, none
+  s32ldiv \next, $a1, $t3,  0
+  s32ldd  xr6,  $a1,  4
+  .endif
+  .ifnc \ca, none
+  q8macsu xr1,  \ca,  \r,   xr2,  AA
+  .endif
+  .ifnc \cb, none
+  q8macsu xr3,  \cb,  \r,   xr4,  AA
+  .endif
+  .ifnc \next, none
+  s32aln  \next, xr6, \next, $v1
+  .endif
+.endm
+
+  .globl  mxu1_hevc_v
+  .type   mxu1_hevc_v, @function
+  .ent    mxu1_hevc_v
+mxu1_hevc_v:
+  MC_ENTER
+  lw      $t9,  MC_COEF($a0)
+  HEVC_TAPS $t9
+  li      $a3,  0x00200020
+  MC_ALIGN $t1, $v1
+  sll     $t9,  $t3,  1                   # 2 rows
+  sll     $v0,  $t3,  2
+  subu    $t1,  $t1,  $v0                 # Row -4
+1:                                        # 4 pixel strips
+  move    $t6,  $t1
+  move    $t7,  $t0
+  move    $t8,  $t5
+2:                                        # 2 rows
+  move    $a1,  $t6
+  s32ldiv xr5,  $a1,  $t3,  0
+  s32ldd  xr6,  $a1,  4
+  s32i2m  xr1,  $a3
+  s32i2m  xr2,  $a3
+  s32i2m  xr3,  $a3
+  s32i2m  xr4,  $a3
+  s32aln  xr5,  xr6,  xr5,  $v1
+  HEVC_V_ROW xr5, xr7,  xr8,  none
+  HEVC_V_ROW xr7, xr5,  xr9,  xr8
+  HEVC_V_ROW xr5, xr7,  xr10, xr9
+  HEVC_V_ROW xr7, xr5,  xr11, xr10
+  HEVC_V_ROW xr5, xr7,  xr12, xr11
+  HEVC_V_ROW xr7, xr5,  xr13, xr12
+  HEVC_V_ROW xr5, xr7,  xr14, xr13
+  HEVC_V_ROW xr7, xr5,  xr15, xr14
+  HEVC_V_ROW xr5, none, none, xr15
+  q16sar  xr1,  xr1,  xr2,  xr2,  6
+  q16sar  xr3,  xr3,  xr4,  xr4,  6
+  q16sat  xr1,  xr1,  xr2
+  q16sat  xr3,  xr3,  xr4
+  addiu   $t8,  $t8,  -2
+  s32std  xr1,  $t7,  0
+  addu    $t7,  $t7,  $t2
+  s32std  xr3,  $t7,  0
+  addu    $t6,  $t6,  $t9
+  bnez    $t8,  2b
+  addu    $t7,  $t7,  $t2
+  addiu   $t4,  $t4,  -4
+  addiu   $t1,  $t1,  4
+  bnez    $t4,  1b
+  addiu   $t0,  $t0,  4
+  jr      $ra
+  nop
+  .end    mxu1_hevc_v
+  .size   mxu1_hevc_v, .-mxu1_hevc_v
+
+
+################################################################################
+# void mxu1_hevc_hv(const mxu1_mc_block *b)
+#
+#  The horizontal pass writes height + 7 rows of sums to tmp, 2 * width
+# bytes apart ($v0); output row y is then over tmp rows y .. y + 7, with
+# the vertical taps (coef + 8) in xr8..xr15.
+  .globl  mxu1_hevc_hv
+  .type   mxu1_hevc_hv, @function
+  .ent    mxu1_hevc_hv
+mxu1_hevc_hv:
+  MC_ENTER
+  lw      $t9,  MC_TMP($a0)
+  lw      $a0,  MC_COEF($a0)
+  HEVC_TAPS $a0
+  sll     $v0,  $t3,  1
+  addu    $v0,  $v0,  $t3
+  subu    $t6,  $t1,  $v0
+  addiu   $t6,  $t6,  -3                  # Row -3, column -3
+  MC_ALIGN $t6, $v1
+  move    $t7,  $t9
+  addiu   $t1,  $t5,  7
+  sll     $v0,  $t4,  1
+  move    $a3,  $zero
+  HEVC_H_ROWS HEVC_KEEP, 8, $t1, $v0
+
+  addiu   $a0,  $a0,  32
+  HEVC_TAPS $a0
+  li      $v1,  2048
+  s32i2m  xr7,  $v1
+1:                                        # Rows
+  move    $t6,  $t9
+  move    $t7,  $t0
+  move    $t8,  $t4
+2:                                        # 4 pixels
+  subu    $a1,  $t6,  $v0
+  d32add  xr1,  xr7,  xr0,  xr2,  AA
+  d32add  xr3,  xr7,  xr0,  xr4,  AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr8,  AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr9,  AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr10, AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr11, AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr12, AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr13, AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr14, AA
+  MC_VTAP $a1, $v0, xr5, xr6, xr15, AA
+  addiu   $t8,  $t8,  -4
+  addiu   $t6,  $t6,  8
+  MC_VPUT $t7, 12
+  bnez    $t8,  2b
+  addiu   $t7,  $t7,  4
+  addiu   $t5,  $t5,  -1
+  addu    $t9,  $t9,  $v0
+  bnez    $t5,  1b
+  addu    $t0,  $t0,  $t2
+  jr      $ra
+  nop
+  .end    mxu1_hevc_hv
+  .size   mxu1_hevc_hv, .-mxu1_hevc_hv
+
+# vim:shiftwidth=2:expandtab:syntax=asm
@@ -0,0 +1,223 @@
+// mxu1_mc_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 H.264 and HEVC motion compensation: checks and Mpixel/s
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Checks every function in mxu1_mc.h against its _c version, at every
+// position and block size, put and avg, from reference blocks at all four
+// alignments, over random pictures and ones of 0s and 255s only (the
+// largest overshoots, to be clipped), then prints Mpixel/s for the MXU and
+// C versions per block size: H.264 luma over its 16 positions, chroma over
+// its 64, and HEVC at full-pel, horizontal, vertical and both.
+//
+// Build and run on the target (kernels/mc):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_mc_bench
+//         mxu1_mc_bench.c mxu1_mc_pred.c mxu1_mc_ref.c mxu1_mc.s
+//         ../dispatch/mxu1_cpu.c
+//     ./mxu1_mc_bench [seconds per test, default 1]
+// Exits non-zero if any result differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_mc.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+//  The reference picture, with room around the blocks for the filters, and
+// the destination; 'ORIGIN' is the blocks' top left pixel
+#define STRIDE  128
+#define ORIGIN  (8 * STRIDE + 8)
+static uint8_t picture[STRIDE * (MXU1_MC_HEVC_MAX + 24)];
+static uint32_t out_words[2][STRIDE * MXU1_MC_HEVC_MAX / 4];
+
+enum { LUMA, CHROMA, HEVC, CODECS };
+
+static const char *const name[] = { "h264 luma", "h264 chroma", "hevc luma" };
+
+//  Predicts block (w, h) at fraction (fx, fy) from picture + ORIGIN + at
+// into d, MXU or C, put or avg
+static void predict(int codec, int c, int avg, uint8_t *d, int at, int w,
+                    int h, int fx, int fy)
+{
+  const uint8_t *s = picture + ORIGIN + at;
+
+  switch (codec) {
+    case LUMA:
+      if (avg)
+        (c ? mxu1_h264_qpel_avg_c : mxu1_h264_qpel_avg)(d, s, STRIDE, w, fx,
+                                                         fy);
+      else
+        (c ? mxu1_h264_qpel_put_c : mxu1_h264_qpel_put)(d, s, STRIDE, w, fx,
+                                                         fy);
+      break;
+    case CHROMA:
+      if (avg)
+        (c ? mxu1_h264_chroma_avg_c : mxu1_h264_chroma_avg)(d, s, STRIDE, w,
+                                                             h, fx, fy);
+      else
+        (c ? mxu1_h264_chroma_put_c : mxu1_h264_chroma_put)(d, s, STRIDE, w,
+                                                             h, fx, fy);
+      break;
+    default:
+      (c ? mxu1_hevc_qpel_put_c : mxu1_hevc_qpel_put)(d, STRIDE, s, STRIDE, w,
+                                                      h, fx, fy);
+      break;
+  }
+}
+
+//  Whether the MXU and C versions agree on one block, from the same
+// starting dst
+static int check(int codec, int avg, int at, int w, int h, int fx, int fy)
+{
+  uint8_t *const m = (uint8_t *)out_words[0], *const c =
+      (uint8_t *)out_words[1];
+
+  for (size_t i = 0; i < sizeof(out_words[0]); ++i)
+    m[i] = c[i] = (uint8_t)rand16();
+  predict(codec, 0, avg, m, at, w, h, fx, fy);
+  predict(codec, 1, avg, c, at, w, h, fx, fy);
+  if (!memcmp(m, c, sizeof(out_words[0])))
+    return 1;
+  printf("%-12s %s %2dx%-2d (%d, %d) at +%d: MISMATCH\n", name[codec],
+         avg ? "avg" : "put", w, h, fx, fy, at);
+  return 0;
+}
+
+//  Fractions at a codec's step: 4 for the quarter-pel ones, 8 for chroma
+static int fractions(int codec)
+{
+  return codec == CHROMA ? 8 : 4;
+}
+
+//  Mpixel/s of w x h blocks at every fraction in turn (or only (fx, fy),
+// if fx >= 0), from the four alignments in turn
+static double mpixels(int codec, int c, int avg, int w, int h, int fx, int fy,
+                      double secs)
+{
+  const int n = fractions(codec);
+  unsigned long k = 0;
+  double t0 = now(), dt;
+
+  do {
+    for (int i = 0; i < 64; ++i, ++k) {
+      const int f = (int)(k % (n * n));
+      predict(codec, c, avg, (uint8_t *)out_words[0], (int)(k & 3), w, h,
+              fx >= 0 ? fx : f % n, fx >= 0 ? fy : f / n);
+    }
+    dt = now() - t0;
+  } while (dt < secs);
+  return k * (double)(w * h) / dt * 1e-6;
+}
+
+int main(int argc, char **argv)
+{
+  static const int luma[] = { 16, 8, 4 };
+  static const int chroma[][2] = { { 8, 8 }, { 8, 4 }, { 4, 4 }, { 4, 2 },
+                                   { 2, 2 } };
+  static const int hevc[][2] = { { 64, 64 }, { 32, 32 }, { 16, 16 },
+                                 { 8, 8 }, { 12, 16 }, { 8, 4 }, { 4, 8 } };
+  static const char *const hevc_at[] = { "full", "h", "v", "hv" };
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  int failed = 0;
+
+  mxu1_cpu_enable();
+
+  // Random, then 0s and 255s in random runs
+  for (int fill = 0; fill < 2; ++fill) {
+    for (size_t i = 0; i < sizeof(picture); ++i)
+      picture[i] = fill == 0 ? (uint8_t)rand16() :
+                   (rand16() & 7) < 3 ? 255 : 0;
+    for (int at = 0; at < 4; ++at) {
+      for (int avg = 0; avg < 2; ++avg) {
+        for (int f = 0; f < 16; ++f) {
+          for (size_t s = 0; s < sizeof(luma) / sizeof(luma[0]); ++s)
+            failed |= !check(LUMA, avg, at, luma[s], luma[s], f % 4, f / 4);
+        }
+        for (int f = 0; f < 64; ++f) {
+          for (size_t s = 0; s < sizeof(chroma) / sizeof(chroma[0]); ++s)
+            failed |= !check(CHROMA, avg, at, chroma[s][0], chroma[s][1],
+                             f % 8, f / 8);
+          failed |= !check(CHROMA, avg, at, 8, 16, f % 8, f / 8);
+          failed |= !check(CHROMA, avg, at, 4, 3, f % 8, f / 8);
+        }
+      }
+      for (int f = 0; f < 16; ++f) {
+        for (int w = 4; w <= MXU1_MC_HEVC_MAX; w += 4)
+          failed |= !check(HEVC, 0, at, w, (int)(rand16() % 32) * 2 + 2,
+                           f % 4, f / 4);
+        failed |= !check(HEVC, 0, at, MXU1_MC_HEVC_MAX, MXU1_MC_HEVC_MAX,
+                         f % 4, f / 4);
+        failed |= !check(HEVC, 0, at, 6, 5, f % 4, f / 4);
+      }
+    }
+  }
+
+  printf("              Mpixel/s: MXU        C  (MXU vs C)\n");
+  for (size_t s = 0; s < sizeof(luma) / sizeof(luma[0]); ++s) {
+    for (int avg = 0; avg < 2; ++avg) {
+      const double m = mpixels(LUMA, 0, avg, luma[s], luma[s], -1, 0, secs);
+      const double c = mpixels(LUMA, 1, avg, luma[s], luma[s], -1, 0, secs);
+      printf("  %s %2dx%-2d %s     %8.1f %8.1f  x%.2f\n", name[LUMA],
+             luma[s], luma[s], avg ? "avg" : "put", m, c, m / c);
+    }
+  }
+  for (size_t s = 0; s < sizeof(chroma) / sizeof(chroma[0]); ++s) {
+    for (int avg = 0; avg < 2; ++avg) {
+      const int w = chroma[s][0], h = chroma[s][1];
+      const double m = mpixels(CHROMA, 0, avg, w, h, -1, 0, secs);
+      const double c = mpixels(CHROMA, 1, avg, w, h, -1, 0, secs);
+      printf("  %s %dx%d %s    %8.1f %8.1f  x%.2f\n", name[CHROMA], w, h,
+             avg ? "avg" : "put", m, c, m / c);
+    }
+  }
+  for (size_t s = 0; s < sizeof(hevc) / sizeof(hevc[0]); ++s) {
+    for (int f = 0; f < 4; ++f) {
+      const int w = hevc[s][0], h = hevc[s][1], fx = f & 1 ? 2 : 0,
+                fy = f & 2 ? 2 : 0;
+      const double m = mpixels(HEVC, 0, 0, w, h, fx, fy, secs);
+      const double c = mpixels(HEVC, 1, 0, w, h, fx, fy, secs);
+      printf("  %s %2dx%-2d %-4s  %8.1f %8.1f  x%.2f\n", name[HEVC], w, h,
+             hevc_at[f], m, c, m / c);
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,275 @@
+// mxu1_mc_pred.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 H.264 and HEVC motion compensation drivers
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Each H.264 luma position is one or two planes of half-pel samples (or
+// the full-pel block itself), at an offset of a pixel or a row, as
+// libavcodec's mcXY functions put them together: one plane is filtered
+// straight into 'dst' (or into a scratch block for avg), two are averaged
+// with mxu1_mc_avg, the second always from a scratch block since src2 must
+// be word aligned. avg then averages the prediction into 'dst' with one
+// more mxu1_mc_avg, which is the same as libavcodec's avg_pixels_l2.
+//
+//  Chroma at (0, 0) is a copy, and HEVC with no fraction in either
+// direction too; everything else is one kernel.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include "mxu1_mc.h"
+
+//  Whether dst and the strides are not what the kernels take
+static int misaligned(const uint8_t *dst, int dst_stride, int src_stride)
+{
+  return (int)(((uintptr_t)dst | (uintptr_t)dst_stride |
+                (uintptr_t)src_stride) & 3);
+}
+
+//  Runs kernel 'k' on one block
+static void run(void (*k)(const mxu1_mc_block *), uint8_t *dst,
+                int dst_stride, const uint8_t *src, int src_stride, int w,
+                int h, const uint8_t *src2, int src2_stride, int16_t *tmp,
+                const uint32_t *coef)
+{
+  mxu1_mc_block b;
+
+  b.dst = dst;
+  b.src = src;
+  b.dst_stride = dst_stride;
+  b.src_stride = src_stride;
+  b.width = w;
+  b.height = h;
+  b.src2 = src2;
+  b.src2_stride = src2_stride;
+  b.tmp = tmp;
+  b.coef = coef;
+  k(&b);
+}
+
+//  dst = the rounded average of a and b (b word aligned); the blocks may
+// be the same
+static void average(uint8_t *dst, int dst_stride, const uint8_t *a,
+                    int a_stride, const uint8_t *b, int b_stride, int w,
+                    int h)
+{
+  run(mxu1_mc_avg, dst, dst_stride, a, a_stride, w, h, b, b_stride, 0, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// H.264 luma
+////////////////////////////////////////////////////////////////////////////////
+
+enum { NONE, FULL, H, V, HV };
+
+//  A position's planes and where each is taken from: 0 the block, 1 a
+// pixel right, 2 a row down
+static const struct {
+  uint8_t a, a_at, b, b_at;
+} position[16] = {
+  { FULL, 0, NONE, 0 },                 // mc00
+  { FULL, 0, H,    0 },                 // mc10
+  { H,    0, NONE, 0 },                 // mc20
+  { FULL, 1, H,    0 },                 // mc30
+  { FULL, 0, V,    0 },                 // mc01
+  { H,    0, V,    0 },                 // mc11
+  { H,    0, HV,   0 },                 // mc21
+  { H,    0, V,    1 },                 // mc31
+  { V,    0, NONE, 0 },                 // mc02
+  { V,    0, HV,   0 },                 // mc12
+  { HV,   0, NONE, 0 },                 // mc22
+  { V,    1, HV,   0 },                 // mc32
+  { FULL, 2, V,    0 },                 // mc03
+  { H,    2, V,    0 },                 // mc13
+  { H,    2, HV,   0 },                 // mc23
+  { H,    2, V,    1 }                  // mc33
+};
+
+//  Plane p of the size x size block at src into dst
+static void plane(int p, uint8_t *dst, int dst_stride, const uint8_t *src,
+                  int stride, int size, int16_t *tmp)
+{
+  static void (*const kernel[])(const mxu1_mc_block *) = {
+    0, mxu1_mc_copy, mxu1_h264_h, mxu1_h264_v, mxu1_h264_hv
+  };
+  run(kernel[p], dst, dst_stride, src, stride, size, size, 0, 0, tmp, 0);
+}
+
+static void h264_qpel(uint8_t *dst, const uint8_t *src, int stride, int size,
+                      int dx, int dy, int avg)
+{
+  uint32_t t0[16 * 16 / 4], t1[16 * 16 / 4], tmp[(16 + 5) * 16 / 2];
+  const int p = dy * 4 + dx, at[3] = { 0, 1, stride };
+  const uint8_t *a = src + at[position[p].a_at];
+  const uint8_t *b = src + at[position[p].b_at];
+  uint8_t *s0 = (uint8_t *)t0, *s1 = (uint8_t *)t1;
+  int16_t *s = (int16_t *)tmp;
+
+  if (position[p].b == NONE) {
+    if (!avg) {
+      plane(position[p].a, dst, stride, a, stride, size, s);
+    } else if (position[p].a == FULL) {
+      average(dst, stride, a, stride, dst, stride, size, size);
+    } else {
+      plane(position[p].a, s0, size, a, stride, size, s);
+      average(dst, stride, s0, size, dst, stride, size, size);
+    }
+    return;
+  }
+  plane(position[p].b, s1, size, b, stride, size, s);
+  if (position[p].a != FULL) {
+    plane(position[p].a, s0, size, a, stride, size, s);
+    a = s0;
+  }
+  if (!avg) {
+    average(dst, stride, a, a == s0 ? size : stride, s1, size, size, size);
+  } else {
+    average(s1, size, a, a == s0 ? size : stride, s1, size, size, size);
+    average(dst, stride, s1, size, dst, stride, size, size);
+  }
+}
+
+void mxu1_h264_qpel_put(uint8_t *dst, const uint8_t *src, int stride,
+                        int size, int dx, int dy)
+{
+  if (misaligned(dst, stride, stride))
+    mxu1_h264_qpel_put_c(dst, src, stride, size, dx, dy);
+  else
+    h264_qpel(dst, src, stride, size, dx, dy, 0);
+}
+
+void mxu1_h264_qpel_avg(uint8_t *dst, const uint8_t *src, int stride,
+                        int size, int dx, int dy)
+{
+  if (misaligned(dst, stride, stride))
+    mxu1_h264_qpel_avg_c(dst, src, stride, size, dx, dy);
+  else
+    h264_qpel(dst, src, stride, size, dx, dy, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// H.264 chroma
+////////////////////////////////////////////////////////////////////////////////
+
+//  A weight in all four bytes of a word
+static uint32_t bytes(int v)
+{
+  return (uint32_t)(uint8_t)v * 0x01010101u;
+}
+
+//  avg goes through a scratch block, 16 rows at a time (4:2:2 chroma's
+// tallest)
+static void h264_chroma(uint8_t *dst, const uint8_t *src, int stride, int w,
+                        int h, int x, int y, int avg)
+{
+  const uint32_t coef[4] = {
+    bytes((8 - x) * (8 - y)), bytes(x * (8 - y)), bytes((8 - x) * y),
+    bytes(x * y)
+  };
+  uint32_t t[8 * 16 / 4];
+
+  if (!x && !y) {
+    if (!avg)
+      run(mxu1_mc_copy, dst, stride, src, stride, w, h, 0, 0, 0, 0);
+    else
+      average(dst, stride, src, stride, dst, stride, w, h);
+    return;
+  }
+  if (!avg) {
+    run(mxu1_h264_chroma, dst, stride, src, stride, w, h, 0, 0, 0, coef);
+    return;
+  }
+  for (int i = 0; i < h; i += 16) {
+    const int n = h - i < 16 ? h - i : 16;
+    run(mxu1_h264_chroma, (uint8_t *)t, w, src + i * stride, stride, w, n, 0,
+        0, 0, coef);
+    average(dst + i * stride, stride, (uint8_t *)t, w, dst + i * stride,
+            stride, w, n);
+  }
+}
+
+void mxu1_h264_chroma_put(uint8_t *dst, const uint8_t *src, int stride,
+                          int w, int h, int x, int y)
+{
+  if (w == 2 || (h & 1) || misaligned(dst, stride, stride))
+    mxu1_h264_chroma_put_c(dst, src, stride, w, h, x, y);
+  else
+    h264_chroma(dst, src, stride, w, h, x, y, 0);
+}
+
+void mxu1_h264_chroma_avg(uint8_t *dst, const uint8_t *src, int stride,
+                          int w, int h, int x, int y)
+{
+  if (w == 2 || (h & 1) || misaligned(dst, stride, stride))
+    mxu1_h264_chroma_avg_c(dst, src, stride, w, h, x, y);
+  else
+    h264_chroma(dst, src, stride, w, h, x, y, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// HEVC luma
+////////////////////////////////////////////////////////////////////////////////
+
+//  Each filter's taps in all four bytes of a word (coef[0 .. 7] for
+// mxu1_hevc_h and _v) and in both halves (the vertical taps, coef[8 .. 15]
+// for mxu1_hevc_hv)
+#define B4(c)   ((uint32_t)(uint8_t)(c) * 0x01010101u)
+#define H2(c)   ((uint32_t)(uint16_t)(c) * 0x00010001u)
+#define TAPS(a, b, c, d, e, f, g, h) \
+  { B4(a), B4(b), B4(c), B4(d), B4(e), B4(f), B4(g), B4(h), \
+    H2(a), H2(b), H2(c), H2(d), H2(e), H2(f), H2(g), H2(h) }
+
+static const uint32_t hevc_taps[3][16] = {
+  TAPS(-1, 4, -10, 58, 17,  -5, 1,  0),
+  TAPS(-1, 4, -11, 40, 40, -11, 4, -1),
+  TAPS( 0, 1,  -5, 17, 58, -10, 4, -1)
+};
+
+void mxu1_hevc_qpel_put(uint8_t *dst, int dst_stride, const uint8_t *src,
+                        int src_stride, int w, int h, int mx, int my)
+{
+  uint32_t tmp[(MXU1_MC_HEVC_MAX + 7) * MXU1_MC_HEVC_MAX / 2], coef[16];
+
+  if (w <= 0 || w > MXU1_MC_HEVC_MAX || (w & 3) || h <= 0 ||
+      h > MXU1_MC_HEVC_MAX || (h & 1) ||
+      misaligned(dst, dst_stride, src_stride)) {
+    mxu1_hevc_qpel_put_c(dst, dst_stride, src, src_stride, w, h, mx, my);
+  } else if (!mx && !my) {
+    run(mxu1_mc_copy, dst, dst_stride, src, src_stride, w, h, 0, 0, 0, 0);
+  } else if (!my) {
+    run(mxu1_hevc_h, dst, dst_stride, src, src_stride, w, h, 0, 0, 0,
+        hevc_taps[mx - 1]);
+  } else if (!mx) {
+    run(mxu1_hevc_v, dst, dst_stride, src, src_stride, w, h, 0, 0, 0,
+        hevc_taps[my - 1]);
+  } else {
+    for (int i = 0; i < 8; ++i) {
+      coef[i] = hevc_taps[mx - 1][i];
+      coef[8 + i] = hevc_taps[my - 1][8 + i];
+    }
+    run(mxu1_hevc_hv, dst, dst_stride, src, src_stride, w, h, 0, 0,
+        (int16_t *)tmp, coef);
+  }
+}
@@ -0,0 +1,254 @@
+// mxu1_mc_ref.c
+//
+// Scalar C reference for the mxu1_mc.s motion compensation kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The definitions of the functions in mxu1_mc.h, which the MXU versions
+// must match exactly: libavcodec's 8-bit C (h264qpel_template.c,
+// h264chroma_template.c and hevcdsp_template.c), with its helpers folded
+// into a few loops that take the block size. Quarter-pel positions are
+// built from half-pel blocks just as libavcodec's mcXY functions build them.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "mxu1_mc.h"
+
+static uint8_t clip_u8(int v)
+{
+  return (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+//  Stores v at *d, or (with 'avg') the rounded average of it and *d
+static void op(uint8_t *d, int v, int avg)
+{
+  *d = (uint8_t)(avg ? (*d + v + 1) >> 1 : v);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// H.264 luma
+////////////////////////////////////////////////////////////////////////////////
+
+#define TAP6(p, s) \
+  (((p)[0] + (p)[s]) * 20 - ((p)[-(s)] + (p)[2 * (s)]) * 5 + \
+   ((p)[-2 * (s)] + (p)[3 * (s)]))
+
+static void h_lowpass(uint8_t *dst, int dst_stride, const uint8_t *src,
+                      int src_stride, int size, int avg)
+{
+  for (int y = 0; y < size; ++y, dst += dst_stride, src += src_stride)
+    for (int x = 0; x < size; ++x)
+      op(&dst[x], clip_u8((TAP6(src + x, 1) + 16) >> 5), avg);
+}
+
+static void v_lowpass(uint8_t *dst, int dst_stride, const uint8_t *src,
+                      int src_stride, int size, int avg)
+{
+  for (int y = 0; y < size; ++y, dst += dst_stride, src += src_stride)
+    for (int x = 0; x < size; ++x)
+      op(&dst[x], clip_u8((TAP6(src + x, src_stride) + 16) >> 5), avg);
+}
+
+static void hv_lowpass(uint8_t *dst, int dst_stride, const uint8_t *src,
+                       int src_stride, int size, int avg)
+{
+  int16_t tmp[(16 + 5) * 16];
+
+  src -= 2 * src_stride;
+  for (int y = 0; y < size + 5; ++y, src += src_stride)
+    for (int x = 0; x < size; ++x)
+      tmp[y * size + x] = (int16_t)TAP6(src + x, 1);
+  for (int y = 0; y < size; ++y, dst += dst_stride)
+    for (int x = 0; x < size; ++x)
+      op(&dst[x], clip_u8((TAP6(tmp + (y + 2) * size + x, size) + 512) >> 10),
+         avg);
+}
+
+//  The rounded average of blocks a and b, put or averaged into dst
+static void pixels_l2(uint8_t *dst, int dst_stride, const uint8_t *a,
+                      int a_stride, const uint8_t *b, int b_stride, int size,
+                      int avg)
+{
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x)
+      op(&dst[x], (a[x] + b[x] + 1) >> 1, avg);
+    dst += dst_stride;
+    a += a_stride;
+    b += b_stride;
+  }
+}
+
+static void h264_qpel(uint8_t *dst, const uint8_t *src, int stride, int size,
+                      int dx, int dy, int avg)
+{
+  uint8_t half_h[16 * 16], half_v[16 * 16], half_hv[16 * 16];
+  const int s = size;
+
+  switch (dy * 4 + dx) {
+    case 0:                                                   // mc00
+      for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+          op(&dst[y * stride + x], src[y * stride + x], avg);
+      break;
+    case 1:                                                   // mc10
+    case 3:                                                   // mc30
+      h_lowpass(half_h, s, src, stride, size, 0);
+      pixels_l2(dst, stride, src + dx / 2, stride, half_h, s, size, avg);
+      break;
+    case 2:                                                   // mc20
+      h_lowpass(dst, stride, src, stride, size, avg);
+      break;
+    case 4:                                                   // mc01
+    case 12:                                                  // mc03
+      v_lowpass(half_v, s, src, stride, size, 0);
+      pixels_l2(dst, stride, src + dy / 2 * stride, stride, half_v, s, size,
+                avg);
+      break;
+    case 8:                                                   // mc02
+      v_lowpass(dst, stride, src, stride, size, avg);
+      break;
+    case 5:                                                   // mc11
+    case 7:                                                   // mc31
+    case 13:                                                  // mc13
+    case 15:                                                  // mc33
+      h_lowpass(half_h, s, src + dy / 2 * stride, stride, size, 0);
+      v_lowpass(half_v, s, src + dx / 2, stride, size, 0);
+      pixels_l2(dst, stride, half_h, s, half_v, s, size, avg);
+      break;
+    case 10:                                                  // mc22
+      hv_lowpass(dst, stride, src, stride, size, avg);
+      break;
+    case 9:                                                   // mc12
+    case 11:                                                  // mc32
+      v_lowpass(half_v, s, src + dx / 2, stride, size, 0);
+      hv_lowpass(half_hv, s, src, stride, size, 0);
+      pixels_l2(dst, stride, half_v, s, half_hv, s, size, avg);
+      break;
+    default:                                                  // mc21, mc23
+      h_lowpass(half_h, s, src + dy / 2 * stride, stride, size, 0);
+      hv_lowpass(half_hv, s, src, stride, size, 0);
+      pixels_l2(dst, stride, half_h, s, half_hv, s, size, avg);
+      break;
+  }
+}
+
+void mxu1_h264_qpel_put_c(uint8_t *dst, const uint8_t *src, int stride,
+                          int size, int dx, int dy)
+{
+  h264_qpel(dst, src, stride, size, dx, dy, 0);
+}
+
+void mxu1_h264_qpel_avg_c(uint8_t *dst, const uint8_t *src, int stride,
+                          int size, int dx, int dy)
+{
+  h264_qpel(dst, src, stride, size, dx, dy, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// H.264 chroma
+////////////////////////////////////////////////////////////////////////////////
+
+static void h264_chroma(uint8_t *dst, const uint8_t *src, int stride, int w,
+                        int h, int x, int y, int avg)
+{
+  const int a = (8 - x) * (8 - y), b = x * (8 - y), c = (8 - x) * y,
+            d = x * y;
+
+  if (d) {
+    for (int i = 0; i < h; ++i, dst += stride, src += stride)
+      for (int j = 0; j < w; ++j)
+        op(&dst[j], (a * src[j] + b * src[j + 1] + c * src[stride + j] +
+                     d * src[stride + j + 1] + 32) >> 6, avg);
+  } else if (b + c) {
+    const int e = b + c, step = c ? stride : 1;
+    for (int i = 0; i < h; ++i, dst += stride, src += stride)
+      for (int j = 0; j < w; ++j)
+        op(&dst[j], (a * src[j] + e * src[step + j] + 32) >> 6, avg);
+  } else {
+    for (int i = 0; i < h; ++i, dst += stride, src += stride)
+      for (int j = 0; j < w; ++j)
+        op(&dst[j], (a * src[j] + 32) >> 6, avg);
+  }
+}
+
+void mxu1_h264_chroma_put_c(uint8_t *dst, const uint8_t *src, int stride,
+                            int w, int h, int x, int y)
+{
+  h264_chroma(dst, src, stride, w, h, x, y, 0);
+}
+
+void mxu1_h264_chroma_avg_c(uint8_t *dst, const uint8_t *src, int stride,
+                            int w, int h, int x, int y)
+{
+  h264_chroma(dst, src, stride, w, h, x, y, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// HEVC luma
+////////////////////////////////////////////////////////////////////////////////
+
+static const int8_t qpel_filters[3][8] = {
+  { -1, 4, -10, 58, 17,  -5, 1,  0 },
+  { -1, 4, -11, 40, 40, -11, 4, -1 },
+  {  0, 1,  -5, 17, 58, -10, 4, -1 }
+};
+
+#define QPEL_FILTER(p, s) \
+  (f[0] * (p)[-3 * (s)] + f[1] * (p)[-2 * (s)] + f[2] * (p)[-(s)] + \
+   f[3] * (p)[0] + f[4] * (p)[s] + f[5] * (p)[2 * (s)] + \
+   f[6] * (p)[3 * (s)] + f[7] * (p)[4 * (s)])
+
+void mxu1_hevc_qpel_put_c(uint8_t *dst, int dst_stride, const uint8_t *src,
+                          int src_stride, int w, int h, int mx, int my)
+{
+  int16_t tmp[(MXU1_MC_HEVC_MAX + 7) * MXU1_MC_HEVC_MAX];
+  const int8_t *f;
+
+  if (!mx && !my) {
+    for (int y = 0; y < h; ++y)
+      memcpy(dst + y * dst_stride, src + y * src_stride, (size_t)w);
+  } else if (!my) {
+    f = qpel_filters[mx - 1];
+    for (int y = 0; y < h; ++y, dst += dst_stride, src += src_stride)
+      for (int x = 0; x < w; ++x)
+        dst[x] = clip_u8((QPEL_FILTER(src + x, 1) + 32) >> 6);
+  } else if (!mx) {
+    f = qpel_filters[my - 1];
+    for (int y = 0; y < h; ++y, dst += dst_stride, src += src_stride)
+      for (int x = 0; x < w; ++x)
+        dst[x] = clip_u8((QPEL_FILTER(src + x, src_stride) + 32) >> 6);
+  } else {
+    f = qpel_filters[mx - 1];
+    src -= 3 * src_stride;
+    for (int y = 0; y < h + 7; ++y, src += src_stride)
+      for (int x = 0; x < w; ++x)
+        tmp[y * w + x] = (int16_t)QPEL_FILTER(src + x, 1);
+    f = qpel_filters[my - 1];
+    for (int y = 0; y < h; ++y, dst += dst_stride)
+      for (int x = 0; x < w; ++x)
+        dst[x] = clip_u8(((QPEL_FILTER(tmp + (y + 3) * w + x, w) >> 6) + 32)
+                         >> 6);
+  }
+}
@@ -0,0 +1,213 @@
+// mxu1_me.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 motion estimation: SAD/SATD and searches
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Block matching for 16x16, 16x8, 8x8 and 4x4 blocks, in C99, with the inner
+// kernels in mxu1_me.s (q8sad for SAD, q8adde + q16add Hadamard for SATD) and a
+// plain C reference for each (the _c functions, in mxu1_me_ref.c), which the
+// MXU versions match exactly.
+//
+// Conventions shared by every function here:
+//   - 'cur' is the block being searched for. It must be word aligned and is
+//     laid out with a stride of MXU1_ME_CUR_STRIDE bytes: copy it out of the
+//     frame once per block (mxu1_me_load_cur()), it is then read from L1.
+//   - 'ref' points at the candidate block in the reference frame, at any
+//     alignment, with a row stride of 'ref_stride' bytes (a multiple of 4).
+//     Each row is read up to 4 bytes past its right edge, so pad frames (or
+//     keep searches) at least 4 bytes clear of the end of the last row.
+//   - Row counts must be positive multiples of 1 (16 wide), 2 (8 wide) or
+//     4 (4 wide).
+//   - The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// The searches (mxu1_me_full(), mxu1_me_diamond(), mxu1_me_hexagon()) take a
+// mxu1_me_params and return the best motion vector, in whole pixels, with its
+// SAD. Each has a _c twin that runs the same search on the C kernels, so the
+// two can be compared result for result.
+//
+// Build (kernels/me, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_me.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_me_ref.c mxu1_me_search.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_ME_H
+#define MXU1_ME_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MXU1_ME_CUR_STRIDE 16
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels (mxu1_me.s)
+////////////////////////////////////////////////////////////////////////////////
+
+//  SAD of a 16, 8 or 4 pixel wide, 'h' row block of cur against 'ref'.
+uint32_t mxu1_sad16(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h);
+uint32_t mxu1_sad8(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h);
+uint32_t mxu1_sad4(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h);
+
+//  SADs of one block of cur against four candidates at once, each ADDED to
+// its sad[] entry, so that a block can be matched in strips of rows (and a
+// search can stop partway through a candidate group, see mxu1_me_full()).
+// Each group of cur rows is loaded into xr registers once and compared with
+// all four candidates while resident.
+void mxu1_sad16_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                   int ref_stride, uint32_t sad[4], int h);
+void mxu1_sad8_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                  int ref_stride, uint32_t sad[4], int h);
+void mxu1_sad4_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                  int ref_stride, uint32_t sad[4], int h);
+
+//  Sum of the 4x4 Hadamard SATDs of 'n' 4x4 blocks side by side (a 4n x 4
+// strip). Each block's SATD is half the sum of the absolute values of its
+// transformed differences, as x264 defines it.
+uint32_t mxu1_satd4x4n(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+                       int n);
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar references (mxu1_me_ref.c), same arguments and results
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t mxu1_sad16_c(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h);
+uint32_t mxu1_sad8_c(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h);
+uint32_t mxu1_sad4_c(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h);
+void mxu1_sad16_x4_c(const uint8_t *cur, const uint8_t *const ref[4],
+                     int ref_stride, uint32_t sad[4], int h);
+void mxu1_sad8_x4_c(const uint8_t *cur, const uint8_t *const ref[4],
+                    int ref_stride, uint32_t sad[4], int h);
+void mxu1_sad4_x4_c(const uint8_t *cur, const uint8_t *const ref[4],
+                    int ref_stride, uint32_t sad[4], int h);
+uint32_t mxu1_satd4x4n_c(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+                         int n);
+
+////////////////////////////////////////////////////////////////////////////////
+// Fixed-size wrappers
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t mxu1_sad_16x16(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_sad16(cur, ref, ref_stride, 16); }
+static inline uint32_t mxu1_sad_16x8(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_sad16(cur, ref, ref_stride, 8); }
+static inline uint32_t mxu1_sad_8x8(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_sad8(cur, ref, ref_stride, 8); }
+static inline uint32_t mxu1_sad_4x4(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_sad4(cur, ref, ref_stride, 4); }
+
+static inline void mxu1_sad_16x16_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                                     int ref_stride, uint32_t sad[4])
+{ sad[0] = sad[1] = sad[2] = sad[3] = 0; mxu1_sad16_x4(cur, ref, ref_stride, sad, 16); }
+static inline void mxu1_sad_16x8_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                                    int ref_stride, uint32_t sad[4])
+{ sad[0] = sad[1] = sad[2] = sad[3] = 0; mxu1_sad16_x4(cur, ref, ref_stride, sad, 8); }
+static inline void mxu1_sad_8x8_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                                   int ref_stride, uint32_t sad[4])
+{ sad[0] = sad[1] = sad[2] = sad[3] = 0; mxu1_sad8_x4(cur, ref, ref_stride, sad, 8); }
+static inline void mxu1_sad_4x4_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                                   int ref_stride, uint32_t sad[4])
+{ sad[0] = sad[1] = sad[2] = sad[3] = 0; mxu1_sad4_x4(cur, ref, ref_stride, sad, 4); }
+
+//  SATD of a w x h block, w and h multiples of 4, as a sum over 4x4 blocks.
+static inline uint32_t mxu1_satd(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+                                 int w, int h)
+{
+  uint32_t sum = 0;
+  for (int y = 0; y < h; y += 4)
+    sum += mxu1_satd4x4n(cur + y * MXU1_ME_CUR_STRIDE, ref + y * ref_stride,
+                         ref_stride, w / 4);
+  return sum;
+}
+
+static inline uint32_t mxu1_satd_16x16(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_satd(cur, ref, ref_stride, 16, 16); }
+static inline uint32_t mxu1_satd_16x8(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_satd(cur, ref, ref_stride, 16, 8); }
+static inline uint32_t mxu1_satd_8x8(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_satd(cur, ref, ref_stride, 8, 8); }
+static inline uint32_t mxu1_satd_4x4(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{ return mxu1_satd4x4n(cur, ref, ref_stride, 1); }
+
+////////////////////////////////////////////////////////////////////////////////
+// Searches (mxu1_me_search.c)
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum {
+  MXU1_ME_16x16,
+  MXU1_ME_16x8,
+  MXU1_ME_8x8,
+  MXU1_ME_4x4
+} mxu1_me_size;
+
+typedef struct {
+  int x, y;
+} mxu1_mv;
+
+typedef struct {
+  const uint8_t *cur;       // Block to match, MXU1_ME_CUR_STRIDE layout
+  const uint8_t *ref;       // Reference frame at the block's own position
+  int            ref_stride;
+  mxu1_me_size   size;
+  mxu1_mv        min, max;  // Search window, inclusive, relative to 'ref'
+  mxu1_mv        start;     // Evaluated first (the predicted vector, say)
+  uint32_t       good_enough; // Stop at the first SAD <= this (0: exact only)
+  int            max_iter;  // Step limit for diamond and hexagon, 0: none
+} mxu1_me_params;
+
+typedef struct {
+  mxu1_mv  mv;
+  uint32_t sad;
+  uint32_t positions;       // Candidate positions evaluated (fully or not)
+} mxu1_me_result;
+
+//  Copy a block out of a frame into the MXU1_ME_CUR_STRIDE layout. 'dst' must
+// be word aligned and hold 16 * h bytes.
+void mxu1_me_load_cur(uint8_t *dst, const uint8_t *src, int src_stride,
+                      mxu1_me_size size);
+
+//  Exhaustive search of the window. Candidates are matched four at a time, in
+// strips of 4 rows, and a group is abandoned as soon as all four partial SADs
+// reach the best SAD found so far (partial distortion elimination).
+mxu1_me_result mxu1_me_full(const mxu1_me_params *p);
+
+//  Small diamond: move to the best of the 4 neighbours until the centre wins.
+mxu1_me_result mxu1_me_diamond(const mxu1_me_params *p);
+
+//  Hexagon (radius 2, 6 points, 3 new per step) followed by one small diamond
+// refinement, as in x264's "hex" method.
+mxu1_me_result mxu1_me_hexagon(const mxu1_me_params *p);
+
+mxu1_me_result mxu1_me_full_c(const mxu1_me_params *p);
+mxu1_me_result mxu1_me_diamond_c(const mxu1_me_params *p);
+mxu1_me_result mxu1_me_hexagon_c(const mxu1_me_params *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_ME_H
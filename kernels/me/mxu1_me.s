@@ -0,0 +1,407 @@
+# mxu1_me.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 block-matching kernels (SAD, SATD)
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, calling conventions and alignment rules are in mxu1_me.h.
+# In short: 'cur' is the block being matched, word aligned, with a stride of
+# MXU1_ME_CUR_STRIDE (16) bytes; 'ref' may have any alignment, and the row of
+# each reference block is read up to 4 bytes past its right edge.
+#
+#  Unaligned reference rows are read as aligned words and put back together
+# with s32aln: with k = ref & 3 and the two words w0, w1 around a pixel group,
+# 's32aln x, w1, w0, 4-k' is (w1 << 8*(4-k)) | (w0 >> 8*k), the little-endian
+# word at ref (and just w0 when k = 0).
+#
+#  The _x4 kernels match one block against four candidate positions at once.
+# Each group of cur rows is loaded into xr1..xr4 a single time and then stays
+# there while it is compared with all four candidates, so cur is read once per
+# four positions instead of once per position. The group is one row of 16
+# pixels, two rows of 8 or four rows of 4: exactly four words, leaving xr5..xr8
+# for the four SAD accumulators and xr9..xr15 for reference words.
+#
+# Register use: any xr, and $v0, $v1, $t0..$t9 and $a0..$a3. Leaf functions.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+
+# SAD of cur row xr1..xr4 (16 pixels) with the ref row at \p (aligned down,
+#  realigned by \sh = 4 - (ref & 3)), added into \acc
+.macro ME_ROW16 p, sh, acc
+  s32ldd  xr9,  \p, 0
+  s32ldd  xr10, \p, 4
+  s32ldd  xr11, \p, 8
+  s32aln  xr14, xr10, xr9,  \sh
+  s32ldd  xr12, \p, 12
+  s32aln  xr15, xr11, xr10, \sh
+  q8sad   xr0,  xr1,  xr14, \acc
+  s32ldd  xr13, \p, 16
+  s32aln  xr14, xr12, xr11, \sh
+  q8sad   xr0,  xr2,  xr15, \acc
+  s32aln  xr15, xr13, xr12, \sh
+  q8sad   xr0,  xr3,  xr14, \acc
+  q8sad   xr0,  xr4,  xr15, \acc
+.endm
+
+# Same for two 8-pixel rows: cur xr1,xr2 and xr3,xr4, ref rows \p, \p+$a2
+.macro ME_ROWS8 p, sh, acc
+  addu    $t8,  \p,   $a2
+  s32ldd  xr9,  \p, 0
+  s32ldd  xr10, \p, 4
+  s32ldd  xr11, \p, 8
+  s32ldd  xr12, $t8, 0
+  s32aln  xr14, xr10, xr9,  \sh
+  s32ldd  xr13, $t8, 4
+  s32aln  xr15, xr11, xr10, \sh
+  q8sad   xr0,  xr1,  xr14, \acc
+  s32ldd  xr9,  $t8, 8
+  s32aln  xr14, xr13, xr12, \sh
+  q8sad   xr0,  xr2,  xr15, \acc
+  s32aln  xr15, xr9,  xr13, \sh
+  q8sad   xr0,  xr3,  xr14, \acc
+  q8sad   xr0,  xr4,  xr15, \acc
+.endm
+
+# Same for four 4-pixel rows: cur xr1..xr4, ref rows \p + 0..3 * $a2
+.macro ME_ROWS4 p, sh, acc
+  addu    $t8,  \p,   $a2
+  s32ldd  xr9,  \p, 0
+  s32ldd  xr10, \p, 4
+  s32ldd  xr11, $t8, 0
+  s32ldd  xr12, $t8, 4
+  addu    $t8,  $t8,  $a2
+  s32aln  xr14, xr10, xr9,  \sh
+  s32ldd  xr13, $t8, 0
+  s32aln  xr15, xr12, xr11, \sh
+  q8sad   xr0,  xr1,  xr14, \acc
+  s32ldd  xr9,  $t8, 4
+  addu    $t8,  $t8,  $a2
+  q8sad   xr0,  xr2,  xr15, \acc
+  s32ldd  xr10, $t8, 0
+  s32ldd  xr11, $t8, 4
+  s32aln  xr14, xr9,  xr13, \sh
+  q8sad   xr0,  xr3,  xr14, \acc
+  s32aln  xr15, xr11, xr10, \sh
+  q8sad   xr0,  xr4,  xr15, \acc
+.endm
+
+# Split \p into its aligned address and the s32aln amount \sh; $v1 must be 4
+.macro ME_ALIGN p, sh
+  andi    $v0,  \p,   3
+  subu    \p,   \p,   $v0
+  subu    \sh,  $v1,  $v0
+.endm
+
+# Prologue of the _x4 kernels: candidate pointers into $t0..$t3, their
+#  s32aln amounts into $t4..$t7, row count into $t9 and the four running
+#  sums into xr5..xr8
+.macro ME_X4_ENTER
+  lw      $t0,  0($a1)
+  lw      $t1,  4($a1)
+  lw      $t2,  8($a1)
+  lw      $t3,  12($a1)
+  lw      $t9,  16($sp)
+  li      $v1,  4
+  ME_ALIGN $t0, $t4
+  ME_ALIGN $t1, $t5
+  ME_ALIGN $t2, $t6
+  ME_ALIGN $t3, $t7
+  s32ldd  xr5,  $a3, 0
+  s32ldd  xr6,  $a3, 4
+  s32ldd  xr7,  $a3, 8
+  s32ldd  xr8,  $a3, 12
+.endm
+
+.macro ME_X4_LEAVE
+  s32std  xr5,  $a3, 0
+  s32std  xr6,  $a3, 4
+  s32std  xr7,  $a3, 8
+  jr      $ra
+  s32std  xr8,  $a3, 12
+.endm
+
+
+################################################################################
+# void mxu1_sad16_x4(const uint8_t *cur, const uint8_t *const ref[4],
+#                    int ref_stride, uint32_t sad[4], int h)
+  .globl  mxu1_sad16_x4
+  .type   mxu1_sad16_x4, @function
+  .ent    mxu1_sad16_x4
+mxu1_sad16_x4:
+  ME_X4_ENTER
+1:
+  s32ldd  xr1,  $a0, 0
+  s32ldd  xr2,  $a0, 4
+  s32ldd  xr3,  $a0, 8
+  s32ldd  xr4,  $a0, 12
+  ME_ROW16 $t0, $t4, xr5
+  ME_ROW16 $t1, $t5, xr6
+  ME_ROW16 $t2, $t6, xr7
+  ME_ROW16 $t3, $t7, xr8
+  addiu   $t9,  $t9,  -1
+  addu    $t0,  $t0,  $a2
+  addu    $t1,  $t1,  $a2
+  addu    $t2,  $t2,  $a2
+  addiu   $a0,  $a0,  16
+  bnez    $t9,  1b
+  addu    $t3,  $t3,  $a2
+  ME_X4_LEAVE
+  .end    mxu1_sad16_x4
+  .size   mxu1_sad16_x4, .-mxu1_sad16_x4
+
+
+################################################################################
+# void mxu1_sad8_x4(const uint8_t *cur, const uint8_t *const ref[4],
+#                   int ref_stride, uint32_t sad[4], int h)
+  .globl  mxu1_sad8_x4
+  .type   mxu1_sad8_x4, @function
+  .ent    mxu1_sad8_x4
+mxu1_sad8_x4:
+  ME_X4_ENTER
+  sll     $a1,  $a2,  1
+1:
+  s32ldd  xr1,  $a0, 0
+  s32ldd  xr2,  $a0, 4
+  s32ldd  xr3,  $a0, 16
+  s32ldd  xr4,  $a0, 20
+  ME_ROWS8 $t0, $t4, xr5
+  ME_ROWS8 $t1, $t5, xr6
+  ME_ROWS8 $t2, $t6, xr7
+  ME_ROWS8 $t3, $t7, xr8
+  addiu   $t9,  $t9,  -2
+  addu    $t0,  $t0,  $a1
+  addu    $t1,  $t1,  $a1
+  addu    $t2,  $t2,  $a1
+  addiu   $a0,  $a0,  32
+  bnez    $t9,  1b
+  addu    $t3,  $t3,  $a1
+  ME_X4_LEAVE
+  .end    mxu1_sad8_x4
+  .size   mxu1_sad8_x4, .-mxu1_sad8_x4
+
+
+################################################################################
+# void mxu1_sad4_x4(const uint8_t *cur, const uint8_t *const ref[4],
+#                   int ref_stride, uint32_t sad[4], int h)
+  .globl  mxu1_sad4_x4
+  .type   mxu1_sad4_x4, @function
+  .ent    mxu1_sad4_x4
+mxu1_sad4_x4:
+  ME_X4_ENTER
+  sll     $a1,  $a2,  2
+1:
+  s32ldd  xr1,  $a0, 0
+  s32ldd  xr2,  $a0, 16
+  s32ldd  xr3,  $a0, 32
+  s32ldd  xr4,  $a0, 48
+  ME_ROWS4 $t0, $t4, xr5
+  ME_ROWS4 $t1, $t5, xr6
+  ME_ROWS4 $t2, $t6, xr7
+  ME_ROWS4 $t3, $t7, xr8
+  addiu   $t9,  $t9,  -4
+  addu    $t0,  $t0,  $a1
+  addu    $t1,  $t1,  $a1
+  addu    $t2,  $t2,  $a1
+  addiu   $a0,  $a0,  64
+  bnez    $t9,  1b
+  addu    $t3,  $t3,  $a1
+  ME_X4_LEAVE
+  .end    mxu1_sad4_x4
+  .size   mxu1_sad4_x4, .-mxu1_sad4_x4
+
+
+################################################################################
+# uint32_t mxu1_sad16(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+#                     int h)
+  .globl  mxu1_sad16
+  .type   mxu1_sad16, @function
+  .ent    mxu1_sad16
+mxu1_sad16:
+  li      $v1,  4
+  ME_ALIGN $a1, $t4
+  s32i2m  xr5,  $zero
+1:
+  s32ldd  xr1,  $a0, 0
+  s32ldd  xr2,  $a0, 4
+  s32ldd  xr3,  $a0, 8
+  s32ldd  xr4,  $a0, 12
+  ME_ROW16 $a1, $t4, xr5
+  addiu   $a3,  $a3,  -1
+  addu    $a1,  $a1,  $a2
+  bnez    $a3,  1b
+  addiu   $a0,  $a0,  16
+  jr      $ra
+  s32m2i  xr5,  $v0
+  .end    mxu1_sad16
+  .size   mxu1_sad16, .-mxu1_sad16
+
+
+################################################################################
+# uint32_t mxu1_sad8(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+#                    int h)
+  .globl  mxu1_sad8
+  .type   mxu1_sad8, @function
+  .ent    mxu1_sad8
+mxu1_sad8:
+  li      $v1,  4
+  ME_ALIGN $a1, $t4
+  sll     $t5,  $a2,  1
+  s32i2m  xr5,  $zero
+1:
+  s32ldd  xr1,  $a0, 0
+  s32ldd  xr2,  $a0, 4
+  s32ldd  xr3,  $a0, 16
+  s32ldd  xr4,  $a0, 20
+  ME_ROWS8 $a1, $t4, xr5
+  addiu   $a3,  $a3,  -2
+  addu    $a1,  $a1,  $t5
+  bnez    $a3,  1b
+  addiu   $a0,  $a0,  32
+  jr      $ra
+  s32m2i  xr5,  $v0
+  .end    mxu1_sad8
+  .size   mxu1_sad8, .-mxu1_sad8
+
+
+################################################################################
+# uint32_t mxu1_sad4(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+#                    int h)
+  .globl  mxu1_sad4
+  .type   mxu1_sad4, @function
+  .ent    mxu1_sad4
+mxu1_sad4:
+  li      $v1,  4
+  ME_ALIGN $a1, $t4
+  sll     $t5,  $a2,  2
+  s32i2m  xr5,  $zero
+1:
+  s32ldd  xr1,  $a0, 0
+  s32ldd  xr2,  $a0, 16
+  s32ldd  xr3,  $a0, 32
+  s32ldd  xr4,  $a0, 48
+  ME_ROWS4 $a1, $t4, xr5
+  addiu   $a3,  $a3,  -4
+  addu    $a1,  $a1,  $t5
+  bnez    $a3,  1b
+  addiu   $a0,  $a0,  64
+  jr      $ra
+  s32m2i  xr5,  $v0
+  .end    mxu1_sad4
+  .size   mxu1_sad4, .-mxu1_sad4
+
+
+################################################################################
+# uint32_t mxu1_satd4x4n(const uint8_t *cur, const uint8_t *ref,
+#                        int ref_stride, int n)
+#
+#  Sum of the SATDs of n 4x4 blocks side by side. For each, the differences
+# are widened to 16 bits by q8adde, row r into xr(2r+1) = columns 3,2 and
+# xr(2r+2) = columns 1,0. The vertical 4-point Hadamard transform is then
+# two rounds of q16add butterflies between rows, and the first horizontal
+# round a butterfly between each row's two registers. The last horizontal
+# round is never computed: since |x+y| + |x-y| = 2*max(|x|,|y|), and SATD is
+# half the sum of the absolute transform coefficients, it is enough to sum
+# max(|x|,|y|) over those last pairs. s32sfl brings the two halves of each
+# pair into the same lane of two registers, for d16max.
+  .globl  mxu1_satd4x4n
+  .type   mxu1_satd4x4n, @function
+  .ent    mxu1_satd4x4n
+mxu1_satd4x4n:
+  li      $t9,  4
+  s32i2m  xr13, $zero
+  s32i2m  xr14, $zero
+1:
+  andi    $v0,  $a1,  3
+  subu    $t0,  $a1,  $v0
+  subu    $t4,  $t9,  $v0
+  addu    $t1,  $t0,  $a2
+  s32ldd  xr10, $t0, 0
+  s32ldd  xr11, $t0, 4
+  addu    $t2,  $t1,  $a2
+  s32ldd  xr9,  $a0, 0
+  s32ldd  xr12, $t1, 0
+  s32aln  xr10, xr11, xr10, $t4
+  s32ldd  xr15, $t1, 4
+  q8adde  xr1,  xr9,  xr10, xr2,  SS
+  s32ldd  xr9,  $a0, 16
+  s32aln  xr12, xr15, xr12, $t4
+  addu    $t3,  $t2,  $a2
+  s32ldd  xr10, $t2, 0
+  s32ldd  xr11, $t2, 4
+  q8adde  xr3,  xr9,  xr12, xr4,  SS
+  s32ldd  xr9,  $a0, 32
+  s32aln  xr10, xr11, xr10, $t4
+  s32ldd  xr12, $t3, 0
+  s32ldd  xr15, $t3, 4
+  q8adde  xr5,  xr9,  xr10, xr6,  SS
+  s32ldd  xr9,  $a0, 48
+  q16add  xr1,  xr1,  xr3,  xr3,  AS, WW    # Vertical, rows 0,1
+  s32aln  xr12, xr15, xr12, $t4
+  q16add  xr2,  xr2,  xr4,  xr4,  AS, WW
+  q8adde  xr7,  xr9,  xr12, xr8,  SS
+  q16add  xr5,  xr5,  xr7,  xr7,  AS, WW    # Vertical, rows 2,3
+  q16add  xr6,  xr6,  xr8,  xr8,  AS, WW
+  q16add  xr1,  xr1,  xr5,  xr5,  AS, WW    # Vertical, second round
+  q16add  xr2,  xr2,  xr6,  xr6,  AS, WW
+  q16add  xr3,  xr3,  xr7,  xr7,  AS, WW
+  q16add  xr4,  xr4,  xr8,  xr8,  AS, WW
+  q16add  xr1,  xr1,  xr2,  xr2,  AS, WW    # Horizontal, first round
+  q16add  xr3,  xr3,  xr4,  xr4,  AS, WW
+  q16add  xr5,  xr5,  xr6,  xr6,  AS, WW
+  q16add  xr7,  xr7,  xr8,  xr8,  AS, WW
+  s32sfl  xr1,  xr1,  xr3,  xr3,  ptn3      # Pair up rows 0,1 and 2,3
+  s32sfl  xr2,  xr2,  xr4,  xr4,  ptn3
+  s32sfl  xr5,  xr5,  xr7,  xr7,  ptn3
+  s32sfl  xr6,  xr6,  xr8,  xr8,  ptn3
+  d16cps  xr1,  xr1,  xr1                   # abs()
+  d16cps  xr3,  xr3,  xr3
+  d16cps  xr2,  xr2,  xr2
+  d16cps  xr4,  xr4,  xr4
+  d16max  xr1,  xr1,  xr3
+  d16cps  xr5,  xr5,  xr5
+  d16cps  xr7,  xr7,  xr7
+  d16max  xr2,  xr2,  xr4
+  d16cps  xr6,  xr6,  xr6
+  d16cps  xr8,  xr8,  xr8
+  d16max  xr5,  xr5,  xr7
+  d16max  xr6,  xr6,  xr8
+  d16asum xr13, xr1,  xr2,  xr14, AA
+  addiu   $a3,  $a3,  -1
+  addiu   $a0,  $a0,  4
+  d16asum xr13, xr5,  xr6,  xr14, AA
+  bnez    $a3,  1b
+  addiu   $a1,  $a1,  4
+  d32add  xr13, xr13, xr14, xr0,  AA
+  jr      $ra
+  s32m2i  xr13, $v0
+  .end    mxu1_satd4x4n
+  .size   mxu1_satd4x4n, .-mxu1_satd4x4n
+
+# vim:shiftwidth=2:expandtab:syntax=asm
@@ -0,0 +1,240 @@
+// mxu1_me_bench.c
+//
+// Positions/s benchmark and cross-check of the MXU1 motion estimation kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Runs every search on every block size over a synthetic frame pair (a
+// textured frame and a shifted, noisy copy of it), once with the MXU kernels
+// and once with the C references, checks that both return the same vector,
+// SAD and position count for every block, and prints candidate positions per
+// second for each. Then times the SAD and SATD kernels alone.
+//
+// Build and run on the target (kernels/me):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_me_bench
+//         mxu1_me_bench.c mxu1_me_search.c mxu1_me_ref.c mxu1_me.s
+//         ../dispatch/mxu1_cpu.c
+//     ./mxu1_me_bench [seconds per test, default 1]
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_me.h"
+#include "../dispatch/mxu1_cpu.h"
+
+#define W      320
+#define H      240
+#define STRIDE (W + 64)         // 32 pixels of border each side
+#define RANGE  16
+
+static uint8_t frame0[(H + 64) * STRIDE];
+static uint8_t frame1[(H + 64) * STRIDE];
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void make_frames(void)
+{
+  srand(1);
+  for (int y = 0; y < H + 64; ++y)
+    for (int x = 0; x < STRIDE; ++x)
+      frame0[y * STRIDE + x] = (uint8_t)((x * 7 + y * 3) ^ (x * y >> 4)) + (rand() & 15);
+
+  // frame1 is frame0 moved by (3, -2), plus noise
+  for (int y = 0; y < H + 64; ++y)
+    for (int x = 0; x < STRIDE; ++x) {
+      int sx = x + 3, sy = y - 2;
+      sx = sx < 0 ? 0 : sx >= STRIDE ? STRIDE - 1 : sx;
+      sy = sy < 0 ? 0 : sy >= H + 64 ? H + 63 : sy;
+      frame1[y * STRIDE + x] = frame0[sy * STRIDE + sx] ^ (rand() & 3);
+    }
+}
+
+typedef mxu1_me_result (*search_fn)(const mxu1_me_params *p);
+
+// One pass of 'search' over every block of frame1; returns positions visited
+static unsigned long search_frame(search_fn search, mxu1_me_size size,
+                                  mxu1_me_result *results)
+{
+  static uint8_t cur[16 * 16] __attribute__((aligned(4)));
+  int bw = size <= MXU1_ME_16x8 ? 16 : size == MXU1_ME_8x8 ? 8 : 4;
+  int bh = size == MXU1_ME_16x16 ? 16 : size == MXU1_ME_4x4 ? 4 : 8;
+  unsigned long positions = 0;
+  mxu1_me_params p;
+
+  memset(&p, 0, sizeof(p));
+  p.cur        = cur;
+  p.ref_stride = STRIDE;
+  p.size       = size;
+  p.min.x      = p.min.y = -RANGE;
+  p.max.x      = p.max.y = RANGE;
+
+  for (int by = 32; by + bh <= H + 32; by += bh)
+    for (int bx = 32; bx + bw <= W + 32; bx += bw) {
+      mxu1_me_result r;
+      mxu1_me_load_cur(cur, frame1 + by * STRIDE + bx, STRIDE, size);
+      p.ref = frame0 + by * STRIDE + bx;
+      r = search(&p);
+      positions += r.positions;
+      if (results)
+        *results++ = r;
+    }
+  return positions;
+}
+
+static int cross_check(search_fn mxu, search_fn c, mxu1_me_size size)
+{
+  static mxu1_me_result a[(W / 4) * (H / 4)], b[(W / 4) * (H / 4)];
+  unsigned long n = 0;
+
+  search_frame(mxu, size, a);
+  search_frame(c, size, b);
+  for (int i = 0; i < (W / 4) * (H / 4); ++i)
+    n += memcmp(&a[i], &b[i], sizeof(a[i])) != 0;
+  return n == 0;
+}
+
+static double positions_per_s(search_fn search, mxu1_me_size size, double secs)
+{
+  unsigned long positions = 0;
+  double t0 = now(), t;
+
+  do {
+    positions += search_frame(search, size, NULL);
+    t = now() - t0;
+  } while (t < secs);
+  return positions / t;
+}
+
+static double calls_per_s(uint32_t (*f)(const uint8_t *, const uint8_t *, int),
+                          double secs)
+{
+  static uint8_t cur[16 * 16] __attribute__((aligned(4)));
+  volatile uint32_t sink = 0;
+  unsigned long calls = 0;
+  double t0 = now(), t;
+
+  mxu1_me_load_cur(cur, frame1 + 32 * STRIDE + 32, STRIDE, MXU1_ME_16x16);
+  do {
+    for (int i = 0; i < 1024; ++i)
+      sink += f(cur, frame0 + 32 * STRIDE + 32 + (i & 31), STRIDE);
+    calls += 1024;
+    t = now() - t0;
+  } while (t < secs);
+  (void)sink;
+  return calls / t;
+}
+
+// C reference, for calls_per_s()
+static uint32_t sad_16x16_c(const uint8_t *c, const uint8_t *r, int s) { return mxu1_sad16_c(c, r, s, 16); }
+static uint32_t sad_8x8_c(const uint8_t *c, const uint8_t *r, int s)   { return mxu1_sad8_c(c, r, s, 8); }
+static uint32_t sad_4x4_c(const uint8_t *c, const uint8_t *r, int s)   { return mxu1_sad4_c(c, r, s, 4); }
+static uint32_t satd_16x16_c(const uint8_t *c, const uint8_t *r, int s)
+{
+  uint32_t sum = 0;
+  for (int y = 0; y < 16; y += 4)
+    sum += mxu1_satd4x4n_c(c + y * MXU1_ME_CUR_STRIDE, r + y * s, s, 4);
+  return sum;
+}
+static uint32_t satd_4x4_c(const uint8_t *c, const uint8_t *r, int s)  { return mxu1_satd4x4n_c(c, r, s, 1); }
+
+// The inline wrappers need an address
+static uint32_t sad_16x16(const uint8_t *c, const uint8_t *r, int s)   { return mxu1_sad_16x16(c, r, s); }
+static uint32_t sad_8x8(const uint8_t *c, const uint8_t *r, int s)     { return mxu1_sad_8x8(c, r, s); }
+static uint32_t sad_4x4(const uint8_t *c, const uint8_t *r, int s)     { return mxu1_sad_4x4(c, r, s); }
+static uint32_t satd_16x16(const uint8_t *c, const uint8_t *r, int s)  { return mxu1_satd_16x16(c, r, s); }
+static uint32_t satd_4x4(const uint8_t *c, const uint8_t *r, int s)    { return mxu1_satd_4x4(c, r, s); }
+
+int main(int argc, char **argv)
+{
+  static const char *size_names[] = { "16x16", "16x8", "8x8", "4x4" };
+  static const struct {
+    const char *name;
+    search_fn   mxu, c;
+  } searches[] = {
+    { "full",    mxu1_me_full,    mxu1_me_full_c    },
+    { "diamond", mxu1_me_diamond, mxu1_me_diamond_c },
+    { "hexagon", mxu1_me_hexagon, mxu1_me_hexagon_c },
+  };
+  static const struct {
+    const char *name;
+    uint32_t  (*mxu)(const uint8_t *, const uint8_t *, int);
+    uint32_t  (*c)(const uint8_t *, const uint8_t *, int);
+  } kernels[] = {
+    { "sad 16x16",  sad_16x16,  sad_16x16_c  },
+    { "sad 8x8",    sad_8x8,    sad_8x8_c    },
+    { "sad 4x4",    sad_4x4,    sad_4x4_c    },
+    { "satd 16x16", satd_16x16, satd_16x16_c },
+    { "satd 4x4",   satd_4x4,   satd_4x4_c   },
+  };
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  int failed = 0;
+
+  mxu1_cpu_enable();
+  make_frames();
+
+  printf("%dx%d frame, +-%d search, positions/s (MXU vs C):\n", W, H, RANGE);
+  for (unsigned s = 0; s < sizeof(searches) / sizeof(searches[0]); ++s) {
+    for (int size = MXU1_ME_16x16; size <= MXU1_ME_4x4; ++size) {
+      double m, c;
+      if (!cross_check(searches[s].mxu, searches[s].c, size)) {
+        printf("  %-8s %-6s MISMATCH between MXU and C results\n",
+               searches[s].name, size_names[size]);
+        failed = 1;
+        continue;
+      }
+      m = positions_per_s(searches[s].mxu, size, secs);
+      c = positions_per_s(searches[s].c, size, secs);
+      printf("  %-8s %-6s %12.0f %12.0f  x%.2f\n",
+             searches[s].name, size_names[size], m, c, m / c);
+    }
+  }
+
+  printf("kernel calls/s (MXU vs C):\n");
+  for (unsigned k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+    double m, c;
+    for (int i = 0; i < 32; ++i) {
+      const uint8_t *cur = frame1 + 32 * STRIDE + 32, *ref = frame0 + 32 * STRIDE + 32 + i;
+      static uint8_t blk[16 * 16] __attribute__((aligned(4)));
+      mxu1_me_load_cur(blk, cur, STRIDE, MXU1_ME_16x16);
+      if (kernels[k].mxu(blk, ref, STRIDE) != kernels[k].c(blk, ref, STRIDE)) {
+        printf("  %-10s MISMATCH at offset %d\n", kernels[k].name, i);
+        failed = 1;
+        break;
+      }
+    }
+    m = calls_per_s(kernels[k].mxu, secs);
+    c = calls_per_s(kernels[k].c, secs);
+    printf("  %-10s %12.0f %12.0f  x%.2f\n", kernels[k].name, m, c, m / c);
+  }
+
+  return failed;
+}
@@ -0,0 +1,110 @@
+// mxu1_me_ref.c
+//
+// Scalar C reference for the mxu1_me.s block-matching kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Straightforward C versions of the kernels in mxu1_me.s, with identical
+// arguments and results. They are the specification the MXU code is tested
+// against, and the fallback on CPUs without MXU.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include "mxu1_me.h"
+
+static uint32_t sad_wxh(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+                        int w, int h)
+{
+  uint32_t sum = 0;
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x)
+      sum += abs(cur[x] - ref[x]);
+    cur += MXU1_ME_CUR_STRIDE;
+    ref += ref_stride;
+  }
+  return sum;
+}
+
+uint32_t mxu1_sad16_c(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h)
+{ return sad_wxh(cur, ref, ref_stride, 16, h); }
+uint32_t mxu1_sad8_c(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h)
+{ return sad_wxh(cur, ref, ref_stride, 8, h); }
+uint32_t mxu1_sad4_c(const uint8_t *cur, const uint8_t *ref, int ref_stride, int h)
+{ return sad_wxh(cur, ref, ref_stride, 4, h); }
+
+static void sad_x4(const uint8_t *cur, const uint8_t *const ref[4],
+                   int ref_stride, uint32_t sad[4], int w, int h)
+{
+  for (int i = 0; i < 4; ++i)
+    sad[i] += sad_wxh(cur, ref[i], ref_stride, w, h);
+}
+
+void mxu1_sad16_x4_c(const uint8_t *cur, const uint8_t *const ref[4],
+                     int ref_stride, uint32_t sad[4], int h)
+{ sad_x4(cur, ref, ref_stride, sad, 16, h); }
+void mxu1_sad8_x4_c(const uint8_t *cur, const uint8_t *const ref[4],
+                    int ref_stride, uint32_t sad[4], int h)
+{ sad_x4(cur, ref, ref_stride, sad, 8, h); }
+void mxu1_sad4_x4_c(const uint8_t *cur, const uint8_t *const ref[4],
+                    int ref_stride, uint32_t sad[4], int h)
+{ sad_x4(cur, ref, ref_stride, sad, 4, h); }
+
+static uint32_t satd4x4(const uint8_t *cur, const uint8_t *ref, int ref_stride)
+{
+  int d[4][4], t[4][4];
+  uint32_t sum = 0;
+
+  for (int y = 0; y < 4; ++y)
+    for (int x = 0; x < 4; ++x)
+      d[y][x] = cur[y * MXU1_ME_CUR_STRIDE + x] - ref[y * ref_stride + x];
+
+  for (int y = 0; y < 4; ++y) {
+    int s01 = d[y][0] + d[y][1], d01 = d[y][0] - d[y][1];
+    int s23 = d[y][2] + d[y][3], d23 = d[y][2] - d[y][3];
+    t[y][0] = s01 + s23;
+    t[y][1] = d01 + d23;
+    t[y][2] = s01 - s23;
+    t[y][3] = d01 - d23;
+  }
+
+  for (int x = 0; x < 4; ++x) {
+    int s01 = t[0][x] + t[1][x], d01 = t[0][x] - t[1][x];
+    int s23 = t[2][x] + t[3][x], d23 = t[2][x] - t[3][x];
+    sum += abs(s01 + s23) + abs(d01 + d23) + abs(s01 - s23) + abs(d01 - d23);
+  }
+
+  // Every coefficient has the parity of the sum of all 16 differences, so
+  //  the total is even and halving it is exact
+  return sum / 2;
+}
+
+uint32_t mxu1_satd4x4n_c(const uint8_t *cur, const uint8_t *ref, int ref_stride,
+                         int n)
+{
+  uint32_t sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += satd4x4(cur + 4 * i, ref + 4 * i, ref_stride);
+  return sum;
+}
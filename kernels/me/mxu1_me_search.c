@@ -0,0 +1,252 @@
+// mxu1_me_search.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 motion search drivers (full, diamond, hexagon)
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The searches are written once, against a table of kernels: one table holds
+// the MXU kernels from mxu1_me.s, the other the C references, so that the _c
+// searches visit the same positions in the same order and must return the
+// same result. Candidates are always evaluated four at a time through the _x4
+// kernels; slots with nothing to evaluate (or outside the window) are given
+// the current centre instead, which can never win since only a strictly lower
+// SAD replaces the best.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "mxu1_me.h"
+
+typedef void (*sad_x4_fn)(const uint8_t *cur, const uint8_t *const ref[4],
+                          int ref_stride, uint32_t sad[4], int h);
+typedef uint32_t (*sad_fn)(const uint8_t *cur, const uint8_t *ref,
+                           int ref_stride, int h);
+
+typedef struct {
+  sad_fn    sad16, sad8, sad4;
+  sad_x4_fn sad16_x4, sad8_x4, sad4_x4;
+} me_kernels;
+
+static const me_kernels kernels_mxu = {
+  mxu1_sad16,    mxu1_sad8,    mxu1_sad4,
+  mxu1_sad16_x4, mxu1_sad8_x4, mxu1_sad4_x4
+};
+
+static const me_kernels kernels_c = {
+  mxu1_sad16_c,    mxu1_sad8_c,    mxu1_sad4_c,
+  mxu1_sad16_x4_c, mxu1_sad8_x4_c, mxu1_sad4_x4_c
+};
+
+// Search state: the parameters, resolved for one block size
+typedef struct {
+  const mxu1_me_params *p;
+  sad_fn         sad;
+  sad_x4_fn      sad_x4;
+  int            h;
+  mxu1_me_result best;
+} me_ctx;
+
+static void ctx_init(me_ctx *c, const mxu1_me_params *p, const me_kernels *k)
+{
+  c->p = p;
+  switch (p->size) {
+    case MXU1_ME_16x16: c->sad = k->sad16; c->sad_x4 = k->sad16_x4; c->h = 16; break;
+    case MXU1_ME_16x8:  c->sad = k->sad16; c->sad_x4 = k->sad16_x4; c->h = 8;  break;
+    case MXU1_ME_8x8:   c->sad = k->sad8;  c->sad_x4 = k->sad8_x4;  c->h = 8;  break;
+    default:            c->sad = k->sad4;  c->sad_x4 = k->sad4_x4;  c->h = 4;  break;
+  }
+  c->best.positions = 0;
+}
+
+static int in_window(const mxu1_me_params *p, int x, int y)
+{
+  return x >= p->min.x && x <= p->max.x && y >= p->min.y && y <= p->max.y;
+}
+
+static const uint8_t *ref_at(const mxu1_me_params *p, int x, int y)
+{
+  return p->ref + y * p->ref_stride + x;
+}
+
+// Evaluate the starting vector, clamped into the window, as the first best
+static void ctx_start(me_ctx *c)
+{
+  const mxu1_me_params *p = c->p;
+  int x = p->start.x, y = p->start.y;
+
+  x = x < p->min.x ? p->min.x : x > p->max.x ? p->max.x : x;
+  y = y < p->min.y ? p->min.y : y > p->max.y ? p->max.y : y;
+  c->best.mv.x = x;
+  c->best.mv.y = y;
+  c->best.sad = c->sad(p->cur, ref_at(p, x, y), p->ref_stride, c->h);
+  c->best.positions++;
+}
+
+static int good_enough(const me_ctx *c)
+{
+  return c->best.sad <= c->p->good_enough;
+}
+
+//  Evaluate up to four offsets from 'centre', whose SAD must not be lower than
+// the best so far; returns the index of the offset that became the new best,
+// or -1.
+static int eval_around(me_ctx *c, mxu1_mv centre, const mxu1_mv *off, int n)
+{
+  const mxu1_me_params *p = c->p;
+  const uint8_t *ref[4];
+  uint32_t sad[4] = { 0, 0, 0, 0 };
+  mxu1_mv mv[4];
+  int best = -1;
+
+  for (int i = 0; i < 4; ++i) {
+    mv[i] = centre;
+    if (i < n && in_window(p, centre.x + off[i].x, centre.y + off[i].y)) {
+      mv[i].x += off[i].x;
+      mv[i].y += off[i].y;
+      c->best.positions++;
+    }
+    ref[i] = ref_at(p, mv[i].x, mv[i].y);
+  }
+
+  c->sad_x4(p->cur, ref, p->ref_stride, sad, c->h);
+
+  for (int i = 0; i < n; ++i) {
+    if (sad[i] < c->best.sad) {
+      c->best.sad = sad[i];
+      c->best.mv = mv[i];
+      best = i;
+    }
+  }
+  return best;
+}
+
+static const mxu1_mv diamond[4] = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
+
+// Clockwise from the left, so that directions d-1, d, d+1 (mod 6) are the
+//  three points a step in direction d has not seen yet
+static const mxu1_mv hexagon[6] = {
+  { -2, 0 }, { -1, -2 }, { 1, -2 }, { 2, 0 }, { 1, 2 }, { -1, 2 }
+};
+
+static mxu1_me_result full(const mxu1_me_params *p, const me_kernels *k)
+{
+  me_ctx c;
+  ctx_init(&c, p, k);
+  ctx_start(&c);
+
+  for (int y = p->min.y; y <= p->max.y && !good_enough(&c); ++y) {
+    for (int x = p->min.x; x <= p->max.x && !good_enough(&c); x += 4) {
+      const uint8_t *ref[4];
+      uint32_t sad[4] = { 0, 0, 0, 0 };
+      int n = p->max.x - x + 1;
+
+      n = n > 4 ? 4 : n;
+      for (int i = 0; i < 4; ++i)
+        ref[i] = ref_at(p, x + (i < n ? i : 0), y);
+      c.best.positions += n;
+
+      // Partial distortion elimination, 4 rows at a time
+      for (int r = 0; r < c.h; r += 4) {
+        c.sad_x4(p->cur + r * MXU1_ME_CUR_STRIDE, ref, p->ref_stride, sad, 4);
+        if (sad[0] >= c.best.sad && sad[1] >= c.best.sad &&
+            sad[2] >= c.best.sad && sad[3] >= c.best.sad)
+          break;
+        for (int i = 0; i < 4; ++i)
+          ref[i] += 4 * p->ref_stride;
+      }
+
+      for (int i = 0; i < n; ++i) {
+        if (sad[i] < c.best.sad) {
+          c.best.sad = sad[i];
+          c.best.mv.x = x + i;
+          c.best.mv.y = y;
+        }
+      }
+    }
+  }
+  return c.best;
+}
+
+static mxu1_me_result diamond_search(const mxu1_me_params *p, const me_kernels *k)
+{
+  me_ctx c;
+  ctx_init(&c, p, k);
+  ctx_start(&c);
+
+  for (int i = 0; (!p->max_iter || i < p->max_iter) && !good_enough(&c); ++i)
+    if (eval_around(&c, c.best.mv, diamond, 4) < 0)
+      break;
+  return c.best;
+}
+
+static mxu1_me_result hexagon_search(const mxu1_me_params *p, const me_kernels *k)
+{
+  me_ctx c;
+  int dir;
+
+  ctx_init(&c, p, k);
+  ctx_start(&c);
+  if (good_enough(&c))
+    return c.best;
+
+  // First step: all six points, the best of which gives the direction
+  {
+    mxu1_mv centre = c.best.mv;
+    int lo = eval_around(&c, centre, hexagon, 4);
+    int hi = eval_around(&c, centre, hexagon + 4, 2);
+    dir = hi >= 0 ? 4 + hi : lo;
+  }
+
+  for (int i = 1; dir >= 0 && (!p->max_iter || i < p->max_iter) &&
+                  !good_enough(&c); ++i) {
+    mxu1_mv off[3];
+    int won;
+
+    for (int j = 0; j < 3; ++j)
+      off[j] = hexagon[(dir + 5 + j) % 6];
+    won = eval_around(&c, c.best.mv, off, 3);
+    dir = won < 0 ? -1 : (dir + 5 + won) % 6;
+  }
+
+  if (!good_enough(&c))
+    eval_around(&c, c.best.mv, diamond, 4);
+  return c.best;
+}
+
+void mxu1_me_load_cur(uint8_t *dst, const uint8_t *src, int src_stride,
+                      mxu1_me_size size)
+{
+  int w = size <= MXU1_ME_16x8 ? 16 : size == MXU1_ME_8x8 ? 8 : 4;
+  int h = size == MXU1_ME_16x16 ? 16 : size == MXU1_ME_4x4 ? 4 : 8;
+
+  for (int y = 0; y < h; ++y)
+    memcpy(dst + y * MXU1_ME_CUR_STRIDE, src + y * src_stride, w);
+}
+
+mxu1_me_result mxu1_me_full(const mxu1_me_params *p)      { return full(p, &kernels_mxu); }
+mxu1_me_result mxu1_me_diamond(const mxu1_me_params *p)   { return diamond_search(p, &kernels_mxu); }
+mxu1_me_result mxu1_me_hexagon(const mxu1_me_params *p)   { return hexagon_search(p, &kernels_mxu); }
+mxu1_me_result mxu1_me_full_c(const mxu1_me_params *p)    { return full(p, &kernels_c); }
+mxu1_me_result mxu1_me_diamond_c(const mxu1_me_params *p) { return diamond_search(p, &kernels_c); }
+mxu1_me_result mxu1_me_hexagon_c(const mxu1_me_params *p) { return hexagon_search(p, &kernels_c); }
@@ -0,0 +1,97 @@
+// mxu1_mem.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 memcpy, memmove, memset, memcmp and string search
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  memcpy(), memmove(), memset() and memcmp() on the MXU (mxu1_mem.s), for
+// the frame buffer and packet paths where libc's versions show up first in
+// profiles, and plain C versions of each (the _c functions, in
+// mxu1_mem_ref.c) that define their results.
+//
+// Each function has the signature and semantics of its libc namesake and
+// takes buffers at any alignment; mxu1_memcmp() returns the difference of the
+// first differing bytes, as unsigned chars, so it can be compared exactly
+// with mxu1_memcmp_c(). Past 16 bytes the work is done 32 bytes (a cache
+// line) at a time with s32ldi/s32sdi streams, a source misaligned against
+// the destination being realigned in registers with s32aln rather than moved
+// bytewise, and pref fetching ahead of both streams (MEM_PREF_AHEAD in
+// mxu1_mem.s). Only aligned words holding at least one byte of a buffer are
+// read.
+//
+//  strlen(), strchr(), memchr() and memrchr() (a GNU extension) are done the
+// same way, a q8movz match mask per word, tested once per 32-byte block.
+// mxu1_strlen() and mxu1_strchr() read the aligned 32-byte block holding the
+// terminator to its end, as libc's versions do: it may lie past the string,
+// never in another page. mxu1_memchr() and mxu1_memrchr() keep to the
+// buffer's words.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/mem, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_mem.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_mem_ref.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_MEM_H
+#define MXU1_MEM_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// MXU versions (mxu1_mem.s)
+////////////////////////////////////////////////////////////////////////////////
+
+void  *mxu1_memcpy(void *dst, const void *src, size_t n);
+void  *mxu1_memmove(void *dst, const void *src, size_t n);
+void  *mxu1_memset(void *dst, int c, size_t n);
+int    mxu1_memcmp(const void *s1, const void *s2, size_t n);
+size_t mxu1_strlen(const char *s);
+char  *mxu1_strchr(const char *s, int c);
+void  *mxu1_memchr(const void *s, int c, size_t n);
+void  *mxu1_memrchr(const void *s, int c, size_t n);
+
+////////////////////////////////////////////////////////////////////////////////
+// C versions (mxu1_mem_ref.c)
+////////////////////////////////////////////////////////////////////////////////
+
+void  *mxu1_memcpy_c(void *dst, const void *src, size_t n);
+void  *mxu1_memmove_c(void *dst, const void *src, size_t n);
+void  *mxu1_memset_c(void *dst, int c, size_t n);
+int    mxu1_memcmp_c(const void *s1, const void *s2, size_t n);
+size_t mxu1_strlen_c(const char *s);
+char  *mxu1_strchr_c(const char *s, int c);
+void  *mxu1_memchr_c(const void *s, int c, size_t n);
+void  *mxu1_memrchr_c(const void *s, int c, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_MEM_H
@@ -0,0 +1,788 @@
+# mxu1_mem.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 memcpy, memmove, memset, memcmp and string search
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes are in mxu1_mem.h; each function is a drop-in for its libc
+# namesake (memcmp() returns the difference of the first differing bytes).
+#
+#  Copies bring the destination to a word boundary with byte moves, then
+# stream 32 bytes, one cache line, per loop iteration with s32ldi/s32sdi,
+# whose pointer update comes free with the access, and finish with words and
+# then bytes. One pref per line fetches the source MEM_PREF_AHEAD bytes ahead
+# of the loads, and one the destination as far ahead of the stores.
+#
+#  A source that is misaligned once the destination is aligned is read as
+# aligned words and put back together in registers: with k = src & 3 and the
+# words w0, w1 around four source bytes, 's32aln x, w1, w0, 4-k' is
+# (w1 << 8*(4-k)) | (w0 >> 8*k), the little-endian word at src. Each aligned
+# word is loaded once, the last of a block carrying over into the next, so a
+# block is 8 loads, 8 s32aln and 8 stores. Only aligned words holding at least
+# one source byte are read.
+#
+#  mxu1_memmove() copies forwards (in mxu1_memcpy()) unless the destination
+# starts inside the source, dst - src < n unsigned, and then runs the same
+# code downwards from the ends, where the destination is above the source.
+#
+#  mxu1_memcmp() compares 32 bytes per iteration with q8sad, which is zero
+# only when all four byte pairs are equal, summing into xr15 and testing the
+# sum once per block; the block holding the first difference is then compared
+# again bytewise for the result.
+#
+#  mxu1_strlen(), mxu1_strchr(), mxu1_memchr() and mxu1_memrchr() build a
+# match mask per word with q8movz, 0xff into xr15 in each byte that is NUL
+# or (q8abd against c in every byte being zero there) c, and test it with
+# s32m2i. The word holding the first byte is realigned with s32aln so that
+# byte is byte 0, the others filled with a byte that matches nothing; then
+# come aligned words up to a 32-byte boundary and 32-byte blocks, eight
+# s32ldi loads and one test of xr15 each. The string functions read whole
+# aligned blocks past the terminator, which never cross into another page;
+# mxu1_memchr() and mxu1_memrchr() read only words holding a byte of the
+# buffer. clz of the mask gives the byte's position.
+#
+# Register use: any xr, and $v0, $v1, $t0..$t4 and $a0..$a3. Leaf functions.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# Prefetch distance, bytes: two 32-byte lines
+  .equ    MEM_PREF_AHEAD, 64
+
+# \d = the source word between \prev, the aligned word already held, and
+#  \next, the one just loaded, \step (4 or -4) giving the direction
+.macro MEM_ALN d, prev, next, step
+  .if \step > 0
+  s32aln  \d,   \next, \prev, $t4
+  .else
+  s32aln  \d,   \prev, \next, $t4
+  .endif
+.endm
+
+# Move \n (a register, counted down to 0) bytes from $a1 to $a0, upwards, or
+#  for \step < 0 downwards from the ends
+.macro MEM_BYTES step, n
+  beqz    \n,   9f
+   nop
+8:
+  .if \step > 0
+  lbu     $t0,  0($a1)
+  addiu   $a1,  $a1,  1
+  addiu   \n,   \n,   -1
+  sb      $t0,  0($a0)
+  bnez    \n,   8b
+   addiu  $a0,  $a0,  1
+  .else
+  lbu     $t0,  -1($a1)
+  addiu   $a1,  $a1,  -1
+  addiu   \n,   \n,   -1
+  sb      $t0,  -1($a0)
+  bnez    \n,   8b
+   addiu  $a0,  $a0,  -1
+  .endif
+9:
+.endm
+
+# Body of memcpy (\step = 4) and of the downward memmove (\step = -4):
+#  copy $a2 bytes from $a1 to $a0 and return
+.macro MEM_COPY step
+  .if \step > 0
+  negu    $t1,  $a0
+  .else
+  addu    $a0,  $a0,  $a2
+  addu    $a1,  $a1,  $a2
+  move    $t1,  $a0
+  .endif
+  sltiu   $t0,  $a2,  16
+  bnez    $t0,  6f                  # Short: bytes only
+   andi   $t1,  $t1,  3             # Bytes to a word aligned destination
+  subu    $a2,  $a2,  $t1
+  MEM_BYTES \step, $t1
+  andi    $t2,  $a1,  3             # Source misalignment k
+  srl     $t3,  $a2,  5             # 32-byte blocks
+  andi    $a2,  $a2,  31
+  li      $t4,  4
+  subu    $t4,  $t4,  $t2           # s32aln amount, 4 - k
+  .if \step > 0
+  addiu   $a0,  $a0,  -4            # s32ldi/s32sdi step before the access
+  subu    $a1,  $a1,  $t2
+  bnez    $t2,  3f
+   addiu  $a1,  $a1,  -4
+  li      $t2,  4                   # Next source byte at the end: $a1 + 4
+  .else
+  bnez    $t2,  3f
+   subu   $a1,  $a1,  $t2
+  .endif
+
+  # Aligned source
+  beqz    $t3,  2f
+   nop
+1:
+  pref    0,    MEM_PREF_AHEAD * \step / 4($a1)
+  pref    1,    MEM_PREF_AHEAD * \step / 4($a0)
+  s32ldi  xr1,  $a1,  \step
+  s32ldi  xr2,  $a1,  \step
+  s32ldi  xr3,  $a1,  \step
+  s32ldi  xr4,  $a1,  \step
+  s32ldi  xr5,  $a1,  \step
+  s32ldi  xr6,  $a1,  \step
+  s32ldi  xr7,  $a1,  \step
+  s32ldi  xr8,  $a1,  \step
+  addiu   $t3,  $t3,  -1
+  s32sdi  xr1,  $a0,  \step
+  s32sdi  xr2,  $a0,  \step
+  s32sdi  xr3,  $a0,  \step
+  s32sdi  xr4,  $a0,  \step
+  s32sdi  xr5,  $a0,  \step
+  s32sdi  xr6,  $a0,  \step
+  s32sdi  xr7,  $a0,  \step
+  bnez    $t3,  1b
+   s32sdi xr8,  $a0,  \step
+2:
+  srl     $t3,  $a2,  2
+  beqz    $t3,  5f
+   andi   $a2,  $a2,  3
+1:
+  s32ldi  xr1,  $a1,  \step
+  addiu   $t3,  $t3,  -1
+  bnez    $t3,  1b
+   s32sdi xr1,  $a0,  \step
+  b       5f
+   nop
+
+  # Misaligned source: xr8 carries the last aligned word loaded
+3:
+  .if \step > 0
+  s32ldi  xr8,  $a1,  4             # Word holding the first source byte
+  .else
+  s32ldd  xr8,  $a1,  0             # Word holding the last source byte
+  .endif
+  beqz    $t3,  4f
+   nop
+1:
+  pref    0,    MEM_PREF_AHEAD * \step / 4($a1)
+  pref    1,    MEM_PREF_AHEAD * \step / 4($a0)
+  s32ldi  xr1,  $a1,  \step
+  s32ldi  xr2,  $a1,  \step
+  s32ldi  xr3,  $a1,  \step
+  s32ldi  xr4,  $a1,  \step
+  MEM_ALN xr8,  xr8,  xr1,  \step
+  s32ldi  xr5,  $a1,  \step
+  MEM_ALN xr1,  xr1,  xr2,  \step
+  s32ldi  xr6,  $a1,  \step
+  MEM_ALN xr2,  xr2,  xr3,  \step
+  s32ldi  xr7,  $a1,  \step
+  MEM_ALN xr3,  xr3,  xr4,  \step
+  s32sdi  xr8,  $a0,  \step
+  s32ldi  xr8,  $a1,  \step
+  MEM_ALN xr4,  xr4,  xr5,  \step
+  s32sdi  xr1,  $a0,  \step
+  MEM_ALN xr5,  xr5,  xr6,  \step
+  s32sdi  xr2,  $a0,  \step
+  MEM_ALN xr6,  xr6,  xr7,  \step
+  s32sdi  xr3,  $a0,  \step
+  MEM_ALN xr7,  xr7,  xr8,  \step
+  s32sdi  xr4,  $a0,  \step
+  addiu   $t3,  $t3,  -1
+  s32sdi  xr5,  $a0,  \step
+  s32sdi  xr6,  $a0,  \step
+  bnez    $t3,  1b
+   s32sdi xr7,  $a0,  \step
+4:
+  srl     $t3,  $a2,  2
+  beqz    $t3,  5f
+   andi   $a2,  $a2,  3
+1:
+  s32ldi  xr1,  $a1,  \step
+  addiu   $t3,  $t3,  -1
+  MEM_ALN xr2,  xr8,  xr1,  \step
+  s32alni xr8,  xr1,  xr0,  0       # Carry xr1
+  bnez    $t3,  1b
+   s32sdi xr2,  $a0,  \step
+
+5:
+  .if \step > 0
+  addiu   $a0,  $a0,  4
+  .endif
+  addu    $a1,  $a1,  $t2           # Back to a byte pointer
+6:
+  MEM_BYTES \step, $a2
+  jr      $ra
+   nop
+.endm
+
+# Compare 16 bytes of s1 at $a0 + \o with those of an aligned s2 at $a1 + \o
+#  into the q8sad sum xr15
+.macro MEM_CMP4 o
+  s32ldd  xr1,  $a0,  \o
+  s32ldd  xr5,  $a1,  \o
+  s32ldd  xr2,  $a0,  \o + 4
+  s32ldd  xr6,  $a1,  \o + 4
+  s32ldd  xr3,  $a0,  \o + 8
+  s32ldd  xr7,  $a1,  \o + 8
+  q8sad   xr0,  xr1,  xr5,  xr15
+  s32ldd  xr4,  $a0,  \o + 12
+  s32ldd  xr8,  $a1,  \o + 12
+  q8sad   xr0,  xr2,  xr6,  xr15
+  q8sad   xr0,  xr3,  xr7,  xr15
+  q8sad   xr0,  xr4,  xr8,  xr15
+.endm
+
+# Same for a misaligned s2, read as the aligned words after $a1 + \o (held in
+#  \c) and realigned by $t4; the last of them is left in \r4
+.macro MEM_CMP4_ALN o, c, r1, r2, r3, r4
+  s32ldd  xr1,  $a0,  \o
+  s32ldd  \r1,  $a1,  \o + 4
+  s32ldd  xr2,  $a0,  \o + 4
+  s32ldd  \r2,  $a1,  \o + 8
+  s32ldd  xr3,  $a0,  \o + 8
+  s32aln  \c,   \r1,  \c,   $t4
+  s32ldd  \r3,  $a1,  \o + 12
+  s32aln  \r1,  \r2,  \r1,  $t4
+  s32ldd  xr4,  $a0,  \o + 12
+  q8sad   xr0,  xr1,  \c,   xr15
+  s32ldd  \r4,  $a1,  \o + 16
+  s32aln  \r2,  \r3,  \r2,  $t4
+  q8sad   xr0,  xr2,  \r1,  xr15
+  s32aln  \r3,  \r4,  \r3,  $t4
+  q8sad   xr0,  xr3,  \r2,  xr15
+  q8sad   xr0,  xr4,  \r3,  xr15
+.endm
+
+# Mark in xr15 (0xff bytes) the bytes of \w that a search of \kind looks
+#  for: 0 (strlen) NUL, 1 (strchr) NUL or c, 2 (memchr, memrchr) c; c is in
+#  every byte of xr13, 0xff in every byte of xr14. \t is scratch.
+.macro STR_TEST kind, w, t
+  .if \kind != 0
+  q8abd   \t,   \w,   xr13          # Zero where the byte is c
+  .endif
+  .if \kind != 2
+  q8movz  xr15, xr14, \w
+  .endif
+  .if \kind != 0
+  q8movz  xr15, xr14, \t
+  .endif
+.endm
+
+# The forward scans, strlen (\kind 0), strchr (1) and memchr (2, $a2 the
+#  end): a match mask for the word at s realigned by s32aln to start at s[0]
+#  (the bytes after it the fill xr12, which matches nothing), then aligned
+#  words to a 32-byte boundary, then 32-byte blocks with one test of the
+#  mask each. The block holding a match is run again a word at a time; then
+#  $t0 is the word's mask, $v1 the address of its byte 0.
+.macro STR_FORWARD kind
+  andi    $t1,  $a0,  3
+  subu    $a3,  $a0,  $t1           # The aligned word holding s[0]
+  li      $t2,  4
+  subu    $t2,  $t2,  $t1           # s32aln amount, 4 - k
+  s32ldd  xr1,  $a3,  0
+  s32i2m  xr15, $zero
+  s32aln  xr1,  xr12, xr1,  $t2     # s[0] .. s[3 - k], then k fill bytes
+  STR_TEST \kind, xr1, xr9
+  s32m2i  xr15, $t0
+  bnez    $t0,  8f
+   move   $v1,  $a0
+
+  # Words up to a 32-byte boundary (and, for memchr, while 32 bytes are not
+  # left); $a3 is the word last tested
+1:
+  addiu   $a3,  $a3,  4
+  .if \kind == 2
+  sltu    $t0,  $a3,  $a2
+  beqz    $t0,  9f                  # Past the end
+   subu   $t3,  $a2,  $a3
+  sltiu   $t0,  $t3,  32
+  bnez    $t0,  2f
+   srl    $t3,  $t3,  5             # 32-byte blocks left
+  .endif
+  andi    $t0,  $a3,  31
+  beqz    $t0,  3f
+   nop
+2:
+  s32ldd  xr1,  $a3,  0
+  s32i2m  xr15, $zero
+  STR_TEST \kind, xr1, xr9
+  s32m2i  xr15, $t0
+  beqz    $t0,  1b
+   move   $v1,  $a3
+  b       8f
+   nop
+
+  # 32-byte blocks: xr15 is clear until one holds a match
+3:
+  addiu   $a3,  $a3,  -4            # s32ldi steps before the load
+4:
+  pref    0,    MEM_PREF_AHEAD + 4($a3)
+  s32ldi  xr1,  $a3,  4
+  s32ldi  xr2,  $a3,  4
+  s32ldi  xr3,  $a3,  4
+  s32ldi  xr4,  $a3,  4
+  s32ldi  xr5,  $a3,  4
+  s32ldi  xr6,  $a3,  4
+  s32ldi  xr7,  $a3,  4
+  s32ldi  xr8,  $a3,  4
+  STR_TEST \kind, xr1, xr9
+  STR_TEST \kind, xr2, xr10
+  STR_TEST \kind, xr3, xr11
+  STR_TEST \kind, xr4, xr9
+  STR_TEST \kind, xr5, xr10
+  STR_TEST \kind, xr6, xr11
+  STR_TEST \kind, xr7, xr9
+  STR_TEST \kind, xr8, xr10
+  s32m2i  xr15, $t0
+  .if \kind == 2
+  bnez    $t0,  5f
+   addiu  $t3,  $t3,  -1
+  bnez    $t3,  4b
+   nop
+  b       1b                        # Less than a block left
+   nop
+  .else
+  beqz    $t0,  4b
+   nop
+  .endif
+5:
+  b       2b                        # Find the word
+   addiu  $a3,  $a3,  -28
+.endm
+
+# $v0 = the address of the first (lowest) byte set in the mask $t0, whose
+#  byte 0 is at \p
+.macro STR_FIRST p
+  negu    $t1,  $t0
+  and     $t0,  $t0,  $t1
+  clz     $t0,  $t0
+  xori    $t0,  $t0,  31
+  srl     $t0,  $t0,  3
+  addu    $v0,  \p,   $t0
+.endm
+
+# $v0 = the address of the last (highest) byte set in the mask $t0, whose
+#  byte 3 is at \p
+.macro STR_LAST p
+  clz     $t0,  $t0
+  srl     $t0,  $t0,  3
+  subu    $v0,  \p,   $t0
+.endm
+
+# xr14 = 0xff in every byte, xr13 and \t = c (\c, a GPR holding it as an
+#  unsigned char) in every byte
+.macro STR_SETUP c, t
+  li      \t,   -1
+  s32i2m  xr14, \t
+  move    \t,   \c
+  ins     \t,   \t,   8,    8
+  ins     \t,   \t,   16,   16
+  s32i2m  xr13, \t
+.endm
+
+
+################################################################################
+# void *mxu1_memcpy(void *dst, const void *src, size_t n)
+  .globl  mxu1_memcpy
+  .type   mxu1_memcpy, @function
+  .ent    mxu1_memcpy
+mxu1_memcpy:
+  move    $v0,  $a0
+.Lmemcpy_body:
+  MEM_COPY 4
+  .end    mxu1_memcpy
+  .size   mxu1_memcpy, .-mxu1_memcpy
+
+
+################################################################################
+# void *mxu1_memmove(void *dst, const void *src, size_t n)
+  .globl  mxu1_memmove
+  .type   mxu1_memmove, @function
+  .ent    mxu1_memmove
+mxu1_memmove:
+  subu    $t0,  $a0,  $a1
+  sltu    $t0,  $t0,  $a2           # Destination starts inside the source?
+  beqz    $t0,  .Lmemcpy_body
+   move   $v0,  $a0
+  MEM_COPY -4
+  .end    mxu1_memmove
+  .size   mxu1_memmove, .-mxu1_memmove
+
+
+################################################################################
+# void *mxu1_memset(void *dst, int c, size_t n)
+  .globl  mxu1_memset
+  .type   mxu1_memset, @function
+  .ent    mxu1_memset
+mxu1_memset:
+  move    $v0,  $a0
+  andi    $a1,  $a1,  0xff
+  ins     $a1,  $a1,  8,    8       # c in every byte
+  ins     $a1,  $a1,  16,   16
+  sltiu   $t0,  $a2,  16
+  bnez    $t0,  5f                  # Short: bytes only
+   negu   $t1,  $a0
+  andi    $t1,  $t1,  3             # Bytes to a word aligned destination
+  beqz    $t1,  2f
+   subu   $a2,  $a2,  $t1
+1:
+  addiu   $t1,  $t1,  -1
+  sb      $a1,  0($a0)
+  bnez    $t1,  1b
+   addiu  $a0,  $a0,  1
+2:
+  s32i2m  xr1,  $a1
+  srl     $t3,  $a2,  5             # 32-byte blocks
+  andi    $a2,  $a2,  31
+  beqz    $t3,  3f
+   addiu  $a0,  $a0,  -4            # s32sdi steps before the store
+1:
+  pref    1,    MEM_PREF_AHEAD($a0)
+  addiu   $t3,  $t3,  -1
+  s32sdi  xr1,  $a0,  4
+  s32sdi  xr1,  $a0,  4
+  s32sdi  xr1,  $a0,  4
+  s32sdi  xr1,  $a0,  4
+  s32sdi  xr1,  $a0,  4
+  s32sdi  xr1,  $a0,  4
+  s32sdi  xr1,  $a0,  4
+  bnez    $t3,  1b
+   s32sdi xr1,  $a0,  4
+3:
+  srl     $t3,  $a2,  2
+  beqz    $t3,  4f
+   andi   $a2,  $a2,  3
+1:
+  addiu   $t3,  $t3,  -1
+  bnez    $t3,  1b
+   s32sdi xr1,  $a0,  4
+4:
+  addiu   $a0,  $a0,  4
+5:
+  beqz    $a2,  2f
+   nop
+1:
+  addiu   $a2,  $a2,  -1
+  sb      $a1,  0($a0)
+  bnez    $a2,  1b
+   addiu  $a0,  $a0,  1
+2:
+  jr      $ra
+   nop
+  .end    mxu1_memset
+  .size   mxu1_memset, .-mxu1_memset
+
+
+################################################################################
+# int mxu1_memcmp(const void *s1, const void *s2, size_t n)
+  .globl  mxu1_memcmp
+  .type   mxu1_memcmp, @function
+  .ent    mxu1_memcmp
+mxu1_memcmp:
+  sltiu   $t0,  $a2,  16
+  bnez    $t0,  7f                  # Short: bytes only
+   negu   $t1,  $a0
+  andi    $t1,  $t1,  3             # Bytes to a word aligned s1
+  beqz    $t1,  2f
+   subu   $a2,  $a2,  $t1
+1:
+  lbu     $t0,  0($a0)
+  lbu     $v1,  0($a1)
+  addiu   $t1,  $t1,  -1
+  addiu   $a0,  $a0,  1
+  bne     $t0,  $v1,  9f
+   subu   $v0,  $t0,  $v1
+  bnez    $t1,  1b
+   addiu  $a1,  $a1,  1
+2:
+  andi    $t2,  $a1,  3             # s2 misalignment k
+  subu    $a1,  $a1,  $t2
+  li      $t4,  4
+  subu    $t4,  $t4,  $t2           # s32aln amount, 4 - k
+  srl     $t3,  $a2,  5             # 32-byte blocks
+  andi    $a2,  $a2,  31
+  s32i2m  xr15, $zero
+  bnez    $t2,  4f
+   s32ldd xr9,  $a1,  0             # Misaligned: first word of s2
+
+  # Aligned s2
+  beqz    $t3,  2f
+   nop
+1:
+  pref    0,    MEM_PREF_AHEAD($a0)
+  pref    0,    MEM_PREF_AHEAD($a1)
+  MEM_CMP4 0
+  MEM_CMP4 16
+  s32m2i  xr15, $t0
+  addiu   $t3,  $t3,  -1
+  addiu   $a0,  $a0,  32
+  addiu   $a1,  $a1,  32
+  bnez    $t0,  5f                  # A difference in the last 32 bytes
+   li     $t1,  32
+  bnez    $t3,  1b
+   nop
+2:
+  srl     $t3,  $a2,  2
+  beqz    $t3,  8f
+   andi   $a2,  $a2,  3
+1:
+  s32ldd  xr1,  $a0,  0
+  s32ldd  xr5,  $a1,  0
+  addiu   $t3,  $t3,  -1
+  addiu   $a0,  $a0,  4
+  q8sad   xr0,  xr1,  xr5,  xr15
+  s32m2i  xr15, $t0
+  addiu   $a1,  $a1,  4
+  bnez    $t0,  5f
+   li     $t1,  4
+  bnez    $t3,  1b
+   nop
+  b       8f
+   nop
+
+  # Misaligned s2: xr9 carries the last aligned word loaded
+4:
+  beqz    $t3,  2f
+   nop
+1:
+  pref    0,    MEM_PREF_AHEAD($a0)
+  pref    0,    MEM_PREF_AHEAD($a1)
+  MEM_CMP4_ALN 0,  xr9, xr5, xr6, xr7, xr8
+  MEM_CMP4_ALN 16, xr8, xr5, xr6, xr7, xr9
+  s32m2i  xr15, $t0
+  addiu   $t3,  $t3,  -1
+  addiu   $a0,  $a0,  32
+  addiu   $a1,  $a1,  32
+  bnez    $t0,  5f
+   li     $t1,  32
+  bnez    $t3,  1b
+   nop
+2:
+  srl     $t3,  $a2,  2
+  beqz    $t3,  8f
+   andi   $a2,  $a2,  3
+1:
+  s32ldd  xr1,  $a0,  0
+  s32ldd  xr5,  $a1,  4
+  addiu   $t3,  $t3,  -1
+  addiu   $a0,  $a0,  4
+  s32aln  xr6,  xr5,  xr9,  $t4
+  s32alni xr9,  xr5,  xr0,  0       # Carry xr5
+  q8sad   xr0,  xr1,  xr6,  xr15
+  s32m2i  xr15, $t0
+  addiu   $a1,  $a1,  4
+  bnez    $t0,  5f
+   li     $t1,  4
+  bnez    $t3,  1b
+   nop
+  b       8f
+   nop
+
+  # The first difference is in the $t1 bytes before $a0
+5:
+  subu    $a0,  $a0,  $t1
+  subu    $a1,  $a1,  $t1
+  move    $a2,  $t1
+8:
+  addu    $a1,  $a1,  $t2           # Back to a byte pointer
+7:
+  beqz    $a2,  9f
+   move   $v0,  $zero
+1:
+  lbu     $t0,  0($a0)
+  lbu     $v1,  0($a1)
+  addiu   $a2,  $a2,  -1
+  addiu   $a0,  $a0,  1
+  bne     $t0,  $v1,  9f
+   subu   $v0,  $t0,  $v1
+  bnez    $a2,  1b
+   addiu  $a1,  $a1,  1
+9:
+  jr      $ra
+   nop
+  .end    mxu1_memcmp
+  .size   mxu1_memcmp, .-mxu1_memcmp
+
+
+################################################################################
+# size_t mxu1_strlen(const char *s)
+  .globl  mxu1_strlen
+  .type   mxu1_strlen, @function
+  .ent    mxu1_strlen
+mxu1_strlen:
+  li      $t0,  -1
+  s32i2m  xr12, $t0                 # Fill: no NUL
+  s32i2m  xr14, $t0
+  STR_FORWARD 0
+8:
+  STR_FIRST $v1
+  jr      $ra
+   subu   $v0,  $v0,  $a0
+  .end    mxu1_strlen
+  .size   mxu1_strlen, .-mxu1_strlen
+
+
+################################################################################
+# char *mxu1_strchr(const char *s, int c)
+  .globl  mxu1_strchr
+  .type   mxu1_strchr, @function
+  .ent    mxu1_strchr
+mxu1_strchr:
+  andi    $a1,  $a1,  0xff
+  STR_SETUP $a1, $t0
+  xori    $t0,  $a1,  0x7f          # Fill: bit 7 set, so not NUL, and low
+  ori     $t0,  $t0,  0x80          # bits unlike c's, so not c
+  ins     $t0,  $t0,  8,    8
+  ins     $t0,  $t0,  16,   16
+  s32i2m  xr12, $t0
+  STR_FORWARD 1
+8:
+  STR_FIRST $v1
+  lbu     $t0,  0($v0)
+  xor     $t0,  $t0,  $a1
+  jr      $ra
+   movn   $v0,  $zero, $t0          # The NUL, not c: none
+  .end    mxu1_strchr
+  .size   mxu1_strchr, .-mxu1_strchr
+
+
+################################################################################
+# void *mxu1_memchr(const void *s, int c, size_t n)
+  .globl  mxu1_memchr
+  .type   mxu1_memchr, @function
+  .ent    mxu1_memchr
+mxu1_memchr:
+  beqz    $a2,  9f
+   andi   $a1,  $a1,  0xff
+  STR_SETUP $a1, $t0
+  nor     $t0,  $t0,  $zero         # Fill: ~c
+  s32i2m  xr12, $t0
+  addu    $a2,  $a0,  $a2           # The end
+  STR_FORWARD 2
+8:
+  STR_FIRST $v1
+  sltu    $t0,  $v0,  $a2
+  jr      $ra
+   movz   $v0,  $zero, $t0          # Past the end: none
+9:
+  jr      $ra
+   move   $v0,  $zero
+  .end    mxu1_memchr
+  .size   mxu1_memchr, .-mxu1_memchr
+
+
+################################################################################
+# void *mxu1_memrchr(const void *s, int c, size_t n)
+#
+#  memchr() downwards: the word holding the last byte is realigned to put it
+# in byte 3, ~c filling below; then words down to a 32-byte boundary, and
+# 32-byte blocks while they lie wholly in s; $a3 is the word last tested.
+  .globl  mxu1_memrchr
+  .type   mxu1_memrchr, @function
+  .ent    mxu1_memrchr
+mxu1_memrchr:
+  beqz    $a2,  9f
+   andi   $a1,  $a1,  0xff
+  STR_SETUP $a1, $t0
+  nor     $t0,  $t0,  $zero
+  s32i2m  xr12, $t0
+  addu    $v1,  $a0,  $a2
+  addiu   $v1,  $v1,  -1            # The last byte
+  andi    $t1,  $v1,  3
+  subu    $a3,  $v1,  $t1           # The aligned word holding it
+  li      $t2,  3
+  subu    $t2,  $t2,  $t1           # s32aln amount, 3 - j
+  s32ldd  xr1,  $a3,  0
+  s32i2m  xr15, $zero
+  s32aln  xr1,  xr1,  xr12, $t2
+  STR_TEST 2, xr1, xr9
+  s32m2i  xr15, $t0
+  bnez    $t0,  8f
+   nop
+
+1:
+  addiu   $a3,  $a3,  -4
+  addiu   $t1,  $a3,  4
+  sltu    $t0,  $a0,  $t1
+  beqz    $t0,  9f                  # Below s
+   subu   $t3,  $t1,  $a0
+  sltiu   $t0,  $t3,  32
+  bnez    $t0,  2f
+   srl    $t3,  $t3,  5             # 32-byte blocks left
+  andi    $t0,  $t1,  31
+  beqz    $t0,  3f
+   nop
+2:
+  s32ldd  xr1,  $a3,  0
+  s32i2m  xr15, $zero
+  STR_TEST 2, xr1, xr9
+  s32m2i  xr15, $t0
+  beqz    $t0,  1b
+   addiu  $v1,  $a3,  3
+  b       8f
+   nop
+
+3:
+  addiu   $a3,  $a3,  4             # s32ldi steps before the load
+4:
+  pref    0,    -MEM_PREF_AHEAD - 4($a3)
+  s32ldi  xr1,  $a3,  -4
+  s32ldi  xr2,  $a3,  -4
+  s32ldi  xr3,  $a3,  -4
+  s32ldi  xr4,  $a3,  -4
+  s32ldi  xr5,  $a3,  -4
+  s32ldi  xr6,  $a3,  -4
+  s32ldi  xr7,  $a3,  -4
+  s32ldi  xr8,  $a3,  -4
+  STR_TEST 2, xr1, xr9
+  STR_TEST 2, xr2, xr10
+  STR_TEST 2, xr3, xr11
+  STR_TEST 2, xr4, xr9
+  STR_TEST 2, xr5, xr10
+  STR_TEST 2, xr6, xr11
+  STR_TEST 2, xr7, xr9
+  STR_TEST 2, xr8, xr10
+  s32m2i  xr15, $t0
+  bnez    $t0,  5f
+   addiu  $t3,  $t3,  -1
+  bnez    $t3,  4b
+   nop
+  b       1b                        # Less than a block left
+   nop
+5:
+  b       2b                        # Find the word
+   addiu  $a3,  $a3,  28
+
+8:
+  STR_LAST $v1
+  sltu    $t0,  $v0,  $a0
+  jr      $ra
+   movn   $v0,  $zero, $t0          # Below s: none
+9:
+  jr      $ra
+   move   $v0,  $zero
+  .end    mxu1_memrchr
+  .size   mxu1_memrchr, .-mxu1_memrchr
+
+# vim:shiftwidth=2:expandtab:syntax=asm
@@ -0,0 +1,326 @@
+// mxu1_mem_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 memcpy, memmove, memset, memcmp and string search: checks and throughput
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Checks every function against its C version (and mxu1_memcmp()'s sign
+// against libc's) for all sizes up to 300 bytes at every alignment, with
+// overlapping moves in both directions and guard bytes around each
+// destination; the search functions also against libc's, on random buffers
+// with matches at any density, and next to unmapped pages. Then prints a
+// size x alignment matrix for each function: MXU throughput in MB/s, and its
+// speed relative to libc's version (the search functions scanning text of
+// that length without a match).
+//
+// Build and run on the target (kernels/mem):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_mem_bench
+//         mxu1_mem_bench.c mxu1_mem_ref.c mxu1_mem.s ../dispatch/mxu1_cpu.c
+//     ./mxu1_mem_bench [seconds per measurement, default 0.1]
+// Exits non-zero if any result differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE             // memrchr()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "mxu1_mem.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#define MAX_SIZE (1 << 20)      // Beyond L2: memory bandwidth
+#define CHECK_N  300
+
+static uint8_t buf_a[MAX_SIZE + 256] __attribute__((aligned(32)));
+static uint8_t buf_b[MAX_SIZE + 256] __attribute__((aligned(32)));
+static uint8_t buf_t[MAX_SIZE + 256] __attribute__((aligned(32)));
+static uint8_t expect[CHECK_N + 256];
+
+static void fill(uint8_t *p, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    p[i] = (uint8_t)rand();
+}
+
+static int sign(int x)
+{
+  return (x > 0) - (x < 0);
+}
+
+//  NULL if the search functions agree with their C versions and libc's on
+// the n bytes at p, and the string there; else the name of one that does not
+static const char *search_wrong(const uint8_t *p, int c, size_t n)
+{
+  const char *s = (const char *)p;
+  const void *r;
+
+  r = mxu1_memchr(p, c, n);
+  if (r != mxu1_memchr_c(p, c, n) || r != memchr(p, c, n))
+    return "mxu1_memchr";
+  r = mxu1_memrchr(p, c, n);
+  if (r != mxu1_memrchr_c(p, c, n) || r != memrchr(p, c, n))
+    return "mxu1_memrchr";
+  if (mxu1_strlen(s) != mxu1_strlen_c(s) || mxu1_strlen(s) != strlen(s))
+    return "mxu1_strlen";
+  r = mxu1_strchr(s, c);
+  if (r != mxu1_strchr_c(s, c) || r != strchr(s, c))
+    return "mxu1_strchr";
+  return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Checks
+////////////////////////////////////////////////////////////////////////////////
+
+static int check(void)
+{
+  int bad = 0;
+
+  for (int n = 0; n < CHECK_N; ++n)
+    for (int da = 0; da < 4; ++da)
+      for (int sa = 0; sa < 4; ++sa) {
+        uint8_t *dst = buf_b + 32 + da, *src = buf_a + 32 + sa;
+        fill(buf_a, CHECK_N + 64);
+        fill(buf_b, CHECK_N + 64);
+        memcpy(expect, buf_b, CHECK_N + 64);
+        mxu1_memcpy_c(expect + 32 + da, src, n);
+        if (mxu1_memcpy(dst, src, n) != dst ||
+            memcmp(buf_b, expect, CHECK_N + 64)) {
+          printf("mxu1_memcpy: wrong, n %d, dst & 3 = %d, src & 3 = %d\n",
+                 n, da, sa);
+          bad = 1;
+        }
+      }
+
+  // Overlapping both ways, and apart
+  for (int n = 0; n < CHECK_N; ++n)
+    for (int d = -40; d <= 40; ++d)
+      for (int sa = 0; sa < 4; ++sa) {
+        uint8_t *src = buf_a + 64 + sa, *dst = src + d;
+        fill(buf_a, CHECK_N + 128);
+        memcpy(expect, buf_a, CHECK_N + 128);
+        mxu1_memmove_c(expect + 64 + sa + d, expect + 64 + sa, n);
+        if (mxu1_memmove(dst, src, n) != dst ||
+            memcmp(buf_a, expect, CHECK_N + 128)) {
+          printf("mxu1_memmove: wrong, n %d, dst - src = %d, src & 3 = %d\n",
+                 n, d, sa);
+          bad = 1;
+        }
+      }
+
+  for (int n = 0; n < CHECK_N; ++n)
+    for (int da = 0; da < 4; ++da) {
+      const int c = n & 1 ? rand() : 0x1a5;   // Only the low byte counts
+      uint8_t *dst = buf_b + 32 + da;
+      fill(buf_b, CHECK_N + 64);
+      memcpy(expect, buf_b, CHECK_N + 64);
+      mxu1_memset_c(expect + 32 + da, c, n);
+      if (mxu1_memset(dst, c, n) != dst || memcmp(buf_b, expect, CHECK_N + 64)) {
+        printf("mxu1_memset: wrong, n %d, dst & 3 = %d\n", n, da);
+        bad = 1;
+      }
+    }
+
+  // Equal, then one or two differences at each position
+  for (int n = 0; n < CHECK_N; ++n)
+    for (int aa = 0; aa < 4; ++aa)
+      for (int ba = 0; ba < 4; ++ba)
+        for (int pos = -1; pos < n; ++pos) {
+          uint8_t *a = buf_a + 32 + aa, *b = buf_b + 32 + ba;
+          fill(a, n + 8);
+          memcpy(b, a, n);
+          fill(b + n, 8);
+          if (pos >= 0) {
+            b[pos] ^= 1 + rand() % 255;
+            if (pos + 1 < n && rand() % 2)
+              b[pos + 1 + rand() % (n - pos - 1)] ^= 0x80;
+          }
+          const int r = mxu1_memcmp(a, b, n);
+          if (r != mxu1_memcmp_c(a, b, n) || sign(r) != sign(memcmp(a, b, n))) {
+            printf("mxu1_memcmp: wrong, n %d, s1 & 3 = %d, s2 & 3 = %d, "
+                   "difference at %d\n", n, aa, ba, pos);
+            bad = 1;
+          }
+        }
+
+  // Bytes equal to c one in 'odds', NULs as often, c also just outside the
+  // buffer; c NUL, with the top bit set, or with bits above the low byte
+  for (int n = 0; n < CHECK_N; ++n)
+    for (int sa = 0; sa < 32; ++sa)
+      for (int t = 0; t < 6; ++t) {
+        static const int cs[] = { 'a', 0, 0x80, 0xff, 0x17f, -1 };
+        const int c = t ? cs[t] : rand() & 0xff;
+        const unsigned odds = 2u << rand() % 9;
+        uint8_t *p = buf_a + 64 + sa;
+        const char *f;
+        for (int i = 0; i < CHECK_N + 160; ++i)
+          buf_a[i] = rand() % odds == 0 ? (uint8_t)c :
+                     rand() % odds == 0 ? 0 : (uint8_t)rand();
+        buf_a[CHECK_N + 160] = 0;
+        p[-1] = p[n] = (uint8_t)c;
+        if ((f = search_wrong(p, c, n))) {
+          printf("%s: wrong, n %d, s & 31 = %d, c 0x%x\n", f, n, sa, c);
+          bad = 1;
+        }
+      }
+
+  // Strings ending, and buffers starting and ending, at unmapped pages
+  {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uint8_t *m = (uint8_t *)mmap(NULL, 3 * page, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED || mprotect(m, page, PROT_NONE) ||
+        mprotect(m + 2 * page, page, PROT_NONE)) {
+      printf("page checks: mmap failed\n");
+      return 0;
+    }
+    uint8_t *lo = m + page, *hi = m + 2 * page;
+    memset(lo, 'x', page);
+    hi[-1] = 0;
+    for (int n = 1; n < CHECK_N; ++n)
+      for (int t = 0; t < 2; ++t) {
+        const char *f;
+        if ((f = search_wrong(hi - n, "xy"[t], n)) ||
+            (f = search_wrong(lo, "xy"[t], n))) {
+          printf("%s: wrong at a page boundary, n %d\n", f, n);
+          bad = 1;
+        }
+      }
+    munmap(m, 3 * page);
+  }
+
+  return !bad;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Timing
+////////////////////////////////////////////////////////////////////////////////
+
+typedef void (*mem_fn)(uint8_t *dst, const uint8_t *src, size_t n);
+
+static volatile int sink;
+
+static void run_memcpy(uint8_t *d, const uint8_t *s, size_t n)    { mxu1_memcpy(d, s, n); }
+static void run_memcpy_libc(uint8_t *d, const uint8_t *s, size_t n) { memcpy(d, s, n); }
+static void run_memmove(uint8_t *d, const uint8_t *s, size_t n)   { mxu1_memmove(d, s, n); }
+static void run_memmove_libc(uint8_t *d, const uint8_t *s, size_t n) { memmove(d, s, n); }
+static void run_memset(uint8_t *d, const uint8_t *s, size_t n)    { mxu1_memset(d, *s, n); }
+static void run_memset_libc(uint8_t *d, const uint8_t *s, size_t n) { memset(d, *s, n); }
+static void run_memcmp(uint8_t *d, const uint8_t *s, size_t n)    { sink = mxu1_memcmp(d, s, n); }
+static void run_memcmp_libc(uint8_t *d, const uint8_t *s, size_t n) { sink = memcmp(d, s, n); }
+static void run_strlen(uint8_t *d, const uint8_t *s, size_t n)    { (void)d; (void)n; sink = (int)mxu1_strlen((const char *)s); }
+static void run_strlen_libc(uint8_t *d, const uint8_t *s, size_t n) { (void)d; (void)n; sink = (int)strlen((const char *)s); }
+static void run_strchr(uint8_t *d, const uint8_t *s, size_t n)    { (void)d; (void)n; sink = !mxu1_strchr((const char *)s, '\n'); }
+static void run_strchr_libc(uint8_t *d, const uint8_t *s, size_t n) { (void)d; (void)n; sink = !strchr((const char *)s, '\n'); }
+static void run_memchr(uint8_t *d, const uint8_t *s, size_t n)    { (void)d; sink = !mxu1_memchr(s, '\n', n); }
+static void run_memchr_libc(uint8_t *d, const uint8_t *s, size_t n) { (void)d; sink = !memchr(s, '\n', n); }
+static void run_memrchr(uint8_t *d, const uint8_t *s, size_t n)   { (void)d; sink = !mxu1_memrchr(s, '\n', n); }
+static void run_memrchr_libc(uint8_t *d, const uint8_t *s, size_t n) { (void)d; sink = !memrchr(s, '\n', n); }
+
+static double mb_per_s(mem_fn f, uint8_t *dst, const uint8_t *src, size_t n,
+                       double secs)
+{
+  const unsigned reps = n < 65536 ? 65536 / n : 1;
+  unsigned long calls = 0;
+  double t0 = now(), t;
+
+  do {
+    for (unsigned i = 0; i < reps; ++i)
+      f(dst, src, n);
+    calls += reps;
+    t = now() - t0;
+  } while (t < secs);
+  return n * (double)calls / t * 1e-6;
+}
+
+int main(int argc, char **argv)
+{
+  static const struct {
+    const char *name;
+    mem_fn      mxu, libc;
+    int         move;           // Destination 32 bytes above the source
+    int         text;           // Source in buf_t, NUL at src[n]
+  } tests[] = {
+    { "memcpy",  run_memcpy,  run_memcpy_libc,  0, 0 },
+    { "memmove", run_memmove, run_memmove_libc, 1, 0 },
+    { "memset",  run_memset,  run_memset_libc,  0, 0 },
+    { "memcmp",  run_memcmp,  run_memcmp_libc,  0, 0 },
+    { "strlen",  run_strlen,  run_strlen_libc,  0, 1 },
+    { "strchr",  run_strchr,  run_strchr_libc,  0, 1 },
+    { "memchr",  run_memchr,  run_memchr_libc,  0, 1 },
+    { "memrchr", run_memrchr, run_memrchr_libc, 0, 1 },
+  };
+  static const size_t sizes[] = { 16, 64, 256, 1024, 4096, 65536, MAX_SIZE };
+  static const int align[][2] = {   // dst (s1) & 3, src (s2) & 3
+    { 0, 0 }, { 0, 1 }, { 0, 2 }, { 1, 0 }, { 3, 1 }, { 2, 2 }
+  };
+  double secs = argc > 1 ? atof(argv[1]) : 0.1;
+  int ok;
+
+  mxu1_cpu_enable();
+  ok = check();
+
+  fill(buf_a, sizeof(buf_a));
+  memcpy(buf_b, buf_a, sizeof(buf_b));   // memcmp runs to the end
+  for (size_t i = 0; i < sizeof(buf_t); ++i)
+    buf_t[i] = (uint8_t)(' ' + rand() % 95);  // No '\n' for the searches
+  for (unsigned t = 0; t < sizeof(tests) / sizeof(tests[0]); ++t) {
+    printf("\n%s%s: MB/s (MXU) and speed relative to libc\n", tests[t].name,
+           tests[t].move ? ", destination 32 bytes above the source" :
+           tests[t].text ? ", no match (src alignment counts)" : "");
+    printf("   bytes");
+    for (unsigned a = 0; a < sizeof(align) / sizeof(align[0]); ++a)
+      printf("       %d/%d   ", align[a][0], align[a][1]);
+    printf("\n");
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+      printf("%8u", (unsigned)sizes[s]);
+      for (unsigned a = 0; a < sizeof(align) / sizeof(align[0]); ++a) {
+        uint8_t *src = (tests[t].text ? buf_t : buf_a) + 64 + align[a][1];
+        uint8_t *dst = tests[t].move ? src + 32 - align[a][1] + align[a][0]
+                                     : buf_b + 64 + align[a][0];
+        const uint8_t end = src[sizes[s]];
+        if (tests[t].text)
+          src[sizes[s]] = 0;
+        double m = mb_per_s(tests[t].mxu, dst, src, sizes[s], secs);
+        double l = mb_per_s(tests[t].libc, dst, src, sizes[s], secs);
+        src[sizes[s]] = end;
+        printf("  %7.0f x%4.2f", m, m / l);
+      }
+      printf("\n");
+    }
+  }
+
+  return !ok;
+}
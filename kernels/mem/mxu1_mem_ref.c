@@ -0,0 +1,108 @@
+// mxu1_mem_ref.c
+//
+// Scalar C reference for the mxu1_mem.s memcpy, memmove, memset, memcmp and string search
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Byte at a time versions of the functions in mxu1_mem.s: the definition of
+// their results, and the fallback without MXU.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include "mxu1_mem.h"
+
+void *mxu1_memcpy_c(void *dst, const void *src, size_t n)
+{
+  uint8_t *d = (uint8_t *)dst;
+  const uint8_t *s = (const uint8_t *)src;
+  while (n--)
+    *d++ = *s++;
+  return dst;
+}
+
+void *mxu1_memmove_c(void *dst, const void *src, size_t n)
+{
+  uint8_t *d = (uint8_t *)dst;
+  const uint8_t *s = (const uint8_t *)src;
+  // Downwards when dst starts inside the source, as mxu1_memmove() decides
+  if ((uintptr_t)d - (uintptr_t)s >= n)
+    return mxu1_memcpy_c(dst, src, n);
+  while (n--)
+    d[n] = s[n];
+  return dst;
+}
+
+void *mxu1_memset_c(void *dst, int c, size_t n)
+{
+  uint8_t *d = (uint8_t *)dst;
+  while (n--)
+    *d++ = (uint8_t)c;
+  return dst;
+}
+
+int mxu1_memcmp_c(const void *s1, const void *s2, size_t n)
+{
+  const uint8_t *a = (const uint8_t *)s1, *b = (const uint8_t *)s2;
+  for (; n; --n, ++a, ++b)
+    if (*a != *b)
+      return *a - *b;
+  return 0;
+}
+
+size_t mxu1_strlen_c(const char *s)
+{
+  const char *p = s;
+  while (*p)
+    ++p;
+  return (size_t)(p - s);
+}
+
+char *mxu1_strchr_c(const char *s, int c)
+{
+  for (;; ++s) {
+    if (*s == (char)c)
+      return (char *)s;
+    if (!*s)
+      return NULL;
+  }
+}
+
+void *mxu1_memchr_c(const void *s, int c, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)s;
+  for (; n; --n, ++p)
+    if (*p == (uint8_t)c)
+      return (void *)p;
+  return NULL;
+}
+
+void *mxu1_memrchr_c(const void *s, int c, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)s;
+  while (n--)
+    if (p[n] == (uint8_t)c)
+      return (void *)(p + n);
+  return NULL;
+}
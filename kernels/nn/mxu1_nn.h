@@ -0,0 +1,192 @@
+// mxu1_nn.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 int8 CNN layers: conv 3x3, depthwise, pointwise
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Quantized (int8) CNN layers: 3x3 convolution, 3x3 depthwise convolution
+// and 1x1 pointwise convolution, computed directly on NHWC tensors (no
+// im2col), with the inner kernels in mxu1_nn.s and a C twin of each kernel in
+// mxu1_nn_ref.c that they match exactly.
+//
+// Arithmetic is TensorFlow Lite's int8 scheme, and results are bit-exact with
+// its reference kernels (mxu1_nn_run_ref(), a direct transcription of them):
+//   - activations are int8 with a zero point, weights int8 with zero point 0,
+//     biases int32, one multiplier and shift per output channel (as produced
+//     by TFLite's QuantizeMultiplier(): mult in [2^30, 2^31) or 0);
+//   - acc = bias + sum (in - in_zp) * w, with padding taking the value in_zp;
+//   - out = clamp(out_zp + MultiplyByQuantizedMultiplier(acc, mult, shift),
+//     act_min, act_max), i.e. a rounding doubling high multiply followed by a
+//     rounding (half away from zero) right shift.
+//
+// How the MXU does it (details in mxu1_nn.s):
+//   - Activations are copied, a few rows at a time, into offset binary
+//     (in + 128, a uint8), with the padding and the channel count rounded up
+//     to 4 added on the way. q8mulsu then forms int8 weight x uint8 input
+//     products four at a time, which d16asum (conv, pointwise) or d16mac
+//     against 1 (depthwise) adds into 32-bit accumulators. The 128 and the
+//     input zero point come out as a per-channel constant, which mxu1_nn_pack()
+//     folds into the bias.
+//   - Accumulators are requantized per output channel, then clamped, narrowed
+//     (d32sarl, q16sat) and stored four channels per word.
+//   - The driver (mxu1_nn_layer.c) computes one output row at a time, in tiles
+//     of pixels and blocks of output channels sized so that each tile's inputs,
+//     accumulators and weights stay in the L1 data cache (MXU1_NN_L1_BYTES).
+//
+// Restrictions: batch 1, stride 1 or 2, out_c a multiple of 4 (conv and
+// pointwise) and in_c a multiple of 4 for depthwise; any in_c otherwise.
+// Tensors and the packed and scratch buffers must be word aligned.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/nn, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_nn.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_nn_ref.c mxu1_nn_layer.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_NN_H
+#define MXU1_NN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Layers (mxu1_nn_layer.c)
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum {
+  MXU1_NN_CONV3X3,          // weights [out_c][3][3][in_c] (TFLite OHWI)
+  MXU1_NN_DEPTHWISE3X3,     // weights [3][3][in_c] (TFLite 1HWC, multiplier 1)
+  MXU1_NN_POINTWISE         // weights [out_c][in_c]
+} mxu1_nn_op;
+
+typedef struct {
+  mxu1_nn_op     op;
+  int            in_h, in_w, in_c;  // Input tensor, NHWC, batch 1
+  int            out_c;             // Output channels (depthwise: in_c)
+  int            stride;            // 1 or 2, both directions
+  int            same;              // Padding: 1 'SAME', 0 'VALID'
+  int32_t        in_zp, out_zp;     // Zero points
+  int32_t        act_min, act_max;  // Output clamp, within -128..127
+  const int32_t *mult;              // Per output channel requantization, as
+  const int32_t *shift;             //  TFLite's (shift > 0: left)
+} mxu1_nn_layer;
+
+//  Output size, TFLite's rule: SAME gives ceil(in / stride), VALID
+// ceil((in - k + 1) / stride), for a k x k kernel.
+int mxu1_nn_out_h(const mxu1_nn_layer *l);
+int mxu1_nn_out_w(const mxu1_nn_layer *l);
+
+//  Weights, biases (folded as above) and requantization parameters in the
+// order the kernels read them. 'bias' may be NULL. mult[] and shift[] are only
+// read here, the layer's own arrays need not outlive the call.
+size_t mxu1_nn_packed_size(const mxu1_nn_layer *l);
+void   mxu1_nn_pack(void *packed, const mxu1_nn_layer *l,
+                    const int8_t *weights, const int32_t *bias);
+
+//  Run a layer: 'in' is in_h x in_w x in_c, 'out' out_h x out_w x out_c.
+// 'scratch' holds the offset binary input rows and the accumulators of one
+// tile, mxu1_nn_scratch_size() bytes.
+size_t mxu1_nn_scratch_size(const mxu1_nn_layer *l);
+void   mxu1_nn_run(const mxu1_nn_layer *l, const void *packed,
+                   const int8_t *in, int8_t *out, void *scratch);
+
+//  The same, on the C kernels.
+void   mxu1_nn_run_c(const mxu1_nn_layer *l, const void *packed,
+                     const int8_t *in, int8_t *out, void *scratch);
+
+//  Reference int8 runtime (mxu1_nn_ref.c): TFLite's reference ConvPerChannel
+// and DepthwiseConvPerChannel, on the unpacked weights.
+void   mxu1_nn_run_ref(const mxu1_nn_layer *l, const int8_t *weights,
+                       const int32_t *bias, const int8_t *in, int8_t *out);
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels (mxu1_nn.s), for the driver
+////////////////////////////////////////////////////////////////////////////////
+
+//  L1 data cache size the driver tiles for: 16 KiB on the JZ4740 through
+// JZ4770; larger parts do better with their own size.
+#ifndef MXU1_NN_L1_BYTES
+#define MXU1_NN_L1_BYTES 16384
+#endif
+
+//  A tile: 'npix' (even) output pixels of one row, whose k x k input windows
+// start at row[0..k-1] and step by 'pix_step' bytes. Inputs are offset binary
+// with 'cp' (a multiple of 4) channels per pixel. Accumulators are written to
+// acc[pixel * acc_stride / 4 + channel].
+//   conv_acc: 'count' pairs of output channels; for each pair, two int32
+//             biases, then for each kernel row 'words' words of weights (k * cp
+//             bytes) per channel, the two channels' words interleaved.
+//   dw_acc:   'count' groups of 4 channels; for each group, four int32 biases,
+//             then 9 words, one per tap (row major), of the group's weights.
+typedef struct {
+  const uint8_t *row[3];
+  int32_t        pix_step;
+  int32_t        cp;
+  int32_t        k;
+  int32_t        words;
+  const void    *w;
+  int32_t        count;
+  int32_t        npix;
+  int32_t       *acc;
+  int32_t        acc_stride;
+} mxu1_nn_tile;
+
+//  Per output channel requantization parameters, from mult and shift: shift
+// left by 'lshift', take the rounded high half of the doubled product with
+// 'mult', then shift right by 'rshift', rounding up when the bits shifted out
+// ('mask') exceed 'thresh' (half, plus one for negative values).
+typedef struct {
+  int32_t mult, lshift, rshift, mask, thresh;
+} mxu1_nn_rq;
+
+typedef struct {
+  int32_t           offset;     // out_zp + 128
+  int32_t           lo, hi;     // act_min + 128, act_max + 128
+  int32_t           channels;   // Multiple of 4
+  const mxu1_nn_rq *ch;
+} mxu1_nn_requant_params;
+
+void mxu1_nn_conv_acc(const mxu1_nn_tile *t);
+void mxu1_nn_dw_acc(const mxu1_nn_tile *t);
+
+//  Requantize npix x q->channels accumulators to int8 at 'dst'.
+void mxu1_nn_requant(int8_t *dst, const int32_t *acc, int npix,
+                     const mxu1_nn_requant_params *q);
+
+void mxu1_nn_conv_acc_c(const mxu1_nn_tile *t);
+void mxu1_nn_dw_acc_c(const mxu1_nn_tile *t);
+void mxu1_nn_requant_c(int8_t *dst, const int32_t *acc, int npix,
+                       const mxu1_nn_requant_params *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_NN_H
@@ -0,0 +1,384 @@
+# mxu1_nn.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 int8 CNN kernels: conv, depthwise, requantization
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, the tile layout (mxu1_nn_tile) and the arithmetic are
+# described in mxu1_nn.h.
+#
+#  Products: inputs are offset binary (x + 128, unsigned) and weights int8,
+# which is exactly what q8mulsu multiplies, four byte lanes at a time, into
+# 16-bit products in XRa (lanes 3,2) and XRd (lanes 1,0). A single product of
+# an int8 and a uint8 already needs 16 bits, so q8mac/q8macsu, which add into
+# the same 16-bit lanes, cannot accumulate even two of them without risk of
+# wrapping; every product is widened into a 32-bit accumulator instead:
+#
+#   conv_acc: the four lanes are four input channels of one output, so
+#             d16asum adds XRa's pair of products into one accumulator and
+#             XRd's into another; the two are summed at the end. Each step
+#             does 2 output pixels x 2 output channels x 4 input channels
+#             (16 MACs) from 4 loads, 4 q8mulsu and 4 d16asum.
+#   dw_acc:   the four lanes are four channels, each its own output, so
+#             d16mac against (1,1) adds the upper and the lower product of a
+#             word into two accumulators. Each tap does 2 pixels x 4 channels
+#             (8 MACs) from 3 loads, 2 q8mulsu and 4 d16mac.
+#
+#  Requantization needs the high half of a 32 x 32-bit product rounded at
+# bit 31, which takes 32 bits from {HI:LO}: more than s32extr's 31-bit field,
+# so madd and mfhi/mflo do it. The per-channel rounding shift is scalar too
+# (d32sarv and friends shift both lanes by the same amount, and by at most
+# 15). Four channels at a time are then clamped in 32 bits (s32max/s32min),
+# narrowed to halfwords (d32sarl) and bytes (q16sat), moved from offset binary
+# back to int8 (s32xor) and stored as one word.
+#
+# Register use: any xr, $v0, $v1, $t0..$t9, $a0..$a3, HI/LO. Leaf functions,
+# no stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# mxu1_nn_tile field offsets
+  .equ    TILE_ROW,       0
+  .equ    TILE_PIX_STEP,  12
+  .equ    TILE_CP,        16
+  .equ    TILE_K,         20
+  .equ    TILE_WORDS,     24
+  .equ    TILE_W,         28
+  .equ    TILE_COUNT,     32
+  .equ    TILE_NPIX,      36
+  .equ    TILE_ACC,       40
+  .equ    TILE_ACC_STRIDE, 44
+
+# mxu1_nn_requant_params and mxu1_nn_rq field offsets
+  .equ    RQP_OFFSET,     0
+  .equ    RQP_LO,         4
+  .equ    RQP_HI,         8
+  .equ    RQP_CHANNELS,   12
+  .equ    RQP_CH,         16
+  .equ    RQ_MULT,        0
+  .equ    RQ_LSHIFT,      4
+  .equ    RQ_RSHIFT,      8
+  .equ    RQ_MASK,        12
+  .equ    RQ_THRESH,      16
+  .equ    RQ_SIZE,        20
+
+
+################################################################################
+# void mxu1_nn_conv_acc(const mxu1_nn_tile *t)
+#
+#  For each pair of pixels, for each pair of output channels: xr1/xr2 and
+# xr3/xr4 accumulate pixel 0's two channels, xr5/xr6 and xr7/xr8 pixel 1's.
+# A kernel row is one run of t->words words per channel, read at $t5 for
+# pixel 0 and $t5 + pix_step for pixel 1, against the interleaved weights at
+# $a3.
+  .globl  mxu1_nn_conv_acc
+  .type   mxu1_nn_conv_acc, @function
+  .ent    mxu1_nn_conv_acc
+mxu1_nn_conv_acc:
+  lw      $t0,  TILE_PIX_STEP($a0)
+  lw      $t1,  TILE_WORDS($a0)
+  lw      $t2,  TILE_K($a0)
+  lw      $t4,  TILE_NPIX($a0)
+  lw      $a2,  TILE_ACC($a0)
+  lw      $t9,  TILE_ACC_STRIDE($a0)
+  blez    $t4,  9f
+  move    $a1,  $zero                     # Offset of this pixel pair's windows
+
+1:                                        # Pixel pair
+  lw      $a3,  TILE_W($a0)
+  lw      $t3,  TILE_COUNT($a0)
+  move    $v0,  $a2
+  addiu   $a3,  $a3,  -4
+
+2:                                        # Channel pair: biases, then 0
+  s32ldd  xr1,  $a3,  4
+  s32ldd  xr3,  $a3,  8
+  s32ldd  xr5,  $a3,  4
+  s32ldd  xr7,  $a3,  8
+  d32add  xr2,  xr0,  xr0,  xr4,  AA
+  d32add  xr6,  xr0,  xr0,  xr8,  AA
+  addiu   $a3,  $a3,  8
+  move    $t8,  $a0
+  move    $t7,  $t2
+
+3:                                        # Kernel row
+  lw      $t5,  TILE_ROW($t8)
+  addiu   $t8,  $t8,  4
+  move    $t6,  $t1
+  addu    $t5,  $t5,  $a1
+  addiu   $t5,  $t5,  -4
+
+4:                                        # 16 MACs
+  s32ldi  xr11, $a3,  4                   # Channel 0 weights
+  s32ldi  xr12, $a3,  4                   # Channel 1 weights
+  s32ldi  xr9,  $t5,  4                   # Pixel 0 inputs
+  s32lddv xr10, $t5,  $t0,  0             # Pixel 1 inputs
+  q8mulsu xr13, xr11, xr9,  xr14
+  q8mulsu xr15, xr12, xr9,  xr9
+  d16asum xr1,  xr13, xr14, xr2,  AA
+  q8mulsu xr13, xr11, xr10, xr14
+  d16asum xr3,  xr15, xr9,  xr4,  AA
+  q8mulsu xr15, xr12, xr10, xr10
+  addiu   $t6,  $t6,  -1
+  d16asum xr5,  xr13, xr14, xr6,  AA
+  bnez    $t6,  4b
+  d16asum xr7,  xr15, xr10, xr8,  AA
+
+  addiu   $t7,  $t7,  -1
+  bnez    $t7,  3b
+  nop
+
+  d32add  xr1,  xr1,  xr2,  xr2,  AA
+  d32add  xr3,  xr3,  xr4,  xr4,  AA
+  d32add  xr5,  xr5,  xr6,  xr6,  AA
+  d32add  xr7,  xr7,  xr8,  xr8,  AA
+  addu    $v1,  $v0,  $t9
+  s32std  xr1,  $v0,  0
+  s32std  xr3,  $v0,  4
+  s32std  xr5,  $v1,  0
+  s32std  xr7,  $v1,  4
+  addiu   $t3,  $t3,  -1
+  bnez    $t3,  2b
+  addiu   $v0,  $v0,  8
+
+  addiu   $t4,  $t4,  -2
+  sll     $v1,  $t0,  1
+  addu    $a1,  $a1,  $v1
+  sll     $v1,  $t9,  1
+  bgtz    $t4,  1b
+  addu    $a2,  $a2,  $v1
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_nn_conv_acc
+  .size   mxu1_nn_conv_acc, .-mxu1_nn_conv_acc
+
+
+################################################################################
+#  One depthwise tap for both pixels: the tap's weights are in xr11 and the
+# inputs in xr9 (pixel 0) and xr10 (pixel 1). The next tap's weights, at
+# \w($a3), and inputs, at \row + \i0 and \row + \i1, are loaded in between;
+# leave \w blank on the last tap. xr14 holds (1,1).
+.macro DW_TAP w, row, i0, i1
+  q8mulsu xr9,  xr11, xr9,  xr12
+  q8mulsu xr10, xr11, xr10, xr13
+  .ifnb \w
+    s32ldd  xr11, $a3,  \w
+  .endif
+  d16mac  xr1,  xr9,  xr14, xr2,  AA, WW
+  d16mac  xr3,  xr12, xr14, xr4,  AA, WW
+  .ifnb \w
+    s32lddv xr9,  \row, \i0,  0
+  .endif
+  d16mac  xr5,  xr10, xr14, xr6,  AA, WW
+  d16mac  xr7,  xr13, xr14, xr8,  AA, WW
+  .ifnb \w
+    s32lddv xr10, \row, \i1,  0
+  .endif
+.endm
+
+################################################################################
+# void mxu1_nn_dw_acc(const mxu1_nn_tile *t)
+#
+#  For each group of 4 channels, for each pair of pixels: pixel 0's channels
+# 3..0 accumulate in xr1..xr4, pixel 1's in xr5..xr8. $t2..$t4 point at the
+# group's bytes in the three kernel rows of pixel 0's window; the taps are at
+# offsets 0, cp and 2*cp from there ($zero, $t5, $t6) and pixel 1's at
+# pix_step more ($t7, $t8, $t9).
+  .globl  mxu1_nn_dw_acc
+  .type   mxu1_nn_dw_acc, @function
+  .ent    mxu1_nn_dw_acc
+mxu1_nn_dw_acc:
+  lw      $t5,  TILE_CP($a0)
+  lw      $t7,  TILE_PIX_STEP($a0)
+  lw      $t0,  TILE_COUNT($a0)
+  lw      $a3,  TILE_W($a0)
+  lw      $a2,  TILE_ACC($a0)
+  sll     $t6,  $t5,  1
+  addu    $t8,  $t7,  $t5
+  addu    $t9,  $t7,  $t6
+  li      $v1,  0x00010001
+  s32i2m  xr14, $v1
+  blez    $t0,  9f
+  move    $v0,  $zero                     # Byte offset of the group
+
+1:                                        # Group of 4 channels
+  lw      $t2,  TILE_ROW($a0)
+  lw      $t3,  TILE_ROW + 4($a0)
+  lw      $t4,  TILE_ROW + 8($a0)
+  lw      $t1,  TILE_NPIX($a0)
+  move    $a1,  $a2
+  addu    $t2,  $t2,  $v0
+  addu    $t3,  $t3,  $v0
+  addu    $t4,  $t4,  $v0
+
+2:                                        # Pixel pair
+  s32ldd  xr11, $a3,  16
+  s32ldd  xr9,  $t2,  0
+  s32lddv xr10, $t2,  $t7,  0
+  s32ldd  xr4,  $a3,  0
+  s32ldd  xr3,  $a3,  4
+  s32ldd  xr2,  $a3,  8
+  s32ldd  xr1,  $a3,  12
+  s32ldd  xr8,  $a3,  0
+  s32ldd  xr7,  $a3,  4
+  s32ldd  xr6,  $a3,  8
+  s32ldd  xr5,  $a3,  12
+  DW_TAP  20, $t2, $t5, $t8
+  DW_TAP  24, $t2, $t6, $t9
+  DW_TAP  28, $t3, $zero, $t7
+  DW_TAP  32, $t3, $t5, $t8
+  DW_TAP  36, $t3, $t6, $t9
+  DW_TAP  40, $t4, $zero, $t7
+  DW_TAP  44, $t4, $t5, $t8
+  DW_TAP  48, $t4, $t6, $t9
+  DW_TAP
+
+  lw      $v1,  TILE_ACC_STRIDE($a0)
+  s32std  xr4,  $a1,  0
+  s32std  xr3,  $a1,  4
+  s32std  xr2,  $a1,  8
+  s32std  xr1,  $a1,  12
+  addu    $a1,  $a1,  $v1
+  s32std  xr8,  $a1,  0
+  s32std  xr7,  $a1,  4
+  s32std  xr6,  $a1,  8
+  s32std  xr5,  $a1,  12
+  addu    $a1,  $a1,  $v1
+  addu    $t2,  $t2,  $t7
+  addu    $t3,  $t3,  $t7
+  addu    $t4,  $t4,  $t7
+  addu    $t2,  $t2,  $t7
+  addu    $t3,  $t3,  $t7
+  addiu   $t1,  $t1,  -2
+  bgtz    $t1,  2b
+  addu    $t4,  $t4,  $t7
+
+  addiu   $t0,  $t0,  -1
+  addiu   $a3,  $a3,  52
+  addiu   $a2,  $a2,  16
+  bnez    $t0,  1b
+  addiu   $v0,  $v0,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_nn_dw_acc
+  .size   mxu1_nn_dw_acc, .-mxu1_nn_dw_acc
+
+
+################################################################################
+#  Requantize the accumulator at ($a1) with the channel parameters at ($t2),
+# plus the output offset ($t0), into \xr; advances both pointers. $t9 = 2^30,
+#  $v1 = 1.
+.macro RQ1 xr
+  lw      $t4,  0($a1)
+  lw      $t5,  RQ_LSHIFT($t2)
+  lw      $t6,  RQ_MULT($t2)
+  multu   $t9,  $v1                       # {HI:LO} = 2^30
+  sllv    $t4,  $t4,  $t5
+  lw      $t5,  RQ_RSHIFT($t2)
+  madd    $t4,  $t6                       # {HI:LO} += x * mult
+  lw      $t6,  RQ_MASK($t2)
+  lw      $t7,  RQ_THRESH($t2)
+  mfhi    $t4
+  mflo    $t8
+  sll     $t4,  $t4,  1
+  srl     $t8,  $t8,  31
+  or      $t4,  $t4,  $t8                 # v = {HI:LO} >> 31
+  srl     $t8,  $t4,  31
+  addu    $t7,  $t7,  $t8                 # Threshold, +1 if v < 0
+  and     $t8,  $t4,  $t6                 # Remainder
+  srav    $t4,  $t4,  $t5
+  slt     $t8,  $t7,  $t8
+  addu    $t4,  $t4,  $t8
+  addu    $t4,  $t4,  $t0
+  s32i2m  \xr,  $t4
+  addiu   $a1,  $a1,  4
+  addiu   $t2,  $t2,  RQ_SIZE
+.endm
+
+################################################################################
+# void mxu1_nn_requant(int8_t *dst, const int32_t *acc, int npix,
+#                      const mxu1_nn_requant_params *q)
+  .globl  mxu1_nn_requant
+  .type   mxu1_nn_requant, @function
+  .ent    mxu1_nn_requant
+mxu1_nn_requant:
+  lw      $t0,  RQP_OFFSET($a3)
+  lw      $v0,  RQP_LO($a3)
+  lw      $v1,  RQP_HI($a3)
+  lw      $t1,  RQP_CHANNELS($a3)
+  s32i2m  xr13, $v0
+  s32i2m  xr14, $v1
+  li      $v0,  0x80808080
+  s32i2m  xr15, $v0
+  lui     $t9,  0x4000
+  li      $v1,  1
+  blez    $a2,  9f
+  srl     $t1,  $t1,  2                   # Groups of 4 channels
+
+1:                                        # Pixel
+  lw      $t2,  RQP_CH($a3)
+  move    $t3,  $t1
+
+2:                                        # 4 channels
+  RQ1     xr1
+  RQ1     xr2
+  RQ1     xr3
+  RQ1     xr4
+  s32max  xr1,  xr1,  xr13
+  s32max  xr2,  xr2,  xr13
+  s32max  xr3,  xr3,  xr13
+  s32max  xr4,  xr4,  xr13
+  s32min  xr1,  xr1,  xr14
+  s32min  xr2,  xr2,  xr14
+  s32min  xr3,  xr3,  xr14
+  s32min  xr4,  xr4,  xr14
+  d32sarl xr5,  xr4,  xr3,  0             # (ch3, ch2)
+  d32sarl xr6,  xr2,  xr1,  0             # (ch1, ch0)
+  q16sat  xr7,  xr5,  xr6
+  s32xor  xr7,  xr7,  xr15
+  addiu   $t3,  $t3,  -1
+  s32std  xr7,  $a0,  0
+  bnez    $t3,  2b
+  addiu   $a0,  $a0,  4
+
+  addiu   $a2,  $a2,  -1
+  bnez    $a2,  1b
+  nop
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_nn_requant
+  .size   mxu1_nn_requant, .-mxu1_nn_requant
+
+# vim:shiftwidth=2:expandtab:syntax=asm
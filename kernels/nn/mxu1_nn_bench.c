@@ -0,0 +1,221 @@
+// mxu1_nn_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 int8 CNN layers: bit-exactness check and throughput
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Builds the layers of a small MobileNet-style network (a strided 3x3
+// convolution from RGB, depthwise + pointwise pairs, and a plain 3x3
+// convolution) with random weights, biases, inputs and per-channel scales,
+// checks that mxu1_nn_run() and mxu1_nn_run_c() both reproduce the reference
+// runtime (mxu1_nn_run_ref()) byte for byte, and prints each layer's
+// throughput in millions of multiply-accumulates per second for the three.
+//
+// Build and run on the target (kernels/nn):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_nn_bench
+//         mxu1_nn_bench.c mxu1_nn_layer.c mxu1_nn_ref.c mxu1_nn.s
+//         ../dispatch/mxu1_cpu.c -lm
+//     ./mxu1_nn_bench [seconds per test, default 1]
+// Exits non-zero if any output differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_nn.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static int rand_in(int lo, int hi)
+{
+  rng = rng * 1103515245u + 12345u;
+  return lo + (int)((rng >> 8) % (uint32_t)(hi - lo + 1));
+}
+
+// TFLite's QuantizeMultiplier()
+static void quantize_multiplier(double scale, int32_t *mult, int32_t *shift)
+{
+  int exp;
+  int64_t q;
+  if (scale == 0) {
+    *mult = *shift = 0;
+    return;
+  }
+  q = llround(frexp(scale, &exp) * (1ll << 31));
+  if (q == (1ll << 31)) {
+    q /= 2;
+    ++exp;
+  }
+  *mult = (int32_t)q;
+  *shift = exp;
+}
+
+typedef struct {
+  const char    *name;
+  mxu1_nn_layer  l;
+  int8_t        *weights, *in, *out_ref, *out_c, *out_mxu;
+  int32_t       *bias, *mult, *shift;
+  void          *packed, *scratch;
+  double         macs;
+} bench_layer;
+
+static void *xalloc(size_t n)
+{
+  void *p = malloc(n ? n : 1);
+  if (!p) {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  return p;
+}
+
+static void setup(bench_layer *b)
+{
+  mxu1_nn_layer *l = &b->l;
+  const int k = l->op == MXU1_NN_POINTWISE ? 1 : 3;
+  const int dw = l->op == MXU1_NN_DEPTHWISE3X3;
+  const int out_c = dw ? l->in_c : l->out_c;
+  const int n_w = dw ? 9 * l->in_c : out_c * k * k * l->in_c;
+  const int n_in = l->in_h * l->in_w * l->in_c;
+  const int n_out = mxu1_nn_out_h(l) * mxu1_nn_out_w(l) * out_c;
+
+  b->weights = xalloc(n_w);
+  b->in = xalloc(n_in);
+  b->out_ref = xalloc(n_out);
+  b->out_c = xalloc(n_out);
+  b->out_mxu = xalloc(n_out);
+  b->bias = xalloc(out_c * sizeof(int32_t));
+  b->mult = xalloc(out_c * sizeof(int32_t));
+  b->shift = xalloc(out_c * sizeof(int32_t));
+
+  for (int i = 0; i < n_w; ++i)
+    b->weights[i] = (int8_t)rand_in(-127, 127);
+  for (int i = 0; i < n_in; ++i)
+    b->in[i] = (int8_t)rand_in(-128, 127);
+  for (int c = 0; c < out_c; ++c) {
+    // Scale the sum's spread (about 74 * sqrt(terms)) to about +-64
+    const double spread = 74.0 * sqrt((double)(dw ? 9 : k * k * l->in_c));
+    b->bias[c] = rand_in(-2000, 2000);
+    quantize_multiplier(64.0 / spread * rand_in(50, 150) / 100.0,
+                        &b->mult[c], &b->shift[c]);
+  }
+  l->in_zp = rand_in(-20, 20);
+  l->out_zp = rand_in(-20, 20);
+  l->act_min = l->out_zp;             // ReLU
+  l->act_max = 127;
+  l->mult = b->mult;
+  l->shift = b->shift;
+
+  b->packed = xalloc(mxu1_nn_packed_size(l));
+  b->scratch = xalloc(mxu1_nn_scratch_size(l));
+  mxu1_nn_pack(b->packed, l, b->weights, b->bias);
+  b->macs = (double)mxu1_nn_out_h(l) * mxu1_nn_out_w(l) * out_c *
+            (dw ? 9 : k * k * l->in_c);
+}
+
+static void run_ref(bench_layer *b)
+{
+  mxu1_nn_run_ref(&b->l, b->weights, b->bias, b->in, b->out_ref);
+}
+static void run_c(bench_layer *b)
+{
+  mxu1_nn_run_c(&b->l, b->packed, b->in, b->out_c, b->scratch);
+}
+static void run_mxu(bench_layer *b)
+{
+  mxu1_nn_run(&b->l, b->packed, b->in, b->out_mxu, b->scratch);
+}
+
+static double mmacs(void (*f)(bench_layer *), bench_layer *b, double secs)
+{
+  unsigned long n = 0;
+  double t0 = now(), t;
+
+  do {
+    f(b);
+    ++n;
+    t = now() - t0;
+  } while (t < secs);
+  return b->macs * n / t * 1e-6;
+}
+
+int main(int argc, char **argv)
+{
+  // Designated, so the zero points, clamps and buffers setup() fills in
+  // stay zero here without tripping -Wmissing-field-initializers
+#define LAYER(NAME, OP, H, W, IC, OC, S, SAME)                                \
+    { .name = NAME, .l = { .op = OP, .in_h = H, .in_w = W, .in_c = IC,        \
+                           .out_c = OC, .stride = S, .same = SAME } }
+  //                         op                   in_h in_w in_c out_c stride same
+  static bench_layer layers[] = {
+    LAYER("conv3x3/2 3->32", MXU1_NN_CONV3X3,      96, 96,   3,  32, 2, 1),
+    LAYER("dw3x3 32",        MXU1_NN_DEPTHWISE3X3, 48, 48,  32,  32, 1, 1),
+    LAYER("pw 32->64",       MXU1_NN_POINTWISE,    48, 48,  32,  64, 1, 0),
+    LAYER("dw3x3/2 64",      MXU1_NN_DEPTHWISE3X3, 48, 48,  64,  64, 2, 1),
+    LAYER("pw 64->128",      MXU1_NN_POINTWISE,    24, 24,  64, 128, 1, 0),
+    LAYER("conv3x3 32->32",  MXU1_NN_CONV3X3,      24, 24,  32,  32, 1, 1),
+  };
+#undef LAYER
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  int failed = 0;
+
+  mxu1_cpu_enable();
+
+  printf("layer                MMAC/s: MXU        C   reference  (MXU vs reference)\n");
+  for (unsigned i = 0; i < sizeof(layers) / sizeof(layers[0]); ++i) {
+    bench_layer *b = &layers[i];
+    const mxu1_nn_layer *l = &b->l;
+    const size_t n_out = (size_t)mxu1_nn_out_h(l) * mxu1_nn_out_w(l) *
+                         (l->op == MXU1_NN_DEPTHWISE3X3 ? l->in_c : l->out_c);
+    double m, c, r;
+
+    setup(b);
+    run_ref(b);
+    run_c(b);
+    run_mxu(b);
+    if (memcmp(b->out_c, b->out_ref, n_out) || memcmp(b->out_mxu, b->out_ref, n_out)) {
+      printf("%-20s MISMATCH against the reference (C %s, MXU %s)\n", b->name,
+             memcmp(b->out_c, b->out_ref, n_out) ? "differs" : "ok",
+             memcmp(b->out_mxu, b->out_ref, n_out) ? "differs" : "ok");
+      failed = 1;
+      continue;
+    }
+    m = mmacs(run_mxu, b, secs);
+    c = mmacs(run_c, b, secs);
+    r = mmacs(run_ref, b, secs);
+    printf("%-20s %12.1f %8.1f %11.1f  x%.2f\n", b->name, m, c, r, m / r);
+  }
+
+  return failed;
+}
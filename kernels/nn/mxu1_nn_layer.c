@@ -0,0 +1,307 @@
+// mxu1_nn_layer.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 int8 CNN layer drivers: packing and tiling
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Layers are computed one output row at a time. The k input rows a row
+// needs are held, converted to offset binary and padded, in a ring of k row
+// buffers at the start of the scratch space (input row y lives in slot y % k,
+// so each row is converted once, also at stride 2). A row is then cut into
+// tiles of 'npix' pixels, and each tile's output channels into blocks whose
+// packed weights fill half the L1 data cache: the block's weights are read
+// once per pixel pair, the tile's input windows once per channel pair, and
+// the tile's accumulators, a quarter of the cache, are requantized in one go.
+//
+//  The driver is written once, against a table of kernels, so that
+// mxu1_nn_run_c() is the same computation on the C kernels.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "mxu1_nn.h"
+
+typedef struct {
+  void (*conv_acc)(const mxu1_nn_tile *t);
+  void (*dw_acc)(const mxu1_nn_tile *t);
+  void (*requant)(int8_t *dst, const int32_t *acc, int npix,
+                  const mxu1_nn_requant_params *q);
+} nn_kernels;
+
+static const nn_kernels kernels_mxu = {
+  mxu1_nn_conv_acc, mxu1_nn_dw_acc, mxu1_nn_requant
+};
+
+static const nn_kernels kernels_c = {
+  mxu1_nn_conv_acc_c, mxu1_nn_dw_acc_c, mxu1_nn_requant_c
+};
+
+typedef struct {
+  int k;                    // Kernel size, 3 or 1
+  int cp;                   // Input channels, rounded up to 4
+  int out_c;
+  int out_h, out_w;
+  int pad_t, pad_l;         // Zero-point rows above, columns to the left
+  int pw;                   // Padded input row, pixels (room for an even tile)
+  int npix;                 // Tile, pixels (even)
+  int block;                // Output channels per block (multiple of 4)
+  int chan_bytes;           // Packed bytes per output channel
+} nn_geom;
+
+static int kernel_size(const mxu1_nn_layer *l)
+{
+  return l->op == MXU1_NN_POINTWISE ? 1 : 3;
+}
+
+static int out_size(int in, int stride, int k, int same)
+{
+  return same ? (in + stride - 1) / stride : (in - k + stride) / stride;
+}
+
+int mxu1_nn_out_h(const mxu1_nn_layer *l)
+{
+  return out_size(l->in_h, l->stride, kernel_size(l), l->same);
+}
+
+int mxu1_nn_out_w(const mxu1_nn_layer *l)
+{
+  return out_size(l->in_w, l->stride, kernel_size(l), l->same);
+}
+
+static int pad_before(int in, int out, int stride, int k)
+{
+  const int total = (out - 1) * stride + k - in;
+  return total > 0 ? total / 2 : 0;
+}
+
+static void get_geom(const mxu1_nn_layer *l, nn_geom *g)
+{
+  const int s = l->stride;
+  g->k = kernel_size(l);
+  g->cp = (l->in_c + 3) & ~3;
+  g->out_c = l->op == MXU1_NN_DEPTHWISE3X3 ? l->in_c : l->out_c;
+  g->out_h = mxu1_nn_out_h(l);
+  g->out_w = mxu1_nn_out_w(l);
+  g->pad_t = pad_before(l->in_h, g->out_h, s, g->k);
+  g->pad_l = pad_before(l->in_w, g->out_w, s, g->k);
+
+  // Tile: accumulators and input windows a quarter of L1 each
+  const int even_w = (g->out_w + 1) & ~1;
+  int n = MXU1_NN_L1_BYTES / 4 / (g->out_c * 4);
+  const int n_in = (MXU1_NN_L1_BYTES / 4 / (g->k * g->cp) - g->k) / s + 1;
+  if (n_in < n)
+    n = n_in;
+  n &= ~1;
+  g->npix = n < 2 ? 2 : n > even_w ? even_w : n;
+  g->pw = (even_w - 1) * s + g->k;
+
+  // Channel block: packed weights half of L1
+  if (l->op == MXU1_NN_DEPTHWISE3X3) {
+    g->chan_bytes = 13;
+    g->block = g->out_c;
+  } else {
+    g->chan_bytes = 4 + g->k * g->k * g->cp;
+    const int b = (MXU1_NN_L1_BYTES / 2 / g->chan_bytes) & ~3;
+    g->block = b < 4 ? 4 : b > g->out_c ? g->out_c : b;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Packing
+////////////////////////////////////////////////////////////////////////////////
+
+size_t mxu1_nn_packed_size(const mxu1_nn_layer *l)
+{
+  nn_geom g;
+  get_geom(l, &g);
+  return g.out_c * (sizeof(mxu1_nn_rq) + g.chan_bytes);
+}
+
+void mxu1_nn_pack(void *packed, const mxu1_nn_layer *l,
+                  const int8_t *weights, const int32_t *bias)
+{
+  nn_geom g;
+  get_geom(l, &g);
+  const int k = g.k, in_c = l->in_c;
+  // Offset binary inputs add (128 + in_zp) * sum of weights to each sum
+  const uint32_t fold = (uint32_t)(128 + l->in_zp);
+
+  mxu1_nn_rq *rq = (mxu1_nn_rq *)packed;
+  for (int c = 0; c < g.out_c; ++c, ++rq) {
+    const int shift = l->shift[c];
+    rq->mult = l->mult[c];
+    rq->lshift = shift > 0 ? shift : 0;
+    rq->rshift = shift > 0 ? 0 : -shift;
+    rq->mask = (int32_t)(((int64_t)1 << rq->rshift) - 1);
+    rq->thresh = rq->mask >> 1;
+  }
+
+  int32_t *w32 = (int32_t *)rq;
+  if (l->op == MXU1_NN_DEPTHWISE3X3) {
+    for (int c0 = 0; c0 < g.out_c; c0 += 4, w32 += 13) {
+      int8_t *w8 = (int8_t *)(w32 + 4);
+      for (int i = 0; i < 4; ++i) {
+        uint32_t sum = 0;
+        for (int t = 0; t < 9; ++t) {
+          w8[t * 4 + i] = weights[t * in_c + c0 + i];
+          sum += (uint32_t)weights[t * in_c + c0 + i];
+        }
+        w32[i] = (int32_t)((bias ? (uint32_t)bias[c0 + i] : 0) - fold * sum);
+      }
+    }
+    return;
+  }
+
+  const int words = k * g.cp / 4;
+  for (int c0 = 0; c0 < g.out_c; c0 += 2) {
+    for (int i = 0; i < 2; ++i) {
+      const int8_t *w = weights + (c0 + i) * k * k * in_c;
+      uint32_t sum = 0;
+      for (int j = 0; j < k * k * in_c; ++j)
+        sum += (uint32_t)w[j];
+      *w32++ = (int32_t)((bias ? (uint32_t)bias[c0 + i] : 0) - fold * sum);
+    }
+    int8_t *w8 = (int8_t *)w32;
+    for (int r = 0; r < k; ++r)
+      for (int j = 0; j < words; ++j)
+        for (int i = 0; i < 2; ++i)
+          for (int b = 0; b < 4; ++b) {
+            const int x = (j * 4 + b) / g.cp, ci = (j * 4 + b) % g.cp;
+            *w8++ = ci < in_c ? weights[(((c0 + i) * k + r) * k + x) * in_c + ci] : 0;
+          }
+    w32 = (int32_t *)w8;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Running
+////////////////////////////////////////////////////////////////////////////////
+
+size_t mxu1_nn_scratch_size(const mxu1_nn_layer *l)
+{
+  nn_geom g;
+  get_geom(l, &g);
+  return (size_t)g.k * g.pw * g.cp + (size_t)g.npix * g.out_c * 4;
+}
+
+//  Convert padded input row 'y' (in padded coordinates) to offset binary
+static void load_row(uint8_t *dst, const mxu1_nn_layer *l, const nn_geom *g,
+                     int y, const int8_t *in)
+{
+  const uint8_t fill = (uint8_t)(l->in_zp + 128);
+  const int iy = y - g->pad_t;
+  int x0 = g->pad_l, x1 = g->pad_l + l->in_w;   // Columns holding input
+  if (iy < 0 || iy >= l->in_h)
+    x0 = x1 = g->pw;
+  if (x1 > g->pw)
+    x1 = g->pw;
+
+  memset(dst, fill, (size_t)x0 * g->cp);
+  const int8_t *src = in + (x0 < x1 ? (size_t)iy * l->in_w * l->in_c : 0);
+  if (g->cp == l->in_c) {
+    const uint32_t *s32 = (const uint32_t *)src;
+    uint32_t *d32 = (uint32_t *)(dst + x0 * g->cp);
+    for (int i = 0; i < (x1 - x0) * g->cp / 4; ++i)
+      d32[i] = s32[i] ^ 0x80808080u;
+  } else {
+    for (int x = x0; x < x1; ++x, src += l->in_c) {
+      uint8_t *d = dst + x * g->cp;
+      for (int c = 0; c < l->in_c; ++c)
+        d[c] = (uint8_t)src[c] ^ 0x80;
+      memset(d + l->in_c, fill, g->cp - l->in_c);
+    }
+  }
+  memset(dst + x1 * g->cp, fill, (size_t)(g->pw - x1) * g->cp);
+}
+
+static void run(const mxu1_nn_layer *l, const void *packed, const int8_t *in,
+                int8_t *out, void *scratch, const nn_kernels *kn)
+{
+  nn_geom g;
+  get_geom(l, &g);
+  const int k = g.k, s = l->stride;
+  const size_t row_bytes = (size_t)g.pw * g.cp;
+  uint8_t *ring = (uint8_t *)scratch;
+  int32_t *acc = (int32_t *)(ring + k * row_bytes);
+  int ring_row[3] = { -1, -1, -1 };
+
+  const mxu1_nn_rq *rq = (const mxu1_nn_rq *)packed;
+  const uint8_t *w = (const uint8_t *)(rq + g.out_c);
+  const mxu1_nn_requant_params q = {
+    l->out_zp + 128, l->act_min + 128, l->act_max + 128, g.out_c, rq
+  };
+
+  mxu1_nn_tile t;
+  t.pix_step = s * g.cp;
+  t.cp = g.cp;
+  t.k = k;
+  t.words = k * g.cp / 4;
+  t.acc_stride = g.out_c * 4;
+
+  for (int oy = 0; oy < g.out_h; ++oy) {
+    const uint8_t *rows[3];
+    for (int r = 0; r < k; ++r) {
+      const int y = oy * s + r, slot = y % k;
+      if (ring_row[slot] != y) {
+        load_row(ring + slot * row_bytes, l, &g, y, in);
+        ring_row[slot] = y;
+      }
+      rows[r] = ring + slot * row_bytes;
+    }
+
+    for (int ox = 0; ox < g.out_w; ox += g.npix) {
+      const int n = g.out_w - ox < g.npix ? g.out_w - ox : g.npix;
+      for (int r = 0; r < k; ++r)
+        t.row[r] = rows[r] + ox * t.pix_step;
+      t.npix = (n + 1) & ~1;
+      if (l->op == MXU1_NN_DEPTHWISE3X3) {
+        t.w = w;
+        t.count = g.out_c / 4;
+        t.acc = acc;
+        kn->dw_acc(&t);
+      } else {
+        for (int c0 = 0; c0 < g.out_c; c0 += g.block) {
+          const int nc = g.out_c - c0 < g.block ? g.out_c - c0 : g.block;
+          t.w = w + c0 * g.chan_bytes;
+          t.count = nc / 2;
+          t.acc = acc + c0;
+          kn->conv_acc(&t);
+        }
+      }
+      kn->requant(out + ((size_t)oy * g.out_w + ox) * g.out_c, acc, n, &q);
+    }
+  }
+}
+
+void mxu1_nn_run(const mxu1_nn_layer *l, const void *packed,
+                 const int8_t *in, int8_t *out, void *scratch)
+{
+  run(l, packed, in, out, scratch, &kernels_mxu);
+}
+
+void mxu1_nn_run_c(const mxu1_nn_layer *l, const void *packed,
+                   const int8_t *in, int8_t *out, void *scratch)
+{
+  run(l, packed, in, out, scratch, &kernels_c);
+}
@@ -0,0 +1,173 @@
+// mxu1_nn_ref.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 int8 CNN kernels: C references and reference runtime
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Two kinds of reference here:
+//   - C versions of the kernels in mxu1_nn.s, with identical arguments and
+//     results, used by mxu1_nn_run_c() and as the fallback without MXU;
+//   - mxu1_nn_run_ref(), written independently of all the above from
+//     TFLite's reference_integer_ops ConvPerChannel() and
+//     DepthwiseConvPerChannel(), against which whole layers are checked.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_nn.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels
+////////////////////////////////////////////////////////////////////////////////
+
+// Sums are formed in uint32_t, wrapping as the MXU accumulators do.
+
+void mxu1_nn_conv_acc_c(const mxu1_nn_tile *t)
+{
+  for (int p = 0; p < t->npix; ++p) {
+    const uint8_t *w = (const uint8_t *)t->w;
+    int32_t *acc = t->acc + p * (t->acc_stride / 4);
+    for (int pair = 0; pair < t->count; ++pair) {
+      const int32_t *bias = (const int32_t *)w;
+      uint32_t a0 = (uint32_t)bias[0], a1 = (uint32_t)bias[1];
+      w += 8;
+      for (int r = 0; r < t->k; ++r) {
+        const uint8_t *in = t->row[r] + p * t->pix_step;
+        for (int j = 0; j < t->words; ++j, w += 8, in += 4)
+          for (int b = 0; b < 4; ++b) {
+            a0 += (uint32_t)((int8_t)w[b] * in[b]);
+            a1 += (uint32_t)((int8_t)w[4 + b] * in[b]);
+          }
+      }
+      acc[2 * pair]     = (int32_t)a0;
+      acc[2 * pair + 1] = (int32_t)a1;
+    }
+  }
+}
+
+void mxu1_nn_dw_acc_c(const mxu1_nn_tile *t)
+{
+  for (int g = 0; g < t->count; ++g) {
+    const int32_t *bias = (const int32_t *)t->w + g * 13;
+    const int8_t *w = (const int8_t *)(bias + 4);
+    for (int p = 0; p < t->npix; ++p) {
+      int32_t *acc = t->acc + p * (t->acc_stride / 4) + g * 4;
+      for (int c = 0; c < 4; ++c) {
+        uint32_t a = (uint32_t)bias[c];
+        for (int r = 0; r < 3; ++r) {
+          const uint8_t *in = t->row[r] + p * t->pix_step + g * 4 + c;
+          for (int x = 0; x < 3; ++x)
+            a += (uint32_t)(w[(r * 3 + x) * 4 + c] * in[x * t->cp]);
+        }
+        acc[c] = (int32_t)a;
+      }
+    }
+  }
+}
+
+static int32_t requant1(int32_t x, const mxu1_nn_rq *r)
+{
+  const int32_t xs = (int32_t)((uint32_t)x << r->lshift);
+  const int32_t v = (int32_t)(((int64_t)xs * r->mult + (1 << 30)) >> 31);
+  const int32_t thresh = r->thresh + (v < 0);
+  return (v >> r->rshift) + ((v & r->mask) > thresh);
+}
+
+void mxu1_nn_requant_c(int8_t *dst, const int32_t *acc, int npix,
+                       const mxu1_nn_requant_params *q)
+{
+  for (int p = 0; p < npix; ++p)
+    for (int c = 0; c < q->channels; ++c) {
+      int32_t v = requant1(*acc++, &q->ch[c]) + q->offset;
+      v = v < q->lo ? q->lo : v > q->hi ? q->hi : v;
+      *dst++ = (int8_t)(v - 128);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reference int8 runtime
+////////////////////////////////////////////////////////////////////////////////
+
+// gemmlowp's SaturatingRoundingDoublingHighMul()
+static int32_t srdhm(int32_t a, int32_t b)
+{
+  if (a == b && a == INT32_MIN)
+    return INT32_MAX;
+  const int64_t ab = (int64_t)a * b;
+  const int32_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+  return (int32_t)((ab + nudge) / ((int64_t)1 << 31));
+}
+
+// gemmlowp's RoundingDivideByPOT()
+static int32_t rdbpot(int32_t x, int exponent)
+{
+  const int32_t mask = (int32_t)(((int64_t)1 << exponent) - 1);
+  const int32_t remainder = x & mask;
+  const int32_t threshold = (mask >> 1) + (x < 0);
+  return (x >> exponent) + (remainder > threshold);
+}
+
+// TFLite's MultiplyByQuantizedMultiplier()
+static int32_t mbqm(int32_t x, int32_t mult, int shift)
+{
+  const int left = shift > 0 ? shift : 0, right = shift > 0 ? 0 : -shift;
+  return rdbpot(srdhm((int32_t)((uint32_t)x << left), mult), right);
+}
+
+void mxu1_nn_run_ref(const mxu1_nn_layer *l, const int8_t *weights,
+                     const int32_t *bias, const int8_t *in, int8_t *out)
+{
+  const int k = l->op == MXU1_NN_POINTWISE ? 1 : 3;
+  const int out_h = mxu1_nn_out_h(l), out_w = mxu1_nn_out_w(l);
+  const int pad_t = ((out_h - 1) * l->stride + k - l->in_h) / 2;
+  const int pad_l = ((out_w - 1) * l->stride + k - l->in_w) / 2;
+  const int dw = l->op == MXU1_NN_DEPTHWISE3X3;
+  const int in_c = l->in_c, out_c = dw ? in_c : l->out_c;
+
+  for (int oy = 0; oy < out_h; ++oy)
+    for (int ox = 0; ox < out_w; ++ox)
+      for (int oc = 0; oc < out_c; ++oc) {
+        int32_t acc = 0;
+        for (int ky = 0; ky < k; ++ky)
+          for (int kx = 0; kx < k; ++kx) {
+            const int iy = oy * l->stride - (pad_t > 0 ? pad_t : 0) + ky;
+            const int ix = ox * l->stride - (pad_l > 0 ? pad_l : 0) + kx;
+            if (iy < 0 || iy >= l->in_h || ix < 0 || ix >= l->in_w)
+              continue;
+            const int8_t *px = in + (iy * l->in_w + ix) * in_c;
+            if (dw) {
+              acc += (px[oc] - l->in_zp) * weights[(ky * 3 + kx) * in_c + oc];
+            } else {
+              const int8_t *w = weights + ((oc * k + ky) * k + kx) * in_c;
+              for (int ic = 0; ic < in_c; ++ic)
+                acc += (px[ic] - l->in_zp) * w[ic];
+            }
+          }
+        if (bias)
+          acc += bias[oc];
+        acc = mbqm(acc, l->mult[oc], l->shift[oc]) + l->out_zp;
+        acc = acc < l->act_min ? l->act_min : acc;
+        acc = acc > l->act_max ? l->act_max : acc;
+        *out++ = (int8_t)acc;
+      }
+}
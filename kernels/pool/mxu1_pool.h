@@ -0,0 +1,138 @@
+// mxu1_pool.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 context save/restore and tiling thread pool
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Running kernels on more than one core, and more than one task on a core:
+//   - MXU contexts: xr1..xr15 and MXU_CR (xr16) saved to and restored from
+//     memory (mxu1_pool.s, built on the mxu_save_context and
+//     mxu_restore_context macros of mxu1_as_macros.s.h), and a lazy switch
+//     for cooperative tasks or coroutines sharing one thread;
+//   - a pool of threads (mxu1_pool_tiles.c) that splits a job of numbered
+//     tiles, or a rectangle cut into tiles, across the cores, with work
+//     stealing to even out tiles of uneven cost.
+//
+//  The kernel does not know about the MXU in cooperative code: switching
+// tasks on one thread leaves the registers of whichever ran last. A task
+// that keeps values in xr registers across a switch (a coroutine yielding
+// mid-row, say) either saves and restores them around it, or calls
+// mxu1_context_claim() with its own context before its MXU code. A claim
+// saves the registers of the thread's previous claimant, if another, and
+// loads the claimant's own: tasks that never touch the MXU cost nothing,
+// and neither does a task claiming again with nobody in between.
+//
+//  Threads are another matter: each has its own MXU registers only when the
+// kernel switches them with the thread (Ingenic's kernels do). The pool's
+// workers start with a copy of the MXU state of the thread that created the
+// pool, so the MXU is enabled in them as it is there.
+//
+//  A job is 'tiles' calls of fn(arg, tile, worker), tile 0 .. tiles - 1,
+// worker the index (0 .. threads - 1) of the thread making the call, for
+// per-thread scratch buffers; the calling thread is worker 0 and takes a
+// share. Each worker starts on a contiguous run of tiles, so neighbouring
+// tiles (rows of an image) stay on one core; one that runs out takes the
+// later half of another's remaining run. The calls of a job may run in any
+// order and at once, so tiles must not write what other tiles read.
+//
+// Build (kernels/pool, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_pool.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -pthread -c mxu1_pool_tiles.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_POOL_H
+#define MXU1_POOL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// MXU contexts (mxu1_pool.s, mxu1_pool_tiles.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  xr[i] is xri, xr[16] MXU_CR; xr[0] is unused (xr0 always reads zero).
+// The layout of mxu_save_context's MXU_CONTEXT_SIZE bytes.
+typedef struct {
+  uint32_t xr[17];
+} mxu1_context;
+
+void mxu1_context_save(mxu1_context *ctx);
+void mxu1_context_restore(const mxu1_context *ctx);
+
+//  Saves the registers to 'save', then restores them from 'load'
+void mxu1_context_switch(mxu1_context *save, const mxu1_context *load);
+
+//  A fresh context: every register zero, the MXU enabled (MXU_CR = 1,
+// MXU_EN alone, rounding off, as mxu1_cpu_enable() leaves it)
+void mxu1_context_init(mxu1_context *ctx);
+
+//  Makes 'ctx' the one the calling thread's registers belong to (see
+// above), then returns with them holding it. Call mxu1_context_release()
+// before 'ctx' goes away.
+void mxu1_context_claim(mxu1_context *ctx);
+void mxu1_context_release(mxu1_context *ctx);
+
+////////////////////////////////////////////////////////////////////////////////
+// Thread pool (mxu1_pool_tiles.c)
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct mxu1_pool mxu1_pool;
+
+typedef void (*mxu1_pool_fn)(void *arg, int tile, int worker);
+
+//  A rectangle of a job of mxu1_pool_tiles()
+typedef struct {
+  int x, y, width, height;
+} mxu1_tile;
+
+typedef void (*mxu1_tile_fn)(void *arg, const mxu1_tile *tile, int worker);
+
+//  A pool of 'threads' workers, the caller of mxu1_pool_run() included
+// (threads - 1 are started), or with threads <= 0 one per online CPU. With
+// 'mxu' nonzero the workers copy the calling thread's MXU context, which
+// must then have the MXU enabled. NULL if a thread could not be started or
+// memory allocated.
+mxu1_pool *mxu1_pool_create(int threads, int mxu);
+void mxu1_pool_destroy(mxu1_pool *pool);
+int mxu1_pool_threads(const mxu1_pool *pool);
+
+//  Runs fn(arg, tile, worker) for every tile in 0 .. tiles - 1 and returns
+// when all have. One job at a time per pool.
+void mxu1_pool_run(mxu1_pool *pool, int tiles, mxu1_pool_fn fn, void *arg);
+
+//  Cuts width x height into tile_width x tile_height rectangles (smaller at
+// the right and bottom edges) and runs fn() on each, row by row. A strip
+// of whole rows, tile_width = width, suits row kernels.
+void mxu1_pool_tiles(mxu1_pool *pool, int width, int height, int tile_width,
+                     int tile_height, mxu1_tile_fn fn, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_POOL_H
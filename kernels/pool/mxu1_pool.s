@@ -0,0 +1,82 @@
+# mxu1_pool.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 MXU context save and restore
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes are in mxu1_pool.h. The context is mxu1_context, the
+# layout of the mxu_save_context and mxu_restore_context macros (see
+# mxu1_as_macros.s.h): xri in word i, MXU_CR in word 16. MXU_CR is restored
+# last, so a context with the MXU disabled still has its registers loaded.
+#
+# Register use: xr1..xr16, $t0 and $a0, $a1. Leaf functions.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+
+################################################################################
+# void mxu1_context_save(mxu1_context *ctx)
+  .globl  mxu1_context_save
+  .type   mxu1_context_save, @function
+  .ent    mxu1_context_save
+mxu1_context_save:
+  mxu_save_context     $a0,  $t0
+  jr      $ra
+   nop
+  .end    mxu1_context_save
+  .size   mxu1_context_save, .-mxu1_context_save
+
+
+################################################################################
+# void mxu1_context_restore(const mxu1_context *ctx)
+  .globl  mxu1_context_restore
+  .type   mxu1_context_restore, @function
+  .ent    mxu1_context_restore
+mxu1_context_restore:
+  mxu_restore_context  $a0,  $t0
+  jr      $ra
+   nop
+  .end    mxu1_context_restore
+  .size   mxu1_context_restore, .-mxu1_context_restore
+
+
+################################################################################
+# void mxu1_context_switch(mxu1_context *save, const mxu1_context *load)
+  .globl  mxu1_context_switch
+  .type   mxu1_context_switch, @function
+  .ent    mxu1_context_switch
+mxu1_context_switch:
+  mxu_save_context     $a0,  $t0
+  mxu_restore_context  $a1,  $t0
+  jr      $ra
+   nop
+  .end    mxu1_context_switch
+  .size   mxu1_context_switch, .-mxu1_context_switch
+
+# vim:shiftwidth=2:expandtab:syntax=asm
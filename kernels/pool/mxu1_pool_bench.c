@@ -0,0 +1,252 @@
+// mxu1_pool_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 contexts and tile pool: checks and frames/s per thread count
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Checks the context functions (save, restore and switch move xr1..xr16
+// exactly; claims between two contexts keep each one's registers), that
+// every tile of jobs of 0 to 300 tiles of uneven cost runs exactly once
+// and every pixel of a tiled rectangle is covered once, and that a 1080p
+// I420 to ARGB conversion split into 16-row strips across the pool matches
+// the whole frame converted in one call. Then prints frames per second of
+// that conversion for 1 thread up to one per CPU (at least 2), and the
+// speedup over 1.
+//
+// Build and run on the target (kernels/pool):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -pthread
+//         -o mxu1_pool_bench mxu1_pool_bench.c mxu1_pool_tiles.c
+//         mxu1_pool.s ../yuv/mxu1_yuv_frame.c ../yuv/mxu1_yuv_ref.c
+//         ../yuv/mxu1_yuv.s ../dispatch/mxu1_cpu.c
+//     ./mxu1_pool_bench [seconds per test, default 1]
+// Exits non-zero if any result differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mxu1_pool.h"
+#include "../yuv/mxu1_yuv.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+//  Whether the registers held in the two agree, xr1..xr16
+static int same(const mxu1_context *a, const mxu1_context *b)
+{
+  return !memcmp(&a->xr[1], &b->xr[1], 16 * sizeof(uint32_t));
+}
+
+static int contexts(void)
+{
+  mxu1_context a, b, ca, cb, t, u;
+  int failed = 0;
+
+  mxu1_context_init(&a);
+  mxu1_context_init(&b);
+  for (int i = 1; i < 16; ++i) {
+    a.xr[i] = rand16() << 16 | rand16();
+    b.xr[i] = rand16() << 16 | rand16();
+  }
+  mxu1_context_restore(&a);
+  mxu1_context_save(&t);
+  failed |= !same(&t, &a);
+  mxu1_context_switch(&u, &b);
+  mxu1_context_save(&t);
+  failed |= !same(&u, &a) || !same(&t, &b);
+
+  //  Two tasks taking turns, their registers in ca and cb while away
+  ca = a;
+  cb = b;
+  mxu1_context_claim(&ca);
+  mxu1_context_save(&t);
+  failed |= !same(&t, &a);
+  mxu1_context_claim(&cb);
+  mxu1_context_save(&t);
+  failed |= !same(&t, &b) || !same(&ca, &a);
+  mxu1_context_claim(&cb);
+  mxu1_context_claim(&ca);
+  mxu1_context_save(&t);
+  failed |= !same(&t, &a) || !same(&cb, &b);
+  mxu1_context_release(&ca);
+  mxu1_context_release(&cb);
+  if (failed)
+    printf("contexts: MISMATCH\n");
+  return failed;
+}
+
+static int calls[300];
+
+//  Tile t takes t % 7 units of time, so runs empty unevenly
+static void count(void *arg, int t, int worker)
+{
+  volatile int spin = 0;
+
+  (void)arg;
+  (void)worker;
+  for (int i = 0; i < t % 7 * 2000; ++i)
+    spin += i;
+  ++calls[t];
+}
+
+static unsigned char cover[37][100];
+
+static void cover_tile(void *arg, const mxu1_tile *t, int worker)
+{
+  (void)arg;
+  (void)worker;
+  for (int y = t->y; y < t->y + t->height; ++y)
+    for (int x = t->x; x < t->x + t->width; ++x)
+      ++cover[y][x];
+}
+
+static int jobs(mxu1_pool *pool)
+{
+  int failed = 0;
+
+  for (int n = 0; n <= 300; n += n < 20 ? 1 : 37) {
+    memset(calls, 0, sizeof(calls));
+    mxu1_pool_run(pool, n, count, NULL);
+    for (int t = 0; t < 300; ++t)
+      if (calls[t] != (t < n)) {
+        printf("%d threads, %d tiles: tile %d ran %d times\n",
+               mxu1_pool_threads(pool), n, t, calls[t]);
+        failed = 1;
+        break;
+      }
+  }
+  for (int th = 1; th <= 37; th += 6) {
+    memset(cover, 0, sizeof(cover));
+    mxu1_pool_tiles(pool, 100, 37, 16, th, cover_tile, NULL);
+    for (int y = 0; y < 37; ++y)
+      for (int x = 0; x < 100; ++x)
+        if (cover[y][x] != 1) {
+          printf("%d threads, 16x%d tiles: (%d, %d) covered %d times\n",
+                 mxu1_pool_threads(pool), th, x, y, cover[y][x]);
+          failed = 1;
+          y = 37;
+          break;
+        }
+  }
+  return failed;
+}
+
+enum { W = 1920, H = 1080, STRIP = 16 };
+
+typedef struct {
+  const uint8_t *y, *u, *v;
+  uint8_t       *argb;
+} frame;
+
+static void convert_strip(void *arg, const mxu1_tile *t, int worker)
+{
+  const frame *f = (const frame *)arg;
+  const int c = t->y / 2 * (W / 2);
+
+  (void)worker;
+  mxu1_i420_to_rgb(f->y + t->y * W, W, f->u + c, f->v + c, W / 2,
+                   f->argb + t->y * W * 4, W * 4, MXU1_ARGB8888,
+                   t->width, t->height);
+}
+
+int main(int argc, char **argv)
+{
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  const int most = cpus > 2 ? (int)cpus : 2;
+  uint8_t *yuv = (uint8_t *)malloc(W * H * 3 / 2);
+  uint8_t *ref = (uint8_t *)malloc(W * H * 4);
+  uint8_t *out = (uint8_t *)malloc(W * H * 4);
+  double one = 0;
+  frame f;
+  int failed;
+
+  if (!yuv || !ref || !out) {
+    fprintf(stderr, "out of memory\n");
+    return 2;
+  }
+  mxu1_cpu_enable();
+  failed = contexts();
+
+  for (int i = 0; i < W * H * 3 / 2; ++i)
+    yuv[i] = (uint8_t)rand16();
+  f.y = yuv;
+  f.u = yuv + W * H;
+  f.v = f.u + W * H / 4;
+  f.argb = out;
+  mxu1_i420_to_rgb(f.y, W, f.u, f.v, W / 2, ref, W * 4, MXU1_ARGB8888, W, H);
+
+  printf("%dx%d I420 to ARGB, %d-row strips   frames/s  speedup\n", W, H,
+         STRIP);
+  for (int n = 1; n <= most; ++n) {
+    mxu1_pool *pool = mxu1_pool_create(n, 1);
+    unsigned long k = 0;
+    double t0, dt;
+
+    if (!pool) {
+      fprintf(stderr, "could not start %d threads\n", n);
+      return 2;
+    }
+    failed |= jobs(pool);
+    memset(out, 0, W * H * 4);
+    mxu1_pool_tiles(pool, W, H, W, STRIP, convert_strip, &f);
+    if (memcmp(out, ref, W * H * 4)) {
+      printf("%d threads: MISMATCH against one call\n", n);
+      failed = 1;
+    }
+    t0 = now();
+    do {
+      mxu1_pool_tiles(pool, W, H, W, STRIP, convert_strip, &f);
+      ++k;
+      dt = now() - t0;
+    } while (dt < secs);
+    if (n == 1)
+      one = k / dt;
+    printf("  %d thread%s %31.1f  x%.2f\n", n, n > 1 ? "s" : " ", k / dt,
+           k / dt / one);
+    mxu1_pool_destroy(pool);
+  }
+
+  free(out);
+  free(ref);
+  free(yuv);
+  return failed;
+}
@@ -0,0 +1,324 @@
+// mxu1_pool_tiles.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 lazy context switch and work-stealing tile pool
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Each worker owns a run of tile numbers, [begin, end), under its own lock,
+// on a cache line of its own. It takes tiles from the front; when its run
+// is empty it looks at the others', from its next neighbour round, and takes
+// the later half of the first it finds not empty (at least one tile): the
+// first of those it runs, the rest become its own run, which others may in
+// turn take from. A worker that finds every run empty is done with the job;
+// tiles only ever move between runs, never back, so nothing is missed, and
+// the caller waits for all of them before returning.
+////////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mxu1_pool.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// MXU contexts
+////////////////////////////////////////////////////////////////////////////////
+
+//  The context the calling thread's registers hold, if claimed
+static __thread mxu1_context *owner;
+
+void mxu1_context_init(mxu1_context *ctx)
+{
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->xr[16] = 1;
+}
+
+void mxu1_context_claim(mxu1_context *ctx)
+{
+  if (owner == ctx)
+    return;
+  if (owner)
+    mxu1_context_switch(owner, ctx);
+  else
+    mxu1_context_restore(ctx);
+  owner = ctx;
+}
+
+//  The registers are left as they are: nobody else's values are in them
+void mxu1_context_release(mxu1_context *ctx)
+{
+  if (owner == ctx)
+    owner = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Thread pool
+////////////////////////////////////////////////////////////////////////////////
+
+//  Bytes per worker, a multiple of the cache line (32 bytes on XBurst)
+#define WORKER_SIZE 64
+
+typedef struct {
+  pthread_mutex_t lock;
+  int             begin, end;
+  mxu1_pool      *pool;
+  int             index;
+} worker;
+
+typedef union {
+  worker w;
+  char   line[WORKER_SIZE];
+} worker_line;
+
+struct mxu1_pool {
+  worker_line    *workers;
+  int             threads, started;
+  pthread_t      *ids;
+  int             mxu;
+  mxu1_context    context;
+
+  //  The job, and the workers still on it; under 'lock'
+  pthread_mutex_t lock;
+  pthread_cond_t  start, done;
+  unsigned        generation;
+  int             busy, quit;
+  mxu1_pool_fn    fn;
+  void           *arg;
+};
+
+//  The next tile of w's run, or -1
+static int take(worker *w)
+{
+  int t = -1;
+
+  pthread_mutex_lock(&w->lock);
+  if (w->begin < w->end)
+    t = w->begin++;
+  pthread_mutex_unlock(&w->lock);
+  return t;
+}
+
+//  The first of the later half of another worker's run, the rest of that
+// half moved to w's (empty) run; -1 if every run is empty
+static int steal(worker *w)
+{
+  mxu1_pool *p = w->pool;
+
+  for (int i = 1; i < p->threads; ++i) {
+    worker *v = &p->workers[(w->index + i) % p->threads].w;
+    int begin, end;
+
+    pthread_mutex_lock(&v->lock);
+    end = v->end;
+    begin = v->end -= (end - v->begin + 1) / 2;
+    pthread_mutex_unlock(&v->lock);
+    if (begin < end) {
+      pthread_mutex_lock(&w->lock);
+      w->begin = begin + 1;
+      w->end = end;
+      pthread_mutex_unlock(&w->lock);
+      return begin;
+    }
+  }
+  return -1;
+}
+
+static void work(worker *w)
+{
+  mxu1_pool *p = w->pool;
+  int t;
+
+  while ((t = take(w)) >= 0 || (t = steal(w)) >= 0)
+    p->fn(p->arg, t, w->index);
+}
+
+static void *thread(void *v)
+{
+  worker *w = (worker *)v;
+  mxu1_pool *p = w->pool;
+  unsigned seen = 0;
+
+  if (p->mxu)
+    mxu1_context_restore(&p->context);
+  pthread_mutex_lock(&p->lock);
+  for (;;) {
+    while (!p->quit && p->generation == seen)
+      pthread_cond_wait(&p->start, &p->lock);
+    if (p->quit)
+      break;
+    seen = p->generation;
+    pthread_mutex_unlock(&p->lock);
+    work(w);
+    pthread_mutex_lock(&p->lock);
+    if (--p->busy == 0)
+      pthread_cond_signal(&p->done);
+  }
+  pthread_mutex_unlock(&p->lock);
+  return NULL;
+}
+
+mxu1_pool *mxu1_pool_create(int threads, int mxu)
+{
+  mxu1_pool *p;
+  void *workers;
+
+  if (threads <= 0) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cpus > 0 ? (int)cpus : 1;
+  }
+  p = (mxu1_pool *)calloc(1, sizeof(*p));
+  if (!p)
+    return NULL;
+  if (posix_memalign(&workers, WORKER_SIZE, threads * sizeof(worker_line))) {
+    free(p);
+    return NULL;
+  }
+  p->workers = (worker_line *)workers;
+  p->ids = (pthread_t *)calloc(threads, sizeof(pthread_t));
+  p->threads = threads;
+  p->mxu = mxu;
+  if (mxu)
+    mxu1_context_save(&p->context);
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->start, NULL);
+  pthread_cond_init(&p->done, NULL);
+  for (int i = 0; i < threads; ++i) {
+    worker *w = &p->workers[i].w;
+    pthread_mutex_init(&w->lock, NULL);
+    w->begin = w->end = 0;
+    w->pool = p;
+    w->index = i;
+  }
+  if (!p->ids) {
+    mxu1_pool_destroy(p);
+    return NULL;
+  }
+  for (int i = 1; i < threads; ++i, ++p->started) {
+    if (pthread_create(&p->ids[i], NULL, thread, &p->workers[i].w)) {
+      mxu1_pool_destroy(p);
+      return NULL;
+    }
+  }
+  return p;
+}
+
+void mxu1_pool_destroy(mxu1_pool *p)
+{
+  if (!p)
+    return;
+  pthread_mutex_lock(&p->lock);
+  p->quit = 1;
+  pthread_cond_broadcast(&p->start);
+  pthread_mutex_unlock(&p->lock);
+  for (int i = 1; i <= p->started; ++i)
+    pthread_join(p->ids[i], NULL);
+  for (int i = 0; i < p->threads; ++i)
+    pthread_mutex_destroy(&p->workers[i].w.lock);
+  pthread_cond_destroy(&p->done);
+  pthread_cond_destroy(&p->start);
+  pthread_mutex_destroy(&p->lock);
+  free(p->ids);
+  free(p->workers);
+  free(p);
+}
+
+int mxu1_pool_threads(const mxu1_pool *p)
+{
+  return p->threads;
+}
+
+void mxu1_pool_run(mxu1_pool *p, int tiles, mxu1_pool_fn fn, void *arg)
+{
+  if (tiles <= 0)
+    return;
+  if (p->threads == 1 || tiles == 1) {
+    for (int t = 0; t < tiles; ++t)
+      fn(arg, t, 0);
+    return;
+  }
+
+  //  The workers are all waiting: their runs are set before the job is
+  // published under p->lock
+  for (int i = 0; i < p->threads; ++i) {
+    worker *w = &p->workers[i].w;
+    pthread_mutex_lock(&w->lock);
+    w->begin = (int)((long long)tiles * i / p->threads);
+    w->end = (int)((long long)tiles * (i + 1) / p->threads);
+    pthread_mutex_unlock(&w->lock);
+  }
+  pthread_mutex_lock(&p->lock);
+  p->fn = fn;
+  p->arg = arg;
+  p->busy = p->threads - 1;
+  ++p->generation;
+  pthread_cond_broadcast(&p->start);
+  pthread_mutex_unlock(&p->lock);
+
+  work(&p->workers[0].w);
+
+  pthread_mutex_lock(&p->lock);
+  while (p->busy)
+    pthread_cond_wait(&p->done, &p->lock);
+  pthread_mutex_unlock(&p->lock);
+}
+
+typedef struct {
+  mxu1_tile_fn fn;
+  void        *arg;
+  int          width, height, tile_width, tile_height, columns;
+} tiling;
+
+static void run_tile(void *arg, int t, int index)
+{
+  const tiling *g = (const tiling *)arg;
+  mxu1_tile r;
+
+  r.x = t % g->columns * g->tile_width;
+  r.y = t / g->columns * g->tile_height;
+  r.width = g->width - r.x < g->tile_width ? g->width - r.x : g->tile_width;
+  r.height = g->height - r.y < g->tile_height ? g->height - r.y :
+                                                g->tile_height;
+  g->fn(g->arg, &r, index);
+}
+
+void mxu1_pool_tiles(mxu1_pool *p, int width, int height, int tile_width,
+                     int tile_height, mxu1_tile_fn fn, void *arg)
+{
+  tiling g;
+
+  if (width <= 0 || height <= 0 || tile_width <= 0 || tile_height <= 0)
+    return;
+  g.fn = fn;
+  g.arg = arg;
+  g.width = width;
+  g.height = height;
+  g.tile_width = tile_width;
+  g.tile_height = tile_height;
+  g.columns = (width + tile_width - 1) / tile_width;
+  mxu1_pool_run(p, g.columns * ((height + tile_height - 1) / tile_height),
+                run_tile, &g);
+}
@@ -0,0 +1,147 @@
+// mxu1_prof.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 per-region operation profiling
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Finds the records of mxu1_as_macros.s.h's profiling regions through the
+// section bounds the linker defines, and writes them as JSON at exit (see
+// mxu1_prof.h). The bounds are weak, so a program with no profiled source
+// links, and has no records.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include "mxu1_prof.h"
+
+extern mxu1_prof_region __start_mxu1_prof[] __attribute__((weak));
+extern mxu1_prof_region __stop_mxu1_prof[] __attribute__((weak));
+
+const char *const mxu1_prof_class_names[MXU1_PROF_CLASSES] = {
+  "mul", "mac", "add", "cmp", "shift", "shuffle", "logic", "xfer", "load",
+  "store"
+};
+
+mxu1_prof_region *mxu1_prof_regions(size_t *count)
+{
+  mxu1_prof_region *start = __start_mxu1_prof, *stop = __stop_mxu1_prof;
+  *count = start && stop > start ? (size_t)(stop - start) : 0;
+  return *count ? start : NULL;
+}
+
+void mxu1_prof_reset(void)
+{
+  size_t n;
+  mxu1_prof_region *r = mxu1_prof_regions(&n);
+  for (size_t i = 0; i < n; ++i)
+    r[i].entries = 0;
+}
+
+//  The records of one name added up: executed operations per class
+typedef struct {
+  const char *name;
+  uint64_t    entries, total, ops[MXU1_PROF_CLASSES];
+} summary;
+
+static int by_total(const void *a, const void *b)
+{
+  const summary *x = (const summary *)a, *y = (const summary *)b;
+  return x->total < y->total ? 1 : x->total > y->total ? -1 :
+         strcmp(x->name, y->name);
+}
+
+static void write_counts(FILE *f, const summary *s)
+{
+  fprintf(f, "\"ops\": %llu", (unsigned long long)s->total);
+  for (int c = 0; c < MXU1_PROF_CLASSES; ++c)
+    fprintf(f, ", \"%s\": %llu", mxu1_prof_class_names[c],
+            (unsigned long long)s->ops[c]);
+}
+
+int mxu1_prof_write_json(FILE *f)
+{
+  size_t n, m = 0;
+  const mxu1_prof_region *r = mxu1_prof_regions(&n);
+  summary *s = (summary *)calloc(n ? n : 1, sizeof(*s)), total;
+
+  if (!s)
+    return -1;
+  memset(&total, 0, sizeof(total));
+  for (size_t i = 0; i < n; ++i) {
+    size_t j = 0;
+    while (j < m && strcmp(s[j].name, r[i].name))
+      ++j;
+    if (j == m)
+      s[m++].name = r[i].name;
+    s[j].entries += r[i].entries;
+    for (int c = 0; c < MXU1_PROF_CLASSES; ++c) {
+      const uint64_t ops = (uint64_t)r[i].entries * r[i].ops[c];
+      s[j].ops[c] += ops;
+      s[j].total += ops;
+      total.ops[c] += ops;
+      total.total += ops;
+    }
+  }
+  qsort(s, m, sizeof(*s), by_total);
+
+  fprintf(f, "{ \"classes\": [");
+  for (int c = 0; c < MXU1_PROF_CLASSES; ++c)
+    fprintf(f, "%s\"%s\"", c ? ", " : "", mxu1_prof_class_names[c]);
+  fprintf(f, "],\n  \"total\": { ");
+  write_counts(f, &total);
+  fprintf(f, " },\n  \"regions\": [");
+  for (size_t j = 0; j < m; ++j) {
+    fprintf(f, "%s\n    { \"name\": \"%s\", \"entries\": %llu, ", j ? "," : "",
+            s[j].name, (unsigned long long)s[j].entries);
+    write_counts(f, &s[j]);
+    fprintf(f, " }");
+  }
+  fprintf(f, "%s] }\n", m ? "\n  " : "");
+  free(s);
+  return ferror(f) ? -1 : 0;
+}
+
+static void write_at_exit(void)
+{
+  const char *path = getenv("MXU1_PROF_OUT");
+  FILE *f;
+  size_t n;
+
+  mxu1_prof_regions(&n);
+  if (!n)
+    return;
+  if (!path || !*path)
+    path = "mxu1_prof.json";
+  f = strcmp(path, "-") ? fopen(path, "w") : stdout;
+  if (!f || mxu1_prof_write_json(f))
+    fprintf(stderr, "mxu1_prof: cannot write %s\n", path);
+  if (f && f != stdout)
+    fclose(f);
+}
+
+__attribute__((constructor)) static void register_at_exit(void)
+{
+  atexit(write_at_exit);
+}
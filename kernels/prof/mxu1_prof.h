@@ -0,0 +1,96 @@
+// mxu1_prof.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 per-region operation profiling
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The run-time side of the profiling mode of mxu1_as_macros.s.h: sources
+// assembled with MXU1_PROFILE non-zero put one record per mxu_prof_begin/end
+// region in section mxu1_prof, which the linker gathers between
+// __start_mxu1_prof and __stop_mxu1_prof. Linking mxu1_prof.c into the
+// program writes them as JSON when it exits, to the file named by
+// $MXU1_PROF_OUT ("-" for stdout; mxu1_prof.json when unset), unless there
+// are none. Each region shows how often it was entered and the operations
+// of each class it executed, entries times its count of the class; regions
+// of one name in several sources are added up. For example:
+//
+//     { "classes": ["mul", "mac", ...],
+//       "total": { "ops": 1350, "mul": 0, "mac": 300, ... },
+//       "regions": [
+//         { "name": "fir_tap", "entries": 300, "ops": 1200,
+//           "mul": 0, "mac": 300, ..., "load": 600, "store": 0 },
+//         ... ] }
+//
+// with regions from most operations to least.
+//
+//  The records hold 32-bit pointers: MIPS o32 only, like the macros.
+//
+// Build (kernels/prof, mipsel cross toolchain), with the profiled sources:
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../..
+//         -Wa,--defsym,MXU1_PROFILE=1 -c kernel.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_prof.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_PROF_H
+#define MXU1_PROF_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  Operation classes, in the order of mxu1_as_macros.s.h's records
+enum {
+  MXU1_PROF_MUL, MXU1_PROF_MAC, MXU1_PROF_ADD, MXU1_PROF_CMP, MXU1_PROF_SHIFT,
+  MXU1_PROF_SHUFFLE, MXU1_PROF_LOGIC, MXU1_PROF_XFER, MXU1_PROF_LOAD,
+  MXU1_PROF_STORE, MXU1_PROF_CLASSES
+};
+
+//  One mxu_prof_end: 'entries' counted at run time, ops[] per entry
+typedef struct {
+  uint32_t    entries;
+  const char *name;
+  uint32_t    ops[MXU1_PROF_CLASSES];
+} mxu1_prof_region;
+
+extern const char *const mxu1_prof_class_names[MXU1_PROF_CLASSES];
+
+//  The program's records, *count of them (none without profiled sources)
+mxu1_prof_region *mxu1_prof_regions(size_t *count);
+
+//  Zeroes every region's entries, to profile one phase of a program
+void mxu1_prof_reset(void);
+
+//  Writes the JSON above to 'f'; 0, or -1 if writing failed
+int mxu1_prof_write_json(FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_PROF_H
@@ -0,0 +1,215 @@
+// mxu1_prof_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 per-region operation profiling
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  A sum of absolute differences of two word arrays, written twice in the
+// file-scope assembly below: prof_sad() with three profiling regions, setup,
+// loop body and exit, and plain_sad() without. Checks that both return the
+// C result and that prof_sad()'s records hold the entries and class counts
+// of its code, then prints the time the profiling adds per loop iteration
+// (one lw/addiu/sw of the record, and the $at address) and the JSON of one
+// call, which mxu1_prof.c also writes to mxu1_prof.json at exit.
+//
+// Build and run on the target (kernels/prof):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_prof_bench
+//         mxu1_prof_bench.c mxu1_prof.c ../dispatch/mxu1_cpu.c
+//     ./mxu1_prof_bench [seconds per test, default 1]
+// Exits non-zero if any result or count differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_prof.h"
+#include "../dispatch/mxu1_cpu.h"
+
+//  uint32_t prof_sad(const uint32_t *a, const uint32_t *b, int n), n > 0
+// words, and plain_sad() with the same code
+__asm__(".equiv MXU1_PROFILE, 1\n"
+        ".include \"mxu1_as_macros.s.h\"\n"
+        ".macro sad_body prof\n"
+        "  .if \\prof\n"
+        "  mxu_prof_begin prof_sad_setup, $t0\n"
+        "  .endif\n"
+        "  addiu   $a0, $a0, -4\n"
+        "  addiu   $a1, $a1, -4\n"
+        "  s32xor  xr5, xr5, xr5\n"
+        "  .if \\prof\n"
+        "  mxu_prof_end prof_sad_setup\n"
+        "  .endif\n"
+        "1:\n"
+        "  .if \\prof\n"
+        "  mxu_prof_begin prof_sad_loop, $t0\n"
+        "  .endif\n"
+        "  s32ldi  xr1, $a0, 4\n"
+        "  s32ldi  xr2, $a1, 4\n"
+        "  q8sad   xr3, xr1, xr2, xr5\n"
+        "  addiu   $a2, $a2, -1\n"
+        "  .if \\prof\n"
+        "  mxu_prof_end prof_sad_loop\n"
+        "  .endif\n"
+        "  bnez    $a2, 1b\n"
+        "  nop\n"
+        "  .if \\prof\n"
+        "  mxu_prof_begin prof_sad_exit, $t0\n"
+        "  .endif\n"
+        "  s32m2i  xr5, $v0\n"
+        "  .if \\prof\n"
+        "  mxu_prof_end prof_sad_exit\n"
+        "  .endif\n"
+        "  jr      $ra\n"
+        "  nop\n"
+        ".endm\n"
+        "  .text\n"
+        "  .set    push\n"
+        "  .set    noreorder\n"
+        "  .globl  prof_sad\n"
+        "  .ent    prof_sad\n"
+        "prof_sad:\n"
+        "  sad_body 1\n"
+        "  .end    prof_sad\n"
+        "  .globl  plain_sad\n"
+        "  .ent    plain_sad\n"
+        "plain_sad:\n"
+        "  sad_body 0\n"
+        "  .end    plain_sad\n"
+        "  .set    pop\n");
+
+uint32_t prof_sad(const uint32_t *a, const uint32_t *b, int n);
+uint32_t plain_sad(const uint32_t *a, const uint32_t *b, int n);
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+static uint32_t sad_c(const uint32_t *a, const uint32_t *b, int n)
+{
+  uint32_t s = 0;
+  for (int i = 0; i < n; ++i)
+    for (int sh = 0; sh < 32; sh += 8) {
+      const int d = (int)(a[i] >> sh & 255) - (int)(b[i] >> sh & 255);
+      s += d < 0 ? -d : d;
+    }
+  return s;
+}
+
+//  What prof_sad()'s n-word call must have recorded, by region name
+typedef struct {
+  const char *name;
+  uint32_t    entries, ops[MXU1_PROF_CLASSES];
+} expected;
+
+static int check_counts(int n)
+{
+  const expected want[] = {
+    { "prof_sad_setup", 1, { [MXU1_PROF_LOGIC] = 1 } },
+    { "prof_sad_loop", (uint32_t)n,
+      { [MXU1_PROF_ADD] = 1, [MXU1_PROF_LOAD] = 2 } },
+    { "prof_sad_exit", 1, { [MXU1_PROF_XFER] = 1 } },
+  };
+  size_t count;
+  const mxu1_prof_region *r = mxu1_prof_regions(&count);
+  int failed = count != 3;
+
+  for (int w = 0; w < 3; ++w) {
+    size_t i = 0;
+    while (i < count && strcmp(r[i].name, want[w].name))
+      ++i;
+    if (i == count || r[i].entries != want[w].entries ||
+        memcmp(r[i].ops, want[w].ops, sizeof(want[w].ops))) {
+      printf("%-15s n = %d: COUNTS DIFFER\n", want[w].name, n);
+      failed = 1;
+    }
+  }
+  return failed;
+}
+
+//  Seconds per call of 'f' over n words
+static double timed(uint32_t (*f)(const uint32_t *, const uint32_t *, int),
+                    const uint32_t *a, const uint32_t *b, int n, double secs)
+{
+  unsigned long k = 0;
+  double t0 = now(), dt;
+  volatile uint32_t sink;
+
+  do {
+    sink = f(a, b, n);
+    ++k;
+    dt = now() - t0;
+  } while (dt < secs);
+  (void)sink;
+  return dt / k;
+}
+
+int main(int argc, char **argv)
+{
+  enum { N = 4096 };
+  static uint32_t a[N], b[N];
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  int failed = 0;
+
+  mxu1_cpu_enable();
+  for (int i = 0; i < N; ++i) {
+    a[i] = rand16() << 16 | rand16();
+    b[i] = rand16() << 16 | rand16();
+  }
+
+  for (int n = 1; n <= N; n = n < 16 ? n + 1 : n * 2) {
+    const uint32_t c = sad_c(a, b, n);
+    mxu1_prof_reset();
+    if (prof_sad(a, b, n) != c || plain_sad(a, b, n) != c) {
+      printf("sad n = %d: MISMATCH\n", n);
+      failed = 1;
+    }
+    failed |= check_counts(n);
+  }
+
+  {
+    const double p = timed(prof_sad, a, b, N, secs);
+    const double q = timed(plain_sad, a, b, N, secs);
+    printf("%d words: profiled %.3f us, plain %.3f us, "
+           "%.2f ns per iteration added\n", N, p * 1e6, q * 1e6,
+           (p - q) / N * 1e9);
+  }
+
+  mxu1_prof_reset();
+  prof_sad(a, b, N);
+  if (mxu1_prof_write_json(stdout))
+    failed = 1;
+  return failed;
+}
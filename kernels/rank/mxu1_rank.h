@@ -0,0 +1,155 @@
+// mxu1_rank.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 median, erode and dilate filters
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Rank-order filters on 8-bit single plane images (camera luma, masks):
+// 3x3 and 5x5 median for noise removal, and 3x3 and 5x5 erosion (minimum)
+// and dilation (maximum) for morphology. The row kernels are in mxu1_rank.s,
+// each with a C twin in mxu1_rank_ref.c whose output it matches byte for
+// byte; the image functions (mxu1_rank_image.c) run either set.
+//
+// Every output pixel is the median, minimum or maximum of the k x k window
+// centred on it, with pixels outside the image taken from the nearest edge
+// row or column (replicated borders).
+//
+// How the MXU does it (details in mxu1_rank.s): four output pixels per word,
+// with q8min/q8max as the compare-exchange of a branch-free sorting network
+// on four lanes at once. Each pass over a row loads every input word once,
+// down its column of k rows, reduces or sorts that column, and keeps the
+// result in xr registers while it serves as the left, centre and right
+// neighbour of the output words around it (s32alni shifts the neighbouring
+// columns into lane position):
+//   - erode/dilate take the column minimum or maximum, then of k shifts;
+//   - the 3x3 median sorts columns of 3 and takes the median of the largest
+//     of the minima, the median of the middles and the smallest of the
+//     maxima of 3 adjacent columns;
+//   - the 5x5 median sorts columns of 5, then runs a 96-op selection network
+//     over the 25 sorted values. Those do not fit in 15 registers, so the
+//     columns' 25 shifted words go through a small batch buffer instead
+//     (still one load of each input word per pass).
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/rank, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_rank.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_rank_ref.c mxu1_rank_image.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_RANK_H
+#define MXU1_RANK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Images (mxu1_rank_image.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  Any width and height; strides in bytes. 'dst' must not overlap 'src'.
+// The MXU kernels take the middle of each row (all but 4 pixels at the
+// left and 4 to 7 at the right) when the rows and strides are word
+// aligned, the C kernels the rest.
+void mxu1_median3x3(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height);
+void mxu1_median5x5(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height);
+void mxu1_erode3x3(uint8_t *dst, int dst_stride,
+                   const uint8_t *src, int src_stride, int width, int height);
+void mxu1_erode5x5(uint8_t *dst, int dst_stride,
+                   const uint8_t *src, int src_stride, int width, int height);
+void mxu1_dilate3x3(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height);
+void mxu1_dilate5x5(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height);
+
+//  The same, on the C kernels only.
+void mxu1_median3x3_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height);
+void mxu1_median5x5_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height);
+void mxu1_erode3x3_c(uint8_t *dst, int dst_stride,
+                     const uint8_t *src, int src_stride,
+                     int width, int height);
+void mxu1_erode5x5_c(uint8_t *dst, int dst_stride,
+                     const uint8_t *src, int src_stride,
+                     int width, int height);
+void mxu1_dilate3x3_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height);
+void mxu1_dilate5x5_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height);
+
+////////////////////////////////////////////////////////////////////////////////
+// Row kernels (mxu1_rank.s), for the driver
+////////////////////////////////////////////////////////////////////////////////
+
+//  Output words per mxu1_median5x5_row call at most, and its batch buffer
+#define MXU1_RANK_BATCH         32
+#define MXU1_RANK_FRAMES_SIZE   ((MXU1_RANK_BATCH + 2) * 25 * 4)
+
+//  One output row: the k source rows around it (src[0] is k / 2 rows above,
+// repeated rows at the top and bottom edges), output columns x .. x + n - 1.
+// Row pointers are to column 0.
+//   MXU kernels: x and n multiples of 4, x >= 4 and x + n + 4 <= width (the
+//                words either side of the span are read), every row word
+//                aligned; mxu1_median5x5_row also n <= 4 * MXU1_RANK_BATCH
+//                and 'frames' a word aligned MXU1_RANK_FRAMES_SIZE bytes.
+//   C kernels:   any span within the row; columns are clamped to
+//                0 .. width - 1.
+typedef struct {
+  const uint8_t *src[5];
+  uint8_t       *dst;
+  int32_t        x, n;
+  int32_t        width;
+  uint32_t      *frames;
+} mxu1_rank_rows;
+
+void mxu1_median3x3_row(const mxu1_rank_rows *r);
+void mxu1_median5x5_row(const mxu1_rank_rows *r);
+void mxu1_erode3x3_row(const mxu1_rank_rows *r);
+void mxu1_erode5x5_row(const mxu1_rank_rows *r);
+void mxu1_dilate3x3_row(const mxu1_rank_rows *r);
+void mxu1_dilate5x5_row(const mxu1_rank_rows *r);
+
+void mxu1_median3x3_row_c(const mxu1_rank_rows *r);
+void mxu1_median5x5_row_c(const mxu1_rank_rows *r);
+void mxu1_erode3x3_row_c(const mxu1_rank_rows *r);
+void mxu1_erode5x5_row_c(const mxu1_rank_rows *r);
+void mxu1_dilate3x3_row_c(const mxu1_rank_rows *r);
+void mxu1_dilate5x5_row_c(const mxu1_rank_rows *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_RANK_H
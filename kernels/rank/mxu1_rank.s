@@ -0,0 +1,474 @@
+# mxu1_rank.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 median, erode and dilate row kernels
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, the row layout (mxu1_rank_rows) and the filters are
+# described in mxu1_rank.h; mxu1_rank_ref.c is the same computation in C.
+#
+#  Every kernel steps along its output row one word (4 pixels) at a time.
+# Each step loads the next word of each of the k source rows (s32ldi), the
+# "next" column, and reduces it: to its minimum or maximum for erode and
+# dilate, to a sorted column (k words, one per rank) for the medians. The
+# previous, current and next columns stay in registers, and the current
+# word's neighbours at distance d are the byte shifts s32alni makes of two
+# adjacent columns:
+#   current - 1 = s32alni(cur,  prev, 1)    current + 1 = s32alni(next, cur, 3)
+#   current - 2 = s32alni(cur,  prev, 2)    current + 2 = s32alni(next, cur, 2)
+# The loops are unrolled three times with the column registers rotated, so
+# nothing is ever moved: "next" becomes "current" by being named so.
+#
+#  q8min and q8max are a compare-exchange of four byte lanes at once, with
+# no branches. Medians (k x k, rank k * k / 2):
+#   3x3: each column sorted into L <= M <= H (3 compare-exchanges); the
+#        median is med3(max(L-1, L, L+1), med3(M-1, M, M+1),
+#        min(H-1, H, H+1)) (Paeth); 24 q8min, q8max and s32alni in all
+#        per 4 pixels.
+#   5x5: each column sorted into 5 ranks (the optimal 9 compare-exchange
+#        network); then a selection network on the 25 values, which after
+#        the column sort has 96 q8min/q8max: it sorts the 5 rank rows, of
+#        which 13 candidates remain (an element of a matrix with sorted rows
+#        and columns has at least (i + 1)(j + 1) - 1 others below it and
+#        (5 - i)(5 - j) - 1 above), and finds their median, pruned to what
+#        the output depends on. It was checked on all 2^25 inputs of 0s and
+#        1s, which suffices for min/max networks (the 0-1 principle).
+#
+# Register use: any xr, $t0..$t9, $a1..$a3. Leaf functions, no stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# mxu1_rank_rows field offsets
+  .equ    ROWS_SRC0,      0
+  .equ    ROWS_SRC1,      4
+  .equ    ROWS_SRC2,      8
+  .equ    ROWS_SRC3,      12
+  .equ    ROWS_SRC4,      16
+  .equ    ROWS_DST,       20
+  .equ    ROWS_X,         24
+  .equ    ROWS_N,         28
+  .equ    ROWS_FRAMES,    36
+
+
+#  Source rows in $t0..$t(k-1), each at column x - 8 for s32ldi; dst in $t5
+# at x - 4; output words in $t7. Branches to 9f if there are none.
+.macro RANK_SETUP k
+  lw      $t6,  ROWS_X($a0)
+  lw      $t7,  ROWS_N($a0)
+  lw      $t5,  ROWS_DST($a0)
+  lw      $t0,  ROWS_SRC0($a0)
+  lw      $t1,  ROWS_SRC1($a0)
+  lw      $t2,  ROWS_SRC2($a0)
+  .if \k == 5
+  lw      $t3,  ROWS_SRC3($a0)
+  lw      $t4,  ROWS_SRC4($a0)
+  .endif
+  sra     $t7,  $t7,  2
+  blez    $t7,  9f
+   addiu  $t6,  $t6,  -8
+  addu    $t0,  $t0,  $t6
+  addu    $t1,  $t1,  $t6
+  addu    $t2,  $t2,  $t6
+  .if \k == 5
+  addu    $t3,  $t3,  $t6
+  addu    $t4,  $t4,  $t6
+  .endif
+  addiu   $t6,  $t6,  4
+  addu    $t5,  $t5,  $t6
+.endm
+
+#  Three column steps and the loop around them: \step is a macro (with any
+# leading arguments, quoted) of the prev, cur and next column registers,
+# each given as one argument (quoted if several), which leaves the output
+# word in xr10
+.macro RANK_LOOP step, a, b, c
+1:
+  \step   \a,   \b,   \c
+  addiu   $t7,  $t7,  -1
+  beqz    $t7,  9f
+   s32sdi xr10, $t5,  4
+  \step   \b,   \c,   \a
+  addiu   $t7,  $t7,  -1
+  beqz    $t7,  9f
+   s32sdi xr10, $t5,  4
+  \step   \c,   \a,   \b
+  addiu   $t7,  $t7,  -1
+  bnez    $t7,  1b
+   s32sdi xr10, $t5,  4
+
+9:
+  jr      $ra
+  nop
+.endm
+
+
+################################################################################
+# Erode and dilate
+#
+#  One column register each for prev, cur and next (xr1..xr3); the rows are
+# loaded into xr4..xr8 and the shifts made in xr11..xr14.
+################################################################################
+
+#  Next column's minimum (q8min) or maximum (q8max) into \c
+.macro MINMAX_COLUMN op, k, c
+  s32ldi  xr4,  $t0,  4
+  s32ldi  xr5,  $t1,  4
+  s32ldi  xr6,  $t2,  4
+  .if \k == 5
+  s32ldi  xr7,  $t3,  4
+  s32ldi  xr8,  $t4,  4
+  \op     xr4,  xr4,  xr7
+  \op     xr5,  xr5,  xr8
+  .endif
+  \op     xr4,  xr4,  xr5
+  \op     \c,   xr4,  xr6
+.endm
+
+.macro MINMAX_STEP op, k, p, c, n
+  MINMAX_COLUMN \op, \k, \n
+  s32alni xr11, \c,   \p,   1             # cur - 1
+  s32alni xr12, \n,   \c,   3             # cur + 1
+  .if \k == 5
+  s32alni xr13, \c,   \p,   2             # cur - 2
+  s32alni xr14, \n,   \c,   2             # cur + 2
+  \op     xr11, xr11, xr13
+  \op     xr12, xr12, xr14
+  .endif
+  \op     xr10, xr11, \c
+  \op     xr10, xr10, xr12
+.endm
+
+.macro MINMAX name, op, k
+  .globl  \name
+  .type   \name, @function
+  .ent    \name
+\name:
+  RANK_SETUP \k
+  MINMAX_COLUMN \op, \k, xr1
+  MINMAX_COLUMN \op, \k, xr2
+  RANK_LOOP "MINMAX_STEP \op, \k,", xr1, xr2, xr3
+  .end    \name
+  .size   \name, .-\name
+.endm
+
+
+################################################################################
+# void mxu1_erode3x3_row(const mxu1_rank_rows *r)
+  MINMAX mxu1_erode3x3_row, q8min, 3
+
+
+################################################################################
+# void mxu1_erode5x5_row(const mxu1_rank_rows *r)
+  MINMAX mxu1_erode5x5_row, q8min, 5
+
+
+################################################################################
+# void mxu1_dilate3x3_row(const mxu1_rank_rows *r)
+  MINMAX mxu1_dilate3x3_row, q8max, 3
+
+
+################################################################################
+# void mxu1_dilate5x5_row(const mxu1_rank_rows *r)
+  MINMAX mxu1_dilate5x5_row, q8max, 5
+
+
+################################################################################
+# void mxu1_median3x3_row(const mxu1_rank_rows *r)
+#
+#  Columns sorted into L, M, H: prev in xr1..xr3, cur in xr4..xr6, next in
+# xr7..xr9 (rotating); the three rows are loaded into xr11..xr13.
+################################################################################
+
+#  Next column, sorted into \l <= \m <= \h
+.macro MED3_COLUMN l, m, h
+  s32ldi  xr11, $t0,  4
+  s32ldi  xr12, $t1,  4
+  s32ldi  xr13, $t2,  4
+  q8min   xr14, xr11, xr12
+  q8max   xr12, xr11, xr12
+  q8max   \h,   xr12, xr13
+  q8min   xr12, xr12, xr13
+  q8min   \l,   xr14, xr12
+  q8max   \m,   xr14, xr12
+.endm
+
+.macro MED3_STEP pl, pm, ph, cl, cm, ch, nl, nm, nh
+  MED3_COLUMN \nl, \nm, \nh
+  s32alni xr10, \cl,  \pl,  1             # Largest of the minima
+  s32alni xr11, \nl,  \cl,  3
+  q8max   xr10, xr10, xr11
+  q8max   xr10, xr10, \cl
+  s32alni xr11, \ch,  \ph,  1             # Smallest of the maxima
+  s32alni xr12, \nh,  \ch,  3
+  q8min   xr11, xr11, xr12
+  q8min   xr11, xr11, \ch
+  s32alni xr12, \cm,  \pm,  1             # Median of the middles
+  s32alni xr13, \nm,  \cm,  3
+  q8min   xr14, xr12, xr13
+  q8max   xr12, xr12, xr13
+  q8min   xr12, xr12, \cm
+  q8max   xr12, xr12, xr14
+  q8min   xr13, xr10, xr11                # Median of the three
+  q8max   xr10, xr10, xr11
+  q8min   xr10, xr10, xr12
+  q8max   xr10, xr10, xr13
+.endm
+
+  .globl  mxu1_median3x3_row
+  .type   mxu1_median3x3_row, @function
+  .ent    mxu1_median3x3_row
+mxu1_median3x3_row:
+  RANK_SETUP 3
+  MED3_COLUMN xr1, xr2, xr3
+  MED3_COLUMN xr4, xr5, xr6
+  RANK_LOOP MED3_STEP, "xr1, xr2, xr3", "xr4, xr5, xr6", "xr7, xr8, xr9"
+  .end    mxu1_median3x3_row
+  .size   mxu1_median3x3_row, .-mxu1_median3x3_row
+
+
+################################################################################
+# void mxu1_median5x5_row(const mxu1_rank_rows *r)
+#
+#  Two passes over a batch of at most MXU1_RANK_BATCH output words. The first
+# loads each column once, sorts it (ranks 0..4 in one of two register sets,
+# xr1..xr5 and xr6..xr10, alternating) and writes, for every output word k,
+# a frame F[k] of 25 words in r->frames: rank i shifted by d = -2..2 at
+# F[k] + (5 * i + d + 2) * 4. Column k with its left neighbour k - 1 gives
+# the shifts +1 and +2 of word k - 1 and -2, -1 and 0 of word k. The second
+# pass runs the selection network over each frame in turn.
+#
+#  Frames are 100 bytes apart, F[0] at r->frames + 100: the first column
+# loaded (word x - 4) fills half of F[-1], which is never read.
+################################################################################
+
+#  Next column, sorted into \s0 <= .. <= \s4 (xr11 spare)
+.macro MED5_COLUMN s0, s1, s2, s3, s4
+  s32ldi  \s3,  $t0,  4
+  s32ldi  xr11,  $t1,  4
+  s32ldi  \s2,  $t2,  4
+  s32ldi  \s1,  $t3,  4
+  s32ldi  \s4,  $t4,  4
+  q8min   \s0,  \s3,  xr11
+  q8max   xr11,  \s3,  xr11
+  q8min   \s3,  \s1,  \s4
+  q8max   \s4,  \s1,  \s4
+  q8min   \s1,  \s2,  \s4
+  q8max   \s4,  \s2,  \s4
+  q8min   \s2,  \s1,  \s3
+  q8max   \s3,  \s1,  \s3
+  q8min   \s1,  \s0,  \s3
+  q8max   \s3,  \s0,  \s3
+  q8min   \s0,  \s1,  \s2
+  q8max   \s2,  \s1,  \s2
+  q8min   \s1,  xr11,  \s4
+  q8max   \s4,  xr11,  \s4
+  q8min   xr11,  \s1,  \s3
+  q8max   \s3,  \s1,  \s3
+  q8min   \s1,  xr11,  \s2
+  q8max   \s2,  xr11,  \s2
+.endm
+
+#  The five shifts of rank \i of column \c (previous column \p) into the
+# frames around $t8 (F[k])
+.macro MED5_SHIFTS i, c, p
+  s32alni xr12, \c,   \p,   3             # F[k-1] + 1
+  s32alni xr13, \c,   \p,   2             # F[k-1] + 2, F[k] - 2
+  s32alni xr14, \c,   \p,   1             # F[k] - 1
+  s32std  xr12, $t8,  (5 * \i + 3) * 4 - 100
+  s32std  xr13, $t8,  (5 * \i + 4) * 4 - 100
+  s32std  xr13, $t8,  (5 * \i + 0) * 4
+  s32std  xr14, $t8,  (5 * \i + 1) * 4
+  s32std  \c,   $t8,  (5 * \i + 2) * 4
+.endm
+
+.macro MED5_FRAME c0, c1, c2, c3, c4, p0, p1, p2, p3, p4
+  MED5_COLUMN \c0, \c1, \c2, \c3, \c4
+  MED5_SHIFTS 0, \c0, \p0
+  MED5_SHIFTS 1, \c1, \p1
+  MED5_SHIFTS 2, \c2, \p2
+  MED5_SHIFTS 3, \c3, \p3
+  MED5_SHIFTS 4, \c4, \p4
+  addiu   $t6,  $t6,  -1
+.endm
+
+  .globl  mxu1_median5x5_row
+  .type   mxu1_median5x5_row, @function
+  .ent    mxu1_median5x5_row
+mxu1_median5x5_row:
+  RANK_SETUP 5
+  lw      $t8,  ROWS_FRAMES($a0)
+  addiu   $t6,  $t7,  1                   # Columns after the first
+  MED5_COLUMN xr1, xr2, xr3, xr4, xr5
+  addiu   $t8,  $t8,  100
+  move    $t9,  $t8
+
+1:
+  MED5_FRAME xr6, xr7, xr8, xr9, xr10, xr1, xr2, xr3, xr4, xr5
+  beqz    $t6,  2f
+   addiu  $t8,  $t8,  100
+  MED5_FRAME xr1, xr2, xr3, xr4, xr5, xr6, xr7, xr8, xr9, xr10
+  bnez    $t6,  1b
+   addiu  $t8,  $t8,  100
+
+#  Selection network: the median of F[k] into xr8, in the order scheduled
+# for the fewest registers live
+2:
+  s32ldd  xr1,  $t9,  32
+  s32ldd  xr2,  $t9,  36
+  s32ldd  xr3,  $t9,  28
+  s32ldd  xr4,  $t9,  12
+  s32ldd  xr5,  $t9,  16
+  s32ldd  xr6,  $t9,  8
+  s32ldd  xr7,  $t9,  0
+  q8min   xr8,  xr1,  xr2
+  s32ldd  xr9,  $t9,  4
+  q8max   xr2,  xr1,  xr2
+  q8min   xr1,  xr3,  xr2
+  q8max   xr3,  xr3,  xr2
+  q8min   xr2,  xr4,  xr5
+  q8max   xr5,  xr4,  xr5
+  s32ldd  xr4,  $t9,  20
+  s32ldd  xr10, $t9,  24
+  q8min   xr11, xr6,  xr5
+  q8max   xr6,  xr6,  xr5
+  q8max   xr11, xr11, xr2
+  q8max   xr11, xr7,  xr11
+  q8min   xr7,  xr9,  xr6
+  q8max   xr6,  xr9,  xr6
+  q8max   xr7,  xr7,  xr11
+  q8min   xr11, xr7,  xr6
+  q8max   xr6,  xr7,  xr6
+  q8min   xr7,  xr4,  xr10
+  q8max   xr10, xr4,  xr10
+  q8max   xr7,  xr7,  xr8
+  q8min   xr8,  xr10, xr3
+  q8max   xr3,  xr10, xr3
+  q8min   xr10, xr8,  xr7
+  s32ldd  xr4,  $t9,  52
+  s32ldd  xr9,  $t9,  56
+  q8max   xr7,  xr8,  xr7
+  q8max   xr10, xr10, xr1
+  s32ldd  xr1,  $t9,  48
+  q8min   xr8,  xr10, xr7
+  q8max   xr10, xr10, xr7
+  q8max   xr8,  xr11, xr8
+  q8min   xr11, xr6,  xr10
+  s32ldd  xr7,  $t9,  60
+  s32ldd  xr2,  $t9,  64
+  q8max   xr6,  xr6,  xr10
+  q8min   xr10, xr11, xr8
+  s32ldd  xr5,  $t9,  40
+  s32ldd  xr12, $t9,  44
+  q8max   xr11, xr11, xr8
+  q8min   xr8,  xr4,  xr9
+  q8max   xr9,  xr4,  xr9
+  q8min   xr4,  xr1,  xr9
+  q8max   xr9,  xr1,  xr9
+  q8min   xr1,  xr4,  xr8
+  q8max   xr4,  xr4,  xr8
+  q8min   xr8,  xr7,  xr2
+  q8max   xr7,  xr7,  xr2
+  q8min   xr2,  xr5,  xr12
+  q8max   xr5,  xr5,  xr12
+  q8min   xr5,  xr5,  xr9
+  q8max   xr1,  xr2,  xr1
+  q8min   xr2,  xr3,  xr5
+  q8max   xr3,  xr3,  xr5
+  q8min   xr5,  xr1,  xr4
+  q8max   xr4,  xr1,  xr4
+  q8min   xr4,  xr3,  xr4
+  q8min   xr3,  xr2,  xr5
+  q8max   xr2,  xr2,  xr5
+  q8max   xr11, xr11, xr3
+  q8min   xr3,  xr4,  xr2
+  s32ldd  xr5,  $t9,  72
+  s32ldd  xr1,  $t9,  76
+  q8max   xr4,  xr4,  xr2
+  q8min   xr2,  xr10, xr3
+  q8max   xr3,  xr10, xr3
+  s32ldd  xr10, $t9,  68
+  q8min   xr9,  xr6,  xr3
+  q8max   xr3,  xr6,  xr3
+  q8min   xr6,  xr9,  xr11
+  q8max   xr9,  xr9,  xr11
+  q8min   xr11, xr3,  xr4
+  q8max   xr3,  xr3,  xr4
+  q8min   xr4,  xr5,  xr1
+  q8max   xr1,  xr5,  xr1
+  q8min   xr7,  xr7,  xr1
+  q8min   xr1,  xr10, xr4
+  s32ldd  xr5,  $t9,  92
+  s32ldd  xr12, $t9,  96
+  q8max   xr4,  xr10, xr4
+  q8min   xr10, xr8,  xr4
+  s32ldd  xr13, $t9,  80
+  s32ldd  xr14, $t9,  84
+  q8max   xr8,  xr8,  xr4
+  q8min   xr7,  xr7,  xr8
+  q8min   xr8,  xr10, xr1
+  q8max   xr1,  xr10, xr1
+  q8max   xr8,  xr9,  xr8
+  q8min   xr9,  xr7,  xr1
+  s32ldd  xr10, $t9,  88
+  q8max   xr1,  xr7,  xr1
+  q8min   xr7,  xr5,  xr12
+  q8max   xr12, xr5,  xr12
+  q8min   xr5,  xr13, xr14
+  q8max   xr14, xr13, xr14
+  q8min   xr14, xr14, xr12
+  q8min   xr12, xr5,  xr7
+  q8max   xr5,  xr5,  xr7
+  q8min   xr14, xr14, xr5
+  q8min   xr5,  xr12, xr10
+  q8max   xr10, xr12, xr10
+  q8min   xr14, xr14, xr10
+  q8min   xr10, xr1,  xr5
+  q8max   xr5,  xr1,  xr5
+  q8min   xr14, xr5,  xr14
+  q8min   xr6,  xr6,  xr14
+  q8min   xr14, xr9,  xr10
+  q8max   xr10, xr9,  xr10
+  q8max   xr2,  xr2,  xr14
+  q8min   xr3,  xr3,  xr10
+  q8min   xr8,  xr3,  xr8
+  q8min   xr11, xr11, xr2
+  q8max   xr6,  xr6,  xr11
+  q8max   xr8,  xr6,  xr8
+  addiu   $t7,  $t7,  -1
+  addiu   $t9,  $t9,  100
+  bnez    $t7,  2b
+   s32sdi xr8,  $t5,  4
+
+9:
+  jr      $ra
+  nop
+  .end    mxu1_median5x5_row
+  .size   mxu1_median5x5_row, .-mxu1_median5x5_row
+
+# vim:shiftwidth=2:expandtab:syntax=asm
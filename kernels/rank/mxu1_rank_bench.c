@@ -0,0 +1,198 @@
+// mxu1_rank_bench.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 median, erode and dilate: checks and megapixels per second
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Runs each filter on a 720p luma plane of noisy gradients, checks that the
+// MXU image functions match their _c versions byte for byte (also on odd
+// and tiny sizes, unaligned strides and rows longer than a median 5x5
+// batch, for the C edges and the driver), and prints megapixels per second
+// for both.
+//
+// Build and run on the target (kernels/rank):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -o mxu1_rank_bench
+//         mxu1_rank_bench.c mxu1_rank_image.c mxu1_rank_ref.c mxu1_rank.s
+//         ../dispatch/mxu1_cpu.c
+//     ./mxu1_rank_bench [seconds per test, default 1]
+// Exits non-zero if any output differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mxu1_rank.h"
+#include "../dispatch/mxu1_cpu.h"
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 12345;
+static uint32_t rand16(void)
+{
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 16;
+}
+
+static void *xalloc(size_t n)
+{
+  void *p = malloc(n);
+  if (!p) {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  return p;
+}
+
+typedef void (*filter_fn)(uint8_t *dst, int dst_stride, const uint8_t *src,
+                          int src_stride, int width, int height);
+
+static const struct {
+  const char *name;
+  filter_fn   mxu, c;
+} filters[] = {
+  { "median 3x3", mxu1_median3x3, mxu1_median3x3_c },
+  { "median 5x5", mxu1_median5x5, mxu1_median5x5_c },
+  { "erode 3x3",  mxu1_erode3x3,  mxu1_erode3x3_c  },
+  { "erode 5x5",  mxu1_erode5x5,  mxu1_erode5x5_c  },
+  { "dilate 3x3", mxu1_dilate3x3, mxu1_dilate3x3_c },
+  { "dilate 5x5", mxu1_dilate5x5, mxu1_dilate5x5_c },
+};
+
+typedef struct {
+  uint8_t *src, *dst[2];
+  int      width, height, stride;
+} test;
+
+//  A gradient with noise and some salt and pepper, so that the medians have
+// something to remove and ties are common. 'offset' 1 makes every row and
+// the stride unaligned (the C path).
+static void test_init(test *t, int w, int h, int offset)
+{
+  t->width = w;
+  t->height = h;
+  t->stride = ((w + 3) & ~3) + 4 + offset;
+  for (int i = 0; i < 3; ++i) {
+    uint8_t *p = (uint8_t *)xalloc((size_t)t->stride * h + 4);
+    if (i == 0)
+      t->src = p;
+    else
+      t->dst[i - 1] = p;
+  }
+  for (int y = 0; y < h; ++y)
+    for (int x = 0; x < t->stride; ++x) {
+      const uint32_t r = rand16();
+      int v = (x + y) / 4 + (int)(r % 16) - 8;
+      if (r % 64 == 0)
+        v = r & 64 ? 255 : 0;
+      t->src[offset + (size_t)y * t->stride + x] =
+          (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+    }
+}
+
+static void test_free(test *t)
+{
+  free(t->src);
+  free(t->dst[0]);
+  free(t->dst[1]);
+}
+
+static int check(const test *t, int f, int offset)
+{
+  const size_t bytes = (size_t)t->stride * t->height + 4;
+
+  for (int i = 0; i < 2; ++i) {
+    memset(t->dst[i], 0x5a, bytes);
+    (i ? filters[f].c : filters[f].mxu)(t->dst[i] + offset, t->stride,
+                                         t->src + offset, t->stride,
+                                         t->width, t->height);
+  }
+  return memcmp(t->dst[0], t->dst[1], bytes) != 0;
+}
+
+static double mpix(const test *t, int f, int c, double secs)
+{
+  const filter_fn fn = c ? filters[f].c : filters[f].mxu;
+  unsigned long n = 0;
+  double t0 = now(), dt;
+
+  do {
+    fn(t->dst[0], t->stride, t->src, t->stride, t->width, t->height);
+    ++n;
+    dt = now() - t0;
+  } while (dt < secs);
+  return n * (double)t->width * t->height / dt * 1e-6;
+}
+
+int main(int argc, char **argv)
+{
+  static const struct {
+    int w, h, offset;
+  } edges[] = {
+    {    1,   1, 0 }, {    3,   7, 0 }, {   11,   5, 0 }, {   12,  12, 0 },
+    {   13,   9, 0 }, {   16,   2, 0 }, {  641, 359, 0 }, { 1000,   6, 0 },
+    {  640,  33, 1 }, {   37,  37, 1 },
+  };
+  const int nf = (int)(sizeof(filters) / sizeof(filters[0]));
+  double secs = argc > 1 ? atof(argv[1]) : 1.0;
+  int failed = 0;
+  test t;
+
+  mxu1_cpu_enable();
+
+  for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i) {
+    test_init(&t, edges[i].w, edges[i].h, edges[i].offset);
+    for (int f = 0; f < nf; ++f)
+      if (check(&t, f, edges[i].offset)) {
+        printf("%-10s %dx%d%s: MISMATCH between MXU and C\n",
+               filters[f].name, edges[i].w, edges[i].h,
+               edges[i].offset ? " unaligned" : "");
+        failed = 1;
+      }
+    test_free(&t);
+  }
+
+  test_init(&t, 1280, 720, 0);
+  printf("1280x720          Mpix/s: MXU        C  (MXU vs C)\n");
+  for (int f = 0; f < nf; ++f) {
+    double m, c;
+    if (check(&t, f, 0)) {
+      printf("%-24s MISMATCH between MXU and C\n", filters[f].name);
+      failed = 1;
+      continue;
+    }
+    m = mpix(&t, f, 0, secs);
+    c = mpix(&t, f, 1, secs);
+    printf("%-24s %10.1f %8.1f  x%.2f\n", filters[f].name, m, c, m / c);
+  }
+  test_free(&t);
+
+  return failed;
+}
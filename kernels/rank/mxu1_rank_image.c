@@ -0,0 +1,177 @@
+// mxu1_rank_image.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 median, erode and dilate image functions: borders and edges
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Images are filtered one output row at a time, with the k source row
+// pointers clamped to the image at the top and bottom. When the image is
+// wide enough (12 pixels) and its rows and strides are word aligned, the MXU
+// kernel takes columns 4 .. 4 + n - 1, n the largest multiple of 4 that
+// leaves it a word to read on either side, and the C kernel the columns left
+// over at both ends (whose windows cross the image edge); otherwise the C
+// kernel takes the whole row. mxu1_median5x5_row is called on at most
+// MXU1_RANK_BATCH words at a time, with its frames on the stack.
+//
+//  The driver is written once, against a kernel, so that the _c functions
+// are the same computation with the C kernel throughout.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include "mxu1_rank.h"
+
+typedef void (*rows_fn)(const mxu1_rank_rows *r);
+
+static void filter(uint8_t *dst, int dst_stride, const uint8_t *src,
+                   int src_stride, int width, int height, int k,
+                   rows_fn mxu, rows_fn c)
+{
+  uint32_t frames[MXU1_RANK_FRAMES_SIZE / 4];
+  const int batch = mxu == mxu1_median5x5_row ? 4 * MXU1_RANK_BATCH : width;
+  int n = 0;
+  mxu1_rank_rows r;
+
+  if (width <= 0 || height <= 0)
+    return;
+  if (mxu && width >= 12 &&
+      (((uintptr_t)dst | (uintptr_t)src | (uint32_t)dst_stride |
+        (uint32_t)src_stride) & 3) == 0)
+    n = (width - 8) & ~3;
+
+  r.width = width;
+  r.frames = frames;
+  for (int y = 0; y < height; ++y) {
+    for (int i = 0; i < k; ++i) {
+      int sy = y + i - k / 2;
+      sy = sy < 0 ? 0 : sy >= height ? height - 1 : sy;
+      r.src[i] = src + (intptr_t)sy * src_stride;
+    }
+    r.dst = dst + (intptr_t)y * dst_stride;
+
+    if (n) {
+      for (int x = 4; x < 4 + n; x += batch) {
+        r.x = x;
+        r.n = 4 + n - x < batch ? 4 + n - x : batch;
+        mxu(&r);
+      }
+      r.x = 0;
+      r.n = 4;
+      c(&r);
+    }
+    r.x = n ? 4 + n : 0;
+    r.n = width - r.x;
+    c(&r);
+  }
+}
+
+void mxu1_median3x3(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 3,
+         mxu1_median3x3_row, mxu1_median3x3_row_c);
+}
+
+void mxu1_median5x5(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 5,
+         mxu1_median5x5_row, mxu1_median5x5_row_c);
+}
+
+void mxu1_erode3x3(uint8_t *dst, int dst_stride,
+                   const uint8_t *src, int src_stride, int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 3,
+         mxu1_erode3x3_row, mxu1_erode3x3_row_c);
+}
+
+void mxu1_erode5x5(uint8_t *dst, int dst_stride,
+                   const uint8_t *src, int src_stride, int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 5,
+         mxu1_erode5x5_row, mxu1_erode5x5_row_c);
+}
+
+void mxu1_dilate3x3(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 3,
+         mxu1_dilate3x3_row, mxu1_dilate3x3_row_c);
+}
+
+void mxu1_dilate5x5(uint8_t *dst, int dst_stride,
+                    const uint8_t *src, int src_stride, int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 5,
+         mxu1_dilate5x5_row, mxu1_dilate5x5_row_c);
+}
+
+void mxu1_median3x3_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 3,
+         NULL, mxu1_median3x3_row_c);
+}
+
+void mxu1_median5x5_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 5,
+         NULL, mxu1_median5x5_row_c);
+}
+
+void mxu1_erode3x3_c(uint8_t *dst, int dst_stride,
+                     const uint8_t *src, int src_stride,
+                     int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 3,
+         NULL, mxu1_erode3x3_row_c);
+}
+
+void mxu1_erode5x5_c(uint8_t *dst, int dst_stride,
+                     const uint8_t *src, int src_stride,
+                     int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 5,
+         NULL, mxu1_erode5x5_row_c);
+}
+
+void mxu1_dilate3x3_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 3,
+         NULL, mxu1_dilate3x3_row_c);
+}
+
+void mxu1_dilate5x5_c(uint8_t *dst, int dst_stride,
+                      const uint8_t *src, int src_stride,
+                      int width, int height)
+{
+  filter(dst, dst_stride, src, src_stride, width, height, 5,
+         NULL, mxu1_dilate5x5_row_c);
+}
@@ -0,0 +1,91 @@
+// mxu1_rank_ref.c
+//
+// Scalar C reference for the mxu1_rank.s median, erode and dilate kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  C versions of the row kernels in mxu1_rank.s, with identical arguments
+// and results: the definitions in mxu1_rank.h, one pixel at a time, with
+// columns clamped to the image. They take any span, and are what the image
+// functions use for the edge columns.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_rank.h"
+
+//  Window of output column x: k x k pixels, edge columns repeated
+static void window(const mxu1_rank_rows *r, int k, int32_t x, uint8_t *w)
+{
+  for (int i = 0; i < k; ++i)
+    for (int j = 0; j < k; ++j) {
+      int32_t c = x + j - k / 2;
+      c = c < 0 ? 0 : c >= r->width ? r->width - 1 : c;
+      w[i * k + j] = r->src[i][c];
+    }
+}
+
+static uint8_t median(uint8_t *w, int n)
+{
+  for (int i = 1; i < n; ++i) {
+    const uint8_t v = w[i];
+    int j = i;
+    for (; j > 0 && w[j - 1] > v; --j)
+      w[j] = w[j - 1];
+    w[j] = v;
+  }
+  return w[n / 2];
+}
+
+static uint8_t minimum(uint8_t *w, int n)
+{
+  uint8_t m = w[0];
+  for (int i = 1; i < n; ++i)
+    m = w[i] < m ? w[i] : m;
+  return m;
+}
+
+static uint8_t maximum(uint8_t *w, int n)
+{
+  uint8_t m = w[0];
+  for (int i = 1; i < n; ++i)
+    m = w[i] > m ? w[i] : m;
+  return m;
+}
+
+static void filter(const mxu1_rank_rows *r, int k,
+                   uint8_t (*f)(uint8_t *w, int n))
+{
+  uint8_t w[25];
+  for (int32_t i = 0; i < r->n; ++i) {
+    window(r, k, r->x + i, w);
+    r->dst[r->x + i] = f(w, k * k);
+  }
+}
+
+void mxu1_median3x3_row_c(const mxu1_rank_rows *r) { filter(r, 3, median); }
+void mxu1_median5x5_row_c(const mxu1_rank_rows *r) { filter(r, 5, median); }
+void mxu1_erode3x3_row_c(const mxu1_rank_rows *r)  { filter(r, 3, minimum); }
+void mxu1_erode5x5_row_c(const mxu1_rank_rows *r)  { filter(r, 5, minimum); }
+void mxu1_dilate3x3_row_c(const mxu1_rank_rows *r) { filter(r, 3, maximum); }
+void mxu1_dilate5x5_row_c(const mxu1_rank_rows *r) { filter(r, 5, maximum); }
@@ -0,0 +1,172 @@
+// mxu1_yuv.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 YUV 4:2:0 <-> RGB colour conversion
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Colour conversion between 8-bit YUV 4:2:0 (I420: three planes, NV12: a
+// Y plane and an interleaved U,V plane) and packed RGB (RGB565, RGB888,
+// ARGB8888), both ways, for camera and video paths. The row kernels are in
+// mxu1_yuv.s, each with a C twin in mxu1_yuv_ref.c whose output it matches
+// byte for byte; the frame functions (mxu1_yuv_frame.c) run either set.
+//
+// Arithmetic is BT.601, limited range (Y 16..235, U,V 16..240), in 16-bit
+// fixed point with 6 fractional bits one way and 8 the other, which is what
+// the MXU's 8 x 8-bit multiplies into 16-bit lanes allow:
+//   YUV -> RGB, with u = min(U, 240) (keeps B's sum within 16 bits):
+//     R = clamp((74 Y + 102 V - 14208) >> 6)
+//     G = clamp((74 Y - 25 u - 52 V + 8704) >> 6)
+//     B = clamp((74 Y + 129 u - 17664) >> 6)
+//   RGB -> YUV, chroma from each 2x2 block's average (rounded rows first,
+//   then columns, as q8avgr does: (a + b + 1) >> 1):
+//     Y = (66 R + 129 G + 25 B + 4224) >> 8
+//     U = (-38 R - 74 G + 112 B + 32896) >> 8
+//     V = (112 R - 94 G - 18 B + 32896) >> 8
+// Shifts are arithmetic. Against the exact BT.601 matrices, RGB -> YUV is
+// within 1 everywhere and YUV -> RGB, with its 6-bit coefficients, within 2.4.
+//
+// How the MXU does it (details in mxu1_yuv.s): two rows per pass, so each
+// chroma sample is loaded and its products formed once for the 2x2 pixels
+// it covers; q8mul against replicated coefficients (s32lui) gives four
+// products per instruction, q16add/q16sar/q16sat combine, shift and clamp
+// eight, and s32sfl shuffles planar bytes into packed pixels and back.
+//
+// Pixel formats, as stored in memory:
+//   RGB565    16-bit little-endian words, R in bits 15..11, B in 4..0
+//   RGB888    bytes B, G, R (the DRM/V4L2 'RGB24' little-endian order)
+//   ARGB8888  32-bit little-endian words 0xAARRGGBB; A is written as 255
+// Reading RGB565, each channel is widened by bit replication.
+//
+// The MXU must be enabled (MXU_CR.MXU_EN, bit 0 of xr16) before calling.
+//
+// Build (kernels/yuv, mipsel cross toolchain):
+//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I../.. -c mxu1_yuv.s
+//     mipsel-linux-gcc -O2 -march=mips32r2 -c mxu1_yuv_ref.c mxu1_yuv_frame.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_YUV_H
+#define MXU1_YUV_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  MXU1_RGB565,
+  MXU1_RGB888,
+  MXU1_ARGB8888
+} mxu1_rgb_format;
+
+////////////////////////////////////////////////////////////////////////////////
+// Frames (mxu1_yuv_frame.c)
+////////////////////////////////////////////////////////////////////////////////
+
+//  Any width and height. Strides are in bytes; 'uv' is NV12's interleaved
+// plane, U first. The MXU kernels take the largest multiple of 4 pixels of
+// each row pair when every row starts word aligned, the C kernels the rest;
+// an odd last row is converted on its own (as a pair of itself).
+void mxu1_i420_to_rgb(const uint8_t *y, int y_stride,
+                      const uint8_t *u, const uint8_t *v, int uv_stride,
+                      void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      int width, int height);
+void mxu1_nv12_to_rgb(const uint8_t *y, int y_stride,
+                      const uint8_t *uv, int uv_stride,
+                      void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      int width, int height);
+void mxu1_rgb_to_i420(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      uint8_t *y, int y_stride,
+                      uint8_t *u, uint8_t *v, int uv_stride,
+                      int width, int height);
+void mxu1_rgb_to_nv12(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      uint8_t *y, int y_stride, uint8_t *uv, int uv_stride,
+                      int width, int height);
+
+//  The same, on the C kernels only.
+void mxu1_i420_to_rgb_c(const uint8_t *y, int y_stride,
+                        const uint8_t *u, const uint8_t *v, int uv_stride,
+                        void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        int width, int height);
+void mxu1_nv12_to_rgb_c(const uint8_t *y, int y_stride,
+                        const uint8_t *uv, int uv_stride,
+                        void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        int width, int height);
+void mxu1_rgb_to_i420_c(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        uint8_t *y, int y_stride,
+                        uint8_t *u, uint8_t *v, int uv_stride,
+                        int width, int height);
+void mxu1_rgb_to_nv12_c(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        uint8_t *y, int y_stride, uint8_t *uv, int uv_stride,
+                        int width, int height);
+
+////////////////////////////////////////////////////////////////////////////////
+// Row pair kernels (mxu1_yuv.s), for the driver
+////////////////////////////////////////////////////////////////////////////////
+
+//  Two luma rows, the chroma row they share and the two matching RGB rows,
+// written by the to_rgb kernels and read by the others. For NV12, 'u' is the
+// interleaved U,V row and 'v' is unused. y[1] may equal y[0] and rgb[1]
+// rgb[0] (an odd last row).
+//   MXU kernels: 'width' a multiple of 4, every row word aligned.
+//   C kernels:   any width; an odd last column has a chroma sample to itself.
+typedef struct {
+  uint8_t *y[2];
+  uint8_t *u, *v;
+  uint8_t *rgb[2];
+  int32_t  width;
+} mxu1_yuv_rows;
+
+void mxu1_i420_to_rgb565(const mxu1_yuv_rows *r);
+void mxu1_i420_to_rgb888(const mxu1_yuv_rows *r);
+void mxu1_i420_to_argb(const mxu1_yuv_rows *r);
+void mxu1_nv12_to_rgb565(const mxu1_yuv_rows *r);
+void mxu1_nv12_to_rgb888(const mxu1_yuv_rows *r);
+void mxu1_nv12_to_argb(const mxu1_yuv_rows *r);
+void mxu1_rgb565_to_i420(const mxu1_yuv_rows *r);
+void mxu1_rgb888_to_i420(const mxu1_yuv_rows *r);
+void mxu1_argb_to_i420(const mxu1_yuv_rows *r);
+void mxu1_rgb565_to_nv12(const mxu1_yuv_rows *r);
+void mxu1_rgb888_to_nv12(const mxu1_yuv_rows *r);
+void mxu1_argb_to_nv12(const mxu1_yuv_rows *r);
+
+void mxu1_i420_to_rgb565_c(const mxu1_yuv_rows *r);
+void mxu1_i420_to_rgb888_c(const mxu1_yuv_rows *r);
+void mxu1_i420_to_argb_c(const mxu1_yuv_rows *r);
+void mxu1_nv12_to_rgb565_c(const mxu1_yuv_rows *r);
+void mxu1_nv12_to_rgb888_c(const mxu1_yuv_rows *r);
+void mxu1_nv12_to_argb_c(const mxu1_yuv_rows *r);
+void mxu1_rgb565_to_i420_c(const mxu1_yuv_rows *r);
+void mxu1_rgb888_to_i420_c(const mxu1_yuv_rows *r);
+void mxu1_argb_to_i420_c(const mxu1_yuv_rows *r);
+void mxu1_rgb565_to_nv12_c(const mxu1_yuv_rows *r);
+void mxu1_rgb888_to_nv12_c(const mxu1_yuv_rows *r);
+void mxu1_argb_to_nv12_c(const mxu1_yuv_rows *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MXU1_YUV_H
@@ -0,0 +1,489 @@
+# mxu1_yuv.s
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 YUV 4:2:0 <-> RGB565/RGB888/ARGB8888 row conversion
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  C prototypes, the row pair layout (mxu1_yuv_rows) and the arithmetic are
+# described in mxu1_yuv.h; mxu1_yuv_ref.c is the same computation in C.
+#
+#  Every kernel steps through a row pair 4 pixels at a time: one word of
+# each luma row, two chroma samples of each of U and V, 4 pixels of each RGB
+# row. Bytes are kept planar (a word of 4 R, of 4 G, of 4 B) for the
+# arithmetic, and packed pixels are shuffled in and out with s32sfl.
+#
+#  YUV -> RGB: the two U and two V samples are duplicated to pixel lanes
+# (U1 U1 U0 U0) with one s32sfl, U is clamped with q8min, and the chroma
+# terms 102 V, 25 U + 52 V and 129 U, each with its channel's constant
+# added (q16accm), are formed once for both rows. 74 Y comes from one q8mul
+# per row, then per channel and row pair: four q16add (luma + chroma term),
+# two q16sar by 6 and two q16sat, giving the 4 R, G or B bytes of each row.
+# All sums fit in signed 16 bits (B's is at most 74 * 255 + 129 * 240 - 17664
+# = 32166, hence the clamp).
+#
+#  RGB -> YUV: Y is 66 R + 129 G + 25 B + 4224, at most 60324, formed with
+# q8mul and q16accm in unsigned 16-bit lanes and shifted with q16slr. For
+# chroma, q8avgr averages the two rows, s32sfl splits even and odd columns
+# and a second q8avgr averages those; the 2 samples of each of R, G and B
+# are then left duplicated (c1 c0 c1 c0), so one q8mulsu against a word of
+# signed coefficients (V's in bytes 3,2, U's in 1,0) gives a channel's
+# contribution to both U and V at once.
+#
+#  Pixel packing (forward) and unpacking (reverse), per row of 4 pixels:
+#   ARGB8888: s32sfl pairs A,R and G,B bytes into halfwords, then the
+#             halfwords into pixels; the reverse is two rounds of s32sfl
+#             pattern 1, which gathers every second byte.
+#   RGB888:   as ARGB with A = 0, then s32alni joins 4 pixels' low 3 bytes
+#             into 3 words; reading, s32alni splits them back.
+#   RGB565:   R and B are masked and shifted down 3 bits in their bytes, R
+#             and the masked G paired into halfwords and shifted up 3 bits,
+#             and B added at the bottom; reading, each field is
+#             shifted to the top of a byte with q16sll/q16slr, narrowed with
+#             q16sat and its top bits replicated below.
+#
+# Register use: any xr, $t0..$t9, $a1. Leaf functions, no stack.
+################################################################################
+
+  .include "mxu1_as_macros.s.h"
+
+  .text
+  .set noreorder
+
+# mxu1_yuv_rows field offsets
+  .equ    ROWS_Y0,        0
+  .equ    ROWS_Y1,        4
+  .equ    ROWS_U,         8
+  .equ    ROWS_V,         12
+  .equ    ROWS_RGB0,      16
+  .equ    ROWS_RGB1,      20
+  .equ    ROWS_WIDTH,     24
+
+
+################################################################################
+# YUV -> RGB
+#
+#  Chroma: U in xr1 and V in xr2 as (s1 s1 s0 s0); then the terms, 102 V +
+# K_R in xr5 (pixels 3,2) and xr6 (1,0), 25 U + 52 V + K_G in xr7/xr8 and
+# 129 U + K_B in xr9/xr10. $a1 holds q8min's bound, 240 in the U bytes.
+################################################################################
+
+.macro YUV_CHROMA_LOAD_I420
+  s16ldi  xr1,  $t2,  2,  0               # (x x U1 U0)
+  s32i2m  xr15, $a1
+  s16ldi  xr1,  $t3,  2,  1               # (V1 V0 U1 U0)
+.endm
+
+.macro YUV_CHROMA_I420
+  q8min   xr1,  xr1,  xr15
+  s32sfl  xr2,  xr1,  xr1,  xr1,  0       # (V1 V1 V0 V0), (U1 U1 U0 U0)
+.endm
+
+.macro YUV_CHROMA_LOAD_NV12
+  s32ldi  xr1,  $t2,  4                   # (V1 U1 V0 U0)
+  s32i2m  xr15, $a1
+.endm
+
+.macro YUV_CHROMA_NV12
+  q8min   xr1,  xr1,  xr15
+  s32sfl  xr1,  xr1,  xr1,  xr2,  0       # (V1 V1 U1 U1), (V0 V0 U0 U0)
+  s32sfl  xr2,  xr1,  xr2,  xr1,  3       # (V1 V1 V0 V0), (U1 U1 U0 U0)
+.endm
+
+#  One channel for both rows: 74 Y in xr1/xr2 (row 0) and xr3/xr4 (row 1)
+# plus or minus the term in \hi/\lo, which are replaced by the row 0 and row
+# 1 bytes
+.macro YUV_CHANNEL aptn, hi, lo
+  q16add  xr11, xr1,  \hi,  xr0,  \aptn, WW
+  q16add  xr12, xr2,  \lo,  xr0,  \aptn, WW
+  q16add  xr13, xr3,  \hi,  xr0,  \aptn, WW
+  q16add  xr14, xr4,  \lo,  xr0,  \aptn, WW
+  q16sar  xr11, xr11, xr12, xr12, 6
+  q16sar  xr13, xr13, xr14, xr14, 6
+  q16sat  \hi,  xr11, xr12
+  q16sat  \lo,  xr13, xr14
+.endm
+
+#  Packing one row of 4 pixels from R in \r, G in \g and B in \b, stored at
+# \p. xr1..xr4 and xr11..xr15 are free but for the constants the setup
+# macro leaves in xr15 (and xr14 for RGB565).
+.macro YUV_PUT_SETUP_ARGB
+  s32lui  xr15, 0xff, 7
+.endm
+
+.macro YUV_PUT_ARGB p, r, g, b
+  s32sfl  xr11, xr15, \r,   xr12, 0       # (A3 R3 A2 R2), (A1 R1 A0 R0)
+  s32sfl  xr13, \g,   \b,   xr14, 0       # (G3 B3 G2 B2), (G1 B1 G0 B0)
+  s32sfl  xr1,  xr12, xr14, xr2,  3       # Pixels 1, 0
+  s32sfl  xr3,  xr11, xr13, xr4,  3       # Pixels 3, 2
+  s32sdi  xr2,  \p,   4
+  s32sdi  xr1,  \p,   4
+  s32sdi  xr4,  \p,   4
+  s32sdi  xr3,  \p,   4
+.endm
+
+.macro YUV_PUT_SETUP_RGB888
+.endm
+
+#  Pixels P0..P3 as ARGB with A = 0, Q = P << 8; then
+# w0 = P1 << 24 | P0, w1 = P2 << 16 | P1 >> 8, w2 = P3 << 8 | P2 >> 16.
+.macro YUV_PUT_RGB888 p, r, g, b
+  s32sfl  xr11, xr0,  \r,   xr12, 0
+  s32sfl  xr13, \g,   \b,   xr14, 0
+  s32sfl  xr1,  xr12, xr14, xr2,  3       # P1, P0
+  s32sfl  xr3,  xr11, xr13, xr4,  3       # P3, P2
+  d32sll  xr11, xr2,  xr1,  xr12, 8       # Q0, Q1
+  d32sll  xr13, xr4,  xr0,  xr0,  8       # Q2
+  s32alni xr2,  xr1,  xr11, 3
+  s32alni xr1,  xr4,  xr12, 2
+  s32alni xr4,  xr3,  xr13, 1
+  s32sdi  xr2,  \p,   4
+  s32sdi  xr1,  \p,   4
+  s32sdi  xr4,  \p,   4
+.endm
+
+.macro YUV_PUT_SETUP_RGB565
+  s32lui  xr15, 0xf8, 7
+  s32lui  xr14, 0xfc, 7
+.endm
+
+.macro YUV_PUT_RGB565 p, r, g, b
+  s32and  xr11, \r,   xr15
+  s32and  xr12, \g,   xr14
+  s32and  xr13, \b,   xr15
+  q16slr  xr11, xr11, xr13, xr13, 3       # R >> 3, B >> 3: no bits cross bytes
+  s32sfl  xr1,  xr11, xr12, xr2,  0       # (R3 G3 R2 G2), (R1 G1 R0 G0)
+  s32sfl  xr3,  xr0,  xr13, xr4,  0       # (0 B3 0 B2), (0 B1 0 B0)
+  q16sll  xr1,  xr1,  xr2,  xr2,  3
+  s32or   xr2,  xr2,  xr4                 # Pixels 1, 0
+  s32or   xr1,  xr1,  xr3                 # Pixels 3, 2
+  s32sdi  xr2,  \p,   4
+  s32sdi  xr1,  \p,   4
+.endm
+
+.macro YUV_TO_RGB name, layout, fmt
+  .globl  \name
+  .type   \name, @function
+  .ent    \name
+\name:
+  lw      $t0,  ROWS_Y0($a0)
+  lw      $t1,  ROWS_Y1($a0)
+  lw      $t2,  ROWS_U($a0)
+  lw      $t3,  ROWS_V($a0)
+  lw      $t4,  ROWS_RGB0($a0)
+  lw      $t5,  ROWS_RGB1($a0)
+  lw      $t6,  ROWS_WIDTH($a0)
+  li      $t7,  0xc880c880                # K_R = -14208
+  li      $t8,  0xde00de00                # K_G = -8704
+  li      $t9,  0xbb00bb00                # K_B = -17664
+  sra     $t6,  $t6,  2
+  blez    $t6,  9f
+  addiu   $t0,  $t0,  -4
+  addiu   $t1,  $t1,  -4
+  addiu   $t4,  $t4,  -4
+  addiu   $t5,  $t5,  -4
+  .ifc \layout, I420
+  li      $a1,  0xfffff0f0
+  addiu   $t2,  $t2,  -2
+  addiu   $t3,  $t3,  -2
+  .else
+  li      $a1,  0xfff0fff0
+  addiu   $t2,  $t2,  -4
+  .endif
+
+1:
+  YUV_CHROMA_LOAD_\layout
+  s32ldi  xr11, $t0,  4                   # Y, row 0
+  s32ldi  xr12, $t1,  4                   # Y, row 1
+  YUV_CHROMA_\layout
+  s32lui  xr15, 102,  7
+  q8mul   xr5,  xr2,  xr15, xr6           # 102 V
+  s32lui  xr15, 52,   7
+  q8mul   xr7,  xr2,  xr15, xr8           # 52 V
+  s32lui  xr15, 25,   7
+  q8mul   xr3,  xr1,  xr15, xr4           # 25 U
+  s32lui  xr15, 129,  7
+  q8mul   xr9,  xr1,  xr15, xr10          # 129 U
+  q16accm xr7,  xr3,  xr4,  xr8,  AA
+  s32i2m  xr15, $t7
+  q16accm xr5,  xr15, xr15, xr6,  AA
+  s32i2m  xr15, $t8
+  q16accm xr7,  xr15, xr15, xr8,  AA
+  s32i2m  xr15, $t9
+  q16accm xr9,  xr15, xr15, xr10, AA
+  s32lui  xr15, 74,   7
+  q8mul   xr1,  xr11, xr15, xr2
+  q8mul   xr3,  xr12, xr15, xr4
+  YUV_CHANNEL AA, xr5, xr6                # R
+  YUV_CHANNEL SS, xr7, xr8                # G
+  YUV_CHANNEL AA, xr9, xr10               # B
+  YUV_PUT_SETUP_\fmt
+  YUV_PUT_\fmt $t4, xr5, xr7, xr9
+  addiu   $t6,  $t6,  -1
+  YUV_PUT_\fmt $t5, xr6, xr8, xr10
+  bnez    $t6,  1b
+  nop
+
+9:
+  jr      $ra
+  nop
+  .end    \name
+  .size   \name, .-\name
+.endm
+
+
+################################################################################
+# void mxu1_i420_to_rgb565(const mxu1_yuv_rows *r)
+  YUV_TO_RGB mxu1_i420_to_rgb565, I420, RGB565
+
+
+################################################################################
+# void mxu1_i420_to_rgb888(const mxu1_yuv_rows *r)
+  YUV_TO_RGB mxu1_i420_to_rgb888, I420, RGB888
+
+
+################################################################################
+# void mxu1_i420_to_argb(const mxu1_yuv_rows *r)
+  YUV_TO_RGB mxu1_i420_to_argb, I420, ARGB
+
+
+################################################################################
+# void mxu1_nv12_to_rgb565(const mxu1_yuv_rows *r)
+  YUV_TO_RGB mxu1_nv12_to_rgb565, NV12, RGB565
+
+
+################################################################################
+# void mxu1_nv12_to_rgb888(const mxu1_yuv_rows *r)
+  YUV_TO_RGB mxu1_nv12_to_rgb888, NV12, RGB888
+
+
+################################################################################
+# void mxu1_nv12_to_argb(const mxu1_yuv_rows *r)
+  YUV_TO_RGB mxu1_nv12_to_argb, NV12, ARGB
+
+
+################################################################################
+# RGB -> YUV
+#
+#  Each row's 4 pixels are unpacked to R, G and B words: row 0 to xr1..xr3,
+# row 1 to xr4..xr6. $t7 holds Y's constant, $t8, $t9 and $a1 the chroma
+# coefficients of R, G and B: (V V U U) as signed bytes.
+################################################################################
+
+#  Pixels P0..P3 (as ARGB, any A) in \p0..\p3 to R in \r, G in \g, B in \b
+.macro YUV_PLANAR r, g, b, p0, p1, p2, p3
+  s32sfl  \p0,  \p1,  \p0,  \p1,  1       # (A1 G1 A0 G0), (R1 B1 R0 B0)
+  s32sfl  \p2,  \p3,  \p2,  \p3,  1       # (A3 G3 A2 G2), (R3 B3 R2 B2)
+  s32sfl  \r,   \p3,  \p1,  \b,   1
+  s32sfl  xr0,  \p2,  \p0,  \g,   1
+.endm
+
+.macro YUV_GET_SETUP_ARGB
+.endm
+
+.macro YUV_GET_ARGB p, r, g, b
+  s32ldi  xr11, \p,   4
+  s32ldi  xr12, \p,   4
+  s32ldi  xr13, \p,   4
+  s32ldi  xr14, \p,   4
+  YUV_PLANAR \r, \g, \b, xr11, xr12, xr13, xr14
+.endm
+
+.macro YUV_GET_SETUP_RGB888
+.endm
+
+.macro YUV_GET_RGB888 p, r, g, b
+  s32ldi  xr11, \p,   4                   # (B1 R0 G0 B0)
+  s32ldi  xr12, \p,   4                   # (G2 B2 R1 G1)
+  s32ldi  xr13, \p,   4                   # (R3 G3 B3 R2)
+  s32alni xr14, xr12, xr11, 1             # P1
+  s32alni xr12, xr13, xr12, 2             # P2
+  s32alni xr13, xr0,  xr13, 3             # P3
+  YUV_PLANAR \r, \g, \b, xr11, xr14, xr12, xr13
+.endm
+
+#  Field masks and the replication masks, in xr7..xr10
+.macro YUV_GET_SETUP_RGB565
+  s32lui  xr7,  0xf8, 7
+  s32lui  xr8,  0xfc, 7
+  s32lui  xr9,  0x07, 7
+  s32lui  xr10, 0x03, 7
+.endm
+
+.macro YUV_GET_RGB565 p, r, g, b
+  s32ldi  xr11, \p,   4                   # Pixels 1, 0
+  s32ldi  xr12, \p,   4                   # Pixels 3, 2
+  q16slr  xr13, xr12, xr11, xr14, 8       # R << 3 | G >> 3
+  q16sat  \r,   xr13, xr14
+  q16sll  xr13, xr12, xr11, xr14, 5
+  q16slr  xr13, xr13, xr14, xr14, 8       # G << 2 | B >> 3
+  q16sat  \g,   xr13, xr14
+  q16sll  xr13, xr12, xr11, xr14, 11
+  q16slr  xr13, xr13, xr14, xr14, 8       # B << 3
+  q16sat  \b,   xr13, xr14
+  s32and  \r,   \r,   xr7
+  s32and  \g,   \g,   xr8
+  q16slr  xr13, \r,   \b,   xr14, 5
+  q16slr  xr11, \g,   xr0,  xr0,  6
+  s32and  xr13, xr13, xr9
+  s32and  xr14, xr14, xr9
+  s32and  xr11, xr11, xr10
+  s32or   \r,   \r,   xr13
+  s32or   \b,   \b,   xr14
+  s32or   \g,   \g,   xr11
+.endm
+
+#  U in xr8 (s1 s0), V in xr7, 16-bit lanes, to the chroma row(s)
+.macro YUV_STORE_I420
+  q16sat  xr7,  xr7,  xr8                 # (V1 V0 U1 U0)
+  s16sdi  xr7,  $t4,  2,  0
+  s16sdi  xr7,  $t5,  2,  1
+.endm
+
+.macro YUV_STORE_NV12
+  s32sfl  xr7,  xr7,  xr8,  xr8,  3       # (V1 U1), (V0 U0)
+  q16sat  xr7,  xr7,  xr8
+  s32sdi  xr7,  $t4,  4
+.endm
+
+.macro RGB_TO_YUV name, fmt, layout
+  .globl  \name
+  .type   \name, @function
+  .ent    \name
+\name:
+  lw      $t0,  ROWS_RGB0($a0)
+  lw      $t1,  ROWS_RGB1($a0)
+  lw      $t2,  ROWS_Y0($a0)
+  lw      $t3,  ROWS_Y1($a0)
+  lw      $t4,  ROWS_U($a0)
+  lw      $t5,  ROWS_V($a0)
+  lw      $t6,  ROWS_WIDTH($a0)
+  li      $t7,  0x10801080                # 4224
+  li      $t8,  0x7070dada                # R: 112, -38
+  li      $t9,  0xa2a2b6b6                # G: -94, -74
+  li      $a1,  0xeeee7070                # B: -18, 112
+  sra     $t6,  $t6,  2
+  blez    $t6,  9f
+  addiu   $t0,  $t0,  -4
+  addiu   $t1,  $t1,  -4
+  addiu   $t2,  $t2,  -4
+  addiu   $t3,  $t3,  -4
+  .ifc \layout, I420
+  addiu   $t4,  $t4,  -2
+  addiu   $t5,  $t5,  -2
+  .else
+  addiu   $t4,  $t4,  -4
+  .endif
+
+1:
+  YUV_GET_SETUP_\fmt
+  YUV_GET_\fmt $t0, xr1, xr2, xr3
+  YUV_GET_\fmt $t1, xr4, xr5, xr6
+
+  s32lui  xr15, 66,   7                   # Y, both rows: xr7/xr8, xr11/xr12
+  q8mul   xr7,  xr1,  xr15, xr8
+  q8mul   xr11, xr4,  xr15, xr12
+  s32lui  xr15, 129,  7
+  q8mul   xr9,  xr2,  xr15, xr10
+  q8mul   xr13, xr5,  xr15, xr14
+  q16accm xr7,  xr9,  xr10, xr8,  AA
+  q16accm xr11, xr13, xr14, xr12, AA
+  s32lui  xr15, 25,   7
+  q8mul   xr9,  xr3,  xr15, xr10
+  q8mul   xr13, xr6,  xr15, xr14
+  q16accm xr7,  xr9,  xr10, xr8,  AA
+  q16accm xr11, xr13, xr14, xr12, AA
+  s32i2m  xr15, $t7
+  q16accm xr7,  xr15, xr15, xr8,  AA
+  q16accm xr11, xr15, xr15, xr12, AA
+  q16slr  xr7,  xr7,  xr8,  xr8,  8
+  q16slr  xr11, xr11, xr12, xr12, 8
+  q16sat  xr7,  xr7,  xr8
+  q16sat  xr11, xr11, xr12
+  s32sdi  xr7,  $t2,  4
+  s32sdi  xr11, $t3,  4
+
+  q8avgr  xr1,  xr1,  xr4                 # Chroma: rows averaged,
+  q8avgr  xr2,  xr2,  xr5
+  q8avgr  xr3,  xr3,  xr6
+  s32sfl  xr4,  xr1,  xr1,  xr5,  1       # (3 1 3 1), (2 0 2 0)
+  q8avgr  xr1,  xr4,  xr5                 #  then columns: (c1 c0 c1 c0)
+  s32sfl  xr4,  xr2,  xr2,  xr5,  1
+  q8avgr  xr2,  xr4,  xr5
+  s32sfl  xr4,  xr3,  xr3,  xr5,  1
+  q8avgr  xr3,  xr4,  xr5
+  s32i2m  xr15, $t8
+  q8mulsu xr7,  xr15, xr1,  xr8           # V in xr7, U in xr8
+  s32i2m  xr15, $t9
+  q8mulsu xr9,  xr15, xr2,  xr10
+  s32i2m  xr15, $a1
+  q8mulsu xr11, xr15, xr3,  xr12
+  s32lui  xr15, 0x80, 7                   # 32896
+  q16accm xr7,  xr9,  xr10, xr8,  AA
+  q16accm xr7,  xr11, xr12, xr8,  AA
+  q16accm xr7,  xr15, xr15, xr8,  AA
+  q16slr  xr7,  xr7,  xr8,  xr8,  8
+  addiu   $t6,  $t6,  -1
+  YUV_STORE_\layout
+  bnez    $t6,  1b
+  nop
+
+9:
+  jr      $ra
+  nop
+  .end    \name
+  .size   \name, .-\name
+.endm
+
+
+################################################################################
+# void mxu1_rgb565_to_i420(const mxu1_yuv_rows *r)
+  RGB_TO_YUV mxu1_rgb565_to_i420, RGB565, I420
+
+
+################################################################################
+# void mxu1_rgb888_to_i420(const mxu1_yuv_rows *r)
+  RGB_TO_YUV mxu1_rgb888_to_i420, RGB888, I420
+
+
+################################################################################
+# void mxu1_argb_to_i420(const mxu1_yuv_rows *r)
+  RGB_TO_YUV mxu1_argb_to_i420, ARGB, I420
+
+
+################################################################################
+# void mxu1_rgb565_to_nv12(const mxu1_yuv_rows *r)
+  RGB_TO_YUV mxu1_rgb565_to_nv12, RGB565, NV12
+
+
+################################################################################
+# void mxu1_rgb888_to_nv12(const mxu1_yuv_rows *r)
+  RGB_TO_YUV mxu1_rgb888_to_nv12, RGB888, NV12
+
+
+################################################################################
+# void mxu1_argb_to_nv12(const mxu1_yuv_rows *r)
+  RGB_TO_YUV mxu1_argb_to_nv12, ARGB, NV12
+
+# vim:shiftwidth=2:expandtab:syntax=asm
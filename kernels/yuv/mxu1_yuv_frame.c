@@ -0,0 +1,232 @@
+// mxu1_yuv_frame.c
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 YUV <-> RGB frame drivers: row pairs and edges
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Frames are converted one row pair at a time. The MXU kernel takes the
+// first width & ~3 pixels of a pair when all its rows are word aligned, and
+// the C kernel the rest (or all of it otherwise), starting at the matching
+// offset in each row. An odd last row is passed as a pair of itself, which
+// both directions handle: it is written twice with the same bytes, and its
+// chroma is the average of the row with itself.
+//
+//  The driver is written once, against tables of kernels indexed by chroma
+// layout and pixel format, so that the _c functions are the same
+// computation on the C kernels.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include "mxu1_yuv.h"
+
+typedef void (*row_fn)(const mxu1_yuv_rows *r);
+
+//  [nv12][fmt]
+static const row_fn to_rgb_mxu[2][3] = {
+  { mxu1_i420_to_rgb565, mxu1_i420_to_rgb888, mxu1_i420_to_argb },
+  { mxu1_nv12_to_rgb565, mxu1_nv12_to_rgb888, mxu1_nv12_to_argb }
+};
+static const row_fn to_rgb_c[2][3] = {
+  { mxu1_i420_to_rgb565_c, mxu1_i420_to_rgb888_c, mxu1_i420_to_argb_c },
+  { mxu1_nv12_to_rgb565_c, mxu1_nv12_to_rgb888_c, mxu1_nv12_to_argb_c }
+};
+static const row_fn from_rgb_mxu[2][3] = {
+  { mxu1_rgb565_to_i420, mxu1_rgb888_to_i420, mxu1_argb_to_i420 },
+  { mxu1_rgb565_to_nv12, mxu1_rgb888_to_nv12, mxu1_argb_to_nv12 }
+};
+static const row_fn from_rgb_c[2][3] = {
+  { mxu1_rgb565_to_i420_c, mxu1_rgb888_to_i420_c, mxu1_argb_to_i420_c },
+  { mxu1_rgb565_to_nv12_c, mxu1_rgb888_to_nv12_c, mxu1_argb_to_nv12_c }
+};
+
+typedef struct {
+  uint8_t *y, *u, *v, *rgb;
+  int      y_stride, uv_stride, rgb_stride;
+  int      width, height;
+  int      nv12;
+  int      bpp;               // RGB bytes per pixel
+} yuv_frame;
+
+static int bytes_per_pixel(mxu1_rgb_format fmt)
+{
+  return fmt == MXU1_RGB565 ? 2 : fmt == MXU1_RGB888 ? 3 : 4;
+}
+
+//  NV12's r->v is NULL
+static int words_aligned(const mxu1_yuv_rows *r)
+{
+  const uintptr_t a = (uintptr_t)r->y[0] | (uintptr_t)r->y[1] |
+                      (uintptr_t)r->u | (uintptr_t)r->v |
+                      (uintptr_t)r->rgb[0] | (uintptr_t)r->rgb[1];
+  return (a & 3) == 0;
+}
+
+static void run(const yuv_frame *f, row_fn mxu, row_fn c)
+{
+  mxu1_yuv_rows r;
+
+  for (int row = 0; row < f->height; row += 2) {
+    const int pair = row + 1 < f->height;
+    const size_t uv_off = (size_t)(row / 2) * f->uv_stride;
+
+    r.y[0] = f->y + (size_t)row * f->y_stride;
+    r.y[1] = pair ? r.y[0] + f->y_stride : r.y[0];
+    r.u = f->u + uv_off;
+    r.v = f->nv12 ? NULL : f->v + uv_off;
+    r.rgb[0] = f->rgb + (size_t)row * f->rgb_stride;
+    r.rgb[1] = pair ? r.rgb[0] + f->rgb_stride : r.rgb[0];
+
+    int n = 0;
+    if (mxu && words_aligned(&r)) {
+      n = f->width & ~3;
+      r.width = n;
+      if (n)
+        mxu(&r);
+    }
+    if (n < f->width) {
+      r.y[0] += n;
+      r.y[1] += n;
+      r.u += f->nv12 ? n : n / 2;
+      if (!f->nv12)
+        r.v += n / 2;
+      r.rgb[0] += n * f->bpp;
+      r.rgb[1] += n * f->bpp;
+      r.width = f->width - n;
+      c(&r);
+    }
+  }
+}
+
+static void setup(yuv_frame *f, int nv12, const uint8_t *y, int y_stride,
+                  const uint8_t *u, const uint8_t *v, int uv_stride,
+                  const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                  int width, int height)
+{
+  f->y = (uint8_t *)y;
+  f->u = (uint8_t *)u;
+  f->v = (uint8_t *)v;
+  f->rgb = (uint8_t *)rgb;
+  f->y_stride = y_stride;
+  f->uv_stride = uv_stride;
+  f->rgb_stride = rgb_stride;
+  f->width = width;
+  f->height = height;
+  f->nv12 = nv12;
+  f->bpp = bytes_per_pixel(fmt);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// YUV -> RGB
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_i420_to_rgb(const uint8_t *y, int y_stride,
+                      const uint8_t *u, const uint8_t *v, int uv_stride,
+                      void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 0, y, y_stride, u, v, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, to_rgb_mxu[0][fmt], to_rgb_c[0][fmt]);
+}
+
+void mxu1_nv12_to_rgb(const uint8_t *y, int y_stride,
+                      const uint8_t *uv, int uv_stride,
+                      void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 1, y, y_stride, uv, NULL, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, to_rgb_mxu[1][fmt], to_rgb_c[1][fmt]);
+}
+
+void mxu1_i420_to_rgb_c(const uint8_t *y, int y_stride,
+                        const uint8_t *u, const uint8_t *v, int uv_stride,
+                        void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 0, y, y_stride, u, v, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, NULL, to_rgb_c[0][fmt]);
+}
+
+void mxu1_nv12_to_rgb_c(const uint8_t *y, int y_stride,
+                        const uint8_t *uv, int uv_stride,
+                        void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 1, y, y_stride, uv, NULL, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, NULL, to_rgb_c[1][fmt]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// RGB -> YUV
+////////////////////////////////////////////////////////////////////////////////
+
+void mxu1_rgb_to_i420(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      uint8_t *y, int y_stride,
+                      uint8_t *u, uint8_t *v, int uv_stride,
+                      int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 0, y, y_stride, u, v, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, from_rgb_mxu[0][fmt], from_rgb_c[0][fmt]);
+}
+
+void mxu1_rgb_to_nv12(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                      uint8_t *y, int y_stride, uint8_t *uv, int uv_stride,
+                      int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 1, y, y_stride, uv, NULL, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, from_rgb_mxu[1][fmt], from_rgb_c[1][fmt]);
+}
+
+void mxu1_rgb_to_i420_c(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        uint8_t *y, int y_stride,
+                        uint8_t *u, uint8_t *v, int uv_stride,
+                        int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 0, y, y_stride, u, v, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, NULL, from_rgb_c[0][fmt]);
+}
+
+void mxu1_rgb_to_nv12_c(const void *rgb, int rgb_stride, mxu1_rgb_format fmt,
+                        uint8_t *y, int y_stride, uint8_t *uv, int uv_stride,
+                        int width, int height)
+{
+  yuv_frame f;
+  setup(&f, 1, y, y_stride, uv, NULL, uv_stride, rgb, rgb_stride, fmt,
+        width, height);
+  run(&f, NULL, from_rgb_c[1][fmt]);
+}
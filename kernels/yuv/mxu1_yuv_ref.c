@@ -0,0 +1,164 @@
+// mxu1_yuv_ref.c
+//
+// Scalar C reference for the mxu1_yuv.s row pair kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  C versions of the row pair kernels in mxu1_yuv.s, with identical
+// arguments and results: the definition of the arithmetic in mxu1_yuv.h,
+// one pixel at a time. They take any width, and are what the frame
+// functions fall back on for the columns the MXU kernels leave.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_yuv.h"
+
+static uint8_t clamp8(int32_t x)
+{
+  return (uint8_t)(x < 0 ? 0 : x > 255 ? 255 : x);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// YUV -> RGB
+////////////////////////////////////////////////////////////////////////////////
+
+static void put_pixel(uint8_t *p, int x, mxu1_rgb_format fmt,
+                      int32_t yy, int32_t u, int32_t v)
+{
+  const int32_t y74 = 74 * yy;
+  const uint8_t r = clamp8((y74 + 102 * v - 14208) >> 6);
+  const uint8_t g = clamp8((y74 - 25 * u - 52 * v + 8704) >> 6);
+  const uint8_t b = clamp8((y74 + 129 * u - 17664) >> 6);
+
+  switch (fmt) {
+    case MXU1_RGB565: {
+      const uint16_t w = (uint16_t)((r >> 3) << 11 | (g >> 2) << 5 | b >> 3);
+      p[2 * x] = (uint8_t)w;
+      p[2 * x + 1] = (uint8_t)(w >> 8);
+      break;
+    }
+    case MXU1_RGB888:
+      p[3 * x] = b;
+      p[3 * x + 1] = g;
+      p[3 * x + 2] = r;
+      break;
+    default:
+      p[4 * x] = b;
+      p[4 * x + 1] = g;
+      p[4 * x + 2] = r;
+      p[4 * x + 3] = 255;
+      break;
+  }
+}
+
+// Pixel x's chroma: I420 u[x / 2] and v[x / 2], NV12 u[x & ~1] and the byte after
+static void to_rgb(const mxu1_yuv_rows *r, mxu1_rgb_format fmt, int nv12)
+{
+  for (int x = 0; x < r->width; ++x) {
+    const int i = x >> 1;
+    int32_t u = nv12 ? r->u[2 * i] : r->u[i];
+    const int32_t v = nv12 ? r->u[2 * i + 1] : r->v[i];
+    if (u > 240)
+      u = 240;
+    put_pixel(r->rgb[0], x, fmt, r->y[0][x], u, v);
+    put_pixel(r->rgb[1], x, fmt, r->y[1][x], u, v);
+  }
+}
+
+void mxu1_i420_to_rgb565_c(const mxu1_yuv_rows *r) { to_rgb(r, MXU1_RGB565, 0); }
+void mxu1_i420_to_rgb888_c(const mxu1_yuv_rows *r) { to_rgb(r, MXU1_RGB888, 0); }
+void mxu1_i420_to_argb_c(const mxu1_yuv_rows *r)   { to_rgb(r, MXU1_ARGB8888, 0); }
+void mxu1_nv12_to_rgb565_c(const mxu1_yuv_rows *r) { to_rgb(r, MXU1_RGB565, 1); }
+void mxu1_nv12_to_rgb888_c(const mxu1_yuv_rows *r) { to_rgb(r, MXU1_RGB888, 1); }
+void mxu1_nv12_to_argb_c(const mxu1_yuv_rows *r)   { to_rgb(r, MXU1_ARGB8888, 1); }
+
+////////////////////////////////////////////////////////////////////////////////
+// RGB -> YUV
+////////////////////////////////////////////////////////////////////////////////
+
+static void get_pixel(const uint8_t *p, int x, mxu1_rgb_format fmt,
+                      int32_t rgb[3])
+{
+  switch (fmt) {
+    case MXU1_RGB565: {
+      const uint32_t w = p[2 * x] | (uint32_t)p[2 * x + 1] << 8;
+      const uint32_t r5 = w >> 11, g6 = (w >> 5) & 63, b5 = w & 31;
+      rgb[0] = (int32_t)(r5 << 3 | r5 >> 2);
+      rgb[1] = (int32_t)(g6 << 2 | g6 >> 4);
+      rgb[2] = (int32_t)(b5 << 3 | b5 >> 2);
+      break;
+    }
+    case MXU1_RGB888:
+      rgb[0] = p[3 * x + 2];
+      rgb[1] = p[3 * x + 1];
+      rgb[2] = p[3 * x];
+      break;
+    default:
+      rgb[0] = p[4 * x + 2];
+      rgb[1] = p[4 * x + 1];
+      rgb[2] = p[4 * x];
+      break;
+  }
+}
+
+static int32_t avgr(int32_t a, int32_t b)
+{
+  return (a + b + 1) >> 1;
+}
+
+static void from_rgb(const mxu1_yuv_rows *r, mxu1_rgb_format fmt, int nv12)
+{
+  for (int x = 0; x < r->width; x += 2) {
+    const int x1 = x + 1 < r->width ? x + 1 : x;
+    int32_t p[4][3], c[3];
+
+    get_pixel(r->rgb[0], x, fmt, p[0]);
+    get_pixel(r->rgb[0], x1, fmt, p[1]);
+    get_pixel(r->rgb[1], x, fmt, p[2]);
+    get_pixel(r->rgb[1], x1, fmt, p[3]);
+
+    for (int k = 0; k < 4; ++k)
+      r->y[k >> 1][k & 1 ? x1 : x] =
+          (uint8_t)((66 * p[k][0] + 129 * p[k][1] + 25 * p[k][2] + 4224) >> 8);
+
+    for (int ch = 0; ch < 3; ++ch)
+      c[ch] = avgr(avgr(p[0][ch], p[2][ch]), avgr(p[1][ch], p[3][ch]));
+    const uint8_t u = (uint8_t)((-38 * c[0] - 74 * c[1] + 112 * c[2] + 32896) >> 8);
+    const uint8_t v = (uint8_t)((112 * c[0] - 94 * c[1] - 18 * c[2] + 32896) >> 8);
+    if (nv12) {
+      r->u[x] = u;
+      r->u[x + 1] = v;
+    } else {
+      r->u[x >> 1] = u;
+      r->v[x >> 1] = v;
+    }
+  }
+}
+
+void mxu1_rgb565_to_i420_c(const mxu1_yuv_rows *r) { from_rgb(r, MXU1_RGB565, 0); }
+void mxu1_rgb888_to_i420_c(const mxu1_yuv_rows *r) { from_rgb(r, MXU1_RGB888, 0); }
+void mxu1_argb_to_i420_c(const mxu1_yuv_rows *r)   { from_rgb(r, MXU1_ARGB8888, 0); }
+void mxu1_rgb565_to_nv12_c(const mxu1_yuv_rows *r) { from_rgb(r, MXU1_RGB565, 1); }
+void mxu1_rgb888_to_nv12_c(const mxu1_yuv_rows *r) { from_rgb(r, MXU1_RGB888, 1); }
+void mxu1_argb_to_nv12_c(const mxu1_yuv_rows *r)   { from_rgb(r, MXU1_ARGB8888, 1); }
@@ -181,6 +181,111 @@
 .endm
 
 
+################################################################################
+#  Profiling: define MXU1_PROFILE as non-zero before including this header,
+# as
+#      .equiv MXU1_PROFILE, 1
+#      .include "mxu1_as_macros.s.h"
+# or with -Wa,--defsym,MXU1_PROFILE=1 (=0, like leaving it undefined, turns
+# profiling off), and mark regions of straight-line code
+# (a loop body, an unrolled kernel) with
+#      mxu_prof_begin  sad16_row, $t0
+#      ...
+#      mxu_prof_end    sad16_row
+#  Each opcode macro between the two then also adds one to the region's count
+# of its class, and at run time mxu_prof_begin adds one to the region's count
+# of entries, with lw/addiu/sw through GPR 'tmp' and $at (so not in a delay
+# slot; in -KPIC code through the GOT, so $gp must be set up). mxu_prof_end
+# puts the region's record in section mxu1_prof: entries, name, and the ten
+# class counts, MXU_PROF_CLASSES words. kernels/prof/mxu1_prof.c finds the
+# records and writes them as JSON at exit. The operations executed in a class
+# are entries * count, exactly so when every entry runs through to the end of
+# the region; several threads in one region may lose entries. Regions do not
+# nest, and a name is used once per source file.
+#
+# Classes, in record order:
+#   mul      d16mul[f,e], q8mul[su], s32mul[u]
+#   mac      d16mac[f,e], d16madl, s16mad, q8mac[su], q8madl, s32madd/msub[u]
+#   add      adds, accumulates, sums, averages, differences, q8sad, [sd]*cps
+#   cmp      compares, min/max, conditional moves, q16scop
+#   shift    shifts, s32extr[v], d32sarw
+#   shuffle  s32sfl, s32aln[i], s32lui, q16sat
+#   logic    s32and, s32or, s32xor, s32nor
+#   xfer     s32i2m, s32m2i
+#   load     s32ld*, s8ld*, s16ld*, lx*
+#   store    s32st*, s32sd*, s8st*, s8sd*, s16st*, s16sd*
+#
+#  Without MXU1_PROFILE, or with it 0, the region macros expand to nothing,
+# and each opcode macro to its single .word.
+################################################################################
+
+.equiv MXU_PROF_CLASSES, 10
+
+.set MXU_PROF_ON, 0
+.ifdef MXU1_PROFILE
+  .if MXU1_PROFILE
+    .set MXU_PROF_ON, 1
+  .endif
+.endif
+
+.if MXU_PROF_ON
+
+.set MXU_PROF_OPEN, 0
+
+.macro MXU_PROF_OP class:req
+  .if MXU_PROF_OPEN
+    .set MXU_PROF_N_\class, MXU_PROF_N_\class + 1
+  .endif
+.endm
+
+.macro mxu_prof_begin name:req, tmp:req
+  .if MXU_PROF_OPEN
+    .error "mxu_prof_begin \name: MXU profiling regions do not nest"
+  .endif
+  .set MXU_PROF_OPEN, 1
+  .irp c, mul,mac,add,cmp,shift,shuffle,logic,xfer,load,store
+    .set MXU_PROF_N_\c, 0
+  .endr
+  .set push
+  .set at
+  lw      \tmp, .Lmxu_prof_\name
+  addiu   \tmp, \tmp, 1
+  sw      \tmp, .Lmxu_prof_\name
+  .set pop
+.endm
+
+.macro mxu_prof_end name:req
+  .if !MXU_PROF_OPEN
+    .error "mxu_prof_end \name: no MXU profiling region is open"
+  .endif
+  .set MXU_PROF_OPEN, 0
+  .pushsection mxu1_prof, "aw"
+  .balign 4
+.Lmxu_prof_\name:
+  .word 0
+  .word .Lmxu_prof_name_\name
+  .irp c, mul,mac,add,cmp,shift,shuffle,logic,xfer,load,store
+    .word MXU_PROF_N_\c
+  .endr
+  .popsection
+  .pushsection .rodata
+.Lmxu_prof_name_\name:
+  .asciz "\name"
+  .popsection
+.endm
+
+.else
+
+.macro MXU_PROF_OP class:req
+.endm
+.macro mxu_prof_begin name:req, tmp:req
+.endm
+.macro mxu_prof_end name:req
+.endm
+
+.endif # MXU_PROF_ON
+
+
 # XXX: The Ingenic MXU PDF dated June 2, 2017 containing MXU encodings table
 #  shows the wrong encoding for d16mule, and their binutils patch fails to
 #  parse or assemble it right. The opcode as encoded here has been tested to
@@ -188,240 +293,311 @@
 #  'X1000_M200_XBurst_ISA_MXU_PM.pdf' is the name of the errant PDF doc.
 #
 .macro d16mul      xra:req, xrb:req, xrc:req, xrd:req, optn2:req
+  MXU_PROF_OP mul
   .word 0x70000008 | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16mulf     xra:req, xrb:req, xrc:req, optn2:req
+  MXU_PROF_OP mul
   .word 0x70000009 | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16mule     xra:req, xrb:req, xrc:req, xrd:req, optn2:req
+  MXU_PROF_OP mul
   .word 0x71000009 | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16mac      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req, optn2:req
+  MXU_PROF_OP mac
   .word 0x7000000a | (MXU_APTN2_\aptn2 << 24) | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16macf     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req, optn2:req
+  MXU_PROF_OP mac
   .word 0x7000000b | (MXU_APTN2_\aptn2 << 24) | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16madl     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req, optn2:req
+  MXU_PROF_OP mac
   .word 0x7000000c | (MXU_APTN2_\aptn2 << 24) | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s16mad      xra:req, xrb:req, xrc:req, xrd:req, aptn1:req, mptn2:req
+  MXU_PROF_OP mac
   .word 0x7000000d | (MXU_APTN1_\aptn1 << 24) | (MXU_MPTN2_\mptn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q16add      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req, optn2:req
+  MXU_PROF_OP add
   .word 0x7000000e | (MXU_APTN2_\aptn2 << 24) | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16mace     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req, optn2:req
+  MXU_PROF_OP mac
   .word 0x7000000f | (MXU_APTN2_\aptn2 << 24) | (MXU_OPTN2_\optn2 << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro q8mul       xra:req, xrb:req, xrc:req, xrd:req
+  MXU_PROF_OP mul
   .word 0x70000038 | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8mulsu     xra:req, xrb:req, xrc:req, xrd:req
+  MXU_PROF_OP mul
   .word 0x70800038 | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8mac       xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP mac
   .word 0x7000003a | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8macsu     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP mac
   .word 0x7080003a | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8madl      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP mac
   .word 0x7000003c | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro q8movz      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000039 | (0 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8movn      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000039 | (1 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16movz     xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000039 | (2 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16movn     xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000039 | (3 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32movz     xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000039 | (4 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32movn     xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000039 | (5 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro q16scop     xra:req, xrb:req, xrc:req, xrd:req
+  MXU_PROF_OP cmp
   .word 0x7000003b | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32sfl      xra:req, xrb:req, xrc:req, xrd:req, ptn:req
   MXU_CHECK_PATTERN \ptn, 0, 3
+  MXU_PROF_OP shuffle
   .word 0x7000003d | (MXU_PTN_\ptn << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8sad       xra:req, xrb:req, xrc:req, xrd:req
+  MXU_PROF_OP add
   .word 0x7000003e | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro d32add      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x70000018 | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d32addc     xra:req, xrb:req, xrc:req, xrd:req
+  MXU_PROF_OP add
   .word 0x70400018 | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d32acc      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x70000019 | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d32accm     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x70400019 | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d32asum     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x70800019 | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q16acc      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x7000001b | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q16accm     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x7040001b | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16asum     xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x7080001b | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8adde      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x7000001c | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d8sum       xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x7040001c | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d8sumc      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x7080001c | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8acce      xra:req, xrb:req, xrc:req, xrd:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x7000001d | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro s32cps      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x70000007 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16cps      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x70080007 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8abd       xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x70100007 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q16sat      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP shuffle
   .word 0x70180007 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32slt      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000006 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16slt      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70040006 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16avg      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x70080006 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16avgr     xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x700c0006 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8avg       xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x70100006 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8avgr      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP add
   .word 0x70140006 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8add       xra:req, xrb:req, xrc:req, aptn2:req
+  MXU_PROF_OP add
   .word 0x701c0006 | (MXU_APTN2_\aptn2 << 24) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32max      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70000003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32min      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70040003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16max      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70080003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d16min      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x700c0003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8max       xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70100003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8min       xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70140003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8slt       xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x70180003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q8sltu      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP cmp
   .word 0x701c0003 | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro d32sll      xra:req, xrb:req, xrc:req, xrd:req, sft4:req
   MXU_CHECK_BOUNDS \sft4, 0, 15
+  MXU_PROF_OP shift
   .word 0x70000030 | ((\sft4) << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d32slr      xra:req, xrb:req, xrc:req, xrd:req, sft4:req
   MXU_CHECK_BOUNDS \sft4, 0, 15
+  MXU_PROF_OP shift
   .word 0x70000031 | ((\sft4) << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d32sarl     xra:req, xrb:req, xrc:req, sft4:req
   MXU_CHECK_BOUNDS \sft4, 0, 15
+  MXU_PROF_OP shift
   .word 0x70000032 | ((\sft4) << 22) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro d32sar      xra:req, xrb:req, xrc:req, xrd:req, sft4:req
   MXU_CHECK_BOUNDS \sft4, 0, 15
+  MXU_PROF_OP shift
   .word 0x70000033 | ((\sft4) << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q16sll      xra:req, xrb:req, xrc:req, xrd:req, sft4:req
   MXU_CHECK_BOUNDS \sft4, 0, 15
+  MXU_PROF_OP shift
   .word 0x70000034 | ((\sft4) << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q16slr      xra:req, xrb:req, xrc:req, xrd:req, sft4:req
   MXU_CHECK_BOUNDS \sft4, 0, 15
+  MXU_PROF_OP shift
   .word 0x70000035 | ((\sft4) << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro q16sar      xra:req, xrb:req, xrc:req, xrd:req, sft4:req
   MXU_CHECK_BOUNDS \sft4, 0, 15
+  MXU_PROF_OP shift
   .word 0x70000037 | ((\sft4) << 22) | (MXU_\xrd << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro d32sllv     xra:req, xrd:req, rs:req
+  MXU_PROF_OP shift
   .word 0x70000036 | (GPR_\rs << 21) | (0 << 18) | (MXU_\xrd << 14) | (MXU_\xra << 10)
 .endm
 .macro d32slrv     xra:req, xrd:req, rs:req
+  MXU_PROF_OP shift
   .word 0x70000036 | (GPR_\rs << 21) | (1 << 18) | (MXU_\xrd << 14) | (MXU_\xra << 10)
 .endm
 .macro d32sarv     xra:req, xrd:req, rs:req
+  MXU_PROF_OP shift
   .word 0x70000036 | (GPR_\rs << 21) | (3 << 18) | (MXU_\xrd << 14) | (MXU_\xra << 10)
 .endm
 .macro q16sllv     xra:req, xrd:req, rs:req
+  MXU_PROF_OP shift
   .word 0x70000036 | (GPR_\rs << 21) | (4 << 18) | (MXU_\xrd << 14) | (MXU_\xra << 10)
 .endm
 .macro q16slrv     xra:req, xrd:req, rs:req
+  MXU_PROF_OP shift
   .word 0x70000036 | (GPR_\rs << 21) | (5 << 18) | (MXU_\xrd << 14) | (MXU_\xra << 10)
 .endm
 .macro q16sarv     xra:req, xrd:req, rs:req
+  MXU_PROF_OP shift
   .word 0x70000036 | (GPR_\rs << 21) | (7 << 18) | (MXU_\xrd << 14) | (MXU_\xra << 10)
 .endm
 
 
 .macro s32madd     xra:req, xrd:req, rs:req, rt:req
+  MXU_PROF_OP mac
   .word 0x70008000 | (GPR_\rs << 21) | (GPR_\rt << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 .macro s32maddu    xra:req, xrd:req, rs:req, rt:req
+  MXU_PROF_OP mac
   .word 0x70008001 | (GPR_\rs << 21) | (GPR_\rt << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 .macro s32msub     xra:req, xrd:req, rs:req, rt:req
+  MXU_PROF_OP mac
   .word 0x70008004 | (GPR_\rs << 21) | (GPR_\rt << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 .macro s32msubu    xra:req, xrd:req, rs:req, rt:req
+  MXU_PROF_OP mac
   .word 0x70008005 | (GPR_\rs << 21) | (GPR_\rt << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 
@@ -429,16 +605,20 @@
 # Note: Ingenic MXU docs fail to mention that, like 's32madd', 's32msub' , etc,
 #  the HI and LO CPU registers are stained by 's32mul' and 's32mulu'.
 .macro s32mul      xra:req, xrd:req, rs:req, rt:req
+  MXU_PROF_OP mul
   .word 0x70000026 | (GPR_\rs << 21) | (GPR_\rt << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 .macro s32mulu     xra:req, xrd:req, rs:req, rt:req
+  MXU_PROF_OP mul
   .word 0x70004026 | (GPR_\rs << 21) | (GPR_\rt << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 .macro s32extr     xra:req, xrd:req, rs:req, bits5:req
   MXU_CHECK_BOUNDS \bits5, 1, 31
+  MXU_PROF_OP shift
   .word 0x70008026 | (GPR_\rs << 21) | ((\bits5) << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 .macro s32extrv    xra:req, xrd:req, rs:req, rt:req
+  MXU_PROF_OP shift
   .word 0x7000c026 | (GPR_\rs << 21) | (GPR_\rt << 16) | (MXU_\xrd << 10) | (MXU_\xra << 6)
 .endm
 
@@ -450,13 +630,16 @@
 #  'X1000_M200_XBurst_ISA_MXU_PM.pdf' is the name of the errant PDF doc.
 #
 .macro d32sarw     xra:req, xrb:req, xrc:req, rs:req
+  MXU_PROF_OP shift
   .word 0x70000027 | (GPR_\rs << 21) | (0 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32aln      xra:req, xrb:req, xrc:req, rs:req
+  MXU_PROF_OP shuffle
   .word 0x70000027 | (GPR_\rs << 21) | (1 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32alni     xra:req, xrb:req, xrc:req, ptn:req
   MXU_CHECK_PATTERN \ptn, 0, 4
+  MXU_PROF_OP shuffle
   .word 0x70000027 | (MXU_PTN_\ptn << 23) | (2 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32lui      xra:req, imm8:req, ptn:req
@@ -466,94 +649,117 @@
   .else
     MXU_CHECK_BOUNDS \imm8, 0, 255
   .endif
+  MXU_PROF_OP shuffle
   .word 0x70000027 | (MXU_PTN_\ptn << 23) | (3 << 18) | (((\imm8) & 0xff) << 10) | (MXU_\xra << 6)
 .endm
 .macro s32nor      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP logic
   .word 0x70000027 | (4 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32and      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP logic
   .word 0x70000027 | (5 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32or       xra:req, xrb:req, xrc:req
+  MXU_PROF_OP logic
   .word 0x70000027 | (6 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 .macro s32xor      xra:req, xrb:req, xrc:req
+  MXU_PROF_OP logic
   .word 0x70000027 | (7 << 18) | (MXU_\xrc << 14) | (MXU_\xrb << 10) | (MXU_\xra << 6)
 .endm
 
 
 .macro s32m2i      xra:req, rt:req
+  MXU_PROF_OP xfer
   .word 0x7000002e | (GPR_\rt << 16) | (MXU_I2M_M2I_\xra << 6)
 .endm
 .macro s32i2m      xra:req, rt:req
+  MXU_PROF_OP xfer
   .word 0x7000002f | (GPR_\rt << 16) | (MXU_I2M_M2I_\xra << 6)
 .endm
 
 
 .macro s32lddv     xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000012 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 .macro s32lddvr    xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000412 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 .macro s32stdv     xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP store
   .word 0x70000013 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 .macro s32stdvr    xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP store
   .word 0x70000413 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 .macro s32ldiv     xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000016 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 .macro s32ldivr    xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000416 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 .macro s32sdiv     xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP store
   .word 0x70000017 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 .macro s32sdivr    xra:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP store
   .word 0x70000417 | (GPR_\rs << 21) | (GPR_\rt << 16) | ((\strd2) << 14) | (MXU_\xra << 6)
 .endm
 
 
 .macro s32ldd      xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP load
   .word 0x70000010 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 .macro s32lddr     xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP load
   .word 0x70100010 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 .macro s32std      xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP store
   .word 0x70000011 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 .macro s32stdr     xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP store
   .word 0x70100011 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 .macro s32ldi      xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP load
   .word 0x70000014 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 .macro s32ldir     xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP load
   .word 0x70100014 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 .macro s32sdi      xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP store
   .word 0x70000015 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 .macro s32sdir     xra:req, rs:req, imm12:req
   MXU_CHECK_OFFSET \imm12, 4, -2048, 2047
+  MXU_PROF_OP store
   .word 0x70100015 | (GPR_\rs << 21) | (((\imm12) & 0xffc) << 8) | (MXU_\xra << 6)
 .endm
 
@@ -565,66 +771,129 @@
 .macro s8ldd       xra:req, rs:req, imm8:req, ptn:req
   MXU_CHECK_OFFSET  \imm8, 1, -128, 127
   MXU_CHECK_PATTERN \ptn, 0, 7
+  MXU_PROF_OP load
   .word 0x70000022 | (GPR_\rs << 21) | (MXU_PTN_\ptn << 18) | (((\imm8) & 0xff) << 10) | (MXU_\xra << 6)
 .endm
 .macro s8std       xra:req, rs:req, imm8:req, ptn:req
   MXU_CHECK_OFFSET  \imm8, 1, -128, 127
   MXU_CHECK_PATTERN \ptn, 0, 3
+  MXU_PROF_OP store
   .word 0x70000023 | (GPR_\rs << 21) | (MXU_PTN_\ptn << 18) | (((\imm8) & 0xff) << 10) | (MXU_\xra << 6)
 .endm
 .macro s8ldi       xra:req, rs:req, imm8:req, ptn:req
   MXU_CHECK_OFFSET  \imm8, 1, -128, 127
   MXU_CHECK_PATTERN \ptn, 0, 7
+  MXU_PROF_OP load
   .word 0x70000024 | (GPR_\rs << 21) | (MXU_PTN_\ptn << 18) | (((\imm8) & 0xff) << 10) | (MXU_\xra << 6)
 .endm
 .macro s8sdi       xra:req, rs:req, imm8:req, ptn:req
   MXU_CHECK_OFFSET  \imm8, 1, -128, 127
   MXU_CHECK_PATTERN \ptn, 0, 3
+  MXU_PROF_OP store
   .word 0x70000025 | (GPR_\rs << 21) | (MXU_PTN_\ptn << 18) | (((\imm8) & 0xff) << 10) | (MXU_\xra << 6)
 .endm
 .macro s16ldd      xra:req, rs:req, imm10:req, ptn:req
   MXU_CHECK_OFFSET  \imm10, 2, -512, 511
   MXU_CHECK_PATTERN \ptn, 0, 3
+  MXU_PROF_OP load
   .word 0x7000002a | (GPR_\rs << 21) | (MXU_PTN_\ptn << 19) | (((\imm10) & 0x3fe) << 9) | (MXU_\xra << 6)
 .endm
 .macro s16std      xra:req, rs:req, imm10:req, ptn:req
   MXU_CHECK_OFFSET  \imm10, 2, -512, 511
   MXU_CHECK_PATTERN \ptn, 0, 1
+  MXU_PROF_OP store
   .word 0x7000002b | (GPR_\rs << 21) | (MXU_PTN_\ptn << 19) | (((\imm10) & 0x3fe) << 9) | (MXU_\xra << 6)
 .endm
 .macro s16ldi      xra:req, rs:req, imm10:req, ptn:req
   MXU_CHECK_OFFSET  \imm10, 2, -512, 511
   MXU_CHECK_PATTERN \ptn, 0, 3
+  MXU_PROF_OP load
   .word 0x7000002c | (GPR_\rs << 21) | (MXU_PTN_\ptn << 19) | (((\imm10) & 0x3fe) << 9) | (MXU_\xra << 6)
 .endm
 .macro s16sdi      xra:req, rs:req, imm10:req, ptn:req
   MXU_CHECK_OFFSET \imm10, 2, -512, 511
   MXU_CHECK_PATTERN \ptn, 0, 1
+  MXU_PROF_OP store
   .word 0x7000002d | (GPR_\rs << 21) | (MXU_PTN_\ptn << 19) | (((\imm10) & 0x3fe) << 9) | (MXU_\xra << 6)
 .endm
 
 
 .macro lxw         rd:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000028 | (GPR_\rs << 21) | (GPR_\rt << 16) | (GPR_\rd << 11) | ((\strd2) << 9) | (3 << 6)
 .endm
 .macro lxh         rd:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000028 | (GPR_\rs << 21) | (GPR_\rt << 16) | (GPR_\rd << 11) | ((\strd2) << 9) | (1 << 6)
 .endm
 .macro lxhu        rd:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000028 | (GPR_\rs << 21) | (GPR_\rt << 16) | (GPR_\rd << 11) | ((\strd2) << 9) | (5 << 6)
 .endm
 .macro lxb         rd:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000028 | (GPR_\rs << 21) | (GPR_\rt << 16) | (GPR_\rd << 11) | ((\strd2) << 9) | (0 << 6)
 .endm
 .macro lxbu        rd:req, rs:req, rt:req, strd2:req
   MXU_CHECK_BOUNDS \strd2, 0, 2
+  MXU_PROF_OP load
   .word 0x70000028 | (GPR_\rs << 21) | (GPR_\rt << 16) | (GPR_\rd << 11) | ((\strd2) << 9) | (4 << 6)
 .endm
 
+################################################################################
+#  Saving and restoring the MXU registers, for code that switches between
+# tasks on one thread (coroutines, cooperative schedulers) or must hand the
+# xr registers back as it found them. The context is MXU_CONTEXT_SIZE bytes at
+# the word aligned address in GPR 'base', word i holding xri (word 0 is not
+# written: xr0 always reads zero). xr16, MXU_CR, goes through GPR 'tmp'.
+#
+#     mxu_save_context     $a0, $t0             # xr1..xr16 to 0($a0)..64($a0)
+#     mxu_restore_context  $a0, $t0
+#
+#  The _lazy forms move only the registers in 'mask', bit i for xri and bit 16
+# for MXU_CR, so a routine that touches only xr1..xr4 keeps them with
+#     mxu_save_context_lazy     $sp, $t0, 0x1e
+#     mxu_restore_context_lazy  $sp, $t0, 0x1e
+# The restores write MXU_CR last, so the loads run while the MXU is still
+# enabled even when the context being restored has it disabled.
+################################################################################
+
+.equiv MXU_CONTEXT_SIZE, 68
+.equiv MXU_CONTEXT_ALL,  0x1fffe
+
+.macro mxu_save_context_lazy     base:req, tmp:req, mask:req
+  .if (\mask) & (1 << 16)
+    s32m2i  xr16, \tmp
+    sw      \tmp, 64(\base)
+  .endif
+  .irp i, 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15
+    .if (\mask) & (1 << \i)
+      s32std  xr\i, \base, 4 * \i
+    .endif
+  .endr
+.endm
+.macro mxu_restore_context_lazy  base:req, tmp:req, mask:req
+  .irp i, 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15
+    .if (\mask) & (1 << \i)
+      s32ldd  xr\i, \base, 4 * \i
+    .endif
+  .endr
+  .if (\mask) & (1 << 16)
+    lw      \tmp, 64(\base)
+    s32i2m  xr16, \tmp
+  .endif
+.endm
+.macro mxu_save_context          base:req, tmp:req
+  mxu_save_context_lazy     \base, \tmp, MXU_CONTEXT_ALL
+.endm
+.macro mxu_restore_context       base:req, tmp:req
+  mxu_restore_context_lazy  \base, \tmp, MXU_CONTEXT_ALL
+.endm
+
 
 .endif # MXU1_AS_MACROS_S_H
 
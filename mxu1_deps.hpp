@@ -0,0 +1,234 @@
+// mxu1_deps.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 register def/use information
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  What each MXU opcode reads and writes, for dependency analysis. This
+// mirrors the semantics in mxu1_emu.hpp; keep the two in step.
+//
+// Register sets are bitmasks: bit N of xr_* is xrN (bit 16 is MXU_CR), bit N of
+// gpr_* is $N. xr0 and $zero never appear, since writes to them are discarded
+// and reads of them carry no dependency.
+//
+// Note that, as the GAS header points out, s32mul/s32mulu write HI/LO just
+// like s32madd and friends do.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_DEPS_HPP
+#define MXU1_DEPS_HPP
+
+#include "mxu1_isa.hpp"
+
+#include <cstdint>
+
+namespace mxu1 {
+
+// Coarse functional grouping, used for latency defaults and reporting
+enum class OpClass : uint8_t {
+  alu,     // Lane add/sub/avg/min/max/compare/logic/shuffle/shift
+  mul,     // Lane multiply or multiply-accumulate
+  hilo,    // GPR x GPR multiply through HI/LO (s32madd etc.)
+  xfer,    // s32i2m / s32m2i
+  load,
+  store,
+};
+
+struct Deps {
+  uint32_t xr_use  = 0, xr_def  = 0;
+  uint32_t gpr_use = 0, gpr_def = 0;
+  uint32_t gpr_inc = 0;   // Subset of gpr_def that is a base-address update
+  bool     hilo_use = false, hilo_def = false;
+  bool     load = false, store = false;
+};
+
+constexpr uint32_t kCrBit = 1u << 16;
+
+inline OpClass op_class(Op op)
+{
+  switch (op) {
+    case Op::d16mul:   case Op::d16mulf:  case Op::d16mule:  case Op::d16mac:
+    case Op::d16macf:  case Op::d16madl:  case Op::s16mad:   case Op::d16mace:
+    case Op::q8mul:    case Op::q8mulsu:  case Op::q8mac:    case Op::q8macsu:
+    case Op::q8madl:
+      return OpClass::mul;
+    case Op::s32madd:  case Op::s32maddu: case Op::s32msub:  case Op::s32msubu:
+    case Op::s32mul:   case Op::s32mulu:
+      return OpClass::hilo;
+    case Op::s32m2i:   case Op::s32i2m:
+      return OpClass::xfer;
+    case Op::s32lddv:  case Op::s32lddvr: case Op::s32ldiv:  case Op::s32ldivr:
+    case Op::s32ldd:   case Op::s32lddr:  case Op::s32ldi:   case Op::s32ldir:
+    case Op::s8ldd:    case Op::s8ldi:    case Op::s16ldd:   case Op::s16ldi:
+    case Op::lxw:      case Op::lxh:      case Op::lxhu:     case Op::lxb:
+    case Op::lxbu:
+      return OpClass::load;
+    case Op::s32stdv:  case Op::s32stdvr: case Op::s32sdiv:  case Op::s32sdivr:
+    case Op::s32std:   case Op::s32stdr:  case Op::s32sdi:   case Op::s32sdir:
+    case Op::s8std:    case Op::s8sdi:    case Op::s16std:   case Op::s16sdi:
+      return OpClass::store;
+    default:
+      return OpClass::alu;
+  }
+}
+
+inline Deps deps(const Insn& in)
+{
+  Deps d;
+  const uint32_t A = 1u << in.xra, B = 1u << in.xrb, C = 1u << in.xrc, D = 1u << in.xrd;
+  const uint32_t RS = 1u << in.rs, RT = 1u << in.rt, RD = 1u << in.rd;
+
+  switch (in.op) {
+    // XRa,XRd <- f(XRb, XRc)
+    case Op::d16mul:   case Op::q16add:   case Op::q8mul:    case Op::q8mulsu:
+    case Op::q16scop:  case Op::s32sfl:   case Op::d32sll:   case Op::d32slr:
+    case Op::d32sar:   case Op::q16sll:   case Op::q16slr:   case Op::q16sar:
+    case Op::q8adde:
+      d.xr_use = B | C;  d.xr_def = A | D;
+      break;
+    case Op::d16mule:
+      d.xr_use = B | C | kCrBit;  d.xr_def = A | D;
+      break;
+    case Op::d32add:
+      // Only the carry bits of MXU_CR are written, so the old CR is an input
+      d.xr_use = B | C | kCrBit;  d.xr_def = A | D | kCrBit;
+      break;
+    case Op::d32addc:
+      d.xr_use = B | C | kCrBit;  d.xr_def = A | D;
+      break;
+    // XRa,XRd <- f(XRa, XRb, XRc, XRd)
+    case Op::d16mac:   case Op::q8mac:    case Op::q8macsu:  case Op::d32acc:
+    case Op::d32accm:  case Op::d32asum:  case Op::q16acc:   case Op::q16accm:
+    case Op::d16asum:  case Op::q8acce:
+      d.xr_use = A | B | C | D;  d.xr_def = A | D;
+      break;
+    case Op::d16mace:
+      d.xr_use = A | B | C | D | kCrBit;  d.xr_def = A | D;
+      break;
+    case Op::q8sad:
+      d.xr_use = B | C | D;  d.xr_def = A | D;
+      break;
+    case Op::d16macf:
+      d.xr_use = A | B | C | D | kCrBit;  d.xr_def = A;
+      break;
+    case Op::d16mulf:
+      d.xr_use = B | C | kCrBit;  d.xr_def = A;
+      break;
+    // XRd <- f(XRa, XRb, XRc)
+    case Op::d16madl:  case Op::s16mad:   case Op::q8madl:
+      d.xr_use = A | B | C;  d.xr_def = D;
+      break;
+    // Conditional moves keep the old XRa on a false condition
+    case Op::q8movz:   case Op::q8movn:   case Op::d16movz:  case Op::d16movn:
+    case Op::s32movz:  case Op::s32movn:
+      d.xr_use = A | B | C;  d.xr_def = A;
+      break;
+
+    case Op::d32sllv:  case Op::d32slrv:  case Op::d32sarv:  case Op::q16sllv:
+    case Op::q16slrv:  case Op::q16sarv:
+      d.xr_use = A | D;  d.xr_def = A | D;  d.gpr_use = RS;
+      break;
+    case Op::s32madd:  case Op::s32maddu: case Op::s32msub:  case Op::s32msubu:
+      d.hilo_use = true;
+      // fall through
+    case Op::s32mul:   case Op::s32mulu:
+      d.gpr_use = RS | RT;  d.xr_def = A | D;  d.hilo_def = true;
+      break;
+    case Op::s32extr:
+      d.xr_use = A | D;  d.xr_def = A;  d.gpr_use = RS;
+      break;
+    case Op::s32extrv:
+      d.xr_use = A | D;  d.xr_def = A;  d.gpr_use = RS | RT;
+      break;
+    case Op::d32sarw:  case Op::s32aln:
+      d.xr_use = B | C;  d.xr_def = A;  d.gpr_use = RS;
+      break;
+    case Op::s32lui:
+      d.xr_def = A;
+      break;
+    case Op::s32m2i:
+      d.xr_use = A;  d.gpr_def = RT;
+      break;
+    case Op::s32i2m:
+      d.gpr_use = RT;  d.xr_def = A;
+      break;
+
+    case Op::s32lddv:  case Op::s32lddvr:
+      d.gpr_use = RS | RT;  d.xr_def = A;  d.load = true;
+      break;
+    case Op::s32ldiv:  case Op::s32ldivr:
+      d.gpr_use = RS | RT;  d.xr_def = A;  d.gpr_def = d.gpr_inc = RS;  d.load = true;
+      break;
+    case Op::s32stdv:  case Op::s32stdvr:
+      d.gpr_use = RS | RT;  d.xr_use = A;  d.store = true;
+      break;
+    case Op::s32sdiv:  case Op::s32sdivr:
+      d.gpr_use = RS | RT;  d.xr_use = A;  d.gpr_def = d.gpr_inc = RS;  d.store = true;
+      break;
+    case Op::s32ldd:   case Op::s32lddr:
+      d.gpr_use = RS;  d.xr_def = A;  d.load = true;
+      break;
+    case Op::s32ldi:   case Op::s32ldir:
+      d.gpr_use = RS;  d.xr_def = A;  d.gpr_def = d.gpr_inc = RS;  d.load = true;
+      break;
+    case Op::s32std:   case Op::s32stdr:  case Op::s8std:    case Op::s16std:
+      d.gpr_use = RS;  d.xr_use = A;  d.store = true;
+      break;
+    case Op::s32sdi:   case Op::s32sdir:  case Op::s8sdi:    case Op::s16sdi:
+      d.gpr_use = RS;  d.xr_use = A;  d.gpr_def = d.gpr_inc = RS;  d.store = true;
+      break;
+    case Op::s8ldd:    case Op::s8ldi:
+      // ptn0..3 insert one byte into the old value
+      d.gpr_use = RS;  d.xr_use = in.ptn <= 3 ? A : 0;  d.xr_def = A;  d.load = true;
+      if (in.op == Op::s8ldi)
+        d.gpr_def = d.gpr_inc = RS;
+      break;
+    case Op::s16ldd:   case Op::s16ldi:
+      // ptn0,1 insert one halfword into the old value
+      d.gpr_use = RS;  d.xr_use = in.ptn <= 1 ? A : 0;  d.xr_def = A;  d.load = true;
+      if (in.op == Op::s16ldi)
+        d.gpr_def = d.gpr_inc = RS;
+      break;
+    case Op::lxw:      case Op::lxh:      case Op::lxhu:     case Op::lxb:
+    case Op::lxbu:
+      d.gpr_use = RS | RT;  d.gpr_def = RD;  d.load = true;
+      break;
+
+    case Op::invalid:
+      break;
+    default:
+      // XRa <- f(XRb, XRc): everything left in Fmt::XA_XB_XC/_APTN2/_SFT4/_PTN
+      d.xr_use = B | C;  d.xr_def = A;
+      break;
+  }
+
+  d.xr_use  &= ~1u;  d.xr_def  &= ~1u;
+  d.gpr_use &= ~1u;  d.gpr_def &= ~1u;  d.gpr_inc &= ~1u;
+  return d;
+}
+
+} // namespace mxu1
+
+#endif // MXU1_DEPS_HPP
@@ -0,0 +1,137 @@
+// mxu1_disasm.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 disassembler
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Prints decoded instructions back in the syntax of mxu1_as_macros.s.h, so
+// the text can be fed straight back through the header and must assemble to
+// the same word. Patterns print by name (AS, XW, ptn3...), GPRs as '$a1'.
+//
+// format() writes into a caller buffer and never allocates, for use on large
+// images; to_string() is the convenient form.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_DISASM_HPP
+#define MXU1_DISASM_HPP
+
+#include "mxu1_isa.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace mxu1 {
+
+// Longest possible output, including the terminating NUL
+constexpr std::size_t kDisasmMax = 64;
+
+// Write "mnemonic\toperands" for 'in' into 'buf'. Returns the length written.
+inline int format(const Insn& in, char* buf, std::size_t len = kDisasmMax)
+{
+  const char* n = name(in.op);
+  const unsigned a = in.xra, b = in.xrb, c = in.xrc, d = in.xrd;
+  const char* rs = kGprName[in.rs];
+  const char* rt = kGprName[in.rt];
+
+  switch (info(in.op).fmt) {
+    case Fmt::XA_XB_XC_XD_OPTN2:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, xr%u, %s", n, a, b, c, d, kOptn2Name[in.optn]);
+    case Fmt::XA_XB_XC_OPTN2:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, %s", n, a, b, c, kOptn2Name[in.optn]);
+    case Fmt::XA_XB_XC_XD_APTN2_OPTN2:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, xr%u, %s, %s", n, a, b, c, d,
+                           kAptn2Name[in.aptn], kOptn2Name[in.optn]);
+    case Fmt::XA_XB_XC_XD_APTN1_MPTN2:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, xr%u, %s, %s", n, a, b, c, d,
+                           kAptn1Name[in.aptn & 1], kMptn2Name[in.optn]);
+    case Fmt::XA_XB_XC_XD:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, xr%u", n, a, b, c, d);
+    case Fmt::XA_XB_XC_XD_APTN2:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, xr%u, %s", n, a, b, c, d, kAptn2Name[in.aptn]);
+    case Fmt::XA_XB_XC:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u", n, a, b, c);
+    case Fmt::XA_XB_XC_XD_PTN:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, xr%u, ptn%u", n, a, b, c, d, in.ptn);
+    case Fmt::XA_XB_XC_APTN2:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, %s", n, a, b, c, kAptn2Name[in.aptn]);
+    case Fmt::XA_XB_XC_XD_SFT4:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, xr%u, %d", n, a, b, c, d, in.imm);
+    case Fmt::XA_XB_XC_SFT4:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, %d", n, a, b, c, in.imm);
+    case Fmt::XA_XD_RS:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, %s", n, a, d, rs);
+    case Fmt::XA_XD_RS_RT:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, %s, %s", n, a, d, rs, rt);
+    case Fmt::XA_XD_RS_BITS5:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, %s, %d", n, a, d, rs, in.imm);
+    case Fmt::XA_XB_XC_RS:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, %s", n, a, b, c, rs);
+    case Fmt::XA_XB_XC_PTN:
+      return std::snprintf(buf, len, "%s\txr%u, xr%u, xr%u, ptn%u", n, a, b, c, in.ptn);
+    case Fmt::XA_IMM8_PTN:
+      return std::snprintf(buf, len, "%s\txr%u, %d, ptn%u", n, a, in.imm, in.ptn);
+    case Fmt::XA16_RT:
+      return std::snprintf(buf, len, "%s\txr%u, %s", n, a, rt);
+    case Fmt::XA_RS_RT_STRD2:
+      return std::snprintf(buf, len, "%s\txr%u, %s, %s, %d", n, a, rs, rt, in.imm);
+    case Fmt::XA_RS_S12:
+      return std::snprintf(buf, len, "%s\txr%u, %s, %d", n, a, rs, in.imm);
+    case Fmt::XA_RS_S8_PTN:
+    case Fmt::XA_RS_S10_PTN:
+      return std::snprintf(buf, len, "%s\txr%u, %s, %d, ptn%u", n, a, rs, in.imm, in.ptn);
+    case Fmt::RD_RS_RT_STRD2:
+      return std::snprintf(buf, len, "%s\t%s, %s, %s, %d", n, kGprName[in.rd], rs, rt, in.imm);
+  }
+  return 0;
+}
+
+// Disassemble one word. Non-MXU words print as '.word 0x...'.
+inline int format(uint32_t word, char* buf, std::size_t len = kDisasmMax)
+{
+  const Insn in = decode(word);
+  if (in.op == Op::invalid)
+    return std::snprintf(buf, len, ".word\t0x%08x", word);
+  return format(in, buf, len);
+}
+
+inline std::string to_string(const Insn& in)
+{
+  char buf[kDisasmMax];
+  const int n = format(in, buf, sizeof(buf));
+  return std::string(buf, n > 0 ? static_cast<std::size_t>(n) : 0);
+}
+
+inline std::string to_string(uint32_t word)
+{
+  char buf[kDisasmMax];
+  const int n = format(word, buf, sizeof(buf));
+  return std::string(buf, n > 0 ? static_cast<std::size_t>(n) : 0);
+}
+
+} // namespace mxu1
+
+#endif // MXU1_DISASM_HPP
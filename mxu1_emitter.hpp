@@ -0,0 +1,157 @@
+// mxu1_emitter.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 runtime code emitter (JIT) for POSIX hosts
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  mxu1::Emitter collects instruction words built with mxu1_encode.hpp, so
+// kernels can be specialized at runtime for values the assembler never sees
+// (filter length, stride, image width) and fully unrolled. finalize() copies
+// them into a fresh mapping, flushes the icache over it and makes it
+// read+execute only. For instance, a SAD over 'rows' rows of 'stride' bytes:
+//
+//     using namespace mxu1;
+//     Emitter e;
+//     e(s32i2m(xr4, gpr::zero));
+//     for (int y = 0; y < rows; ++y) {
+//       e(s32ldi(xr1, gpr::a0, y ? stride : 0));
+//       e(s32ldi(xr2, gpr::a1, y ? stride : 0));
+//       e(q8sad(xr3, xr1, xr2, xr4));
+//     }
+//     e(s32m2i(xr4, gpr::v0));
+//     e.ret();
+//     Code code = e.finalize();
+//     auto sad = code.entry<uint32_t (*)(const uint8_t*, const uint8_t*)>();
+//
+// On a non-MIPS host, finalize() still works but the result is not runnable;
+// hand words() to mxu1::State (mxu1_emu.hpp) instead.
+//
+// Offsets in stride-specialized code must still fit the opcode's immediate
+// field; the mxu1_encode.hpp checks throw if they do not.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_EMITTER_HPP
+#define MXU1_EMITTER_HPP
+
+#include "mxu1_encode.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace mxu1 {
+
+// Owner of one finalized, executable mapping. Move-only.
+class Code {
+ public:
+  Code() = default;
+  Code(const Code&) = delete;
+  Code& operator=(const Code&) = delete;
+  Code(Code&& o) noexcept : mem_(o.mem_), size_(o.size_) { o.mem_ = nullptr;  o.size_ = 0; }
+  Code& operator=(Code&& o) noexcept
+  {
+    std::swap(mem_, o.mem_);
+    std::swap(size_, o.size_);
+    return *this;
+  }
+  ~Code() { if (mem_) munmap(mem_, size_); }
+
+  // Function pointer to the code starting 'word_offset' instructions in
+  template <typename Fn>
+  Fn entry(std::size_t word_offset = 0) const
+  {
+    void* p = static_cast<uint32_t*>(mem_) + word_offset;
+    Fn fn;
+    static_assert(sizeof(fn) == sizeof(p), "Code::entry() needs a plain function pointer type");
+    std::memcpy(&fn, &p, sizeof(fn));
+    return fn;
+  }
+
+  const uint32_t* words() const { return static_cast<const uint32_t*>(mem_); }
+  std::size_t     size() const  { return size_; }
+
+ private:
+  friend class Emitter;
+  Code(void* mem, std::size_t size) : mem_(mem), size_(size) {}
+
+  void*       mem_  = nullptr;
+  std::size_t size_ = 0;
+};
+
+class Emitter {
+ public:
+  Emitter& emit(uint32_t word)       { words_.push_back(word);  return *this; }
+  Emitter& operator()(uint32_t word) { return emit(word); }
+
+  // 'jr $ra' and its delay slot
+  Emitter& ret() { return emit(mips::jr(gpr::ra)).emit(mips::nop()); }
+
+  // Current position in words, for use as a branch target or patch point
+  std::size_t pos() const { return words_.size(); }
+
+  // Branch offset field for a branch emitted at pos() that targets 'target'
+  int branch_to(std::size_t target) const
+  {
+    return static_cast<int>(target) - static_cast<int>(pos() + 1);
+  }
+
+  void patch(std::size_t at, uint32_t word) { words_.at(at) = word; }
+
+  const std::vector<uint32_t>& words() const { return words_; }
+  void clear() { words_.clear(); }
+
+  // Copy the words into executable memory. The Emitter itself is unchanged,
+  //  so it may be reused or finalized again.
+  Code finalize() const
+  {
+    const std::size_t size = words_.size() * sizeof(uint32_t);
+    if (size == 0)
+      throw std::logic_error("mxu1::Emitter::finalize() with no code");
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+      throw std::bad_alloc();
+    std::memcpy(mem, words_.data(), size);
+    char* begin = static_cast<char*>(mem);
+    __builtin___clear_cache(begin, begin + size);
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+      munmap(mem, size);
+      throw std::runtime_error("mxu1::Emitter::finalize(): mprotect failed");
+    }
+    return Code(mem, size);
+  }
+
+ private:
+  std::vector<uint32_t> words_;
+};
+
+} // namespace mxu1
+
+#endif // MXU1_EMITTER_HPP
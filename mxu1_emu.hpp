@@ -0,0 +1,759 @@
+// mxu1_emu.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 host-side reference emulator
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  mxu1::State executes the exact '.word' encodings emitted by
+// mxu1_as_macros.s.h, one at a time, against a model of the MXU register file
+// (xr0..xr15, plus xr16 which is MXU_CR), the 32 MIPS GPRs, HI/LO and a
+// little-endian guest memory. It does not execute ordinary MIPS instructions:
+// host code drives loops and scalar work by setting 'gpr[]' directly, e.g.:
+//
+//     mxu1::State st;
+//     st.mem.map(0x10000000, src_buf, sizeof(src_buf));
+//     st.gpr[5] = 0x10000000;                   // $a1
+//     st.run(kernel_words, kernel_len);         // or st.exec(word)
+//
+// Semantics follow the Ingenic MXU1 programming manual. Where that manual is
+// known to be wrong about encodings (see d16mule, d32sarw group notes in the
+// GAS header) the header is authoritative, since it is what was tested on HW.
+//
+// Things the manual leaves open, and what is modeled here:
+//  - xr0 always reads as zero, writes to it are discarded.
+//  - When MXU_CR.MXU_EN is clear, every opcode but s32i2m/s32m2i is a no-op.
+//  - Fractional ops (d16mulf etc.) round only when MXU_CR.RD_EN is set.
+//    d16mulf/d16macf round half-to-even unless MXU_CR.BIAS is also set.
+//  - d32add leaves its two carry-outs in MXU_CR bits 31 (XRa) and 30 (XRd),
+//    which d32addc then adds in.
+//  - When an opcode writes both XRa and XRd and they are the same register,
+//    the XRa result wins.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_EMU_HPP
+#define MXU1_EMU_HPP
+
+#include "mxu1_isa.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mxu1 {
+
+// MXU_CR (xr16) bits
+constexpr uint32_t CR_MXU_EN  = 1u << 0;
+constexpr uint32_t CR_RD_EN   = 1u << 1;
+constexpr uint32_t CR_BIAS    = 1u << 2;
+constexpr uint32_t CR_CARRY_D = 1u << 30;
+constexpr uint32_t CR_CARRY_A = 1u << 31;
+
+// Raised for unmapped or misaligned guest accesses, and non-MXU words
+class Fault : public std::runtime_error {
+ public:
+  Fault(const char* what, uint32_t value)
+    : std::runtime_error(format(what, value)), value(value) {}
+  uint32_t value;  // Offending address or instruction word
+
+ private:
+  static std::string format(const char* what, uint32_t value)
+  {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "mxu1: %s: 0x%08x", what, value);
+    return buf;
+  }
+};
+
+// Flat 32-bit guest address space built from host buffers
+class Memory {
+ public:
+  void map(uint32_t guest_addr, void* host, uint32_t size)
+  {
+    regions_.push_back(Region{guest_addr, size, static_cast<uint8_t*>(host)});
+  }
+
+  void unmap_all() { regions_.clear();  last_ = 0; }
+
+  // Host pointer for 'size' bytes at 'addr', which must be 'size'-aligned
+  uint8_t* translate(uint32_t addr, uint32_t size)
+  {
+    if (addr & (size - 1))
+      throw Fault("misaligned access", addr);
+    if (last_ < regions_.size() && regions_[last_].holds(addr, size))
+      return regions_[last_].host + (addr - regions_[last_].base);
+    for (std::size_t i = 0; i < regions_.size(); ++i) {
+      if (regions_[i].holds(addr, size)) {
+        last_ = i;
+        return regions_[i].host + (addr - regions_[i].base);
+      }
+    }
+    throw Fault("unmapped access", addr);
+  }
+
+  uint32_t load8(uint32_t a)  { return *translate(a, 1); }
+  uint32_t load16(uint32_t a) { const uint8_t* p = translate(a, 2);  return p[0] | (p[1] << 8); }
+  uint32_t load32(uint32_t a)
+  {
+    const uint8_t* p = translate(a, 4);
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  }
+  void store8(uint32_t a, uint32_t v)  { *translate(a, 1) = static_cast<uint8_t>(v); }
+  void store16(uint32_t a, uint32_t v)
+  {
+    uint8_t* p = translate(a, 2);
+    p[0] = static_cast<uint8_t>(v);  p[1] = static_cast<uint8_t>(v >> 8);
+  }
+  void store32(uint32_t a, uint32_t v)
+  {
+    uint8_t* p = translate(a, 4);
+    p[0] = static_cast<uint8_t>(v);        p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);  p[3] = static_cast<uint8_t>(v >> 24);
+  }
+
+ private:
+  struct Region {
+    uint32_t base, size;
+    uint8_t* host;
+    bool holds(uint32_t addr, uint32_t n) const { return size >= n && addr - base <= size - n; }
+  };
+  std::vector<Region> regions_;
+  std::size_t         last_ = 0;  // Region that satisfied the previous access
+};
+
+namespace detail {
+
+inline int32_t  hi16(uint32_t v)  { return static_cast<int16_t>(v >> 16); }
+inline int32_t  lo16(uint32_t v)  { return static_cast<int16_t>(v); }
+inline uint32_t ub(uint32_t v, int i) { return (v >> (8 * i)) & 0xff; }
+inline int32_t  sb(uint32_t v, int i) { return static_cast<int8_t>(v >> (8 * i)); }
+inline uint32_t pack16(uint32_t h, uint32_t l) { return (h << 16) | (l & 0xffff); }
+inline uint32_t pack8(uint32_t b3, uint32_t b2, uint32_t b1, uint32_t b0)
+{
+  return ((b3 & 0xff) << 24) | ((b2 & 0xff) << 16) | ((b1 & 0xff) << 8) | (b0 & 0xff);
+}
+inline uint32_t addsub(uint32_t a, uint32_t b, bool sub) { return sub ? a - b : a + b; }
+inline uint32_t sat_u8(int32_t v) { return v < 0 ? 0 : v > 255 ? 255 : static_cast<uint32_t>(v); }
+inline uint32_t sign16(int32_t v) { return v < 0 ? 0xffff : v > 0 ? 1 : 0; }
+inline uint32_t bswap32(uint32_t v)
+{
+  return (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+}
+
+// Halves of XRb feeding the H and L lanes for each optn2 pattern WW,LW,HW,XW
+inline void optn2_sel(uint32_t b, unsigned optn2, int32_t& h, int32_t& l)
+{
+  switch (optn2 & 3) {
+    case 0:  h = hi16(b);  l = lo16(b);  break;
+    case 1:  h = lo16(b);  l = lo16(b);  break;
+    case 2:  h = hi16(b);  l = hi16(b);  break;
+    default: h = lo16(b);  l = hi16(b);  break;
+  }
+}
+
+} // namespace detail
+
+class State {
+ public:
+  std::array<uint32_t, 17> xr{};   // xr16 is MXU_CR
+  std::array<uint32_t, 32> gpr{};  // gpr[0] always reads as zero
+  uint32_t hi = 0, lo = 0;
+  Memory   mem;
+
+  // Executed-instruction counts, indexed by Op
+  std::array<uint64_t, kNumOps> counts{};
+
+  State() { xr[16] = CR_MXU_EN; }
+
+  void exec(uint32_t word)
+  {
+    const Insn in = decode(word);
+    if (in.op == Op::invalid)
+      throw Fault("not an MXU1 instruction", word);
+    exec(in);
+  }
+
+  void run(const uint32_t* words, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      exec(words[i]);
+  }
+
+  void exec(const Insn& in);
+
+ private:
+  uint32_t x(unsigned i) const { return i ? xr[i] : 0; }
+  uint32_t rg(unsigned i) const { return i ? gpr[i] : 0; }
+  void     set(unsigned i, uint32_t v) { if (i) xr[i] = v; }
+  void     set_gpr(unsigned i, uint32_t v) { if (i) gpr[i] = v; }
+  uint32_t round_frac(uint32_t v, bool allow_even) const;
+  void     hilo_madd(const Insn& in, bool is_signed, bool sub, bool accumulate);
+};
+
+// Round a Q31 product/sum to Q15 in the upper half, as MXU_CR dictates
+inline uint32_t State::round_frac(uint32_t v, bool allow_even) const
+{
+  if (!(xr[16] & CR_RD_EN))
+    return v;
+  if (allow_even && !(xr[16] & CR_BIAS) && (v & 0x1ffff) == 0x8000)
+    return v;
+  return v + 0x8000;
+}
+
+inline void State::hilo_madd(const Insn& in, bool is_signed, bool sub, bool accumulate)
+{
+  const uint32_t a = rg(in.rs), b = rg(in.rt);
+  const uint64_t prod = is_signed ?
+      static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(a)) * static_cast<int32_t>(b)) :
+      static_cast<uint64_t>(a) * b;
+  uint64_t acc = accumulate ? (static_cast<uint64_t>(hi) << 32) | lo : 0;
+  acc = sub ? acc - prod : acc + prod;
+  hi = static_cast<uint32_t>(acc >> 32);
+  lo = static_cast<uint32_t>(acc);
+  set(in.xrd, lo);
+  set(in.xra, hi);
+}
+
+inline void State::exec(const Insn& in)
+{
+  using namespace detail;
+
+  if (!(xr[16] & CR_MXU_EN) && in.op != Op::s32i2m && in.op != Op::s32m2i)
+    return;
+  ++counts[static_cast<std::size_t>(in.op)];
+
+  const uint32_t a = x(in.xra), b = x(in.xrb), c = x(in.xrc), d = x(in.xrd);
+  const bool sub_a = in.aptn & 2, sub_d = in.aptn & 1;
+  int32_t bh, bl;
+  optn2_sel(b, in.optn, bh, bl);
+  const uint32_t lop = static_cast<uint32_t>(bh * hi16(c));
+  const uint32_t rop = static_cast<uint32_t>(bl * lo16(c));
+
+  switch (in.op) {
+    case Op::d16mul:
+      set(in.xrd, rop);
+      set(in.xra, lop);
+      break;
+    case Op::d16mulf:
+      set(in.xra, pack16(round_frac(lop << 1, true) >> 16, round_frac(rop << 1, true) >> 16));
+      break;
+    case Op::d16mule:
+      set(in.xrd, round_frac(rop << 1, false));
+      set(in.xra, round_frac(lop << 1, false));
+      break;
+    case Op::d16mac:
+      set(in.xrd, addsub(d, rop, sub_d));
+      set(in.xra, addsub(a, lop, sub_a));
+      break;
+    case Op::d16macf:
+      set(in.xra, pack16(round_frac(addsub(a, lop << 1, sub_a), true) >> 16,
+                         round_frac(addsub(d, rop << 1, sub_d), true) >> 16));
+      break;
+    case Op::d16mace:
+      set(in.xrd, round_frac(addsub(d, rop << 1, sub_d), false));
+      set(in.xra, round_frac(addsub(a, lop << 1, sub_a), false));
+      break;
+    case Op::d16madl:
+      set(in.xrd, pack16(addsub(a >> 16, lop, sub_a), addsub(a, rop, sub_d)));
+      break;
+    case Op::s16mad: {
+      const int32_t p = in.optn == 0 ? hi16(b) * hi16(c) :
+                        in.optn == 1 ? lo16(b) * lo16(c) :
+                        in.optn == 2 ? hi16(b) * lo16(c) : lo16(b) * hi16(c);
+      set(in.xrd, addsub(a, static_cast<uint32_t>(p), in.aptn & 1));
+      break;
+    }
+    case Op::q16add: {
+      const uint32_t h = static_cast<uint32_t>(bh), l = static_cast<uint32_t>(bl);
+      const uint32_t ch = static_cast<uint32_t>(hi16(c)), cl = static_cast<uint32_t>(lo16(c));
+      set(in.xrd, pack16(addsub(h, ch, sub_d), addsub(l, cl, sub_d)));
+      set(in.xra, pack16(addsub(h, ch, sub_a), addsub(l, cl, sub_a)));
+      break;
+    }
+
+    case Op::q8mul:
+    case Op::q8mulsu: {
+      const bool su = in.op == Op::q8mulsu;
+      uint32_t p[4];
+      for (int i = 0; i < 4; ++i)
+        p[i] = static_cast<uint32_t>((su ? sb(b, i) : static_cast<int32_t>(ub(b, i))) *
+                                     static_cast<int32_t>(ub(c, i)));
+      set(in.xrd, pack16(p[1], p[0]));
+      set(in.xra, pack16(p[3], p[2]));
+      break;
+    }
+    case Op::q8mac:
+    case Op::q8macsu: {
+      const bool su = in.op == Op::q8macsu;
+      uint32_t p[4];
+      for (int i = 0; i < 4; ++i)
+        p[i] = static_cast<uint32_t>((su ? sb(b, i) : static_cast<int32_t>(ub(b, i))) *
+                                     static_cast<int32_t>(ub(c, i)));
+      set(in.xrd, pack16(addsub(d >> 16, p[1], sub_d), addsub(d, p[0], sub_d)));
+      set(in.xra, pack16(addsub(a >> 16, p[3], sub_a), addsub(a, p[2], sub_a)));
+      break;
+    }
+    case Op::q8madl: {
+      uint32_t r[4];
+      for (int i = 0; i < 4; ++i)
+        r[i] = addsub(ub(a, i), ub(b, i) * ub(c, i), i >= 2 ? sub_a : sub_d);
+      set(in.xrd, pack8(r[3], r[2], r[1], r[0]));
+      break;
+    }
+
+    case Op::q8movz:
+    case Op::q8movn: {
+      uint32_t r = a;
+      for (int i = 0; i < 4; ++i) {
+        const uint32_t m = 0xffu << (8 * i);
+        if (((c & m) == 0) == (in.op == Op::q8movz))
+          r = (r & ~m) | (b & m);
+      }
+      set(in.xra, r);
+      break;
+    }
+    case Op::d16movz:
+    case Op::d16movn: {
+      uint32_t r = a;
+      for (int i = 0; i < 2; ++i) {
+        const uint32_t m = 0xffffu << (16 * i);
+        if (((c & m) == 0) == (in.op == Op::d16movz))
+          r = (r & ~m) | (b & m);
+      }
+      set(in.xra, r);
+      break;
+    }
+    case Op::s32movz:  if (c == 0) set(in.xra, b);  break;
+    case Op::s32movn:  if (c != 0) set(in.xra, b);  break;
+
+    case Op::q16scop:
+      set(in.xrd, pack16(sign16(hi16(c)), sign16(lo16(c))));
+      set(in.xra, pack16(sign16(hi16(b)), sign16(lo16(b))));
+      break;
+    case Op::s32sfl: {
+      uint32_t ra, rd;
+      switch (in.ptn) {
+        case 0:
+          ra = pack8(ub(b, 3), ub(c, 3), ub(b, 2), ub(c, 2));
+          rd = pack8(ub(b, 1), ub(c, 1), ub(b, 0), ub(c, 0));
+          break;
+        case 1:
+          ra = pack8(ub(b, 3), ub(b, 1), ub(c, 3), ub(c, 1));
+          rd = pack8(ub(b, 2), ub(b, 0), ub(c, 2), ub(c, 0));
+          break;
+        case 2:
+          ra = pack8(ub(b, 3), ub(c, 3), ub(b, 1), ub(c, 1));
+          rd = pack8(ub(b, 2), ub(c, 2), ub(b, 0), ub(c, 0));
+          break;
+        default:
+          ra = (b & 0xffff0000) | (c >> 16);
+          rd = (b << 16) | (c & 0xffff);
+          break;
+      }
+      set(in.xrd, rd);
+      set(in.xra, ra);
+      break;
+    }
+    case Op::q8sad: {
+      uint32_t sad = 0;
+      for (int i = 0; i < 4; ++i)
+        sad += ub(b, i) > ub(c, i) ? ub(b, i) - ub(c, i) : ub(c, i) - ub(b, i);
+      set(in.xrd, d + sad);
+      set(in.xra, sad);
+      break;
+    }
+
+    case Op::d32add: {
+      const uint64_t ra = sub_a ? static_cast<uint64_t>(b) - c : static_cast<uint64_t>(b) + c;
+      const uint64_t rd = sub_d ? static_cast<uint64_t>(b) - c : static_cast<uint64_t>(b) + c;
+      xr[16] = (xr[16] & ~(CR_CARRY_A | CR_CARRY_D)) |
+               ((ra >> 32) ? CR_CARRY_A : 0) | ((rd >> 32) ? CR_CARRY_D : 0);
+      set(in.xrd, static_cast<uint32_t>(rd));
+      set(in.xra, static_cast<uint32_t>(ra));
+      break;
+    }
+    case Op::d32addc:
+      set(in.xrd, c + ((xr[16] & CR_CARRY_D) ? 1 : 0));
+      set(in.xra, b + ((xr[16] & CR_CARRY_A) ? 1 : 0));
+      break;
+    case Op::d32acc:
+      set(in.xrd, d + addsub(b, c, sub_d));
+      set(in.xra, a + addsub(b, c, sub_a));
+      break;
+    case Op::d32accm:
+      set(in.xrd, addsub(d, b - c, sub_d));
+      set(in.xra, addsub(a, b + c, sub_a));
+      break;
+    case Op::d32asum:
+      set(in.xrd, addsub(d, c, sub_d));
+      set(in.xra, addsub(a, b, sub_a));
+      break;
+    case Op::q16acc:
+      set(in.xrd, pack16((d >> 16) + addsub(b >> 16, c >> 16, sub_d), d + addsub(b, c, sub_d)));
+      set(in.xra, pack16((a >> 16) + addsub(b >> 16, c >> 16, sub_a), a + addsub(b, c, sub_a)));
+      break;
+    case Op::q16accm:
+      set(in.xrd, pack16(addsub(d >> 16, c >> 16, sub_d), addsub(d, c, sub_d)));
+      set(in.xra, pack16(addsub(a >> 16, b >> 16, sub_a), addsub(a, b, sub_a)));
+      break;
+    case Op::d16asum:
+      set(in.xrd, addsub(d, static_cast<uint32_t>(hi16(c) + lo16(c)), sub_d));
+      set(in.xra, addsub(a, static_cast<uint32_t>(hi16(b) + lo16(b)), sub_a));
+      break;
+    case Op::q8adde:
+      set(in.xrd, pack16(addsub(ub(b, 1), ub(c, 1), sub_d), addsub(ub(b, 0), ub(c, 0), sub_d)));
+      set(in.xra, pack16(addsub(ub(b, 3), ub(c, 3), sub_a), addsub(ub(b, 2), ub(c, 2), sub_a)));
+      break;
+    case Op::d8sum:
+    case Op::d8sumc: {
+      const uint32_t k = in.op == Op::d8sumc ? 2 : 0;
+      set(in.xra, pack16(ub(b, 3) + ub(b, 2) + ub(b, 1) + ub(b, 0) + k,
+                         ub(c, 3) + ub(c, 2) + ub(c, 1) + ub(c, 0) + k));
+      break;
+    }
+    case Op::q8acce:
+      set(in.xrd, pack16((d >> 16) + addsub(ub(b, 1), ub(c, 1), sub_d),
+                         d + addsub(ub(b, 0), ub(c, 0), sub_d)));
+      set(in.xra, pack16((a >> 16) + addsub(ub(b, 3), ub(c, 3), sub_a),
+                         a + addsub(ub(b, 2), ub(c, 2), sub_a)));
+      break;
+
+    case Op::s32cps:
+      set(in.xra, static_cast<int32_t>(c) < 0 ? 0 - b : b);
+      break;
+    case Op::d16cps:
+      set(in.xra, pack16(lo16(c >> 16) < 0 ? 0 - (b >> 16) : b >> 16,
+                         lo16(c) < 0 ? 0 - b : b));
+      break;
+    case Op::q8abd: {
+      uint32_t r[4];
+      for (int i = 0; i < 4; ++i)
+        r[i] = ub(b, i) > ub(c, i) ? ub(b, i) - ub(c, i) : ub(c, i) - ub(b, i);
+      set(in.xra, pack8(r[3], r[2], r[1], r[0]));
+      break;
+    }
+    case Op::q16sat:
+      set(in.xra, pack8(sat_u8(hi16(b)), sat_u8(lo16(b)), sat_u8(hi16(c)), sat_u8(lo16(c))));
+      break;
+    case Op::s32slt:
+      set(in.xra, static_cast<int32_t>(b) < static_cast<int32_t>(c));
+      break;
+    case Op::d16slt:
+      set(in.xra, pack16(hi16(b) < hi16(c), lo16(b) < lo16(c)));
+      break;
+    case Op::d16avg:
+    case Op::d16avgr: {
+      const int32_t k = in.op == Op::d16avgr;
+      set(in.xra, pack16(static_cast<uint32_t>((hi16(b) + hi16(c) + k) >> 1),
+                         static_cast<uint32_t>((lo16(b) + lo16(c) + k) >> 1)));
+      break;
+    }
+    case Op::q8avg:
+    case Op::q8avgr: {
+      const uint32_t k = in.op == Op::q8avgr;
+      uint32_t r[4];
+      for (int i = 0; i < 4; ++i)
+        r[i] = (ub(b, i) + ub(c, i) + k) >> 1;
+      set(in.xra, pack8(r[3], r[2], r[1], r[0]));
+      break;
+    }
+    case Op::q8add: {
+      uint32_t r[4];
+      for (int i = 0; i < 4; ++i)
+        r[i] = addsub(ub(b, i), ub(c, i), i >= 2 ? sub_a : sub_d);
+      set(in.xra, pack8(r[3], r[2], r[1], r[0]));
+      break;
+    }
+    case Op::s32max:
+    case Op::s32min: {
+      const bool lt = static_cast<int32_t>(b) < static_cast<int32_t>(c);
+      set(in.xra, (lt == (in.op == Op::s32min)) ? b : c);
+      break;
+    }
+    case Op::d16max:
+    case Op::d16min: {
+      const bool mn = in.op == Op::d16min;
+      set(in.xra, pack16(static_cast<uint32_t>(((hi16(b) < hi16(c)) == mn) ? hi16(b) : hi16(c)),
+                         static_cast<uint32_t>(((lo16(b) < lo16(c)) == mn) ? lo16(b) : lo16(c))));
+      break;
+    }
+    case Op::q8max:
+    case Op::q8min: {
+      const bool mn = in.op == Op::q8min;
+      uint32_t r[4];
+      for (int i = 0; i < 4; ++i)
+        r[i] = ((ub(b, i) < ub(c, i)) == mn) ? ub(b, i) : ub(c, i);
+      set(in.xra, pack8(r[3], r[2], r[1], r[0]));
+      break;
+    }
+    case Op::q8slt:
+    case Op::q8sltu: {
+      const bool u = in.op == Op::q8sltu;
+      uint32_t r[4];
+      for (int i = 0; i < 4; ++i)
+        r[i] = u ? ub(b, i) < ub(c, i) : sb(b, i) < sb(c, i);
+      set(in.xra, pack8(r[3], r[2], r[1], r[0]));
+      break;
+    }
+
+    case Op::d32sll:
+      set(in.xrd, c << in.imm);
+      set(in.xra, b << in.imm);
+      break;
+    case Op::d32slr:
+      set(in.xrd, c >> in.imm);
+      set(in.xra, b >> in.imm);
+      break;
+    case Op::d32sar:
+      set(in.xrd, static_cast<uint32_t>(static_cast<int32_t>(c) >> in.imm));
+      set(in.xra, static_cast<uint32_t>(static_cast<int32_t>(b) >> in.imm));
+      break;
+    case Op::d32sarl:
+      set(in.xra, pack16(static_cast<uint32_t>(static_cast<int32_t>(b) >> in.imm),
+                         static_cast<uint32_t>(static_cast<int32_t>(c) >> in.imm)));
+      break;
+    case Op::q16sll:
+      set(in.xrd, pack16((c >> 16) << in.imm, c << in.imm));
+      set(in.xra, pack16((b >> 16) << in.imm, b << in.imm));
+      break;
+    case Op::q16slr:
+      set(in.xrd, pack16((c >> 16) >> in.imm, (c & 0xffff) >> in.imm));
+      set(in.xra, pack16((b >> 16) >> in.imm, (b & 0xffff) >> in.imm));
+      break;
+    case Op::q16sar:
+      set(in.xrd, pack16(static_cast<uint32_t>(hi16(c) >> in.imm), static_cast<uint32_t>(lo16(c) >> in.imm)));
+      set(in.xra, pack16(static_cast<uint32_t>(hi16(b) >> in.imm), static_cast<uint32_t>(lo16(b) >> in.imm)));
+      break;
+
+    case Op::d32sllv:
+    case Op::d32slrv:
+    case Op::d32sarv:
+    case Op::q16sllv:
+    case Op::q16slrv:
+    case Op::q16sarv: {
+      // In-place shifts of XRa and XRd by rs[3:0]
+      const unsigned s = rg(in.rs) & 0xf;
+      uint32_t v[2] = { a, d };
+      for (uint32_t& e : v) {
+        switch (in.op) {
+          case Op::d32sllv:  e = e << s;  break;
+          case Op::d32slrv:  e = e >> s;  break;
+          case Op::d32sarv:  e = static_cast<uint32_t>(static_cast<int32_t>(e) >> s);  break;
+          case Op::q16sllv:  e = pack16((e >> 16) << s, e << s);  break;
+          case Op::q16slrv:  e = pack16((e >> 16) >> s, (e & 0xffff) >> s);  break;
+          default:           e = pack16(static_cast<uint32_t>(hi16(e) >> s),
+                                        static_cast<uint32_t>(lo16(e) >> s));  break;
+        }
+      }
+      set(in.xrd, v[1]);
+      set(in.xra, v[0]);
+      break;
+    }
+
+    case Op::s32madd:   hilo_madd(in, true,  false, true);   break;
+    case Op::s32maddu:  hilo_madd(in, false, false, true);   break;
+    case Op::s32msub:   hilo_madd(in, true,  true,  true);   break;
+    case Op::s32msubu:  hilo_madd(in, false, true,  true);   break;
+    case Op::s32mul:    hilo_madd(in, true,  false, false);  break;
+    case Op::s32mulu:   hilo_madd(in, false, false, false);  break;
+    case Op::s32extr:
+    case Op::s32extrv: {
+      // Extract a field 'bits' wide, starting rs[4:0] bits below the MSB of
+      //  the 64-bit pair {XRa:XRd}, right-aligned into XRa.
+      unsigned bits = in.op == Op::s32extr ? in.imm : rg(in.rt) & 0x1f;
+      if (bits == 0)
+        bits = 32;
+      const unsigned pos = rg(in.rs) & 0x1f;
+      const uint64_t pair = (static_cast<uint64_t>(a) << 32) | d;
+      const uint64_t field = pair >> (64 - pos - bits);
+      set(in.xra, static_cast<uint32_t>(field & ((uint64_t{1} << bits) - 1)));
+      break;
+    }
+
+    case Op::d32sarw: {
+      const unsigned s = rg(in.rs) & 0xf;
+      set(in.xra, pack16(static_cast<uint32_t>(static_cast<int32_t>(b) >> s),
+                         static_cast<uint32_t>(static_cast<int32_t>(c) >> s)));
+      break;
+    }
+    case Op::s32aln:
+    case Op::s32alni: {
+      // Upper word of {XRb:XRc} << (8 * n), n in 0..4
+      const unsigned n = in.op == Op::s32aln ? rg(in.rs) & 7 : in.ptn;
+      if (n <= 4)
+        set(in.xra, n == 0 ? b : n == 4 ? c : (b << (8 * n)) | (c >> (32 - 8 * n)));
+      break;
+    }
+    case Op::s32lui: {
+      const uint32_t i8 = static_cast<uint32_t>(in.imm) & 0xff;
+      uint32_t r;
+      switch (in.ptn) {
+        case 0:  r = i8;  break;
+        case 1:  r = i8 << 8;  break;
+        case 2:  r = i8 << 16;  break;
+        case 3:  r = i8 << 24;  break;
+        case 4:  r = pack16(i8, i8);  break;
+        case 5:  r = pack16(i8 << 8, i8 << 8);  break;
+        case 6:  r = pack16(static_cast<uint32_t>(sb(i8, 0)), static_cast<uint32_t>(sb(i8, 0)));  break;
+        default: r = i8 * 0x01010101u;  break;
+      }
+      set(in.xra, r);
+      break;
+    }
+    case Op::s32nor:  set(in.xra, ~(b | c));  break;
+    case Op::s32and:  set(in.xra, b & c);  break;
+    case Op::s32or:   set(in.xra, b | c);  break;
+    case Op::s32xor:  set(in.xra, b ^ c);  break;
+
+    case Op::s32m2i:  set_gpr(in.rt, in.xra == 16 ? xr[16] : x(in.xra));  break;
+    case Op::s32i2m:
+      if (in.xra == 16)
+        xr[16] = rg(in.rt);
+      else
+        set(in.xra, rg(in.rt));
+      break;
+
+    case Op::s32lddv:
+    case Op::s32lddvr:
+    case Op::s32ldiv:
+    case Op::s32ldivr: {
+      const uint32_t addr = rg(in.rs) + (rg(in.rt) << in.imm);
+      const uint32_t v = mem.load32(addr);
+      set(in.xra, (in.op == Op::s32lddvr || in.op == Op::s32ldivr) ? bswap32(v) : v);
+      if (in.op == Op::s32ldiv || in.op == Op::s32ldivr)
+        set_gpr(in.rs, addr);
+      break;
+    }
+    case Op::s32stdv:
+    case Op::s32stdvr:
+    case Op::s32sdiv:
+    case Op::s32sdivr: {
+      const uint32_t addr = rg(in.rs) + (rg(in.rt) << in.imm);
+      mem.store32(addr, (in.op == Op::s32stdvr || in.op == Op::s32sdivr) ? bswap32(a) : a);
+      if (in.op == Op::s32sdiv || in.op == Op::s32sdivr)
+        set_gpr(in.rs, addr);
+      break;
+    }
+    case Op::s32ldd:
+    case Op::s32lddr:
+    case Op::s32ldi:
+    case Op::s32ldir: {
+      const uint32_t addr = rg(in.rs) + static_cast<uint32_t>(in.imm);
+      const uint32_t v = mem.load32(addr);
+      set(in.xra, (in.op == Op::s32lddr || in.op == Op::s32ldir) ? bswap32(v) : v);
+      if (in.op == Op::s32ldi || in.op == Op::s32ldir)
+        set_gpr(in.rs, addr);
+      break;
+    }
+    case Op::s32std:
+    case Op::s32stdr:
+    case Op::s32sdi:
+    case Op::s32sdir: {
+      const uint32_t addr = rg(in.rs) + static_cast<uint32_t>(in.imm);
+      mem.store32(addr, (in.op == Op::s32stdr || in.op == Op::s32sdir) ? bswap32(a) : a);
+      if (in.op == Op::s32sdi || in.op == Op::s32sdir)
+        set_gpr(in.rs, addr);
+      break;
+    }
+    case Op::s8ldd:
+    case Op::s8ldi: {
+      const uint32_t addr = rg(in.rs) + static_cast<uint32_t>(in.imm);
+      const uint32_t v = mem.load8(addr);
+      uint32_t r;
+      switch (in.ptn) {
+        case 0: case 1: case 2: case 3:
+          r = (a & ~(0xffu << (8 * in.ptn))) | (v << (8 * in.ptn));  break;
+        case 4:  r = pack16(v, v);  break;
+        case 5:  r = pack16(v << 8, v << 8);  break;
+        case 6:  r = pack16(static_cast<uint32_t>(sb(v, 0)), static_cast<uint32_t>(sb(v, 0)));  break;
+        default: r = v * 0x01010101u;  break;
+      }
+      set(in.xra, r);
+      if (in.op == Op::s8ldi)
+        set_gpr(in.rs, addr);
+      break;
+    }
+    case Op::s8std:
+    case Op::s8sdi: {
+      const uint32_t addr = rg(in.rs) + static_cast<uint32_t>(in.imm);
+      mem.store8(addr, ub(a, in.ptn));
+      if (in.op == Op::s8sdi)
+        set_gpr(in.rs, addr);
+      break;
+    }
+    case Op::s16ldd:
+    case Op::s16ldi: {
+      const uint32_t addr = rg(in.rs) + static_cast<uint32_t>(in.imm);
+      const uint32_t v = mem.load16(addr);
+      uint32_t r;
+      switch (in.ptn) {
+        case 0:  r = (a & 0xffff0000) | v;  break;
+        case 1:  r = (a & 0x0000ffff) | (v << 16);  break;
+        case 2:  r = static_cast<uint32_t>(lo16(v));  break;
+        default: r = pack16(v, v);  break;
+      }
+      set(in.xra, r);
+      if (in.op == Op::s16ldi)
+        set_gpr(in.rs, addr);
+      break;
+    }
+    case Op::s16std:
+    case Op::s16sdi: {
+      const uint32_t addr = rg(in.rs) + static_cast<uint32_t>(in.imm);
+      mem.store16(addr, in.ptn ? a >> 16 : a);
+      if (in.op == Op::s16sdi)
+        set_gpr(in.rs, addr);
+      break;
+    }
+
+    case Op::lxw:
+    case Op::lxh:
+    case Op::lxhu:
+    case Op::lxb:
+    case Op::lxbu: {
+      const uint32_t addr = rg(in.rs) + (rg(in.rt) << in.imm);
+      uint32_t v;
+      switch (in.op) {
+        case Op::lxw:   v = mem.load32(addr);  break;
+        case Op::lxh:   v = static_cast<uint32_t>(lo16(mem.load16(addr)));  break;
+        case Op::lxhu:  v = mem.load16(addr);  break;
+        case Op::lxb:   v = static_cast<uint32_t>(sb(mem.load8(addr), 0));  break;
+        default:        v = mem.load8(addr);  break;
+      }
+      set_gpr(in.rd, v);
+      break;
+    }
+
+    case Op::invalid:
+      throw Fault("not an MXU1 instruction", encode(in));
+  }
+}
+
+} // namespace mxu1
+
+#endif // MXU1_EMU_HPP
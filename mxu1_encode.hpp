@@ -0,0 +1,303 @@
+// mxu1_encode.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 constexpr instruction encoders
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  One constexpr function per GAS macro in mxu1_as_macros.s.h, same name,
+// same operand order, returning the same '.word':
+//
+//     using namespace mxu1;
+//     constexpr uint32_t w = d16mac(xr1, xr2, xr3, xr4, AS, XW);
+//     uint32_t ld = s32ldi(xr5, gpr::a1, stride);     // runtime operands too
+//
+// Operands are range-checked exactly like MXU_CHECK_BOUNDS, MXU_CHECK_OFFSET
+// and MXU_CHECK_PATTERN do. A failed check throws, which inside a constant
+// expression becomes a compile-time error, and at runtime (when building
+// code on the fly, see mxu1_emitter.hpp) a std::out_of_range or
+// std::invalid_argument carrying the same message GAS would have printed.
+//
+// A handful of ordinary MIPS32 encoders live in mxu1::mips, just enough to
+// glue generated MXU sequences into callable functions.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_ENCODE_HPP
+#define MXU1_ENCODE_HPP
+
+#include "mxu1_isa.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace mxu1 {
+
+// MXU regs xr0..xr16 (xr16 only valid with s32i2m,s32m2i)
+struct Xr { uint8_t n; };
+constexpr Xr xr0{0},   xr1{1},   xr2{2},   xr3{3},   xr4{4},   xr5{5},   xr6{6},   xr7{7},
+             xr8{8},   xr9{9},   xr10{10}, xr11{11}, xr12{12}, xr13{13}, xr14{14}, xr15{15},
+             xr16{16};
+
+// MIPS GPRs, named as in the GAS header minus the '$'
+struct Gpr { uint8_t n; };
+namespace gpr {
+constexpr Gpr zero{0}, at{1},  v0{2},  v1{3},  a0{4},  a1{5},  a2{6},  a3{7},
+              t0{8},   t1{9},  t2{10}, t3{11}, t4{12}, t5{13}, t6{14}, t7{15},
+              s0{16},  s1{17}, s2{18}, s3{19}, s4{20}, s5{21}, s6{22}, s7{23},
+              t8{24},  t9{25}, k0{26}, k1{27}, gp{28}, sp{29}, fp{30}, s8{30},
+              ra{31};
+} // namespace gpr
+
+// Pattern operands, named as the MXU_APTN1_*, MXU_MPTN2_* etc. equivs
+enum Aptn1 : uint8_t { A, S };
+enum Mptn2 : uint8_t { HH, LL, HL, LH };
+enum Aptn2 : uint8_t { AA, AS, SA, SS };
+enum Optn2 : uint8_t { WW, LW, HW, XW };
+
+namespace detail {
+
+constexpr int check_bounds(int val, int lo_bound, int hi_bound)
+{
+  if (val < lo_bound || val > hi_bound)
+    throw std::out_of_range("MXU opcode field out of range");
+  return val;
+}
+
+constexpr int check_offset(int val, int byte_alignment, int lo_bound, int hi_bound)
+{
+  if (val & (byte_alignment - 1))
+    throw std::invalid_argument("MXU opcode immediate offset misaligned");
+  if (val < lo_bound || val > hi_bound)
+    throw std::out_of_range("MXU opcode immediate offset out of range");
+  return val;
+}
+
+constexpr uint8_t check_pattern(int ptn, int lo_bound, int hi_bound)
+{
+  if (ptn < lo_bound || ptn > hi_bound)
+    throw std::out_of_range("MXU opcode pattern field out of range");
+  return static_cast<uint8_t>(ptn);
+}
+
+constexpr uint8_t x(Xr r)   { return static_cast<uint8_t>(check_bounds(r.n, 0, 15)); }
+constexpr uint8_t x16(Xr r) { return static_cast<uint8_t>(check_bounds(r.n, 0, 16)); }
+constexpr uint8_t g(Gpr r)  { return static_cast<uint8_t>(check_bounds(r.n, 0, 31)); }
+
+constexpr Insn make(Op op, Xr xra, Xr xrb, Xr xrc, Xr xrd)
+{
+  Insn in;
+  in.op  = op;
+  in.xra = x(xra);  in.xrb = x(xrb);  in.xrc = x(xrc);  in.xrd = x(xrd);
+  return in;
+}
+
+constexpr uint32_t abcd(Op op, Xr a, Xr b, Xr c, Xr d, unsigned aptn, unsigned optn)
+{
+  Insn in = make(op, a, b, c, d);
+  in.aptn = static_cast<uint8_t>(aptn);  in.optn = static_cast<uint8_t>(optn);
+  return encode(in);
+}
+
+constexpr uint32_t abcd_ptn(Op op, Xr a, Xr b, Xr c, Xr d, int ptn)
+{
+  Insn in = make(op, a, b, c, d);
+  in.ptn = check_pattern(ptn, 0, info(op).ptn_max);
+  return encode(in);
+}
+
+constexpr uint32_t abcd_sft(Op op, Xr a, Xr b, Xr c, Xr d, int sft4)
+{
+  Insn in = make(op, a, b, c, d);
+  in.imm = check_bounds(sft4, 0, 15);
+  return encode(in);
+}
+
+constexpr uint32_t ad_rs_rt(Op op, Xr a, Xr d, Gpr rs, Gpr rt)
+{
+  Insn in = make(op, a, xr0, xr0, d);
+  in.rs = g(rs);  in.rt = g(rt);
+  return encode(in);
+}
+
+constexpr uint32_t ad_rs_bits(Op op, Xr a, Xr d, Gpr rs, int bits5)
+{
+  Insn in = make(op, a, xr0, xr0, d);
+  in.rs = g(rs);  in.imm = check_bounds(bits5, 1, 31);
+  return encode(in);
+}
+
+constexpr uint32_t abc_rs(Op op, Xr a, Xr b, Xr c, Gpr rs)
+{
+  Insn in = make(op, a, b, c, xr0);
+  in.rs = g(rs);
+  return encode(in);
+}
+
+constexpr uint32_t lui(Op op, Xr a, int imm8, int ptn)
+{
+  Insn in = make(op, a, xr0, xr0, xr0);
+  in.ptn = check_pattern(ptn, 0, info(op).ptn_max);
+  in.imm = imm8 < 0 ? check_bounds(imm8, -128, 127) : check_bounds(imm8, 0, 255);
+  return encode(in);
+}
+
+constexpr uint32_t a16_rt(Op op, Xr a, Gpr rt)
+{
+  Insn in;
+  in.op = op;  in.xra = x16(a);  in.rt = g(rt);
+  return encode(in);
+}
+
+constexpr uint32_t a_rs_rt_strd(Op op, Xr a, Gpr rs, Gpr rt, int strd2)
+{
+  Insn in = make(op, a, xr0, xr0, xr0);
+  in.rs = g(rs);  in.rt = g(rt);  in.imm = check_bounds(strd2, 0, 2);
+  return encode(in);
+}
+
+constexpr uint32_t a_rs_off(Op op, Xr a, Gpr rs, int imm, int align, int lo, int hi, int ptn)
+{
+  Insn in = make(op, a, xr0, xr0, xr0);
+  in.rs = g(rs);  in.imm = check_offset(imm, align, lo, hi);
+  in.ptn = check_pattern(ptn, 0, info(op).ptn_max);
+  return encode(in);
+}
+
+constexpr uint32_t rd_rs_rt_strd(Op op, Gpr rd, Gpr rs, Gpr rt, int strd2)
+{
+  Insn in;
+  in.op = op;  in.rd = g(rd);  in.rs = g(rs);  in.rt = g(rt);
+  in.imm = check_bounds(strd2, 0, 2);
+  return encode(in);
+}
+
+} // namespace detail
+
+// One encoder per operand format, instantiated for every MXU1_OPCODES() entry
+#define MXU1_ENC_XA_XB_XC_XD_OPTN2(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Xr xrd, Optn2 optn2) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xrd, 0, optn2); }
+#define MXU1_ENC_XA_XB_XC_OPTN2(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Optn2 optn2) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xr0, 0, optn2); }
+#define MXU1_ENC_XA_XB_XC_XD_APTN2_OPTN2(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Xr xrd, Aptn2 aptn2, Optn2 optn2) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xrd, aptn2, optn2); }
+#define MXU1_ENC_XA_XB_XC_XD_APTN1_MPTN2(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Xr xrd, Aptn1 aptn1, Mptn2 mptn2) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xrd, aptn1, mptn2); }
+#define MXU1_ENC_XA_XB_XC_XD(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Xr xrd) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xrd, 0, 0); }
+#define MXU1_ENC_XA_XB_XC_XD_APTN2(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Xr xrd, Aptn2 aptn2) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xrd, aptn2, 0); }
+#define MXU1_ENC_XA_XB_XC(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xr0, 0, 0); }
+#define MXU1_ENC_XA_XB_XC_XD_PTN(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Xr xrd, int ptn) \
+  { return detail::abcd_ptn(Op::name, xra, xrb, xrc, xrd, ptn); }
+#define MXU1_ENC_XA_XB_XC_APTN2(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Aptn2 aptn2) \
+  { return detail::abcd(Op::name, xra, xrb, xrc, xr0, aptn2, 0); }
+#define MXU1_ENC_XA_XB_XC_XD_SFT4(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Xr xrd, int sft4) \
+  { return detail::abcd_sft(Op::name, xra, xrb, xrc, xrd, sft4); }
+#define MXU1_ENC_XA_XB_XC_SFT4(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, int sft4) \
+  { return detail::abcd_sft(Op::name, xra, xrb, xrc, xr0, sft4); }
+#define MXU1_ENC_XA_XD_RS(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrd, Gpr rs) \
+  { return detail::ad_rs_rt(Op::name, xra, xrd, rs, gpr::zero); }
+#define MXU1_ENC_XA_XD_RS_RT(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrd, Gpr rs, Gpr rt) \
+  { return detail::ad_rs_rt(Op::name, xra, xrd, rs, rt); }
+#define MXU1_ENC_XA_XD_RS_BITS5(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrd, Gpr rs, int bits5) \
+  { return detail::ad_rs_bits(Op::name, xra, xrd, rs, bits5); }
+#define MXU1_ENC_XA_XB_XC_RS(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, Gpr rs) \
+  { return detail::abc_rs(Op::name, xra, xrb, xrc, rs); }
+#define MXU1_ENC_XA_XB_XC_PTN(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Xr xrb, Xr xrc, int ptn) \
+  { return detail::abcd_ptn(Op::name, xra, xrb, xrc, xr0, ptn); }
+#define MXU1_ENC_XA_IMM8_PTN(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, int imm8, int ptn) \
+  { return detail::lui(Op::name, xra, imm8, ptn); }
+#define MXU1_ENC_XA16_RT(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Gpr rt) \
+  { return detail::a16_rt(Op::name, xra, rt); }
+#define MXU1_ENC_XA_RS_RT_STRD2(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Gpr rs, Gpr rt, int strd2) \
+  { return detail::a_rs_rt_strd(Op::name, xra, rs, rt, strd2); }
+#define MXU1_ENC_XA_RS_S12(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Gpr rs, int imm12) \
+  { return detail::a_rs_off(Op::name, xra, rs, imm12, 4, -2048, 2047, 0); }
+#define MXU1_ENC_XA_RS_S8_PTN(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Gpr rs, int imm8, int ptn) \
+  { return detail::a_rs_off(Op::name, xra, rs, imm8, 1, -128, 127, ptn); }
+#define MXU1_ENC_XA_RS_S10_PTN(name, ptn_max) \
+  constexpr uint32_t name(Xr xra, Gpr rs, int imm10, int ptn) \
+  { return detail::a_rs_off(Op::name, xra, rs, imm10, 2, -512, 511, ptn); }
+#define MXU1_ENC_RD_RS_RT_STRD2(name, ptn_max) \
+  constexpr uint32_t name(Gpr rd, Gpr rs, Gpr rt, int strd2) \
+  { return detail::rd_rs_rt_strd(Op::name, rd, rs, rt, strd2); }
+
+#define MXU1_X(name, word, fmt, ptn_max) MXU1_ENC_##fmt(name, ptn_max)
+MXU1_OPCODES(MXU1_X)
+#undef MXU1_X
+
+// The few plain MIPS32 instructions needed around generated MXU code
+namespace mips {
+
+constexpr uint32_t i_type(unsigned opc, Gpr rs, Gpr rt, int imm16)
+{
+  return (opc << 26) | (detail::g(rs) << 21) | (detail::g(rt) << 16) |
+         (static_cast<uint32_t>(detail::check_bounds(imm16, -32768, 65535)) & 0xffff);
+}
+
+constexpr uint32_t r_type(unsigned funct, Gpr rs, Gpr rt, Gpr rd)
+{
+  return (detail::g(rs) << 21) | (detail::g(rt) << 16) | (detail::g(rd) << 11) | funct;
+}
+
+constexpr uint32_t nop()                             { return 0; }
+constexpr uint32_t jr(Gpr rs)                        { return r_type(0x08, rs, gpr::zero, gpr::zero); }
+constexpr uint32_t addu(Gpr rd, Gpr rs, Gpr rt)      { return r_type(0x21, rs, rt, rd); }
+constexpr uint32_t subu(Gpr rd, Gpr rs, Gpr rt)      { return r_type(0x23, rs, rt, rd); }
+constexpr uint32_t addiu(Gpr rt, Gpr rs, int imm16)  { return i_type(0x09, rs, rt, detail::check_bounds(imm16, -32768, 32767)); }
+constexpr uint32_t ori(Gpr rt, Gpr rs, int imm16)    { return i_type(0x0d, rs, rt, detail::check_bounds(imm16, 0, 65535)); }
+constexpr uint32_t lui(Gpr rt, int imm16)            { return i_type(0x0f, gpr::zero, rt, detail::check_bounds(imm16, 0, 65535)); }
+constexpr uint32_t lw(Gpr rt, Gpr base, int off16)   { return i_type(0x23, base, rt, detail::check_bounds(off16, -32768, 32767)); }
+constexpr uint32_t sw(Gpr rt, Gpr base, int off16)   { return i_type(0x2b, base, rt, detail::check_bounds(off16, -32768, 32767)); }
+// Branch offsets are in instructions, relative to the delay slot
+constexpr uint32_t beq(Gpr rs, Gpr rt, int off16)    { return i_type(0x04, rs, rt, detail::check_bounds(off16, -32768, 32767)); }
+constexpr uint32_t bne(Gpr rs, Gpr rt, int off16)    { return i_type(0x05, rs, rt, detail::check_bounds(off16, -32768, 32767)); }
+
+} // namespace mips
+
+} // namespace mxu1
+
+#endif // MXU1_ENCODE_HPP
@@ -0,0 +1,727 @@
+// mxu1_intrin.h
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 inline-asm intrinsics for C and C++
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Every opcode macro of mxu1_as_macros.s.h as a C/C++ statement, so MXU code
+// can be inlined into C and C++ loops instead of living in a .s file behind a
+// call. mxu1_q8sad(3, 1, 2, 5) assembles 'q8sad xr3, xr1, xr2, xr5' through
+// the macro itself: same name with a mxu1_ prefix, same operand order, same
+// encoding. For example:
+//
+//     #include "mxu1_intrin.h"
+//
+//     uint32_t sad(const uint32_t *a, const uint32_t *b, int n)
+//     {
+//       mxu1_s32xor(5, 5, 5);
+//       for (a -= 1, b -= 1; n > 0; --n) {
+//         mxu1_s32ldi(1, a, 4);               // xr1 = *++a
+//         mxu1_s32ldi(2, b, 4);
+//         mxu1_q8sad(3, 1, 2, 5);
+//       }
+//       return mxu1_s32m2i(5);
+//     }
+//
+//  Operands:
+//   - xr registers are numbers, 0..15 (0..16 for s32i2m and s32m2i), and
+//     pattern, shift and offset fields integer constants, MXU1_AS and the
+//     like for the named patterns. They must be constant expressions, and
+//     are checked against the same ranges (and offset alignments) as in
+//     the GAS macros: a bad one is a compile error at the call, an array
+//     of negative size in MXU1_FIELD_, or an impossible "i" constraint when
+//     not constant;
+//   - GPR operands are C expressions, which the compiler puts in registers
+//     of its choosing ("r"; "rJ", so a constant 0 is $zero, where a value
+//     is only read). A base pointer the opcode updates (the _i_ forms, as
+//     s32ldi above) must be an lvalue, and is advanced in place;
+//   - s32m2i and the lx* loads return their GPR result instead of taking it:
+//     uint32_t, or int32_t for lxh and lxb.
+//  Arguments may be evaluated more than once: pass plain variables.
+//
+//  From C++, mxu1::intrin has every opcode as a function template, with the
+// constant operands as template arguments, which are constant expressions
+// at any optimization level (a function parameter is not one, inlined or
+// not, so it cannot reach an "i" constraint at -O0), and the GPR operands
+// as function arguments, evaluated once:
+//
+//     mxu1::intrin::s32ldi<1, 4>(a);          // a: the pointer, advanced
+//     mxu1::intrin::q8sad<3, 1, 2, 5>();
+//
+//  The compiler does not know about xr registers, so every MXU statement is
+// __volatile__: they stay in program order with one another, while other
+// code is free to be scheduled around them. Values stay in the numbered xr
+// registers between statements, but not across a call to a function that
+// uses the MXU itself (the kernels treat all of xr1..xr15 as scratch).
+// s32madd[u], s32msub[u] and s32mul[u] clobber HI/LO, and the madd/msub
+// forms accumulate in them: keep C multiplications and divisions out of a
+// chain of those.
+//
+//  Memory is described exactly rather than by a "memory" clobber, so C code
+// touching other memory is not held back: a load has the bytes it reads as
+// an "m" input, a store the bytes it writes as an "=m" output, typed with
+// __may_alias__ so any type of buffer is covered. The register-indexed forms
+// (s32lddv etc. and lx*) read, or write, "the memory from rs onwards", as
+// they are used, with a non-negative index scaled by the stride: a negative
+// index may need a __asm__ __volatile__("" ::: "memory") before or after.
+//
+//  Including this header also includes mxu1_as_macros.s.h into the
+// translation unit's assembly, so the include path of the assembler must
+// reach it. It is for MIPS targets only, and not only for the opcodes: the
+// s32madd/msub/mul statements name "hi" and "lo" as clobbers, registers
+// that no other target's compiler accepts. The MXU must be enabled (MXU_CR,
+// see kernels/dispatch) before any of this runs.
+//
+// Build, with this directory as <mxu1>, mipsel cross toolchain:
+//     mipsel-linux-gcc -O2 -march=mips32r2 -I<mxu1> -Wa,-I<mxu1> -c file.c
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_INTRIN_H
+#define MXU1_INTRIN_H
+
+#include <stdint.h>
+
+__asm__(".include \"mxu1_as_macros.s.h\"");
+
+//  Pattern operands, named as the MXU_APTN1_*, MXU_MPTN2_* etc. equivs
+enum { MXU1_A = 0, MXU1_S = 1 };                                  // aptn1
+enum { MXU1_HH = 0, MXU1_LL = 1, MXU1_HL = 2, MXU1_LH = 3 };       // mptn2
+enum { MXU1_AA = 0, MXU1_AS = 1, MXU1_SA = 2, MXU1_SS = 3 };       // aptn2
+enum { MXU1_WW = 0, MXU1_LW = 1, MXU1_HW = 2, MXU1_XW = 3 };       // optn2
+
+////////////////////////////////////////////////////////////////////////////////
+// Operand checks and statement shapes (not for use outside this header)
+////////////////////////////////////////////////////////////////////////////////
+
+//  'v', when a constant in lo..hi; a negative array size (or, not constant,
+// a variable one that no "i" constraint accepts) otherwise
+#define MXU1_FIELD_(v, lo, hi) \
+  ((v) + 0 * (int)sizeof(char[(v) >= (lo) && (v) <= (hi) ? 1 : -1]))
+#define MXU1_F_(v, hi)    MXU1_FIELD_(v, 0, hi)
+#define MXU1_XR_(xr)      MXU1_FIELD_(xr, 0, 15)
+#define MXU1_OFFSET_(v, align, lo, hi) \
+  MXU1_FIELD_(v, (v) & ((align) - 1) ? (hi) + 1 : (lo), hi)
+#define MXU1_OFF8_(imm8)   MXU1_OFFSET_(imm8, 1, -128, 127)
+#define MXU1_OFF10_(imm10) MXU1_OFFSET_(imm10, 2, -512, 511)
+#define MXU1_OFF12_(imm12) MXU1_OFFSET_(imm12, 4, -2048, 2047)
+
+//  What a load reads or a store writes: the object at p + off, or from p on
+typedef uint32_t mxu1_word_ __attribute__((__may_alias__));
+typedef uint16_t mxu1_half_ __attribute__((__may_alias__));
+typedef struct { uint8_t b[0x10000000]; } mxu1_span_;
+#define MXU1_AT_(T, p, off)  (*(T *)((const char *)(p) + (off)))
+#define MXU1_SPAN_(p)        (*(mxu1_span_ *)(p))
+
+#define MXU1_XR3_(op, xra, xrb, xrc) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, xr%c2" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrb)), \
+                          "i"(MXU1_XR_(xrc)))
+#define MXU1_XR3_F1_(op, xra, xrb, xrc, f) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, xr%c2, %c3" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrb)), \
+                          "i"(MXU1_XR_(xrc)), "i"(f))
+#define MXU1_XR4_(op, xra, xrb, xrc, xrd) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, xr%c2, xr%c3" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrb)), \
+                          "i"(MXU1_XR_(xrc)), "i"(MXU1_XR_(xrd)))
+#define MXU1_XR4_F1_(op, xra, xrb, xrc, xrd, f) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, xr%c2, xr%c3, %c4" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrb)), \
+                          "i"(MXU1_XR_(xrc)), "i"(MXU1_XR_(xrd)), "i"(f))
+#define MXU1_XR4_F2_(op, xra, xrb, xrc, xrd, f, g) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, xr%c2, xr%c3, %c4, %c5" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrb)), \
+                          "i"(MXU1_XR_(xrc)), "i"(MXU1_XR_(xrd)), "i"(f), \
+                          "i"(g))
+#define MXU1_XR1_F2_(op, xra, f, g) \
+  __asm__ __volatile__(op " xr%c0, %c1, %c2" \
+                       :: "i"(MXU1_XR_(xra)), "i"(f), "i"(g))
+
+#define MXU1_XR2_RS_(op, xra, xrd, rs) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, %z2" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrd)), \
+                          "rJ"((uint32_t)(rs)))
+#define MXU1_XR2_RS_F1_(op, xra, xrd, rs, f) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, %z2, %c3" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrd)), \
+                          "rJ"((uint32_t)(rs)), "i"(f))
+#define MXU1_XR2_RS_RT_(op, xra, xrd, rs, rt) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, %z2, %z3" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrd)), \
+                          "rJ"((uint32_t)(rs)), "rJ"((uint32_t)(rt)))
+#define MXU1_XR2_RS_RT_HILO_(op, xra, xrd, rs, rt) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, %z2, %z3" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrd)), \
+                          "rJ"((uint32_t)(rs)), "rJ"((uint32_t)(rt)) \
+                       : "hi", "lo")
+#define MXU1_XR3_RS_(op, xra, xrb, xrc, rs) \
+  __asm__ __volatile__(op " xr%c0, xr%c1, xr%c2, %z3" \
+                       :: "i"(MXU1_XR_(xra)), "i"(MXU1_XR_(xrb)), \
+                          "i"(MXU1_XR_(xrc)), "rJ"((uint32_t)(rs)))
+
+#define MXU1_M2I_(xra) \
+  __extension__({ \
+    uint32_t mxu1_rt_; \
+    __asm__ __volatile__("s32m2i xr%c1, %0" \
+                         : "=r"(mxu1_rt_) : "i"(MXU1_FIELD_(xra, 0, 16))); \
+    mxu1_rt_; \
+  })
+#define MXU1_I2M_(xra, rt) \
+  __asm__ __volatile__("s32i2m xr%c0, %z1" \
+                       :: "i"(MXU1_FIELD_(xra, 0, 16)), "rJ"((uint32_t)(rt)))
+
+#define MXU1_LD_(op, T, xra, rs, off) \
+  __asm__ __volatile__(op " xr%c0, %1, %c2" \
+                       :: "i"(MXU1_XR_(xra)), "r"(rs), "i"(off), \
+                          "m"(MXU1_AT_(const T, rs, off)))
+#define MXU1_LD_P_(op, T, xra, rs, off, ptn) \
+  __asm__ __volatile__(op " xr%c0, %1, %c2, %c3" \
+                       :: "i"(MXU1_XR_(xra)), "r"(rs), "i"(off), "i"(ptn), \
+                          "m"(MXU1_AT_(const T, rs, off)))
+#define MXU1_LDI_(op, T, xra, rs, off) \
+  __asm__ __volatile__(op " xr%c1, %0, %c2" \
+                       : "+r"(rs) \
+                       : "i"(MXU1_XR_(xra)), "i"(off), \
+                         "m"(MXU1_AT_(const T, rs, off)))
+#define MXU1_LDI_P_(op, T, xra, rs, off, ptn) \
+  __asm__ __volatile__(op " xr%c1, %0, %c2, %c3" \
+                       : "+r"(rs) \
+                       : "i"(MXU1_XR_(xra)), "i"(off), "i"(ptn), \
+                         "m"(MXU1_AT_(const T, rs, off)))
+#define MXU1_ST_(op, T, xra, rs, off) \
+  __asm__ __volatile__(op " xr%c1, %2, %c3" \
+                       : "=m"(MXU1_AT_(T, rs, off)) \
+                       : "i"(MXU1_XR_(xra)), "r"(rs), "i"(off))
+#define MXU1_ST_P_(op, T, xra, rs, off, ptn) \
+  __asm__ __volatile__(op " xr%c1, %2, %c3, %c4" \
+                       : "=m"(MXU1_AT_(T, rs, off)) \
+                       : "i"(MXU1_XR_(xra)), "r"(rs), "i"(off), "i"(ptn))
+#define MXU1_SDI_(op, T, xra, rs, off) \
+  __asm__ __volatile__(op " xr%c2, %0, %c3" \
+                       : "+r"(rs), "=m"(MXU1_AT_(T, rs, off)) \
+                       : "i"(MXU1_XR_(xra)), "i"(off))
+#define MXU1_SDI_P_(op, T, xra, rs, off, ptn) \
+  __asm__ __volatile__(op " xr%c2, %0, %c3, %c4" \
+                       : "+r"(rs), "=m"(MXU1_AT_(T, rs, off)) \
+                       : "i"(MXU1_XR_(xra)), "i"(off), "i"(ptn))
+
+#define MXU1_LDV_(op, xra, rs, rt, strd2) \
+  __asm__ __volatile__(op " xr%c0, %1, %z2, %c3" \
+                       :: "i"(MXU1_XR_(xra)), "r"(rs), "rJ"((uint32_t)(rt)), \
+                          "i"(strd2), "m"(MXU1_SPAN_(rs)))
+#define MXU1_LDIV_(op, xra, rs, rt, strd2) \
+  __asm__ __volatile__(op " xr%c1, %0, %z2, %c3" \
+                       : "+r"(rs) \
+                       : "i"(MXU1_XR_(xra)), "rJ"((uint32_t)(rt)), \
+                         "i"(strd2), "m"(MXU1_SPAN_(rs)))
+#define MXU1_STV_(op, xra, rs, rt, strd2) \
+  __asm__ __volatile__(op " xr%c1, %2, %z3, %c4" \
+                       : "+m"(MXU1_SPAN_(rs)) \
+                       : "i"(MXU1_XR_(xra)), "r"(rs), "rJ"((uint32_t)(rt)), \
+                         "i"(strd2))
+#define MXU1_SDIV_(op, xra, rs, rt, strd2) \
+  __asm__ __volatile__(op " xr%c2, %0, %z3, %c4" \
+                       : "+r"(rs), "+m"(MXU1_SPAN_(rs)) \
+                       : "i"(MXU1_XR_(xra)), "rJ"((uint32_t)(rt)), \
+                         "i"(strd2))
+
+//  Not volatile: lx* do not touch the MXU, and may be moved or dropped
+#define MXU1_LX_(op, T, rs, rt, strd2) \
+  __extension__({ \
+    T mxu1_rd_; \
+    __asm__(op " %0, %1, %z2, %c3" \
+            : "=r"(mxu1_rd_) \
+            : "r"(rs), "rJ"((uint32_t)(rt)), "i"(strd2), \
+              "m"(MXU1_SPAN_(rs))); \
+    mxu1_rd_; \
+  })
+
+////////////////////////////////////////////////////////////////////////////////
+// Opcodes, in the order of mxu1_as_macros.s.h
+////////////////////////////////////////////////////////////////////////////////
+
+#define mxu1_d16mul(xra, xrb, xrc, xrd, optn2) \
+  MXU1_XR4_F1_("d16mul", xra, xrb, xrc, xrd, MXU1_F_(optn2, 3))
+#define mxu1_d16mulf(xra, xrb, xrc, optn2) \
+  MXU1_XR3_F1_("d16mulf", xra, xrb, xrc, MXU1_F_(optn2, 3))
+#define mxu1_d16mule(xra, xrb, xrc, xrd, optn2) \
+  MXU1_XR4_F1_("d16mule", xra, xrb, xrc, xrd, MXU1_F_(optn2, 3))
+#define mxu1_d16mac(xra, xrb, xrc, xrd, aptn2, optn2) \
+  MXU1_XR4_F2_("d16mac", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3), \
+               MXU1_F_(optn2, 3))
+#define mxu1_d16macf(xra, xrb, xrc, xrd, aptn2, optn2) \
+  MXU1_XR4_F2_("d16macf", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3), \
+               MXU1_F_(optn2, 3))
+#define mxu1_d16madl(xra, xrb, xrc, xrd, aptn2, optn2) \
+  MXU1_XR4_F2_("d16madl", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3), \
+               MXU1_F_(optn2, 3))
+#define mxu1_s16mad(xra, xrb, xrc, xrd, aptn1, mptn2) \
+  MXU1_XR4_F2_("s16mad", xra, xrb, xrc, xrd, MXU1_F_(aptn1, 1), \
+               MXU1_F_(mptn2, 3))
+#define mxu1_q16add(xra, xrb, xrc, xrd, aptn2, optn2) \
+  MXU1_XR4_F2_("q16add", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3), \
+               MXU1_F_(optn2, 3))
+#define mxu1_d16mace(xra, xrb, xrc, xrd, aptn2, optn2) \
+  MXU1_XR4_F2_("d16mace", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3), \
+               MXU1_F_(optn2, 3))
+#define mxu1_q8mul(xra, xrb, xrc, xrd) MXU1_XR4_("q8mul", xra, xrb, xrc, xrd)
+#define mxu1_q8mulsu(xra, xrb, xrc, xrd) \
+  MXU1_XR4_("q8mulsu", xra, xrb, xrc, xrd)
+#define mxu1_q8mac(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("q8mac", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_q8macsu(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("q8macsu", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_q8madl(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("q8madl", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_q8movz(xra, xrb, xrc) MXU1_XR3_("q8movz", xra, xrb, xrc)
+#define mxu1_q8movn(xra, xrb, xrc) MXU1_XR3_("q8movn", xra, xrb, xrc)
+#define mxu1_d16movz(xra, xrb, xrc) MXU1_XR3_("d16movz", xra, xrb, xrc)
+#define mxu1_d16movn(xra, xrb, xrc) MXU1_XR3_("d16movn", xra, xrb, xrc)
+#define mxu1_s32movz(xra, xrb, xrc) MXU1_XR3_("s32movz", xra, xrb, xrc)
+#define mxu1_s32movn(xra, xrb, xrc) MXU1_XR3_("s32movn", xra, xrb, xrc)
+#define mxu1_q16scop(xra, xrb, xrc, xrd) \
+  MXU1_XR4_("q16scop", xra, xrb, xrc, xrd)
+#define mxu1_s32sfl(xra, xrb, xrc, xrd, ptn) \
+  MXU1_XR4_F1_("s32sfl", xra, xrb, xrc, xrd, MXU1_F_(ptn, 3))
+#define mxu1_q8sad(xra, xrb, xrc, xrd) MXU1_XR4_("q8sad", xra, xrb, xrc, xrd)
+#define mxu1_d32add(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("d32add", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_d32addc(xra, xrb, xrc, xrd) \
+  MXU1_XR4_("d32addc", xra, xrb, xrc, xrd)
+#define mxu1_d32acc(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("d32acc", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_d32accm(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("d32accm", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_d32asum(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("d32asum", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_q16acc(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("q16acc", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_q16accm(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("q16accm", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_d16asum(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("d16asum", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_q8adde(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("q8adde", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_d8sum(xra, xrb, xrc) MXU1_XR3_("d8sum", xra, xrb, xrc)
+#define mxu1_d8sumc(xra, xrb, xrc) MXU1_XR3_("d8sumc", xra, xrb, xrc)
+#define mxu1_q8acce(xra, xrb, xrc, xrd, aptn2) \
+  MXU1_XR4_F1_("q8acce", xra, xrb, xrc, xrd, MXU1_F_(aptn2, 3))
+#define mxu1_s32cps(xra, xrb, xrc) MXU1_XR3_("s32cps", xra, xrb, xrc)
+#define mxu1_d16cps(xra, xrb, xrc) MXU1_XR3_("d16cps", xra, xrb, xrc)
+#define mxu1_q8abd(xra, xrb, xrc) MXU1_XR3_("q8abd", xra, xrb, xrc)
+#define mxu1_q16sat(xra, xrb, xrc) MXU1_XR3_("q16sat", xra, xrb, xrc)
+#define mxu1_s32slt(xra, xrb, xrc) MXU1_XR3_("s32slt", xra, xrb, xrc)
+#define mxu1_d16slt(xra, xrb, xrc) MXU1_XR3_("d16slt", xra, xrb, xrc)
+#define mxu1_d16avg(xra, xrb, xrc) MXU1_XR3_("d16avg", xra, xrb, xrc)
+#define mxu1_d16avgr(xra, xrb, xrc) MXU1_XR3_("d16avgr", xra, xrb, xrc)
+#define mxu1_q8avg(xra, xrb, xrc) MXU1_XR3_("q8avg", xra, xrb, xrc)
+#define mxu1_q8avgr(xra, xrb, xrc) MXU1_XR3_("q8avgr", xra, xrb, xrc)
+#define mxu1_q8add(xra, xrb, xrc, aptn2) \
+  MXU1_XR3_F1_("q8add", xra, xrb, xrc, MXU1_F_(aptn2, 3))
+#define mxu1_s32max(xra, xrb, xrc) MXU1_XR3_("s32max", xra, xrb, xrc)
+#define mxu1_s32min(xra, xrb, xrc) MXU1_XR3_("s32min", xra, xrb, xrc)
+#define mxu1_d16max(xra, xrb, xrc) MXU1_XR3_("d16max", xra, xrb, xrc)
+#define mxu1_d16min(xra, xrb, xrc) MXU1_XR3_("d16min", xra, xrb, xrc)
+#define mxu1_q8max(xra, xrb, xrc) MXU1_XR3_("q8max", xra, xrb, xrc)
+#define mxu1_q8min(xra, xrb, xrc) MXU1_XR3_("q8min", xra, xrb, xrc)
+#define mxu1_q8slt(xra, xrb, xrc) MXU1_XR3_("q8slt", xra, xrb, xrc)
+#define mxu1_q8sltu(xra, xrb, xrc) MXU1_XR3_("q8sltu", xra, xrb, xrc)
+#define mxu1_d32sll(xra, xrb, xrc, xrd, sft4) \
+  MXU1_XR4_F1_("d32sll", xra, xrb, xrc, xrd, MXU1_F_(sft4, 15))
+#define mxu1_d32slr(xra, xrb, xrc, xrd, sft4) \
+  MXU1_XR4_F1_("d32slr", xra, xrb, xrc, xrd, MXU1_F_(sft4, 15))
+#define mxu1_d32sarl(xra, xrb, xrc, sft4) \
+  MXU1_XR3_F1_("d32sarl", xra, xrb, xrc, MXU1_F_(sft4, 15))
+#define mxu1_d32sar(xra, xrb, xrc, xrd, sft4) \
+  MXU1_XR4_F1_("d32sar", xra, xrb, xrc, xrd, MXU1_F_(sft4, 15))
+#define mxu1_q16sll(xra, xrb, xrc, xrd, sft4) \
+  MXU1_XR4_F1_("q16sll", xra, xrb, xrc, xrd, MXU1_F_(sft4, 15))
+#define mxu1_q16slr(xra, xrb, xrc, xrd, sft4) \
+  MXU1_XR4_F1_("q16slr", xra, xrb, xrc, xrd, MXU1_F_(sft4, 15))
+#define mxu1_q16sar(xra, xrb, xrc, xrd, sft4) \
+  MXU1_XR4_F1_("q16sar", xra, xrb, xrc, xrd, MXU1_F_(sft4, 15))
+
+//  GPR operands: shift amounts, multiplicands, alignments
+#define mxu1_d32sllv(xra, xrd, rs) MXU1_XR2_RS_("d32sllv", xra, xrd, rs)
+#define mxu1_d32slrv(xra, xrd, rs) MXU1_XR2_RS_("d32slrv", xra, xrd, rs)
+#define mxu1_d32sarv(xra, xrd, rs) MXU1_XR2_RS_("d32sarv", xra, xrd, rs)
+#define mxu1_q16sllv(xra, xrd, rs) MXU1_XR2_RS_("q16sllv", xra, xrd, rs)
+#define mxu1_q16slrv(xra, xrd, rs) MXU1_XR2_RS_("q16slrv", xra, xrd, rs)
+#define mxu1_q16sarv(xra, xrd, rs) MXU1_XR2_RS_("q16sarv", xra, xrd, rs)
+#define mxu1_s32madd(xra, xrd, rs, rt) \
+  MXU1_XR2_RS_RT_HILO_("s32madd", xra, xrd, rs, rt)
+#define mxu1_s32maddu(xra, xrd, rs, rt) \
+  MXU1_XR2_RS_RT_HILO_("s32maddu", xra, xrd, rs, rt)
+#define mxu1_s32msub(xra, xrd, rs, rt) \
+  MXU1_XR2_RS_RT_HILO_("s32msub", xra, xrd, rs, rt)
+#define mxu1_s32msubu(xra, xrd, rs, rt) \
+  MXU1_XR2_RS_RT_HILO_("s32msubu", xra, xrd, rs, rt)
+#define mxu1_s32mul(xra, xrd, rs, rt) \
+  MXU1_XR2_RS_RT_HILO_("s32mul", xra, xrd, rs, rt)
+#define mxu1_s32mulu(xra, xrd, rs, rt) \
+  MXU1_XR2_RS_RT_HILO_("s32mulu", xra, xrd, rs, rt)
+#define mxu1_s32extr(xra, xrd, rs, bits5) \
+  MXU1_XR2_RS_F1_("s32extr", xra, xrd, rs, MXU1_FIELD_(bits5, 1, 31))
+#define mxu1_s32extrv(xra, xrd, rs, rt) \
+  MXU1_XR2_RS_RT_("s32extrv", xra, xrd, rs, rt)
+#define mxu1_d32sarw(xra, xrb, xrc, rs) \
+  MXU1_XR3_RS_("d32sarw", xra, xrb, xrc, rs)
+#define mxu1_s32aln(xra, xrb, xrc, rs) MXU1_XR3_RS_("s32aln", xra, xrb, xrc, rs)
+#define mxu1_s32alni(xra, xrb, xrc, ptn) \
+  MXU1_XR3_F1_("s32alni", xra, xrb, xrc, MXU1_F_(ptn, 4))
+#define mxu1_s32lui(xra, imm8, ptn) \
+  MXU1_XR1_F2_("s32lui", xra, MXU1_FIELD_(imm8, -128, 255), MXU1_F_(ptn, 7))
+#define mxu1_s32nor(xra, xrb, xrc) MXU1_XR3_("s32nor", xra, xrb, xrc)
+#define mxu1_s32and(xra, xrb, xrc) MXU1_XR3_("s32and", xra, xrb, xrc)
+#define mxu1_s32or(xra, xrb, xrc) MXU1_XR3_("s32or", xra, xrb, xrc)
+#define mxu1_s32xor(xra, xrb, xrc) MXU1_XR3_("s32xor", xra, xrb, xrc)
+
+////////////////////////////////////////////////////////////////////////////////
+// Transfers between GPRs and xr registers
+////////////////////////////////////////////////////////////////////////////////
+
+#define mxu1_s32m2i(xra) MXU1_M2I_(xra)
+#define mxu1_s32i2m(xra, rt) MXU1_I2M_(xra, rt)
+
+////////////////////////////////////////////////////////////////////////////////
+// Loads and stores
+////////////////////////////////////////////////////////////////////////////////
+
+#define mxu1_s32lddv(xra, rs, rt, strd2) \
+  MXU1_LDV_("s32lddv", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32lddvr(xra, rs, rt, strd2) \
+  MXU1_LDV_("s32lddvr", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32stdv(xra, rs, rt, strd2) \
+  MXU1_STV_("s32stdv", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32stdvr(xra, rs, rt, strd2) \
+  MXU1_STV_("s32stdvr", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32ldiv(xra, rs, rt, strd2) \
+  MXU1_LDIV_("s32ldiv", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32ldivr(xra, rs, rt, strd2) \
+  MXU1_LDIV_("s32ldivr", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32sdiv(xra, rs, rt, strd2) \
+  MXU1_SDIV_("s32sdiv", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32sdivr(xra, rs, rt, strd2) \
+  MXU1_SDIV_("s32sdivr", xra, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_s32ldd(xra, rs, imm12) \
+  MXU1_LD_("s32ldd", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s32lddr(xra, rs, imm12) \
+  MXU1_LD_("s32lddr", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s32std(xra, rs, imm12) \
+  MXU1_ST_("s32std", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s32stdr(xra, rs, imm12) \
+  MXU1_ST_("s32stdr", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s32ldi(xra, rs, imm12) \
+  MXU1_LDI_("s32ldi", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s32ldir(xra, rs, imm12) \
+  MXU1_LDI_("s32ldir", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s32sdi(xra, rs, imm12) \
+  MXU1_SDI_("s32sdi", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s32sdir(xra, rs, imm12) \
+  MXU1_SDI_("s32sdir", mxu1_word_, xra, rs, MXU1_OFF12_(imm12))
+#define mxu1_s8ldd(xra, rs, imm8, ptn) \
+  MXU1_LD_P_("s8ldd", uint8_t, xra, rs, MXU1_OFF8_(imm8), MXU1_F_(ptn, 7))
+#define mxu1_s8std(xra, rs, imm8, ptn) \
+  MXU1_ST_P_("s8std", uint8_t, xra, rs, MXU1_OFF8_(imm8), MXU1_F_(ptn, 3))
+#define mxu1_s8ldi(xra, rs, imm8, ptn) \
+  MXU1_LDI_P_("s8ldi", uint8_t, xra, rs, MXU1_OFF8_(imm8), MXU1_F_(ptn, 7))
+#define mxu1_s8sdi(xra, rs, imm8, ptn) \
+  MXU1_SDI_P_("s8sdi", uint8_t, xra, rs, MXU1_OFF8_(imm8), MXU1_F_(ptn, 3))
+#define mxu1_s16ldd(xra, rs, imm10, ptn) \
+  MXU1_LD_P_("s16ldd", mxu1_half_, xra, rs, MXU1_OFF10_(imm10), MXU1_F_(ptn, 3))
+#define mxu1_s16std(xra, rs, imm10, ptn) \
+  MXU1_ST_P_("s16std", mxu1_half_, xra, rs, MXU1_OFF10_(imm10), MXU1_F_(ptn, 1))
+#define mxu1_s16ldi(xra, rs, imm10, ptn) \
+  MXU1_LDI_P_("s16ldi", mxu1_half_, xra, rs, MXU1_OFF10_(imm10), \
+              MXU1_F_(ptn, 3))
+#define mxu1_s16sdi(xra, rs, imm10, ptn) \
+  MXU1_SDI_P_("s16sdi", mxu1_half_, xra, rs, MXU1_OFF10_(imm10), \
+              MXU1_F_(ptn, 1))
+
+//  Indexed GPR loads: return what they load
+#define mxu1_lxw(rs, rt, strd2) \
+  MXU1_LX_("lxw", uint32_t, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_lxh(rs, rt, strd2) \
+  MXU1_LX_("lxh", int32_t, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_lxhu(rs, rt, strd2) \
+  MXU1_LX_("lxhu", uint32_t, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_lxb(rs, rt, strd2) \
+  MXU1_LX_("lxb", int32_t, rs, rt, MXU1_F_(strd2, 2))
+#define mxu1_lxbu(rs, rt, strd2) \
+  MXU1_LX_("lxbu", uint32_t, rs, rt, MXU1_F_(strd2, 2))
+
+#ifdef __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// C++: the same statements as function templates
+////////////////////////////////////////////////////////////////////////////////
+
+//  Constant operands are the template arguments, in the macro's order, GPR
+// operands the function arguments; a pointer type is deduced, and a base
+// pointer the _i_ forms advance is taken by reference
+namespace mxu1 {
+namespace intrin {
+
+template <int xra, int xrb, int xrc, int xrd, int optn2>
+inline void d16mul() { mxu1_d16mul(xra, xrb, xrc, xrd, optn2); }
+template <int xra, int xrb, int xrc, int optn2>
+inline void d16mulf() { mxu1_d16mulf(xra, xrb, xrc, optn2); }
+template <int xra, int xrb, int xrc, int xrd, int optn2>
+inline void d16mule() { mxu1_d16mule(xra, xrb, xrc, xrd, optn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2, int optn2>
+inline void d16mac() { mxu1_d16mac(xra, xrb, xrc, xrd, aptn2, optn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2, int optn2>
+inline void d16macf() { mxu1_d16macf(xra, xrb, xrc, xrd, aptn2, optn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2, int optn2>
+inline void d16madl() { mxu1_d16madl(xra, xrb, xrc, xrd, aptn2, optn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn1, int mptn2>
+inline void s16mad() { mxu1_s16mad(xra, xrb, xrc, xrd, aptn1, mptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2, int optn2>
+inline void q16add() { mxu1_q16add(xra, xrb, xrc, xrd, aptn2, optn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2, int optn2>
+inline void d16mace() { mxu1_d16mace(xra, xrb, xrc, xrd, aptn2, optn2); }
+template <int xra, int xrb, int xrc, int xrd>
+inline void q8mul() { mxu1_q8mul(xra, xrb, xrc, xrd); }
+template <int xra, int xrb, int xrc, int xrd>
+inline void q8mulsu() { mxu1_q8mulsu(xra, xrb, xrc, xrd); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void q8mac() { mxu1_q8mac(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void q8macsu() { mxu1_q8macsu(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void q8madl() { mxu1_q8madl(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc>
+inline void q8movz() { mxu1_q8movz(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8movn() { mxu1_q8movn(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16movz() { mxu1_d16movz(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16movn() { mxu1_d16movn(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void s32movz() { mxu1_s32movz(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void s32movn() { mxu1_s32movn(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc, int xrd>
+inline void q16scop() { mxu1_q16scop(xra, xrb, xrc, xrd); }
+template <int xra, int xrb, int xrc, int xrd, int ptn>
+inline void s32sfl() { mxu1_s32sfl(xra, xrb, xrc, xrd, ptn); }
+template <int xra, int xrb, int xrc, int xrd>
+inline void q8sad() { mxu1_q8sad(xra, xrb, xrc, xrd); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void d32add() { mxu1_d32add(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd>
+inline void d32addc() { mxu1_d32addc(xra, xrb, xrc, xrd); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void d32acc() { mxu1_d32acc(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void d32accm() { mxu1_d32accm(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void d32asum() { mxu1_d32asum(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void q16acc() { mxu1_q16acc(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void q16accm() { mxu1_q16accm(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void d16asum() { mxu1_d16asum(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void q8adde() { mxu1_q8adde(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc>
+inline void d8sum() { mxu1_d8sum(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d8sumc() { mxu1_d8sumc(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc, int xrd, int aptn2>
+inline void q8acce() { mxu1_q8acce(xra, xrb, xrc, xrd, aptn2); }
+template <int xra, int xrb, int xrc>
+inline void s32cps() { mxu1_s32cps(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16cps() { mxu1_d16cps(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8abd() { mxu1_q8abd(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q16sat() { mxu1_q16sat(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void s32slt() { mxu1_s32slt(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16slt() { mxu1_d16slt(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16avg() { mxu1_d16avg(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16avgr() { mxu1_d16avgr(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8avg() { mxu1_q8avg(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8avgr() { mxu1_q8avgr(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc, int aptn2>
+inline void q8add() { mxu1_q8add(xra, xrb, xrc, aptn2); }
+template <int xra, int xrb, int xrc>
+inline void s32max() { mxu1_s32max(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void s32min() { mxu1_s32min(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16max() { mxu1_d16max(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void d16min() { mxu1_d16min(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8max() { mxu1_q8max(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8min() { mxu1_q8min(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8slt() { mxu1_q8slt(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void q8sltu() { mxu1_q8sltu(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc, int xrd, int sft4>
+inline void d32sll() { mxu1_d32sll(xra, xrb, xrc, xrd, sft4); }
+template <int xra, int xrb, int xrc, int xrd, int sft4>
+inline void d32slr() { mxu1_d32slr(xra, xrb, xrc, xrd, sft4); }
+template <int xra, int xrb, int xrc, int sft4>
+inline void d32sarl() { mxu1_d32sarl(xra, xrb, xrc, sft4); }
+template <int xra, int xrb, int xrc, int xrd, int sft4>
+inline void d32sar() { mxu1_d32sar(xra, xrb, xrc, xrd, sft4); }
+template <int xra, int xrb, int xrc, int xrd, int sft4>
+inline void q16sll() { mxu1_q16sll(xra, xrb, xrc, xrd, sft4); }
+template <int xra, int xrb, int xrc, int xrd, int sft4>
+inline void q16slr() { mxu1_q16slr(xra, xrb, xrc, xrd, sft4); }
+template <int xra, int xrb, int xrc, int xrd, int sft4>
+inline void q16sar() { mxu1_q16sar(xra, xrb, xrc, xrd, sft4); }
+template <int xra, int xrd>
+inline void d32sllv(uint32_t rs) { mxu1_d32sllv(xra, xrd, rs); }
+template <int xra, int xrd>
+inline void d32slrv(uint32_t rs) { mxu1_d32slrv(xra, xrd, rs); }
+template <int xra, int xrd>
+inline void d32sarv(uint32_t rs) { mxu1_d32sarv(xra, xrd, rs); }
+template <int xra, int xrd>
+inline void q16sllv(uint32_t rs) { mxu1_q16sllv(xra, xrd, rs); }
+template <int xra, int xrd>
+inline void q16slrv(uint32_t rs) { mxu1_q16slrv(xra, xrd, rs); }
+template <int xra, int xrd>
+inline void q16sarv(uint32_t rs) { mxu1_q16sarv(xra, xrd, rs); }
+template <int xra, int xrd>
+inline void s32madd(uint32_t rs, uint32_t rt)
+{ mxu1_s32madd(xra, xrd, rs, rt); }
+template <int xra, int xrd>
+inline void s32maddu(uint32_t rs, uint32_t rt)
+{ mxu1_s32maddu(xra, xrd, rs, rt); }
+template <int xra, int xrd>
+inline void s32msub(uint32_t rs, uint32_t rt)
+{ mxu1_s32msub(xra, xrd, rs, rt); }
+template <int xra, int xrd>
+inline void s32msubu(uint32_t rs, uint32_t rt)
+{ mxu1_s32msubu(xra, xrd, rs, rt); }
+template <int xra, int xrd>
+inline void s32mul(uint32_t rs, uint32_t rt) { mxu1_s32mul(xra, xrd, rs, rt); }
+template <int xra, int xrd>
+inline void s32mulu(uint32_t rs, uint32_t rt)
+{ mxu1_s32mulu(xra, xrd, rs, rt); }
+template <int xra, int xrd, int bits5>
+inline void s32extr(uint32_t rs) { mxu1_s32extr(xra, xrd, rs, bits5); }
+template <int xra, int xrd>
+inline void s32extrv(uint32_t rs, uint32_t rt)
+{ mxu1_s32extrv(xra, xrd, rs, rt); }
+template <int xra, int xrb, int xrc>
+inline void d32sarw(uint32_t rs) { mxu1_d32sarw(xra, xrb, xrc, rs); }
+template <int xra, int xrb, int xrc>
+inline void s32aln(uint32_t rs) { mxu1_s32aln(xra, xrb, xrc, rs); }
+template <int xra, int xrb, int xrc, int ptn>
+inline void s32alni() { mxu1_s32alni(xra, xrb, xrc, ptn); }
+template <int xra, int imm8, int ptn>
+inline void s32lui() { mxu1_s32lui(xra, imm8, ptn); }
+template <int xra, int xrb, int xrc>
+inline void s32nor() { mxu1_s32nor(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void s32and() { mxu1_s32and(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void s32or() { mxu1_s32or(xra, xrb, xrc); }
+template <int xra, int xrb, int xrc>
+inline void s32xor() { mxu1_s32xor(xra, xrb, xrc); }
+template <int xra>
+inline uint32_t s32m2i() { return mxu1_s32m2i(xra); }
+template <int xra>
+inline void s32i2m(uint32_t rt) { mxu1_s32i2m(xra, rt); }
+template <int xra, int strd2, class P>
+inline void s32lddv(P *rs, uint32_t rt) { mxu1_s32lddv(xra, rs, rt, strd2); }
+template <int xra, int strd2, class P>
+inline void s32lddvr(P *rs, uint32_t rt) { mxu1_s32lddvr(xra, rs, rt, strd2); }
+template <int xra, int strd2, class P>
+inline void s32stdv(P *rs, uint32_t rt) { mxu1_s32stdv(xra, rs, rt, strd2); }
+template <int xra, int strd2, class P>
+inline void s32stdvr(P *rs, uint32_t rt) { mxu1_s32stdvr(xra, rs, rt, strd2); }
+template <int xra, int strd2, class P>
+inline void s32ldiv(P *&rs, uint32_t rt) { mxu1_s32ldiv(xra, rs, rt, strd2); }
+template <int xra, int strd2, class P>
+inline void s32ldivr(P *&rs, uint32_t rt) { mxu1_s32ldivr(xra, rs, rt, strd2); }
+template <int xra, int strd2, class P>
+inline void s32sdiv(P *&rs, uint32_t rt) { mxu1_s32sdiv(xra, rs, rt, strd2); }
+template <int xra, int strd2, class P>
+inline void s32sdivr(P *&rs, uint32_t rt) { mxu1_s32sdivr(xra, rs, rt, strd2); }
+template <int xra, int imm12, class P>
+inline void s32ldd(P *rs) { mxu1_s32ldd(xra, rs, imm12); }
+template <int xra, int imm12, class P>
+inline void s32lddr(P *rs) { mxu1_s32lddr(xra, rs, imm12); }
+template <int xra, int imm12, class P>
+inline void s32std(P *rs) { mxu1_s32std(xra, rs, imm12); }
+template <int xra, int imm12, class P>
+inline void s32stdr(P *rs) { mxu1_s32stdr(xra, rs, imm12); }
+template <int xra, int imm12, class P>
+inline void s32ldi(P *&rs) { mxu1_s32ldi(xra, rs, imm12); }
+template <int xra, int imm12, class P>
+inline void s32ldir(P *&rs) { mxu1_s32ldir(xra, rs, imm12); }
+template <int xra, int imm12, class P>
+inline void s32sdi(P *&rs) { mxu1_s32sdi(xra, rs, imm12); }
+template <int xra, int imm12, class P>
+inline void s32sdir(P *&rs) { mxu1_s32sdir(xra, rs, imm12); }
+template <int xra, int imm8, int ptn, class P>
+inline void s8ldd(P *rs) { mxu1_s8ldd(xra, rs, imm8, ptn); }
+template <int xra, int imm8, int ptn, class P>
+inline void s8std(P *rs) { mxu1_s8std(xra, rs, imm8, ptn); }
+template <int xra, int imm8, int ptn, class P>
+inline void s8ldi(P *&rs) { mxu1_s8ldi(xra, rs, imm8, ptn); }
+template <int xra, int imm8, int ptn, class P>
+inline void s8sdi(P *&rs) { mxu1_s8sdi(xra, rs, imm8, ptn); }
+template <int xra, int imm10, int ptn, class P>
+inline void s16ldd(P *rs) { mxu1_s16ldd(xra, rs, imm10, ptn); }
+template <int xra, int imm10, int ptn, class P>
+inline void s16std(P *rs) { mxu1_s16std(xra, rs, imm10, ptn); }
+template <int xra, int imm10, int ptn, class P>
+inline void s16ldi(P *&rs) { mxu1_s16ldi(xra, rs, imm10, ptn); }
+template <int xra, int imm10, int ptn, class P>
+inline void s16sdi(P *&rs) { mxu1_s16sdi(xra, rs, imm10, ptn); }
+template <int strd2, class P>
+inline uint32_t lxw(P *rs, uint32_t rt) { return mxu1_lxw(rs, rt, strd2); }
+template <int strd2, class P>
+inline int32_t lxh(P *rs, uint32_t rt) { return mxu1_lxh(rs, rt, strd2); }
+template <int strd2, class P>
+inline uint32_t lxhu(P *rs, uint32_t rt) { return mxu1_lxhu(rs, rt, strd2); }
+template <int strd2, class P>
+inline int32_t lxb(P *rs, uint32_t rt) { return mxu1_lxb(rs, rt, strd2); }
+template <int strd2, class P>
+inline uint32_t lxbu(P *rs, uint32_t rt) { return mxu1_lxbu(rs, rt, strd2); }
+
+} // namespace intrin
+} // namespace mxu1
+
+#endif // __cplusplus
+
+#endif // MXU1_INTRIN_H
@@ -0,0 +1,478 @@
+// mxu1_isa.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 instruction table for host-side C++ tools
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  This is the one place outside of mxu1_as_macros.s.h where MXU1 encodings
+// are spelled out. Each MXU1_OPCODES() entry carries the exact base '.word'
+// constant of the matching GAS macro, plus the operand layout that macro ORs
+// into it. Everything else (decoding, encoding, naming) is derived from that,
+// so a table entry and its macro must always be changed together.
+//
+// Operand order of every format below is the macro's own operand order.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_ISA_HPP
+#define MXU1_ISA_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mxu1 {
+
+// Operand layouts. Field positions are those used by the GAS macros.
+enum class Fmt : uint8_t {
+  XA_XB_XC_XD_OPTN2,        // optn2@22 xrd@18 xrc@14 xrb@10 xra@6
+  XA_XB_XC_OPTN2,           // optn2@22        xrc@14 xrb@10 xra@6
+  XA_XB_XC_XD_APTN2_OPTN2,  // aptn2@24 optn2@22 xrd@18 xrc@14 xrb@10 xra@6
+  XA_XB_XC_XD_APTN1_MPTN2,  // aptn1@24 mptn2@22 xrd@18 xrc@14 xrb@10 xra@6
+  XA_XB_XC_XD,              // xrd@18 xrc@14 xrb@10 xra@6
+  XA_XB_XC_XD_APTN2,        // aptn2@24 xrd@18 xrc@14 xrb@10 xra@6
+  XA_XB_XC,                 // xrc@14 xrb@10 xra@6
+  XA_XB_XC_XD_PTN,          // ptn@24 (2 bits) xrd@18 xrc@14 xrb@10 xra@6
+  XA_XB_XC_APTN2,           // aptn2@24 xrc@14 xrb@10 xra@6
+  XA_XB_XC_XD_SFT4,         // sft4@22 xrd@18 xrc@14 xrb@10 xra@6
+  XA_XB_XC_SFT4,            // sft4@22 xrc@14 xrb@10 xra@6
+  XA_XD_RS,                 // rs@21 xrd@14 xra@10
+  XA_XD_RS_RT,              // rs@21 rt@16 xrd@10 xra@6
+  XA_XD_RS_BITS5,           // rs@21 bits5@16 xrd@10 xra@6
+  XA_XB_XC_RS,              // rs@21 xrc@14 xrb@10 xra@6
+  XA_XB_XC_PTN,             // ptn@23 (3 bits) xrc@14 xrb@10 xra@6
+  XA_IMM8_PTN,              // ptn@23 (3 bits) imm8@10 xra@6
+  XA16_RT,                  // rt@16 xra@6 (5 bits, xr0..xr16)
+  XA_RS_RT_STRD2,           // rs@21 rt@16 strd2@14 xra@6
+  XA_RS_S12,                // rs@21 s12[11:2]@10 xra@6
+  XA_RS_S8_PTN,             // rs@21 ptn@18 (3 bits) s8@10 xra@6
+  XA_RS_S10_PTN,            // rs@21 ptn@19 (2 bits) s10[9:1]@10 xra@6
+  RD_RS_RT_STRD2,           // rs@21 rt@16 rd@11 strd2@9
+};
+
+// X(name, base .word, operand format, highest legal ptn)
+#define MXU1_OPCODES(X) \
+  X(d16mul,    0x70000008, XA_XB_XC_XD_OPTN2,       0) \
+  X(d16mulf,   0x70000009, XA_XB_XC_OPTN2,          0) \
+  X(d16mule,   0x71000009, XA_XB_XC_XD_OPTN2,       0) \
+  X(d16mac,    0x7000000a, XA_XB_XC_XD_APTN2_OPTN2, 0) \
+  X(d16macf,   0x7000000b, XA_XB_XC_XD_APTN2_OPTN2, 0) \
+  X(d16madl,   0x7000000c, XA_XB_XC_XD_APTN2_OPTN2, 0) \
+  X(s16mad,    0x7000000d, XA_XB_XC_XD_APTN1_MPTN2, 0) \
+  X(q16add,    0x7000000e, XA_XB_XC_XD_APTN2_OPTN2, 0) \
+  X(d16mace,   0x7000000f, XA_XB_XC_XD_APTN2_OPTN2, 0) \
+  X(q8mul,     0x70000038, XA_XB_XC_XD,             0) \
+  X(q8mulsu,   0x70800038, XA_XB_XC_XD,             0) \
+  X(q8mac,     0x7000003a, XA_XB_XC_XD_APTN2,       0) \
+  X(q8macsu,   0x7080003a, XA_XB_XC_XD_APTN2,       0) \
+  X(q8madl,    0x7000003c, XA_XB_XC_XD_APTN2,       0) \
+  X(q8movz,    0x70000039, XA_XB_XC,                0) \
+  X(q8movn,    0x70040039, XA_XB_XC,                0) \
+  X(d16movz,   0x70080039, XA_XB_XC,                0) \
+  X(d16movn,   0x700c0039, XA_XB_XC,                0) \
+  X(s32movz,   0x70100039, XA_XB_XC,                0) \
+  X(s32movn,   0x70140039, XA_XB_XC,                0) \
+  X(q16scop,   0x7000003b, XA_XB_XC_XD,             0) \
+  X(s32sfl,    0x7000003d, XA_XB_XC_XD_PTN,         3) \
+  X(q8sad,     0x7000003e, XA_XB_XC_XD,             0) \
+  X(d32add,    0x70000018, XA_XB_XC_XD_APTN2,       0) \
+  X(d32addc,   0x70400018, XA_XB_XC_XD,             0) \
+  X(d32acc,    0x70000019, XA_XB_XC_XD_APTN2,       0) \
+  X(d32accm,   0x70400019, XA_XB_XC_XD_APTN2,       0) \
+  X(d32asum,   0x70800019, XA_XB_XC_XD_APTN2,       0) \
+  X(q16acc,    0x7000001b, XA_XB_XC_XD_APTN2,       0) \
+  X(q16accm,   0x7040001b, XA_XB_XC_XD_APTN2,       0) \
+  X(d16asum,   0x7080001b, XA_XB_XC_XD_APTN2,       0) \
+  X(q8adde,    0x7000001c, XA_XB_XC_XD_APTN2,       0) \
+  X(d8sum,     0x7040001c, XA_XB_XC,                0) \
+  X(d8sumc,    0x7080001c, XA_XB_XC,                0) \
+  X(q8acce,    0x7000001d, XA_XB_XC_XD_APTN2,       0) \
+  X(s32cps,    0x70000007, XA_XB_XC,                0) \
+  X(d16cps,    0x70080007, XA_XB_XC,                0) \
+  X(q8abd,     0x70100007, XA_XB_XC,                0) \
+  X(q16sat,    0x70180007, XA_XB_XC,                0) \
+  X(s32slt,    0x70000006, XA_XB_XC,                0) \
+  X(d16slt,    0x70040006, XA_XB_XC,                0) \
+  X(d16avg,    0x70080006, XA_XB_XC,                0) \
+  X(d16avgr,   0x700c0006, XA_XB_XC,                0) \
+  X(q8avg,     0x70100006, XA_XB_XC,                0) \
+  X(q8avgr,    0x70140006, XA_XB_XC,                0) \
+  X(q8add,     0x701c0006, XA_XB_XC_APTN2,          0) \
+  X(s32max,    0x70000003, XA_XB_XC,                0) \
+  X(s32min,    0x70040003, XA_XB_XC,                0) \
+  X(d16max,    0x70080003, XA_XB_XC,                0) \
+  X(d16min,    0x700c0003, XA_XB_XC,                0) \
+  X(q8max,     0x70100003, XA_XB_XC,                0) \
+  X(q8min,     0x70140003, XA_XB_XC,                0) \
+  X(q8slt,     0x70180003, XA_XB_XC,                0) \
+  X(q8sltu,    0x701c0003, XA_XB_XC,                0) \
+  X(d32sll,    0x70000030, XA_XB_XC_XD_SFT4,        0) \
+  X(d32slr,    0x70000031, XA_XB_XC_XD_SFT4,        0) \
+  X(d32sarl,   0x70000032, XA_XB_XC_SFT4,           0) \
+  X(d32sar,    0x70000033, XA_XB_XC_XD_SFT4,        0) \
+  X(q16sll,    0x70000034, XA_XB_XC_XD_SFT4,        0) \
+  X(q16slr,    0x70000035, XA_XB_XC_XD_SFT4,        0) \
+  X(q16sar,    0x70000037, XA_XB_XC_XD_SFT4,        0) \
+  X(d32sllv,   0x70000036, XA_XD_RS,                0) \
+  X(d32slrv,   0x70040036, XA_XD_RS,                0) \
+  X(d32sarv,   0x700c0036, XA_XD_RS,                0) \
+  X(q16sllv,   0x70100036, XA_XD_RS,                0) \
+  X(q16slrv,   0x70140036, XA_XD_RS,                0) \
+  X(q16sarv,   0x701c0036, XA_XD_RS,                0) \
+  X(s32madd,   0x70008000, XA_XD_RS_RT,             0) \
+  X(s32maddu,  0x70008001, XA_XD_RS_RT,             0) \
+  X(s32msub,   0x70008004, XA_XD_RS_RT,             0) \
+  X(s32msubu,  0x70008005, XA_XD_RS_RT,             0) \
+  X(s32mul,    0x70000026, XA_XD_RS_RT,             0) \
+  X(s32mulu,   0x70004026, XA_XD_RS_RT,             0) \
+  X(s32extr,   0x70008026, XA_XD_RS_BITS5,          0) \
+  X(s32extrv,  0x7000c026, XA_XD_RS_RT,             0) \
+  X(d32sarw,   0x70000027, XA_XB_XC_RS,             0) \
+  X(s32aln,    0x70040027, XA_XB_XC_RS,             0) \
+  X(s32alni,   0x70080027, XA_XB_XC_PTN,            4) \
+  X(s32lui,    0x700c0027, XA_IMM8_PTN,             7) \
+  X(s32nor,    0x70100027, XA_XB_XC,                0) \
+  X(s32and,    0x70140027, XA_XB_XC,                0) \
+  X(s32or,     0x70180027, XA_XB_XC,                0) \
+  X(s32xor,    0x701c0027, XA_XB_XC,                0) \
+  X(s32m2i,    0x7000002e, XA16_RT,                 0) \
+  X(s32i2m,    0x7000002f, XA16_RT,                 0) \
+  X(s32lddv,   0x70000012, XA_RS_RT_STRD2,          0) \
+  X(s32lddvr,  0x70000412, XA_RS_RT_STRD2,          0) \
+  X(s32stdv,   0x70000013, XA_RS_RT_STRD2,          0) \
+  X(s32stdvr,  0x70000413, XA_RS_RT_STRD2,          0) \
+  X(s32ldiv,   0x70000016, XA_RS_RT_STRD2,          0) \
+  X(s32ldivr,  0x70000416, XA_RS_RT_STRD2,          0) \
+  X(s32sdiv,   0x70000017, XA_RS_RT_STRD2,          0) \
+  X(s32sdivr,  0x70000417, XA_RS_RT_STRD2,          0) \
+  X(s32ldd,    0x70000010, XA_RS_S12,               0) \
+  X(s32lddr,   0x70100010, XA_RS_S12,               0) \
+  X(s32std,    0x70000011, XA_RS_S12,               0) \
+  X(s32stdr,   0x70100011, XA_RS_S12,               0) \
+  X(s32ldi,    0x70000014, XA_RS_S12,               0) \
+  X(s32ldir,   0x70100014, XA_RS_S12,               0) \
+  X(s32sdi,    0x70000015, XA_RS_S12,               0) \
+  X(s32sdir,   0x70100015, XA_RS_S12,               0) \
+  X(s8ldd,     0x70000022, XA_RS_S8_PTN,            7) \
+  X(s8std,     0x70000023, XA_RS_S8_PTN,            3) \
+  X(s8ldi,     0x70000024, XA_RS_S8_PTN,            7) \
+  X(s8sdi,     0x70000025, XA_RS_S8_PTN,            3) \
+  X(s16ldd,    0x7000002a, XA_RS_S10_PTN,           3) \
+  X(s16std,    0x7000002b, XA_RS_S10_PTN,           1) \
+  X(s16ldi,    0x7000002c, XA_RS_S10_PTN,           3) \
+  X(s16sdi,    0x7000002d, XA_RS_S10_PTN,           1) \
+  X(lxw,       0x700000e8, RD_RS_RT_STRD2,          0) \
+  X(lxh,       0x70000068, RD_RS_RT_STRD2,          0) \
+  X(lxhu,      0x70000168, RD_RS_RT_STRD2,          0) \
+  X(lxb,       0x70000028, RD_RS_RT_STRD2,          0) \
+  X(lxbu,      0x70000128, RD_RS_RT_STRD2,          0)
+
+enum class Op : uint8_t {
+#define MXU1_X(name, word, fmt, ptn_max) name,
+  MXU1_OPCODES(MXU1_X)
+#undef MXU1_X
+  invalid
+};
+
+constexpr std::size_t kNumOps = static_cast<std::size_t>(Op::invalid);
+
+struct OpInfo {
+  const char* name;
+  uint32_t    word;     // Base '.word' constant, all operand fields zero
+  Fmt         fmt;
+  uint8_t     ptn_max;  // Highest legal ptn operand, when fmt has one
+};
+
+constexpr OpInfo kOpInfo[kNumOps + 1] = {
+#define MXU1_X(name, word, fmt, ptn_max) { #name, word, Fmt::fmt, ptn_max },
+  MXU1_OPCODES(MXU1_X)
+#undef MXU1_X
+  { "(invalid)", 0, Fmt::XA_XB_XC, 0 }
+};
+
+constexpr const OpInfo& info(Op op) { return kOpInfo[static_cast<std::size_t>(op)]; }
+constexpr const char*   name(Op op) { return info(op).name; }
+
+// Operand spellings accepted by the GAS macros, indexed by field value
+constexpr const char* kGprName[32] = {
+  "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+  "$t0",   "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+  "$s0",   "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+  "$t8",   "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra"
+};
+constexpr const char* kAptn1Name[2] = { "A", "S" };
+constexpr const char* kMptn2Name[4] = { "HH", "LL", "HL", "LH" };
+constexpr const char* kAptn2Name[4] = { "AA", "AS", "SA", "SS" };
+constexpr const char* kOptn2Name[4] = { "WW", "LW", "HW", "XW" };
+
+// One decoded MXU instruction. Fields not used by an opcode's format are 0.
+//  'aptn' holds aptn1/aptn2, 'optn' holds optn2/mptn2, and 'imm' holds
+//  whichever one numeric operand the format has: a byte offset (already
+//  scaled and sign-extended), imm8, sft4, strd2 or bits5.
+struct Insn {
+  Op      op   = Op::invalid;
+  uint8_t xra  = 0, xrb = 0, xrc = 0, xrd = 0;
+  uint8_t rs   = 0, rt  = 0, rd  = 0;
+  uint8_t aptn = 0, optn = 0, ptn = 0;
+  int32_t imm  = 0;
+};
+
+// Bits of a word occupied by the operand fields of a format
+constexpr uint32_t field_mask(Fmt f)
+{
+  return f == Fmt::XA_XB_XC_XD_OPTN2       ? 0x00ffffc0 :
+         f == Fmt::XA_XB_XC_OPTN2          ? 0x00c3ffc0 :
+         f == Fmt::XA_XB_XC_XD_APTN2_OPTN2 ? 0x03ffffc0 :
+         f == Fmt::XA_XB_XC_XD_APTN1_MPTN2 ? 0x01ffffc0 :
+         f == Fmt::XA_XB_XC_XD             ? 0x003fffc0 :
+         f == Fmt::XA_XB_XC_XD_APTN2       ? 0x033fffc0 :
+         f == Fmt::XA_XB_XC                ? 0x0003ffc0 :
+         f == Fmt::XA_XB_XC_XD_PTN         ? 0x033fffc0 :
+         f == Fmt::XA_XB_XC_APTN2          ? 0x0303ffc0 :
+         f == Fmt::XA_XB_XC_XD_SFT4        ? 0x03ffffc0 :
+         f == Fmt::XA_XB_XC_SFT4           ? 0x03c3ffc0 :
+         f == Fmt::XA_XD_RS                ? 0x03e3fc00 :
+         f == Fmt::XA_XD_RS_RT             ? 0x03ff3fc0 :
+         f == Fmt::XA_XD_RS_BITS5          ? 0x03ff3fc0 :
+         f == Fmt::XA_XB_XC_RS             ? 0x03e3ffc0 :
+         f == Fmt::XA_XB_XC_PTN            ? 0x0383ffc0 :
+         f == Fmt::XA_IMM8_PTN             ? 0x0383ffc0 :
+         f == Fmt::XA16_RT                 ? 0x001f07c0 :
+         f == Fmt::XA_RS_RT_STRD2          ? 0x03ffc3c0 :
+         f == Fmt::XA_RS_S12               ? 0x03efffc0 :
+         f == Fmt::XA_RS_S8_PTN            ? 0x03ffffc0 :
+         f == Fmt::XA_RS_S10_PTN           ? 0x03ffffc0 :
+         /* Fmt::RD_RS_RT_STRD2 */           0x03fffe00;
+}
+
+namespace detail {
+
+constexpr int32_t sext(uint32_t v, unsigned bits)
+{
+  return static_cast<int32_t>(v << (32 - bits)) >> (32 - bits);
+}
+
+// Operand fields of 'in' placed as the GAS macros place them, no validation
+constexpr uint32_t place(Fmt f, const Insn& in)
+{
+  return f == Fmt::XA_XB_XC_XD_OPTN2 ?
+           (in.optn << 22) | (in.xrd << 18) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_OPTN2 ?
+           (in.optn << 22) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_XD_APTN2_OPTN2 || f == Fmt::XA_XB_XC_XD_APTN1_MPTN2 ?
+           (in.aptn << 24) | (in.optn << 22) | (in.xrd << 18) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_XD ?
+           (in.xrd << 18) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_XD_APTN2 ?
+           (in.aptn << 24) | (in.xrd << 18) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC ?
+           (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_XD_PTN ?
+           (in.ptn << 24) | (in.xrd << 18) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_APTN2 ?
+           (in.aptn << 24) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_XD_SFT4 ?
+           (static_cast<uint32_t>(in.imm) << 22) | (in.xrd << 18) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_SFT4 ?
+           (static_cast<uint32_t>(in.imm) << 22) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XD_RS ?
+           (in.rs << 21) | (in.xrd << 14) | (in.xra << 10) :
+         f == Fmt::XA_XD_RS_RT ?
+           (in.rs << 21) | (in.rt << 16) | (in.xrd << 10) | (in.xra << 6) :
+         f == Fmt::XA_XD_RS_BITS5 ?
+           (in.rs << 21) | (static_cast<uint32_t>(in.imm) << 16) | (in.xrd << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_RS ?
+           (in.rs << 21) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_XB_XC_PTN ?
+           (in.ptn << 23) | (in.xrc << 14) | (in.xrb << 10) | (in.xra << 6) :
+         f == Fmt::XA_IMM8_PTN ?
+           (in.ptn << 23) | ((static_cast<uint32_t>(in.imm) & 0xff) << 10) | (in.xra << 6) :
+         f == Fmt::XA16_RT ?
+           (in.rt << 16) | (in.xra << 6) :
+         f == Fmt::XA_RS_RT_STRD2 ?
+           (in.rs << 21) | (in.rt << 16) | (static_cast<uint32_t>(in.imm) << 14) | (in.xra << 6) :
+         f == Fmt::XA_RS_S12 ?
+           (in.rs << 21) | ((static_cast<uint32_t>(in.imm) & 0xffc) << 8) | (in.xra << 6) :
+         f == Fmt::XA_RS_S8_PTN ?
+           (in.rs << 21) | (in.ptn << 18) | ((static_cast<uint32_t>(in.imm) & 0xff) << 10) | (in.xra << 6) :
+         f == Fmt::XA_RS_S10_PTN ?
+           (in.rs << 21) | (in.ptn << 19) | ((static_cast<uint32_t>(in.imm) & 0x3fe) << 9) | (in.xra << 6) :
+         /* Fmt::RD_RS_RT_STRD2 */
+           (in.rs << 21) | (in.rt << 16) | (in.rd << 11) | (static_cast<uint32_t>(in.imm) << 9);
+}
+
+// Operand fields of word 'w' pulled back out, inverse of place()
+inline Insn extract(Op op, uint32_t w)
+{
+  Insn in;
+  in.op = op;
+  const Fmt f = info(op).fmt;
+  const uint32_t b6 = (w >> 6) & 0xf, b10 = (w >> 10) & 0xf, b14 = (w >> 14) & 0xf, b18 = (w >> 18) & 0xf;
+  switch (f) {
+    case Fmt::XA_XB_XC_XD_OPTN2:
+    case Fmt::XA_XB_XC_XD_APTN2_OPTN2:
+    case Fmt::XA_XB_XC_XD_APTN1_MPTN2:
+    case Fmt::XA_XB_XC_XD:
+    case Fmt::XA_XB_XC_XD_APTN2:
+    case Fmt::XA_XB_XC_XD_PTN:
+    case Fmt::XA_XB_XC_XD_SFT4:
+      in.xrd = b18;
+      // fall through
+    case Fmt::XA_XB_XC_OPTN2:
+    case Fmt::XA_XB_XC:
+    case Fmt::XA_XB_XC_APTN2:
+    case Fmt::XA_XB_XC_SFT4:
+    case Fmt::XA_XB_XC_RS:
+    case Fmt::XA_XB_XC_PTN:
+      in.xra = b6;  in.xrb = b10;  in.xrc = b14;
+      break;
+    case Fmt::XA_XD_RS:
+      in.xra = b10;  in.xrd = b14;  in.rs = (w >> 21) & 0x1f;
+      break;
+    case Fmt::XA_XD_RS_RT:
+    case Fmt::XA_XD_RS_BITS5:
+      in.xra = b6;  in.xrd = b10;  in.rs = (w >> 21) & 0x1f;
+      break;
+    case Fmt::XA_IMM8_PTN:
+      in.xra = b6;
+      break;
+    case Fmt::XA16_RT:
+      in.xra = (w >> 6) & 0x1f;  in.rt = (w >> 16) & 0x1f;
+      break;
+    case Fmt::XA_RS_RT_STRD2:
+    case Fmt::XA_RS_S12:
+    case Fmt::XA_RS_S8_PTN:
+    case Fmt::XA_RS_S10_PTN:
+      in.xra = b6;  in.rs = (w >> 21) & 0x1f;
+      break;
+    case Fmt::RD_RS_RT_STRD2:
+      in.rd = (w >> 11) & 0x1f;  in.rs = (w >> 21) & 0x1f;
+      break;
+  }
+  switch (f) {
+    case Fmt::XA_XB_XC_XD_OPTN2:
+    case Fmt::XA_XB_XC_OPTN2:          in.optn = (w >> 22) & 3;  break;
+    case Fmt::XA_XB_XC_XD_APTN2_OPTN2: in.aptn = (w >> 24) & 3;  in.optn = (w >> 22) & 3;  break;
+    case Fmt::XA_XB_XC_XD_APTN1_MPTN2: in.aptn = (w >> 24) & 1;  in.optn = (w >> 22) & 3;  break;
+    case Fmt::XA_XB_XC_XD_APTN2:
+    case Fmt::XA_XB_XC_APTN2:          in.aptn = (w >> 24) & 3;  break;
+    case Fmt::XA_XB_XC_XD_PTN:         in.ptn  = (w >> 24) & 3;  break;
+    case Fmt::XA_XB_XC_XD_SFT4:
+    case Fmt::XA_XB_XC_SFT4:           in.imm  = (w >> 22) & 0xf;  break;
+    case Fmt::XA_XD_RS_RT:             in.rt   = (w >> 16) & 0x1f;  break;
+    case Fmt::XA_XD_RS_BITS5:          in.imm  = (w >> 16) & 0x1f;  break;
+    case Fmt::XA_XB_XC_RS:             in.rs   = (w >> 21) & 0x1f;  break;
+    case Fmt::XA_XB_XC_PTN:            in.ptn  = (w >> 23) & 7;  break;
+    case Fmt::XA_IMM8_PTN:             in.ptn  = (w >> 23) & 7;  in.imm = (w >> 10) & 0xff;  break;
+    case Fmt::XA_RS_RT_STRD2:          in.rt   = (w >> 16) & 0x1f;  in.imm = (w >> 14) & 3;  break;
+    case Fmt::XA_RS_S12:               in.imm  = sext((w >> 10) & 0x3ff, 10) * 4;  break;
+    case Fmt::XA_RS_S8_PTN:            in.ptn  = (w >> 18) & 7;  in.imm = sext((w >> 10) & 0xff, 8);  break;
+    case Fmt::XA_RS_S10_PTN:           in.ptn  = (w >> 19) & 3;  in.imm = sext((w >> 10) & 0x1ff, 9) * 2;  break;
+    case Fmt::RD_RS_RT_STRD2:          in.rt   = (w >> 16) & 0x1f;  in.imm = (w >> 9) & 3;  break;
+    default:                           break;
+  }
+  return in;
+}
+
+// The same range checks the GAS macros make with MXU_CHECK_BOUNDS,
+//  MXU_CHECK_OFFSET and MXU_CHECK_PATTERN, on fields already extracted.
+inline bool fields_valid(const Insn& in)
+{
+  const OpInfo& oi = info(in.op);
+  if (in.xra > (oi.fmt == Fmt::XA16_RT ? 16 : 15))
+    return false;
+  switch (oi.fmt) {
+    case Fmt::XA_XB_XC_XD_PTN:
+    case Fmt::XA_XB_XC_PTN:
+    case Fmt::XA_IMM8_PTN:
+    case Fmt::XA_RS_S8_PTN:
+    case Fmt::XA_RS_S10_PTN:   return in.ptn <= oi.ptn_max;
+    case Fmt::XA_RS_RT_STRD2:
+    case Fmt::RD_RS_RT_STRD2:  return in.imm <= 2;
+    case Fmt::XA_XD_RS_BITS5:  return in.imm >= 1;
+    default:                   return true;
+  }
+}
+
+// Opcodes bucketed by their 6-bit SPECIAL2 minor opcode field
+struct MinorIndex {
+  uint8_t first[64 + 1];
+  Op      ops[kNumOps];
+
+  MinorIndex()
+  {
+    std::size_t n = 0;
+    for (unsigned minor = 0; minor < 64; ++minor) {
+      first[minor] = static_cast<uint8_t>(n);
+      for (std::size_t i = 0; i < kNumOps; ++i) {
+        if ((kOpInfo[i].word & 0x3f) == minor)
+          ops[n++] = static_cast<Op>(i);
+      }
+    }
+    first[64] = static_cast<uint8_t>(n);
+  }
+};
+
+inline const MinorIndex& minor_index()
+{
+  static const MinorIndex idx;
+  return idx;
+}
+
+} // namespace detail
+
+// True if 'w' sits in the SPECIAL2 major opcode space that MXU1 shares with
+//  madd/mul/clz etc. A word for which this is true may still be non-MXU.
+constexpr bool is_special2(uint32_t w) { return (w >> 26) == 0x1c; }
+
+// Decode one instruction word. Non-MXU words and MXU words with operand
+//  values the GAS macros would have rejected decode to Op::invalid.
+inline Insn decode(uint32_t w)
+{
+  if (is_special2(w)) {
+    const detail::MinorIndex& idx = detail::minor_index();
+    const unsigned minor = w & 0x3f;
+    for (unsigned i = idx.first[minor]; i < idx.first[minor + 1]; ++i) {
+      const Op op = idx.ops[i];
+      const OpInfo& oi = info(op);
+      if ((w & ~field_mask(oi.fmt)) == oi.word) {
+        Insn in = detail::extract(op, w);
+        if (detail::fields_valid(in))
+          return in;
+        break;
+      }
+    }
+  }
+  return Insn();
+}
+
+// Encode a decoded instruction back into its word. Operands are assumed to be
+//  in range (see decode(), or mxu1_encode.hpp for checked encoders).
+constexpr uint32_t encode(const Insn& in)
+{
+  return info(in.op).word | detail::place(info(in.op).fmt, in);
+}
+
+} // namespace mxu1
+
+#endif // MXU1_ISA_HPP
@@ -0,0 +1,362 @@
+// mxu1_parse.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 macro-syntax statement parser
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  The inverse of mxu1_disasm.hpp: turns one macro invocation as written in a
+// .s/.S file back into an Insn, for source-level tools. It accepts what the
+// GAS macros accept in practice: 'xrN', '$name' or '$N' GPRs, pattern names or
+// their numeric equivalents, 'ptnN', and plain integer literals. Operands
+// that are symbolic expressions (other than those) are reported as errors,
+// since only the assembler can evaluate them.
+//
+// Operand values are validated by round-tripping them through encode() and
+// decode(), which rejects exactly what MXU_CHECK_* would have.
+//
+// Also here are the small lexical helpers (comment stripping, statement and
+// operand splitting) that every source-level tool needs.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_PARSE_HPP
+#define MXU1_PARSE_HPP
+
+#include "mxu1_isa.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace mxu1 {
+
+inline bool operator==(const Insn& x, const Insn& y)
+{
+  return x.op == y.op && x.xra == y.xra && x.xrb == y.xrb && x.xrc == y.xrc && x.xrd == y.xrd &&
+         x.rs == y.rs && x.rt == y.rt && x.rd == y.rd && x.aptn == y.aptn && x.optn == y.optn &&
+         x.ptn == y.ptn && x.imm == y.imm;
+}
+inline bool operator!=(const Insn& x, const Insn& y) { return !(x == y); }
+
+// Opcode for a macro name, Op::invalid if it is not one of ours
+inline Op find_op(const std::string& mnemonic)
+{
+  for (std::size_t i = 0; i < kNumOps; ++i) {
+    if (mnemonic == kOpInfo[i].name)
+      return static_cast<Op>(i);
+  }
+  return Op::invalid;
+}
+
+namespace detail {
+
+inline std::string trim(const std::string& s)
+{
+  std::size_t b = 0, e = s.size();
+  while (b < e && std::isspace(static_cast<unsigned char>(s[b])))
+    ++b;
+  while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1])))
+    --e;
+  return s.substr(b, e - b);
+}
+
+inline bool parse_int(const std::string& s, int32_t& out)
+{
+  if (s.empty())
+    return false;
+  errno = 0;
+  char* end = nullptr;
+  const long v = std::strtol(s.c_str(), &end, 0);
+  if (errno || *end != '\0' || v < INT32_MIN || v > INT32_MAX)
+    return false;
+  out = static_cast<int32_t>(v);
+  return true;
+}
+
+// Index of 's' in 'names[0..n)', or -1; digits 0..n-1 are also accepted
+inline int parse_name(const std::string& s, const char* const* names, int n)
+{
+  for (int i = 0; i < n; ++i) {
+    if (s == names[i])
+      return i;
+  }
+  int32_t v;
+  return parse_int(s, v) && v >= 0 && v < n ? v : -1;
+}
+
+inline int parse_xr(const std::string& s, int max)
+{
+  int32_t v;
+  if (s.size() < 3 || s.compare(0, 2, "xr") != 0 || !std::isdigit(static_cast<unsigned char>(s[2])) ||
+      !parse_int(s.substr(2), v) || v < 0 || v > max)
+    return -1;
+  return v;
+}
+
+inline int parse_gpr(const std::string& s)
+{
+  if (s.size() < 2 || s[0] != '$')
+    return -1;
+  for (int i = 0; i < 32; ++i) {
+    if (s == kGprName[i])
+      return i;
+  }
+  if (s == "$s8")
+    return 30;
+  int32_t v;
+  return std::isdigit(static_cast<unsigned char>(s[1])) && parse_int(s.substr(1), v) && v >= 0 && v < 32 ? v : -1;
+}
+
+inline int parse_ptn(const std::string& s)
+{
+  int32_t v;
+  if (s.size() == 4 && s.compare(0, 3, "ptn") == 0 && s[3] >= '0' && s[3] <= '7')
+    return s[3] - '0';
+  return parse_int(s, v) && v >= 0 && v <= 7 ? v : -1;
+}
+
+} // namespace detail
+
+// Split "a, b, c" at top-level commas, trimming each operand
+inline std::vector<std::string> split_operands(const std::string& s)
+{
+  std::vector<std::string> out;
+  int depth = 0;
+  std::size_t start = 0;
+  for (std::size_t i = 0; i <= s.size(); ++i) {
+    const char ch = i < s.size() ? s[i] : ',';
+    if (ch == '(')
+      ++depth;
+    else if (ch == ')')
+      --depth;
+    else if (ch == ',' && depth <= 0) {
+      out.push_back(detail::trim(s.substr(start, i - start)));
+      start = i + 1;
+    }
+  }
+  if (out.size() == 1 && out[0].empty())
+    out.clear();
+  return out;
+}
+
+// One assembler statement, with comments and any leading labels removed
+struct Statement {
+  std::vector<std::string> labels;
+  std::string mnemonic;   // Empty for label-only or blank statements
+  std::string operands;   // Raw operand text
+};
+
+// Break a source line into its ';'-separated statements. '#' starts a comment
+//  (as it does for MIPS GAS), except inside a string.
+inline std::vector<Statement> split_statements(const std::string& line)
+{
+  std::vector<Statement> out;
+  std::string cur;
+  bool in_str = false;
+  auto flush = [&out](const std::string& text) {
+    Statement st;
+    std::string s = detail::trim(text);
+    for (;;) {
+      std::size_t i = 0;
+      while (i < s.size() && (std::isalnum(static_cast<unsigned char>(s[i])) || s[i] == '_' ||
+                              s[i] == '.' || s[i] == '$'))
+        ++i;
+      if (i > 0 && i < s.size() && s[i] == ':') {
+        st.labels.push_back(s.substr(0, i));
+        s = detail::trim(s.substr(i + 1));
+      } else {
+        break;
+      }
+    }
+    std::size_t sp = 0;
+    while (sp < s.size() && !std::isspace(static_cast<unsigned char>(s[sp])))
+      ++sp;
+    st.mnemonic = s.substr(0, sp);
+    st.operands = detail::trim(s.substr(sp));
+    if (!st.labels.empty() || !st.mnemonic.empty())
+      out.push_back(st);
+  };
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    const char ch = line[i];
+    if (ch == '"' && (i == 0 || line[i - 1] != '\\'))
+      in_str = !in_str;
+    if (!in_str && ch == '#')
+      break;
+    if (!in_str && ch == ';') {
+      flush(cur);
+      cur.clear();
+    } else {
+      cur += ch;
+    }
+  }
+  flush(cur);
+  return out;
+}
+
+// Parse one MXU macro invocation. Returns false if 'mnemonic' is not an MXU
+//  macro (and 'err' is left empty), or if its operands are malformed or out
+//  of range (and 'err' says why).
+inline bool parse(const std::string& mnemonic, const std::string& operands, Insn& out, std::string& err)
+{
+  using namespace detail;
+  err.clear();
+  const Op op = find_op(mnemonic);
+  if (op == Op::invalid)
+    return false;
+
+  static const int kArity[] = {
+    5, 4, 6, 6, 4, 5, 3, 5, 4, 5, 4, 3, 4, 4, 4, 4, 3, 2, 4, 3, 4, 4, 4
+  };
+  const Fmt f = info(op).fmt;
+  const std::vector<std::string> a = split_operands(operands);
+  if (a.size() != static_cast<std::size_t>(kArity[static_cast<int>(f)])) {
+    err = mnemonic + ": expected " + std::to_string(kArity[static_cast<int>(f)]) + " operands";
+    return false;
+  }
+
+  Insn in;
+  in.op = op;
+  bool ok = true;
+  auto xr = [&](std::size_t i, uint8_t& dst, int max) {
+    const int v = parse_xr(a[i], max);
+    ok = ok && v >= 0;
+    dst = static_cast<uint8_t>(v < 0 ? 0 : v);
+  };
+  auto gp = [&](std::size_t i, uint8_t& dst) {
+    const int v = parse_gpr(a[i]);
+    ok = ok && v >= 0;
+    dst = static_cast<uint8_t>(v < 0 ? 0 : v);
+  };
+  auto pat = [&](std::size_t i, uint8_t& dst, const char* const* names, int n) {
+    const int v = parse_name(a[i], names, n);
+    ok = ok && v >= 0;
+    dst = static_cast<uint8_t>(v < 0 ? 0 : v);
+  };
+  auto ptn = [&](std::size_t i) {
+    const int v = parse_ptn(a[i]);
+    ok = ok && v >= 0;
+    in.ptn = static_cast<uint8_t>(v < 0 ? 0 : v);
+  };
+  auto num = [&](std::size_t i) { ok = ok && parse_int(a[i], in.imm); };
+
+  switch (f) {
+    case Fmt::XA_XB_XC_XD_OPTN2:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  xr(3, in.xrd, 15);
+      pat(4, in.optn, kOptn2Name, 4);
+      break;
+    case Fmt::XA_XB_XC_OPTN2:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);
+      pat(3, in.optn, kOptn2Name, 4);
+      break;
+    case Fmt::XA_XB_XC_XD_APTN2_OPTN2:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  xr(3, in.xrd, 15);
+      pat(4, in.aptn, kAptn2Name, 4);  pat(5, in.optn, kOptn2Name, 4);
+      break;
+    case Fmt::XA_XB_XC_XD_APTN1_MPTN2:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  xr(3, in.xrd, 15);
+      pat(4, in.aptn, kAptn1Name, 2);  pat(5, in.optn, kMptn2Name, 4);
+      break;
+    case Fmt::XA_XB_XC_XD:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  xr(3, in.xrd, 15);
+      break;
+    case Fmt::XA_XB_XC_XD_APTN2:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  xr(3, in.xrd, 15);
+      pat(4, in.aptn, kAptn2Name, 4);
+      break;
+    case Fmt::XA_XB_XC:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);
+      break;
+    case Fmt::XA_XB_XC_XD_PTN:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  xr(3, in.xrd, 15);
+      ptn(4);
+      break;
+    case Fmt::XA_XB_XC_APTN2:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);
+      pat(3, in.aptn, kAptn2Name, 4);
+      break;
+    case Fmt::XA_XB_XC_XD_SFT4:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  xr(3, in.xrd, 15);
+      num(4);
+      break;
+    case Fmt::XA_XB_XC_SFT4:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);
+      num(3);
+      break;
+    case Fmt::XA_XD_RS:
+      xr(0, in.xra, 15);  xr(1, in.xrd, 15);  gp(2, in.rs);
+      break;
+    case Fmt::XA_XD_RS_RT:
+      xr(0, in.xra, 15);  xr(1, in.xrd, 15);  gp(2, in.rs);  gp(3, in.rt);
+      break;
+    case Fmt::XA_XD_RS_BITS5:
+      xr(0, in.xra, 15);  xr(1, in.xrd, 15);  gp(2, in.rs);  num(3);
+      break;
+    case Fmt::XA_XB_XC_RS:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  gp(3, in.rs);
+      break;
+    case Fmt::XA_XB_XC_PTN:
+      xr(0, in.xra, 15);  xr(1, in.xrb, 15);  xr(2, in.xrc, 15);  ptn(3);
+      break;
+    case Fmt::XA_IMM8_PTN:
+      xr(0, in.xra, 15);  num(1);  ptn(2);
+      if (ok && in.imm >= -128 && in.imm < 0)
+        in.imm &= 0xff;
+      break;
+    case Fmt::XA16_RT:
+      xr(0, in.xra, 16);  gp(1, in.rt);
+      break;
+    case Fmt::XA_RS_RT_STRD2:
+      xr(0, in.xra, 15);  gp(1, in.rs);  gp(2, in.rt);  num(3);
+      break;
+    case Fmt::XA_RS_S12:
+      xr(0, in.xra, 15);  gp(1, in.rs);  num(2);
+      break;
+    case Fmt::XA_RS_S8_PTN:
+    case Fmt::XA_RS_S10_PTN:
+      xr(0, in.xra, 15);  gp(1, in.rs);  num(2);  ptn(3);
+      break;
+    case Fmt::RD_RS_RT_STRD2:
+      gp(0, in.rd);  gp(1, in.rs);  gp(2, in.rt);  num(3);
+      break;
+  }
+
+  if (!ok) {
+    err = mnemonic + ": unrecognized operand in '" + operands + "'";
+    return false;
+  }
+  if (decode(encode(in)) != in) {
+    err = mnemonic + ": operand out of range or misaligned in '" + operands + "'";
+    return false;
+  }
+  out = in;
+  return true;
+}
+
+} // namespace mxu1
+
+#endif // MXU1_PARSE_HPP
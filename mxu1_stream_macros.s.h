@@ -0,0 +1,214 @@
+# mxu1_stream_macros.s.h
+#
+# MIPS Ingenic XBurst MXU1 rev1,2 software-pipelined loop macros for GNU GAS
+#
+# MIT License
+#
+# Copyright (c) 2019 Daniel Silsby (senquack)
+#                    dansilsby <AT> gmail <DOT> com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+################################################################################
+#  Streaming kernels (load, compute, store, repeat) written the obvious way
+# stall on every load and on every multiply result. These macros take the
+# three stages of such a kernel as the names of three macros of your own, and
+# emit a modulo-scheduled loop around them: the body is unrolled 'unroll'
+# times, each copy ("slot") working on its own registers, and the three stages
+# of successive groups of 'unroll' elements overlap:
+#
+#     prologue:  L0 L1 .. Ln                      load group 0
+#                C0 L0 C1 L1 .. Cn Ln             compute 0, load 1
+#     kernel:    S0 C0 L0 .. Sn Cn Ln             store g-1, compute g, load g+1
+#     epilogue:  S0 C0 .. Sn Cn                   store n-2, compute n-1
+#                S0 .. Sn                         store n-1
+#     remainder: L0 C0 S0, once per element left over (count % unroll)
+#
+# so every load has a whole group's worth of instructions before its result is
+# used, and every compute result likewise before it is stored.
+#
+# To use this header (it includes mxu1_as_macros.s.h itself):
+#     .include "mxu1_stream_macros.s.h"
+#
+# Example, Q15 x Q15 -> Q15 (d16mulf) multiply of two arrays, 4 words
+# at a time ($a0 = dst, $a1 = src1, $a2 = src2, $a3 = word count):
+#
+#     .mxu_stream_regs X, xr1, xr2, xr3, xr4      # slot 0..3 inputs
+#     .mxu_stream_regs Y, xr5, xr6, xr7, xr8
+#     .mxu_stream_regs Z, xr9, xr10, xr11, xr12   # slot 0..3 results
+#
+#     .macro mul_ld s
+#       s32ldi  X\s, $a1, 4
+#       s32ldi  Y\s, $a2, 4
+#     .endm
+#     .macro mul_op s
+#       d16mulf Z\s, X\s, Y\s, WW
+#     .endm
+#     .macro mul_st s
+#       s32sdi  Z\s, $a0, 4
+#     .endm
+#
+#         addiu   $a0, $a0, -4                    # Pre-decrement for s32ldi
+#         addiu   $a1, $a1, -4                    #  and s32sdi
+#         addiu   $a2, $a2, -4
+#         .mxu_stream_loop $a3, $t0, 4, mul_ld, mul_op, mul_st
+#
+# Going from 4 to 2 slots means changing '4' to '2' (the extra .mxu_stream_regs
+# entries are then simply unused).
+#
+# Rules for the three stage macros, each of which is invoked with the slot
+# number 0..unroll-1 as its only argument:
+#   - The load stage of slot s may write only slot s's input registers, and
+#     the store stage may read only slot s's results. The compute stage of
+#     slot s reads slot s's inputs and writes slot s's results; any other
+#     register it writes must be dead by the end of that same invocation
+#     (scratch registers may be shared by all slots).
+#   - Elements are still computed in order, so accumulators carried from one
+#     compute to the next (sums, running maxima) work unchanged.
+#   - Each stage must advance its own pointers, e.g. with the _i_ forms
+#     (s32ldi, s32sdi, s32ldiv, ...). Stages run a whole group apart, so the
+#     load and store stages must not share a pointer.
+#   - Neither 'count' nor 'tmp' may be used by a stage, and no stage may
+#     branch out of the loop.
+#
+# 'count' is the number of elements (stage invocations), and is clobbered along
+# with 'tmp'. 'unroll' is 1, 2, 4 or 8; at 8 there is room for just one
+# register per slot, which suits reductions whose store stage is empty. The
+# loop is emitted under '.set noreorder', which is restored afterwards. Delay
+# slots hold a nop, one per group, rather than anything from a stage, since a
+# stage may expand to more than one instruction.
+################################################################################
+
+
+.ifndef MXU1_STREAM_MACROS_S_H
+.equiv  MXU1_STREAM_MACROS_S_H, 1
+
+.include "mxu1_as_macros.s.h"
+
+# Name slot registers, so a stage macro can write e.g. 'X\s' for slot s's X:
+#  defines X0 as the first register given, X1 as the second, and so on. The
+#  names may be redefined for the next loop.
+.macro .mxu_stream_regs name:req, r0:req, r1, r2, r3, r4, r5, r6, r7
+  .set MXU_\name\()0, MXU_\r0
+  .ifnb \r1
+    .set MXU_\name\()1, MXU_\r1
+  .endif
+  .ifnb \r2
+    .set MXU_\name\()2, MXU_\r2
+  .endif
+  .ifnb \r3
+    .set MXU_\name\()3, MXU_\r3
+  .endif
+  .ifnb \r4
+    .set MXU_\name\()4, MXU_\r4
+  .endif
+  .ifnb \r5
+    .set MXU_\name\()5, MXU_\r5
+  .endif
+  .ifnb \r6
+    .set MXU_\name\()6, MXU_\r6
+  .endif
+  .ifnb \r7
+    .set MXU_\name\()7, MXU_\r7
+  .endif
+.endm
+
+# Invoke 'stage' (then 'stage2' and 'stage3', if given) for each slot
+#  0..unroll-1 in turn
+.macro MXU_STREAM_SLOTS unroll:req, stage:req, stage2, stage3
+  .irp s, 0,1,2,3,4,5,6,7
+    .if \s < (\unroll)
+      \stage \s
+      .ifnb \stage2
+        \stage2 \s
+      .endif
+      .ifnb \stage3
+        \stage3 \s
+      .endif
+    .endif
+  .endr
+.endm
+
+.macro .mxu_stream_loop count:req, tmp:req, unroll:req, load:req, compute:req, store:req
+  .if (\unroll) == 1
+    .equiv MXU_STREAM_SHIFT_\@, 0
+  .elseif (\unroll) == 2
+    .equiv MXU_STREAM_SHIFT_\@, 1
+  .elseif (\unroll) == 4
+    .equiv MXU_STREAM_SHIFT_\@, 2
+  .elseif (\unroll) == 8
+    .equiv MXU_STREAM_SHIFT_\@, 3
+  .else
+    .error ".mxu_stream_loop unroll factor must be 1, 2, 4 or 8 : \unroll"
+  .endif
+
+  .set push
+  .set noreorder
+  .if (\unroll) > 1
+    andi    \tmp, \count, (\unroll) - 1
+    srl     \count, \count, MXU_STREAM_SHIFT_\@
+  .endif
+    beqz    \count, .Lmxu_stream_rem_\@
+    nop
+
+    MXU_STREAM_SLOTS \unroll, \load
+    addiu   \count, \count, -1
+    beqz    \count, .Lmxu_stream_one_\@
+    nop
+
+    MXU_STREAM_SLOTS \unroll, \compute, \load
+    addiu   \count, \count, -1
+    beqz    \count, .Lmxu_stream_drain_\@
+    nop
+
+.Lmxu_stream_kernel_\@:
+    MXU_STREAM_SLOTS \unroll, \store, \compute, \load
+    addiu   \count, \count, -1
+    bnez    \count, .Lmxu_stream_kernel_\@
+    nop
+
+.Lmxu_stream_drain_\@:
+    MXU_STREAM_SLOTS \unroll, \store, \compute
+    b       .Lmxu_stream_last_\@
+    nop
+
+.Lmxu_stream_one_\@:
+    MXU_STREAM_SLOTS \unroll, \compute
+.Lmxu_stream_last_\@:
+    MXU_STREAM_SLOTS \unroll, \store
+
+.Lmxu_stream_rem_\@:
+  .if (\unroll) > 1
+    beqz    \tmp, .Lmxu_stream_done_\@
+    nop
+.Lmxu_stream_rem_loop_\@:
+    \load 0
+    addiu   \tmp, \tmp, -1
+    \compute 0
+    \store 0
+    bnez    \tmp, .Lmxu_stream_rem_loop_\@
+    nop
+  .endif
+.Lmxu_stream_done_\@:
+  .set pop
+.endm
+
+.endif # MXU1_STREAM_MACROS_S_H
+
+# vim:shiftwidth=2:expandtab:syntax=asm
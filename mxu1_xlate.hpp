@@ -0,0 +1,681 @@
+// mxu1_xlate.hpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 block translator to host SSE2 for fast emulation
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  mxu1::Translator runs the same word sequences as mxu1::State::run(), with
+// the same results, several times faster: long replays (hours of video
+// through the motion estimation, CNN test sets) as host regression tests.
+//
+//     mxu1::State st;
+//     mxu1::Translator tr(st);
+//     st.mem.map(...);  st.gpr[5] = ...;       // as for State
+//     for (int y = 0; y < rows; ++y)
+//       tr.run(kernel_words, kernel_len);      // instead of st.run()
+//
+//  The first run() of a block of words decodes it once into a list of
+// handlers, one per instruction, with operand fields already extracted and
+// everything that is fixed at translation worked out (s32lui values, which
+// lanes of q8add subtract, the optn2 half selection). Later runs of the
+// same words at the same address find it in the cache and just call the
+// handlers, after comparing the words with the copy kept at translation, so
+// a buffer reused for other code (mxu1::Emitter) is retranslated rather
+// than run stale.
+//
+//  The q8/q16/d16 lane ops become SSE2 on x86 (e.g. q8sad is psadbw,
+// q8max pmaxub, d16mac pmullw/pmulhw plus a masked paddd/psubd, q16sat
+// packuswb). An xr register is 32 bits, so no op needs more than one
+// 128-bit register; AVX2 has nothing to add. The scalar, shift, move and
+// common load/store ops have handlers in plain C++; the rest, anything
+// writing xr0, $zero or MXU_CR, and every op on a host without SSE2 for
+// the lane ops, go through State::exec(). So do all ops while MXU_CR.MXU_EN
+// is clear. Execution order, faults (thrown before the faulting
+// instruction writes anything) and State::counts are exactly those of
+// State::run().
+//
+//  A Translator refers to its State, which must outlive it, and is no more
+// thread safe than the State.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MXU1_XLATE_HPP
+#define MXU1_XLATE_HPP
+
+#include "mxu1_deps.hpp"
+#include "mxu1_emu.hpp"
+#include "mxu1_isa.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MXU1_XLATE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MXU1_XLATE_SSE2 0
+#endif
+
+namespace mxu1 {
+
+namespace xlate {
+
+// One translated instruction. 'k' is whatever the handler precomputes.
+struct Uop;
+using Handler = void (*)(State&, const Uop&);
+
+struct Uop {
+  Handler  fn;     // nullptr: State::exec()
+  uint8_t  op;
+  uint8_t  a, b, c, d;
+  uint8_t  rs, rt;
+  int32_t  imm;
+  uint32_t k;
+};
+
+//  Both halves of XRb as optn2 feeds them to the H and L lanes
+inline uint32_t optn2_halves(uint32_t b, unsigned optn)
+{
+  switch (optn & 3) {
+    case 0:  return b;
+    case 1:  return (b << 16) | (b & 0xffff);
+    case 2:  return (b & 0xffff0000) | (b >> 16);
+    default: return (b << 16) | (b >> 16);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar handlers
+////////////////////////////////////////////////////////////////////////////////
+
+template <Op O>
+inline void logic(State& s, const Uop& u)
+{
+  const uint32_t b = s.xr[u.b], c = s.xr[u.c];
+  s.xr[u.a] = O == Op::s32and ? b & c : O == Op::s32or ? b | c :
+              O == Op::s32xor ? b ^ c : ~(b | c);
+}
+
+template <bool Min>
+inline void s32minmax(State& s, const Uop& u)
+{
+  const uint32_t b = s.xr[u.b], c = s.xr[u.c];
+  const bool lt = static_cast<int32_t>(b) < static_cast<int32_t>(c);
+  s.xr[u.a] = lt == Min ? b : c;
+}
+
+inline void s32slt(State& s, const Uop& u)
+{
+  s.xr[u.a] = static_cast<int32_t>(s.xr[u.b]) < static_cast<int32_t>(s.xr[u.c]);
+}
+
+template <bool Nonzero>
+inline void s32mov(State& s, const Uop& u)
+{
+  if ((s.xr[u.c] != 0) == Nonzero)
+    s.xr[u.a] = s.xr[u.b];
+}
+
+//  XRd and XRa shifted by u.imm: 0 left, 1 logical right, 2 arithmetic right
+template <int Kind>
+inline void d32shift(State& s, const Uop& u)
+{
+  const uint32_t b = s.xr[u.b], c = s.xr[u.c];
+  const unsigned n = static_cast<unsigned>(u.imm);
+  s.xr[u.d] = Kind == 0 ? c << n : Kind == 1 ? c >> n :
+              static_cast<uint32_t>(static_cast<int32_t>(c) >> n);
+  s.xr[u.a] = Kind == 0 ? b << n : Kind == 1 ? b >> n :
+              static_cast<uint32_t>(static_cast<int32_t>(b) >> n);
+}
+
+//  u.k: bit 1 subtracts into XRa, bit 0 into XRd
+inline void d32add(State& s, const Uop& u)
+{
+  const uint64_t b = s.xr[u.b], c = s.xr[u.c];
+  const uint64_t ra = u.k & 2 ? b - c : b + c, rd = u.k & 1 ? b - c : b + c;
+  s.xr[16] = (s.xr[16] & ~(CR_CARRY_A | CR_CARRY_D)) |
+             ((ra >> 32) ? CR_CARRY_A : 0) | ((rd >> 32) ? CR_CARRY_D : 0);
+  s.xr[u.d] = static_cast<uint32_t>(rd);
+  s.xr[u.a] = static_cast<uint32_t>(ra);
+}
+
+inline void d32acc(State& s, const Uop& u)
+{
+  const uint32_t a = s.xr[u.a], b = s.xr[u.b], c = s.xr[u.c], d = s.xr[u.d];
+  s.xr[u.d] = d + (u.k & 1 ? b - c : b + c);
+  s.xr[u.a] = a + (u.k & 2 ? b - c : b + c);
+}
+
+inline void d32asum(State& s, const Uop& u)
+{
+  const uint32_t a = s.xr[u.a], b = s.xr[u.b], c = s.xr[u.c], d = s.xr[u.d];
+  s.xr[u.d] = u.k & 1 ? d - c : d + c;
+  s.xr[u.a] = u.k & 2 ? a - b : a + b;
+}
+
+inline void s32alni(State& s, const Uop& u)
+{
+  const uint32_t b = s.xr[u.b], c = s.xr[u.c];
+  s.xr[u.a] = u.k == 0 ? b : u.k == 4 ? c : (b << (8 * u.k)) | (c >> (32 - 8 * u.k));
+}
+
+inline void s32aln(State& s, const Uop& u)
+{
+  const unsigned n = s.gpr[u.rs] & 7;
+  const uint32_t b = s.xr[u.b], c = s.xr[u.c];
+  if (n <= 4)
+    s.xr[u.a] = n == 0 ? b : n == 4 ? c : (b << (8 * n)) | (c >> (32 - 8 * n));
+}
+
+inline void s32lui(State& s, const Uop& u)  { s.xr[u.a] = u.k; }
+inline void s32i2m(State& s, const Uop& u)  { s.xr[u.a] = s.gpr[u.rt]; }
+inline void s32m2i(State& s, const Uop& u)  { s.gpr[u.rt] = s.xr[u.a]; }
+
+//  Word loads and stores, byte reversed or not: Index adds rt << strd2
+// (u.imm) rather than the offset u.imm, Inc writes the address back to rs
+template <bool Rev, bool Index, bool Inc>
+inline void s32load(State& s, const Uop& u)
+{
+  const uint32_t addr = s.gpr[u.rs] + (Index ? s.gpr[u.rt] << u.imm : static_cast<uint32_t>(u.imm));
+  const uint32_t v = s.mem.load32(addr);
+  s.xr[u.a] = Rev ? detail::bswap32(v) : v;
+  if (Inc)
+    s.gpr[u.rs] = addr;
+}
+
+template <bool Rev, bool Index, bool Inc>
+inline void s32store(State& s, const Uop& u)
+{
+  const uint32_t addr = s.gpr[u.rs] + (Index ? s.gpr[u.rt] << u.imm : static_cast<uint32_t>(u.imm));
+  const uint32_t a = s.xr[u.a];
+  s.mem.store32(addr, Rev ? detail::bswap32(a) : a);
+  if (Inc)
+    s.gpr[u.rs] = addr;
+}
+
+#if MXU1_XLATE_SSE2
+
+////////////////////////////////////////////////////////////////////////////////
+// SSE2 lane handlers: an xr value sits in the low 32 bits of an __m128i, a
+// pair of them (XRd low, XRa high, or XRc and XRb) in the low 64
+////////////////////////////////////////////////////////////////////////////////
+
+inline __m128i v32(uint32_t v) { return _mm_cvtsi32_si128(static_cast<int>(v)); }
+inline uint32_t s32(__m128i v) { return static_cast<uint32_t>(_mm_cvtsi128_si32(v)); }
+inline uint32_t s32_hi(__m128i v) { return s32(_mm_srli_si128(v, 4)); }
+inline __m128i v64(uint32_t hi, uint32_t lo) { return _mm_unpacklo_epi32(v32(lo), v32(hi)); }
+
+//  Lanes of 'sub' where 'mask' is set, of 'add' elsewhere
+inline __m128i select(__m128i mask, __m128i sub, __m128i add)
+{
+  return _mm_or_si128(_mm_and_si128(mask, sub), _mm_andnot_si128(mask, add));
+}
+
+//  The 64-bit lane mask of an aptn2 pattern for a {XRa:XRd} pair
+inline __m128i pair_mask(uint32_t aptn)
+{
+  return v64(aptn & 2 ? ~0u : 0, aptn & 1 ? ~0u : 0);
+}
+
+//  u.k: mask of the bytes that subtract (XRa's two for aptn bit 1, XRd's
+// for bit 0)
+inline void q8add(State& s, const Uop& u)
+{
+  const __m128i b = v32(s.xr[u.b]), c = v32(s.xr[u.c]);
+  s.xr[u.a] = s32(select(v32(u.k), _mm_sub_epi8(b, c), _mm_add_epi8(b, c)));
+}
+
+inline void q8sad(State& s, const Uop& u)
+{
+  const uint32_t sad = s32(_mm_sad_epu8(v32(s.xr[u.b]), v32(s.xr[u.c])));
+  s.xr[u.d] += sad;
+  s.xr[u.a] = sad;
+}
+
+inline void q8abd(State& s, const Uop& u)
+{
+  const __m128i b = v32(s.xr[u.b]), c = v32(s.xr[u.c]);
+  s.xr[u.a] = s32(_mm_or_si128(_mm_subs_epu8(b, c), _mm_subs_epu8(c, b)));
+}
+
+template <bool Min>
+inline void q8minmax(State& s, const Uop& u)
+{
+  const __m128i b = v32(s.xr[u.b]), c = v32(s.xr[u.c]);
+  s.xr[u.a] = s32(Min ? _mm_min_epu8(b, c) : _mm_max_epu8(b, c));
+}
+
+//  pavgb rounds up; q8avg is that less the bit the rounding added
+template <bool Round>
+inline void q8avg(State& s, const Uop& u)
+{
+  const uint32_t b = s.xr[u.b], c = s.xr[u.c];
+  const uint32_t r = s32(_mm_avg_epu8(v32(b), v32(c)));
+  s.xr[u.a] = Round ? r : r - ((b ^ c) & 0x01010101);
+}
+
+template <bool Unsigned>
+inline void q8slt(State& s, const Uop& u)
+{
+  const __m128i bias = _mm_set1_epi8(Unsigned ? -128 : 0);
+  const __m128i b = _mm_xor_si128(v32(s.xr[u.b]), bias), c = _mm_xor_si128(v32(s.xr[u.c]), bias);
+  s.xr[u.a] = s32(_mm_and_si128(_mm_cmpgt_epi8(c, b), _mm_set1_epi8(1)));
+}
+
+//  Products of the bytes of XRb (signed for q8mulsu/q8macsu) and XRc, as
+// 16-bit lanes 0..3
+template <bool Signed>
+inline __m128i q8products(uint32_t b, uint32_t c)
+{
+  const __m128i z = _mm_setzero_si128();
+  const __m128i vb = Signed ? _mm_srai_epi16(_mm_unpacklo_epi8(v32(b), v32(b)), 8) :
+                              _mm_unpacklo_epi8(v32(b), z);
+  return _mm_mullo_epi16(vb, _mm_unpacklo_epi8(v32(c), z));
+}
+
+template <bool Signed>
+inline void q8mul(State& s, const Uop& u)
+{
+  const __m128i p = q8products<Signed>(s.xr[u.b], s.xr[u.c]);
+  s.xr[u.d] = s32(p);
+  s.xr[u.a] = s32_hi(p);
+}
+
+//  u.k: aptn2
+template <bool Signed>
+inline void q8mac(State& s, const Uop& u)
+{
+  const __m128i p = q8products<Signed>(s.xr[u.b], s.xr[u.c]);
+  const __m128i acc = v64(s.xr[u.a], s.xr[u.d]);
+  const __m128i r = select(pair_mask(u.k), _mm_sub_epi16(acc, p), _mm_add_epi16(acc, p));
+  s.xr[u.d] = s32(r);
+  s.xr[u.a] = s32_hi(r);
+}
+
+inline void q8madl(State& s, const Uop& u)
+{
+  const __m128i z = _mm_setzero_si128();
+  const __m128i p = q8products<false>(s.xr[u.b], s.xr[u.c]);
+  const __m128i a = _mm_unpacklo_epi8(v32(s.xr[u.a]), z);
+  const __m128i r = select(pair_mask(u.k), _mm_sub_epi16(a, p), _mm_add_epi16(a, p));
+  s.xr[u.d] = s32(_mm_packus_epi16(_mm_and_si128(r, _mm_set1_epi16(0xff)), z));
+}
+
+//  u.k: aptn2
+template <bool Acc>
+inline void q8adde(State& s, const Uop& u)
+{
+  const __m128i z = _mm_setzero_si128();
+  const __m128i b = _mm_unpacklo_epi8(v32(s.xr[u.b]), z), c = _mm_unpacklo_epi8(v32(s.xr[u.c]), z);
+  __m128i r = select(pair_mask(u.k), _mm_sub_epi16(b, c), _mm_add_epi16(b, c));
+  if (Acc)
+    r = _mm_add_epi16(r, v64(s.xr[u.a], s.xr[u.d]));
+  s.xr[u.d] = s32(r);
+  s.xr[u.a] = s32_hi(r);
+}
+
+//  Byte sums of XRb and XRc (psadbw against zero, per 64-bit half), plus
+// 2 each for d8sumc
+template <bool Round>
+inline void d8sum(State& s, const Uop& u)
+{
+  const __m128i v = _mm_unpacklo_epi64(v32(s.xr[u.c]), v32(s.xr[u.b]));
+  const __m128i sum = _mm_sad_epu8(v, _mm_setzero_si128());
+  const uint32_t k = Round ? 2 : 0;
+  s.xr[u.a] = detail::pack16(s32(_mm_srli_si128(sum, 8)) + k, s32(sum) + k);
+}
+
+//  u.k: aptn2, XRb halves already as optn2 selects them at u.imm
+inline void q16add(State& s, const Uop& u)
+{
+  const __m128i b = v32(optn2_halves(s.xr[u.b], static_cast<unsigned>(u.imm))), c = v32(s.xr[u.c]);
+  const __m128i sum = _mm_add_epi16(b, c), diff = _mm_sub_epi16(b, c);
+  s.xr[u.d] = s32(u.k & 1 ? diff : sum);
+  s.xr[u.a] = s32(u.k & 2 ? diff : sum);
+}
+
+template <bool Accm>
+inline void q16acc(State& s, const Uop& u)
+{
+  const __m128i b = v32(s.xr[u.b]), c = v32(s.xr[u.c]);
+  const __m128i td = Accm ? c : u.k & 1 ? _mm_sub_epi16(b, c) : _mm_add_epi16(b, c);
+  const __m128i ta = Accm ? b : u.k & 2 ? _mm_sub_epi16(b, c) : _mm_add_epi16(b, c);
+  const __m128i d = v32(s.xr[u.d]), a = v32(s.xr[u.a]);
+  s.xr[u.d] = s32(Accm && u.k & 1 ? _mm_sub_epi16(d, td) : _mm_add_epi16(d, td));
+  s.xr[u.a] = s32(Accm && u.k & 2 ? _mm_sub_epi16(a, ta) : _mm_add_epi16(a, ta));
+}
+
+//  The 32-bit products of the halves of XRb (optn2 at u.imm) with those of
+// XRc: lane 0 the L product, lane 1 the H one
+inline __m128i d16products(const State& s, const Uop& u)
+{
+  const __m128i b = v32(optn2_halves(s.xr[u.b], static_cast<unsigned>(u.imm))), c = v32(s.xr[u.c]);
+  return _mm_unpacklo_epi16(_mm_mullo_epi16(b, c), _mm_mulhi_epi16(b, c));
+}
+
+inline void d16mul(State& s, const Uop& u)
+{
+  const __m128i p = d16products(s, u);
+  s.xr[u.d] = s32(p);
+  s.xr[u.a] = s32_hi(p);
+}
+
+//  u.k: aptn2
+inline void d16mac(State& s, const Uop& u)
+{
+  const __m128i p = d16products(s, u), acc = v64(s.xr[u.a], s.xr[u.d]);
+  const __m128i r = select(pair_mask(u.k), _mm_sub_epi32(acc, p), _mm_add_epi32(acc, p));
+  s.xr[u.d] = s32(r);
+  s.xr[u.a] = s32_hi(r);
+}
+
+template <bool Min>
+inline void d16minmax(State& s, const Uop& u)
+{
+  const __m128i b = v32(s.xr[u.b]), c = v32(s.xr[u.c]);
+  s.xr[u.a] = s32(Min ? _mm_min_epi16(b, c) : _mm_max_epi16(b, c));
+}
+
+//  Signed halves biased to unsigned for pavgw, which rounds up
+template <bool Round>
+inline void d16avg(State& s, const Uop& u)
+{
+  const __m128i b = v32(s.xr[u.b]), c = v32(s.xr[u.c]);
+  const __m128i bias = _mm_set1_epi16(-32768);
+  const __m128i r = _mm_xor_si128(_mm_avg_epu16(_mm_xor_si128(b, bias), _mm_xor_si128(c, bias)), bias);
+  s.xr[u.a] = s32(Round ? r : _mm_sub_epi16(r, _mm_and_si128(_mm_xor_si128(b, c), _mm_set1_epi16(1))));
+}
+
+inline void d16slt(State& s, const Uop& u)
+{
+  const __m128i b = v32(s.xr[u.b]), c = v32(s.xr[u.c]);
+  s.xr[u.a] = s32(_mm_and_si128(_mm_cmpgt_epi16(c, b), _mm_set1_epi16(1)));
+}
+
+inline void q16sat(State& s, const Uop& u)
+{
+  const __m128i v = v64(s.xr[u.b], s.xr[u.c]);
+  s.xr[u.a] = s32(_mm_packus_epi16(v, v));
+}
+
+//  Both halves of XRc into XRd and of XRb into XRa, shifted by u.imm (Kind
+// as d32shift)
+template <int Kind>
+inline void q16shift(State& s, const Uop& u)
+{
+  const __m128i v = v64(s.xr[u.b], s.xr[u.c]), n = v32(static_cast<uint32_t>(u.imm));
+  const __m128i r = Kind == 0 ? _mm_sll_epi16(v, n) : Kind == 1 ? _mm_srl_epi16(v, n) :
+                    _mm_sra_epi16(v, n);
+  s.xr[u.d] = s32(r);
+  s.xr[u.a] = s32_hi(r);
+}
+
+//  XRa and XRd in place, by rs[3:0]
+template <int Kind>
+inline void q16shiftv(State& s, const Uop& u)
+{
+  const __m128i v = v64(s.xr[u.a], s.xr[u.d]), n = v32(s.gpr[u.rs] & 0xf);
+  const __m128i r = Kind == 0 ? _mm_sll_epi16(v, n) : Kind == 1 ? _mm_srl_epi16(v, n) :
+                    _mm_sra_epi16(v, n);
+  s.xr[u.d] = s32(r);
+  s.xr[u.a] = s32_hi(r);
+}
+
+#endif // MXU1_XLATE_SSE2
+
+////////////////////////////////////////////////////////////////////////////////
+// Translation
+////////////////////////////////////////////////////////////////////////////////
+
+//  The value s32lui writes
+inline uint32_t lui_value(const Insn& in)
+{
+  const uint32_t i8 = static_cast<uint32_t>(in.imm) & 0xff;
+  const uint32_t s8 = static_cast<uint32_t>(static_cast<int8_t>(i8)) & 0xffff;
+  switch (in.ptn) {
+    case 0:  return i8;
+    case 1:  return i8 << 8;
+    case 2:  return i8 << 16;
+    case 3:  return i8 << 24;
+    case 4:  return i8 * 0x00010001u;
+    case 5:  return (i8 << 8) * 0x00010001u;
+    case 6:  return s8 * 0x00010001u;
+    default: return i8 * 0x01010101u;
+  }
+}
+
+//  The handler for 'in', or nullptr to leave it to State::exec()
+inline Handler handler(const Insn& in)
+{
+  // State::set() and set_gpr() discard writes to xr0 and $zero, which
+  // deps() leaves out, so look for them as xr17 and in the GPR writers
+  Insn t = in;
+  for (uint8_t* f : {&t.xra, &t.xrb, &t.xrc, &t.xrd})
+    *f = *f ? *f : 17;
+  const uint32_t def = deps(t).xr_def & ~(in.op == Op::d32add ? kCrBit : 0);
+  if (def & (kCrBit | 1u << 17))
+    return nullptr;
+  const Handler zero = nullptr;
+
+  switch (in.op) {
+    case Op::s32and:    return logic<Op::s32and>;
+    case Op::s32or:     return logic<Op::s32or>;
+    case Op::s32xor:    return logic<Op::s32xor>;
+    case Op::s32nor:    return logic<Op::s32nor>;
+    case Op::s32max:    return s32minmax<false>;
+    case Op::s32min:    return s32minmax<true>;
+    case Op::s32slt:    return s32slt;
+    case Op::s32movz:   return s32mov<false>;
+    case Op::s32movn:   return s32mov<true>;
+    case Op::d32sll:    return d32shift<0>;
+    case Op::d32slr:    return d32shift<1>;
+    case Op::d32sar:    return d32shift<2>;
+    case Op::d32add:    return d32add;
+    case Op::d32acc:    return d32acc;
+    case Op::d32asum:   return d32asum;
+    case Op::s32alni:   return s32alni;
+    case Op::s32aln:    return s32aln;
+    case Op::s32lui:    return s32lui;
+    case Op::s32i2m:    return s32i2m;
+    case Op::s32m2i:    return in.rt ? s32m2i : zero;
+    case Op::s32ldd:    return s32load<false, false, false>;
+    case Op::s32lddr:   return s32load<true,  false, false>;
+    case Op::s32ldi:    return in.rs ? s32load<false, false, true> : zero;
+    case Op::s32ldir:   return in.rs ? s32load<true,  false, true> : zero;
+    case Op::s32lddv:   return s32load<false, true,  false>;
+    case Op::s32lddvr:  return s32load<true,  true,  false>;
+    case Op::s32ldiv:   return in.rs ? s32load<false, true,  true> : zero;
+    case Op::s32ldivr:  return in.rs ? s32load<true,  true,  true> : zero;
+    case Op::s32std:    return s32store<false, false, false>;
+    case Op::s32stdr:   return s32store<true,  false, false>;
+    case Op::s32sdi:    return in.rs ? s32store<false, false, true> : zero;
+    case Op::s32sdir:   return in.rs ? s32store<true,  false, true> : zero;
+    case Op::s32stdv:   return s32store<false, true,  false>;
+    case Op::s32stdvr:  return s32store<true,  true,  false>;
+    case Op::s32sdiv:   return in.rs ? s32store<false, true,  true> : zero;
+    case Op::s32sdivr:  return in.rs ? s32store<true,  true,  true> : zero;
+#if MXU1_XLATE_SSE2
+    case Op::q8add:     return q8add;
+    case Op::q8sad:     return q8sad;
+    case Op::q8abd:     return q8abd;
+    case Op::q8max:     return q8minmax<false>;
+    case Op::q8min:     return q8minmax<true>;
+    case Op::q8avg:     return q8avg<false>;
+    case Op::q8avgr:    return q8avg<true>;
+    case Op::q8slt:     return q8slt<false>;
+    case Op::q8sltu:    return q8slt<true>;
+    case Op::q8mul:     return q8mul<false>;
+    case Op::q8mulsu:   return q8mul<true>;
+    case Op::q8mac:     return q8mac<false>;
+    case Op::q8macsu:   return q8mac<true>;
+    case Op::q8madl:    return q8madl;
+    case Op::q8adde:    return q8adde<false>;
+    case Op::q8acce:    return q8adde<true>;
+    case Op::d8sum:     return d8sum<false>;
+    case Op::d8sumc:    return d8sum<true>;
+    case Op::q16add:    return q16add;
+    case Op::q16acc:    return q16acc<false>;
+    case Op::q16accm:   return q16acc<true>;
+    case Op::d16mul:    return d16mul;
+    case Op::d16mac:    return d16mac;
+    case Op::d16max:    return d16minmax<false>;
+    case Op::d16min:    return d16minmax<true>;
+    case Op::d16avg:    return d16avg<false>;
+    case Op::d16avgr:   return d16avg<true>;
+    case Op::d16slt:    return d16slt;
+    case Op::q16sat:    return q16sat;
+    case Op::q16sll:    return q16shift<0>;
+    case Op::q16slr:    return q16shift<1>;
+    case Op::q16sar:    return q16shift<2>;
+    case Op::q16sllv:   return q16shiftv<0>;
+    case Op::q16slrv:   return q16shiftv<1>;
+    case Op::q16sarv:   return q16shiftv<2>;
+#endif
+    default:            return nullptr;
+  }
+}
+
+inline Uop translate(const Insn& in)
+{
+  Uop u;
+  u.fn  = handler(in);
+  u.op  = static_cast<uint8_t>(in.op);
+  u.a   = in.xra;  u.b = in.xrb;  u.c = in.xrc;  u.d = in.xrd;
+  u.rs  = in.rs;   u.rt = in.rt;
+  u.imm = in.imm;
+  u.k   = in.aptn;
+  switch (in.op) {
+    case Op::q8add:
+      u.k = (in.aptn & 2 ? 0xffff0000u : 0) | (in.aptn & 1 ? 0x0000ffffu : 0);
+      break;
+    case Op::q16add:  case Op::d16mul:  case Op::d16mac:
+      u.imm = in.optn;
+      break;
+    case Op::s32alni:
+      u.k = in.ptn;
+      // ptn 5..7 writes nothing
+      if (in.ptn > 4)
+        u.fn = nullptr;
+      break;
+    case Op::s32lui:
+      u.k = lui_value(in);
+      break;
+    default:
+      break;
+  }
+  return u;
+}
+
+} // namespace xlate
+
+class Translator {
+ public:
+  explicit Translator(State& st) : st_(st) {}
+  Translator(const Translator&) = delete;
+  Translator& operator=(const Translator&) = delete;
+
+  //  As State::run(words, n)
+  void run(const uint32_t* words, std::size_t n);
+
+  //  Drops every translation, e.g. when their words have been freed (a new
+  // buffer at a freed one's address is caught by the comparison anyway)
+  void flush() { blocks_.clear(); }
+
+  std::size_t blocks() const { return blocks_.size(); }
+  uint64_t    translations() const { return translations_; }
+
+ private:
+  struct Block {
+    std::vector<uint32_t>   words;
+    std::vector<Insn>       insns;
+    std::vector<xlate::Uop> uops;
+  };
+
+  //  xr0 and $zero read as zero while handlers run
+  class ZeroGuard {
+   public:
+    explicit ZeroGuard(State& st) : st_(st), xr0_(st.xr[0]), gpr0_(st.gpr[0])
+    {
+      st.xr[0] = 0;
+      st.gpr[0] = 0;
+    }
+    ~ZeroGuard()
+    {
+      st_.xr[0] = xr0_;
+      st_.gpr[0] = gpr0_;
+    }
+
+   private:
+    State&   st_;
+    uint32_t xr0_, gpr0_;
+  };
+
+  const Block& block(const uint32_t* words, std::size_t n);
+
+  State&                                           st_;
+  std::unordered_map<const uint32_t*, Block>       blocks_;
+  uint64_t                                         translations_ = 0;
+};
+
+inline const Translator::Block& Translator::block(const uint32_t* words, std::size_t n)
+{
+  Block& b = blocks_[words];
+  if (b.words.size() == n && (n == 0 || std::memcmp(b.words.data(), words, n * 4) == 0))
+    return b;
+
+  ++translations_;
+  b.words.assign(words, words + n);
+  b.insns.resize(n);
+  b.uops.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    b.insns[i] = decode(words[i]);
+    b.uops[i] = xlate::translate(b.insns[i]);
+  }
+  return b;
+}
+
+inline void Translator::run(const uint32_t* words, std::size_t n)
+{
+  const Block& b = block(words, n);
+  ZeroGuard zero(st_);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const xlate::Uop& u = b.uops[i];
+    if (u.fn && (st_.xr[16] & CR_MXU_EN)) {
+      ++st_.counts[u.op];
+      u.fn(st_, u);
+    } else if (b.insns[i].op == Op::invalid) {
+      throw Fault("not an MXU1 instruction", b.words[i]);
+    } else {
+      st_.exec(b.insns[i]);
+    }
+  }
+}
+
+} // namespace mxu1
+
+#endif // MXU1_XLATE_HPP
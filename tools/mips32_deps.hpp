@@ -0,0 +1,509 @@
+// mips32_deps.hpp
+//
+// Register def/use information for the ordinary MIPS32r2 instructions that
+// surround MXU code, from either source text or instruction words
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+//  Companion to mxu1_deps.hpp for the integer MIPS32r2 instructions a kernel
+// is built from: what each reads and writes among the GPRs and HI/LO, whether
+// it touches memory, and whether it is a branch (always with a delay slot;
+// 'likely' branches included).
+//
+// Anything not covered here (COP0, FPU arithmetic, traps to the kernel, ...)
+// is reported as unknown, and tools should treat it as a scheduling barrier.
+//
+// MIPS32 leaves HI/LO UNPREDICTABLE after 'mul', so it is counted as writing
+// them, the same way s32mul is.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MIPS32_DEPS_HPP
+#define MIPS32_DEPS_HPP
+
+#include "mxu1_deps.hpp"
+#include "mxu1_parse.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace mxu1 {
+
+// Latency classes of the plain CPU instructions, named as in latency tables
+enum class MipsClass : uint8_t {
+  alu,      // mips_alu
+  load,     // mips_load
+  store,    // mips_store
+  mul,      // mips_mul    (3-operand 'mul')
+  hilo,     // mips_hilo   (mult/madd/msub and unsigned forms)
+  div,      // mips_div
+  mfhilo,   // mips_mfhilo (mfhi/mflo/mthi/mtlo)
+  branch,   // mips_branch
+};
+
+struct MipsDeps : Deps {
+  const char* name = "";           // Mnemonic, for reports
+  MipsClass   cls  = MipsClass::alu;
+  bool        branch = false;      // Has a delay slot
+  bool        likely = false;      // Delay slot is annulled when not taken
+  bool        call   = false;      // Returns to after the delay slot
+  bool        cond   = false;      // Conditional: may fall through
+  bool        has_offset = false;  // Binary only: 'offset' is valid
+  int32_t     offset = 0;          // Branch target, in words from the delay slot
+  std::string target;              // Text only: label operand, if any
+};
+
+inline const char* class_key(MipsClass c)
+{
+  static const char* const kKey[] = {
+    "mips_alu", "mips_load", "mips_store", "mips_mul", "mips_hilo", "mips_div",
+    "mips_mfhilo", "mips_branch"
+  };
+  return kKey[static_cast<int>(c)];
+}
+
+namespace detail {
+
+// Flags for kMipsText
+enum : uint16_t {
+  MF_HI_USE = 1 << 0,
+  MF_HI_DEF = 1 << 1,
+  MF_BRANCH = 1 << 2,
+  MF_LIKELY = 1 << 3,
+  MF_CALL   = 1 << 4,   // Writes $ra
+  MF_COND   = 1 << 5,
+  MF_LOAD   = 1 << 6,
+  MF_STORE  = 1 << 7,
+};
+
+// Operand roles: 'd' GPR written, 'u' GPR read, 'b' GPR read and written,
+//  'm' memory operand 'off(base)', 'l' branch target, '-' ignored.
+struct MipsText {
+  const char* name;
+  const char* roles;
+  MipsClass   cls;
+  uint16_t    flags;
+};
+
+constexpr MipsClass kA = MipsClass::alu;
+
+static const MipsText kMipsText[] = {
+  {"nop", "", kA, 0},             {"ssnop", "", kA, 0},           {"ehb", "", kA, 0},
+  {"addu", "duu", kA, 0},         {"add", "duu", kA, 0},          {"subu", "duu", kA, 0},
+  {"sub", "duu", kA, 0},          {"and", "duu", kA, 0},          {"or", "duu", kA, 0},
+  {"xor", "duu", kA, 0},          {"nor", "duu", kA, 0},          {"slt", "duu", kA, 0},
+  {"sltu", "duu", kA, 0},         {"sllv", "duu", kA, 0},         {"srlv", "duu", kA, 0},
+  {"srav", "duu", kA, 0},         {"rotrv", "duu", kA, 0},        {"movz", "buu", kA, 0},
+  {"movn", "buu", kA, 0},         {"addiu", "du-", kA, 0},        {"addi", "du-", kA, 0},
+  {"slti", "du-", kA, 0},         {"sltiu", "du-", kA, 0},        {"andi", "du-", kA, 0},
+  {"ori", "du-", kA, 0},          {"xori", "du-", kA, 0},         {"sll", "du-", kA, 0},
+  {"srl", "du-", kA, 0},          {"sra", "du-", kA, 0},          {"rotr", "du-", kA, 0},
+  {"lui", "d-", kA, 0},           {"li", "d-", kA, 0},            {"la", "d-", kA, 0},
+  {"move", "du", kA, 0},          {"negu", "du", kA, 0},          {"neg", "du", kA, 0},
+  {"not", "du", kA, 0},           {"clz", "du", kA, 0},           {"clo", "du", kA, 0},
+  {"seb", "du", kA, 0},           {"seh", "du", kA, 0},           {"wsbh", "du", kA, 0},
+  {"ext", "du--", kA, 0},         {"ins", "bu--", kA, 0},         {"mfc1", "d-", kA, 0},
+  {"mtc1", "u-", kA, 0},          {"rdhwr", "d-", kA, 0},         {"pref", "-m", kA, 0},
+
+  {"lb", "dm", MipsClass::load, MF_LOAD},    {"lbu", "dm", MipsClass::load, MF_LOAD},
+  {"lh", "dm", MipsClass::load, MF_LOAD},    {"lhu", "dm", MipsClass::load, MF_LOAD},
+  {"lw", "dm", MipsClass::load, MF_LOAD},    {"ll", "dm", MipsClass::load, MF_LOAD},
+  {"lwl", "bm", MipsClass::load, MF_LOAD},   {"lwr", "bm", MipsClass::load, MF_LOAD},
+  {"lwc1", "-m", MipsClass::load, MF_LOAD},  {"ldc1", "-m", MipsClass::load, MF_LOAD},
+  {"sb", "um", MipsClass::store, MF_STORE},  {"sh", "um", MipsClass::store, MF_STORE},
+  {"sw", "um", MipsClass::store, MF_STORE},  {"swl", "um", MipsClass::store, MF_STORE},
+  {"swr", "um", MipsClass::store, MF_STORE}, {"sc", "bm", MipsClass::store, MF_LOAD | MF_STORE},
+  {"swc1", "-m", MipsClass::store, MF_STORE}, {"sdc1", "-m", MipsClass::store, MF_STORE},
+
+  {"mul", "duu", MipsClass::mul, MF_HI_DEF},
+  {"mult", "uu", MipsClass::hilo, MF_HI_DEF},
+  {"multu", "uu", MipsClass::hilo, MF_HI_DEF},
+  {"madd", "uu", MipsClass::hilo, MF_HI_USE | MF_HI_DEF},
+  {"maddu", "uu", MipsClass::hilo, MF_HI_USE | MF_HI_DEF},
+  {"msub", "uu", MipsClass::hilo, MF_HI_USE | MF_HI_DEF},
+  {"msubu", "uu", MipsClass::hilo, MF_HI_USE | MF_HI_DEF},
+  {"div", "uu", MipsClass::div, MF_HI_DEF},
+  {"divu", "uu", MipsClass::div, MF_HI_DEF},
+  {"mfhi", "d", MipsClass::mfhilo, MF_HI_USE},
+  {"mflo", "d", MipsClass::mfhilo, MF_HI_USE},
+  {"mthi", "u", MipsClass::mfhilo, MF_HI_DEF},
+  {"mtlo", "u", MipsClass::mfhilo, MF_HI_DEF},
+
+  {"b", "l", MipsClass::branch, MF_BRANCH},
+  {"bal", "l", MipsClass::branch, MF_BRANCH | MF_CALL},
+  {"j", "l", MipsClass::branch, MF_BRANCH},
+  {"jal", "l", MipsClass::branch, MF_BRANCH | MF_CALL},
+  {"jr", "u", MipsClass::branch, MF_BRANCH},
+  {"jr.hb", "u", MipsClass::branch, MF_BRANCH},
+  {"jalr", "u", MipsClass::branch, MF_BRANCH | MF_CALL},
+  {"jalr.hb", "u", MipsClass::branch, MF_BRANCH | MF_CALL},
+  {"beq", "uul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"bne", "uul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"beql", "uul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"bnel", "uul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"beqz", "ul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"bnez", "ul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"beqzl", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"bnezl", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"blez", "ul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"bgtz", "ul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"bltz", "ul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"bgez", "ul", MipsClass::branch, MF_BRANCH | MF_COND},
+  {"blezl", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"bgtzl", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"bltzl", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"bgezl", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_LIKELY},
+  {"bltzal", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_CALL},
+  {"bgezal", "ul", MipsClass::branch, MF_BRANCH | MF_COND | MF_CALL},
+};
+
+inline void set_hilo_mem(MipsDeps& d, uint16_t f)
+{
+  d.hilo_use = (f & MF_HI_USE) != 0;
+  d.hilo_def = (f & MF_HI_DEF) != 0;
+  d.load     = (f & MF_LOAD) != 0;
+  d.store    = (f & MF_STORE) != 0;
+  d.branch   = (f & MF_BRANCH) != 0;
+  d.likely   = (f & MF_LIKELY) != 0;
+  d.call     = (f & MF_CALL) != 0;
+  d.cond     = (f & MF_COND) != 0;
+  if (d.call)
+    d.gpr_def |= 1u << 31;
+}
+
+} // namespace detail
+
+// Def/use of one MIPS statement as written in source. Returns false if the
+//  mnemonic is not known here. GPR operands that are not registers (an
+//  immediate given to a register-form mnemonic, say) are ignored, as GAS
+//  would turn those into the immediate form.
+inline bool mips_deps(const std::string& mnemonic, const std::string& operands, MipsDeps& out)
+{
+  using namespace detail;
+  const MipsText* t = nullptr;
+  for (const MipsText& e : kMipsText) {
+    if (mnemonic == e.name) {
+      t = &e;
+      break;
+    }
+  }
+  if (!t)
+    return false;
+
+  MipsDeps d;
+  d.name = t->name;
+  d.cls = t->cls;
+  set_hilo_mem(d, t->flags);
+
+  std::vector<std::string> a = split_operands(operands);
+  std::string roles = t->roles;
+  // 'div $zero, rs, rt' is the explicit form of 'div rs, rt'
+  if ((d.cls == MipsClass::div || d.cls == MipsClass::hilo) && a.size() == 3 && parse_gpr(a[0]) == 0)
+    a.erase(a.begin());
+  // 'addu rd, rt' means 'addu rd, rd, rt'
+  if (a.size() + 1 == roles.size() && roles[0] == 'd' && roles[1] == 'u')
+    roles[0] = 'b', roles.erase(1, 1);
+  // 'jalr rs' links to $ra, 'jalr rd, rs' to rd
+  if (t->flags & MF_CALL && t->roles[0] == 'u' && a.size() == 2) {
+    d.gpr_def &= ~(1u << 31);
+    roles = "du";
+  }
+
+  for (std::size_t i = 0; i < a.size() && i < roles.size(); ++i) {
+    const int r = parse_gpr(a[i]);
+    switch (roles[i]) {
+      case 'd':
+        if (r >= 0) d.gpr_def |= 1u << r;
+        break;
+      case 'u':
+        if (r >= 0) d.gpr_use |= 1u << r;
+        break;
+      case 'b':
+        if (r >= 0) d.gpr_use |= 1u << r, d.gpr_def |= 1u << r;
+        break;
+      case 'm': {
+        const std::size_t lp = a[i].rfind('('), rp = a[i].rfind(')');
+        if (lp != std::string::npos && rp != std::string::npos && rp > lp) {
+          const int base = parse_gpr(a[i].substr(lp + 1, rp - lp - 1));
+          if (base >= 0)
+            d.gpr_use |= 1u << base;
+        }
+        break;
+      }
+      case 'l':
+        // 'j $reg' is really 'jr $reg'
+        if (r >= 0)
+          d.gpr_use |= 1u << r;
+        else
+          d.target = a[i];
+        break;
+    }
+  }
+  d.gpr_use &= ~1u;  d.gpr_def &= ~1u;
+  out = d;
+  return true;
+}
+
+// Def/use of one MIPS32r2 instruction word that is not an MXU instruction.
+//  Returns false if it is not recognized here.
+inline bool mips_deps(uint32_t w, MipsDeps& out)
+{
+  using namespace detail;
+  const unsigned op = w >> 26, rs = (w >> 21) & 31, rt = (w >> 16) & 31, rd = (w >> 11) & 31;
+  const unsigned fn = w & 63;
+  const uint32_t RS = 1u << rs, RT = 1u << rt, RD = 1u << rd;
+  const int32_t off16 = static_cast<int16_t>(w & 0xffff);
+  MipsDeps d;
+
+  auto alu = [&](const char* n, uint32_t def, uint32_t use) {
+    d.name = n;  d.gpr_def = def;  d.gpr_use = use;
+  };
+  auto br = [&](const char* n, uint32_t use, uint16_t f) {
+    d.name = n;  d.cls = MipsClass::branch;  d.gpr_use = use;
+    set_hilo_mem(d, static_cast<uint16_t>(f | MF_BRANCH));
+    d.has_offset = true;  d.offset = off16;
+  };
+  auto mem = [&](const char* n, MipsClass c, uint32_t def, uint32_t use, uint16_t f) {
+    d.name = n;  d.cls = c;  d.gpr_def = def;  d.gpr_use = use;
+    set_hilo_mem(d, f);
+  };
+
+  switch (op) {
+    case 0:   // SPECIAL
+      switch (fn) {
+        case 0x00: alu(w == 0 ? "nop" : "sll", RD, RT); break;
+        case 0x02: alu(rs & 1 ? "rotr" : "srl", RD, RT); break;
+        case 0x03: alu("sra", RD, RT); break;
+        case 0x04: alu("sllv", RD, RT | RS); break;
+        case 0x06: alu((w >> 6) & 1 ? "rotrv" : "srlv", RD, RT | RS); break;
+        case 0x07: alu("srav", RD, RT | RS); break;
+        case 0x08:
+          br("jr", RS, 0);  d.has_offset = false;
+          break;
+        case 0x09:
+          br("jalr", RS, 0);  d.has_offset = false;  d.call = true;  d.gpr_def = RD;
+          break;
+        case 0x0a: alu("movz", RD, RD | RS | RT); break;
+        case 0x0b: alu("movn", RD, RD | RS | RT); break;
+        case 0x0f: alu("sync", 0, 0); break;
+        case 0x10: mem("mfhi", MipsClass::mfhilo, RD, 0, MF_HI_USE); break;
+        case 0x11: mem("mthi", MipsClass::mfhilo, 0, RS, MF_HI_DEF); break;
+        case 0x12: mem("mflo", MipsClass::mfhilo, RD, 0, MF_HI_USE); break;
+        case 0x13: mem("mtlo", MipsClass::mfhilo, 0, RS, MF_HI_DEF); break;
+        case 0x18: mem("mult", MipsClass::hilo, 0, RS | RT, MF_HI_DEF); break;
+        case 0x19: mem("multu", MipsClass::hilo, 0, RS | RT, MF_HI_DEF); break;
+        case 0x1a: mem("div", MipsClass::div, 0, RS | RT, MF_HI_DEF); break;
+        case 0x1b: mem("divu", MipsClass::div, 0, RS | RT, MF_HI_DEF); break;
+        case 0x20: alu("add", RD, RS | RT); break;
+        case 0x21: alu("addu", RD, RS | RT); break;
+        case 0x22: alu("sub", RD, RS | RT); break;
+        case 0x23: alu("subu", RD, RS | RT); break;
+        case 0x24: alu("and", RD, RS | RT); break;
+        case 0x25: alu("or", RD, RS | RT); break;
+        case 0x26: alu("xor", RD, RS | RT); break;
+        case 0x27: alu("nor", RD, RS | RT); break;
+        case 0x2a: alu("slt", RD, RS | RT); break;
+        case 0x2b: alu("sltu", RD, RS | RT); break;
+        default:   return false;   // syscall, break, traps
+      }
+      break;
+    case 1:   // REGIMM
+      switch (rt) {
+        case 0x00: br("bltz", RS, MF_COND); break;
+        case 0x01: br("bgez", RS, MF_COND); break;
+        case 0x02: br("bltzl", RS, MF_COND | MF_LIKELY); break;
+        case 0x03: br("bgezl", RS, MF_COND | MF_LIKELY); break;
+        case 0x10: br("bltzal", RS, MF_COND | MF_CALL); break;
+        case 0x11: br(rs ? "bgezal" : "bal", RS, (rs ? MF_COND : 0) | MF_CALL); break;
+        default:   return false;
+      }
+      break;
+    case 2: br("j", 0, 0);  d.has_offset = false;  break;
+    case 3: br("jal", 0, MF_CALL);  d.has_offset = false;  break;
+    case 4: br(rs == 0 && rt == 0 ? "b" : "beq", RS | RT, rs == 0 && rt == 0 ? 0 : MF_COND); break;
+    case 5: br("bne", RS | RT, MF_COND); break;
+    case 6: br("blez", RS, MF_COND); break;
+    case 7: br("bgtz", RS, MF_COND); break;
+    case 8: alu("addi", RT, RS); break;
+    case 9: alu("addiu", RT, RS); break;
+    case 10: alu("slti", RT, RS); break;
+    case 11: alu("sltiu", RT, RS); break;
+    case 12: alu("andi", RT, RS); break;
+    case 13: alu("ori", RT, RS); break;
+    case 14: alu("xori", RT, RS); break;
+    case 15: alu("lui", RT, 0); break;
+    case 17:  // COP1 register moves only
+      if (rs == 0) alu("mfc1", RT, 0);
+      else if (rs == 4) alu("mtc1", 0, RT);
+      else return false;
+      break;
+    case 20: br("beql", RS | RT, MF_COND | MF_LIKELY); break;
+    case 21: br("bnel", RS | RT, MF_COND | MF_LIKELY); break;
+    case 22: br("blezl", RS, MF_COND | MF_LIKELY); break;
+    case 23: br("bgtzl", RS, MF_COND | MF_LIKELY); break;
+    case 28:  // SPECIAL2, for the words decode() did not claim as MXU
+      switch (fn) {
+        case 0x00: mem("madd", MipsClass::hilo, 0, RS | RT, MF_HI_USE | MF_HI_DEF); break;
+        case 0x01: mem("maddu", MipsClass::hilo, 0, RS | RT, MF_HI_USE | MF_HI_DEF); break;
+        case 0x02: mem("mul", MipsClass::mul, RD, RS | RT, MF_HI_DEF); break;
+        case 0x04: mem("msub", MipsClass::hilo, 0, RS | RT, MF_HI_USE | MF_HI_DEF); break;
+        case 0x05: mem("msubu", MipsClass::hilo, 0, RS | RT, MF_HI_USE | MF_HI_DEF); break;
+        case 0x20: alu("clz", RD, RS); break;
+        case 0x21: alu("clo", RD, RS); break;
+        default:   return false;
+      }
+      break;
+    case 31:  // SPECIAL3
+      switch (fn) {
+        case 0x00: alu("ext", RT, RS); break;
+        case 0x04: alu("ins", RT, RS | RT); break;
+        case 0x20:
+          if (((w >> 6) & 31) == 0x02) alu("wsbh", RD, RT);
+          else if (((w >> 6) & 31) == 0x10) alu("seb", RD, RT);
+          else if (((w >> 6) & 31) == 0x18) alu("seh", RD, RT);
+          else return false;
+          break;
+        case 0x3b: alu("rdhwr", RT, 0); break;
+        default:   return false;
+      }
+      break;
+    case 32: mem("lb", MipsClass::load, RT, RS, MF_LOAD); break;
+    case 33: mem("lh", MipsClass::load, RT, RS, MF_LOAD); break;
+    case 34: mem("lwl", MipsClass::load, RT, RS | RT, MF_LOAD); break;
+    case 35: mem("lw", MipsClass::load, RT, RS, MF_LOAD); break;
+    case 36: mem("lbu", MipsClass::load, RT, RS, MF_LOAD); break;
+    case 37: mem("lhu", MipsClass::load, RT, RS, MF_LOAD); break;
+    case 38: mem("lwr", MipsClass::load, RT, RS | RT, MF_LOAD); break;
+    case 40: mem("sb", MipsClass::store, 0, RS | RT, MF_STORE); break;
+    case 41: mem("sh", MipsClass::store, 0, RS | RT, MF_STORE); break;
+    case 42: mem("swl", MipsClass::store, 0, RS | RT, MF_STORE); break;
+    case 43: mem("sw", MipsClass::store, 0, RS | RT, MF_STORE); break;
+    case 46: mem("swr", MipsClass::store, 0, RS | RT, MF_STORE); break;
+    case 48: mem("ll", MipsClass::load, RT, RS, MF_LOAD); break;
+    case 49: mem("lwc1", MipsClass::load, 0, RS, MF_LOAD); break;
+    case 51: alu("pref", 0, RS); break;
+    case 53: mem("ldc1", MipsClass::load, 0, RS, MF_LOAD); break;
+    case 56: mem("sc", MipsClass::store, RT, RS | RT, MF_LOAD | MF_STORE); break;
+    case 57: mem("swc1", MipsClass::store, 0, RS, MF_STORE); break;
+    case 61: mem("sdc1", MipsClass::store, 0, RS, MF_STORE); break;
+    default:
+      return false;
+  }
+  d.gpr_use &= ~1u;  d.gpr_def &= ~1u;
+  out = d;
+  return true;
+}
+
+// Operands of an instruction word mips_deps() recognizes, as objdump writes
+//  them ("$v0, 8($sp)"), for reports; a branch target as an address, with
+//  the word at 'addr'. Empty if there are none or the word is not known.
+inline std::string mips_operands(uint32_t w, uint32_t addr)
+{
+  // Operand layouts: R rd,rs,rt  V rd,rt,rs  S rd,rt,sa  H rs,rt  D rd
+  //  U rs  C rd,rs  E rd,rt  I rt,rs,simm  X rt,rs,uimm  L rt,uimm
+  //  M rt,off(rs)  F $ft,off(rs)  P hint,off(rs)  1 rs,target
+  //  2 rs,rt,target  B target  J jump target  Q jalr  T ext  N ins
+  //  W rdhwr  C1 mfc1/mtc1 (Z)
+  static const struct {
+    const char* name;
+    char        layout;
+  } kLayout[] = {
+    {"add", 'R'},   {"addu", 'R'},  {"sub", 'R'},   {"subu", 'R'},  {"and", 'R'},
+    {"or", 'R'},    {"xor", 'R'},   {"nor", 'R'},   {"slt", 'R'},   {"sltu", 'R'},
+    {"movz", 'R'},  {"movn", 'R'},  {"mul", 'R'},   {"sllv", 'V'},  {"srlv", 'V'},
+    {"srav", 'V'},  {"rotrv", 'V'}, {"sll", 'S'},   {"srl", 'S'},   {"sra", 'S'},
+    {"rotr", 'S'},  {"mult", 'H'},  {"multu", 'H'}, {"div", 'H'},   {"divu", 'H'},
+    {"madd", 'H'},  {"maddu", 'H'}, {"msub", 'H'},  {"msubu", 'H'}, {"mfhi", 'D'},
+    {"mflo", 'D'},  {"mthi", 'U'},  {"mtlo", 'U'},  {"jr", 'U'},    {"jalr", 'Q'},
+    {"clz", 'C'},   {"clo", 'C'},   {"seb", 'E'},   {"seh", 'E'},   {"wsbh", 'E'},
+    {"addi", 'I'},  {"addiu", 'I'}, {"slti", 'I'},  {"sltiu", 'I'}, {"andi", 'X'},
+    {"ori", 'X'},   {"xori", 'X'},  {"lui", 'L'},   {"ext", 'T'},   {"ins", 'N'},
+    {"rdhwr", 'W'}, {"mfc1", 'Z'},  {"mtc1", 'Z'},  {"pref", 'P'},  {"lwc1", 'F'},
+    {"ldc1", 'F'},  {"swc1", 'F'},  {"sdc1", 'F'},  {"bltz", '1'},  {"bgez", '1'},
+    {"bltzl", '1'}, {"bgezl", '1'}, {"bltzal", '1'}, {"bgezal", '1'}, {"blez", '1'},
+    {"bgtz", '1'},  {"blezl", '1'}, {"bgtzl", '1'}, {"beq", '2'},   {"bne", '2'},
+    {"beql", '2'},  {"bnel", '2'},  {"b", 'B'},     {"bal", 'B'},   {"j", 'J'},
+    {"jal", 'J'},
+  };
+  MipsDeps d;
+  if (!mips_deps(w, d))
+    return "";
+  char layout = 0;
+  for (const auto& l : kLayout)
+    if (!std::strcmp(l.name, d.name))
+      layout = l.layout;
+  if (!layout && (d.cls == MipsClass::load || d.cls == MipsClass::store))
+    layout = 'M';
+
+  const char* rs = kGprName[(w >> 21) & 31];
+  const char* rt = kGprName[(w >> 16) & 31];
+  const char* rd = kGprName[(w >> 11) & 31];
+  const unsigned rdn = (w >> 11) & 31, sa = (w >> 6) & 31, ft = (w >> 16) & 31;
+  const int32_t simm = static_cast<int16_t>(w & 0xffff);
+  const unsigned uimm = w & 0xffff;
+  const uint32_t target = addr + 4 + static_cast<uint32_t>(simm) * 4;
+  char buf[64];
+
+  switch (layout) {
+    case 'R': std::snprintf(buf, sizeof(buf), "%s, %s, %s", rd, rs, rt); break;
+    case 'V': std::snprintf(buf, sizeof(buf), "%s, %s, %s", rd, rt, rs); break;
+    case 'S': std::snprintf(buf, sizeof(buf), "%s, %s, %u", rd, rt, sa); break;
+    case 'H': std::snprintf(buf, sizeof(buf), "%s, %s", rs, rt); break;
+    case 'D': std::snprintf(buf, sizeof(buf), "%s", rd); break;
+    case 'U': std::snprintf(buf, sizeof(buf), "%s", rs); break;
+    case 'Q':
+      if (rdn == 31) std::snprintf(buf, sizeof(buf), "%s", rs);
+      else std::snprintf(buf, sizeof(buf), "%s, %s", rd, rs);
+      break;
+    case 'C': std::snprintf(buf, sizeof(buf), "%s, %s", rd, rs); break;
+    case 'E': std::snprintf(buf, sizeof(buf), "%s, %s", rd, rt); break;
+    case 'I': std::snprintf(buf, sizeof(buf), "%s, %s, %d", rt, rs, simm); break;
+    case 'X': std::snprintf(buf, sizeof(buf), "%s, %s, 0x%x", rt, rs, uimm); break;
+    case 'L': std::snprintf(buf, sizeof(buf), "%s, 0x%x", rt, uimm); break;
+    case 'T': std::snprintf(buf, sizeof(buf), "%s, %s, %u, %u", rt, rs, sa, rdn + 1); break;
+    case 'N':
+      std::snprintf(buf, sizeof(buf), "%s, %s, %u, %d", rt, rs, sa, static_cast<int>(rdn + 1) - static_cast<int>(sa));
+      break;
+    case 'W': std::snprintf(buf, sizeof(buf), "%s, $%u", rt, rdn); break;
+    case 'Z': std::snprintf(buf, sizeof(buf), "%s, $f%u", rt, rdn); break;
+    case 'M': std::snprintf(buf, sizeof(buf), "%s, %d(%s)", rt, simm, rs); break;
+    case 'F': std::snprintf(buf, sizeof(buf), "$f%u, %d(%s)", ft, simm, rs); break;
+    case 'P': std::snprintf(buf, sizeof(buf), "%u, %d(%s)", ft, simm, rs); break;
+    case '1': std::snprintf(buf, sizeof(buf), "%s, 0x%x", rs, target); break;
+    case '2': std::snprintf(buf, sizeof(buf), "%s, %s, 0x%x", rs, rt, target); break;
+    case 'B': std::snprintf(buf, sizeof(buf), "0x%x", target); break;
+    case 'J':
+      std::snprintf(buf, sizeof(buf), "0x%x", ((addr + 4) & 0xf0000000u) | ((w & 0x3ffffff) << 2));
+      break;
+    default:  return "";   // nop, sync
+  }
+  return buf;
+}
+
+} // namespace mxu1
+
+#endif // MIPS32_DEPS_HPP
@@ -0,0 +1,398 @@
+// mxu1_dis.cpp
+//
+// MXU1-aware filter for objdump / perf annotate output, and raw image dumper
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+// Build:  c++ -std=c++14 -O2 -I.. -o mxu1_dis mxu1_dis.cpp
+//
+// Usage:
+//   mipsel-linux-gnu-objdump -d prog | mxu1_dis
+//   perf annotate --stdio --asm-raw  | mxu1_dis
+//   mxu1_dis -b firmware.bin [-a 0x80010000]
+//   mxu1_dis --self-test [-I DIR]
+//
+//  As a filter, every line is passed through unchanged except where it holds
+// an MXU instruction word, which is then rewritten in mxu1_as_macros.s.h
+// syntax. Two forms are recognized:
+//  1.) '.word 0x7.......' anywhere in the line (what binutils and perf print
+//      for SPECIAL2 words they do not know).
+//  2.) A raw instruction column, i.e. 'addr:' followed by an 8-digit hex word,
+//      as objdump -d and perf --asm-raw print (perf's ' 0.00 :' percentage
+//      column before the address is skipped). This also catches MXU words
+//      that stock binutils mis-decodes as some other SPECIAL2 instruction.
+//
+//  With -b, a raw little-endian image is disassembled directly, one word per
+// line, non-MXU words shown as '.word'.
+//
+//  --self-test checks the disassembly against the GAS macros: it prints
+// samples of every opcode in mxu1_isa.hpp (all operand fields zero, all at
+// their largest, and random legal values), assembles them with
+// mxu1_as_macros.s.h (found in DIR, default '..') and compares the words in
+// the object's .text with the ones printed. The assembler command is $MXU1_AS,
+// default 'mipsel-linux-gnu-as -mips32r2'; it is run as '$MXU1_AS -I DIR -o
+// OUT.o IN.s', which llvm-mc also accepts (MXU1_AS='llvm-mc -triple=mipsel
+// -mcpu=mips32r2 -filetype=obj').
+// Exits with status 1 if any word differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_disasm.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+int hexval(char ch)
+{
+  if (ch >= '0' && ch <= '9') return ch - '0';
+  if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+  if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+  return -1;
+}
+
+bool is_space(char ch) { return ch == ' ' || ch == '\t'; }
+
+// Parse exactly 8 hex digits at 'p' not followed by another hex digit
+bool hex8(const char* p, const char* end, uint32_t& out)
+{
+  if (end - p < 8)
+    return false;
+  uint32_t v = 0;
+  for (int i = 0; i < 8; ++i) {
+    const int h = hexval(p[i]);
+    if (h < 0)
+      return false;
+    v = (v << 4) | static_cast<uint32_t>(h);
+  }
+  if (end - p > 8 && hexval(p[8]) >= 0)
+    return false;
+  out = v;
+  return true;
+}
+
+// Form 1: '.word' <ws> '0x' <8 hex>. Sets [b,e) to the span to replace.
+bool find_dot_word(const char* s, const char* end, uint32_t& w, const char*& b, const char*& e)
+{
+  for (const char* p = s; end - p >= 6; ++p) {
+    p = static_cast<const char*>(std::memchr(p, '.', static_cast<std::size_t>(end - p)));
+    if (!p)
+      return false;
+    if (end - p < 6 || std::memcmp(p, ".word", 5) != 0 || !is_space(p[5]))
+      continue;
+    const char* q = p + 5;
+    while (q < end && is_space(*q))
+      ++q;
+    if (end - q > 2 && q[0] == '0' && (q[1] == 'x' || q[1] == 'X') && hex8(q + 2, end, w)) {
+      b = p;
+      e = q + 10;
+      return true;
+    }
+  }
+  return false;
+}
+
+// After an address's colon: <ws> <8 hex> <ws>. Sets 'b' past them.
+bool raw_word(const char* p, const char* end, uint32_t& w, const char*& b)
+{
+  if (p == end || !is_space(*p))
+    return false;
+  while (p < end && is_space(*p))
+    ++p;
+  if (!hex8(p, end, w))
+    return false;
+  p += 8;
+  if (p == end || !is_space(*p))
+    return false;
+  while (p < end && is_space(*p))
+    ++p;
+  b = p;
+  return true;
+}
+
+// Form 2: <hex> ':' <ws> <8 hex> <ws> <old text>, the address a whole word.
+//  Sets 'b' to the old text. The first such colon counts, so perf's leading
+//  '<percent> :' column (not preceded by a hex word) is passed over.
+bool find_raw_column(const char* s, const char* end, uint32_t& w, const char*& b)
+{
+  for (const char* colon = s; (colon = static_cast<const char*>(
+                                   std::memchr(colon, ':', static_cast<std::size_t>(end - colon)))) != nullptr;
+       ++colon) {
+    const char* a = colon;
+    while (a > s && hexval(a[-1]) >= 0)
+      --a;
+    if (a == colon || (a > s && !is_space(a[-1])))
+      continue;
+    if (raw_word(colon + 1, end, w, b))
+      return true;
+  }
+  return false;
+}
+
+void filter(FILE* in, FILE* out)
+{
+  std::vector<char> line(4096);
+  char text[mxu1::kDisasmMax];
+
+  while (std::fgets(line.data(), static_cast<int>(line.size()), in)) {
+    std::size_t len = std::strlen(line.data());
+    // Grow for very long lines rather than splitting them
+    while (len == line.size() - 1 && line[len - 1] != '\n') {
+      line.resize(line.size() * 2);
+      if (!std::fgets(line.data() + len, static_cast<int>(line.size() - len), in))
+        break;
+      len += std::strlen(line.data() + len);
+    }
+    const char* s = line.data();
+    const char* end = s + len;
+    const bool nl = len && end[-1] == '\n';
+    if (nl)
+      --end;
+
+    uint32_t w;
+    const char* b;
+    const char* e;
+    mxu1::Insn insn;
+    if (find_dot_word(s, end, w, b, e) && (insn = mxu1::decode(w)).op != mxu1::Op::invalid) {
+      mxu1::format(insn, text);
+      std::fwrite(s, 1, static_cast<std::size_t>(b - s), out);
+      std::fputs(text, out);
+      std::fwrite(e, 1, static_cast<std::size_t>(end - e), out);
+    } else if (find_raw_column(s, end, w, b) && (insn = mxu1::decode(w)).op != mxu1::Op::invalid) {
+      mxu1::format(insn, text);
+      std::fwrite(s, 1, static_cast<std::size_t>(b - s), out);
+      std::fputs(text, out);
+    } else {
+      std::fwrite(s, 1, static_cast<std::size_t>(end - s), out);
+    }
+    if (nl)
+      std::fputc('\n', out);
+  }
+}
+
+int dump_image(const char* path, uint32_t base, FILE* out)
+{
+  FILE* f = std::fopen(path, "rb");
+  if (!f) {
+    std::perror(path);
+    return 1;
+  }
+  std::vector<unsigned char> buf(1 << 20);
+  char text[mxu1::kDisasmMax];
+  uint32_t addr = base;
+  std::size_t n;
+  while ((n = std::fread(buf.data(), 1, buf.size(), f)) >= 4) {
+    for (std::size_t i = 0; i + 4 <= n; i += 4, addr += 4) {
+      const uint32_t w = buf[i] | (buf[i + 1] << 8) | (buf[i + 2] << 16) |
+                         (static_cast<uint32_t>(buf[i + 3]) << 24);
+      mxu1::format(w, text);
+      std::fprintf(out, "%8x:\t%08x \t%s\n", addr, w, text);
+    }
+    if (n < buf.size())
+      break;
+  }
+  std::fclose(f);
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// --self-test
+////////////////////////////////////////////////////////////////////////////////
+
+// The words of the .text section of an ELF32 object, or false
+bool read_text(const char* path, std::vector<uint32_t>& words)
+{
+  FILE* f = std::fopen(path, "rb");
+  if (!f)
+    return false;
+  std::vector<unsigned char> img;
+  unsigned char buf[65536];
+  std::size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    img.insert(img.end(), buf, buf + n);
+  std::fclose(f);
+  if (img.size() < 52 || std::memcmp(img.data(), "\x7f" "ELF", 4) != 0 || img[4] != 1)
+    return false;
+  const bool be = img[5] == 2;
+  auto u16 = [&](std::size_t o) -> uint32_t {
+    return be ? (img[o] << 8) | img[o + 1] : img[o] | (img[o + 1] << 8);
+  };
+  auto u32 = [&](std::size_t o) -> uint32_t {
+    return be ? (u16(o) << 16) | u16(o + 2) : u16(o) | (u16(o + 2) << 16);
+  };
+  const uint32_t shoff = u32(32), shentsize = u16(46), shnum = u16(48), shstrndx = u16(50);
+  if (shstrndx >= shnum || shoff + static_cast<uint64_t>(shnum) * shentsize > img.size())
+    return false;
+  const uint32_t strtab = u32(shoff + shstrndx * shentsize + 16);
+  for (uint32_t i = 0; i < shnum; ++i) {
+    const std::size_t h = shoff + i * shentsize;
+    const uint32_t name = strtab + u32(h), off = u32(h + 16), size = u32(h + 20);
+    if (name + 6 > img.size() || std::memcmp(&img[name], ".text", 6) != 0)
+      continue;
+    if (static_cast<uint64_t>(off) + size > img.size())
+      return false;
+    for (uint32_t o = 0; o + 4 <= size; o += 4)
+      words.push_back(u32(off + o));
+    return true;
+  }
+  return false;
+}
+
+std::string shell_quote(const std::string& s)
+{
+  std::string q = "'";
+  for (char ch : s)
+    q += ch == '\'' ? std::string("'\\''") : std::string(1, ch);
+  return q + "'";
+}
+
+int self_test(const std::string& dir)
+{
+  // Samples of each opcode: fields all zero, all ones, then random, each
+  // kept only if it is a legal encoding of that opcode
+  std::vector<uint32_t> words;
+  std::size_t covered = 0;
+  uint32_t rng = 12345;
+  for (std::size_t i = 0; i < mxu1::kNumOps; ++i) {
+    const mxu1::OpInfo& oi = mxu1::kOpInfo[i];
+    const uint32_t mask = mxu1::field_mask(oi.fmt);
+    std::size_t kept = 0;
+    for (int k = 0; k < 256 && kept < 16; ++k) {
+      rng = rng * 1103515245u + 12345u;
+      const uint32_t r = k == 0 ? 0 : k == 1 ? ~0u : rng ^ (rng << 15) ^ (rng >> 11);
+      const uint32_t w = oi.word | (r & mask);
+      const mxu1::Insn in = mxu1::decode(w);
+      if (in.op != static_cast<mxu1::Op>(i) || mxu1::encode(in) != w)
+        continue;
+      words.push_back(w);
+      ++kept;
+    }
+    covered += kept != 0;
+    if (!kept)
+      std::fprintf(stderr, "%s: no legal encoding found\n", oi.name);
+  }
+
+  const char* tmp = std::getenv("TMPDIR");
+  std::string base = std::string(tmp && *tmp ? tmp : "/tmp") + "/mxu1_dis.XXXXXX";
+  std::vector<char> path(base.begin(), base.end());
+  path.push_back('\0');
+  if (!mkdtemp(path.data())) {
+    std::perror("mkdtemp");
+    return 2;
+  }
+  const std::string work = path.data(), src = work + "/t.s", obj = work + "/t.o";
+  FILE* f = std::fopen(src.c_str(), "w");
+  if (!f) {
+    std::perror(src.c_str());
+    return 2;
+  }
+  std::fprintf(f, "  .include \"mxu1_as_macros.s.h\"\n  .text\n  .set noreorder\n");
+  char text[mxu1::kDisasmMax];
+  for (uint32_t w : words) {
+    mxu1::format(w, text);
+    std::fprintf(f, "  %s\n", text);
+  }
+  std::fclose(f);
+
+  const char* as = std::getenv("MXU1_AS");
+  const std::string cmd = std::string(as && *as ? as : "mipsel-linux-gnu-as -mips32r2") + " -I " +
+                          shell_quote(dir) + " -o " + shell_quote(obj) + " " + shell_quote(src);
+  std::vector<uint32_t> got;
+  const bool built = std::system(cmd.c_str()) == 0 && read_text(obj.c_str(), got);
+  std::remove(obj.c_str());
+  if (!built) {
+    std::fprintf(stderr, "self-test: '%s' failed (input kept in %s)\n", cmd.c_str(), src.c_str());
+    return 2;
+  }
+  std::remove(src.c_str());
+  rmdir(work.c_str());
+
+  int bad = 0;
+  for (std::size_t i = 0; i < words.size(); ++i) {
+    mxu1::format(words[i], text);
+    if (i >= got.size() || got[i] != words[i]) {
+      if (i < got.size())
+        std::printf("%-40s assembles to 0x%08x, not 0x%08x\n", text, got[i], words[i]);
+      else
+        std::printf("%-40s missing from the object\n", text);
+      ++bad;
+    }
+  }
+  if (got.size() > words.size()) {
+    std::printf("%zu extra words in the object\n", got.size() - words.size());
+    ++bad;
+  }
+  std::printf("self-test: %zu instructions, %zu of %zu opcodes, %d wrong\n", words.size(), covered,
+              mxu1::kNumOps, bad);
+  return bad || covered != mxu1::kNumOps ? 1 : 0;
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr,
+               "usage: %s                  (filter objdump/perf text, stdin -> stdout)\n"
+               "       %s -b IMAGE [-a ADDR] (disassemble a raw little-endian image)\n"
+               "       %s --self-test [-I DIR] (round trip through mxu1_as_macros.s.h)\n",
+               argv0, argv0, argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  static char outbuf[1 << 16];
+  std::setvbuf(stdout, outbuf, _IOFBF, sizeof(outbuf));
+
+  const char* image = nullptr;
+  const char* dir = "..";
+  bool test = false;
+  uint32_t base = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--self-test")) {
+      test = true;
+    } else if (!std::strcmp(argv[i], "-I") && i + 1 < argc) {
+      dir = argv[++i];
+    } else if (!std::strcmp(argv[i], "-b") && i + 1 < argc) {
+      image = argv[++i];
+    } else if (!std::strcmp(argv[i], "-a") && i + 1 < argc) {
+      base = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (test)
+    return self_test(dir);
+  if (image)
+    return dump_image(image, base, stdout);
+  filter(stdin, stdout);
+  return 0;
+}
@@ -0,0 +1,1501 @@
+// mxu1_hazard.cpp
+//
+// Static pipeline hazard and stall estimator for MXU kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+// Build:  c++ -std=c++14 -O2 -I.. -o mxu1_hazard mxu1_hazard.cpp
+//
+// Usage:
+//   mxu1_hazard [options] FILE...
+//
+//   FILE is a .s file, a .S file (run through the C preprocessor first), or
+//   an ELF32 MIPS object/executable (recognized by its magic, and analyzed
+//   section by section with its symbols as labels). '-' reads .s from stdin.
+//
+//   -l FILE          Latency table to use instead of the built-in estimates
+//   --dump-latencies Print the latency table in effect, in -l format, and exit
+//   -I DIR, -D SYM   Passed on to the preprocessor for .S files; -I also
+//                    searched by .include
+//   -v               Report every block, not only those that stall
+//   --max-stalls N   Exit with status 1 if the total stall estimate exceeds N,
+//                    for use as a CI gate
+//
+//  Every MXU macro invocation and ordinary MIPS32r2 instruction is turned
+// into def/use sets over xr0..xr16 (xr16 is MXU_CR), the 32 GPRs and HI/LO,
+// via mxu1_deps.hpp and mips32_deps.hpp. Code is split into basic blocks at
+// labels, branch targets and after each branch's delay slot, and each block
+// is run through a simple in-order, single-issue pipeline model: an
+// instruction issues once its operands are ready and its unit can accept it,
+// and every cycle it waits beyond the one after its predecessor is a stall.
+// A block that branches back to its own first label is treated as a loop and
+// simulated twice, so the reported figures are the steady state, including
+// latencies carried around the back edge.
+//
+//  For each stall the producing instruction is named, and later instructions
+// in the same block that could legally be hoisted into the gap are suggested.
+// Each block is also list-scheduled under the same model, and the cycle count
+// that reordering would give is shown when it is better.
+//
+// Latency table format (one entry per line, '#' comments):
+//   <key> <latency> [<issue interval>]
+// where <key> is a mnemonic (q8sad, s32ldi, lw...) or one of the class keys
+// below; mnemonics take precedence over classes. Latency is the number of
+// cycles until a consumer can issue without stalling (1 = back-to-back), and
+// the issue interval is the minimum distance between two instructions of the
+// same key (1 = fully pipelined). Unlisted keys keep their defaults.
+//
+//   mxu_alu mxu_mul mxu_hilo mxu_xfer mxu_load mxu_store
+//   mips_alu mips_load mips_store mips_mul mips_hilo mips_div mips_mfhilo
+//   mips_branch
+//
+//  The built-in values are estimates for XBurst1 rather than measurements,
+// so measure the actual core and pass the result with -l where the numbers
+// matter. Base register updates of s32ldi and friends are always ready on the
+// next cycle.
+//
+//  Source is expanded the way GAS would before the analysis: .macro
+// definitions (the file's own, and those of files it .includes from its
+// directory or the -I directories, mxu_save_context and the like), .irp,
+// .irpc and .rept, the .if family, and .equ/.set symbols, so constant
+// expressions in operands are folded. Any statement still not known as an
+// instruction acts as a barrier that splits the block and drains the
+// pipeline; those, and conditions that cannot be evaluated (taken as false),
+// are counted as unknown in the summary. li and la take the two words GAS
+// gives them when the value needs both halves or is a symbol, as do loads
+// and stores of a bare symbol (the profiling counters). An object file
+// shows exactly what the assembler emitted, with plain MIPS instructions
+// decoded to their operands; data objects (STT_OBJECT symbols, such as a
+// constant table in .text) are skipped, their labels going to the next
+// instruction.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mips32_deps.hpp"
+#include "mxu1_deps.hpp"
+#include "mxu1_disasm.hpp"
+#include "mxu1_parse.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace mxu1;
+
+////////////////////////////////////////////////////////////////////////////////
+// Latencies
+////////////////////////////////////////////////////////////////////////////////
+
+struct Timing {
+  int latency;
+  int interval;
+};
+
+const char* mxu_class_key(OpClass c)
+{
+  static const char* const kKey[] = {
+    "mxu_alu", "mxu_mul", "mxu_hilo", "mxu_xfer", "mxu_load", "mxu_store"
+  };
+  return kKey[static_cast<int>(c)];
+}
+
+class Latencies {
+ public:
+  Latencies()
+  {
+    static const struct { const char* key; Timing t; } kDefault[] = {
+      {"mxu_alu",     {1, 1}},
+      {"mxu_mul",     {2, 1}},
+      {"mxu_hilo",    {3, 1}},
+      {"mxu_xfer",    {1, 1}},
+      {"mxu_load",    {2, 1}},
+      {"mxu_store",   {1, 1}},
+      {"mips_alu",    {1, 1}},
+      {"mips_load",   {2, 1}},
+      {"mips_store",  {1, 1}},
+      {"mips_mul",    {2, 1}},
+      {"mips_hilo",   {3, 1}},
+      {"mips_div",    {34, 34}},
+      {"mips_mfhilo", {1, 1}},
+      {"mips_branch", {1, 1}},
+      // Moving a value out of the MXU takes longer than moving one in
+      {"s32m2i",      {2, 1}},
+    };
+    for (const auto& e : kDefault)
+      table_[e.key] = e.t;
+  }
+
+  bool load(const char* path, std::string& err)
+  {
+    std::ifstream f(path);
+    if (!f) {
+      err = std::string(path) + ": cannot open";
+      return false;
+    }
+    std::string line;
+    for (int n = 1; std::getline(f, line); ++n) {
+      const std::size_t hash = line.find('#');
+      if (hash != std::string::npos)
+        line.erase(hash);
+      std::istringstream ss(line);
+      std::string key;
+      if (!(ss >> key))
+        continue;
+      Timing t{0, 1};
+      if (!(ss >> t.latency) || t.latency < 0) {
+        err = std::string(path) + ":" + std::to_string(n) + ": expected '<key> <latency> [<interval>]'";
+        return false;
+      }
+      if (!(ss >> t.interval))
+        t.interval = 1;
+      table_[key] = t;
+    }
+    return true;
+  }
+
+  Timing get(const std::string& mnemonic, const char* cls) const
+  {
+    auto it = table_.find(mnemonic);
+    if (it == table_.end())
+      it = table_.find(cls);
+    return it == table_.end() ? Timing{1, 1} : it->second;
+  }
+
+  // The key get() took its values from, which is also the issue unit
+  std::string unit(const std::string& mnemonic, const std::string& cls) const
+  {
+    return table_.count(mnemonic) ? mnemonic : cls;
+  }
+
+  void dump(FILE* out) const
+  {
+    std::fprintf(out, "# <key> <latency> [<issue interval>]\n");
+    for (const auto& e : table_)
+      std::fprintf(out, "%-12s %d %d\n", e.first.c_str(), e.second.latency, e.second.interval);
+  }
+
+ private:
+  std::map<std::string, Timing> table_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Program representation
+////////////////////////////////////////////////////////////////////////////////
+
+struct Item {
+  std::string where;               // "file:line" or "section+0xoff"
+  std::string text;                // For reports
+  std::vector<std::string> labels;
+  bool        barrier = false;     // Unknown statement
+  MipsDeps    d;                   // For MXU ops, only the Deps part is used
+  std::string key;                 // Latency table keys: mnemonic, class
+  const char* cls = "";
+  bool        delay_slot = false;  // Branch in '.set noreorder' code
+  int         target = -1;         // Binary only: index of branch target
+};
+
+struct Unit {
+  std::string name;
+  std::vector<Item> items;
+  int unknown = 0;
+};
+
+void set_mxu(Item& it, const Insn& in)
+{
+  static_cast<Deps&>(it.d) = deps(in);
+  it.key = name(in.op);
+  it.cls = mxu_class_key(op_class(in.op));
+  it.text = to_string(in);
+}
+
+void set_mips(Item& it, const MipsDeps& md)
+{
+  it.d = md;
+  it.key = md.name;
+  it.cls = class_key(md.cls);
+}
+
+//  Whether GAS assembles 'li'/'la' with the value 'v' to a single addiu, ori
+// or lui; a symbol, or anything else that does not fold to a number, takes two
+bool fits_one_word(const std::string& v)
+{
+  errno = 0;
+  char* end = nullptr;
+  long long n = std::strtoll(v.c_str(), &end, 0);
+  if (v.empty() || errno || *end != '\0' || n < INT32_MIN || n > UINT32_MAX)
+    return false;
+  n = static_cast<int32_t>(static_cast<uint32_t>(n));
+  return (n >= -32768 && n <= 65535) || (n & 0xffff) == 0;
+}
+
+std::string shell_quote(const std::string& s)
+{
+  std::string q = "'";
+  for (char ch : s) {
+    if (ch == '\'')
+      q += "'\\''";
+    else
+      q += ch;
+  }
+  return q + "'";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Source reader: GAS macro expansion
+////////////////////////////////////////////////////////////////////////////////
+
+// Integer expression as GAS evaluates it: its four precedence levels (unary;
+//  * / % << >>; | & ^ !; + - and comparisons, true being -1; && ||), numbers
+//  in C syntax and symbols from 'syms'. False if anything else is in 's'.
+class Expr {
+ public:
+  Expr(const std::string& s, const std::map<std::string, int64_t>& syms) : s_(s), syms_(syms) {}
+
+  bool eval(int64_t& v)
+  {
+    return logic(v) && (skip(), i_ == s_.size());
+  }
+
+ private:
+  void skip()
+  {
+    while (i_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[i_])))
+      ++i_;
+  }
+
+  bool take(const char* op)
+  {
+    skip();
+    const std::size_t n = std::strlen(op);
+    if (s_.compare(i_, n, op) != 0)
+      return false;
+    // '<' is not the start of '<<' or '<=', '&' not of '&&', ...
+    if (n == 1 && i_ + 1 < s_.size() && std::strchr("<>&|=", s_[i_ + 1]) &&
+        (s_[i_ + 1] == op[0] || s_[i_ + 1] == '='))
+      return false;
+    i_ += n;
+    return true;
+  }
+
+  bool unary(int64_t& v)
+  {
+    skip();
+    if (take("-"))
+      return unary(v) && (v = -v, true);
+    if (take("~"))
+      return unary(v) && (v = ~v, true);
+    if (take("!"))
+      return unary(v) && (v = !v, true);
+    if (take("+"))
+      return unary(v);
+    if (take("(")) {
+      if (!logic(v) || !take(")"))
+        return false;
+      return true;
+    }
+    const std::size_t b = i_;
+    if (i_ < s_.size() && std::isdigit(static_cast<unsigned char>(s_[i_]))) {
+      char* end;
+      v = static_cast<int64_t>(std::strtoull(s_.c_str() + i_, &end, 0));
+      i_ = static_cast<std::size_t>(end - s_.c_str());
+      return i_ == s_.size() || !std::isalnum(static_cast<unsigned char>(s_[i_]));   // Not '1f'
+    }
+    while (i_ < s_.size() && (std::isalnum(static_cast<unsigned char>(s_[i_])) || s_[i_] == '_' || s_[i_] == '.'))
+      ++i_;
+    const auto it = syms_.find(s_.substr(b, i_ - b));
+    if (it == syms_.end())
+      return false;
+    v = it->second;
+    return true;
+  }
+
+  bool mul(int64_t& v)
+  {
+    if (!unary(v))
+      return false;
+    for (int64_t r;;) {
+      if (take("*")) {
+        if (!unary(r)) return false;
+        v *= r;
+      } else if (take("/") || take("%")) {
+        const bool div = s_[i_ - 1] == '/';
+        if (!unary(r) || r == 0) return false;
+        v = div ? v / r : v % r;
+      } else if (take("<<")) {
+        if (!unary(r)) return false;
+        v = static_cast<int64_t>(static_cast<uint64_t>(v) << (r & 63));
+      } else if (take(">>")) {
+        if (!unary(r)) return false;
+        v >>= (r & 63);
+      } else {
+        return true;
+      }
+    }
+  }
+
+  bool bits(int64_t& v)
+  {
+    if (!mul(v))
+      return false;
+    for (int64_t r;;) {
+      if (take("|")) {
+        if (!mul(r)) return false;
+        v |= r;
+      } else if (take("&")) {
+        if (!mul(r)) return false;
+        v &= r;
+      } else if (take("^")) {
+        if (!mul(r)) return false;
+        v ^= r;
+      } else if (take("!")) {
+        if (!mul(r)) return false;
+        v |= ~r;
+      } else {
+        return true;
+      }
+    }
+  }
+
+  bool add(int64_t& v)
+  {
+    if (!bits(v))
+      return false;
+    for (int64_t r;;) {
+      if (take("+")) {
+        if (!bits(r)) return false;
+        v += r;
+      } else if (take("-")) {
+        if (!bits(r)) return false;
+        v -= r;
+      } else if (take("==")) {
+        if (!bits(r)) return false;
+        v = v == r ? -1 : 0;
+      } else if (take("!=") || take("<>")) {
+        if (!bits(r)) return false;
+        v = v != r ? -1 : 0;
+      } else if (take("<=")) {
+        if (!bits(r)) return false;
+        v = v <= r ? -1 : 0;
+      } else if (take(">=")) {
+        if (!bits(r)) return false;
+        v = v >= r ? -1 : 0;
+      } else if (take("<")) {
+        if (!bits(r)) return false;
+        v = v < r ? -1 : 0;
+      } else if (take(">")) {
+        if (!bits(r)) return false;
+        v = v > r ? -1 : 0;
+      } else {
+        return true;
+      }
+    }
+  }
+
+  bool logic(int64_t& v)
+  {
+    if (!add(v))
+      return false;
+    for (int64_t r;;) {
+      if (take("&&")) {
+        if (!add(r)) return false;
+        v = v && r;
+      } else if (take("||")) {
+        if (!add(r)) return false;
+        v = v || r;
+      } else {
+        return true;
+      }
+    }
+  }
+
+  const std::string& s_;
+  const std::map<std::string, int64_t>& syms_;
+  std::size_t i_ = 0;
+};
+
+// Feeds source lines through what GAS would do to them before assembling:
+//  .macro definitions and their invocations (parameters with defaults and
+//  :req/:vararg qualifiers, keyword arguments, \() and \@), .irp/.irpc/.rept,
+//  the .if family, .equ/.set symbols for those and for constant operands, and
+//  .include (looked up next to the including file, then in 'dirs'), handing
+//  each resulting statement to 'out' with the source position of the line it
+//  came from. Definitions of the MXU opcode macros themselves, in an included
+//  mxu1_as_macros.s.h, are dropped: those are known as instructions.
+class Expander {
+ public:
+  using Sink = std::function<void(const Statement&, const std::string& where)>;
+
+  Expander(Sink out, int& unknown, std::vector<std::string> dirs)
+      : out_(std::move(out)), unknown_(unknown), dirs_(std::move(dirs)) {}
+
+  void line(const std::string& text, const std::string& where) { feed(text, where, 0); }
+
+  // An operand with constant expressions folded to numbers: the whole
+  //  operand, or the offset of 'offset(base)'
+  std::string fold(const std::string& op) const
+  {
+    int64_t v;
+    if (Expr(op, syms_).eval(v))
+      return std::to_string(v);
+    const std::size_t lp = op.rfind('(');
+    if (lp != std::string::npos && lp > 0 && op.back() == ')' && Expr(op.substr(0, lp), syms_).eval(v))
+      return std::to_string(v) + op.substr(lp);
+    return op;
+  }
+
+  // Unterminated .macro, .irp or conditional at the end of input
+  bool finish(std::string& err) const
+  {
+    if (capture_ != Capture::none)
+      err = "missing .endm or .endr";
+    else if (!conds_.empty())
+      err = "missing .endif";
+    else
+      return true;
+    return false;
+  }
+
+ private:
+  struct Macro {
+    std::vector<std::string> params, defaults;
+    bool vararg = false;
+    std::vector<std::string> body;
+  };
+  struct Cond {
+    bool active;   // This branch is being assembled
+    bool done;     // A branch of this .if has been taken (or the whole .if is inside a skipped one)
+  };
+  enum class Capture { none, macro, loop };
+
+  static constexpr int kMaxDepth = 64;
+
+  bool active() const { return conds_.empty() || conds_.back().active; }
+
+  bool eval(const std::string& e, const std::string& where, int64_t& v)
+  {
+    if (Expr(e, syms_).eval(v))
+      return true;
+    std::fprintf(stderr, "%s: cannot evaluate '%s', taken as 0\n", where.c_str(), e.c_str());
+    ++unknown_;
+    v = 0;
+    return false;
+  }
+
+  // Directives of the .if family; false if 'm' is not one
+  bool conditional(const std::string& m, const std::string& ops, const std::string& where)
+  {
+    if (m == ".endif") {
+      if (!conds_.empty())
+        conds_.pop_back();
+      return true;
+    }
+    if (m == ".else" || m == ".elseif") {
+      if (conds_.empty())
+        return true;
+      Cond& c = conds_.back();
+      int64_t v = 1;
+      if (c.done)
+        c.active = false;
+      else if (m == ".else" || (eval(ops, where, v), v != 0))
+        c.active = c.done = true;
+      return true;
+    }
+    if (m.compare(0, 3, ".if") != 0)
+      return false;
+
+    bool t;
+    if (!active()) {
+      conds_.push_back({false, true});
+      return true;
+    }
+    const std::vector<std::string> a = split_operands(ops);
+    int64_t v = 0;
+    if (m == ".ifc" || m == ".ifnc") {
+      t = (a.size() == 2 && a[0] == a[1]) == (m == ".ifc");
+    } else if (m == ".ifb" || m == ".ifnb") {
+      t = ops.empty() == (m == ".ifb");
+    } else if (m == ".ifdef" || m == ".ifndef") {
+      t = syms_.count(ops) == (m == ".ifdef" ? 1u : 0u);
+    } else if (m == ".if" || m == ".ifne" || m == ".ifeq" || m == ".ifge" || m == ".ifgt" || m == ".ifle" ||
+               m == ".iflt") {
+      eval(ops, where, v);
+      t = m == ".ifeq" ? v == 0 : m == ".ifge" ? v >= 0 : m == ".ifgt" ? v > 0 : m == ".ifle" ? v <= 0 :
+          m == ".iflt" ? v < 0 : v != 0;
+    } else {
+      return false;
+    }
+    conds_.push_back({t, t});
+    return true;
+  }
+
+  // '\name' replaced by its value in 'vals', '\()' removed, '\@' the
+  //  expansion count
+  static std::string substitute(const std::string& text, const std::vector<std::string>& names,
+                                const std::vector<std::string>& vals, int count)
+  {
+    std::string out;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      if (text[i] != '\\' || i + 1 == text.size()) {
+        out += text[i];
+        continue;
+      }
+      if (text.compare(i + 1, 2, "()") == 0) {
+        i += 2;
+        continue;
+      }
+      if (text[i + 1] == '@') {
+        out += std::to_string(count);
+        ++i;
+        continue;
+      }
+      std::size_t e = i + 1;
+      while (e < text.size() && (std::isalnum(static_cast<unsigned char>(text[e])) || text[e] == '_'))
+        ++e;
+      const std::string n = text.substr(i + 1, e - i - 1);
+      const auto it = std::find(names.begin(), names.end(), n);
+      if (it == names.end()) {
+        out += text[i];
+        continue;
+      }
+      out += vals[static_cast<std::size_t>(it - names.begin())];
+      i = e - 1;
+    }
+    return out;
+  }
+
+  // '.macro name a, b=1, c:req, d:vararg' (commas optional)
+  void define(const std::string& ops)
+  {
+    std::string s = ops;
+    std::replace(s.begin(), s.end(), ',', ' ');
+    std::istringstream ss(s);
+    std::string tok;
+    ss >> name_;
+    macro_ = Macro();
+    while (ss >> tok) {
+      std::string def;
+      const std::size_t eq = tok.find('=');
+      if (eq != std::string::npos) {
+        def = tok.substr(eq + 1);
+        tok.erase(eq);
+      }
+      const std::size_t colon = tok.find(':');
+      if (colon != std::string::npos) {
+        macro_.vararg = tok.compare(colon, std::string::npos, ":vararg") == 0;
+        tok.erase(colon);
+      }
+      macro_.params.push_back(tok);
+      macro_.defaults.push_back(def);
+    }
+  }
+
+  // Macro arguments: split at commas outside parentheses and quotes, a
+  //  quoted argument passed without its quotes
+  static std::vector<std::string> arguments(const std::string& s)
+  {
+    std::vector<std::string> out;
+    std::string cur;
+    int depth = 0;
+    bool quoted = false, any = false;
+    for (std::size_t i = 0; i <= s.size(); ++i) {
+      const char ch = i < s.size() ? s[i] : ',';
+      if (ch == '"') {
+        quoted = !quoted;
+        any = true;
+        continue;
+      }
+      if (!quoted && ch == '(')
+        ++depth;
+      else if (!quoted && ch == ')')
+        --depth;
+      if (!quoted && depth <= 0 && ch == ',') {
+        out.push_back(detail::trim(cur));
+        cur.clear();
+      } else {
+        cur += ch;
+      }
+    }
+    if (out.size() == 1 && out[0].empty() && !any)
+      out.clear();
+    return out;
+  }
+
+  void invoke(const Macro& mc, const std::string& ops, const std::string& where, int depth)
+  {
+    std::vector<std::string> vals = mc.defaults;
+    const std::vector<std::string> a = arguments(ops);
+    std::size_t pos = 0;
+    for (std::size_t k = 0; k < a.size(); ++k) {
+      const std::size_t eq = a[k].find('=');
+      if (eq != std::string::npos && eq > 0 && a[k][eq + 1] != '=' && std::strchr("!<>=", a[k][eq - 1]) == nullptr) {
+        const auto it = std::find(mc.params.begin(), mc.params.end(), detail::trim(a[k].substr(0, eq)));
+        if (it != mc.params.end()) {
+          vals[static_cast<std::size_t>(it - mc.params.begin())] = detail::trim(a[k].substr(eq + 1));
+          continue;
+        }
+      }
+      if (pos + 1 == mc.params.size() && mc.vararg) {
+        std::string rest = a[k];
+        for (std::size_t r = k + 1; r < a.size(); ++r)
+          rest += ", " + a[r];
+        vals[pos++] = rest;
+        break;
+      }
+      if (pos < vals.size() && !a[k].empty())
+        vals[pos] = a[k];
+      ++pos;
+    }
+    const int count = count_++;
+    for (const std::string& b : mc.body) {
+      feed(substitute(b, mc.params, vals, count), where, depth + 1);
+      if (exit_) {
+        exit_ = false;
+        break;
+      }
+    }
+  }
+
+  void repeat(const std::string& where, int depth)
+  {
+    const std::vector<std::string> a = split_operands(loop_ops_);
+    std::vector<std::string> vals;
+    std::string sym;
+    if (loop_kind_ == ".rept") {
+      int64_t n;
+      eval(loop_ops_, where, n);
+      vals.assign(static_cast<std::size_t>(std::max<int64_t>(0, n)), "");
+    } else if (!a.empty()) {
+      sym = a[0];
+      if (loop_kind_ == ".irp")
+        vals.assign(a.begin() + 1, a.end());
+      else if (a.size() > 1)
+        for (char ch : a[1])
+          vals.push_back(std::string(1, ch));
+    }
+    const std::vector<std::string> body = std::move(loop_body_);
+    for (const std::string& v : vals)
+      for (const std::string& b : body)
+        feed(substitute(b, {sym}, {v}, count_), where, depth + 1);
+  }
+
+  void include(const std::string& ops, const std::string& where, int depth)
+  {
+    std::string name = detail::trim(ops);
+    if (name.size() > 1 && name.front() == '"' && name.back() == '"')
+      name = name.substr(1, name.size() - 2);
+    std::vector<std::string> tries;
+    const std::string from = where.substr(0, where.rfind(':'));
+    const std::size_t slash = from.rfind('/');
+    tries.push_back(slash == std::string::npos ? name : from.substr(0, slash + 1) + name);
+    for (const std::string& d : dirs_)
+      tries.push_back(d + "/" + name);
+    for (const std::string& path : tries) {
+      std::ifstream f(path);
+      if (!f)
+        continue;
+      std::string text;
+      for (int n = 1; std::getline(f, text); ++n)
+        feed(text, path + ":" + std::to_string(n), depth + 1);
+      return;
+    }
+  }
+
+  void feed(const std::string& text, const std::string& where, int depth)
+  {
+    if (depth > kMaxDepth) {
+      std::fprintf(stderr, "%s: macros nested too deeply\n", where.c_str());
+      ++unknown_;
+      return;
+    }
+    const std::vector<Statement> sts = split_statements(text);
+
+    // Inside a definition only the nesting of its own kind is looked at
+    if (capture_ != Capture::none) {
+      for (const Statement& st : sts) {
+        const std::string& m = st.mnemonic;
+        const bool open = capture_ == Capture::macro ? m == ".macro" :
+                          m == ".irp" || m == ".irpc" || m == ".rept";
+        const bool close = m == (capture_ == Capture::macro ? ".endm" : ".endr");
+        if (open)
+          ++nest_;
+        if (close && nest_-- == 0) {
+          const Capture c = capture_;
+          capture_ = Capture::none;
+          nest_ = 0;
+          if (c == Capture::macro && find_op(name_) == Op::invalid)
+            macros_[name_] = std::move(macro_);
+          else
+            repeat(loop_where_, depth);
+          return;
+        }
+      }
+      (capture_ == Capture::macro ? macro_.body : loop_body_).push_back(text);
+      return;
+    }
+
+    for (Statement st : sts) {
+      const std::string& m = st.mnemonic;
+      if (conditional(m, st.operands, where) || !active())
+        continue;
+      // Labels go to whatever instruction comes next, expanded or not
+      if (!st.labels.empty()) {
+        Statement l;
+        l.labels.swap(st.labels);
+        out_(l, where);
+      }
+      if (m == ".macro") {
+        define(st.operands);
+        capture_ = Capture::macro;
+        return;
+      }
+      if (m == ".irp" || m == ".irpc" || m == ".rept") {
+        loop_kind_ = m;
+        loop_ops_ = st.operands;
+        loop_where_ = where;
+        loop_body_.clear();
+        capture_ = Capture::loop;
+        return;
+      }
+      if (m == ".exitm") {
+        exit_ = depth > 0;
+        return;
+      }
+      if (m == ".include") {
+        include(st.operands, where, depth);
+        continue;
+      }
+      if (m == ".equ" || m == ".equiv" || (m == ".set" && st.operands.find(',') != std::string::npos)) {
+        const std::vector<std::string> a = split_operands(st.operands);
+        int64_t v;
+        if (a.size() == 2 && Expr(a[1], syms_).eval(v))
+          syms_[a[0]] = v;
+        continue;
+      }
+      const auto mc = macros_.find(m);
+      if (mc != macros_.end()) {
+        invoke(mc->second, st.operands, where, depth);
+        continue;
+      }
+      out_(st, where);
+    }
+  }
+
+  Sink out_;
+  int& unknown_;
+  const std::vector<std::string> dirs_;
+  std::map<std::string, Macro> macros_;
+  std::map<std::string, int64_t> syms_;
+  std::vector<Cond> conds_;
+  Capture capture_ = Capture::none;
+  int nest_ = 0, count_ = 0;
+  bool exit_ = false;
+  std::string name_;
+  Macro macro_;
+  std::string loop_kind_, loop_ops_, loop_where_;
+  std::vector<std::string> loop_body_;
+};
+
+bool read_text(const std::string& path, const std::vector<std::string>& cpp_args, Unit& u, std::string& err)
+{
+  FILE* f = nullptr;
+  bool piped = false;
+  if (path == "-") {
+    f = stdin;
+  } else if (path.size() > 2 && path.compare(path.size() - 2, 2, ".S") == 0) {
+    const char* env = std::getenv("CPP");
+    std::string cmd = env && *env ? env : "cpp";
+    cmd += " -x assembler-with-cpp";
+    const std::size_t slash = path.rfind('/');
+    cmd += " -I" + shell_quote(slash == std::string::npos ? "." : path.substr(0, slash));
+    for (const std::string& a : cpp_args)
+      cmd += " " + shell_quote(a);
+    cmd += " " + shell_quote(path);
+    f = popen(cmd.c_str(), "r");
+    piped = true;
+  } else {
+    f = std::fopen(path.c_str(), "r");
+  }
+  if (!f) {
+    err = path + ": cannot open";
+    return false;
+  }
+
+  std::string file = path, line;
+  int lineno = 0;
+  bool noreorder = false;
+  std::vector<std::string> include_dirs;
+  for (const std::string& a : cpp_args)
+    if (a.compare(0, 2, "-I") == 0)
+      include_dirs.push_back(a.substr(2));
+  std::vector<std::string> pending;   // Labels waiting for an instruction
+  Expander ex([&](const Statement& st, const std::string& where) {
+    const std::string& m = st.mnemonic;
+    pending.insert(pending.end(), st.labels.begin(), st.labels.end());
+    if (m.empty())
+      return;
+    if (m == ".set") {
+      if (st.operands == "noreorder")
+        noreorder = true;
+      else if (st.operands == "reorder")
+        noreorder = false;
+      return;
+    }
+
+    Item it;
+    it.where = where;
+    it.text = m + (st.operands.empty() ? "" : " " + st.operands);
+    Insn in;
+    std::string perr;
+    MipsDeps md;
+    if (m[0] == '.') {
+      // Raw MXU words are the only data directive worth looking at
+      int32_t w;
+      if ((m != ".word" && m != ".long" && m != ".4byte") || !detail::parse_int(ex.fold(st.operands), w) ||
+          (in = decode(static_cast<uint32_t>(w))).op == Op::invalid)
+        return;
+      set_mxu(it, in);
+    } else {
+      // Constant expressions (macro arguments, .equ symbols) as numbers
+      std::string ops;
+      for (const std::string& a : split_operands(st.operands))
+        ops += (ops.empty() ? "" : ", ") + ex.fold(a);
+      if (parse(m, ops, in, perr)) {
+        set_mxu(it, in);
+      } else if (!perr.empty()) {
+        std::fprintf(stderr, "%s: %s\n", it.where.c_str(), perr.c_str());
+        it.barrier = true;
+      } else if (mips_deps(m, ops, md)) {
+        set_mips(it, md);
+        it.delay_slot = md.branch && noreorder;
+        const std::vector<std::string> a = split_operands(ops);
+        const bool mem = md.cls == MipsClass::load || md.cls == MipsClass::store;
+        std::string hi, second;   // Register lui writes, and what follows it
+        if ((m == "li" || m == "la") && a.size() == 2 && !fits_one_word(a[1])) {
+          // GAS writes the upper half with lui, then ors or adds the lower
+          hi = a[0];
+          second = (m == "li" ? "ori " : "addiu ") + a[0] + ", " + a[0] + ", 0";
+        } else if (mem && a.size() == 2 && a[1].find('(') == std::string::npos &&
+                   !a[1].empty() && a[1][0] != '-' && !std::isdigit(static_cast<unsigned char>(a[1][0]))) {
+          // A bare symbol: lui of its upper half into the loaded register
+          //  (or $at), then the access with the lower half off that
+          hi = md.cls == MipsClass::load && a[0].compare(0, 2, "$f") != 0 ? a[0] : "$at";
+          second = m + " " + a[0] + ", 0(" + hi + ")";
+        }
+        if (!hi.empty()) {
+          MipsDeps lo;
+          const std::size_t sp = second.find(' ');
+          mips_deps(second.substr(0, sp), second.substr(sp + 1), lo);
+          mips_deps("lui", hi + ", 0", md);
+          set_mips(it, md);
+          it.labels.swap(pending);
+          u.items.push_back(it);
+          it.labels.clear();
+          set_mips(it, lo);
+        }
+      } else {
+        it.barrier = true;
+      }
+    }
+    if (it.barrier)
+      ++u.unknown;
+    it.labels.swap(pending);
+    u.items.push_back(std::move(it));
+  }, u.unknown, include_dirs);
+
+  char buf[4096];
+  while (std::fgets(buf, sizeof(buf), f)) {
+    line += buf;
+    if (!line.empty() && line.back() != '\n' && !std::feof(f))
+      continue;
+    ++lineno;
+    // Preprocessor line markers: '# 12 "file.S" ...'
+    if (piped && line.size() > 2 && line[0] == '#' && line[1] == ' ' && std::isdigit(static_cast<unsigned char>(line[2]))) {
+      char* end;
+      lineno = static_cast<int>(std::strtol(line.c_str() + 2, &end, 10)) - 1;
+      const char* q1 = std::strchr(end, '"');
+      const char* q2 = q1 ? std::strchr(q1 + 1, '"') : nullptr;
+      if (q2)
+        file.assign(q1 + 1, q2);
+      line.clear();
+      continue;
+    }
+    ex.line(line, file + ":" + std::to_string(lineno));
+    line.clear();
+  }
+  std::string unclosed;
+  const bool closed = ex.finish(unclosed);
+
+  if (piped) {
+    if (pclose(f) != 0) {
+      err = path + ": preprocessor failed";
+      return false;
+    }
+  } else if (f != stdin) {
+    std::fclose(f);
+  }
+  if (!closed)
+    err = path + ": " + unclosed;
+  return closed;
+}
+
+// Minimal ELF32 reader: executable sections and the symbols defined in them
+bool read_elf(const std::string& path, const std::vector<unsigned char>& img, std::vector<Unit>& units,
+              std::string& err)
+{
+  if (img.size() < 52 || img[4] != 1) {
+    err = path + ": only ELF32 is supported";
+    return false;
+  }
+  const bool be = img[5] == 2;
+  auto u16 = [&](std::size_t o) -> uint32_t {
+    return be ? (img[o] << 8) | img[o + 1] : img[o] | (img[o + 1] << 8);
+  };
+  auto u32 = [&](std::size_t o) -> uint32_t {
+    return be ? (u16(o) << 16) | u16(o + 2) : u16(o) | (u16(o + 2) << 16);
+  };
+  const uint32_t type = u16(16), shoff = u32(32), shentsize = u16(46), shnum = u16(48);
+  if (u16(18) != 8) {
+    err = path + ": not a MIPS object";
+    return false;
+  }
+  if (shoff == 0 || shoff + static_cast<uint64_t>(shnum) * shentsize > img.size()) {
+    err = path + ": no usable section headers";
+    return false;
+  }
+  struct Sh { uint32_t name, type, flags, addr, off, size, link; };
+  std::vector<Sh> sh(shnum);
+  for (uint32_t i = 0; i < shnum; ++i) {
+    const std::size_t o = shoff + i * shentsize;
+    sh[i] = {u32(o), u32(o + 4), u32(o + 8), u32(o + 12), u32(o + 16), u32(o + 20), u32(o + 24)};
+    if (sh[i].type != 8 && static_cast<uint64_t>(sh[i].off) + sh[i].size > img.size()) {
+      err = path + ": truncated";
+      return false;
+    }
+  }
+  auto str = [&](uint32_t sec, uint32_t off) -> std::string {
+    if (sec >= shnum || off >= sh[sec].size)
+      return "";
+    const char* s = reinterpret_cast<const char*>(&img[sh[sec].off + off]);
+    return std::string(s, strnlen(s, sh[sec].size - off));
+  };
+  const uint32_t shstrndx = u16(50);
+
+  // Symbols per section, as (section offset, name), and the data objects
+  //  (STT_OBJECT, such as a table between a bal and its target) in each, as
+  //  (section offset, size), which are not decoded
+  std::map<uint32_t, std::multimap<uint32_t, std::string>> syms;
+  std::map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> data;
+  for (uint32_t i = 0; i < shnum; ++i) {
+    if (sh[i].type != 2)   // SHT_SYMTAB
+      continue;
+    for (uint32_t o = 16; o + 16 <= sh[i].size; o += 16) {
+      const std::size_t p = sh[i].off + o;
+      const uint32_t value = u32(p + 4), shndx = u16(p + 14), stt = img[p + 12] & 15;
+      const std::string n = str(sh[i].link, u32(p));
+      if (n.empty() || shndx == 0 || shndx >= shnum || stt == 3 || stt == 4)
+        continue;
+      const uint32_t off = type == 1 ? value : value - sh[shndx].addr;
+      syms[shndx].emplace(off, n);
+      if (stt == 1 && u32(p + 8) != 0)
+        data[shndx].emplace_back(off, u32(p + 8));
+    }
+  }
+
+  for (uint32_t s = 0; s < shnum; ++s) {
+    if (sh[s].type != 1 || !(sh[s].flags & 4))   // SHT_PROGBITS, SHF_EXECINSTR
+      continue;
+    Unit u;
+    u.name = path + "(" + str(shstrndx, sh[s].name) + ")";
+    const uint32_t n = sh[s].size / 4;
+    const auto& sy = syms[s];
+    const auto& dt = data[s];
+    std::vector<int> item_of(n, -1);      // Word index -> item index
+    std::vector<int64_t> to(0);           // Item index -> target word index
+    std::vector<std::string> pending;     // Labels of skipped data words
+    for (uint32_t i = 0; i < n; ++i) {
+      auto r = sy.equal_range(i * 4);
+      for (auto k = r.first; k != r.second; ++k)
+        pending.push_back(k->second);
+      if (std::any_of(dt.begin(), dt.end(), [&](const std::pair<uint32_t, uint32_t>& d) {
+            return i * 4 >= d.first && i * 4 - d.first < d.second;
+          }))
+        continue;
+      const uint32_t w = u32(sh[s].off + i * 4);
+      const uint32_t addr = sh[s].addr + i * 4;
+      Item it;
+      char where[32];
+      std::snprintf(where, sizeof(where), "0x%x", addr);
+      it.where = where;
+      it.labels.swap(pending);
+      const Insn in = decode(w);
+      MipsDeps md;
+      int64_t target = -1;
+      if (in.op != Op::invalid) {
+        set_mxu(it, in);
+      } else if (mips_deps(w, md)) {
+        set_mips(it, md);
+        const std::string ops = mips_operands(w, addr);
+        it.text = ops.empty() ? std::string(md.name) : std::string(md.name) + "\t" + ops;
+        it.delay_slot = md.branch;
+        if (md.has_offset)
+          target = static_cast<int64_t>(i) + 1 + md.offset;
+      } else {
+        char t[32];
+        std::snprintf(t, sizeof(t), ".word\t0x%08x", w);
+        it.text = t;
+        it.barrier = true;
+        ++u.unknown;
+      }
+      item_of[i] = static_cast<int>(u.items.size());
+      to.push_back(target);
+      u.items.push_back(std::move(it));
+    }
+    for (std::size_t k = 0; k < u.items.size(); ++k)
+      if (to[k] >= 0 && to[k] < n)
+        u.items[k].target = item_of[to[k]];
+    units.push_back(std::move(u));
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pipeline model
+////////////////////////////////////////////////////////////////////////////////
+
+// Resources are numbered: xr0..16 -> 0..16, GPRs -> 17..48, HI/LO -> 49
+constexpr int kNumRes = 50;
+constexpr int kHiLo = 49;
+
+struct Block {
+  int begin, end;     // Item indices, [begin, end)
+  int pinned;         // Items from here on (branch, delay slot) stay put
+  bool loop;
+};
+
+template <typename Fn>
+void for_each_res(uint32_t xr, uint32_t gpr, bool hilo, Fn fn)
+{
+  for (int r = 0; r < 17; ++r)
+    if (xr & (1u << r)) fn(r);
+  for (int r = 0; r < 32; ++r)
+    if (gpr & (1u << r)) fn(17 + r);
+  if (hilo) fn(kHiLo);
+}
+
+std::string res_name(int r)
+{
+  if (r < 16) return "xr" + std::to_string(r);
+  if (r == 16) return "MXU_CR";
+  if (r < kHiLo) return kGprName[r - 17];
+  return "HI/LO";
+}
+
+struct Issue {
+  int  cycle = 0;
+  int  stall = 0;
+  int  res = -1;          // Resource waited for, -1 = unit busy
+  int  producer = -1;     // Item index of its producer, or -1
+  bool wrapped = false;   // Producer was in the previous loop iteration
+};
+
+class Model {
+ public:
+  Model(const std::vector<Item>& items, const Latencies& lat) : items_(items), lat_(lat) {}
+
+  // Issue 'order' (item indices) 'iters' times; returns the issue records of
+  //  the last iteration and the cycles it took.
+  int run(const std::vector<int>& order, int iters, std::vector<Issue>* out) const
+  {
+    std::vector<int> ready(kNumRes, 0), producer(kNumRes, -1);
+    std::map<std::string, int> unit_free;
+    int prev = -1, iter_start = 0;
+    std::vector<Issue> rec(order.size());
+    for (int it = 0; it < iters; ++it) {
+      iter_start = prev + 1;
+      for (std::size_t k = 0; k < order.size(); ++k) {
+        const Item& in = items_[order[k]];
+        const Timing t = lat_.get(in.key, in.cls);
+        Issue is;
+        int c = prev + 1;
+        for_each_res(in.d.xr_use, in.d.gpr_use, in.d.hilo_use, [&](int r) {
+          if (ready[r] > c) {
+            c = ready[r];
+            is.res = r;
+            is.producer = producer[r];
+          }
+        });
+        const std::string ukey = t.interval > 1 ? lat_.unit(in.key, in.cls) : std::string();
+        if (!ukey.empty() && unit_free[ukey] > c) {
+          c = unit_free[ukey];
+          is.res = -1;
+          is.producer = -1;
+        }
+        is.cycle = c;
+        is.stall = c - (prev + 1);
+        is.wrapped = is.producer >= 0 && position(order, is.producer) >= k;
+        if (!ukey.empty())
+          unit_free[ukey] = c + t.interval;
+        for_each_res(in.d.xr_def, in.d.gpr_def, in.d.hilo_def, [&](int r) {
+          const bool inc = r >= 17 && r < kHiLo && (in.d.gpr_inc & (1u << (r - 17)));
+          ready[r] = c + (inc ? 1 : t.latency);
+          producer[r] = order[k];
+        });
+        prev = c;
+        rec[k] = is;
+      }
+    }
+    if (out)
+      *out = rec;
+    return prev + 1 - iter_start;
+  }
+
+  // Greedy list schedule of the movable part of block 'b' under the same
+  //  model; returns the new order.
+  std::vector<int> schedule(const Block& b) const
+  {
+    const int n = b.pinned - b.begin;
+    std::vector<std::vector<std::pair<int, int>>> preds(n);   // (pred, min distance)
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < j; ++i) {
+        const Item& x = items_[b.begin + i];
+        const Item& y = items_[b.begin + j];
+        if (raw(x, y))
+          preds[j].push_back({i, lat_.get(x.key, x.cls).latency});
+        else if (conflict(x, y))
+          preds[j].push_back({i, 1});
+      }
+    }
+    // Priority: longest latency-weighted path to the end of the block
+    std::vector<int> height(n, 0);
+    for (int j = n - 1; j >= 0; --j) {
+      const Item& y = items_[b.begin + j];
+      height[j] = std::max(height[j], lat_.get(y.key, y.cls).latency);
+      for (const auto& p : preds[j])
+        height[p.first] = std::max(height[p.first], p.second + height[j]);
+    }
+    std::vector<int> issued(n, -1), order;
+    for (int cycle = 0; static_cast<int>(order.size()) < n; ++cycle) {
+      int best = -1;
+      for (int j = 0; j < n; ++j) {
+        if (issued[j] >= 0)
+          continue;
+        bool ok = true;
+        for (const auto& p : preds[j])
+          ok = ok && issued[p.first] >= 0 && issued[p.first] + p.second <= cycle;
+        if (ok && (best < 0 || height[j] > height[best]))
+          best = j;
+      }
+      if (best >= 0) {
+        issued[best] = cycle;
+        order.push_back(b.begin + best);
+      }
+    }
+    for (int i = b.pinned; i < b.end; ++i)
+      order.push_back(i);
+    return order;
+  }
+
+  // Items of [from, to) that 'y' may move above without changing results
+  bool movable_above(int y, int from) const
+  {
+    for (int k = from; k < y; ++k) {
+      if (raw(items_[k], items_[y]) || conflict(items_[k], items_[y]))
+        return false;
+    }
+    return true;
+  }
+
+  static bool raw(const Item& x, const Item& y)
+  {
+    return (x.d.xr_def & y.d.xr_use) || (x.d.gpr_def & y.d.gpr_use) || (x.d.hilo_def && y.d.hilo_use);
+  }
+
+  // Any ordering constraint other than a true dependency
+  static bool conflict(const Item& x, const Item& y)
+  {
+    return (x.d.xr_use & y.d.xr_def) || (x.d.gpr_use & y.d.gpr_def) || (x.d.hilo_use && y.d.hilo_def) ||
+           (x.d.xr_def & y.d.xr_def) || (x.d.gpr_def & y.d.gpr_def) || (x.d.hilo_def && y.d.hilo_def) ||
+           ((x.d.store || y.d.store) && (x.d.load || x.d.store) && (y.d.load || y.d.store));
+  }
+
+ private:
+  static std::size_t position(const std::vector<int>& order, int item)
+  {
+    return static_cast<std::size_t>(std::find(order.begin(), order.end(), item) - order.begin());
+  }
+
+  const std::vector<Item>& items_;
+  const Latencies& lat_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Driver
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<Block> split_blocks(const std::vector<Item>& items)
+{
+  const int n = static_cast<int>(items.size());
+  std::vector<bool> leader(n + 1, false);
+  leader[0] = true;
+  for (int i = 0; i < n; ++i) {
+    const Item& it = items[i];
+    if (!it.labels.empty() || it.barrier)
+      leader[i] = true;
+    if (it.barrier)
+      leader[i + 1] = true;
+    if (it.d.branch)
+      leader[std::min(n, i + (it.delay_slot ? 2 : 1))] = true;
+    if (it.target >= 0)
+      leader[it.target] = true;
+  }
+
+  std::vector<Block> blocks;
+  for (int i = 0; i < n;) {
+    int j = i + 1;
+    while (j < n && !leader[j])
+      ++j;
+    if (!items[i].barrier) {
+      Block b{i, j, j, false};
+      for (int k = i; k < j; ++k) {
+        const Item& it = items[k];
+        if (!it.d.branch)
+          continue;
+        b.pinned = k;
+        // Numeric local labels are referenced as '1b'
+        std::string t = it.d.target;
+        if (t.size() > 1 && t.back() == 'b' && std::isdigit(static_cast<unsigned char>(t[0])))
+          t.pop_back();
+        b.loop = it.target == i ||
+                 (!t.empty() && std::find(items[i].labels.begin(), items[i].labels.end(), t) != items[i].labels.end());
+        break;
+      }
+      blocks.push_back(b);
+    }
+    i = j;
+  }
+  return blocks;
+}
+
+std::string block_name(const std::vector<Item>& items, int begin)
+{
+  for (int i = begin; i >= 0; --i) {
+    if (!items[i].labels.empty())
+      return i == begin ? items[i].labels[0] : items[i].labels[0] + "+" + std::to_string(begin - i);
+  }
+  return "+" + std::to_string(begin);
+}
+
+struct Totals {
+  int blocks = 0, insns = 0, stalls = 0, saved = 0, unknown = 0, clobbers = 0;
+};
+
+// HI/LO results overwritten before anything read them. Easy to miss, since
+//  s32mul/s32mulu (and 'mul') write HI/LO without saying so in their operands.
+std::vector<std::pair<int, int>> hilo_clobbers(const std::vector<Item>& items, const Block& b)
+{
+  std::vector<std::pair<int, int>> out;
+  int live = -1;
+  for (int i = b.begin; i < b.end; ++i) {
+    const Deps& d = items[i].d;
+    if (d.hilo_use)
+      live = -1;
+    if (d.hilo_def) {
+      if (live >= 0)
+        out.push_back({live, i});
+      live = i;
+    }
+  }
+  return out;
+}
+
+void analyze(const Unit& u, const Latencies& lat, bool verbose, Totals& tot)
+{
+  const std::vector<Item>& items = u.items;
+  const Model model(items, lat);
+  tot.unknown += u.unknown;
+
+  for (const Block& b : split_blocks(items)) {
+    std::vector<int> order;
+    for (int i = b.begin; i < b.end; ++i)
+      order.push_back(i);
+    const int iters = b.loop ? 2 : 1;
+    std::vector<Issue> rec;
+    const int cycles = model.run(order, iters, &rec);
+    int stalls = 0;
+    for (const Issue& is : rec)
+      stalls += is.stall;
+    const int best = model.run(model.schedule(b), iters, nullptr);
+
+    ++tot.blocks;
+    tot.insns += b.end - b.begin;
+    tot.stalls += stalls;
+    tot.saved += std::max(0, cycles - best);
+    const std::vector<std::pair<int, int>> clobbers = hilo_clobbers(items, b);
+    tot.clobbers += static_cast<int>(clobbers.size());
+    if (!stalls && clobbers.empty() && !verbose)
+      continue;
+
+    std::printf("%s: %s (%s, %d insns%s): %d cycles, %d stall cycles", u.name.c_str(),
+                block_name(items, b.begin).c_str(), items[b.begin].where.c_str(), b.end - b.begin,
+                b.loop ? ", loop" : "", cycles, stalls);
+    if (best < cycles)
+      std::printf("; reordered: %d cycles", best);
+    std::printf("\n");
+    for (const auto& c : clobbers) {
+      std::printf("  %s: %-32s overwrites HI/LO from %s (%s) before it is read\n", items[c.second].where.c_str(),
+                  items[c.second].text.c_str(), items[c.first].where.c_str(), items[c.first].key.c_str());
+    }
+
+    for (std::size_t k = 0; k < rec.size(); ++k) {
+      const Issue& is = rec[k];
+      if (!is.stall)
+        continue;
+      const int i = order[k];
+      std::printf("  %s: %-32s stalls %d, ", items[i].where.c_str(), items[i].text.c_str(), is.stall);
+      if (is.res < 0) {
+        std::printf("%s unit busy\n", items[i].key.c_str());
+        continue;
+      }
+      std::printf("waiting for %s from %s%s (%s)\n", res_name(is.res).c_str(),
+                  is.wrapped ? "previous iteration, " : "", items[is.producer].where.c_str(),
+                  items[is.producer].key.c_str());
+      // Independent instructions that could fill the gap
+      int found = 0;
+      for (int j = i + 1; j < b.pinned && found < is.stall; ++j) {
+        if (model.movable_above(j, i) && !Model::raw(items[is.producer], items[j])) {
+          std::printf("    hint: move %s (%s) above it\n", items[j].where.c_str(), items[j].text.c_str());
+          ++found;
+        }
+      }
+    }
+  }
+}
+
+std::vector<unsigned char> slurp(const std::string& path)
+{
+  std::vector<unsigned char> data;
+  FILE* f = std::fopen(path.c_str(), "rb");
+  if (!f)
+    return data;
+  unsigned char buf[65536];
+  std::size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    data.insert(data.end(), buf, buf + n);
+  std::fclose(f);
+  return data;
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr,
+               "usage: %s [-l LATENCIES] [-I DIR] [-D SYM] [-v] [--max-stalls N] FILE...\n"
+               "       %s [-l LATENCIES] --dump-latencies\n",
+               argv0, argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  Latencies lat;
+  std::vector<std::string> files, cpp_args;
+  bool verbose = false, dump = false;
+  long max_stalls = -1;
+  std::string err;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "-l" && i + 1 < argc) {
+      if (!lat.load(argv[++i], err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 2;
+      }
+    } else if ((a == "-I" || a == "-D") && i + 1 < argc) {
+      cpp_args.push_back(a + argv[++i]);
+    } else if (a.size() > 2 && (a.compare(0, 2, "-I") == 0 || a.compare(0, 2, "-D") == 0)) {
+      cpp_args.push_back(a);
+    } else if (a == "-v") {
+      verbose = true;
+    } else if (a == "--dump-latencies") {
+      dump = true;
+    } else if (a == "--max-stalls" && i + 1 < argc) {
+      max_stalls = std::strtol(argv[++i], nullptr, 0);
+    } else if (a == "-" || a[0] != '-') {
+      files.push_back(a);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (dump) {
+    lat.dump(stdout);
+    return 0;
+  }
+  if (files.empty()) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  Totals tot;
+  for (const std::string& path : files) {
+    std::vector<Unit> units;
+    std::vector<unsigned char> head = path == "-" ? std::vector<unsigned char>() : slurp(path);
+    bool ok;
+    if (head.size() >= 4 && head[0] == 0x7f && head[1] == 'E' && head[2] == 'L' && head[3] == 'F') {
+      ok = read_elf(path, head, units, err);
+    } else {
+      units.emplace_back();
+      units.back().name = path;
+      ok = read_text(path, cpp_args, units.back(), err);
+    }
+    if (!ok) {
+      std::fprintf(stderr, "%s\n", err.c_str());
+      return 2;
+    }
+    for (const Unit& u : units)
+      analyze(u, lat, verbose, tot);
+  }
+
+  std::printf("total: %d blocks, %d insns, %d stall cycles, %d recoverable by reordering",
+              tot.blocks, tot.insns, tot.stalls, tot.saved);
+  if (tot.clobbers)
+    std::printf(", %d HI/LO overwrites", tot.clobbers);
+  if (tot.unknown)
+    std::printf(", %d unknown statements treated as barriers", tot.unknown);
+  std::printf("\n");
+  return max_stalls >= 0 && tot.stalls > max_stalls ? 1 : 0;
+}
@@ -0,0 +1,760 @@
+// mxu1_latgen.cpp
+//
+// Per-opcode latency and issue interval microbenchmark generator for MXU kernels
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Build:  c++ -std=c++14 -O2 -I.. -o mxu1_latgen mxu1_latgen.cpp
+//
+// Usage:
+//   mxu1_latgen [-u UNROLL] [-o OUT]
+//   mxu1_latgen [-u UNROLL] --check
+//
+//   Writes OUT (or stdout): a C program for the target that times two loops
+//   of every opcode in mxu1_as_macros.s.h with the CPU's cycle counter, and
+//   prints the latency table mxu1_hazard takes with -l:
+//       mxu1_latgen -o mxu1_lat.c                                   (host)
+//       mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I.. -o mxu1_lat mxu1_lat.c
+//       ./mxu1_lat > xburst.lat                                   (target)
+//       mxu1_hazard -l xburst.lat kernel.s                          (host)
+//
+//   -u UNROLL        Instructions per loop iteration, even, 8..512 (default 64)
+//   --check          Write nothing; check every loop on the host instead (see
+//                    below) and exit with status 1 if any is wrong
+//
+//  The loops, UNROLL instructions per iteration of a counted loop:
+//   chain    Each instruction waits for the one before it. An opcode that can
+//            read one of its own results (xrb = xra, an accumulator, HI/LO)
+//            is repeated as is, and its cycles per instruction are its
+//            latency. The rest (loads, s32lui, s32i2m, s32m2i, lx*)
+//            alternate with a consumer of their result that nothing waits on
+//            in turn, 's32or xr15, xrN, xrN' (or 's32i2m xr15' for a GPR):
+//            single issue in order, a pair takes latency + 1 cycles. Stores
+//            have no result and no chain, and are listed with latency 1.
+//   stream   Copies writing a rotating set of registers (as many sets as fit
+//            in xr1..xr12, or six GPRs) and reading fixed ones, with offsets
+//            stepping through a buffer, so that none waits for another: the
+//            cycles per instruction are the issue interval. The opcodes that
+//            accumulate in HI/LO, and d32add, which leaves its carries in
+//            MXU_CR, cannot be made independent; the output marks them.
+// An empty loop is timed and subtracted from every other, and an addu chain
+// (one cycle per addu on any MIPS32 core) reported as a check on the clock.
+//
+//  The program reads the cycle counter with 'rdhwr $2', scaled by CCRes
+// ('rdhwr $3'), which Linux lets user space read on MIPS32r2. Where that
+// traps it falls back to clock_gettime(), turned into cycles by the addu
+// chain. Every loop is timed several times and the fastest run kept.
+//
+// Output, one line per opcode after '#' comments naming the core and clock:
+//   <mnemonic> <latency> <issue interval>   # chain C  stream S [note]
+// which is mxu1_hazard's -l format; C and S are the measured cycles per
+// instruction (per pair for a paired chain) before rounding.
+//
+//  --check runs without a target: every loop instruction must encode and
+// decode to itself and print and parse back (so the macros accept it), each
+// chain instruction must read what the one before it wrote and no stream
+// copy what the ones before it in its rotation wrote (per mxu1_deps.hpp),
+// and both loops must run in mxu1_emu.hpp from the program's initial state.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_deps.hpp"
+#include "mxu1_disasm.hpp"
+#include "mxu1_emu.hpp"
+#include "mxu1_isa.hpp"
+#include "mxu1_parse.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace mxu1;
+
+////////////////////////////////////////////////////////////////////////////////
+// Registers
+////////////////////////////////////////////////////////////////////////////////
+
+//  $a0 counts loop iterations down and $a1 points to a word aligned buffer
+// of kBufBytes; these GPRs hold constants, set on entry to every loop
+constexpr uint8_t kA1 = 5;
+constexpr uint32_t kBufBytes = 256;
+
+struct GprInit {
+  uint8_t  reg;
+  uint32_t value;
+};
+
+constexpr GprInit kGprInit[] = {
+  {9,  3},            // $t1: HI/LO multiplier, s32extr bit position
+  {10, 8},            // $t2: multiplicand, s32extrv length
+  {11, 1},            // $t3: d32sarw shift, s32aln byte count
+  {12, 0x12345678},   // $t4: s32i2m source
+  {13, 2},            // $t5: d32sllv and friends' shift
+};
+
+//  GPR results, in rotation in a stream ($v0, $v1, $t6..$t9)
+constexpr uint8_t kGprOut[] = {2, 3, 14, 15, 24, 25};
+
+//  The consumer of paired chains writes xr15; streams read fixed inputs from
+// xr15, xr14, xr13 and rotate their results through xr1..xr12
+constexpr uint8_t kXrConsumer = 15;
+constexpr uint8_t kXrFixed[] = {15, 14, 13};
+constexpr int kXrRotating = 12;
+
+//  Values of xr1..xr15 on entry to every loop
+constexpr uint32_t kXrInit[15] = {
+  0x01234567, 0x89abcdef, 0x00ff7f80, 0x7fff8001, 0x12345678, 0xfedcba98,
+  0x00010002, 0x80008000, 0x0f0f0f0f, 0x55aa55aa, 0x00007fff, 0xffff0001,
+  0x3c3c3c3c, 0x40004000, 0x00000003
+};
+
+//  The xr operand fields of a format, in macro operand order
+using Field = uint8_t Insn::*;
+
+std::vector<Field> xr_fields(Fmt f)
+{
+  switch (f) {
+    case Fmt::XA_XB_XC_XD_OPTN2:
+    case Fmt::XA_XB_XC_XD_APTN2_OPTN2:
+    case Fmt::XA_XB_XC_XD_APTN1_MPTN2:
+    case Fmt::XA_XB_XC_XD:
+    case Fmt::XA_XB_XC_XD_APTN2:
+    case Fmt::XA_XB_XC_XD_PTN:
+    case Fmt::XA_XB_XC_XD_SFT4:
+      return {&Insn::xra, &Insn::xrb, &Insn::xrc, &Insn::xrd};
+    case Fmt::XA_XB_XC_OPTN2:
+    case Fmt::XA_XB_XC:
+    case Fmt::XA_XB_XC_APTN2:
+    case Fmt::XA_XB_XC_SFT4:
+    case Fmt::XA_XB_XC_RS:
+    case Fmt::XA_XB_XC_PTN:
+      return {&Insn::xra, &Insn::xrb, &Insn::xrc};
+    case Fmt::XA_XD_RS:
+    case Fmt::XA_XD_RS_RT:
+    case Fmt::XA_XD_RS_BITS5:
+      return {&Insn::xra, &Insn::xrd};
+    case Fmt::RD_RS_RT_STRD2:
+      return {};
+    default:
+      return {&Insn::xra};
+  }
+}
+
+//  Bytes between successive offsets of a load/store format, 0 for others
+int offset_step(Fmt f)
+{
+  return f == Fmt::XA_RS_S12 ? 4 : f == Fmt::XA_RS_S10_PTN ? 2 :
+         f == Fmt::XA_RS_S8_PTN ? 1 : 0;
+}
+
+int lowest_bit(uint32_t m)
+{
+  int i = 0;
+  while (!(m & 1)) {
+    m >>= 1;
+    ++i;
+  }
+  return i;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Loops
+////////////////////////////////////////////////////////////////////////////////
+
+//  'op' with xr1, xr2... in its xr fields, the constant GPRs and $a1 in its
+// GPR fields, offset 0, and patterns that read no more than they must: byte
+// and halfword loads that replace the register rather than merge into it
+Insn base(Op op)
+{
+  Insn in;
+  const Fmt f = info(op).fmt;
+  const bool load = op_class(op) == OpClass::load;
+  uint8_t r = 1;
+
+  in.op = op;
+  for (Field x : xr_fields(f))
+    in.*x = r++;
+  switch (f) {
+    case Fmt::XA_XB_XC_XD_SFT4:
+    case Fmt::XA_XB_XC_SFT4:   in.imm = 1;  break;
+    case Fmt::XA_XD_RS:        in.rs = 13;  break;
+    case Fmt::XA_XD_RS_RT:     in.rs = 9;  in.rt = 10;  break;
+    case Fmt::XA_XD_RS_BITS5:  in.rs = 9;  in.imm = 8;  break;
+    case Fmt::XA_XB_XC_RS:     in.rs = 11;  break;
+    case Fmt::XA_XB_XC_PTN:    in.ptn = 1;  break;
+    case Fmt::XA_IMM8_PTN:     in.imm = 0x5a;  break;
+    case Fmt::XA16_RT:         in.rt = op == Op::s32i2m ? 12 : kGprOut[0];  break;
+    case Fmt::XA_RS_RT_STRD2:
+    case Fmt::XA_RS_S12:       in.rs = kA1;  break;
+    case Fmt::XA_RS_S8_PTN:    in.rs = kA1;  in.ptn = load ? 4 : 0;  break;
+    case Fmt::XA_RS_S10_PTN:   in.rs = kA1;  in.ptn = load ? 2 : 0;  break;
+    case Fmt::RD_RS_RT_STRD2:  in.rd = kGprOut[0];  in.rs = kA1;  break;
+    default:                   break;
+  }
+  return in;
+}
+
+//  Whether 'to' reads a register, or HI/LO, that 'from' writes. Base
+// register updates (ready the next cycle) never count, nor MXU_CR or HI/LO
+// unless asked for.
+bool reads(const Insn& to, const Insn& from, bool serial)
+{
+  const Deps t = deps(to), f = deps(from);
+  const uint32_t xr = serial ? ~0u : ~kCrBit;
+
+  return (t.xr_use & f.xr_def & xr) ||
+         (t.gpr_use & f.gpr_def & ~f.gpr_inc) ||
+         (serial && t.hilo_use && f.hilo_def);
+}
+
+//  Points an input field of 'in' at one of its outputs so that it reads its
+// own result; false if it cannot (loads, stores, and opcodes whose inputs
+// and outputs are of different kinds)
+bool make_chain(Insn& in)
+{
+  const OpClass c = op_class(in.op);
+
+  if (c == OpClass::load || c == OpClass::store)
+    return false;
+  if (reads(in, in, true))
+    return true;
+  const Deps d = deps(in);
+  const std::vector<Field> fields = xr_fields(info(in.op).fmt);
+  for (Field to : fields) {
+    if (!(d.xr_use & (1u << in.*to)))
+      continue;
+    for (Field from : fields) {
+      Insn t = in;
+      if (!(d.xr_def & (1u << in.*from)))
+        continue;
+      t.*to = in.*from;
+      if (reads(t, t, false)) {
+        in = t;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//  An instruction reading the first result of 'in', whose own result
+// nothing reads; false if 'in' has none (stores)
+bool consumer(const Insn& in, Insn& c)
+{
+  const Deps d = deps(in);
+  const uint32_t xr = d.xr_def & ~kCrBit, gpr = d.gpr_def & ~d.gpr_inc;
+
+  c = Insn();
+  c.xra = kXrConsumer;
+  if (xr) {
+    c.op = Op::s32or;
+    c.xrb = c.xrc = static_cast<uint8_t>(lowest_bit(xr));
+  } else if (gpr) {
+    c.op = Op::s32i2m;
+    c.rt = static_cast<uint8_t>(lowest_bit(gpr));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+struct Test {
+  Op                op;
+  std::vector<Insn> chain;      // Empty for stores
+  bool              paired = false;
+  std::vector<Insn> stream;
+  int               rotation = 1;
+  const char*       note = "";
+};
+
+Test make_test(Op op, int unroll)
+{
+  Test t;
+  Insn in = base(op), c;
+
+  t.op = op;
+  if (make_chain(in)) {
+    t.chain.assign(unroll, in);
+  } else if (consumer(in, c)) {
+    t.paired = true;
+    for (int k = 0; k < unroll; k += 2) {
+      t.chain.push_back(in);
+      t.chain.push_back(c);
+    }
+  }
+
+  in = base(op);
+  const Fmt f = info(op).fmt;
+  const Deps d = deps(in);
+  const bool gpr_out = (d.gpr_def & ~d.gpr_inc) != 0;
+  std::vector<Field> outs, ins;
+  for (Field x : xr_fields(f))
+    (d.xr_def & (1u << in.*x) ? outs : ins).push_back(x);
+  for (std::size_t i = 0; i < ins.size(); ++i)
+    in.*ins[i] = kXrFixed[i];
+  t.rotation = gpr_out ? static_cast<int>(sizeof(kGprOut)) :
+               outs.empty() ? 1 : kXrRotating / static_cast<int>(outs.size());
+  for (int k = 0; k < unroll; ++k) {
+    const int slot = k % t.rotation;
+    Insn s = in;
+    for (std::size_t j = 0; j < outs.size(); ++j)
+      s.*outs[j] = static_cast<uint8_t>(1 + slot * outs.size() + j);
+    if (gpr_out)
+      (f == Fmt::XA16_RT ? s.rt : s.rd) = kGprOut[slot];
+    if (offset_step(f) && !d.gpr_inc)
+      s.imm = k % 16 * offset_step(f);
+    t.stream.push_back(s);
+  }
+
+  if (d.hilo_use && d.hilo_def)
+    t.note = "serial through HI/LO";
+  else if (d.xr_use & d.xr_def & kCrBit)
+    t.note = "serial through MXU_CR";
+  return t;
+}
+
+std::vector<Test> make_tests(int unroll)
+{
+  std::vector<Test> tests;
+  for (std::size_t i = 0; i < kNumOps; ++i)
+    tests.push_back(make_test(static_cast<Op>(i), unroll));
+  return tests;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Host check
+////////////////////////////////////////////////////////////////////////////////
+
+//  Failures of one loop, reported on stderr
+int check_loop(const Test& t, const std::vector<Insn>& loop, bool chain)
+{
+  const char* const what = chain ? "chain" : "stream";
+  int failed = 0;
+
+  for (std::size_t k = 0; k < loop.size() && !failed; ++k) {
+    const Insn& in = loop[k];
+    const std::string text = to_string(in);
+    const std::size_t tab = text.find('\t');
+    Insn back;
+    std::string err;
+    if (decode(encode(in)) != in ||
+        !parse(text.substr(0, tab), tab == std::string::npos ? "" : text.substr(tab + 1), back, err) ||
+        back != in) {
+      std::fprintf(stderr, "%s %s: '%s' does not round-trip %s\n", name(t.op), what, text.c_str(), err.c_str());
+      ++failed;
+    } else if (chain && k > 0 && reads(in, loop[k - 1], true) != (!t.paired || k % 2)) {
+      std::fprintf(stderr, "%s chain: '%s' %s the one before\n", name(t.op), text.c_str(),
+                   t.paired && !(k % 2) ? "waits for" : "does not wait for");
+      ++failed;
+    } else if (!chain) {
+      for (int j = 1; j < t.rotation && j <= static_cast<int>(k); ++j) {
+        if (reads(in, loop[k - j], false)) {
+          std::fprintf(stderr, "%s stream: '%s' reads the result of '%s'\n", name(t.op), text.c_str(),
+                       to_string(loop[k - j]).c_str());
+          ++failed;
+          break;
+        }
+      }
+    }
+  }
+
+  uint32_t buf[kBufBytes / 4] = {};
+  State s;
+  s.mem.map(0x10000000, buf, kBufBytes);
+  s.gpr[kA1] = 0x10000000;
+  for (const GprInit& g : kGprInit)
+    s.gpr[g.reg] = g.value;
+  for (int i = 1; i < 16; ++i)
+    s.xr[i] = kXrInit[i - 1];
+  s.xr[16] = CR_MXU_EN;
+  try {
+    for (int pass = 0; pass < 2; ++pass) {
+      for (const Insn& in : loop)
+        s.exec(in);
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s %s: %s\n", name(t.op), what, e.what());
+    ++failed;
+  }
+  return failed;
+}
+
+int check(const std::vector<Test>& tests, int unroll)
+{
+  int failed = 0, loops = 0;
+
+  for (const Test& t : tests) {
+    if (!t.chain.empty()) {
+      failed += check_loop(t, t.chain, true);
+      ++loops;
+    } else if (op_class(t.op) != OpClass::store) {
+      std::fprintf(stderr, "%s: no chain\n", name(t.op));
+      ++failed;
+    }
+    failed += check_loop(t, t.stream, false);
+    ++loops;
+  }
+  std::printf("%zu opcodes, %d loops of %d instructions: %d failures\n", tests.size(), loops, unroll, failed);
+  return failed ? 1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Program
+////////////////////////////////////////////////////////////////////////////////
+
+void emit_line(FILE* out, const std::string& s)
+{
+  std::fprintf(out, "  \"%s\\n\"\n", s.c_str());
+}
+
+//  An instruction as the macros take it, mnemonic padded as in the kernels
+std::string insn_text(const Insn& in)
+{
+  std::string s = to_string(in);
+  const std::size_t tab = s.find('\t');
+  if (tab != std::string::npos)
+    s.replace(tab, 1, std::string(tab < 8 ? 8 - tab : 1, ' '));
+  return "  " + s;
+}
+
+void emit_loop(FILE* out, const std::string& fn, const std::vector<std::string>& body)
+{
+  emit_line(out, "");
+  emit_line(out, "LAT_BEGIN " + fn);
+  for (const std::string& s : body)
+    emit_line(out, s);
+  emit_line(out, "LAT_END   " + fn);
+}
+
+void emit_loop(FILE* out, const std::string& fn, const std::vector<Insn>& loop)
+{
+  std::vector<std::string> body;
+  for (const Insn& in : loop)
+    body.push_back(insn_text(in));
+  emit_loop(out, fn, body);
+}
+
+void emit(FILE* out, const std::vector<Test>& tests, int unroll)
+{
+  std::fprintf(out,
+    "// mxu1_lat.c, written by mxu1_latgen -u %d: edit the generator, not this\n"
+    "//\n"
+    "//  Times a dependent chain and an independent stream of every MXU1 opcode\n"
+    "// with the cycle counter, and prints each opcode's latency and issue\n"
+    "// interval in the format of mxu1_hazard -l (see tools/mxu1_latgen.cpp).\n"
+    "//\n"
+    "// Build and run on the target, -I the directory of mxu1_as_macros.s.h:\n"
+    "//     mipsel-linux-gcc -O2 -march=mips32r2 -Wa,-I.. -o mxu1_lat mxu1_lat.c\n"
+    "//     ./mxu1_lat > xburst.lat\n"
+    "\n"
+    "#define _POSIX_C_SOURCE 200112L\n"
+    "\n"
+    "#include <setjmp.h>\n"
+    "#include <signal.h>\n"
+    "#include <stdint.h>\n"
+    "#include <stdio.h>\n"
+    "#include <string.h>\n"
+    "#include <time.h>\n"
+    "\n"
+    "#if !defined(__mips__)\n"
+    "#error \"mxu1_lat.c runs on the target; check it on the host with mxu1_latgen --check\"\n"
+    "#endif\n"
+    "\n"
+    "#define UNROLL     %d\n"
+    "#define ITERATIONS 4000\n"
+    "#define REPEATS    7\n"
+    "\n"
+    "typedef void (*lat_fn)(uint32_t iterations, uint32_t *buf);\n"
+    "\n"
+    "void mxu1_lat_init(const uint32_t *xr);\n"
+    "void mxu1_lat_empty(uint32_t iterations, uint32_t *buf);\n"
+    "void mxu1_lat_addu(uint32_t iterations, uint32_t *buf);\n",
+    unroll, unroll);
+  for (const Test& t : tests) {
+    if (!t.chain.empty())
+      std::fprintf(out, "void mxu1_lat_%s_chain(uint32_t iterations, uint32_t *buf);\n", name(t.op));
+    std::fprintf(out, "void mxu1_lat_%s_stream(uint32_t iterations, uint32_t *buf);\n", name(t.op));
+  }
+
+  // The loops: $a0 iterations, $a1 the buffer
+  std::fprintf(out, "\n__asm__(\n");
+  emit_line(out, ".include \\\"mxu1_as_macros.s.h\\\"");
+  emit_line(out, "  .text");
+  emit_line(out, "  .set    push");
+  emit_line(out, "  .set    noreorder");
+  emit_line(out, ".macro LAT_BEGIN name");
+  emit_line(out, "  .globl  \\\\name");
+  emit_line(out, "  .type   \\\\name, @function");
+  emit_line(out, "  .ent    \\\\name");
+  emit_line(out, "\\\\name:");
+  for (const GprInit& g : kGprInit) {
+    char s[64];
+    std::snprintf(s, sizeof(s), "  li      %s, 0x%x", kGprName[g.reg], g.value);
+    emit_line(out, s);
+  }
+  emit_line(out, "1:");
+  emit_line(out, ".endm");
+  emit_line(out, ".macro LAT_END name");
+  emit_line(out, "  addiu   $a0,  $a0,  -1");
+  emit_line(out, "  bnez    $a0,  1b");
+  emit_line(out, "   nop");
+  emit_line(out, "  jr      $ra");
+  emit_line(out, "   nop");
+  emit_line(out, "  .end    \\\\name");
+  emit_line(out, "  .size   \\\\name, .-\\\\name");
+  emit_line(out, ".endm");
+  emit_line(out, "");
+  emit_line(out, "  .globl  mxu1_lat_init");
+  emit_line(out, "  .type   mxu1_lat_init, @function");
+  emit_line(out, "  .ent    mxu1_lat_init");
+  emit_line(out, "mxu1_lat_init:");
+  for (int i = 1; i < 16; ++i) {
+    emit_line(out, "  lw      $t0,  " + std::to_string(4 * (i - 1)) + "($a0)");
+    emit_line(out, "  s32i2m  xr" + std::to_string(i) + ", $t0");
+  }
+  emit_line(out, "  li      $t0,  1");  // MXU_CR: MXU_EN, rounding off
+  emit_line(out, "  jr      $ra");
+  emit_line(out, "   s32i2m xr16, $t0");
+  emit_line(out, "  .end    mxu1_lat_init");
+  emit_line(out, "  .size   mxu1_lat_init, .-mxu1_lat_init");
+  emit_loop(out, "mxu1_lat_empty", std::vector<std::string>());
+  emit_loop(out, "mxu1_lat_addu", std::vector<std::string>(unroll, "  addu    $t1,  $t1,  $t2"));
+  for (const Test& t : tests) {
+    if (!t.chain.empty())
+      emit_loop(out, std::string("mxu1_lat_") + name(t.op) + "_chain", t.chain);
+    emit_loop(out, std::string("mxu1_lat_") + name(t.op) + "_stream", t.stream);
+  }
+  emit_line(out, "");
+  emit_line(out, "  .set    pop");
+  std::fprintf(out, ");\n\n");
+
+  std::fprintf(out,
+    "static const struct {\n"
+    "  const char *key;\n"
+    "  lat_fn      chain, stream;   // No chain for stores\n"
+    "  int         paired;          // Chain alternates with a consumer\n"
+    "  const char *note;\n"
+    "} tests[] = {\n");
+  for (const Test& t : tests) {
+    const std::string n = name(t.op);
+    std::fprintf(out, "  { \"%s\", %s, mxu1_lat_%s_stream, %d, \"%s\" },\n", n.c_str(),
+                 t.chain.empty() ? "NULL" : ("mxu1_lat_" + n + "_chain").c_str(), n.c_str(),
+                 t.paired ? 1 : 0, t.note);
+  }
+  std::fprintf(out, "};\n\nstatic const uint32_t xr_init[15] = {\n");
+  for (int i = 0; i < 15; ++i)
+    std::fprintf(out, "%s0x%08x%s", i % 6 ? " " : "  ", kXrInit[i], i == 14 ? "\n" : i % 6 == 5 ? ",\n" : ",");
+  std::fprintf(out, "};\n\n");
+
+  std::fprintf(out, "static uint32_t buf[%u] __attribute__((aligned(32)));\n\n", kBufBytes / 4);
+  std::fputs(
+    "static int      use_cc;\n"
+    "static uint32_t cc_res;\n"
+    "static double   hz = 1;\n"
+    "\n"
+    "static sigjmp_buf probe_jump;\n"
+    "\n"
+    "static void probe_sigill(int sig)\n"
+    "{\n"
+    "  (void)sig;\n"
+    "  siglongjmp(probe_jump, 1);\n"
+    "}\n"
+    "\n"
+    "static uint32_t cycle_count(void)\n"
+    "{\n"
+    "  uint32_t c;\n"
+    "  __asm__ __volatile__(\".set push\\n\\t.set mips32r2\\n\\t\"\n"
+    "                       \"rdhwr %0, $2\\n\\t.set pop\" : \"=r\"(c));\n"
+    "  return c;\n"
+    "}\n"
+    "\n"
+    "//  Whether user space may read the cycle counter, and its resolution\n"
+    "static int probe_cc(void)\n"
+    "{\n"
+    "  struct sigaction sa, old;\n"
+    "  volatile int ok = 0;\n"
+    "\n"
+    "  memset(&sa, 0, sizeof(sa));\n"
+    "  sa.sa_handler = probe_sigill;\n"
+    "  sigemptyset(&sa.sa_mask);\n"
+    "  if (sigaction(SIGILL, &sa, &old))\n"
+    "    return 0;\n"
+    "  if (!sigsetjmp(probe_jump, 1)) {\n"
+    "    __asm__ __volatile__(\".set push\\n\\t.set mips32r2\\n\\t\"\n"
+    "                         \"rdhwr %0, $3\\n\\t.set pop\" : \"=r\"(cc_res));\n"
+    "    (void)cycle_count();\n"
+    "    ok = cc_res != 0;\n"
+    "  }\n"
+    "  sigaction(SIGILL, &old, NULL);\n"
+    "  return ok;\n"
+    "}\n"
+    "\n"
+    "static double seconds(void)\n"
+    "{\n"
+    "  struct timespec ts;\n"
+    "  clock_gettime(CLOCK_MONOTONIC, &ts);\n"
+    "  return ts.tv_sec + ts.tv_nsec * 1e-9;\n"
+    "}\n"
+    "\n"
+    "//  Cycles per iteration of f, fastest of REPEATS runs\n"
+    "static double cycles(lat_fn f)\n"
+    "{\n"
+    "  double best = 1e30;\n"
+    "\n"
+    "  for (int r = 0; r < REPEATS; ++r) {\n"
+    "    double t;\n"
+    "    mxu1_lat_init(xr_init);\n"
+    "    if (use_cc) {\n"
+    "      const uint32_t c0 = cycle_count();\n"
+    "      f(ITERATIONS, buf);\n"
+    "      t = (double)(uint32_t)(cycle_count() - c0) * cc_res;\n"
+    "    } else {\n"
+    "      const double t0 = seconds();\n"
+    "      f(ITERATIONS, buf);\n"
+    "      t = (seconds() - t0) * hz;\n"
+    "    }\n"
+    "    best = t < best ? t : best;\n"
+    "  }\n"
+    "  return best / ITERATIONS;\n"
+    "}\n"
+    "\n"
+    "static int rounded(double c)\n"
+    "{\n"
+    "  return c < 1.5 ? 1 : (int)(c + 0.5);\n"
+    "}\n"
+    "\n"
+    "int main(void)\n"
+    "{\n"
+    "  char model[256] = \"unknown\", line[256];\n"
+    "  FILE *f = fopen(\"/proc/cpuinfo\", \"r\");\n"
+    "  double empty, addu;\n"
+    "\n"
+    "  while (f && fgets(line, sizeof(line), f)) {\n"
+    "    const char *colon = strchr(line, ':');\n"
+    "    if (!strncmp(line, \"cpu model\", 9) && colon) {\n"
+    "      snprintf(model, sizeof(model), \"%s\", colon + 2);\n"
+    "      model[strcspn(model, \"\\n\")] = 0;\n"
+    "      break;\n"
+    "    }\n"
+    "  }\n"
+    "  if (f)\n"
+    "    fclose(f);\n"
+    "\n"
+    "  //  Without the counter, seconds until the addu chain gives the clock\n"
+    "  use_cc = probe_cc();\n"
+    "  empty = cycles(mxu1_lat_empty);\n"
+    "  addu = cycles(mxu1_lat_addu) - empty;\n"
+    "  if (!use_cc) {\n"
+    "    hz = UNROLL / addu;\n"
+    "    empty = cycles(mxu1_lat_empty);\n"
+    "    addu = cycles(mxu1_lat_addu) - empty;\n"
+    "  }\n"
+    "\n"
+    "  printf(\"# Latency and issue interval of every MXU1 opcode, for mxu1_hazard -l\\n\");\n"
+    "  printf(\"# core: %s\\n\", model);\n"
+    "  if (use_cc)\n"
+    "    printf(\"# cycles: rdhwr $2 x %u; addu chain %.2f cycles per addu\\n\",\n"
+    "           (unsigned)cc_res, addu / UNROLL);\n"
+    "  else\n"
+    "    printf(\"# cycles: clock_gettime() at %.1f MHz, from an addu chain\\n\",\n"
+    "           hz * 1e-6);\n"
+    "  printf(\"# %d per loop, fastest of %d runs, %.1f cycles of loop overhead\\n\",\n"
+    "         UNROLL, REPEATS, empty);\n"
+    "  printf(\"# chain, stream: cycles per instruction measured (per pair if paired)\\n\");\n"
+    "  printf(\"# <key>   <latency> <interval>\\n\");\n"
+    "  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {\n"
+    "    const double s = (cycles(tests[i].stream) - empty) / UNROLL;\n"
+    "    double c = 0;\n"
+    "    int latency = 1;\n"
+    "\n"
+    "    if (tests[i].chain) {\n"
+    "      c = (cycles(tests[i].chain) - empty) / UNROLL;\n"
+    "      if (tests[i].paired)\n"
+    "        c *= 2;\n"
+    "      latency = rounded(tests[i].paired ? c - 1 : c);\n"
+    "    }\n"
+    "    printf(\"%-10s %2d %2d   # chain \", tests[i].key, latency, rounded(s));\n"
+    "    if (tests[i].chain)\n"
+    "      printf(\"%5.2f%s\", c, tests[i].paired ? \" paired\" : \"\");\n"
+    "    else\n"
+    "      printf(\"    -\");\n"
+    "    printf(\"  stream %5.2f%s%s\\n\", s, *tests[i].note ? \"  \" : \"\",\n"
+    "           tests[i].note);\n"
+    "  }\n"
+    "  return 0;\n"
+    "}\n", out);
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr, "usage: %s [-u UNROLL] [-o OUT | --check]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string out_path;
+  bool check_only = false;
+  int unroll = 64;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "-o" && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (a == "-u" && i + 1 < argc) {
+      unroll = std::atoi(argv[++i]);
+      if (unroll < 8 || unroll > 512 || unroll % 2) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (a == "--check") {
+      check_only = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  const std::vector<Test> tests = make_tests(unroll);
+  if (check_only)
+    return check(tests, unroll);
+
+  FILE* out = out_path.empty() || out_path == "-" ? stdout : std::fopen(out_path.c_str(), "w");
+  if (!out) {
+    std::perror(out_path.c_str());
+    return 2;
+  }
+  emit(out, tests, unroll);
+  if (out != stdout)
+    std::fclose(out);
+  return 0;
+}
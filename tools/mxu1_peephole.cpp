@@ -0,0 +1,987 @@
+// mxu1_peephole.cpp
+//
+// Source-level peephole optimizer fusing MXU instruction sequences
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+// Build:  c++ -std=c++14 -O2 -I.. -o mxu1_peephole mxu1_peephole.cpp
+//
+// Usage:
+//   mxu1_peephole [-o OUT] [-n] [--live-out REGS] FILE
+//
+//   Rewrites FILE (.s or .S, or '-' for stdin) and writes the result to OUT,
+//   or to stdout. OUT may be FILE itself. With -n nothing is written, and
+//   only the report is produced. The report goes to stderr, one line per
+//   function with the instruction count saved and the rewrites applied.
+//   Rewritten statements are laid out as in the kernels (mnemonic padded to
+//   8 columns, register operands to 6), with trailing comments left in their
+//   column; every other line is copied unchanged.
+//
+//   --live-out REGS  Comma-separated xr registers (or 'all') that callers
+//                    expect to hold results on return; see below.
+//
+// Rewrites (A, B, C, D: any xr; P, Q, Y: temporaries that die there):
+//
+//   d16mul  P,B,C,Q,o  + d32asum A,P,Q,D,a           -> d16mac  A,B,C,D,a,o
+//   d16mul  P,B,C,Q,o  + d32add  A,A,P,xr0,a         -> d16mac  A,B,C,xr0,a,o
+//   d16mul  P,B,C,Q,o  + s32sfl  Y,P,Q,Y2,ptn3
+//                      + q16add  D,A,Y2,xr0,a,WW     -> d16madl A,B,C,D,a',o
+//   q8mul   P,B,C,Q    + q16accm A,P,Q,D,a           -> q8mac   A,B,C,D,a
+//   q8mul   P,B,C,Q    + q16add  A,A,P,xr0,a,WW      -> q8mac   A,B,C,xr0,a
+//   (q8mulsu likewise gives q8macsu)
+//
+//   s32ldd  X,rs,k  ... addiu rs,rs,k                -> s32ldi  X,rs,k ...
+//   addiu   rs,rs,k ... s32ldd X,rs,0                -> ... s32ldi X,rs,k
+//   s32lddv X,rs,rt,0 ... addu rs,rs,rt              -> s32ldiv X,rs,rt,0 ...
+//   (likewise every s8/s16/s32 load and store with an _i_ncrementing form;
+//    memory operands on rs in between have their offsets adjusted)
+//
+//  Where the right-hand side of a pattern has 'xr0', the original may have any
+// register that is dead there. Each rewrite is applied only when it provably
+// leaves every live register, HI/LO, the MXU_CR carry bits and memory as the
+// original would: the deleted instructions' results must have no other
+// readers and be dead afterwards (by liveness analysis over the whole file's
+// control flow), their operands must not change before the point where the
+// fused instruction now executes, and nothing may be deleted from a branch
+// delay slot or moved across a label or branch. No instruction that reads or
+// writes HI/LO is ever created, deleted or moved.
+//
+//  The MXU registers are not part of the MIPS calling convention, so they are
+// taken to be dead at 'jr $ra' unless --live-out says otherwise; GPR results
+// ($v0, $v1) and callee-saved GPRs are always live there. Unknown statements,
+// including invocations of macros defined in FILE itself, are assumed to read
+// and write everything. For .S files, preprocessor lines are left alone and
+// code using C macros for operands is simply not rewritten.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mips32_deps.hpp"
+#include "mxu1_deps.hpp"
+#include "mxu1_disasm.hpp"
+#include "mxu1_parse.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace mxu1;
+
+// Resource bits: xr0..15 -> 0..15, MXU_CR carry bits -> 16, GPRs -> 17..48,
+//  HI/LO -> 49
+constexpr int      kGpr0   = 17;
+constexpr uint64_t kCarry  = 1ull << 16;
+constexpr uint64_t kHiLo   = 1ull << 49;
+constexpr uint64_t kAll    = (1ull << 50) - 1;
+constexpr uint64_t kAllXr  = 0xfffe;
+
+uint64_t xr_bit(unsigned r)  { return r ? 1ull << r : 0; }
+uint64_t gpr_bit(unsigned r) { return r ? 1ull << (kGpr0 + r) : 0; }
+uint64_t gpr_mask(uint32_t m) { return static_cast<uint64_t>(m & ~1u) << kGpr0; }
+
+struct Stmt {
+  int         line = 0;
+  std::size_t sb = 0, se = 0;        // Its ';'-separated segment of the line
+  std::size_t b = 0, e = 0;          // The statement proper, without labels
+  std::vector<std::string> labels;
+  std::string mnemonic, operands;
+  bool        mxu = false, mips = false, barrier = false;
+  Insn        in;
+  MipsDeps    md;
+  uint64_t    use = 0, def = 0;
+  bool        ret = false;           // 'jr $ra'
+  bool        exit = false;          // Indirect jump elsewhere
+  bool        delay_owner = false;   // Branch whose delay slot is the next statement
+  bool        in_delay = false;      // Sits in a branch delay slot
+  std::string func;
+  bool        deleted = false;
+  std::string text;                  // Replacement text, if rewritten
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Reading
+////////////////////////////////////////////////////////////////////////////////
+
+// Spans of the ';'-separated statements of 'line', ending at any comment
+std::vector<std::pair<std::size_t, std::size_t>> segments(const std::string& line)
+{
+  std::vector<std::pair<std::size_t, std::size_t>> out;
+  bool in_str = false;
+  std::size_t start = 0, i = 0;
+  for (; i < line.size(); ++i) {
+    const char ch = line[i];
+    if (ch == '"' && (i == 0 || line[i - 1] != '\\'))
+      in_str = !in_str;
+    if (in_str)
+      continue;
+    if (ch == '#')
+      break;
+    if (ch == ';') {
+      out.push_back({start, i});
+      start = i + 1;
+    }
+  }
+  out.push_back({start, i});
+  return out;
+}
+
+// use/def of an already classified statement
+void set_uses(Stmt& s)
+{
+  if (s.mxu) {
+    const Deps d = deps(s.in);
+    s.use = (d.xr_use & kAllXr) | gpr_mask(d.gpr_use) | (d.hilo_use ? kHiLo : 0);
+    s.def = (d.xr_def & kAllXr) | gpr_mask(d.gpr_def) | (d.hilo_def ? kHiLo : 0);
+    // Of MXU_CR only the carries are tracked: d32add replaces them, d32addc
+    //  and reads of xr16 consume them. The other CR bits never change here.
+    if (s.in.op == Op::d32add || (s.in.op == Op::s32i2m && s.in.xra == 16))
+      s.def |= kCarry;
+    if (s.in.op == Op::d32addc || (s.in.op == Op::s32m2i && s.in.xra == 16))
+      s.use |= kCarry;
+  } else if (s.mips) {
+    const MipsDeps& d = s.md;
+    s.use = gpr_mask(d.gpr_use) | (d.hilo_use ? kHiLo : 0);
+    s.def = gpr_mask(d.gpr_def) | (d.hilo_def ? kHiLo : 0);
+    if (d.call)
+      s.use = kAll;   // Whatever is called may read anything
+    if (d.branch && !d.call && d.target.empty()) {
+      s.ret = d.gpr_use == 1u << 31;
+      s.exit = !s.ret;
+    }
+  } else {
+    s.use = s.def = kAll;
+  }
+}
+
+void classify(Stmt& s, bool noreorder)
+{
+  std::string err;
+  s.mxu = s.mips = s.barrier = false;
+  if (s.mnemonic[0] == '.') {
+    int32_t w;
+    if ((s.mnemonic == ".word" || s.mnemonic == ".long" || s.mnemonic == ".4byte") &&
+        detail::parse_int(s.operands, w) && decode(static_cast<uint32_t>(w)).op != Op::invalid) {
+      s.in = decode(static_cast<uint32_t>(w));
+      s.mxu = true;
+    } else {
+      return;   // Some other directive, not a statement we track
+    }
+  } else if (parse(s.mnemonic, s.operands, s.in, err)) {
+    s.mxu = true;
+  } else if (err.empty() && mips_deps(s.mnemonic, s.operands, s.md)) {
+    s.mips = true;
+    s.delay_owner = s.md.branch && noreorder;
+  } else {
+    s.barrier = true;
+  }
+  set_uses(s);
+}
+
+// Statements of 'lines', with the names declared as functions
+void read_source(const std::vector<std::string>& lines, std::vector<Stmt>& stmts, std::set<std::string>& funcs)
+{
+  bool noreorder = false, in_macro = false;
+  std::vector<std::string> pending;
+  for (std::size_t ln = 0; ln < lines.size(); ++ln) {
+    const std::string& text = lines[ln];
+    for (const auto& sp : segments(text)) {
+      const std::string seg = text.substr(sp.first, sp.second - sp.first);
+      const std::vector<Statement> sts = split_statements(seg);
+      if (sts.empty())
+        continue;
+      const Statement& st = sts[0];
+      if (in_macro) {
+        in_macro = st.mnemonic != ".endm";
+        continue;
+      }
+      pending.insert(pending.end(), st.labels.begin(), st.labels.end());
+      if (st.mnemonic.empty())
+        continue;
+      if (st.mnemonic == ".macro") {
+        in_macro = true;
+        continue;
+      }
+      if (st.mnemonic == ".set") {
+        if (st.operands == "noreorder")
+          noreorder = true;
+        else if (st.operands == "reorder")
+          noreorder = false;
+        continue;
+      }
+      if (st.mnemonic == ".globl" || st.mnemonic == ".global" || st.mnemonic == ".ent") {
+        funcs.insert(detail::trim(st.operands));
+        continue;
+      }
+      if (st.mnemonic == ".type") {
+        const std::vector<std::string> a = split_operands(st.operands);
+        if (a.size() == 2 && (a[1] == "@function" || a[1] == "%function"))
+          funcs.insert(a[0]);
+        continue;
+      }
+
+      Stmt s;
+      s.line = static_cast<int>(ln);
+      s.sb = sp.first;
+      s.se = sp.second;
+      std::size_t at = 0;
+      for (const std::string& l : st.labels)
+        at = seg.find(':', seg.find(l, at) + l.size()) + 1;
+      s.b = sp.first + seg.find(st.mnemonic, at);
+      s.e = sp.second;
+      while (s.e > s.b && std::isspace(static_cast<unsigned char>(text[s.e - 1])))
+        --s.e;
+      s.mnemonic = st.mnemonic;
+      s.operands = st.operands;
+      classify(s, noreorder);
+      if (!s.mxu && !s.mips && !s.barrier)
+        continue;
+      s.labels.swap(pending);
+      stmts.push_back(std::move(s));
+    }
+  }
+  for (std::size_t i = 0; i + 1 < stmts.size(); ++i) {
+    if (stmts[i].delay_owner)
+      stmts[i + 1].in_delay = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Liveness
+////////////////////////////////////////////////////////////////////////////////
+
+class Flow {
+ public:
+  Flow(const std::vector<Stmt>& s, uint64_t ret_live) : s_(s), ret_live_(ret_live)
+  {
+    for (std::size_t i = 0; i < s.size(); ++i) {
+      for (const std::string& l : s[i].labels)
+        labels_[l].push_back(static_cast<int>(i));
+    }
+  }
+
+  void compute()
+  {
+    const int n = static_cast<int>(s_.size());
+    std::vector<std::vector<int>> succ(n);
+    std::vector<uint64_t> exit_live(n, 0);
+    for (int i = 0; i < n; ++i) {
+      const Stmt& st = s_[i];
+      if (st.delay_owner) {
+        succ[i].push_back(i + 1);
+        if (st.md.likely)
+          succ[i].push_back(i + 2);   // Not taken: the delay slot is skipped
+        continue;
+      }
+      // The branch that takes effect once this statement is done, if any
+      const int owner = st.in_delay ? i - 1 : st.mips && st.md.branch ? i : -1;
+      if (owner < 0) {
+        succ[i].push_back(i + 1);
+        continue;
+      }
+      const Stmt& br = s_[owner];
+      if (br.md.call || (br.md.cond && !(br.md.likely && owner != i)))
+        succ[i].push_back(i + 1);
+      if (br.md.call)
+        continue;
+      if (br.ret) {
+        exit_live[i] = ret_live_;
+      } else if (br.exit) {
+        exit_live[i] = kAll;
+      } else {
+        const int t = resolve(br.md.target, owner);
+        if (t >= 0)
+          succ[i].push_back(t);
+        else
+          exit_live[i] = kAll;   // Tail call, or a jump out of this file
+      }
+    }
+
+    live_in_.assign(n + 2, 0);
+    live_out_.assign(n, 0);
+    live_in_[n] = live_in_[n + 1] = kAll;   // Falling off the end
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (int i = n - 1; i >= 0; --i) {
+        uint64_t out = exit_live[i];
+        for (int t : succ[i])
+          out |= live_in_[std::min(t, n)];
+        const Stmt& st = s_[i];
+        const uint64_t in = st.deleted ? out : st.use | (out & ~st.def);
+        if (out != live_out_[i] || in != live_in_[i]) {
+          live_out_[i] = out;
+          live_in_[i] = in;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  uint64_t live_out(int i) const { return live_out_[i]; }
+
+ private:
+  // Statement index of the branch target 't' of statement 'from'
+  int resolve(const std::string& t, int from) const
+  {
+    if (t.size() > 1 && std::isdigit(static_cast<unsigned char>(t[0])) && (t.back() == 'b' || t.back() == 'f')) {
+      auto it = labels_.find(t.substr(0, t.size() - 1));
+      if (it == labels_.end())
+        return -1;
+      int best = -1;
+      for (int k : it->second) {
+        if (t.back() == 'b' ? (k <= from && k > best) : (k > from && (best < 0 || k < best)))
+          best = k;
+      }
+      return best;
+    }
+    auto it = labels_.find(t);
+    return it == labels_.end() || it->second.size() != 1 ? -1 : it->second[0];
+  }
+
+  const std::vector<Stmt>& s_;
+  uint64_t ret_live_;
+  std::map<std::string, std::vector<int>> labels_;
+  std::vector<uint64_t> live_in_, live_out_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Rewrites
+////////////////////////////////////////////////////////////////////////////////
+
+bool valid(const Insn& in) { return decode(encode(in)) == in; }
+
+// The base-updating form of an MXU load/store, or Op::invalid
+Op incrementing_form(Op op)
+{
+  switch (op) {
+    case Op::s32ldd:   return Op::s32ldi;
+    case Op::s32lddr:  return Op::s32ldir;
+    case Op::s32std:   return Op::s32sdi;
+    case Op::s32stdr:  return Op::s32sdir;
+    case Op::s8ldd:    return Op::s8ldi;
+    case Op::s8std:    return Op::s8sdi;
+    case Op::s16ldd:   return Op::s16ldi;
+    case Op::s16std:   return Op::s16sdi;
+    case Op::s32lddv:  return Op::s32ldiv;
+    case Op::s32lddvr: return Op::s32ldivr;
+    case Op::s32stdv:  return Op::s32sdiv;
+    case Op::s32stdvr: return Op::s32sdivr;
+    default:           return Op::invalid;
+  }
+}
+
+bool is_indexed(Op op)
+{
+  return op == Op::s32lddv || op == Op::s32lddvr || op == Op::s32stdv || op == Op::s32stdvr;
+}
+
+// 'addiu rs, rs, k' or 'addu rs, rs, rt' (rt = -1 for the former). Returns
+//  rs, or -1 if 's' is not a pointer bump.
+int bump(const Stmt& s, int32_t& k, int& rt)
+{
+  if (!s.mips || (s.mnemonic != "addiu" && s.mnemonic != "addu"))
+    return -1;
+  const std::vector<std::string> a = split_operands(s.operands);
+  if (a.size() != 2 && a.size() != 3)
+    return -1;
+  const int rs = detail::parse_gpr(a[0]);
+  const int x = a.size() == 2 ? rs : detail::parse_gpr(a[1]);
+  const int y = detail::parse_gpr(a.back());
+  if (rs <= 0)
+    return -1;
+  if (y < 0) {
+    rt = -1;
+    return x == rs && detail::parse_int(a.back(), k) ? rs : -1;
+  }
+  k = 0;
+  if (x == rs && y > 0 && y != rs)
+    rt = y;
+  else if (y == rs && x > 0 && x != rs)
+    rt = x;
+  else
+    return -1;
+  return rs;
+}
+
+class Optimizer {
+ public:
+  Optimizer(const std::vector<std::string>& lines, std::vector<Stmt>& s, uint64_t ret_live)
+      : lines_(lines), s_(s), flow_(s, ret_live)
+  {
+  }
+
+  // Apply rewrites until none is left. Returns each one's name and the
+  //  statement it left behind.
+  std::vector<std::pair<int, std::string>> run()
+  {
+    std::vector<std::pair<int, std::string>> done;
+    for (;;) {
+      flow_.compute();
+      std::string what;
+      int at = -1;
+      for (int i = 0; i < static_cast<int>(s_.size()); ++i) {
+        if (!s_[i].deleted &&
+            (try_mac(i, what, at) || try_madl(i, what, at) || try_post_inc(i, what, at) ||
+             try_pre_inc(i, what, at)))
+          break;
+      }
+      if (at < 0)
+        return done;
+      done.push_back({at, what});
+    }
+  }
+
+ private:
+  int next(int i) const
+  {
+    for (++i; i < static_cast<int>(s_.size()); ++i) {
+      if (!s_[i].deleted)
+        return i;
+    }
+    return -1;
+  }
+
+  // Straight-line code from i to k (i < k): no label on (i, k], and no
+  //  control transfer or unknown statement on [i, k)
+  bool same_block(int i, int k) const
+  {
+    for (int m = i; m < k; ++m) {
+      const Stmt& s = s_[m];
+      if (s.deleted)
+        continue;
+      if ((s.mips && s.md.branch) || s.in_delay || s.barrier || (m > i && !s.labels.empty()))
+        return false;
+    }
+    return s_[k].labels.empty();
+  }
+
+  // First statement after i, in the same block, that reads any of 'regs'
+  int next_reader(int i, uint64_t regs) const
+  {
+    for (int k = next(i); k >= 0 && same_block(i, k); k = next(k)) {
+      if (s_[k].use & regs)
+        return k;
+    }
+    return -1;
+  }
+
+  // Conditions for deleting 'gone' (all before j) while rewriting j: their
+  //  results are read by nothing but each other and j, are dead after j
+  //  unless j's rewritten form writes them ('kept'), and no statement in
+  //  between writes their results or their operands.
+  bool can_fuse(const std::vector<int>& gone, int j, uint64_t kept) const
+  {
+    for (int g : gone) {
+      const Stmt& s = s_[g];
+      if (s.in_delay || s.delay_owner || !same_block(g, j))
+        return false;
+      if (s.def & ~kept & flow_.live_out(j))
+        return false;
+      for (int m = g + 1; m < j; ++m) {
+        const Stmt& t = s_[m];
+        if (t.deleted)
+          continue;
+        if (t.def & s.use)
+          return false;
+        if (std::find(gone.begin(), gone.end(), m) == gone.end() && ((t.use | t.def) & s.def))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // Statement text in the kernels' layout: the mnemonic padded to 8 columns,
+  //  and every register operand but the last, with its comma, to 6
+  static std::string layout(const std::string& mnemonic, const std::string& operands)
+  {
+    std::string t = mnemonic + std::string(mnemonic.size() < 8 ? 8 - mnemonic.size() : 1, ' ');
+    const std::vector<std::string> a = split_operands(operands);
+    for (std::size_t k = 0; k < a.size(); ++k) {
+      t += a[k];
+      if (k + 1 == a.size())
+        break;
+      t += ',';
+      const bool reg = !a[k].empty() && (a[k][0] == '$' || a[k][0] == '\\' || a[k].compare(0, 2, "xr") == 0);
+      t.append(reg && a[k].size() < 5 ? 5 - a[k].size() : 1, ' ');
+    }
+    return t;
+  }
+
+  void replace(int j, const Insn& in)
+  {
+    Stmt& s = s_[j];
+    const std::string t = to_string(in);
+    const std::size_t tab = t.find('\t');
+    s.text = layout(t.substr(0, tab), t.substr(tab + 1));
+    s.in = in;
+    set_uses(s);
+  }
+
+  // d16mul/q8mul + accumulate -> d16mac/q8mac
+  bool try_mac(int i, std::string& what, int& at)
+  {
+    const Stmt& m = s_[i];
+    if (!m.mxu || (m.in.op != Op::d16mul && m.in.op != Op::q8mul && m.in.op != Op::q8mulsu))
+      return false;
+    const unsigned P = m.in.xra, Q = m.in.xrd;
+    if (!P || !Q || P == Q)
+      return false;
+    const int j = next_reader(i, xr_bit(P) | xr_bit(Q));
+    if (j < 0 || !s_[j].mxu)
+      return false;
+    const Insn a = s_[j].in;
+    const bool d16 = m.in.op == Op::d16mul;
+
+    Insn f;
+    f.op = d16 ? Op::d16mac : m.in.op == Op::q8mul ? Op::q8mac : Op::q8macsu;
+    f.xrb = m.in.xrb;
+    f.xrc = m.in.xrc;
+    f.optn = d16 ? m.in.optn : 0;
+    uint64_t kept;
+
+    if ((a.op == Op::d32asum && d16) || (a.op == Op::q16accm && !d16)) {
+      // A lane fed from xr0 is left as it was, so need not be written at all
+      if ((a.xrb != P && a.xrb) || (a.xrc != Q && a.xrc) || (!a.xrb && !a.xrc))
+        return false;
+      if (a.xra == a.xrd || a.xra == P || a.xra == Q || a.xrd == P || a.xrd == Q)
+        return false;
+      f.xra = a.xrb ? a.xra : 0;
+      f.xrd = a.xrc ? a.xrd : 0;
+      f.aptn = a.aptn;
+      kept = xr_bit(f.xra) | xr_bit(f.xrd);
+    } else if ((a.op == Op::d32add && d16) || (a.op == Op::q16add && !d16 && a.optn == 0)) {
+      // 'XRa = XRa +/- P', with the XRd result unwanted
+      if (a.xrb != a.xra || a.xrc != P || !a.xra || a.xra == P || a.xra == Q)
+        return false;
+      if (a.xrd && a.xrd != a.xra && (flow_.live_out(j) & xr_bit(a.xrd)))
+        return false;
+      if (a.op == Op::d32add && (flow_.live_out(j) & kCarry))
+        return false;
+      f.xra = a.xra;
+      f.aptn = a.aptn & 2;
+      kept = xr_bit(a.xra);
+    } else {
+      return false;
+    }
+    if (!valid(f) || !can_fuse({i}, j, kept))
+      return false;
+
+    what = std::string(name(m.in.op)) + "+" + name(a.op) + "->" + name(f.op);
+    s_[i].deleted = true;
+    replace(j, f);
+    at = j;
+    return true;
+  }
+
+  // d16mul + s32sfl ptn3 + q16add -> d16madl
+  bool try_madl(int i, std::string& what, int& at)
+  {
+    const Stmt& m = s_[i];
+    if (!m.mxu || m.in.op != Op::d16mul)
+      return false;
+    const unsigned P = m.in.xra, Q = m.in.xrd;
+    if (!P || !Q || P == Q)
+      return false;
+    const int k = next_reader(i, xr_bit(P) | xr_bit(Q));
+    if (k < 0 || !s_[k].mxu)
+      return false;
+    const Insn sf = s_[k].in;
+    if (sf.op != Op::s32sfl || sf.ptn != 3 || sf.xrb != P || sf.xrc != Q || !sf.xrd || sf.xra == sf.xrd)
+      return false;
+    const unsigned Y2 = sf.xrd;
+    const int j = next_reader(k, xr_bit(Y2));
+    if (j < 0 || !s_[j].mxu)
+      return false;
+    const Insn a = s_[j].in;
+    if (a.op != Op::q16add || a.optn != 0 || a.xrc != Y2 || !a.xra)
+      return false;
+    if (a.xrb == P || a.xrb == Q || a.xrb == Y2 || (sf.xra && a.xrb == sf.xra))
+      return false;
+    if (a.xrd && a.xrd != a.xra && (flow_.live_out(j) & xr_bit(a.xrd)))
+      return false;
+    if (!can_fuse({i, k}, j, xr_bit(a.xra)))
+      return false;
+
+    Insn f;
+    f.op = Op::d16madl;
+    f.xra = a.xrb;
+    f.xrb = m.in.xrb;
+    f.xrc = m.in.xrc;
+    f.xrd = a.xra;
+    f.aptn = (a.aptn & 2) ? 3 : 0;   // q16add applies XRa's add/sub to both lanes
+    f.optn = m.in.optn;
+    if (!valid(f))
+      return false;
+
+    what = "d16mul+s32sfl+q16add->d16madl";
+    s_[i].deleted = s_[k].deleted = true;
+    replace(j, f);
+    at = j;
+    return true;
+  }
+
+  // New text for 's', a memory access off 'rs', with its offset moved by
+  //  'delta'; false if 's' reads 'rs' in any other way.
+  bool shifted(const Stmt& s, int rs, int32_t delta, std::string& text) const
+  {
+    if (s.mxu) {
+      if (incrementing_form(s.in.op) == Op::invalid || is_indexed(s.in.op) || s.in.rs != rs)
+        return false;
+      Insn t = s.in;
+      t.imm += delta;
+      if (!valid(t))
+        return false;
+      const std::string f = to_string(t);
+      const std::size_t tab = f.find('\t');
+      text = layout(f.substr(0, tab), f.substr(tab + 1));
+      return true;
+    }
+    if (!s.mips || !(s.md.load || s.md.store) || s.md.gpr_use & s.md.gpr_def)
+      return false;
+    const std::vector<std::string> a = split_operands(s.operands);
+    if (a.size() != 2 || detail::parse_gpr(a[0]) == rs)
+      return false;
+    const std::size_t lp = a[1].rfind('(');
+    int32_t off = 0;
+    if (lp == std::string::npos || a[1].back() != ')' ||
+        detail::parse_gpr(detail::trim(a[1].substr(lp + 1, a[1].size() - lp - 2))) != rs ||
+        (lp > 0 && !detail::parse_int(detail::trim(a[1].substr(0, lp)), off)))
+      return false;
+    off += delta;
+    if (off < -32768 || off > 32767)
+      return false;
+    text = layout(s.mnemonic, a[0] + ", " + std::to_string(off) + a[1].substr(lp));
+    return true;
+  }
+
+  // Offset fixups for the statements in (i, j) that address off 'rs', which
+  //  now holds 'delta' more than it did
+  bool fixups(int i, int j, int rs, int32_t delta, std::vector<std::pair<int, std::string>>& out) const
+  {
+    const uint64_t R = gpr_bit(static_cast<unsigned>(rs));
+    for (int m = i + 1; m < j; ++m) {
+      const Stmt& s = s_[m];
+      if (s.deleted || !((s.use | s.def) & R))
+        continue;
+      std::string text;
+      if ((s.def & R) || !shifted(s, rs, -delta, text))
+        return false;
+      out.push_back({m, text});
+    }
+    return true;
+  }
+
+  void apply(const std::vector<std::pair<int, std::string>>& fix)
+  {
+    for (const auto& f : fix) {
+      Stmt& s = s_[f.first];
+      s.text = f.second;
+      if (s.mxu) {
+        const std::size_t sp = s.text.find_first_of(" \t");
+        std::string err;
+        parse(s.text.substr(0, sp), detail::trim(s.text.substr(sp)), s.in, err);
+      }
+    }
+  }
+
+  // load/store off rs + 'rs += k' (k the same offset) -> base-updating form
+  bool try_post_inc(int i, std::string& what, int& at)
+  {
+    const Stmt& l = s_[i];
+    if (!l.mxu || incrementing_form(l.in.op) == Op::invalid || !l.in.rs)
+      return false;
+    const int rs = l.in.rs;
+    const uint64_t R = gpr_bit(static_cast<unsigned>(rs));
+    int j = -1;
+    for (int k = next(i); k >= 0 && same_block(i, k); k = next(k)) {
+      if (s_[k].def & R) {
+        j = k;
+        break;
+      }
+    }
+    int32_t inc;
+    int rt;
+    if (j < 0 || bump(s_[j], inc, rt) != rs || s_[j].in_delay || s_[j].delay_owner)
+      return false;
+    std::vector<std::pair<int, std::string>> fix;
+    if (is_indexed(l.in.op)) {
+      // Nothing in between may use rs, or change rt
+      if (rt != l.in.rt || l.in.imm != 0)
+        return false;
+      for (int m = i + 1; m < j; ++m) {
+        if (!s_[m].deleted && (((s_[m].use | s_[m].def) & R) || (s_[m].def & gpr_bit(static_cast<unsigned>(rt)))))
+          return false;
+      }
+    } else if (rt >= 0 || inc != l.in.imm || inc == 0 || !fixups(i, j, rs, inc, fix)) {
+      return false;
+    }
+    Insn f = l.in;
+    f.op = incrementing_form(l.in.op);
+    if (!valid(f))
+      return false;
+
+    what = std::string(name(l.in.op)) + "+" + s_[j].mnemonic + "->" + name(f.op);
+    apply(fix);
+    s_[j].deleted = true;
+    replace(i, f);
+    at = i;
+    return true;
+  }
+
+  // 'rs += k' + later access at offset 0 off rs -> base-updating form at k
+  bool try_pre_inc(int i, std::string& what, int& at)
+  {
+    int32_t inc;
+    int rt;
+    const int rs = bump(s_[i], inc, rt);
+    if (rs <= 0 || rt >= 0 || inc == 0 || s_[i].in_delay || s_[i].delay_owner)
+      return false;
+    const uint64_t R = gpr_bit(static_cast<unsigned>(rs));
+    int j = -1;
+    for (int k = next(i); k >= 0 && same_block(i, k); k = next(k)) {
+      const Stmt& s = s_[k];
+      if (s.mxu && incrementing_form(s.in.op) != Op::invalid && !is_indexed(s.in.op) &&
+          s.in.rs == rs && s.in.imm == 0) {
+        j = k;
+        break;
+      }
+      if (s.def & R)
+        return false;
+    }
+    if (j < 0)
+      return false;
+    std::vector<std::pair<int, std::string>> fix;
+    if (!fixups(i, j, rs, -inc, fix))
+      return false;
+    Insn f = s_[j].in;
+    f.op = incrementing_form(f.op);
+    f.imm = inc;
+    if (!valid(f))
+      return false;
+
+    what = s_[i].mnemonic + "+" + name(s_[j].in.op) + "->" + name(f.op);
+    apply(fix);
+    s_[i].deleted = true;
+    replace(j, f);
+    at = j;
+    return true;
+  }
+
+  const std::vector<std::string>& lines_;
+  std::vector<Stmt>& s_;
+  Flow flow_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Output
+////////////////////////////////////////////////////////////////////////////////
+
+void rewrite(std::vector<std::string>& lines, const std::vector<Stmt>& stmts)
+{
+  std::vector<bool> drop(lines.size(), false);
+  // Right to left within each line, so earlier offsets stay valid
+  for (std::size_t k = stmts.size(); k-- > 0;) {
+    const Stmt& s = stmts[k];
+    std::string& line = lines[s.line];
+    if (s.deleted) {
+      if (s.se < line.size() && line[s.se] == ';')
+        line.erase(s.sb, s.se + 1 - s.sb);
+      else if (s.sb > 0 && line[s.sb - 1] == ';')
+        line.erase(s.sb - 1, s.se - s.sb + 1);
+      else
+        line.erase(s.b, s.e - s.b);
+      drop[s.line] = detail::trim(line).empty();
+    } else if (!s.text.empty()) {
+      // A trailing comment keeps its column where there is room
+      std::size_t c = s.e;
+      while (c < line.size() && (line[c] == ' ' || line[c] == '\t'))
+        ++c;
+      if (c > s.e && c < line.size() && line[c] == '#' && line.find('\t', s.b) >= c) {
+        const std::size_t col = c - s.b;
+        line.replace(s.b, c - s.b, s.text + std::string(s.text.size() < col ? col - s.text.size() : 1, ' '));
+      } else {
+        line.replace(s.b, s.e - s.b, s.text);
+      }
+    }
+  }
+  std::vector<std::string> out;
+  for (std::size_t i = 0; i < lines.size(); ++i) {
+    if (!drop[i])
+      out.push_back(lines[i]);
+  }
+  lines.swap(out);
+}
+
+struct Report {
+  int before = 0, after = 0;
+  std::map<std::string, int> rewrites;
+};
+
+uint64_t parse_live_out(const std::string& s, bool& ok)
+{
+  ok = true;
+  if (s == "all")
+    return kAllXr;
+  uint64_t m = 0;
+  for (const std::string& r : split_operands(s)) {
+    const int x = detail::parse_xr(r, 15);
+    ok = ok && x > 0;
+    m |= x > 0 ? xr_bit(static_cast<unsigned>(x)) : 0;
+  }
+  return m;
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr, "usage: %s [-o OUT] [-n] [--live-out xrN,...|all] FILE\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string in_path, out_path;
+  bool write = true;
+  // $v0, $v1, $s0..$s7, $gp, $sp, $fp, $ra
+  uint64_t ret_live = gpr_mask(0xf0ff000c);
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "-o" && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (a == "-n") {
+      write = false;
+    } else if (a == "--live-out" && i + 1 < argc) {
+      bool ok;
+      ret_live |= parse_live_out(argv[++i], ok);
+      if (!ok) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if ((a == "-" || a[0] != '-') && in_path.empty()) {
+      in_path = a;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (in_path.empty()) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  FILE* f = in_path == "-" ? stdin : std::fopen(in_path.c_str(), "r");
+  if (!f) {
+    std::perror(in_path.c_str());
+    return 2;
+  }
+  std::vector<std::string> lines;
+  std::string line;
+  char buf[4096];
+  bool final_nl = true;
+  while (std::fgets(buf, sizeof(buf), f)) {
+    line += buf;
+    if (line.back() != '\n')
+      continue;
+    line.pop_back();
+    lines.push_back(line);
+    line.clear();
+  }
+  if (!line.empty()) {
+    lines.push_back(line);
+    final_nl = false;
+  }
+  if (f != stdin)
+    std::fclose(f);
+
+  std::vector<Stmt> stmts;
+  std::set<std::string> funcs;
+  read_source(lines, stmts, funcs);
+
+  // Attribute statements to functions: declared ones if there are any,
+  //  otherwise any label that is not local
+  std::string cur = "(top)";
+  for (Stmt& s : stmts) {
+    for (const std::string& l : s.labels) {
+      const bool local = std::isdigit(static_cast<unsigned char>(l[0])) || l.compare(0, 2, ".L") == 0 ||
+                         l[0] == '$';
+      if (funcs.empty() ? !local : funcs.count(l) != 0)
+        cur = l;
+    }
+    s.func = cur;
+  }
+
+  Optimizer opt(lines, stmts, ret_live);
+  const std::vector<std::pair<int, std::string>> done = opt.run();
+
+  std::vector<std::string> order;
+  std::map<std::string, Report> rep;
+  for (const Stmt& s : stmts) {
+    if (!rep.count(s.func))
+      order.push_back(s.func);
+    Report& r = rep[s.func];
+    ++r.before;
+    r.after += !s.deleted;
+  }
+  for (const auto& d : done)
+    ++rep[stmts[d.first].func].rewrites[d.second];
+
+  int total = 0;
+  for (const std::string& fn : order) {
+    const Report& r = rep[fn];
+    if (r.before == r.after)
+      continue;
+    std::fprintf(stderr, "%s: %d -> %d instructions (%d saved):", fn.c_str(), r.before, r.after,
+                 r.before - r.after);
+    const char* sep = " ";
+    for (const auto& w : r.rewrites) {
+      std::fprintf(stderr, "%s%dx %s", sep, w.second, w.first.c_str());
+      sep = ", ";
+    }
+    std::fprintf(stderr, "\n");
+    total += r.before - r.after;
+  }
+  std::fprintf(stderr, "total: %d instructions saved\n", total);
+
+  if (!write)
+    return 0;
+  rewrite(lines, stmts);
+  FILE* out = out_path.empty() || out_path == "-" ? stdout : std::fopen(out_path.c_str(), "w");
+  if (!out) {
+    std::perror(out_path.c_str());
+    return 2;
+  }
+  for (std::size_t i = 0; i < lines.size(); ++i)
+    std::fprintf(out, "%s%s", lines[i].c_str(), i + 1 < lines.size() || final_nl ? "\n" : "");
+  if (out != stdout)
+    std::fclose(out);
+  return 0;
+}
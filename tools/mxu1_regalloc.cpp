@@ -0,0 +1,900 @@
+// mxu1_regalloc.cpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 register allocator for virtual xr registers
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+// Build:  c++ -std=c++14 -O2 -I.. -o mxu1_regalloc mxu1_regalloc.cpp
+//
+// Usage:
+//   mxu1_regalloc [-o OUT] [-v] [-r REGS] [-D NAME=VALUE]... FILE
+//
+//   Reads FILE (.s or .S, or '-' for stdin) written with virtual MXU registers,
+//   and writes it to OUT (or stdout) with each one replaced by an xr register
+//   and every '.mxu_unroll' block expanded, ready for mxu1_as_macros.s.h.
+//
+//   -r REGS          Registers to allocate from, e.g. 'xr1-xr12' or
+//                    'xr1-xr8,xr15' (default xr1-xr15)
+//   -D NAME=VALUE    Define NAME for '.mxu_unroll' counts, overriding any
+//                    '.equ'/'.set' of NAME in FILE; the output defines it too
+//   -v               Also list where each virtual register went
+//
+// Source syntax:
+//
+//   %name            A virtual xr register, anywhere an xr operand may go
+//                    (letters, digits, '_' and '.'; '%hi(...)' and friends
+//                    are left alone). Its live range is found by liveness
+//                    analysis over the file's control flow, so a name may be
+//                    reused freely for unrelated values.
+//
+//   .mxu_unroll N[, VAR]
+//   ...
+//   .mxu_endunroll   Repeat the lines in between N times. In copy k (0-based),
+//                    '{VAR}' ('{i}' by default) becomes k, so '%acc{i}' names
+//                    a register per copy and '4*{i}' an offset per copy. N is
+//                    a number or a symbol set earlier with .equ/.set/.equiv
+//                    or -D, or a sum or product of those. Blocks nest.
+//                    (Mind names that end in a digit: '%a1{i}' in copy 0
+//                    and '%a{i}' in copy 10 are the same register.)
+//
+// Example, a dot product unrolled by UNROLL with one accumulator pair per copy:
+//
+//       .equ UNROLL, 4
+//       .mxu_unroll UNROLL
+//       s32i2m  %acch{i}, $zero
+//       s32i2m  %accl{i}, $zero
+//       .mxu_endunroll
+//   1:
+//       .mxu_unroll UNROLL
+//       s32ldd  %x{i}, $a0, 4*{i}
+//       s32ldd  %y{i}, $a1, 4*{i}
+//       d16mac  %acch{i}, %x{i}, %y{i}, %accl{i}, AA, WW
+//       .mxu_endunroll
+//       addiu   $a0, $a0, 4*UNROLL
+//       ...
+//
+// Going from 4 copies to 8 is then a matter of '.equ UNROLL, 8' (or
+// -D UNROLL=8), and the allocator either finds room for them or says which
+// values were live where it ran out.
+//
+//  Registers written literally (xr1 etc.) are left alone, and no virtual
+// register is given one while it holds a value that is still needed; they are
+// taken to be live where the function returns. A virtual register must not be
+// live across a call, since no MXU register survives one, nor across a
+// statement the allocator cannot see into (a macro invocation, or an
+// unknown instruction), and it must not be read before it is written. Each
+// of these is an error, as is running out of registers: the exit status is
+// then 1 and nothing is written.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mips32_deps.hpp"
+#include "mxu1_deps.hpp"
+#include "mxu1_parse.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace mxu1;
+
+// Register indices: xr0..15 are 0..15, virtual registers follow
+constexpr int kNumXr = 16;
+
+class RegSet {
+ public:
+  explicit RegSet(int n = 0) : w_((n + 63) / 64, 0) {}
+  void set(int i)        { w_[i / 64] |= 1ull << (i % 64); }
+  bool test(int i) const { return (w_[i / 64] >> (i % 64)) & 1; }
+  bool operator!=(const RegSet& o) const { return w_ != o.w_; }
+  RegSet& operator|=(const RegSet& o)
+  {
+    for (std::size_t k = 0; k < w_.size(); ++k)
+      w_[k] |= o.w_[k];
+    return *this;
+  }
+  RegSet minus(const RegSet& o) const
+  {
+    RegSet r = *this;
+    for (std::size_t k = 0; k < w_.size(); ++k)
+      r.w_[k] &= ~o.w_[k];
+    return r;
+  }
+  template <class F> void each(F f) const
+  {
+    for (std::size_t k = 0; k < w_.size(); ++k) {
+      for (uint64_t m = w_[k]; m; m &= m - 1)
+        f(static_cast<int>(k * 64 + __builtin_ctzll(m)));
+    }
+  }
+  int count() const
+  {
+    int n = 0;
+    for (uint64_t m : w_)
+      n += __builtin_popcountll(m);
+    return n;
+  }
+
+ private:
+  std::vector<uint64_t> w_;
+};
+
+struct Line {
+  std::string text;
+  int src;   // 1-based line number in FILE
+};
+
+std::string where(const std::string& path, int src)
+{
+  return path + ":" + std::to_string(src) + ": ";
+}
+
+bool is_name_char(char ch)
+{
+  return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '.';
+}
+
+// Calls f(begin, end) for each '%name' in 'text' (end exclusive; the name
+//  proper starts at begin + 1), up to any comment
+template <class F> void each_vreg(const std::string& text, F f)
+{
+  bool in_str = false;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const char ch = text[i];
+    if (ch == '"' && (i == 0 || text[i - 1] != '\\'))
+      in_str = !in_str;
+    if (in_str)
+      continue;
+    if (ch == '#')
+      return;
+    if (ch != '%' || (i > 0 && (is_name_char(text[i - 1]) || text[i - 1] == ')')))
+      continue;
+    std::size_t e = i + 1;
+    while (e < text.size() && is_name_char(text[e]))
+      ++e;
+    std::size_t p = e;
+    while (p < text.size() && std::isspace(static_cast<unsigned char>(text[p])))
+      ++p;
+    if (e > i + 1 && !std::isdigit(static_cast<unsigned char>(text[i + 1])) &&
+        (p == text.size() || text[p] != '('))
+      f(i, e);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unrolling
+////////////////////////////////////////////////////////////////////////////////
+
+class Unroller {
+ public:
+  Unroller(const std::string& path, const std::map<std::string, long>& defines)
+      : path_(path), defines_(defines), syms_(defines)
+  {
+  }
+
+  bool run(const std::vector<Line>& in, std::vector<Line>& out)
+  {
+    std::size_t i = 0;
+    return block(in, i, out, false);
+  }
+
+ private:
+  // Copy lines from in[i] to out up to the end of the file (or, if 'nested',
+  //  up to the matching .mxu_endunroll, which is consumed)
+  bool block(const std::vector<Line>& in, std::size_t& i, std::vector<Line>& out, bool nested)
+  {
+    for (; i < in.size(); ++i) {
+      const Line& l = in[i];
+      const std::vector<Statement> sts = split_statements(l.text);
+      const Statement* st = sts.empty() ? nullptr : &sts[0];
+      const std::string m = st ? st->mnemonic : "";
+
+      if (m == ".mxu_endunroll") {
+        if (nested)
+          return true;
+        return fail(l.src, ".mxu_endunroll without .mxu_unroll");
+      }
+      if (m != ".mxu_unroll") {
+        out.push_back(Line{st ? define(*st, l.text) : l.text, l.src});
+        continue;
+      }
+
+      const std::vector<std::string> a = split_operands(st->operands);
+      long n;
+      if (a.empty() || a.size() > 2 || !value(a[0], n) || n < 1 || n > 64)
+        return fail(l.src, ".mxu_unroll needs a count of 1..64 and an optional index name");
+      const std::string var = "{" + (a.size() == 2 ? a[1] : std::string("i")) + "}";
+
+      // Expand the body once, then copy it
+      const int start = l.src;
+      std::vector<Line> inner;
+      if (!block(in, ++i, inner, true))
+        return i < in.size() ? false : fail(start, ".mxu_unroll without .mxu_endunroll");
+      for (long k = 0; k < n; ++k) {
+        for (Line c : inner) {
+          for (std::size_t p; (p = c.text.find(var)) != std::string::npos;)
+            c.text.replace(p, var.size(), std::to_string(k));
+          out.push_back(c);
+        }
+      }
+    }
+    return !nested;
+  }
+
+  // Record '.equ NAME, VALUE' and the like, rewriting VALUE if -D overrides it
+  std::string define(const Statement& st, const std::string& text)
+  {
+    if (st.mnemonic != ".equ" && st.mnemonic != ".set" && st.mnemonic != ".equiv")
+      return text;
+    const std::vector<std::string> a = split_operands(st.operands);
+    if (a.size() != 2)
+      return text;
+    auto d = defines_.find(a[0]);
+    if (d != defines_.end()) {
+      const std::size_t p = text.find(a[1], text.find(a[0]) + a[0].size());
+      return text.substr(0, p) + std::to_string(d->second) + text.substr(p + a[1].size());
+    }
+    long v;
+    if (value(a[1], v))
+      syms_[a[0]] = v;
+    return text;
+  }
+
+  // A number or symbol, or a sum/difference/product of them
+  bool value(const std::string& s, long& v) const
+  {
+    std::size_t p = 0;
+    return sum(s, p, v) && p == s.size();
+  }
+
+  bool sum(const std::string& s, std::size_t& p, long& v) const
+  {
+    if (!product(s, p, v))
+      return false;
+    while (p < s.size() && (s[p] == '+' || s[p] == '-')) {
+      const char op = s[p++];
+      long t;
+      if (!product(s, p, t))
+        return false;
+      v = op == '+' ? v + t : v - t;
+    }
+    return true;
+  }
+
+  bool product(const std::string& s, std::size_t& p, long& v) const
+  {
+    if (!term(s, p, v))
+      return false;
+    while (p < s.size() && s[p] == '*') {
+      long t;
+      if (!term(s, ++p, t))
+        return false;
+      v *= t;
+    }
+    return true;
+  }
+
+  bool term(const std::string& s, std::size_t& p, long& v) const
+  {
+    while (p < s.size() && std::isspace(static_cast<unsigned char>(s[p])))
+      ++p;
+    if (p < s.size() && s[p] == '(') {
+      if (!sum(s, ++p, v) || p >= s.size() || s[p] != ')')
+        return false;
+      ++p;
+    } else {
+      const std::size_t b = p;
+      while (p < s.size() && is_name_char(s[p]))
+        ++p;
+      const std::string tok = s.substr(b, p - b);
+      int32_t n;
+      auto it = syms_.find(tok);
+      if (detail::parse_int(tok, n))
+        v = n;
+      else if (it != syms_.end())
+        v = it->second;
+      else
+        return false;
+    }
+    while (p < s.size() && std::isspace(static_cast<unsigned char>(s[p])))
+      ++p;
+    return true;
+  }
+
+  bool fail(int src, const std::string& msg)
+  {
+    std::fprintf(stderr, "%serror: %s\n", where(path_, src).c_str(), msg.c_str());
+    return false;
+  }
+
+  const std::string& path_;
+  const std::map<std::string, long>& defines_;
+  std::map<std::string, long> syms_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Statements and liveness
+////////////////////////////////////////////////////////////////////////////////
+
+struct Stmt {
+  int         line = 0;           // Index into the unrolled lines
+  std::vector<std::string> labels;
+  std::string mnemonic;
+  std::vector<int> use, def;      // Register indices
+  bool        opaque = false;     // Macro invocation or unknown instruction
+  MipsDeps    md;
+  bool        mips = false;
+  bool        delay_owner = false, in_delay = false;
+};
+
+class Allocator {
+ public:
+  Allocator(const std::string& path, const std::vector<Line>& lines) : path_(path), lines_(lines) {}
+
+  bool read()
+  {
+    bool ok = true, noreorder = false, in_macro = false;
+    std::vector<std::string> pending;
+    for (std::size_t ln = 0; ln < lines_.size(); ++ln) {
+      for (const Statement& st : split_statements(lines_[ln].text)) {
+        std::string text = st.mnemonic + " " + st.operands;
+        bool has_vreg = false;
+        each_vreg(text, [&](std::size_t, std::size_t) { has_vreg = true; });
+
+        if (in_macro || st.mnemonic == ".macro") {
+          in_macro = st.mnemonic != ".endm";
+          if (has_vreg)
+            ok = fail(static_cast<int>(ln), "virtual registers cannot be used inside .macro");
+          continue;
+        }
+        pending.insert(pending.end(), st.labels.begin(), st.labels.end());
+        if (st.mnemonic.empty())
+          continue;
+        if (st.mnemonic == ".set" && (st.operands == "noreorder" || st.operands == "reorder")) {
+          noreorder = st.operands == "noreorder";
+          continue;
+        }
+
+        Stmt s;
+        s.line = static_cast<int>(ln);
+        s.mnemonic = st.mnemonic;
+        std::string err;
+        if (!classify(st, s, err)) {
+          if (has_vreg)
+            ok = fail(s.line, err.empty() ? "virtual register in '" + st.mnemonic + "', which is not an MXU instruction" : err);
+          continue;   // A directive
+        }
+        s.delay_owner = s.mips && s.md.branch && noreorder;
+        s.labels.swap(pending);
+        stmts_.push_back(std::move(s));
+      }
+    }
+    for (std::size_t i = 0; i + 1 < stmts_.size(); ++i) {
+      if (stmts_[i].delay_owner)
+        stmts_[i + 1].in_delay = true;
+    }
+    return ok;
+  }
+
+  void liveness()
+  {
+    const int n = static_cast<int>(stmts_.size());
+    const int nr = num_regs();
+    std::map<std::string, std::vector<int>> labels;
+    for (int i = 0; i < n; ++i) {
+      for (const std::string& l : stmts_[i].labels)
+        labels[l].push_back(i);
+    }
+
+    // Literal registers are assumed live wherever the function may return
+    RegSet exit_live(nr);
+    for (const Stmt& s : stmts_) {
+      for (int r : s.opaque ? std::vector<int>() : s.def) {
+        if (r < kNumXr)
+          exit_live.set(r);
+      }
+    }
+
+    std::vector<std::vector<int>> succ(n);
+    std::vector<bool> exits(n, false);
+    for (int i = 0; i < n; ++i) {
+      const Stmt& st = stmts_[i];
+      if (st.delay_owner) {
+        succ[i].push_back(i + 1);
+        if (st.md.likely)
+          succ[i].push_back(i + 2);
+        continue;
+      }
+      const int owner = st.in_delay ? i - 1 : st.mips && st.md.branch ? i : -1;
+      if (owner < 0) {
+        succ[i].push_back(i + 1);
+        continue;
+      }
+      const Stmt& br = stmts_[owner];
+      if (br.md.call || (br.md.cond && !(br.md.likely && owner != i)))
+        succ[i].push_back(i + 1);
+      if (br.md.call)
+        continue;
+      const int t = resolve(labels, br.md.target, owner);
+      if (t >= 0)
+        succ[i].push_back(t);
+      else
+        exits[i] = true;
+    }
+
+    live_in_.assign(n + 2, RegSet(nr));
+    live_out_.assign(n, RegSet(nr));
+    live_in_[n] = live_in_[n + 1] = exit_live;
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (int i = n - 1; i >= 0; --i) {
+        RegSet out(nr);
+        if (exits[i])
+          out = exit_live;
+        for (int t : succ[i])
+          out |= live_in_[std::min(t, n)];
+        RegSet in = out;
+        RegSet defs(nr), uses(nr);
+        for (int r : stmts_[i].def)
+          defs.set(r);
+        for (int r : stmts_[i].use)
+          uses.set(r);
+        in = in.minus(defs);
+        in |= uses;
+        if (out != live_out_[i] || in != live_in_[i]) {
+          live_out_[i] = out;
+          live_in_[i] = in;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // Errors for virtual registers live where they cannot be
+  bool check()
+  {
+    bool ok = true;
+    const RegSet& entry = live_in_[0];
+    entry.each([&](int r) {
+      if (r >= kNumXr)
+        ok = fail(stmts_[first_use(r)].line, "%" + names_[r - kNumXr] + " is read before it is written");
+    });
+    for (std::size_t i = 0; i < stmts_.size(); ++i) {
+      const Stmt& s = stmts_[i];
+      const bool call = s.mips && s.md.call;
+      if (!call && !s.opaque)
+        continue;
+      // For a call, what matters is what is live once it returns
+      const RegSet& live = call && s.delay_owner ? live_out_[i + 1] : live_out_[i];
+      live.each([&](int r) {
+        if (r >= kNumXr)
+          ok = fail(s.line, "%" + names_[r - kNumXr] + " is live across '" + s.mnemonic + "'" +
+                            (call ? ", and no MXU register survives a call" :
+                                    ", which may use any MXU register"));
+      });
+    }
+    return ok;
+  }
+
+  bool allocate(uint32_t pool, bool verbose)
+  {
+    const int nv = static_cast<int>(names_.size());
+    const int nr = num_regs();
+    std::vector<std::set<int>> adj(nr);
+    auto edge = [&](int a, int b) {
+      if (a != b && (a >= kNumXr || b >= kNumXr)) {
+        adj[a].insert(b);
+        adj[b].insert(a);
+      }
+    };
+    // A register written by a statement conflicts with everything live after
+    //  it, and with anything else the same statement writes
+    int peak = 0, peak_at = -1;
+    for (std::size_t i = 0; i < stmts_.size(); ++i) {
+      const Stmt& s = stmts_[i];
+      RegSet busy = live_out_[i];
+      for (int d : s.def)
+        busy.set(d);
+      const int p = busy.count();
+      if (p > peak) {
+        peak = p;
+        peak_at = static_cast<int>(i);
+      }
+      for (int d : s.def)
+        busy.each([&](int r) { edge(d, r); });
+    }
+
+    // Simplify (Chaitin), coloring optimistically (Briggs)
+    const int k = __builtin_popcount(pool);
+    std::vector<int> stack;
+    std::vector<bool> removed(nr, false);
+    std::vector<int> degree(nr, 0);
+    for (int v = kNumXr; v < nr; ++v) {
+      for (int u : adj[v])
+        degree[v] += u >= kNumXr || (pool >> u & 1);
+    }
+    for (int left = nv; left > 0; --left) {
+      // Any node that is sure to get a register, or else the one with the
+      //  most neighbours, which may still be lucky
+      int pick = -1;
+      for (int v = kNumXr; v < nr && (pick < 0 || degree[pick] >= k); ++v) {
+        if (!removed[v] && (pick < 0 || degree[v] < k || degree[v] > degree[pick]))
+          pick = v;
+      }
+      removed[pick] = true;
+      stack.push_back(pick);
+      for (int u : adj[pick])
+        --degree[u];
+    }
+
+    color_.assign(nr, -1);
+    for (int r = 0; r < kNumXr; ++r)
+      color_[r] = r;
+    bool ok = true;
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+      uint32_t free = pool;
+      for (int u : adj[*it]) {
+        if (color_[u] >= 0)
+          free &= ~(1u << color_[u]);
+      }
+      if (!free) {
+        ok = false;
+        continue;
+      }
+      color_[*it] = __builtin_ctz(free);
+    }
+
+    if (!ok) {
+      const Stmt& s = stmts_[peak_at];
+      std::string live;
+      RegSet busy = live_out_[peak_at];
+      for (int d : s.def)
+        busy.set(d);
+      busy.each([&](int r) { live += " " + reg_name(r); });
+      fail(s.line, "out of MXU registers: " + std::to_string(peak) + " values live here, " +
+                       std::to_string(k) + " registers available:" + live);
+      for (int v = kNumXr; v < nr; ++v) {
+        if (color_[v] < 0)
+          std::fprintf(stderr, "%snote: no register left for %s\n",
+                       where(path_, lines_[stmts_[first_def(v)].line].src).c_str(), reg_name(v).c_str());
+      }
+      return false;
+    }
+
+    std::set<int> used;
+    for (int v = kNumXr; v < nr; ++v)
+      used.insert(color_[v]);
+    std::fprintf(stderr, "%d virtual registers in %d xr registers, peak pressure %d at line %d\n", nv,
+                 static_cast<int>(used.size()), peak, peak_at < 0 ? 0 : lines_[stmts_[peak_at].line].src);
+    if (verbose) {
+      for (int v = kNumXr; v < nr; ++v)
+        std::fprintf(stderr, "  %-16s xr%d\n", reg_name(v).c_str(), color_[v]);
+    }
+    return true;
+  }
+
+  std::string rewrite(const std::string& text) const
+  {
+    std::string out;
+    std::size_t at = 0;
+    each_vreg(text, [&](std::size_t b, std::size_t e) {
+      auto it = index_.find(text.substr(b + 1, e - b - 1));
+      if (it == index_.end())
+        return;
+      out += text.substr(at, b - at);
+      out += "xr" + std::to_string(color_[it->second]);
+      at = e;
+    });
+    return out + text.substr(at);
+  }
+
+ private:
+  int num_regs() const { return kNumXr + static_cast<int>(names_.size()); }
+
+  std::string reg_name(int r) const
+  {
+    return r < kNumXr ? "xr" + std::to_string(r) : "%" + names_[r - kNumXr];
+  }
+
+  int vreg(const std::string& name)
+  {
+    auto it = index_.find(name);
+    if (it != index_.end())
+      return it->second;
+    names_.push_back(name);
+    return index_[name] = kNumXr + static_cast<int>(names_.size()) - 1;
+  }
+
+  // Fill in s.use/def. False for directives and, with 'err' set, for operands
+  //  the MXU parser rejects.
+  bool classify(const Statement& st, Stmt& s, std::string& err)
+  {
+    // Stand in for each virtual register with an xr the statement leaves unused
+    std::vector<std::pair<int, int>> subst;   // (xr, virtual register index)
+    std::string ops;
+    std::set<int> literal;
+    for (const std::string& o : split_operands(st.operands)) {
+      const int x = detail::parse_xr(o, 16);
+      if (x >= 0)
+        literal.insert(x);
+    }
+    int next_xr = 1;
+    std::size_t at = 0;
+    bool too_many = false;
+    each_vreg(st.operands, [&](std::size_t b, std::size_t e) {
+      const int v = vreg(st.operands.substr(b + 1, e - b - 1));
+      int x = -1;
+      for (const auto& p : subst) {
+        if (p.second == v)
+          x = p.first;
+      }
+      if (x < 0) {
+        while (literal.count(next_xr))
+          ++next_xr;
+        x = next_xr++;
+        too_many |= x > 15;
+        subst.push_back({x, v});
+      }
+      ops += st.operands.substr(at, b - at) + "xr" + std::to_string(x);
+      at = e;
+    });
+    ops += st.operands.substr(at);
+    if (too_many) {
+      err = "too many registers in one statement";
+      return false;
+    }
+    auto map = [&](uint32_t bits, std::vector<int>& out) {
+      bits &= 0xfffe;
+      for (const auto& p : subst) {
+        if (bits >> p.first & 1) {
+          out.push_back(p.second);
+          bits &= ~(1u << p.first);
+        }
+      }
+      for (int r = 1; r < kNumXr; ++r) {
+        if (bits >> r & 1)
+          out.push_back(r);
+      }
+    };
+
+    Insn in;
+    int32_t w;
+    if ((st.mnemonic == ".word" || st.mnemonic == ".long" || st.mnemonic == ".4byte") &&
+        detail::parse_int(st.operands, w) && decode(static_cast<uint32_t>(w)).op != Op::invalid) {
+      in = decode(static_cast<uint32_t>(w));
+    } else if (st.mnemonic[0] == '.') {
+      return false;
+    } else if (!parse(st.mnemonic, ops, in, err) && !parse(st.mnemonic, constant_operands(ops, "0"), in, err) &&
+               !parse(st.mnemonic, constant_operands(ops, "4"), in, err)) {
+      if (!err.empty())
+        return false;
+      s.mips = mips_deps(st.mnemonic, st.operands, s.md);
+      if (!s.mips) {
+        // A macro, or something else this tool does not know
+        s.opaque = true;
+        for (int r = 1; r < kNumXr; ++r)
+          s.def.push_back(r);
+      }
+      return subst.empty();
+    }
+    const Deps d = deps(in);
+    map(d.xr_use, s.use);
+    map(d.xr_def, s.def);
+    return true;
+  }
+
+  // 'ops' with each operand that is not a register or pattern name, and so
+  //  may be an expression for GAS to evaluate, replaced by 'c'. Only the
+  //  registers matter here.
+  static std::string constant_operands(const std::string& ops, const char* c)
+  {
+    static const char* const kPatterns[] = {
+      "A", "S", "AA", "AS", "SA", "SS", "WW", "LW", "HW", "XW", "HH", "LL", "HL", "LH",
+    };
+    std::string out;
+    for (const std::string& o : split_operands(ops)) {
+      const bool keep = detail::parse_xr(o, 16) >= 0 || detail::parse_gpr(o) >= 0 ||
+                        detail::parse_ptn(o) >= 0 ||
+                        std::find(std::begin(kPatterns), std::end(kPatterns), o) != std::end(kPatterns);
+      out += (out.empty() ? "" : ", ") + (keep ? o : std::string(c));
+    }
+    return out;
+  }
+
+  int resolve(const std::map<std::string, std::vector<int>>& labels, const std::string& t, int from) const
+  {
+    if (t.size() > 1 && std::isdigit(static_cast<unsigned char>(t[0])) && (t.back() == 'b' || t.back() == 'f')) {
+      auto it = labels.find(t.substr(0, t.size() - 1));
+      if (it == labels.end())
+        return -1;
+      int best = -1;
+      for (int k : it->second) {
+        if (t.back() == 'b' ? (k <= from && k > best) : (k > from && (best < 0 || k < best)))
+          best = k;
+      }
+      return best;
+    }
+    auto it = labels.find(t);
+    return it == labels.end() || it->second.size() != 1 ? -1 : it->second[0];
+  }
+
+  int first_use(int r) const
+  {
+    for (std::size_t i = 0; i < stmts_.size(); ++i) {
+      if (std::find(stmts_[i].use.begin(), stmts_[i].use.end(), r) != stmts_[i].use.end())
+        return static_cast<int>(i);
+    }
+    return 0;
+  }
+
+  int first_def(int r) const
+  {
+    for (std::size_t i = 0; i < stmts_.size(); ++i) {
+      if (std::find(stmts_[i].def.begin(), stmts_[i].def.end(), r) != stmts_[i].def.end())
+        return static_cast<int>(i);
+    }
+    return first_use(r);
+  }
+
+  bool fail(int line, const std::string& msg) const
+  {
+    std::fprintf(stderr, "%serror: %s\n", where(path_, lines_[line].src).c_str(), msg.c_str());
+    return false;
+  }
+
+  const std::string& path_;
+  const std::vector<Line>& lines_;
+  std::vector<Stmt> stmts_;
+  std::vector<std::string> names_;
+  std::map<std::string, int> index_;
+  std::vector<RegSet> live_in_, live_out_;
+  std::vector<int> color_;
+};
+
+bool parse_pool(const std::string& s, uint32_t& pool)
+{
+  pool = 0;
+  for (const std::string& part : split_operands(s)) {
+    const std::size_t dash = part.find('-');
+    const int lo = detail::parse_xr(part.substr(0, dash), 15);
+    const int hi = dash == std::string::npos ? lo : detail::parse_xr(part.substr(dash + 1), 15);
+    if (lo < 1 || hi < lo)
+      return false;
+    for (int r = lo; r <= hi; ++r)
+      pool |= 1u << r;
+  }
+  return pool != 0;
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr, "usage: %s [-o OUT] [-v] [-r xrA-xrB,...] [-D NAME=VALUE]... FILE\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string in_path, out_path;
+  bool verbose = false;
+  uint32_t pool = 0xfffe;
+  std::map<std::string, long> defines;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "-o" && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (a == "-v") {
+      verbose = true;
+    } else if (a == "-r" && i + 1 < argc) {
+      if (!parse_pool(argv[++i], pool)) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (a.compare(0, 2, "-D") == 0) {
+      const std::string d = a.size() > 2 ? a.substr(2) : i + 1 < argc ? argv[++i] : "";
+      const std::size_t eq = d.find('=');
+      int32_t v;
+      if (eq == std::string::npos || !detail::parse_int(d.substr(eq + 1), v)) {
+        usage(argv[0]);
+        return 2;
+      }
+      defines[d.substr(0, eq)] = v;
+    } else if ((a == "-" || a[0] != '-') && in_path.empty()) {
+      in_path = a;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (in_path.empty()) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  FILE* f = in_path == "-" ? stdin : std::fopen(in_path.c_str(), "r");
+  if (!f) {
+    std::perror(in_path.c_str());
+    return 2;
+  }
+  std::vector<Line> src;
+  std::string line;
+  char buf[4096];
+  while (std::fgets(buf, sizeof(buf), f)) {
+    line += buf;
+    if (line.back() != '\n')
+      continue;
+    line.pop_back();
+    src.push_back(Line{line, static_cast<int>(src.size()) + 1});
+    line.clear();
+  }
+  if (!line.empty())
+    src.push_back(Line{line, static_cast<int>(src.size()) + 1});
+  if (f != stdin)
+    std::fclose(f);
+
+  const std::string name = in_path == "-" ? "<stdin>" : in_path;
+  std::vector<Line> lines;
+  Unroller unroller(name, defines);
+  if (!unroller.run(src, lines))
+    return 1;
+
+  Allocator alloc(name, lines);
+  if (!alloc.read())
+    return 1;
+  alloc.liveness();
+  if (!alloc.check() || !alloc.allocate(pool, verbose))
+    return 1;
+
+  FILE* out = out_path.empty() || out_path == "-" ? stdout : std::fopen(out_path.c_str(), "w");
+  if (!out) {
+    std::perror(out_path.c_str());
+    return 2;
+  }
+  std::set<std::string> defined;
+  for (const Line& l : lines) {
+    for (const Statement& st : split_statements(l.text)) {
+      const std::vector<std::string> a = split_operands(st.operands);
+      if ((st.mnemonic == ".equ" || st.mnemonic == ".set" || st.mnemonic == ".equiv") && !a.empty())
+        defined.insert(a[0]);
+    }
+  }
+  for (const auto& d : defines) {
+    if (!defined.count(d.first))
+      std::fprintf(out, "\t.set\t%s, %ld\n", d.first.c_str(), d.second);
+  }
+  for (const Line& l : lines)
+    std::fprintf(out, "%s\n", alloc.rewrite(l.text).c_str());
+  if (out != stdout)
+    std::fclose(out);
+  return 0;
+}
@@ -0,0 +1,293 @@
+// mxu1_xlate_check.cpp
+//
+// MIPS Ingenic XBurst MXU1 rev1,2 differential test of mxu1::Translator against mxu1::State
+//
+// MIT License
+//
+// Copyright (c) 2019 Daniel Silsby (senquack)
+//                    dansilsby <AT> gmail <DOT> com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Build:  c++ -std=c++14 -O2 -I.. -o mxu1_xlate_check mxu1_xlate_check.cpp
+//
+// Usage:
+//   mxu1_xlate_check [-n RUNS] [-s SEED]
+//
+//   Runs random blocks of MXU words through mxu1::State::run() and through
+//   mxu1::Translator::run() on a second State from the same starting point,
+//   and compares the two afterwards: xr0..xr16 (MXU_CR included), the GPRs,
+//   HI/LO, the executed-instruction counts, guest memory and the text of the
+//   fault, if any. Exits with status 1, after printing the first few blocks
+//   that differ, if any run does. The summary gives the instructions run up
+//   to the end of the block or its fault, which are those compared, and the
+//   loads and stores among them.
+//
+//   -n RUNS          Runs (default 200000)
+//   -s SEED          Seed of the generator (default 1); a failure prints the
+//                    seed and run, for a rerun under a debugger
+//
+//  A block is 1..32 instructions of any opcode, with every operand field
+// random within the opcode's legal range, and now and then a word that is
+// not an MXU instruction. Each block is run several times from different
+// starting states, so later runs come from the Translator's cache, and is
+// sometimes changed in place first, which must be noticed and translated
+// again. Starting states have random xr registers and HI/LO and an MXU_CR
+// with random rounding and carry bits (MXU_EN clear in one run of sixteen).
+// GPRs have roles: bases in the guest buffer, indexes and counts. Loads and
+// stores are given registers of the right role and small offsets, so that
+// nearly all of them hit the buffer; one in 128 keeps its random fields, and
+// one GPR in 256 any value, so that unmapped and misaligned accesses still
+// fault part way through some blocks (under one run in ten).
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mxu1_disasm.hpp"
+#include "mxu1_emu.hpp"
+#include "mxu1_isa.hpp"
+#include "mxu1_xlate.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace mxu1;
+
+//  The guest buffer: base GPRs point into its middle half, so that the
+// offsets the generator keeps to (+-128, many times over for the forms that
+// update the base) stay inside it
+constexpr uint32_t kBase = 0x10000;
+constexpr uint32_t kMemBytes = 8192;
+constexpr std::size_t kMaxBlock = 32;
+constexpr int kRunsPerBlock = 8;
+constexpr int kMaxReports = 5;
+
+//  GPR roles: $1..$15 are bases in the buffer, $16..$23 indexes (small
+// multiples of 4, aligned after any stride) and $24..$31 counts and shifts,
+// which GPR-writing opcodes write
+constexpr int kFirstIndex = 16;
+constexpr int kFirstCount = 24;
+
+using Rng = std::mt19937;
+
+//  Points the GPR operands of a load or store at registers of the right
+// role and brings its offset into +-128, except in one of 128, which keeps
+// the fields it was given so that unmapped and misaligned accesses are
+// still tried
+bool is_memory(Fmt f)
+{
+  return f == Fmt::XA_RS_RT_STRD2 || f == Fmt::XA_RS_S12 || f == Fmt::XA_RS_S8_PTN ||
+         f == Fmt::XA_RS_S10_PTN || f == Fmt::RD_RS_RT_STRD2;
+}
+
+void bias(Rng& rng, Insn& in)
+{
+  const Fmt f = info(in.op).fmt;
+  if (rng() % 128 == 0)
+    return;
+  if (in.op == Op::s32m2i)
+    in.rt = static_cast<uint8_t>(kFirstCount + rng() % (32 - kFirstCount));
+  if (!is_memory(f))
+    return;
+  in.rs = static_cast<uint8_t>(1 + rng() % (kFirstIndex - 1));
+  if (f == Fmt::XA_RS_RT_STRD2 || f == Fmt::RD_RS_RT_STRD2)
+    in.rt = static_cast<uint8_t>(kFirstIndex + rng() % (kFirstCount - kFirstIndex));
+  if (f == Fmt::RD_RS_RT_STRD2)
+    in.rd = static_cast<uint8_t>(kFirstCount + rng() % (32 - kFirstCount));
+  in.imm %= 128;
+}
+
+uint32_t random_word(Rng& rng)
+{
+  if (rng() % 512 == 0)
+    return 0x12345678;                  // Not an MXU instruction
+  for (;;) {
+    const OpInfo& oi = info(static_cast<Op>(rng() % kNumOps));
+    Insn in = decode(oi.word | (rng() & field_mask(oi.fmt)));
+    if (in.op != Op::invalid) {
+      bias(rng, in);
+      return encode(in);
+    }
+  }
+}
+
+void random_state(Rng& rng, State& st)
+{
+  for (uint32_t& r : st.xr)
+    r = rng();
+  st.xr[16] = (rng() & (CR_RD_EN | CR_BIAS | CR_CARRY_A | CR_CARRY_D)) |
+              (rng() % 16 ? CR_MXU_EN : 0);
+  for (int i = 1; i < 32; ++i) {
+    uint32_t& r = st.gpr[i];
+    if (rng() % 256 == 0)
+      r = rng();
+    else if (i < kFirstIndex)
+      r = kBase + kMemBytes / 4 + (rng() % (kMemBytes / 8)) * 4;
+    else if (i < kFirstCount)
+      r = (rng() % 16) * 4;
+    else
+      r = rng() % 64;
+  }
+  st.hi = rng();
+  st.lo = rng();
+}
+
+//  Calls 'run', returning the text of the fault it throws, if any
+template <typename Run>
+std::string outcome(Run run)
+{
+  try {
+    run();
+  } catch (const std::exception& e) {
+    return e.what();
+  }
+  return std::string();
+}
+
+template <std::size_t N>
+void diff_regs(const char* what, const std::array<uint32_t, N>& a,
+               const std::array<uint32_t, N>& b)
+{
+  for (std::size_t i = 0; i < N; ++i)
+    if (a[i] != b[i])
+      std::printf("  %s%zu: State 0x%08x, Translator 0x%08x\n", what, i, a[i], b[i]);
+}
+
+void report(const std::vector<uint32_t>& words, const State& a, const State& b,
+            const std::string& fa, const std::string& fb,
+            const uint8_t* ma, const uint8_t* mb)
+{
+  for (uint32_t w : words)
+    std::printf("    %08x  %s\n", w, to_string(w).c_str());
+  if (fa != fb)
+    std::printf("  fault: State '%s', Translator '%s'\n", fa.c_str(), fb.c_str());
+  diff_regs("xr", a.xr, b.xr);
+  diff_regs("$", a.gpr, b.gpr);
+  if (a.hi != b.hi || a.lo != b.lo)
+    std::printf("  hi/lo: State 0x%08x/0x%08x, Translator 0x%08x/0x%08x\n",
+                a.hi, a.lo, b.hi, b.lo);
+  for (std::size_t i = 0; i < kNumOps; ++i)
+    if (a.counts[i] != b.counts[i])
+      std::printf("  count of %s: State %llu, Translator %llu\n", kOpInfo[i].name,
+                  static_cast<unsigned long long>(a.counts[i]),
+                  static_cast<unsigned long long>(b.counts[i]));
+  for (uint32_t i = 0; i < kMemBytes; ++i)
+    if (ma[i] != mb[i])
+      std::printf("  mem 0x%08x: State 0x%02x, Translator 0x%02x\n", kBase + i,
+                  ma[i], mb[i]);
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr, "usage: %s [-n RUNS] [-s SEED]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  long runs = 200000;
+  unsigned long seed = 1;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "-n" && i + 1 < argc) {
+      runs = std::atol(argv[++i]);
+    } else if (a == "-s" && i + 1 < argc) {
+      seed = std::strtoul(argv[++i], nullptr, 0);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (runs <= 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  Rng rng(static_cast<Rng::result_type>(seed));
+  std::vector<uint8_t> init(kMemBytes), mem_a(kMemBytes), mem_b(kMemBytes);
+  std::vector<uint32_t> words;
+  State a, b;
+  a.mem.map(kBase, mem_a.data(), kMemBytes);
+  b.mem.map(kBase, mem_b.data(), kMemBytes);
+  Translator tr(b);
+  long failed = 0, faults = 0;
+  uint64_t generated = 0, executed = 0, accesses = 0;
+
+  //  One buffer for every block, as an Emitter reuses its own: the cache
+  // must tell a new block at the same address from the old one
+  words.reserve(kMaxBlock);
+  for (long run = 0; run < runs; ++run) {
+    if (run % kRunsPerBlock == 0) {
+      words.resize(1 + rng() % kMaxBlock);
+      for (uint32_t& w : words)
+        w = random_word(rng);
+      for (uint8_t& m : init)
+        m = static_cast<uint8_t>(rng());
+    } else if (rng() % 8 == 0) {
+      words[rng() % words.size()] = random_word(rng);
+    }
+
+    random_state(rng, a);
+    b.xr = a.xr;
+    b.gpr = a.gpr;
+    b.hi = a.hi;
+    b.lo = a.lo;
+    a.counts = b.counts = decltype(a.counts){};
+    mem_a = init;
+    mem_b = init;
+
+    const std::string fa = outcome([&] { a.run(words.data(), words.size()); });
+    const std::string fb = outcome([&] { tr.run(words.data(), words.size()); });
+    faults += !fa.empty();
+    generated += words.size();
+    for (std::size_t i = 0; i < kNumOps; ++i) {
+      executed += a.counts[i];
+      if (is_memory(kOpInfo[i].fmt))
+        accesses += a.counts[i];
+    }
+    if (fa != fb || a.xr != b.xr || a.gpr != b.gpr || a.hi != b.hi ||
+        a.lo != b.lo || a.counts != b.counts || mem_a != mem_b) {
+      if (failed < kMaxReports) {
+        std::printf("seed %lu run %ld: Translator differs from State after\n",
+                    seed, run);
+        report(words, a, b, fa, fb, mem_a.data(), mem_b.data());
+      }
+      ++failed;
+    }
+  }
+
+  std::printf("%ld runs (%ld faulted), %llu of %llu instructions compared "
+              "(%llu loads and stores), %llu translations: %ld differ%s\n",
+              runs, faults, static_cast<unsigned long long>(executed),
+              static_cast<unsigned long long>(generated),
+              static_cast<unsigned long long>(accesses),
+              static_cast<unsigned long long>(tr.translations()), failed,
+              failed == 1 ? "s" : "");
+  return failed ? 1 : 0;
+}